@@ -1,4 +1,5 @@
 #include "BasicBlock.h"
+#include "JitCodeCache.h"
 #include "MemStream.h"
 #include "offsetof_def.h"
 #include "MipsJitter.h"
@@ -45,6 +46,7 @@ CBasicBlock::CBasicBlock(CMIPS& context, uint32 begin, uint32 end)
     : m_begin(begin)
     , m_end(end)
     , m_context(context)
+    , m_compileContext(&context)
 #ifdef AOT_USE_CACHE
     , m_function(nullptr)
 #endif
@@ -76,55 +78,7 @@ void CBasicBlock::SetAotBlockOutputStream(Framework::CStdStream* outputStream)
 void CBasicBlock::Compile()
 {
 #ifndef AOT_USE_CACHE
-
-	Framework::CMemStream stream;
-	{
-		static
-#ifdef AOT_BUILD_CACHE
-		    __declspec(thread)
-#endif
-		        CMipsJitter* jitter = nullptr;
-		if(jitter == nullptr)
-		{
-			Jitter::CCodeGen* codeGen = Jitter::CreateCodeGen();
-			jitter = new CMipsJitter(codeGen);
-
-			for(unsigned int i = 0; i < 4; i++)
-			{
-				jitter->SetVariableAsConstant(
-				    offsetof(CMIPS, m_State.nGPR[CMIPS::R0].nV[i]),
-				    0);
-			}
-		}
-
-		jitter->GetCodeGen()->SetExternalSymbolReferencedHandler([&](auto symbol, auto offset, auto refType) { this->HandleExternalFunctionReference(symbol, offset, refType); });
-		jitter->SetStream(&stream);
-		jitter->Begin();
-		CompileRange(jitter);
-		jitter->End();
-	}
-
-	m_function = CMemoryFunction(stream.GetBuffer(), stream.GetSize());
-
-#ifdef VTUNE_ENABLED
-	if(iJIT_IsProfilingActive() == iJIT_SAMPLING_ON)
-	{
-		iJIT_Method_Load jmethod = {};
-		jmethod.method_id = iJIT_GetNewMethodID();
-		jmethod.class_file_name = "";
-		jmethod.source_file_name = __FILE__;
-
-		jmethod.method_load_address = m_function.GetCode();
-		jmethod.method_size = m_function.GetSize();
-		jmethod.line_number_size = 0;
-
-		auto functionName = string_format("BasicBlock_0x%08X_0x%08X", m_begin, m_end);
-
-		jmethod.method_name = const_cast<char*>(functionName.c_str());
-		iJIT_NotifyEvent(iJVM_EVENT_TYPE_METHOD_LOAD_FINISHED, reinterpret_cast<void*>(&jmethod));
-	}
-#endif
-
+	CompileFunction(nullptr, 0);
 #endif
 
 #ifdef AOT_ENABLED
@@ -190,6 +144,106 @@ void CBasicBlock::Compile()
 #endif
 }
 
+void CBasicBlock::CompileWithCodeCache(CJitCodeCache& codeCache, uint32 checksum)
+{
+#ifdef AOT_ENABLED
+	Compile();
+#else
+	assert(!IsEmpty());
+#ifdef DEBUGGER_INCLUDED
+	//Breakpoint checks are compiled inside the block, don't share these
+	if(HasBreakpoint())
+	{
+		CompileFunction(nullptr, 0);
+		return;
+	}
+#endif
+	AOT_BLOCK_KEY key = {checksum, m_begin, m_end};
+	std::vector<uint8> code;
+	CJitCodeCache::SymbolRefArray symbolRefs;
+	if(codeCache.GetBlock(key, code, symbolRefs))
+	{
+		for(const auto& symbolRef : symbolRefs)
+		{
+			HandleExternalFunctionReference(symbolRef.symbol, symbolRef.offset, Jitter::CCodeGen::SYMBOL_REF_TYPE::NATIVE_POINTER);
+		}
+		m_function = CJitFunction(code.data(), code.size(), m_codeArenaClient);
+	}
+	else
+	{
+		CompileFunction(&codeCache, checksum);
+	}
+#endif
+}
+
+#ifndef AOT_USE_CACHE
+
+void CBasicBlock::CompileFunction(CJitCodeCache* codeCache, uint32 checksum)
+{
+	Framework::CMemStream stream;
+	CJitCodeCache::SymbolRefArray symbolRefs;
+	bool cacheable = true;
+	{
+		//Blocks can be compiled from multiple threads (AOT cache builder, speculative compiler)
+		static thread_local CMipsJitter* jitter = nullptr;
+		if(jitter == nullptr)
+		{
+			Jitter::CCodeGen* codeGen = Jitter::CreateCodeGen();
+			jitter = new CMipsJitter(codeGen);
+
+			for(unsigned int i = 0; i < 4; i++)
+			{
+				jitter->SetVariableAsConstant(
+				    offsetof(CMIPS, m_State.nGPR[CMIPS::R0].nV[i]),
+				    0);
+			}
+		}
+
+		jitter->GetCodeGen()->SetExternalSymbolReferencedHandler(
+		    [&](auto symbol, auto offset, auto refType) {
+			    if(refType != Jitter::CCodeGen::SYMBOL_REF_TYPE::NATIVE_POINTER)
+			    {
+				    cacheable = false;
+			    }
+			    symbolRefs.push_back({symbol, offset});
+			    this->HandleExternalFunctionReference(symbol, offset, refType);
+		    });
+		jitter->SetStream(&stream);
+		jitter->Begin();
+		CompileRange(jitter);
+		jitter->End();
+	}
+
+	m_function = CJitFunction(stream.GetBuffer(), stream.GetSize(), m_codeArenaClient);
+
+	if(codeCache && cacheable)
+	{
+		AOT_BLOCK_KEY key = {checksum, m_begin, m_end};
+		codeCache->PutBlock(key, stream.GetBuffer(), stream.GetSize(), symbolRefs);
+	}
+
+#ifdef VTUNE_ENABLED
+	if(iJIT_IsProfilingActive() == iJIT_SAMPLING_ON)
+	{
+		iJIT_Method_Load jmethod = {};
+		jmethod.method_id = iJIT_GetNewMethodID();
+		jmethod.class_file_name = "";
+		jmethod.source_file_name = __FILE__;
+
+		jmethod.method_load_address = m_function.GetCode();
+		jmethod.method_size = m_function.GetSize();
+		jmethod.line_number_size = 0;
+
+		auto functionName = string_format("BasicBlock_0x%08X_0x%08X", m_begin, m_end);
+
+		jmethod.method_name = const_cast<char*>(functionName.c_str());
+		iJIT_NotifyEvent(iJVM_EVENT_TYPE_METHOD_LOAD_FINISHED, reinterpret_cast<void*>(&jmethod));
+	}
+#endif
+}
+
+#endif
+
 void CBasicBlock::CompileRange(CMipsJitter* jitter)
 {
 	if(IsEmpty())
@@ -202,10 +256,10 @@ void CBasicBlock::CompileRange(CMipsJitter* jitter)
 
 	for(uint32 address = m_begin; address <= m_end; address += 4)
 	{
-		m_context.m_pArch->CompileInstruction(
+		m_compileContext->m_pArch->CompileInstruction(
 		    address,
 		    jitter,
-		    &m_context);
+		    m_compileContext);
 		//Sanity check
 		assert(jitter->IsStackEmpty());
 	}
@@ -341,6 +395,16 @@ void CBasicBlock::SetRecycleCount(uint32 recycleCount)
 	m_recycleCount = recycleCount;
 }
 
+void CBasicBlock::SetCompileContext(CMIPS* compileContext)
+{
+	m_compileContext = compileContext;
+}
+
+void CBasicBlock::SetCodeArenaClient(CJitCodeArena::CClient* codeArenaClient)
+{
+	m_codeArenaClient = codeArenaClient;
+}
+
 uint32 CBasicBlock::GetLinkTargetAddress(LINK_SLOT linkSlot)
 {
 	assert(linkSlot < LINK_SLOT_MAX);
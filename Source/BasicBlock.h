@@ -1,7 +1,7 @@
 #pragma once
 
 #include "MIPS.h"
-#include "MemoryFunction.h"
+#include "JitCodeArena.h"
 #ifdef AOT_BUILD_CACHE
 #include "StdStream.h"
 #include <mutex>
@@ -40,6 +40,8 @@ namespace Jitter
 	class CJitter;
 };
 
+class CJitCodeCache;
+
 extern "C"
 {
 	void EmptyBlockHandler(CMIPS*);
@@ -60,6 +62,7 @@ public:
 	virtual ~CBasicBlock() = default;
 	void Execute();
 	void Compile();
+	void CompileWithCodeCache(CJitCodeCache&, uint32);
 	virtual void CompileRange(CMipsJitter*);
 
 	uint32 GetBeginAddress() const;
@@ -70,6 +73,12 @@ public:
 	uint32 GetRecycleCount() const;
 	void SetRecycleCount(uint32);
 
+	//Instructions are compiled with this context's architecture objects, it must share its memory with the block's context
+	void SetCompileContext(CMIPS*);
+
+	//Generated code is accounted to this client of the code arena
+	void SetCodeArenaClient(CJitCodeArena::CClient*);
+
 	uint32 GetLinkTargetAddress(LINK_SLOT);
 	void SetLinkTargetAddress(LINK_SLOT, uint32);
 	void LinkBlock(LINK_SLOT, CBasicBlock*);
@@ -83,11 +92,16 @@ protected:
 	uint32 m_begin;
 	uint32 m_end;
 	CMIPS& m_context;
+	CMIPS* m_compileContext = nullptr;
+	CJitCodeArena::CClient* m_codeArenaClient = nullptr;
 
 	void CompileProlog(CMipsJitter*);
 	void CompileEpilog(CMipsJitter*);
 
 private:
+#ifndef AOT_USE_CACHE
+	void CompileFunction(CJitCodeCache*, uint32);
+#endif
 	void HandleExternalFunctionReference(uintptr_t, uint32, Jitter::CCodeGen::SYMBOL_REF_TYPE);
 
 #ifdef DEBUGGER_INCLUDED
@@ -102,7 +116,7 @@ private:
 #endif
 
 #ifndef AOT_USE_CACHE
-	CMemoryFunction m_function;
+	CJitFunction m_function;
 #else
 	void (*m_function)(void*);
 #endif
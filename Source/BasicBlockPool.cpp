@@ -0,0 +1,62 @@
+#include <cassert>
+#include "BasicBlockPool.h"
+
+CBasicBlockPool& CBasicBlockPool::GetInstance()
+{
+	static auto instance = new CBasicBlockPool();
+	return *instance;
+}
+
+void* CBasicBlockPool::Allocate(size_t size)
+{
+	if(size > MAX_CHUNK_SIZE)
+	{
+		return ::operator new(size);
+	}
+	unsigned int sizeClass = (size - 1) / CHUNK_GRANULARITY;
+	size_t chunkSize = (sizeClass + 1) * CHUNK_GRANULARITY;
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_stats.allocationCount++;
+	m_stats.liveCount++;
+	auto& freeChunk = m_freeChunks[sizeClass];
+	if(freeChunk)
+	{
+		auto result = freeChunk;
+		freeChunk = freeChunk->next;
+		m_stats.reusedCount++;
+		return result;
+	}
+	//Fill the free list with a new slab, the first chunk is returned
+	m_slabs.emplace_back(new uint8[SLAB_SIZE]);
+	auto slab = m_slabs.back().get();
+	m_stats.slabBytes += SLAB_SIZE;
+	for(size_t offset = chunkSize; (offset + chunkSize) <= SLAB_SIZE; offset += chunkSize)
+	{
+		auto chunk = reinterpret_cast<FREE_CHUNK*>(slab + offset);
+		chunk->next = freeChunk;
+		freeChunk = chunk;
+	}
+	return slab;
+}
+
+void CBasicBlockPool::Free(void* ptr, size_t size)
+{
+	if(size > MAX_CHUNK_SIZE)
+	{
+		::operator delete(ptr);
+		return;
+	}
+	unsigned int sizeClass = (size - 1) / CHUNK_GRANULARITY;
+	std::lock_guard<std::mutex> lock(m_mutex);
+	assert(m_stats.liveCount != 0);
+	m_stats.liveCount--;
+	auto chunk = reinterpret_cast<FREE_CHUNK*>(ptr);
+	chunk->next = m_freeChunks[sizeClass];
+	m_freeChunks[sizeClass] = chunk;
+}
+
+CBasicBlockPool::STATS CBasicBlockPool::GetStats() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_stats;
+}
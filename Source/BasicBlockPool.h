@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "Types.h"
+
+//Fixed size chunks for basic block metadata (block object and shared_ptr control block).
+//Chunks are carved out of slabs and recycled through per size class free lists,
+//blocks are created and destroyed in large numbers when code gets invalidated.
+class CBasicBlockPool
+{
+public:
+	enum
+	{
+		CHUNK_GRANULARITY = 0x40,
+		MAX_CHUNK_SIZE = 0x800,
+		SIZE_CLASS_COUNT = MAX_CHUNK_SIZE / CHUNK_GRANULARITY,
+		SLAB_SIZE = 0x10000,
+	};
+
+	struct STATS
+	{
+		uint64 slabBytes = 0;
+		uint32 liveCount = 0;
+		uint32 allocationCount = 0;
+		uint32 reusedCount = 0;
+	};
+
+	//Never destroyed, blocks can outlive static destruction
+	static CBasicBlockPool& GetInstance();
+
+	void* Allocate(size_t);
+	void Free(void*, size_t);
+
+	STATS GetStats() const;
+
+private:
+	struct FREE_CHUNK
+	{
+		FREE_CHUNK* next;
+	};
+
+	CBasicBlockPool() = default;
+
+	mutable std::mutex m_mutex;
+	FREE_CHUNK* m_freeChunks[SIZE_CLASS_COUNT] = {};
+	std::vector<std::unique_ptr<uint8[]>> m_slabs;
+	STATS m_stats;
+};
+
+template <typename Type>
+class CBasicBlockAllocator
+{
+public:
+	typedef Type value_type;
+
+	CBasicBlockAllocator() = default;
+
+	template <typename OtherType>
+	CBasicBlockAllocator(const CBasicBlockAllocator<OtherType>&)
+	{
+	}
+
+	Type* allocate(size_t count)
+	{
+		return reinterpret_cast<Type*>(CBasicBlockPool::GetInstance().Allocate(count * sizeof(Type)));
+	}
+
+	void deallocate(Type* ptr, size_t count)
+	{
+		CBasicBlockPool::GetInstance().Free(ptr, count * sizeof(Type));
+	}
+
+	template <typename OtherType>
+	bool operator==(const CBasicBlockAllocator<OtherType>&) const
+	{
+		return true;
+	}
+
+	template <typename OtherType>
+	bool operator!=(const CBasicBlockAllocator<OtherType>&) const
+	{
+		return false;
+	}
+};
+
+template <typename BlockType, typename... Args>
+std::shared_ptr<BlockType> MakeBasicBlock(Args&&... args)
+{
+	return std::allocate_shared<BlockType>(CBasicBlockAllocator<BlockType>(), std::forward<Args>(args)...);
+}
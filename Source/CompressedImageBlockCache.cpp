@@ -0,0 +1,234 @@
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include "CompressedImageBlockCache.h"
+#include "Log.h"
+
+#define LOG_NAME ("compressedimageblockcache")
+
+//Number of sequential reads needed before prefetching starts
+static const uint32 SEQUENTIAL_THRESHOLD = 2;
+
+std::mutex CCompressedImageBlockCache::g_defaultConfigMutex;
+CCompressedImageBlockCache::CONFIG CCompressedImageBlockCache::g_defaultConfig;
+
+CCompressedImageBlockCache::CCompressedImageBlockCache(uint32 blockSize, uint32 blockCount, const ReadRawBlockFunction& readRawBlock, const DecompressBlockFunction& decompressBlock, const CONFIG& config)
+    : m_blockSize(blockSize)
+    , m_blockCount(blockCount)
+    , m_readRawBlock(readRawBlock)
+    , m_decompressBlock(decompressBlock)
+    , m_config(config)
+{
+	assert(m_blockSize != 0);
+	//Keep at least the block being read and the next one
+	m_maxEntries = std::max<uint32>(m_config.memoryBudget / m_blockSize, 2);
+	m_config.prefetchBlockCount = std::min<uint32>(m_config.prefetchBlockCount, m_maxEntries - 1);
+	if(m_config.prefetchBlockCount != 0)
+	{
+		for(uint32 i = 0; i < m_config.workerCount; i++)
+		{
+			m_workers.emplace_back([this]() { WorkerThreadProc(); });
+		}
+	}
+}
+
+CCompressedImageBlockCache::~CCompressedImageBlockCache()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_terminate = true;
+	}
+	m_workerCondition.notify_all();
+	for(auto& worker : m_workers)
+	{
+		worker.join();
+	}
+	if(m_stats.misses != 0)
+	{
+		CLog::GetInstance().Print(LOG_NAME, "%llu hits, %llu misses, %llu prefetches (%llu used, %llu waited for), %llu evictions.\r\n",
+		                          m_stats.hits, m_stats.misses, m_stats.prefetches, m_stats.prefetchHits, m_stats.prefetchWaits, m_stats.evictions);
+	}
+}
+
+CCompressedImageBlockCache::CONFIG CCompressedImageBlockCache::GetDefaultConfig()
+{
+	std::lock_guard<std::mutex> lock(g_defaultConfigMutex);
+	return g_defaultConfig;
+}
+
+void CCompressedImageBlockCache::SetDefaultConfig(const CONFIG& config)
+{
+	std::lock_guard<std::mutex> lock(g_defaultConfigMutex);
+	g_defaultConfig = config;
+}
+
+CCompressedImageBlockCache::STATS CCompressedImageBlockCache::GetStats() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_stats;
+}
+
+void CCompressedImageBlockCache::Read(uint32 blockIndex, uint32 offset, uint8* dest, uint32 size)
+{
+	assert(blockIndex < m_blockCount);
+	assert((offset + size) <= m_blockSize);
+
+	LockType lock(m_mutex);
+
+	if(blockIndex == (m_lastBlock + 1))
+	{
+		m_sequentialCount++;
+	}
+	else if(blockIndex != m_lastBlock)
+	{
+		m_sequentialCount = 0;
+	}
+	m_lastBlock = blockIndex;
+
+	auto& entry = AcquireEntry(blockIndex, lock);
+	if(entry.state == ENTRY_STATE::FAILED)
+	{
+		auto error = entry.error;
+		Evict(blockIndex);
+		std::rethrow_exception(error);
+	}
+	assert(entry.state == ENTRY_STATE::READY);
+	memcpy(dest, entry.data.data() + offset, size);
+
+	if(m_sequentialCount >= SEQUENTIAL_THRESHOLD)
+	{
+		uint32 prefetchEnd = std::min<uint32>(blockIndex + 1 + m_config.prefetchBlockCount, m_blockCount);
+		for(uint32 prefetchIndex = blockIndex + 1; prefetchIndex < prefetchEnd; prefetchIndex++)
+		{
+			Prefetch(prefetchIndex);
+		}
+	}
+
+	//Drop least recently used blocks, blocks still being prefetched are kept
+	while((m_entries.size() > m_maxEntries) && !m_lru.empty())
+	{
+		Evict(m_lru.back());
+		m_stats.evictions++;
+	}
+}
+
+CCompressedImageBlockCache::ENTRY& CCompressedImageBlockCache::AcquireEntry(uint32 blockIndex, LockType& lock)
+{
+	auto entryIterator = m_entries.find(blockIndex);
+	if(entryIterator == std::end(m_entries))
+	{
+		m_stats.misses++;
+		auto& entry = m_entries[blockIndex];
+		LoadEntry(blockIndex, entry, lock);
+		return entry;
+	}
+
+	auto& entry = entryIterator->second;
+	switch(entry.state)
+	{
+	case ENTRY_STATE::QUEUED:
+		//Not picked up by a worker yet, do it ourselves
+		m_stats.misses++;
+		m_prefetchQueue.erase(std::find(std::begin(m_prefetchQueue), std::end(m_prefetchQueue), blockIndex));
+		LoadEntry(blockIndex, entry, lock);
+		return entry;
+	case ENTRY_STATE::DECOMPRESSING:
+		m_stats.prefetchWaits++;
+		m_entryCondition.wait(lock, [&entry]() { return entry.state != ENTRY_STATE::DECOMPRESSING; });
+		break;
+	default:
+		break;
+	}
+
+	if(entry.state == ENTRY_STATE::READY)
+	{
+		m_stats.hits++;
+		if(entry.prefetched)
+		{
+			m_stats.prefetchHits++;
+			entry.prefetched = false;
+		}
+		m_lru.splice(std::begin(m_lru), m_lru, entry.lruIterator);
+	}
+	return entry;
+}
+
+//Reads and decompresses a block, called with the lock held and returns with it held
+void CCompressedImageBlockCache::LoadEntry(uint32 blockIndex, ENTRY& entry, LockType& lock)
+{
+	entry.state = ENTRY_STATE::DECOMPRESSING;
+	lock.unlock();
+
+	std::vector<uint8> data;
+	std::exception_ptr error;
+	try
+	{
+		RawBlock rawBlock;
+		{
+			std::lock_guard<std::mutex> baseStreamLock(m_baseStreamMutex);
+			m_readRawBlock(blockIndex, rawBlock);
+		}
+		data.resize(m_blockSize);
+		m_decompressBlock(blockIndex, rawBlock, data.data());
+	}
+	catch(...)
+	{
+		error = std::current_exception();
+	}
+
+	lock.lock();
+	//Entries being decompressed are never evicted, the reference is still valid
+	if(error)
+	{
+		entry.state = ENTRY_STATE::FAILED;
+		entry.error = error;
+		entry.lruIterator = m_lru.end();
+	}
+	else
+	{
+		entry.state = ENTRY_STATE::READY;
+		entry.data = std::move(data);
+		m_lru.push_front(blockIndex);
+		entry.lruIterator = std::begin(m_lru);
+	}
+	m_entryCondition.notify_all();
+}
+
+void CCompressedImageBlockCache::Prefetch(uint32 blockIndex)
+{
+	if(m_entries.find(blockIndex) != std::end(m_entries)) return;
+	auto& entry = m_entries[blockIndex];
+	entry.prefetched = true;
+	m_prefetchQueue.push_back(blockIndex);
+	m_stats.prefetches++;
+	m_workerCondition.notify_one();
+}
+
+void CCompressedImageBlockCache::Evict(uint32 blockIndex)
+{
+	auto entryIterator = m_entries.find(blockIndex);
+	assert(entryIterator != std::end(m_entries));
+	auto& entry = entryIterator->second;
+	assert((entry.state == ENTRY_STATE::READY) || (entry.state == ENTRY_STATE::FAILED));
+	if(entry.state == ENTRY_STATE::READY)
+	{
+		m_lru.erase(entry.lruIterator);
+	}
+	m_entries.erase(entryIterator);
+}
+
+void CCompressedImageBlockCache::WorkerThreadProc()
+{
+	LockType lock(m_mutex);
+	while(true)
+	{
+		m_workerCondition.wait(lock, [this]() { return m_terminate || !m_prefetchQueue.empty(); });
+		if(m_terminate) break;
+
+		uint32 blockIndex = m_prefetchQueue.front();
+		m_prefetchQueue.pop_front();
+		auto entryIterator = m_entries.find(blockIndex);
+		assert(entryIterator != std::end(m_entries));
+		LoadEntry(blockIndex, entryIterator->second, lock);
+	}
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "Types.h"
+
+//LRU cache of decompressed blocks (frames) used by compressed disc image streams.
+//When blocks are read sequentially, the blocks that follow are read and decompressed ahead
+//of time on worker threads. The base stream is only accessed by one thread at a time, but
+//decompression of several blocks can happen in parallel.
+class CCompressedImageBlockCache
+{
+public:
+	typedef std::vector<uint8> RawBlock;
+
+	//Reads the data of a block as stored in the image, the base stream is locked while this runs
+	typedef std::function<void(uint32, RawBlock&)> ReadRawBlockFunction;
+	//Turns raw block data into a full decompressed block, can run concurrently
+	typedef std::function<void(uint32, const RawBlock&, uint8*)> DecompressBlockFunction;
+
+	struct CONFIG
+	{
+		uint32 memoryBudget = 16 * 1024 * 1024;
+		uint32 prefetchBlockCount = 8;
+		uint32 workerCount = 2;
+	};
+
+	struct STATS
+	{
+		uint64 hits = 0;
+		uint64 misses = 0;
+		uint64 prefetches = 0;
+		uint64 prefetchHits = 0;
+		//Requests for blocks that were being prefetched
+		uint64 prefetchWaits = 0;
+		uint64 evictions = 0;
+	};
+
+	CCompressedImageBlockCache(uint32, uint32, const ReadRawBlockFunction&, const DecompressBlockFunction&, const CONFIG& = GetDefaultConfig());
+	virtual ~CCompressedImageBlockCache();
+
+	CCompressedImageBlockCache(const CCompressedImageBlockCache&) = delete;
+	CCompressedImageBlockCache& operator=(const CCompressedImageBlockCache&) = delete;
+
+	//Copies data from a block, errors from reading or decompressing that block are rethrown here
+	void Read(uint32, uint32, uint8*, uint32);
+
+	STATS GetStats() const;
+
+	static CONFIG GetDefaultConfig();
+	static void SetDefaultConfig(const CONFIG&);
+
+private:
+	enum class ENTRY_STATE
+	{
+		QUEUED,
+		DECOMPRESSING,
+		READY,
+		FAILED,
+	};
+
+	struct ENTRY
+	{
+		ENTRY_STATE state = ENTRY_STATE::QUEUED;
+		bool prefetched = false;
+		std::vector<uint8> data;
+		std::exception_ptr error;
+		std::list<uint32>::iterator lruIterator;
+	};
+
+	typedef std::unordered_map<uint32, ENTRY> EntryMap;
+	typedef std::unique_lock<std::mutex> LockType;
+
+	ENTRY& AcquireEntry(uint32, LockType&);
+	void LoadEntry(uint32, ENTRY&, LockType&);
+	void Prefetch(uint32);
+	void Evict(uint32);
+	void WorkerThreadProc();
+
+	uint32 m_blockSize = 0;
+	uint32 m_blockCount = 0;
+	ReadRawBlockFunction m_readRawBlock;
+	DecompressBlockFunction m_decompressBlock;
+	CONFIG m_config;
+	uint32 m_maxEntries = 0;
+
+	mutable std::mutex m_mutex;
+	std::condition_variable m_entryCondition;
+	std::condition_variable m_workerCondition;
+	EntryMap m_entries;
+	//Most recently used blocks first, only contains blocks that are ready
+	std::list<uint32> m_lru;
+	std::deque<uint32> m_prefetchQueue;
+	uint32 m_lastBlock = ~0U;
+	uint32 m_sequentialCount = 0;
+	bool m_terminate = false;
+	STATS m_stats;
+
+	std::mutex m_baseStreamMutex;
+	std::vector<std::thread> m_workers;
+
+	static std::mutex g_defaultConfigMutex;
+	static CONFIG g_defaultConfig;
+};
@@ -8,8 +8,6 @@
 typedef uint32 uint32_le;
 typedef uint64 uint64_le;
 
-static const uint32 CSO_READ_BUFFER_SIZE = 256 * 1024;
-
 struct CsoHeader
 {
 	uint8 magic[4];
@@ -23,8 +21,6 @@ struct CsoHeader
 
 CCsoImageStream::CCsoImageStream(CStream* baseStream)
     : m_baseStream(baseStream)
-    , m_readBuffer(nullptr)
-    , m_zlibBuffer(nullptr)
     , m_index(nullptr)
     , m_position(0)
 {
@@ -39,8 +35,8 @@ CCsoImageStream::CCsoImageStream(CStream* baseStream)
 
 CCsoImageStream::~CCsoImageStream()
 {
-	delete[] m_readBuffer;
-	delete[] m_zlibBuffer;
+	// Stop prefetching before anything it uses goes away.
+	m_frameCache.reset();
 	delete[] m_index;
 }
 
@@ -88,24 +84,17 @@ void CCsoImageStream::InitializeBuffers()
 {
 	uint32 numFrames = static_cast<uint32>((m_totalSize + m_frameSize - 1) / m_frameSize);
 
-	// We might read a bit of alignment too, so be prepared.
-	if(m_frameSize + (1 << m_indexShift) < CSO_READ_BUFFER_SIZE)
-	{
-		m_readBuffer = new uint8[CSO_READ_BUFFER_SIZE];
-	}
-	else
-	{
-		m_readBuffer = new uint8[m_frameSize + (1 << m_indexShift)];
-	}
-	m_zlibBuffer = new uint8[m_frameSize + (1 << m_indexShift)];
-	m_zlibBufferFrame = numFrames;
-
 	const uint32 indexSize = numFrames + 1;
 	m_index = new uint32[indexSize];
 	if(m_baseStream->Read(m_index, sizeof(uint32) * indexSize) != sizeof(uint32) * indexSize)
 	{
 		throw std::runtime_error("Unable to read CSO index.");
 	}
+
+	m_frameCache = std::make_unique<CCompressedImageBlockCache>(
+	    m_frameSize, numFrames,
+	    [this](uint32 frame, CCompressedImageBlockCache::RawBlock& rawFrame) { ReadRawFrame(frame, rawFrame); },
+	    [this](uint32 frame, const CCompressedImageBlockCache::RawBlock& rawFrame, uint8* dest) { DecompressFrame(frame, rawFrame, dest); });
 }
 
 void CCsoImageStream::Seek(int64 position, Framework::STREAM_SEEK_DIRECTION origin)
@@ -170,6 +159,14 @@ uint32 CCsoImageStream::ReadFromNextFrame(uint8* dest, uint64 maxBytes)
 	// This is how many bytes we will actually be reading from this frame.
 	const uint32 bytes = static_cast<uint32>(std::min(maxBytes, static_cast<uint64>(m_frameSize - offset)));
 
+	// Frames (compressed or not) go through the cache, which also reads ahead when reading sequentially.
+	m_frameCache->Read(frame, offset, dest, bytes);
+
+	return bytes;
+}
+
+void CCsoImageStream::ReadRawFrame(uint32 frame, CCompressedImageBlockCache::RawBlock& rawFrame)
+{
 	// Grab the index data for the frame we're about to read.
 	const bool compressed = (m_index[frame + 0] & 0x80000000) == 0;
 	const uint32 index0 = m_index[frame + 0] & 0x7FFFFFFF;
@@ -177,36 +174,31 @@ uint32 CCsoImageStream::ReadFromNextFrame(uint8* dest, uint64 maxBytes)
 
 	// Calculate where the compressed payload is (if compressed.)
 	const uint64 frameRawPos = static_cast<uint64>(index0) << m_indexShift;
-	const uint64 frameRawSize = (index1 - index0) << m_indexShift;
+	const uint64 frameRawSize = compressed ? (static_cast<uint64>(index1 - index0) << m_indexShift) : m_frameSize;
+
+	// This might be less bytes than frameRawSize in case of padding on the last frame.
+	// This is because the index positions must be aligned.
+	rawFrame.resize(frameRawSize);
+	const uint64 readRawBytes = ReadBaseAt(frameRawPos, rawFrame.data(), frameRawSize);
+	rawFrame.resize(readRawBytes);
+}
 
+void CCsoImageStream::DecompressFrame(uint32 frame, const CCompressedImageBlockCache::RawBlock& rawFrame, uint8* dest)
+{
+	const bool compressed = (m_index[frame + 0] & 0x80000000) == 0;
 	if(!compressed)
 	{
-		// Just read directly, easy.
-		if(ReadBaseAt(frameRawPos + offset, dest, bytes) != bytes)
+		// Just copy, easy. The last frame might be shorter than the others.
+		const uint64 frameBytes = std::min<uint64>(m_frameSize, GetTotalSize() - (static_cast<uint64>(frame) << m_frameShift));
+		if(rawFrame.size() < frameBytes)
 		{
 			throw std::runtime_error("Unable to read uncompressed bytes from CSO.");
 		}
+		memcpy(dest, rawFrame.data(), frameBytes);
+		memset(dest + frameBytes, 0, m_frameSize - frameBytes);
+		return;
 	}
-	else
-	{
-		// We don't need to decompress if we already did this same frame last time.
-		if(m_zlibBufferFrame != frame)
-		{
-			// This might be less bytes than frameRawSize in case of padding on the last frame.
-			// This is because the index positions must be aligned.
-			const uint64 readRawBytes = ReadBaseAt(frameRawPos, m_readBuffer, frameRawSize);
-			DecompressFrame(frame, readRawBytes);
-		}
 
-		// Now we just copy the offset data from the cache.
-		memcpy(dest, m_zlibBuffer + offset, bytes);
-	}
-
-	return bytes;
-}
-
-void CCsoImageStream::DecompressFrame(uint32 frame, uint64 readBufferSize)
-{
 	z_stream z;
 	z.zalloc = Z_NULL;
 	z.zfree = Z_NULL;
@@ -216,9 +208,9 @@ void CCsoImageStream::DecompressFrame(uint32 frame, uint64 readBufferSize)
 		throw std::runtime_error("Unable to initialize zlib for CSO decompression.");
 	}
 
-	z.next_in = m_readBuffer;
-	z.avail_in = static_cast<uint32>(readBufferSize);
-	z.next_out = m_zlibBuffer;
+	z.next_in = const_cast<Bytef*>(rawFrame.data());
+	z.avail_in = static_cast<uint32>(rawFrame.size());
+	z.next_out = dest;
 	z.avail_out = m_frameSize;
 
 	int status = inflate(&z, Z_FINISH);
@@ -228,9 +220,6 @@ void CCsoImageStream::DecompressFrame(uint32 frame, uint64 readBufferSize)
 		throw std::runtime_error("Unable to decompress CSO frame using zlib.");
 	}
 	inflateEnd(&z);
-
-	// Our buffer now contains this frame.
-	m_zlibBufferFrame = frame;
 }
 
 uint64 CCsoImageStream::ReadBaseAt(uint64 pos, uint8* dest, uint64 bytes)
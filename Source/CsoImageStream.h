@@ -1,7 +1,9 @@
 #pragma once
 
+#include <memory>
 #include "Types.h"
 #include "Stream.h"
+#include "CompressedImageBlockCache.h"
 
 class CCsoImageStream : public Framework::CStream
 {
@@ -21,15 +23,14 @@ private:
 	uint64 GetTotalSize() const;
 	uint32 ReadFromNextFrame(uint8* dest, uint64 maxBytes);
 	uint64 ReadBaseAt(uint64 pos, uint8* dest, uint64 bytes);
-	void DecompressFrame(uint32 frame, uint64 readBufferSize);
+	void ReadRawFrame(uint32 frame, CCompressedImageBlockCache::RawBlock& rawFrame);
+	void DecompressFrame(uint32 frame, const CCompressedImageBlockCache::RawBlock& rawFrame, uint8* dest);
 
 	Framework::CStream* m_baseStream;
 	uint32 m_frameSize;
 	uint8 m_frameShift;
 	uint8 m_indexShift;
-	uint8* m_readBuffer;
-	uint8* m_zlibBuffer;
-	uint32 m_zlibBufferFrame;
+	std::unique_ptr<CCompressedImageBlockCache> m_frameCache;
 	uint32* m_index;
 	uint64 m_totalSize;
 	uint64 m_position;
@@ -0,0 +1,610 @@
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include "FastMemoryArena.h"
+#include "MIPS.h"
+#include "Log.h"
+
+#ifdef FASTMEMORY_SUPPORTED
+#include <sys/mman.h>
+#include <ucontext.h>
+#include <unistd.h>
+#endif
+
+#define LOG_NAME "fastmemory"
+
+//EE and IOP each use an arena, leaves room for several virtual machines in the same process
+#define ARENA_COUNT 32
+
+//Guest address space is mapped at [base, base + 4GB[. Views above 0x80000000 are also mapped at
+//[base - 2GB, base[ to be independent of the way 32-bit offsets are extended by the code generator.
+static const uint64 g_lowerMirrorSize = 0x80000000ULL;
+static const uint64 g_reservationSize = 0x100000000ULL + g_lowerMirrorSize;
+static const uint32 g_hostPageSize = 0x1000;
+
+struct ARENA_SLOT
+{
+	std::atomic<CFastMemoryArena*> arena;
+	//Fault handlers currently using the arena, it can't be destroyed before this drops to 0
+	std::atomic<uint32> handlerCount;
+};
+
+static ARENA_SLOT g_arenas[ARENA_COUNT];
+
+CFastMemoryArena::CFastMemoryArena()
+{
+#ifdef FASTMEMORY_SUPPORTED
+	void* reservation = mmap(nullptr, g_reservationSize, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if(reservation == MAP_FAILED)
+	{
+		throw std::runtime_error("Failed to reserve address space for fast memory.");
+	}
+	m_reservation = reinterpret_cast<uint8*>(reservation);
+	m_base = m_reservation + g_lowerMirrorSize;
+
+	bool registered = false;
+	for(auto& slot : g_arenas)
+	{
+		CFastMemoryArena* expected = nullptr;
+		if(slot.arena.compare_exchange_strong(expected, this))
+		{
+			registered = true;
+			break;
+		}
+	}
+	if(!registered)
+	{
+		munmap(m_reservation, g_reservationSize);
+		throw std::runtime_error("Too many fast memory arenas.");
+	}
+#else
+	throw std::runtime_error("Fast memory is not supported on this platform.");
+#endif
+}
+
+CFastMemoryArena::~CFastMemoryArena()
+{
+#ifdef FASTMEMORY_SUPPORTED
+	for(auto& slot : g_arenas)
+	{
+		CFastMemoryArena* expected = this;
+		if(slot.arena.compare_exchange_strong(expected, nullptr))
+		{
+			while(slot.handlerCount != 0)
+			{
+				std::this_thread::yield();
+			}
+			break;
+		}
+	}
+	CLog::GetInstance().Print(LOG_NAME, "%d accesses emulated after faults, %d slow access ranges.\r\n",
+	                          m_faultCount, static_cast<uint32>(m_slowAccessRanges.size()));
+	if(m_context)
+	{
+		m_context->m_fastMemory = nullptr;
+		m_context->m_fastMemoryBase = nullptr;
+	}
+	munmap(m_reservation, g_reservationSize);
+	for(const auto& allocation : m_allocations)
+	{
+		munmap(allocation.memory, allocation.size);
+		close(allocation.fd);
+	}
+#endif
+}
+
+bool CFastMemoryArena::IsSupported()
+{
+#ifdef FASTMEMORY_SUPPORTED
+	return true;
+#else
+	return false;
+#endif
+}
+
+uint8* CFastMemoryArena::AllocateMemory(uint32 size)
+{
+#ifdef FASTMEMORY_SUPPORTED
+	ALLOCATION allocation;
+	allocation.size = (size + g_hostPageSize - 1) & ~(g_hostPageSize - 1);
+	allocation.fd = memfd_create("fastmemory", MFD_CLOEXEC);
+	if(allocation.fd < 0)
+	{
+		throw std::runtime_error("Failed to create fast memory backing.");
+	}
+	if(ftruncate(allocation.fd, allocation.size) < 0)
+	{
+		close(allocation.fd);
+		throw std::runtime_error("Failed to resize fast memory backing.");
+	}
+	void* memory = mmap(nullptr, allocation.size, PROT_READ | PROT_WRITE, MAP_SHARED, allocation.fd, 0);
+	if(memory == MAP_FAILED)
+	{
+		close(allocation.fd);
+		throw std::runtime_error("Failed to map fast memory backing.");
+	}
+	allocation.memory = reinterpret_cast<uint8*>(memory);
+	m_allocations.push_back(allocation);
+	return allocation.memory;
+#else
+	return nullptr;
+#endif
+}
+
+//Maps [memory, memory + size[ at address. Memory must come from AllocateMemory.
+void CFastMemoryArena::MapMemory(uint32 address, uint8* memory, uint32 size, bool writable)
+{
+	assert((address % g_hostPageSize) == 0);
+	assert((size % g_hostPageSize) == 0);
+	assert(FindAllocation(memory) != nullptr);
+
+	VIEW view;
+	view.address = address;
+	view.size = size;
+	view.memory = memory;
+	view.writable = writable;
+
+	MapView(m_base + address, view);
+	if(address >= g_lowerMirrorSize)
+	{
+		MapView(m_base + address - 0x100000000LL, view);
+	}
+
+	//Page tables can be set up again, views at the same address replace the previous ones
+	auto viewIterator = std::find_if(m_views.begin(), m_views.end(), [address](const VIEW& view) { return view.address == address; });
+	if(viewIterator != m_views.end())
+	{
+		*viewIterator = view;
+	}
+	else
+	{
+		m_views.push_back(view);
+	}
+}
+
+void CFastMemoryArena::MapView(uint8* hostAddress, const VIEW& view)
+{
+#ifdef FASTMEMORY_SUPPORTED
+	auto allocation = FindAllocation(view.memory);
+	assert((view.memory + view.size) <= (allocation->memory + allocation->size));
+	int protection = view.writable ? (PROT_READ | PROT_WRITE) : PROT_READ;
+	off_t offset = view.memory - allocation->memory;
+	void* result = mmap(hostAddress, view.size, protection, MAP_SHARED | MAP_FIXED, allocation->fd, offset);
+	if(result == MAP_FAILED)
+	{
+		throw std::runtime_error("Failed to map fast memory view.");
+	}
+#endif
+}
+
+//Applies protection to all views of [memory, memory + size[, the original mapping is handled by the caller
+void CFastMemoryArena::SetMemoryProtected(uint8* memory, size_t size, bool protect)
+{
+#ifdef FASTMEMORY_SUPPORTED
+	for(const auto& view : m_views)
+	{
+		if(!view.writable) continue;
+		uint8* start = std::max(memory, view.memory);
+		uint8* end = std::min(memory + size, view.memory + view.size);
+		if(start >= end) continue;
+
+		uint64 viewOffset = start - view.memory;
+		uint64 hostOffset = static_cast<uint64>(view.address) + viewOffset;
+		int protection = protect ? PROT_READ : (PROT_READ | PROT_WRITE);
+		int result = mprotect(m_base + hostOffset, end - start, protection);
+		assert(result >= 0);
+		if(view.address >= g_lowerMirrorSize)
+		{
+			result = mprotect(m_base + hostOffset - 0x100000000LL, end - start, protection);
+			assert(result >= 0);
+		}
+	}
+#endif
+}
+
+//Returns where a host address inside of a view points to in the original mapping
+uint8* CFastMemoryArena::GetMemoryPointer(uintptr_t hostAddress) const
+{
+	if(!Contains(hostAddress)) return nullptr;
+	uint32 address = GetGuestAddress(hostAddress);
+	for(const auto& view : m_views)
+	{
+		if((address >= view.address) && ((address - view.address) < view.size))
+		{
+			return view.memory + (address - view.address);
+		}
+	}
+	return nullptr;
+}
+
+void CFastMemoryArena::Attach(CMIPS& context)
+{
+	assert(m_context == nullptr);
+	m_context = &context;
+	context.m_fastMemory = this;
+	context.m_fastMemoryBase = m_base;
+}
+
+bool CFastMemoryArena::IsFastAccessAllowed(uint32 address) const
+{
+	std::lock_guard<std::mutex> slowAccessRangesLock(m_slowAccessRangesMutex);
+	//Ranges come from blocks and can overlap, check all of those that start close enough
+	auto rangeIterator = m_slowAccessRanges.upper_bound(address);
+	while(rangeIterator != m_slowAccessRanges.begin())
+	{
+		rangeIterator--;
+		if(address <= rangeIterator->second) return false;
+		if((address - rangeIterator->first) > MAX_SLOW_ACCESS_RANGE_SIZE) break;
+	}
+	return true;
+}
+
+void CFastMemoryArena::AddSlowAccessRange(uint32 start, uint32 end)
+{
+	assert((end - start) <= MAX_SLOW_ACCESS_RANGE_SIZE);
+	std::lock_guard<std::mutex> slowAccessRangesLock(m_slowAccessRangesMutex);
+	auto& rangeEnd = m_slowAccessRanges[start];
+	rangeEnd = std::max(rangeEnd, end);
+}
+
+//Returns the addresses of blocks that faulted since the last call (value of PC when they faulted)
+uint32 CFastMemoryArena::TakeFaultedBlocks(uint32* blocks)
+{
+	uint32 count = m_faultedBlockCount;
+	memcpy(blocks, m_faultedBlocks, count * sizeof(uint32));
+	m_faultedBlockCount = 0;
+	return count;
+}
+
+bool CFastMemoryArena::Contains(uintptr_t hostAddress) const
+{
+	return (hostAddress >= reinterpret_cast<uintptr_t>(m_reservation)) &&
+	       ((hostAddress - reinterpret_cast<uintptr_t>(m_reservation)) < g_reservationSize);
+}
+
+uint32 CFastMemoryArena::GetGuestAddress(uintptr_t hostAddress) const
+{
+	return static_cast<uint32>(hostAddress - reinterpret_cast<uintptr_t>(m_base));
+}
+
+const CFastMemoryArena::ALLOCATION* CFastMemoryArena::FindAllocation(const uint8* memory) const
+{
+	for(const auto& allocation : m_allocations)
+	{
+		if((memory >= allocation.memory) && (memory < (allocation.memory + allocation.size)))
+		{
+			return &allocation;
+		}
+	}
+	return nullptr;
+}
+
+//Called from the SIGSEGV handler, only decodes the access and sends the thread to the slow access stub
+bool CFastMemoryArena::HandleAccessFault(uintptr_t hostAddress, void* hostContext)
+{
+	for(auto& slot : g_arenas)
+	{
+		if(!slot.arena.load()) continue;
+		slot.handlerCount++;
+		auto arena = slot.arena.load();
+		bool owned = arena && arena->Contains(hostAddress);
+		bool handled = owned && arena->BeginSlowAccess(hostAddress, hostContext);
+		slot.handlerCount--;
+		if(owned)
+		{
+			return handled;
+		}
+	}
+	return false;
+}
+
+#ifdef FASTMEMORY_SUPPORTED
+
+//Entered in place of the faulting instruction with RAX pointing to a SLOW_ACCESS_FRAME. Saves the
+//general purpose registers (indexed by their x86 encoding, the RSP slot holds the frame), flags and
+//SSE state, lets the arena complete the access on the registers, restores everything and resumes
+//after the faulting instruction. The red zone of the interrupted code is left untouched.
+extern "C" void FastMemoryArena_SlowAccessStub();
+
+// clang-format off
+asm(
+    ".text\n"
+    ".p2align 4\n"
+    ".globl FastMemoryArena_SlowAccessStub\n"
+    ".hidden FastMemoryArena_SlowAccessStub\n"
+    "FastMemoryArena_SlowAccessStub:\n"
+    ".intel_syntax noprefix\n"
+    "	lea rsp, [rsp - 128]\n"
+    "	push qword ptr [rax]\n"
+    "	pushfq\n"
+    "	push r15\n"
+    "	push r14\n"
+    "	push r13\n"
+    "	push r12\n"
+    "	push r11\n"
+    "	push r10\n"
+    "	push r9\n"
+    "	push r8\n"
+    "	push rdi\n"
+    "	push rsi\n"
+    "	push rbp\n"
+    "	push rax\n"
+    "	push rbx\n"
+    "	push rdx\n"
+    "	push rcx\n"
+    "	push qword ptr [rax + 8]\n"
+    "	mov rbx, rsp\n"
+    "	and rsp, -16\n"
+    "	sub rsp, 512\n"
+    "	fxsave [rsp]\n"
+    "	mov rax, [rbx + 32]\n"
+    "	mov rdi, [rax + 24]\n"
+    "	mov rsi, rbx\n"
+    "	call [rax + 16]\n"
+    "	fxrstor [rsp]\n"
+    "	mov rsp, rbx\n"
+    "	pop rax\n"
+    "	pop rcx\n"
+    "	pop rdx\n"
+    "	pop rbx\n"
+    "	lea rsp, [rsp + 8]\n"
+    "	pop rbp\n"
+    "	pop rsi\n"
+    "	pop rdi\n"
+    "	pop r8\n"
+    "	pop r9\n"
+    "	pop r10\n"
+    "	pop r11\n"
+    "	pop r12\n"
+    "	pop r13\n"
+    "	pop r14\n"
+    "	pop r15\n"
+    "	popfq\n"
+    "	ret 128\n"
+    ".att_syntax prefix\n");
+// clang-format on
+
+bool CFastMemoryArena::BeginSlowAccess(uintptr_t hostAddress, void* hostContext)
+{
+	static_assert(offsetof(SLOW_ACCESS_FRAME, resumeAddress) == 0, "Slow access stub expects the resume address at offset 0.");
+	static_assert(offsetof(SLOW_ACCESS_FRAME, savedRax) == 8, "Slow access stub expects RAX at offset 8.");
+	static_assert(offsetof(SLOW_ACCESS_FRAME, complete) == 16, "Slow access stub expects the handler at offset 16.");
+	static_assert(offsetof(SLOW_ACCESS_FRAME, arena) == 24, "Slow access stub expects the arena at offset 24.");
+
+	if(!m_context) return false;
+
+	auto context = reinterpret_cast<ucontext_t*>(hostContext);
+	auto& gregs = context->uc_mcontext.gregs;
+	auto code = reinterpret_cast<const uint8*>(gregs[REG_RIP]);
+
+	//Anything else isn't generated for guest accesses, let the fault go through
+	m_slowAccess = ACCESS();
+	if(!DecodeAccess(code, m_slowAccess)) return false;
+	m_slowAccessAddress = GetGuestAddress(hostAddress);
+
+	m_slowAccessFrame.resumeAddress = static_cast<uint64>(gregs[REG_RIP]) + m_slowAccess.length;
+	m_slowAccessFrame.savedRax = static_cast<uint64>(gregs[REG_RAX]);
+	m_slowAccessFrame.complete = &CFastMemoryArena::CompleteSlowAccess;
+	m_slowAccessFrame.arena = this;
+
+	gregs[REG_RAX] = reinterpret_cast<greg_t>(&m_slowAccessFrame);
+	gregs[REG_RIP] = reinterpret_cast<greg_t>(&FastMemoryArena_SlowAccessStub);
+	return true;
+}
+
+//Called by the slow access stub, outside of the signal handler
+void CFastMemoryArena::CompleteSlowAccess(CFastMemoryArena* arena, uint64* registers)
+{
+	const auto& access = arena->m_slowAccess;
+	auto context = arena->m_context;
+
+	//Arena is indexed by virtual address, memory map handlers expect physical addresses (ie.: kseg1 I/O accesses)
+	uint32 address = context->m_pAddrTranslator(context, arena->m_slowAccessAddress);
+	auto memoryMap = context->m_pMemoryMap;
+	auto& reg = registers[access.highByte ? (access.reg - 4) : access.reg];
+	if(access.isStore)
+	{
+		uint32 value = access.hasImmediate ? access.immediate : static_cast<uint32>(reg >> (access.highByte ? 8 : 0));
+		switch(access.size)
+		{
+		case 1:
+			memoryMap->SetByte(address, static_cast<uint8>(value));
+			break;
+		case 2:
+			memoryMap->SetHalf(address, static_cast<uint16>(value));
+			break;
+		case 4:
+			memoryMap->SetWord(address, value);
+			break;
+		}
+	}
+	else
+	{
+		uint64 value = 0;
+		switch(access.size)
+		{
+		case 1:
+			value = memoryMap->GetByte(address);
+			if(access.signExtend) value = static_cast<int64>(static_cast<int8>(value));
+			break;
+		case 2:
+			value = memoryMap->GetHalf(address);
+			if(access.signExtend) value = static_cast<int64>(static_cast<int16>(value));
+			break;
+		case 4:
+			value = memoryMap->GetWord(address);
+			if(access.signExtend) value = static_cast<int64>(static_cast<int32>(value));
+			break;
+		}
+		//Writing to a 32-bit register clears the upper half, 8 and 16-bit writes leave the rest untouched
+		switch(access.operandSize)
+		{
+		case 1:
+			if(access.highByte)
+			{
+				reg = (reg & ~0xFF00ULL) | ((value & 0xFF) << 8);
+			}
+			else
+			{
+				reg = (reg & ~0xFFULL) | (value & 0xFF);
+			}
+			break;
+		case 2:
+			reg = (reg & ~0xFFFFULL) | (value & 0xFFFF);
+			break;
+		case 4:
+			reg = value & 0xFFFFFFFF;
+			break;
+		case 8:
+			reg = value;
+			break;
+		}
+	}
+
+	//Blocks are executed with PC set to their start address
+	arena->m_faultCount++;
+	if(arena->m_faultedBlockCount < MAX_FAULTED_BLOCKS)
+	{
+		arena->m_faultedBlocks[arena->m_faultedBlockCount++] = context->m_State.nPC;
+	}
+}
+
+#else
+
+bool CFastMemoryArena::BeginSlowAccess(uintptr_t, void*)
+{
+	return false;
+}
+
+void CFastMemoryArena::CompleteSlowAccess(CFastMemoryArena*, uint64*)
+{
+}
+
+#endif
+
+//Decodes the x86-64 load and store instructions generated for memory accesses
+//(mov, movzx, movsx and movsxd with a memory operand)
+bool CFastMemoryArena::DecodeAccess(const uint8* code, ACCESS& access)
+{
+	const uint8* ptr = code;
+
+	bool operandSizeOverride = false;
+	while((*ptr == 0x66) || (*ptr == 0x67))
+	{
+		if(*ptr == 0x66) operandSizeOverride = true;
+		ptr++;
+	}
+
+	uint8 rex = 0;
+	if((*ptr & 0xF0) == 0x40)
+	{
+		rex = *ptr++;
+	}
+
+	uint32 operandSize = (rex & 0x08) ? 8 : (operandSizeOverride ? 2 : 4);
+	uint32 immediateSize = 0;
+
+	uint8 opcode = *ptr++;
+	if(opcode == 0x0F)
+	{
+		opcode = *ptr++;
+		switch(opcode)
+		{
+		case 0xB6:
+		case 0xB7:
+			access.zeroExtend = true;
+			access.size = (opcode == 0xB6) ? 1 : 2;
+			break;
+		case 0xBE:
+		case 0xBF:
+			access.signExtend = true;
+			access.size = (opcode == 0xBE) ? 1 : 2;
+			break;
+		default:
+			return false;
+		}
+		access.operandSize = operandSize;
+	}
+	else
+	{
+		switch(opcode)
+		{
+		case 0x8A:
+			access.size = 1;
+			break;
+		case 0x8B:
+			access.size = operandSize;
+			break;
+		case 0x88:
+			access.isStore = true;
+			access.size = 1;
+			break;
+		case 0x89:
+			access.isStore = true;
+			access.size = operandSize;
+			break;
+		case 0xC6:
+			access.isStore = true;
+			access.hasImmediate = true;
+			access.size = 1;
+			immediateSize = 1;
+			break;
+		case 0xC7:
+			access.isStore = true;
+			access.hasImmediate = true;
+			access.size = operandSize;
+			immediateSize = (operandSize == 2) ? 2 : 4;
+			break;
+		case 0x63:
+			//movsxd, sign extends a 32-bit load in a 64-bit register
+			if(operandSize != 8) return false;
+			access.signExtend = true;
+			access.size = 4;
+			break;
+		default:
+			return false;
+		}
+		access.operandSize = access.signExtend ? operandSize : access.size;
+	}
+
+	//64-bit accesses are never generated for 32-bit guest accesses
+	if(access.size > 4) return false;
+
+	uint8 modRm = *ptr++;
+	uint8 mod = (modRm >> 6) & 0x03;
+	uint8 rm = modRm & 0x07;
+	access.reg = ((modRm >> 3) & 0x07) | ((rex & 0x04) ? 0x08 : 0);
+	if(mod == 0x03) return false;
+	if(access.hasImmediate && ((access.reg & 0x07) != 0)) return false;
+
+	if(rm == 0x04)
+	{
+		uint8 sib = *ptr++;
+		if((mod == 0x00) && ((sib & 0x07) == 0x05)) ptr += 4;
+	}
+	else if((mod == 0x00) && (rm == 0x05))
+	{
+		ptr += 4;
+	}
+	if(mod == 0x01) ptr += 1;
+	if(mod == 0x02) ptr += 4;
+
+	if(access.hasImmediate)
+	{
+		access.immediate = 0;
+		memcpy(&access.immediate, ptr, immediateSize);
+		ptr += immediateSize;
+	}
+
+	//Without REX, byte registers 4 to 7 are AH, CH, DH and BH
+	access.highByte = (access.size == 1) && (access.operandSize == 1) && !access.hasImmediate && (rex == 0) && (access.reg >= 4);
+	//Slow access stub doesn't give access to RSP
+	if(!access.hasImmediate && !access.highByte && (access.reg == 4)) return false;
+
+	access.length = static_cast<uint32>(ptr - code);
+	return true;
+}
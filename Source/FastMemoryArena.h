@@ -0,0 +1,114 @@
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <vector>
+#include "Types.h"
+
+#if defined(__linux__) && !defined(__ANDROID__) && defined(__x86_64__)
+#define FASTMEMORY_SUPPORTED
+#endif
+
+class CMIPS;
+
+//Host virtual address range where guest memory is mapped at its guest address. Generated code
+//accesses guest memory with a single base + address instruction. Accesses to addresses that
+//aren't mapped (I/O registers, etc.) fault and are emulated through the context's memory map,
+//the block that caused the fault is then compiled again without fast accesses. The fault handler
+//only decodes the access, the memory map is called once the thread is out of the signal handler.
+class CFastMemoryArena
+{
+public:
+	enum
+	{
+		MAX_FAULTED_BLOCKS = 64,
+		MAX_SLOW_ACCESS_RANGE_SIZE = 0x1000,
+	};
+
+	CFastMemoryArena();
+	virtual ~CFastMemoryArena();
+
+	static bool IsSupported();
+
+	//Memory that can be mapped in the arena, owned by the arena
+	uint8* AllocateMemory(uint32);
+	void MapMemory(uint32, uint8*, uint32, bool writable = true);
+	void SetMemoryProtected(uint8*, size_t, bool);
+	uint8* GetMemoryPointer(uintptr_t) const;
+	bool Contains(uintptr_t) const;
+
+	void Attach(CMIPS&);
+
+	bool IsFastAccessAllowed(uint32) const;
+	void AddSlowAccessRange(uint32, uint32);
+	uint32 TakeFaultedBlocks(uint32*);
+
+	static bool HandleAccessFault(uintptr_t, void*);
+
+private:
+	struct ALLOCATION
+	{
+		uint8* memory = nullptr;
+		uint32 size = 0;
+		int fd = -1;
+	};
+
+	struct VIEW
+	{
+		uint32 address = 0;
+		uint32 size = 0;
+		uint8* memory = nullptr;
+		bool writable = true;
+	};
+
+	struct ACCESS
+	{
+		uint32 length = 0;
+		uint32 size = 0;
+		uint32 operandSize = 0;
+		uint32 reg = 0;
+		uint32 immediate = 0;
+		bool isStore = false;
+		bool hasImmediate = false;
+		bool signExtend = false;
+		bool zeroExtend = false;
+		bool highByte = false;
+	};
+
+	//Handed to the slow access stub through RAX, layout is known by the stub
+	struct SLOW_ACCESS_FRAME
+	{
+		uint64 resumeAddress = 0;
+		uint64 savedRax = 0;
+		void (*complete)(CFastMemoryArena*, uint64*) = nullptr;
+		CFastMemoryArena* arena = nullptr;
+	};
+
+	typedef std::map<uint32, uint32> SlowAccessRangeMap;
+
+	uint32 GetGuestAddress(uintptr_t) const;
+	const ALLOCATION* FindAllocation(const uint8*) const;
+	void MapView(uint8*, const VIEW&);
+	bool BeginSlowAccess(uintptr_t, void*);
+
+	static bool DecodeAccess(const uint8*, ACCESS&);
+	static void CompleteSlowAccess(CFastMemoryArena*, uint64*);
+
+	uint8* m_reservation = nullptr;
+	uint8* m_base = nullptr;
+	std::vector<ALLOCATION> m_allocations;
+	std::vector<VIEW> m_views;
+
+	CMIPS* m_context = nullptr;
+
+	mutable std::mutex m_slowAccessRangesMutex;
+	SlowAccessRangeMap m_slowAccessRanges;
+
+	//Only touched by the thread executing the context (fault handler, slow access stub and executor)
+	SLOW_ACCESS_FRAME m_slowAccessFrame;
+	ACCESS m_slowAccess;
+	uint32 m_slowAccessAddress = 0;
+	uint32 m_faultedBlocks[MAX_FAULTED_BLOCKS];
+	uint32 m_faultedBlockCount = 0;
+	uint32 m_faultCount = 0;
+};
@@ -1,8 +1,15 @@
 #pragma once
 
-#include <list>
+#include <array>
+#include <map>
+#include <unordered_map>
+#include <zlib.h>
 #include "MIPS.h"
+#include "FastMemoryArena.h"
 #include "BasicBlock.h"
+#include "BasicBlockPool.h"
+#include "JitCodeCache.h"
+#include "SpeculativeBlockCompiler.h"
 
 #include "BlockLookupOneWay.h"
 #include "BlockLookupTwoWay.h"
@@ -32,12 +39,13 @@ public:
 	};
 
 	CGenericMipsExecutor(CMIPS& context, uint32 maxAddress)
-	    : m_emptyBlock(std::make_shared<CBasicBlock>(context, MIPS_INVALID_PC, MIPS_INVALID_PC))
+	    : m_emptyBlock(MakeBasicBlock<CBasicBlock>(context, MIPS_INVALID_PC, MIPS_INVALID_PC))
 	    , m_context(context)
 	    , m_maxAddress(maxAddress)
 	    , m_addressMask(maxAddress - 1)
 	    , m_blockLookup(m_emptyBlock.get(), maxAddress)
 	{
+		m_emptyBlock->SetCodeArenaClient(&m_codeArenaClient);
 		m_emptyBlock->Compile();
 		assert(!context.m_emptyBlockHandler);
 		context.m_emptyBlockHandler =
@@ -50,10 +58,25 @@ public:
 		    };
 	}
 
-	virtual ~CGenericMipsExecutor() = default;
+	virtual ~CGenericMipsExecutor()
+	{
+		//Make sure workers are done before anything they use goes away
+		m_speculativeCompiler.reset();
+	}
 
 	int Execute(int cycles) override
 	{
+		//Drop all blocks if the code arena went over its budget since we last ran and we hold too much of it
+		uint32 codeFlushGeneration = m_codeArenaClient.GetFlushGeneration();
+		if(codeFlushGeneration != m_codeFlushGeneration)
+		{
+			m_codeFlushGeneration = codeFlushGeneration;
+			Reset();
+		}
+		if(m_context.m_fastMemory)
+		{
+			ClearFaultedFastMemoryBlocks();
+		}
 		m_context.m_State.cycleQuota = cycles;
 #ifdef DEBUGGER_INCLUDED
 		m_mustBreak = false;
@@ -84,10 +107,15 @@ public:
 
 	void Reset() override
 	{
+		if(m_speculativeCompiler)
+		{
+			m_speculativeCompiler->Reset();
+		}
 		m_blockLookup.Clear();
 		m_blocks.clear();
 		m_blockLinks.clear();
 		m_pendingBlockLinks.clear();
+		m_outgoingBlockLinks.clear();
 	}
 
 	void ClearActiveBlocksInRange(uint32 start, uint32 end, bool executing) override
@@ -101,6 +129,47 @@ public:
 		ClearActiveBlocksInRangeInternal(start, end, currentBlock);
 	}
 
+	void SetCodeCache(CJitCodeCache* codeCache) override
+	{
+		m_codeCache = codeCache;
+	}
+
+	//Compile successors of new blocks on worker threads. Only blocks starting in [rangeStart, rangeEnd[ are considered.
+	//Returns false if the executor can't provide architecture objects for the workers.
+	bool EnableSpeculativeCompilation(unsigned int threadCount, uint32 rangeStart, uint32 rangeEnd)
+	{
+		assert(!m_speculativeCompiler);
+		assert(rangeEnd <= m_maxAddress);
+		m_speculationRangeStart = rangeStart;
+		m_speculationRangeEnd = rangeEnd;
+		for(unsigned int i = 0; i < threadCount; i++)
+		{
+			auto workerContext = std::make_unique<WORKER_CONTEXT>(m_context);
+			if(!CreateWorkerArchitecture(*workerContext))
+			{
+				m_workerContexts.clear();
+				return false;
+			}
+			assert(workerContext->arch);
+			workerContext->context.m_pArch = workerContext->arch.get();
+			for(unsigned int j = 0; j < 4; j++)
+			{
+				workerContext->context.m_pCOP[j] = workerContext->coprocessors[j].get();
+			}
+			m_workerContexts.push_back(std::move(workerContext));
+		}
+		m_speculativeCompiler = std::make_unique<CSpeculativeBlockCompiler>(
+		    [this](unsigned int workerIndex, uint32 address, CSpeculativeBlockCompiler::RESULT& result) { return CompileSpeculativeBlock(workerIndex, address, result); },
+		    threadCount);
+		return true;
+	}
+
+	CSpeculativeBlockCompiler::STATS GetSpeculativeCompilerStats() const
+	{
+		if(!m_speculativeCompiler) return CSpeculativeBlockCompiler::STATS();
+		return m_speculativeCompiler->GetStats();
+	}
+
 #ifdef DEBUGGER_INCLUDED
 	bool MustBreak() const override
 	{
@@ -126,8 +195,58 @@ protected:
 		uint32 address;
 	};
 
-	typedef std::list<BasicBlockPtr> BlockList;
+	//Live blocks ordered by start address. Blocks are at most MAX_BLOCK_SIZE long,
+	//so blocks overlapping a range can only start in a window just before it.
+	typedef std::map<uint32, BasicBlockPtr> BlockMap;
+
+	//Incoming links, keyed by target address
 	typedef std::multimap<uint32, BLOCK_LINK> BlockLinkMap;
+	typedef typename BlockLinkMap::iterator BlockLinkIterator;
+
+	//Where a block's outgoing links are stored in m_blockLinks or m_pendingBlockLinks
+	struct OUTGOING_BLOCK_LINK
+	{
+		BlockLinkIterator link;
+		bool valid = false;
+		bool pending = false;
+	};
+	typedef std::unordered_map<uint32, std::array<OUTGOING_BLOCK_LINK, CBasicBlock::LINK_SLOT_MAX>> OutgoingBlockLinkMap;
+
+	//Architecture objects keep per instruction state while compiling. Speculative compiler workers get their own
+	//so that they never wait on the emulation thread (or make it wait). Memory related settings are the executor's.
+	struct WORKER_CONTEXT
+	{
+		WORKER_CONTEXT(const CMIPS& executorContext)
+		    //No memory map gets created with this endianess, we use the executor's
+		    : context(MEMORYMAP_ENDIAN_MSBF)
+		{
+			context.m_pMemoryMap = executorContext.m_pMemoryMap;
+			context.m_pageLookup = executorContext.m_pageLookup;
+			context.m_fastMemoryBase = executorContext.m_fastMemoryBase;
+			context.m_fastMemory = executorContext.m_fastMemory;
+			context.m_vuMem = executorContext.m_vuMem;
+			context.m_pAddrTranslator = executorContext.m_pAddrTranslator;
+		}
+
+		~WORKER_CONTEXT()
+		{
+			//Borrowed from the executor's context, CMIPS would free them
+			context.m_pMemoryMap = nullptr;
+			context.m_pageLookup = nullptr;
+		}
+
+		CMIPS context;
+		std::unique_ptr<CMIPSArchitecture> arch;
+		std::unique_ptr<CMIPSCoprocessor> coprocessors[4];
+	};
+	typedef std::unique_ptr<WORKER_CONTEXT> WorkerContextPtr;
+
+	//Must fill arch (and coprocessors) with new instances of what the executor's context uses.
+	//Executors that don't override this can't use speculative compilation.
+	virtual bool CreateWorkerArchitecture(WORKER_CONTEXT&)
+	{
+		return false;
+	}
 
 	bool HasBlockAt(uint32 address) const
 	{
@@ -139,17 +258,94 @@ protected:
 	{
 		assert(!HasBlockAt(start));
 		auto block = BlockFactory(m_context, start, end);
+		if(m_speculativeCompiler)
+		{
+			//BlockFactory might not have used the speculative block, drop it if that's the case
+			m_speculativeCompiler->Discard(start);
+		}
 		m_blockLookup.AddBlock(block.get());
-		m_blocks.push_back(std::move(block));
+		//If a block already started here, the new one would be destroyed while the lookup still points to it
+		auto insertResult = m_blocks.emplace(start, std::move(block));
+		assert(insertResult.second);
+		(void)insertResult;
 	}
 
 	virtual BasicBlockPtr BlockFactory(CMIPS& context, uint32 start, uint32 end)
 	{
-		auto result = std::make_shared<CBasicBlock>(context, start, end);
-		result->Compile();
+		bool needsChecksum = m_codeCache || m_speculativeCompiler;
+		uint32 checksum = needsChecksum ? ComputeBlockChecksum(start, end) : 0;
+		if(auto result = TakeSpeculativeBlock(start, end, checksum))
+		{
+			return result;
+		}
+		auto result = MakeBasicBlock<CBasicBlock>(context, start, end);
+		CompileBlock(result.get(), checksum);
 		return result;
 	}
 
+	BasicBlockPtr TakeSpeculativeBlock(uint32 start, uint32 end, uint32 checksum)
+	{
+		if(!m_speculativeCompiler) return BasicBlockPtr();
+		return m_speculativeCompiler->Take(start, end, checksum);
+	}
+
+	uint32 ComputeBlockChecksum(uint32 start, uint32 end) const
+	{
+		uint32 checksum = crc32(0, nullptr, 0);
+		for(uint32 address = start; address <= end; address += 4)
+		{
+			uint32 opcode = m_context.m_pMemoryMap->GetInstruction(address);
+			checksum = crc32(checksum, reinterpret_cast<const Bytef*>(&opcode), 4);
+		}
+		return checksum;
+	}
+
+	//Compiles a block, going through the persistent code cache if one is available
+	void CompileBlock(CBasicBlock* block, uint32 checksum)
+	{
+		block->SetCodeArenaClient(&m_codeArenaClient);
+		if(m_codeCache && !HasSlowMemoryAccesses(block))
+		{
+			block->CompileWithCodeCache(*m_codeCache, checksum);
+		}
+		else
+		{
+			block->Compile();
+		}
+	}
+
+	//Cached code for blocks that faulted in the fast memory arena was generated with fast accesses
+	bool HasSlowMemoryAccesses(const CBasicBlock* block) const
+	{
+		if(!m_context.m_fastMemory) return false;
+		for(uint32 address = block->GetBeginAddress(); address <= block->GetEndAddress(); address += instructionSize)
+		{
+			if(!m_context.m_fastMemory->IsFastAccessAllowed(address)) return true;
+		}
+		return false;
+	}
+
+	//Blocks that accessed unmapped memory through the fast memory arena are compiled again with regular accesses
+	void ClearFaultedFastMemoryBlocks()
+	{
+		uint32 faultedBlocks[CFastMemoryArena::MAX_FAULTED_BLOCKS];
+		uint32 faultedBlockCount = m_context.m_fastMemory->TakeFaultedBlocks(faultedBlocks);
+		for(uint32 i = 0; i < faultedBlockCount; i++)
+		{
+			auto block = FindBlockStartingAt(faultedBlocks[i] & m_addressMask);
+			if(block->IsEmpty()) continue;
+			uint32 start = block->GetBeginAddress();
+			uint32 end = block->GetEndAddress();
+			m_context.m_fastMemory->AddSlowAccessRange(start, end);
+			ClearSlowMemoryAccessBlock(start, end);
+		}
+	}
+
+	virtual void ClearSlowMemoryAccessBlock(uint32 start, uint32 end)
+	{
+		ClearActiveBlocksInRangeInternal(start, end, nullptr);
+	}
+
 	void SetupBlockLinks(uint32 startAddress, uint32 endAddress, uint32 branchAddress)
 	{
 		auto block = m_blockLookup.FindBlockAt(startAddress);
@@ -157,16 +353,16 @@ protected:
 		{
 			uint32 nextBlockAddress = (endAddress + 4) & m_addressMask;
 			block->SetLinkTargetAddress(CBasicBlock::LINK_SLOT_NEXT, nextBlockAddress);
-			auto link = std::make_pair(nextBlockAddress, BLOCK_LINK{CBasicBlock::LINK_SLOT_NEXT, startAddress});
+			auto link = BLOCK_LINK{CBasicBlock::LINK_SLOT_NEXT, startAddress};
 			auto nextBlock = m_blockLookup.FindBlockAt(nextBlockAddress);
 			if(!nextBlock->IsEmpty())
 			{
 				block->LinkBlock(CBasicBlock::LINK_SLOT_NEXT, nextBlock);
-				m_blockLinks.insert(link);
+				AddBlockLink(nextBlockAddress, link, false);
 			}
 			else
 			{
-				m_pendingBlockLinks.insert(link);
+				AddBlockLink(nextBlockAddress, link, true);
 			}
 		}
 
@@ -174,39 +370,64 @@ protected:
 		{
 			branchAddress &= m_addressMask;
 			block->SetLinkTargetAddress(CBasicBlock::LINK_SLOT_BRANCH, branchAddress);
-			auto link = std::make_pair(branchAddress, BLOCK_LINK{CBasicBlock::LINK_SLOT_BRANCH, startAddress});
+			auto link = BLOCK_LINK{CBasicBlock::LINK_SLOT_BRANCH, startAddress};
 			auto branchBlock = m_blockLookup.FindBlockAt(branchAddress);
 			if(!branchBlock->IsEmpty())
 			{
 				block->LinkBlock(CBasicBlock::LINK_SLOT_BRANCH, branchBlock);
-				m_blockLinks.insert(link);
+				AddBlockLink(branchAddress, link, false);
 			}
 			else
 			{
-				m_pendingBlockLinks.insert(link);
+				AddBlockLink(branchAddress, link, true);
 			}
 		}
 
 		//Resolve any block links that could be valid now that block has been created
 		{
-			auto lowerBound = m_pendingBlockLinks.lower_bound(startAddress);
-			auto upperBound = m_pendingBlockLinks.upper_bound(startAddress);
-			for(auto blockLinkIterator = lowerBound; blockLinkIterator != upperBound; blockLinkIterator++)
+			auto blockLinkIterator = m_pendingBlockLinks.lower_bound(startAddress);
+			while((blockLinkIterator != std::end(m_pendingBlockLinks)) && (blockLinkIterator->first == startAddress))
 			{
 				const auto& blockLink = blockLinkIterator->second;
 				auto referringBlock = m_blockLookup.FindBlockAt(blockLink.address);
-				if(referringBlock->IsEmpty()) continue;
+				assert(!referringBlock->IsEmpty());
 				referringBlock->LinkBlock(blockLink.slot, block);
-				m_blockLinks.insert(*blockLinkIterator);
+				blockLinkIterator = MoveBlockLink(blockLinkIterator, false);
 			}
-			m_pendingBlockLinks.erase(lowerBound, upperBound);
 		}
 	}
 
-	virtual void PartitionFunction(uint32 startAddress)
+	void AddBlockLink(uint32 targetAddress, const BLOCK_LINK& blockLink, bool pending)
 	{
-		uint32 endAddress = startAddress + MAX_BLOCK_SIZE;
-		uint32 branchAddress = 0;
+		auto& blockLinks = pending ? m_pendingBlockLinks : m_blockLinks;
+		auto& outgoingLink = m_outgoingBlockLinks[blockLink.address][blockLink.slot];
+		assert(!outgoingLink.valid);
+		outgoingLink.link = blockLinks.insert(std::make_pair(targetAddress, blockLink));
+		outgoingLink.valid = true;
+		outgoingLink.pending = pending;
+	}
+
+	//Moves a link to the pending or resolved link map, returns the link that followed it
+	BlockLinkIterator MoveBlockLink(BlockLinkIterator blockLinkIterator, bool pending)
+	{
+		auto& srcBlockLinks = pending ? m_blockLinks : m_pendingBlockLinks;
+		auto& dstBlockLinks = pending ? m_pendingBlockLinks : m_blockLinks;
+		const auto& blockLink = blockLinkIterator->second;
+		auto outgoingLinksIterator = m_outgoingBlockLinks.find(blockLink.address);
+		assert(outgoingLinksIterator != std::end(m_outgoingBlockLinks));
+		auto& outgoingLink = outgoingLinksIterator->second[blockLink.slot];
+		assert(outgoingLink.valid && (outgoingLink.pending != pending) && (outgoingLink.link == blockLinkIterator));
+		auto nextIterator = std::next(blockLinkIterator);
+		outgoingLink.link = dstBlockLinks.insert(srcBlockLinks.extract(blockLinkIterator));
+		outgoingLink.pending = pending;
+		return nextIterator;
+	}
+
+	//Only reads memory and instruction reflection info, safe to use from worker threads
+	void FindBlockRange(uint32 startAddress, uint32& endAddress, uint32& branchAddress) const
+	{
+		endAddress = startAddress + MAX_BLOCK_SIZE;
+		branchAddress = 0;
 		for(uint32 address = startAddress; address < endAddress; address += 4)
 		{
 			uint32 opcode = m_context.m_pMemoryMap->GetInstruction(address);
@@ -225,46 +446,85 @@ protected:
 		}
 		assert((endAddress - startAddress) <= MAX_BLOCK_SIZE);
 		assert(endAddress <= m_maxAddress);
+	}
+
+	virtual void PartitionFunction(uint32 startAddress)
+	{
+		uint32 endAddress = 0;
+		uint32 branchAddress = 0;
+		FindBlockRange(startAddress, endAddress, branchAddress);
 		CreateBlock(startAddress, endAddress);
 		auto block = FindBlockStartingAt(startAddress);
 		if(block->GetRecycleCount() < RECYCLE_NOLINK_THRESHOLD)
 		{
 			SetupBlockLinks(startAddress, endAddress, branchAddress);
 		}
+		if(m_speculativeCompiler)
+		{
+			RequestSpeculativeBlock((endAddress + 4) & m_addressMask);
+			if(branchAddress != 0)
+			{
+				RequestSpeculativeBlock(branchAddress & m_addressMask);
+			}
+		}
+	}
+
+	void RequestSpeculativeBlock(uint32 address)
+	{
+		assert(m_speculativeCompiler);
+		if(HasBlockAt(address)) return;
+		m_speculativeCompiler->Request(address);
+	}
+
+	//Runs on speculative compiler worker threads
+	bool CompileSpeculativeBlock(unsigned int workerIndex, uint32 startAddress, CSpeculativeBlockCompiler::RESULT& result)
+	{
+		if((startAddress < m_speculationRangeStart) || (startAddress >= m_speculationRangeEnd)) return false;
+
+		uint32 endAddress = 0;
+		uint32 branchAddress = 0;
+		FindBlockRange(startAddress, endAddress, branchAddress);
+
+		uint32 checksum = ComputeBlockChecksum(startAddress, endAddress);
+		auto block = MakeBasicBlock<CBasicBlock>(m_context, startAddress, endAddress);
+		block->SetCompileContext(&m_workerContexts[workerIndex]->context);
+		CompileBlock(block.get(), checksum);
+		block->SetCompileContext(&m_context);
+
+		//Code was modified while we were compiling, this block can't be trusted
+		if(ComputeBlockChecksum(startAddress, endAddress) != checksum) return false;
+
+		result.block = std::move(block);
+		result.checksum = checksum;
+		result.nextAddress = (endAddress + 4) & m_addressMask;
+		result.branchAddress = (branchAddress != 0) ? (branchAddress & m_addressMask) : MIPS_INVALID_PC;
+		return true;
 	}
 
 	//Unlink and removes block from all of our bookkeeping structures
 	void OrphanBlock(CBasicBlock* block)
 	{
-		auto orphanBlockLinkSlot =
-		    [&](CBasicBlock::LINK_SLOT linkSlot) {
-			    auto slotSearch =
-			        [&](const std::pair<uint32, BLOCK_LINK>& link) {
-				        return (link.second.address == block->GetBeginAddress()) &&
-				               (link.second.slot == linkSlot);
-			        };
-			    uint32 linkTargetAddress = block->GetLinkTargetAddress(linkSlot);
-			    //Check if block has this specific link slot
-			    if(linkTargetAddress != MIPS_INVALID_PC)
-			    {
-				    //If it has that link slot, it's either linked or pending to be linked
-				    auto slotIterator = std::find_if(m_blockLinks.begin(), m_blockLinks.end(), slotSearch);
-				    if(slotIterator != std::end(m_blockLinks))
-				    {
-					    block->UnlinkBlock(linkSlot);
-					    m_blockLinks.erase(slotIterator);
-				    }
-				    else
-				    {
-					    slotIterator = std::find_if(m_pendingBlockLinks.begin(), m_pendingBlockLinks.end(), slotSearch);
-					    assert(slotIterator != std::end(m_pendingBlockLinks));
-					    m_pendingBlockLinks.erase(slotIterator);
-				    }
-			    }
-			    block->SetLinkTargetAddress(linkSlot, MIPS_INVALID_PC);
-		    };
-		orphanBlockLinkSlot(CBasicBlock::LINK_SLOT_NEXT);
-		orphanBlockLinkSlot(CBasicBlock::LINK_SLOT_BRANCH);
+		auto outgoingLinksIterator = m_outgoingBlockLinks.find(block->GetBeginAddress());
+		if(outgoingLinksIterator != std::end(m_outgoingBlockLinks))
+		{
+			for(unsigned int i = 0; i < CBasicBlock::LINK_SLOT_MAX; i++)
+			{
+				const auto& outgoingLink = outgoingLinksIterator->second[i];
+				if(!outgoingLink.valid) continue;
+				if(outgoingLink.pending)
+				{
+					m_pendingBlockLinks.erase(outgoingLink.link);
+				}
+				else
+				{
+					block->UnlinkBlock(static_cast<CBasicBlock::LINK_SLOT>(i));
+					m_blockLinks.erase(outgoingLink.link);
+				}
+			}
+			m_outgoingBlockLinks.erase(outgoingLinksIterator);
+		}
+		block->SetLinkTargetAddress(CBasicBlock::LINK_SLOT_NEXT, MIPS_INVALID_PC);
+		block->SetLinkTargetAddress(CBasicBlock::LINK_SLOT_BRANCH, MIPS_INVALID_PC);
 	}
 
 	void ClearActiveBlocksInRangeInternal(uint32 start, uint32 end, CBasicBlock* protectedBlock)
@@ -274,14 +534,14 @@ protected:
 		uint32 scanEnd = end;
 		assert(scanEnd > scanStart);
 
-		std::set<CBasicBlock*> clearedBlocks;
-		for(uint32 address = scanStart; address < scanEnd; address += instructionSize)
+		std::vector<CBasicBlock*> clearedBlocks;
+		for(auto blockIterator = m_blocks.lower_bound(scanStart);
+		    (blockIterator != std::end(m_blocks)) && (blockIterator->first < scanEnd); blockIterator++)
 		{
-			auto block = m_blockLookup.FindBlockAt(address);
-			if(block->IsEmpty()) continue;
+			auto block = blockIterator->second.get();
 			if(block == protectedBlock) continue;
 			if(!RangesOverlap(block->GetBeginAddress(), block->GetEndAddress(), start, end)) continue;
-			clearedBlocks.insert(block);
+			clearedBlocks.push_back(block);
 			m_blockLookup.DeleteBlock(block);
 		}
 
@@ -291,38 +551,56 @@ protected:
 			OrphanBlock(block);
 		}
 
-		//Undo all stale links
+		if(m_speculativeCompiler)
+		{
+			for(auto& block : clearedBlocks)
+			{
+				m_speculativeCompiler->Forget(block->GetBeginAddress());
+			}
+			m_speculativeCompiler->InvalidateRange(start, end);
+		}
+
+		//Undo all stale links, blocks linking to cleared blocks were not cleared themselves
 		for(auto& block : clearedBlocks)
 		{
-			auto lowerBound = m_blockLinks.lower_bound(block->GetBeginAddress());
-			auto upperBound = m_blockLinks.upper_bound(block->GetBeginAddress());
-			for(auto blockLinkIterator = lowerBound; blockLinkIterator != upperBound; blockLinkIterator++)
+			uint32 blockAddress = block->GetBeginAddress();
+			auto blockLinkIterator = m_blockLinks.lower_bound(blockAddress);
+			while((blockLinkIterator != std::end(m_blockLinks)) && (blockLinkIterator->first == blockAddress))
 			{
 				const auto& blockLink = blockLinkIterator->second;
 				auto referringBlock = m_blockLookup.FindBlockAt(blockLink.address);
-				if(referringBlock->IsEmpty()) continue;
+				assert(!referringBlock->IsEmpty());
 				referringBlock->UnlinkBlock(blockLink.slot);
-				m_pendingBlockLinks.insert(*blockLinkIterator);
+				blockLinkIterator = MoveBlockLink(blockLinkIterator, true);
 			}
-			m_blockLinks.erase(lowerBound, upperBound);
 		}
 
-		if(!clearedBlocks.empty())
+		for(auto& block : clearedBlocks)
 		{
-			m_blocks.remove_if([&](const BasicBlockPtr& block) { return clearedBlocks.find(block.get()) != std::end(clearedBlocks); });
+			m_blocks.erase(block->GetBeginAddress());
 		}
 	}
 
-	BlockList m_blocks;
+	//Must outlive every block holding code
+	CJitCodeArena::CClient m_codeArenaClient;
+	BlockMap m_blocks;
 	BasicBlockPtr m_emptyBlock;
 	BlockLinkMap m_blockLinks;
 	BlockLinkMap m_pendingBlockLinks;
+	OutgoingBlockLinkMap m_outgoingBlockLinks;
 	CMIPS& m_context;
+	CJitCodeCache* m_codeCache = nullptr;
+	uint32 m_codeFlushGeneration = 0;
 	uint32 m_maxAddress = 0;
 	uint32 m_addressMask = 0;
 
 	BlockLookupType m_blockLookup;
 
+	std::vector<WorkerContextPtr> m_workerContexts;
+	std::unique_ptr<CSpeculativeBlockCompiler> m_speculativeCompiler;
+	uint32 m_speculationRangeStart = 0;
+	uint32 m_speculationRangeEnd = 0;
+
 #ifdef DEBUGGER_INCLUDED
 	bool m_mustBreak = false;
 	bool m_breakpointsDisabledOnce = false;
@@ -30,14 +30,16 @@ CIszImageStream::CIszImageStream(CStream* baseStream)
 	}
 
 	ReadBlockDescriptorTable();
-	m_cachedBlock = new uint8[m_header.blockSize];
-	m_readBuffer = new uint8[m_header.blockSize];
+	m_blockCache = std::make_unique<CCompressedImageBlockCache>(
+	    m_header.blockSize, m_header.blockNumber,
+	    [this](uint32 blockNumber, CCompressedImageBlockCache::RawBlock& rawBlock) { ReadRawBlock(blockNumber, rawBlock); },
+	    [this](uint32 blockNumber, const CCompressedImageBlockCache::RawBlock& rawBlock, uint8* block) { DecompressBlock(blockNumber, rawBlock, block); });
 }
 
 CIszImageStream::~CIszImageStream()
 {
-	delete[] m_cachedBlock;
-	delete[] m_readBuffer;
+	//Stop prefetching before the base stream goes away
+	m_blockCache.reset();
 	delete[] m_blockDescriptorTable;
 	delete m_baseStream;
 }
@@ -73,11 +75,15 @@ uint64 CIszImageStream::Read(void* buffer, uint64 size)
 		{
 			break;
 		}
-		SyncCache();
+		uint64 blockNumber = (m_position / m_header.blockSize);
+		if(blockNumber >= m_header.blockNumber)
+		{
+			throw std::runtime_error("Trying to read past eof.");
+		}
 		uint64 blockPosition = (m_position % m_header.blockSize);
 		uint64 sizeLeft = m_header.blockSize - blockPosition;
 		uint64 sizeToRead = std::min<uint64>(size, sizeLeft);
-		memcpy(inputBuffer, m_cachedBlock + blockPosition, static_cast<size_t>(sizeToRead));
+		m_blockCache->Read(static_cast<uint32>(blockNumber), static_cast<uint32>(blockPosition), inputBuffer, static_cast<uint32>(sizeToRead));
 		m_position += sizeToRead;
 		size -= sizeToRead;
 		inputBuffer += sizeToRead;
@@ -109,12 +115,19 @@ void CIszImageStream::ReadBlockDescriptorTable()
 	}
 
 	m_blockDescriptorTable = new BLOCKDESCRIPTOR[m_header.blockNumber];
+	m_blockOffsets.resize(m_header.blockNumber);
+	uint64 blockOffset = m_header.dataOffset;
 	for(unsigned int i = 0; i < m_header.blockNumber; i++)
 	{
 		uint32 value = *reinterpret_cast<uint32*>(&cryptedTable[i * m_header.blockPtrLength]);
 		value &= 0xFFFFFF;
 		m_blockDescriptorTable[i].size = value & 0x3FFFFF;
 		m_blockDescriptorTable[i].storageType = static_cast<uint8>(value >> 22);
+		m_blockOffsets[i] = blockOffset;
+		if(m_blockDescriptorTable[i].storageType != ADI_ZERO)
+		{
+			blockOffset += m_blockDescriptorTable[i].size;
+		}
 	}
 
 	delete[] cryptedTable;
@@ -125,98 +138,86 @@ uint64 CIszImageStream::GetTotalSize() const
 	return static_cast<uint64>(m_header.totalSectors) * static_cast<uint64>(m_header.sectorSize);
 }
 
-const CIszImageStream::BLOCKDESCRIPTOR& CIszImageStream::SeekToBlock(uint64 blockNumber)
+void CIszImageStream::ReadRawBlock(uint32 blockNumber, CCompressedImageBlockCache::RawBlock& rawBlock)
 {
 	assert(blockNumber < m_header.blockNumber);
-	uint64 seekPosition = m_header.dataOffset;
-	for(unsigned int i = 0; i < blockNumber; i++)
-	{
-		const BLOCKDESCRIPTOR& blockDescriptor = m_blockDescriptorTable[i];
-		if(blockDescriptor.storageType != ADI_ZERO)
-		{
-			seekPosition += blockDescriptor.size;
-		}
-	}
-	m_baseStream->Seek(seekPosition, Framework::STREAM_SEEK_SET);
-	return m_blockDescriptorTable[blockNumber];
-}
-
-void CIszImageStream::SyncCache()
-{
-	uint64 currentSector = (m_position / m_header.sectorSize);
-	uint64 neededBlock = (currentSector * m_header.sectorSize) / m_header.blockSize;
-	if(neededBlock == m_cachedBlockNumber)
+	const BLOCKDESCRIPTOR& blockDescriptor = m_blockDescriptorTable[blockNumber];
+	if(blockDescriptor.storageType == ADI_ZERO)
 	{
+		rawBlock.clear();
 		return;
 	}
-	if(neededBlock >= m_header.blockNumber)
+	rawBlock.resize(blockDescriptor.size);
+	m_baseStream->Seek(m_blockOffsets[blockNumber], Framework::STREAM_SEEK_SET);
+	m_baseStream->Read(rawBlock.data(), blockDescriptor.size);
+	if((blockDescriptor.storageType == ADI_BZ2) && (rawBlock.size() >= 3))
 	{
-		throw std::runtime_error("Trying to read past eof.");
+		//Force BZ2 header
+		rawBlock[0] = 'B';
+		rawBlock[1] = 'Z';
+		rawBlock[2] = 'h';
 	}
+}
 
-	const BLOCKDESCRIPTOR& blockDescriptor = SeekToBlock(neededBlock);
-	memset(m_cachedBlock, 0, m_header.blockSize);
+void CIszImageStream::DecompressBlock(uint32 blockNumber, const CCompressedImageBlockCache::RawBlock& rawBlock, uint8* block)
+{
+	const BLOCKDESCRIPTOR& blockDescriptor = m_blockDescriptorTable[blockNumber];
 	switch(blockDescriptor.storageType)
 	{
 	case ADI_ZERO:
-		ReadZeroBlock(blockDescriptor.size);
+		if(blockDescriptor.size != m_header.blockSize)
+		{
+			throw std::runtime_error("Invalid zero block.");
+		}
+		ReadZeroBlock(block);
 		break;
 	case ADI_DATA:
-		ReadDataBlock(blockDescriptor.size);
+		ReadDataBlock(rawBlock, block);
 		break;
 	case ADI_ZLIB:
-		ReadGzipBlock(blockDescriptor.size);
+		ReadGzipBlock(rawBlock, block);
 		break;
 	case ADI_BZ2:
-		ReadBz2Block(blockDescriptor.size);
+		ReadBz2Block(rawBlock, block);
 		break;
 	default:
 		throw std::runtime_error("Unsupported block storage mode.");
 		break;
 	}
-	m_cachedBlockNumber = neededBlock;
 }
 
-void CIszImageStream::ReadZeroBlock(uint32 compressedBlockSize)
+void CIszImageStream::ReadZeroBlock(uint8* block)
 {
-	if(compressedBlockSize != m_header.blockSize)
-	{
-		throw std::runtime_error("Invalid zero block.");
-	}
+	memset(block, 0, m_header.blockSize);
 }
 
-void CIszImageStream::ReadDataBlock(uint32 compressedBlockSize)
+void CIszImageStream::ReadDataBlock(const CCompressedImageBlockCache::RawBlock& rawBlock, uint8* block)
 {
-	if(compressedBlockSize != m_header.blockSize)
+	if(rawBlock.size() != m_header.blockSize)
 	{
 		throw std::runtime_error("Invalid data block.");
 	}
-	m_baseStream->Read(m_cachedBlock, compressedBlockSize);
+	memcpy(block, rawBlock.data(), m_header.blockSize);
 }
 
-void CIszImageStream::ReadGzipBlock(uint32 compressedBlockSize)
+void CIszImageStream::ReadGzipBlock(const CCompressedImageBlockCache::RawBlock& rawBlock, uint8* block)
 {
-	m_baseStream->Read(m_readBuffer, compressedBlockSize);
 	uLongf destLength = m_header.blockSize;
 	if(uncompress(
-	       reinterpret_cast<Bytef*>(m_cachedBlock), &destLength,
-	       reinterpret_cast<Bytef*>(m_readBuffer), compressedBlockSize) != Z_OK)
+	       reinterpret_cast<Bytef*>(block), &destLength,
+	       reinterpret_cast<const Bytef*>(rawBlock.data()), static_cast<uLong>(rawBlock.size())) != Z_OK)
 	{
 		throw std::runtime_error("Error decompressing zlib block.");
 	}
 }
 
-void CIszImageStream::ReadBz2Block(uint32 compressedBlockSize)
+void CIszImageStream::ReadBz2Block(const CCompressedImageBlockCache::RawBlock& rawBlock, uint8* block)
 {
-	m_baseStream->Read(m_readBuffer, compressedBlockSize);
-	//Force BZ2 header
-	m_readBuffer[0] = 'B';
-	m_readBuffer[1] = 'Z';
-	m_readBuffer[2] = 'h';
+	//Header was fixed up when the block was read
 	unsigned int destLength = m_header.blockSize;
 	if(BZ2_bzBuffToBuffDecompress(
-	       reinterpret_cast<char*>(m_cachedBlock), &destLength,
-	       reinterpret_cast<char*>(m_readBuffer), compressedBlockSize, 0, 0) != BZ_OK)
+	       reinterpret_cast<char*>(block), &destLength,
+	       reinterpret_cast<char*>(const_cast<uint8*>(rawBlock.data())), static_cast<unsigned int>(rawBlock.size()), 0, 0) != BZ_OK)
 	{
 		throw std::runtime_error("Error decompressing bz2 block.");
 	}
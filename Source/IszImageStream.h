@@ -1,7 +1,10 @@
 #pragma once
 
+#include <memory>
+#include <vector>
 #include "Types.h"
 #include "Stream.h"
+#include "CompressedImageBlockCache.h"
 
 class CIszImageStream : public Framework::CStream
 {
@@ -70,19 +73,19 @@ private:
 
 	void ReadBlockDescriptorTable();
 	uint64 GetTotalSize() const;
-	const BLOCKDESCRIPTOR& SeekToBlock(uint64);
-	void SyncCache();
 
-	void ReadZeroBlock(uint32);
-	void ReadDataBlock(uint32);
-	void ReadGzipBlock(uint32);
-	void ReadBz2Block(uint32);
+	void ReadRawBlock(uint32, CCompressedImageBlockCache::RawBlock&);
+	void DecompressBlock(uint32, const CCompressedImageBlockCache::RawBlock&, uint8*);
+
+	void ReadZeroBlock(uint8*);
+	void ReadDataBlock(const CCompressedImageBlockCache::RawBlock&, uint8*);
+	void ReadGzipBlock(const CCompressedImageBlockCache::RawBlock&, uint8*);
+	void ReadBz2Block(const CCompressedImageBlockCache::RawBlock&, uint8*);
 
 	Framework::CStream* m_baseStream = nullptr;
 	HEADER m_header;
 	BLOCKDESCRIPTOR* m_blockDescriptorTable = nullptr;
-	int64 m_cachedBlockNumber = -1;
-	uint8* m_cachedBlock = nullptr;
-	uint8* m_readBuffer = nullptr;
+	std::vector<uint64> m_blockOffsets;
+	std::unique_ptr<CCompressedImageBlockCache> m_blockCache;
 	uint64 m_position = 0;
 };
@@ -0,0 +1,414 @@
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+#include "JitCodeArena.h"
+
+#ifdef JITCODEARENA_SUPPORTED
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#if defined(__APPLE__)
+#include <libkern/OSCacheControl.h>
+#include <pthread.h>
+#endif
+#endif
+#endif
+
+#if defined(__APPLE__) && defined(__aarch64__)
+//MAP_JIT pages are either writable or executable for a given thread
+#define JITCODEARENA_WRITE_PROTECT
+#endif
+
+static size_t AlignSize(size_t size)
+{
+	return (size + CJitCodeArena::ALIGNMENT - 1) & ~static_cast<size_t>(CJitCodeArena::ALIGNMENT - 1);
+}
+
+CJitCodeArena& CJitCodeArena::GetInstance()
+{
+	static auto instance = new CJitCodeArena();
+	return *instance;
+}
+
+CJitCodeArena::CClient::CClient()
+{
+	CJitCodeArena::GetInstance().RegisterClient(this);
+}
+
+CJitCodeArena::CClient::~CClient()
+{
+	CJitCodeArena::GetInstance().UnregisterClient(this);
+}
+
+uint32 CJitCodeArena::CClient::GetFlushGeneration() const
+{
+	return m_flushGeneration.load(std::memory_order_relaxed);
+}
+
+void* CJitCodeArena::Allocate(const void* code, size_t size, CClient* client)
+{
+	assert(size != 0);
+	size_t allocSize = AlignSize(size);
+	uint8* result = nullptr;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		result = AllocateFromFreeRanges(allocSize);
+		if(result)
+		{
+			m_stats.reusedCount++;
+		}
+		else
+		{
+			result = AllocateFromSlab(allocSize);
+		}
+		uint64 prevUsed = m_stats.used;
+		m_stats.used += allocSize;
+		m_stats.peakUsed = std::max(m_stats.peakUsed, m_stats.used);
+		m_stats.allocationCount++;
+		if(client)
+		{
+			client->m_used += allocSize;
+		}
+		if((m_stats.budget != 0) && (prevUsed <= m_stats.budget) && (m_stats.used > m_stats.budget))
+		{
+			m_stats.flushCount++;
+			FlushClients();
+		}
+	}
+	BeginModify(result, size);
+	memcpy(result, code, size);
+	EndModify(result, size);
+	return result;
+}
+
+void CJitCodeArena::Free(void* code, size_t size, CClient* client)
+{
+	size = AlignSize(size);
+	std::lock_guard<std::mutex> lock(m_mutex);
+	assert(m_stats.used >= size);
+	m_stats.used -= size;
+	if(client)
+	{
+		assert(client->m_used >= size);
+		client->m_used -= size;
+	}
+	auto range = reinterpret_cast<uint8*>(code);
+	if((range + size) == m_slabCurrent)
+	{
+		//Last allocation of the current slab, give it back to the bump allocator
+		m_slabCurrent = range;
+		auto prevRangeIterator = m_freeRanges.lower_bound(range);
+		if(prevRangeIterator != m_freeRanges.begin())
+		{
+			--prevRangeIterator;
+			if((prevRangeIterator->first + prevRangeIterator->second) == m_slabCurrent)
+			{
+				m_slabCurrent = prevRangeIterator->first;
+				RemoveFreeRange(prevRangeIterator);
+			}
+		}
+		return;
+	}
+	AddFreeRange(range, size);
+}
+
+void CJitCodeArena::BeginModify(void* code, size_t size)
+{
+#ifdef JITCODEARENA_WRITE_PROTECT
+	pthread_jit_write_protect_np(0);
+#endif
+}
+
+void CJitCodeArena::EndModify(void* code, size_t size)
+{
+#ifdef JITCODEARENA_WRITE_PROTECT
+	pthread_jit_write_protect_np(1);
+#endif
+	FlushInstructionCache(code, size);
+}
+
+void CJitCodeArena::SetBudget(uint64 budget)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_stats.budget = budget;
+}
+
+CJitCodeArena::STATS CJitCodeArena::GetStats() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_stats;
+}
+
+uint8* CJitCodeArena::AllocateFromFreeRanges(size_t size)
+{
+	//Best fit, what's left of the range stays in the free list
+	auto sizeIterator = m_freeSizes.lower_bound(size);
+	if(sizeIterator == std::end(m_freeSizes)) return nullptr;
+	auto rangeIterator = m_freeRanges.find(sizeIterator->second);
+	assert(rangeIterator != std::end(m_freeRanges));
+	auto range = rangeIterator->first;
+	auto rangeSize = rangeIterator->second;
+	RemoveFreeRange(rangeIterator);
+	if(rangeSize != size)
+	{
+		AddFreeRange(range + size, rangeSize - size);
+	}
+	return range;
+}
+
+uint8* CJitCodeArena::AllocateFromSlab(size_t size)
+{
+	if(static_cast<size_t>(m_slabEnd - m_slabCurrent) < size)
+	{
+		size_t slabSize = std::max<size_t>(SLAB_SIZE, AlignSize(size));
+		auto slab = MapSlab(slabSize);
+		if(m_slabCurrent != m_slabEnd)
+		{
+			AddFreeRange(m_slabCurrent, m_slabEnd - m_slabCurrent);
+		}
+		m_slabs.emplace_back(slab, slabSize);
+		m_slabCurrent = slab;
+		m_slabEnd = slab + slabSize;
+		m_stats.capacity += slabSize;
+		m_stats.slabCount++;
+	}
+	auto result = m_slabCurrent;
+	m_slabCurrent += size;
+	return result;
+}
+
+void CJitCodeArena::AddFreeRange(uint8* range, size_t size)
+{
+	//Coalesce with neighbouring free ranges
+	auto nextRangeIterator = m_freeRanges.lower_bound(range);
+	if(nextRangeIterator != std::begin(m_freeRanges))
+	{
+		auto prevRangeIterator = std::prev(nextRangeIterator);
+		if((prevRangeIterator->first + prevRangeIterator->second) == range)
+		{
+			range = prevRangeIterator->first;
+			size += prevRangeIterator->second;
+			RemoveFreeRange(prevRangeIterator);
+		}
+	}
+	if((nextRangeIterator != std::end(m_freeRanges)) && (nextRangeIterator->first == (range + size)))
+	{
+		size += nextRangeIterator->second;
+		RemoveFreeRange(nextRangeIterator);
+	}
+	m_freeRanges.emplace(range, size);
+	m_freeSizes.emplace(size, range);
+}
+
+void CJitCodeArena::RemoveFreeRange(FreeRangeMap::iterator rangeIterator)
+{
+	auto sizeRange = m_freeSizes.equal_range(rangeIterator->second);
+	for(auto sizeIterator = sizeRange.first; sizeIterator != sizeRange.second; ++sizeIterator)
+	{
+		if(sizeIterator->second == rangeIterator->first)
+		{
+			m_freeSizes.erase(sizeIterator);
+			break;
+		}
+	}
+	m_freeRanges.erase(rangeIterator);
+}
+
+void CJitCodeArena::RegisterClient(CClient* client)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_clients.push_back(client);
+}
+
+void CJitCodeArena::UnregisterClient(CClient* client)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	//Code still allocated by this client would be freed through a dangling pointer
+	assert(client->m_used == 0);
+	auto clientIterator = std::find(std::begin(m_clients), std::end(m_clients), client);
+	assert(clientIterator != std::end(m_clients));
+	m_clients.erase(clientIterator);
+}
+
+void CJitCodeArena::FlushClients()
+{
+	//Several VMs can share the arena, one VM going over budget shouldn't flush the others
+	if(m_clients.empty()) return;
+	uint64 clientShare = m_stats.budget / m_clients.size();
+	auto largestClient = *std::max_element(std::begin(m_clients), std::end(m_clients),
+	                                       [](const CClient* client1, const CClient* client2) { return client1->m_used < client2->m_used; });
+	for(auto client : m_clients)
+	{
+		if((client == largestClient) || (client->m_used > clientShare))
+		{
+			client->m_flushGeneration++;
+		}
+	}
+}
+
+uint8* CJitCodeArena::MapSlab(size_t size)
+{
+	void* slab = nullptr;
+#if defined(JITCODEARENA_SUPPORTED) && defined(_WIN32)
+	slab = VirtualAlloc(nullptr, size, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE);
+#elif defined(JITCODEARENA_SUPPORTED)
+	int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#if defined(__APPLE__)
+	flags |= MAP_JIT;
+#endif
+	slab = mmap(nullptr, size, PROT_READ | PROT_WRITE | PROT_EXEC, flags, -1, 0);
+	if(slab == MAP_FAILED)
+	{
+		slab = nullptr;
+	}
+#endif
+	if(!slab)
+	{
+		throw std::runtime_error("Failed to allocate JIT code arena slab.");
+	}
+	return reinterpret_cast<uint8*>(slab);
+}
+
+void CJitCodeArena::FlushInstructionCache(void* code, size_t size)
+{
+#if defined(JITCODEARENA_SUPPORTED) && defined(_WIN32)
+	::FlushInstructionCache(GetCurrentProcess(), code, size);
+#elif defined(JITCODEARENA_SUPPORTED) && defined(__APPLE__)
+	sys_icache_invalidate(code, size);
+#elif defined(JITCODEARENA_SUPPORTED) && !defined(__i386__) && !defined(__x86_64__)
+	auto begin = reinterpret_cast<char*>(code);
+	__builtin___clear_cache(begin, begin + size);
+#endif
+}
+
+#ifdef JITCODEARENA_SUPPORTED
+
+CJitFunction::CJitFunction(const void* code, size_t size, CJitCodeArena::CClient* client)
+    : m_code(CJitCodeArena::GetInstance().Allocate(code, size, client))
+    , m_size(size)
+    , m_client(client)
+{
+}
+
+CJitFunction::CJitFunction(CJitFunction&& src)
+{
+	std::swap(m_code, src.m_code);
+	std::swap(m_size, src.m_size);
+	std::swap(m_client, src.m_client);
+}
+
+CJitFunction::~CJitFunction()
+{
+	Reset();
+}
+
+CJitFunction& CJitFunction::operator=(CJitFunction&& src)
+{
+	Reset();
+	std::swap(m_code, src.m_code);
+	std::swap(m_size, src.m_size);
+	std::swap(m_client, src.m_client);
+	return (*this);
+}
+
+void CJitFunction::operator()(void* context)
+{
+	typedef void (*FunctionType)(void*);
+	reinterpret_cast<FunctionType>(m_code)(context);
+}
+
+bool CJitFunction::IsEmpty() const
+{
+	return (m_code == nullptr);
+}
+
+void* CJitFunction::GetCode() const
+{
+	return m_code;
+}
+
+size_t CJitFunction::GetSize() const
+{
+	return m_size;
+}
+
+void CJitFunction::BeginModify()
+{
+	CJitCodeArena::BeginModify(m_code, m_size);
+}
+
+void CJitFunction::EndModify()
+{
+	CJitCodeArena::EndModify(m_code, m_size);
+}
+
+void CJitFunction::Reset()
+{
+	if(!m_code) return;
+	CJitCodeArena::GetInstance().Free(m_code, m_size, m_client);
+	m_code = nullptr;
+	m_size = 0;
+	m_client = nullptr;
+}
+
+#else
+
+//No executable memory we can manage ourselves, every function gets its own allocation
+
+CJitFunction::CJitFunction(const void* code, size_t size, CJitCodeArena::CClient*)
+    : m_function(code, size)
+{
+}
+
+CJitFunction::CJitFunction(CJitFunction&& src)
+    : m_function(std::move(src.m_function))
+{
+}
+
+CJitFunction::~CJitFunction()
+{
+}
+
+CJitFunction& CJitFunction::operator=(CJitFunction&& src)
+{
+	m_function = std::move(src.m_function);
+	return (*this);
+}
+
+void CJitFunction::operator()(void* context)
+{
+	m_function(context);
+}
+
+bool CJitFunction::IsEmpty() const
+{
+	return m_function.IsEmpty();
+}
+
+void* CJitFunction::GetCode() const
+{
+	return m_function.GetCode();
+}
+
+size_t CJitFunction::GetSize() const
+{
+	return m_function.GetSize();
+}
+
+void CJitFunction::BeginModify()
+{
+	m_function.BeginModify();
+}
+
+void CJitFunction::EndModify()
+{
+	m_function.EndModify();
+}
+
+void CJitFunction::Reset()
+{
+}
+
+#endif
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <vector>
+#include "Types.h"
+#include "MemoryFunction.h"
+
+#ifdef __APPLE__
+#include <TargetConditionals.h>
+#endif
+
+#if defined(_WIN32) || (defined(__APPLE__) && TARGET_OS_OSX) || (defined(__unix__) && !defined(__EMSCRIPTEN__))
+#define JITCODEARENA_SUPPORTED
+#endif
+
+//Executable memory shared by all code generated by the jitter. Code is carved out of large slabs
+//with a bump allocator, freed ranges are coalesced and reused for new code before the slabs grow.
+//Keeping blocks together reduces per block overhead and improves i-cache/TLB locality for linked blocks.
+//Usage is tracked against a budget, executors flush their blocks when the arena goes over it.
+class CJitCodeArena
+{
+public:
+	enum
+	{
+		SLAB_SIZE = 0x400000,
+		ALIGNMENT = 0x10,
+	};
+
+	//Code is allocated on behalf of a client (an executor). When the arena goes over budget,
+	//only the clients holding more than their share of it (and always the largest one) flush.
+	class CClient
+	{
+	public:
+		CClient();
+		~CClient();
+
+		CClient(const CClient&) = delete;
+		CClient& operator=(const CClient&) = delete;
+
+		//Incremented every time this client has to drop its code
+		uint32 GetFlushGeneration() const;
+
+	private:
+		friend class CJitCodeArena;
+
+		uint64 m_used = 0;
+		std::atomic<uint32> m_flushGeneration = {0};
+	};
+
+	struct STATS
+	{
+		uint64 capacity = 0;
+		uint64 used = 0;
+		uint64 peakUsed = 0;
+		uint64 budget = 0;
+		uint32 slabCount = 0;
+		uint32 allocationCount = 0;
+		uint32 reusedCount = 0;
+		uint32 flushCount = 0;
+	};
+
+	//Never destroyed, code can be released by blocks that outlive static destruction
+	static CJitCodeArena& GetInstance();
+
+	void* Allocate(const void*, size_t, CClient* = nullptr);
+	void Free(void*, size_t, CClient* = nullptr);
+
+	static void BeginModify(void*, size_t);
+	static void EndModify(void*, size_t);
+
+	//Budget in bytes, 0 means unlimited
+	void SetBudget(uint64);
+
+	STATS GetStats() const;
+
+private:
+	typedef std::map<uint8*, size_t> FreeRangeMap;
+	typedef std::multimap<size_t, uint8*> FreeSizeMap;
+
+	CJitCodeArena() = default;
+
+	uint8* AllocateFromFreeRanges(size_t);
+	uint8* AllocateFromSlab(size_t);
+	void AddFreeRange(uint8*, size_t);
+	void RemoveFreeRange(FreeRangeMap::iterator);
+
+	void RegisterClient(CClient*);
+	void UnregisterClient(CClient*);
+	void FlushClients();
+
+	static uint8* MapSlab(size_t);
+	static void FlushInstructionCache(void*, size_t);
+
+	mutable std::mutex m_mutex;
+	std::vector<std::pair<uint8*, size_t>> m_slabs;
+	uint8* m_slabCurrent = nullptr;
+	uint8* m_slabEnd = nullptr;
+
+	FreeRangeMap m_freeRanges;
+	FreeSizeMap m_freeSizes;
+
+	std::vector<CClient*> m_clients;
+	STATS m_stats;
+};
+
+//Compiled code living in the code arena, same interface as CMemoryFunction
+class CJitFunction
+{
+public:
+	CJitFunction() = default;
+	CJitFunction(const void*, size_t, CJitCodeArena::CClient* = nullptr);
+	CJitFunction(const CJitFunction&) = delete;
+	CJitFunction(CJitFunction&&);
+	virtual ~CJitFunction();
+
+	CJitFunction& operator=(const CJitFunction&) = delete;
+	CJitFunction& operator=(CJitFunction&&);
+
+	void operator()(void*);
+
+	bool IsEmpty() const;
+	void* GetCode() const;
+	size_t GetSize() const;
+
+	void BeginModify();
+	void EndModify();
+
+private:
+	void Reset();
+
+#ifdef JITCODEARENA_SUPPORTED
+	void* m_code = nullptr;
+	size_t m_size = 0;
+	CJitCodeArena::CClient* m_client = nullptr;
+#else
+	CMemoryFunction m_function;
+#endif
+};
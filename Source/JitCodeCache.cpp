@@ -0,0 +1,291 @@
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+#include "JitCodeCache.h"
+#include "MemoryUtils.h"
+#include "StdStreamUtils.h"
+#include "Log.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+#define LOG_NAME ("jitcodecache")
+
+static uint64 ReadCacheUint64(Framework::CStream& stream)
+{
+	uint64 lo = stream.Read32();
+	uint64 hi = stream.Read32();
+	return lo | (hi << 32);
+}
+
+static void WriteCacheUint64(Framework::CStream& stream, uint64 value)
+{
+	stream.Write32(static_cast<uint32>(value));
+	stream.Write32(static_cast<uint32>(value >> 32));
+}
+
+void CJitCodeCache::Load(const fs::path& path)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	m_blocks.clear();
+	m_size = 0;
+	m_useCounter = 0;
+	m_dirty = false;
+
+	if(!fs::exists(path)) return;
+
+	try
+	{
+		auto stream = Framework::CreateInputStdStream(path.native());
+
+		uint32 magic = stream.Read32();
+		uint32 version = stream.Read32();
+		if((magic != MAGIC) || (version != VERSION)) return;
+
+		//Cache was built by another build of the program, symbol offsets are not valid anymore
+		auto signature = GetModuleSignature();
+		for(const auto& signatureItem : signature)
+		{
+			if(ReadCacheUint64(stream) != signatureItem) return;
+		}
+
+		uint32 blockCount = stream.Read32();
+		for(uint32 i = 0; i < blockCount; i++)
+		{
+			AOT_BLOCK_KEY key = {};
+			key.crc = stream.Read32();
+			key.begin = stream.Read32();
+			key.end = stream.Read32();
+
+			uint32 codeSize = stream.Read32();
+			uint32 symbolRefCount = stream.Read32();
+
+			CACHED_BLOCK block;
+			block.lastUse = ReadCacheUint64(stream);
+			block.code.resize(codeSize);
+			stream.Read(block.code.data(), codeSize);
+
+			block.symbolRefs.resize(symbolRefCount);
+			for(auto& symbolRef : block.symbolRefs)
+			{
+				symbolRef.symbolOffset = ReadCacheUint64(stream);
+				symbolRef.offset = stream.Read32();
+				if((symbolRef.offset + sizeof(uintptr_t)) > codeSize)
+				{
+					throw std::runtime_error("Symbol reference is out of bounds.");
+				}
+			}
+
+			m_useCounter = std::max(m_useCounter, block.lastUse + 1);
+			m_size += GetBlockSize(block);
+			m_blocks.insert(std::make_pair(key, std::move(block)));
+		}
+	}
+	catch(...)
+	{
+		//Corrupted or truncated cache, start from scratch
+		m_blocks.clear();
+		m_size = 0;
+		m_useCounter = 0;
+	}
+}
+
+bool CJitCodeCache::Save(const fs::path& path)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if(!m_dirty) return true;
+
+	Evict();
+
+	try
+	{
+		auto stream = Framework::CreateOutputStdStream(path.native());
+
+		stream.Write32(MAGIC);
+		stream.Write32(VERSION);
+
+		auto signature = GetModuleSignature();
+		for(const auto& signatureItem : signature)
+		{
+			WriteCacheUint64(stream, signatureItem);
+		}
+
+		stream.Write32(static_cast<uint32>(m_blocks.size()));
+		for(const auto& blockPair : m_blocks)
+		{
+			const auto& key = blockPair.first;
+			const auto& block = blockPair.second;
+
+			stream.Write32(key.crc);
+			stream.Write32(key.begin);
+			stream.Write32(key.end);
+
+			stream.Write32(static_cast<uint32>(block.code.size()));
+			stream.Write32(static_cast<uint32>(block.symbolRefs.size()));
+			WriteCacheUint64(stream, block.lastUse);
+			stream.Write(block.code.data(), block.code.size());
+
+			for(const auto& symbolRef : block.symbolRefs)
+			{
+				WriteCacheUint64(stream, symbolRef.symbolOffset);
+				stream.Write32(symbolRef.offset);
+			}
+		}
+
+		m_dirty = false;
+	}
+	catch(const std::exception& exception)
+	{
+		CLog::GetInstance().Warn(LOG_NAME, "Failed to save cache to '%s': %s\r\n", path.string().c_str(), exception.what());
+		return false;
+	}
+	return true;
+}
+
+void CJitCodeCache::Clear()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_blocks.clear();
+	m_stats = STATS();
+	m_size = 0;
+	m_useCounter = 0;
+	m_dirty = false;
+}
+
+void CJitCodeCache::SetBudget(uint64 budget)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_budget = budget;
+}
+
+bool CJitCodeCache::GetBlock(const AOT_BLOCK_KEY& key, std::vector<uint8>& code, SymbolRefArray& symbolRefs)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	auto blockIterator = m_blocks.find(key);
+	if(blockIterator == std::end(m_blocks))
+	{
+		m_stats.misses++;
+		return false;
+	}
+
+	auto& block = blockIterator->second;
+	block.lastUse = m_useCounter++;
+	auto moduleBase = GetModuleBase(reinterpret_cast<uintptr_t>(&EmptyBlockHandler));
+
+	code = block.code;
+	symbolRefs.clear();
+	symbolRefs.reserve(block.symbolRefs.size());
+	for(const auto& cachedSymbolRef : block.symbolRefs)
+	{
+		SYMBOL_REF symbolRef;
+		symbolRef.symbol = moduleBase + static_cast<uintptr_t>(cachedSymbolRef.symbolOffset);
+		symbolRef.offset = cachedSymbolRef.offset;
+		*reinterpret_cast<uintptr_t*>(code.data() + symbolRef.offset) = symbolRef.symbol;
+		symbolRefs.push_back(symbolRef);
+	}
+
+	m_stats.hits++;
+	return true;
+}
+
+void CJitCodeCache::PutBlock(const AOT_BLOCK_KEY& key, const void* code, size_t codeSize, const SymbolRefArray& symbolRefs)
+{
+	auto moduleBase = GetModuleBase(reinterpret_cast<uintptr_t>(&EmptyBlockHandler));
+	assert(moduleBase != 0);
+
+	CACHED_BLOCK block;
+	block.symbolRefs.reserve(symbolRefs.size());
+	for(const auto& symbolRef : symbolRefs)
+	{
+		//Symbols living in other modules (ie.: C runtime) can't be relocated reliably
+		if(GetModuleBase(symbolRef.symbol) != moduleBase)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stats.uncacheable++;
+			return;
+		}
+		CACHED_SYMBOL_REF cachedSymbolRef;
+		cachedSymbolRef.symbolOffset = symbolRef.symbol - moduleBase;
+		cachedSymbolRef.offset = symbolRef.offset;
+		block.symbolRefs.push_back(cachedSymbolRef);
+	}
+
+	auto codeBytes = reinterpret_cast<const uint8*>(code);
+	block.code = std::vector<uint8>(codeBytes, codeBytes + codeSize);
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	block.lastUse = m_useCounter++;
+	m_size += GetBlockSize(block);
+	auto& cachedBlock = m_blocks[key];
+	m_size -= GetBlockSize(cachedBlock);
+	cachedBlock = std::move(block);
+	m_dirty = true;
+}
+
+CJitCodeCache::STATS CJitCodeCache::GetStats() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_stats;
+}
+
+uintptr_t CJitCodeCache::GetModuleBase(uintptr_t address)
+{
+#ifdef _WIN32
+	HMODULE module = NULL;
+	BOOL result = GetModuleHandleExW(
+	    GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+	    reinterpret_cast<LPCWSTR>(address), &module);
+	if(result == FALSE) return 0;
+	return reinterpret_cast<uintptr_t>(module);
+#else
+	Dl_info info = {};
+	if(dladdr(reinterpret_cast<void*>(address), &info) == 0) return 0;
+	return reinterpret_cast<uintptr_t>(info.dli_fbase);
+#endif
+}
+
+uint64 CJitCodeCache::GetBlockSize(const CACHED_BLOCK& block)
+{
+	return block.code.size() + (block.symbolRefs.size() * sizeof(CACHED_SYMBOL_REF));
+}
+
+void CJitCodeCache::Evict()
+{
+	if(m_size <= m_budget) return;
+
+	std::vector<BlockMap::iterator> blockIterators;
+	blockIterators.reserve(m_blocks.size());
+	for(auto blockIterator = std::begin(m_blocks); blockIterator != std::end(m_blocks); blockIterator++)
+	{
+		blockIterators.push_back(blockIterator);
+	}
+	std::sort(std::begin(blockIterators), std::end(blockIterators),
+	          [](const BlockMap::iterator& lhs, const BlockMap::iterator& rhs) { return lhs->second.lastUse < rhs->second.lastUse; });
+
+	for(const auto& blockIterator : blockIterators)
+	{
+		if(m_size <= m_budget) break;
+		m_size -= GetBlockSize(blockIterator->second);
+		m_blocks.erase(blockIterator);
+		m_stats.evicted++;
+	}
+}
+
+CJitCodeCache::ModuleSignature CJitCodeCache::GetModuleSignature()
+{
+	//Offsets of a few well known symbols, these will change if the module's layout changes
+	auto moduleBase = GetModuleBase(reinterpret_cast<uintptr_t>(&EmptyBlockHandler));
+	ModuleSignature signature =
+	    {
+	        reinterpret_cast<uintptr_t>(&EmptyBlockHandler) - moduleBase,
+	        reinterpret_cast<uintptr_t>(&NextBlockTrampoline) - moduleBase,
+	        reinterpret_cast<uintptr_t>(&MemoryUtils_GetWordProxy) - moduleBase,
+	    };
+	return signature;
+}
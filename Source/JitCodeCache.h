@@ -0,0 +1,95 @@
+#pragma once
+
+#include <array>
+#include <map>
+#include <mutex>
+#include <vector>
+#include "Types.h"
+#include "filesystem_def.h"
+#include "BasicBlock.h"
+
+//Persistent cache of code generated by the jitter. Blocks use the same key as AOT blocks
+//(crc/begin/end) and are stored with the list of external symbols they reference. Symbols are
+//saved relative to the base address of the module that contains our code and are relocated when
+//blocks are fetched from the cache. Least recently used blocks are dropped when the cache gets
+//bigger than its budget.
+class CJitCodeCache
+{
+public:
+	struct SYMBOL_REF
+	{
+		uintptr_t symbol;
+		uint32 offset;
+	};
+	typedef std::vector<SYMBOL_REF> SymbolRefArray;
+
+	struct STATS
+	{
+		uint32 hits = 0;
+		uint32 misses = 0;
+		uint32 uncacheable = 0;
+		uint32 evicted = 0;
+	};
+
+	enum
+	{
+		//Bump this when code generation changes in a way that isn't reflected in the module layout
+		VERSION = 2,
+	};
+
+	enum : uint64
+	{
+		DEFAULT_BUDGET = 64 * 1024 * 1024,
+	};
+
+	void Load(const fs::path&);
+	//Returns false if the cache couldn't be written, it stays dirty in that case
+	bool Save(const fs::path&);
+	void Clear();
+
+	//Maximum size of saved blocks in bytes
+	void SetBudget(uint64);
+
+	bool GetBlock(const AOT_BLOCK_KEY&, std::vector<uint8>&, SymbolRefArray&);
+	void PutBlock(const AOT_BLOCK_KEY&, const void*, size_t, const SymbolRefArray&);
+
+	STATS GetStats() const;
+
+private:
+	enum
+	{
+		MAGIC = 0x4343494A, //'JICC'
+		SIGNATURE_SYMBOL_COUNT = 3,
+	};
+
+	struct CACHED_SYMBOL_REF
+	{
+		uint64 symbolOffset;
+		uint32 offset;
+	};
+
+	struct CACHED_BLOCK
+	{
+		std::vector<uint8> code;
+		std::vector<CACHED_SYMBOL_REF> symbolRefs;
+		//Value of the use counter when the block was last fetched or stored, kept across sessions
+		uint64 lastUse = 0;
+	};
+
+	typedef std::map<AOT_BLOCK_KEY, CACHED_BLOCK> BlockMap;
+	typedef std::array<uint64, SIGNATURE_SYMBOL_COUNT> ModuleSignature;
+
+	static uintptr_t GetModuleBase(uintptr_t);
+	static ModuleSignature GetModuleSignature();
+	static uint64 GetBlockSize(const CACHED_BLOCK&);
+
+	void Evict();
+
+	mutable std::mutex m_mutex;
+	BlockMap m_blocks;
+	STATS m_stats;
+	uint64 m_size = 0;
+	uint64 m_budget = DEFAULT_BUDGET;
+	uint64 m_useCounter = 0;
+	bool m_dirty = false;
+};
@@ -9,6 +9,8 @@
 
 #define PREF_LOG_SHOWPRINTS "log.showprints"
 
+static thread_local std::string g_threadContext;
+
 CLog::CLog()
 {
 #ifndef DISABLE_LOGGING
@@ -23,6 +25,7 @@ void CLog::Print(const char* logName, const char* format, ...)
 {
 #if defined(_DEBUG) && !defined(DISABLE_LOGGING)
 	if(!m_showPrints) return;
+	std::lock_guard<std::mutex> lock(m_mutex);
 	auto& logStream(GetLog(logName));
 	va_list args;
 	va_start(args, format);
@@ -35,6 +38,7 @@ void CLog::Print(const char* logName, const char* format, ...)
 void CLog::Warn(const char* logName, const char* format, ...)
 {
 #if defined(_DEBUG) && !defined(DISABLE_LOGGING)
+	std::lock_guard<std::mutex> lock(m_mutex);
 	auto& logStream(GetLog(logName));
 	va_list args;
 	va_start(args, format);
@@ -44,15 +48,32 @@ void CLog::Warn(const char* logName, const char* format, ...)
 #endif
 }
 
+void CLog::SetThreadContext(const std::string& context)
+{
+	g_threadContext = context;
+}
+
+std::string CLog::GetThreadContext()
+{
+	return g_threadContext;
+}
+
 Framework::CStdStream& CLog::GetLog(const char* logName)
 {
-	auto logIterator(m_logs.find(logName));
+	auto logKey = g_threadContext.empty() ? std::string(logName) : (g_threadContext + "/" + logName);
+	auto logIterator(m_logs.find(logKey));
 	if(logIterator == std::end(m_logs))
 	{
-		auto logPath = m_logBasePath / (std::string(logName) + ".log");
+		auto logDirectoryPath = m_logBasePath;
+		if(!g_threadContext.empty())
+		{
+			logDirectoryPath /= g_threadContext;
+			Framework::PathUtils::EnsurePathExists(logDirectoryPath);
+		}
+		auto logPath = logDirectoryPath / (std::string(logName) + ".log");
 		auto logStream = Framework::CreateOutputStdStream(logPath.native());
-		m_logs[logName] = std::move(logStream);
-		logIterator = m_logs.find(logName);
+		m_logs[logKey] = std::move(logStream);
+		logIterator = m_logs.find(logKey);
 	}
 	return logIterator->second;
 }
@@ -2,6 +2,7 @@
 
 #include <string>
 #include <map>
+#include <mutex>
 #include "filesystem_def.h"
 #include "StdStream.h"
 #include "Singleton.h"
@@ -15,12 +16,18 @@ public:
 	void Print(const char*, const char*, ...);
 	void Warn(const char*, const char*, ...);
 
+	//Threads of virtual machines running side by side in the same process log in their own directory
+	static void SetThreadContext(const std::string&);
+	static std::string GetThreadContext();
+
 private:
 	typedef std::map<std::string, Framework::CStdStream> LogMapType;
 
 	Framework::CStdStream& GetLog(const char*);
 
 	fs::path m_logBasePath;
+	//Prints can come from the IOP and VU worker threads
+	std::mutex m_mutex;
 	LogMapType m_logs;
 	bool m_showPrints = false;
 };
@@ -87,6 +87,15 @@ void CMA_MIPSIV::Template_Load32(const MemoryAccessTraits& traits)
 		    m_codeGen->PullRel(offsetof(CMIPS, m_State.nGPR[m_nRT].nV[0]));
 	    };
 
+	//Unmapped addresses fault and get this block compiled again without fast accesses
+	if(CanUseFastMemoryAccess())
+	{
+		ComputeMemAccessFastRef(traits.elementSize);
+		((m_codeGen)->*(traits.loadFunction))();
+		finishLoad();
+		return;
+	}
+
 	bool usePageLookup = (m_pCtx->m_pageLookup != nullptr);
 
 	if(usePageLookup)
@@ -124,6 +133,14 @@ void CMA_MIPSIV::Template_Load32(const MemoryAccessTraits& traits)
 
 void CMA_MIPSIV::Template_Store32(const MemoryAccessTraits& traits)
 {
+	if(CanUseFastMemoryAccess())
+	{
+		ComputeMemAccessFastRef(traits.elementSize);
+		m_codeGen->PushRel(offsetof(CMIPS, m_State.nGPR[m_nRT].nV[0]));
+		((m_codeGen)->*(traits.storeFunction))();
+		return;
+	}
+
 	bool usePageLookup = (m_pCtx->m_pageLookup != nullptr);
 
 	if(usePageLookup)
@@ -2,6 +2,7 @@
 #include <string.h>
 #include "MIPS.h"
 #include "COP_SCU.h"
+#include "FastMemoryArena.h"
 
 // clang-format off
 const char* CMIPS::m_sGPRName[] =
@@ -150,4 +151,8 @@ void CMIPS::MapPages(uint32 vAddress, uint32 size, uint8* memory)
 	{
 		m_pageLookup[pageBase + pageIndex] = memory + (MIPS_PAGE_SIZE * pageIndex);
 	}
+	if(m_fastMemory)
+	{
+		m_fastMemory->MapMemory(vAddress, memory, size);
+	}
 }
@@ -120,6 +120,8 @@ struct MIPSSTATE
 #define MIPS_INVALID_PC (0x00000001)
 #define MIPS_PAGE_SIZE (0x1000)
 
+class CFastMemoryArena;
+
 class CMIPS
 {
 public:
@@ -145,6 +147,8 @@ public:
 
 	void* m_vuMem = nullptr;
 	void** m_pageLookup = nullptr;
+	uint8* m_fastMemoryBase = nullptr;
+	CFastMemoryArena* m_fastMemory = nullptr;
 
 	std::function<void(CMIPS*)> m_emptyBlockHandler;
 
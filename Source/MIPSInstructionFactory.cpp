@@ -2,6 +2,7 @@
 #include <stddef.h>
 #include "MIPSInstructionFactory.h"
 #include "MIPS.h"
+#include "FastMemoryArena.h"
 #include "offsetof_def.h"
 #include "BitManip.h"
 
@@ -103,6 +104,24 @@ void CMIPSInstructionFactory::ComputeMemAccessPageRef()
 	m_codeGen->LoadRefFromRef();
 }
 
+//Reference to the access' address in the fast memory arena, aligned like page table accesses
+void CMIPSInstructionFactory::ComputeMemAccessFastRef(uint32 accessSize)
+{
+	m_codeGen->PushRelRef(offsetof(CMIPS, m_fastMemoryBase));
+	ComputeMemAccessAddrNoXlat();
+	if(accessSize > 1)
+	{
+		m_codeGen->PushCst(~(accessSize - 1));
+		m_codeGen->And();
+	}
+	m_codeGen->AddRef();
+}
+
+bool CMIPSInstructionFactory::CanUseFastMemoryAccess() const
+{
+	return (m_pCtx->m_fastMemory != nullptr) && m_pCtx->m_fastMemory->IsFastAccessAllowed(m_nAddress);
+}
+
 void CMIPSInstructionFactory::Branch(Jitter::CONDITION condition)
 {
 	uint16 nImmediate = (uint16)(m_nOpcode & 0xFFFF);
@@ -31,6 +31,8 @@ protected:
 	void ComputeMemAccessAddrNoXlat();
 	void ComputeMemAccessRef(uint32);
 	void ComputeMemAccessPageRef();
+	void ComputeMemAccessFastRef(uint32);
+	bool CanUseFastMemoryAccess() const;
 
 	void Branch(Jitter::CONDITION);
 	void BranchLikely(Jitter::CONDITION);
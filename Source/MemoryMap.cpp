@@ -1,9 +1,14 @@
 #include <cassert>
+#include <algorithm>
+#include <vector>
 #include "MemoryMap.h"
 #include "Log.h"
 
 #define LOG_NAME "MemoryMap"
 
+//Marks pages that contain more than one element (or parts of an element), never returned
+const CMemoryMap::MEMORYMAPELEMENT CMemoryMap::g_mixedPage = {};
+
 void CMemoryMap::InsertReadMap(uint32 start, uint32 end, void* pointer, unsigned char key)
 {
 	assert(GetReadMap(start) == nullptr);
@@ -16,6 +21,12 @@ void CMemoryMap::InsertReadMap(uint32 start, uint32 end, const MemoryMapHandlerT
 	InsertMap(m_readMap, start, end, handler, key);
 }
 
+void CMemoryMap::InsertReadMap(uint32 start, uint32 end, MemoryMapHandlerFunctionType handler, void* context, unsigned char key)
+{
+	assert(GetReadMap(start) == nullptr);
+	InsertMap(m_readMap, start, end, handler, context, key);
+}
+
 void CMemoryMap::InsertWriteMap(uint32 start, uint32 end, void* pointer, unsigned char key)
 {
 	assert(GetWriteMap(start) == nullptr);
@@ -28,6 +39,12 @@ void CMemoryMap::InsertWriteMap(uint32 start, uint32 end, const MemoryMapHandler
 	InsertMap(m_writeMap, start, end, handler, key);
 }
 
+void CMemoryMap::InsertWriteMap(uint32 start, uint32 end, MemoryMapHandlerFunctionType handler, void* context, unsigned char key)
+{
+	assert(GetWriteMap(start) == nullptr);
+	InsertMap(m_writeMap, start, end, handler, context, key);
+}
+
 void CMemoryMap::InsertInstructionMap(uint32 start, uint32 end, void* pointer, unsigned char key)
 {
 	assert(GetMap(m_instructionMap, start) == nullptr);
@@ -44,17 +61,18 @@ const CMemoryMap::MEMORYMAPELEMENT* CMemoryMap::GetWriteMap(uint32 address) cons
 	return GetMap(m_writeMap, address);
 }
 
-void CMemoryMap::InsertMap(MemoryMapListType& memoryMap, uint32 start, uint32 end, void* pointer, unsigned char key)
+void CMemoryMap::InsertMap(MAP& memoryMap, uint32 start, uint32 end, void* pointer, unsigned char key)
 {
 	MEMORYMAPELEMENT element;
 	element.nStart = start;
 	element.nEnd = end;
 	element.pPointer = pointer;
 	element.nType = MEMORYMAP_TYPE_MEMORY;
-	memoryMap.push_back(element);
+	memoryMap.elements.push_back(element);
+	BuildIndex(memoryMap);
 }
 
-void CMemoryMap::InsertMap(MemoryMapListType& memoryMap, uint32 start, uint32 end, const MemoryMapHandlerType& handler, unsigned char key)
+void CMemoryMap::InsertMap(MAP& memoryMap, uint32 start, uint32 end, const MemoryMapHandlerType& handler, unsigned char key)
 {
 	MEMORYMAPELEMENT element;
 	element.nStart = start;
@@ -62,10 +80,86 @@ void CMemoryMap::InsertMap(MemoryMapListType& memoryMap, uint32 start, uint32 en
 	element.handler = handler;
 	element.pPointer = nullptr;
 	element.nType = MEMORYMAP_TYPE_FUNCTION;
-	memoryMap.push_back(element);
+	memoryMap.elements.push_back(element);
+	auto& insertedElement = memoryMap.elements.back();
+	insertedElement.handlerFunction = &CallStdFunctionHandler;
+	insertedElement.handlerContext = &insertedElement.handler;
+	BuildIndex(memoryMap);
+}
+
+void CMemoryMap::InsertMap(MAP& memoryMap, uint32 start, uint32 end, MemoryMapHandlerFunctionType handler, void* context, unsigned char key)
+{
+	MEMORYMAPELEMENT element;
+	element.nStart = start;
+	element.nEnd = end;
+	element.pPointer = nullptr;
+	element.nType = MEMORYMAP_TYPE_FUNCTION;
+	element.handlerFunction = handler;
+	element.handlerContext = context;
+	memoryMap.elements.push_back(element);
+	BuildIndex(memoryMap);
+}
+
+uint32 CMemoryMap::CallStdFunctionHandler(void* context, uint32 address, uint32 value)
+{
+	return (*reinterpret_cast<const MemoryMapHandlerType*>(context))(address, value);
+}
+
+//Maps are only changed during initialization, the whole index is rebuilt every time
+void CMemoryMap::BuildIndex(MAP& memoryMap)
+{
+	//Lookup results only change at those addresses
+	std::vector<uint64> boundaries;
+	for(const auto& element : memoryMap.elements)
+	{
+		boundaries.push_back(element.nStart);
+		boundaries.push_back(static_cast<uint64>(element.nEnd) + 1);
+	}
+	std::sort(boundaries.begin(), boundaries.end());
+
+	auto hasBoundaryInside = [&boundaries](uint64 rangeStart, uint64 rangeSize) {
+		auto boundaryIterator = std::upper_bound(boundaries.begin(), boundaries.end(), rangeStart);
+		return (boundaryIterator != boundaries.end()) && (*boundaryIterator < (rangeStart + rangeSize));
+	};
+
+	static const uint64 pageSize = (1ULL << PAGE_BITS);
+	static const uint64 directorySize = (pageSize << DIRECTORY_BITS);
+	for(uint32 directoryIndex = 0; directoryIndex < DIRECTORY_COUNT; directoryIndex++)
+	{
+		auto& directory = memoryMap.directories[directoryIndex];
+		uint64 directoryStart = directoryIndex * directorySize;
+		if(!hasBoundaryInside(directoryStart, directorySize))
+		{
+			directory.element = FindElement(memoryMap.elements, static_cast<uint32>(directoryStart));
+			directory.pages.reset();
+			continue;
+		}
+		directory.element = nullptr;
+		directory.pages = std::make_unique<const MEMORYMAPELEMENT*[]>(PAGES_PER_DIRECTORY);
+		for(uint32 pageIndex = 0; pageIndex < PAGES_PER_DIRECTORY; pageIndex++)
+		{
+			uint64 pageStart = directoryStart + (pageIndex * pageSize);
+			directory.pages[pageIndex] = hasBoundaryInside(pageStart, pageSize) ? &g_mixedPage : FindElement(memoryMap.elements, static_cast<uint32>(pageStart));
+		}
+	}
+}
+
+const CMemoryMap::MEMORYMAPELEMENT* CMemoryMap::GetMap(const MAP& memoryMap, uint32 address)
+{
+	const auto& directory = memoryMap.directories[address >> (PAGE_BITS + DIRECTORY_BITS)];
+	if(!directory.pages)
+	{
+		return directory.element;
+	}
+	auto element = directory.pages[(address >> PAGE_BITS) & (PAGES_PER_DIRECTORY - 1)];
+	if(element != &g_mixedPage)
+	{
+		return element;
+	}
+	return FindElement(memoryMap.elements, address);
 }
 
-const CMemoryMap::MEMORYMAPELEMENT* CMemoryMap::GetMap(const MemoryMapListType& memoryMap, uint32 nAddress)
+const CMemoryMap::MEMORYMAPELEMENT* CMemoryMap::FindElement(const MemoryMapListType& memoryMap, uint32 nAddress)
 {
 	for(const auto& mapElement : memoryMap)
 	{
@@ -92,7 +186,7 @@ uint8 CMemoryMap::GetByte(uint32 nAddress)
 		return *(uint8*)&((uint8*)e->pPointer)[nAddress - e->nStart];
 		break;
 	case MEMORYMAP_TYPE_FUNCTION:
-		return static_cast<uint8>(e->handler(nAddress, 0));
+		return static_cast<uint8>(e->CallHandler(nAddress, 0));
 		break;
 	default:
 		assert(0);
@@ -115,7 +209,7 @@ void CMemoryMap::SetByte(uint32 nAddress, uint8 nValue)
 		*(uint8*)&((uint8*)e->pPointer)[nAddress - e->nStart] = nValue;
 		break;
 	case MEMORYMAP_TYPE_FUNCTION:
-		e->handler(nAddress, nValue);
+		e->CallHandler(nAddress, nValue);
 		break;
 	default:
 		assert(0);
@@ -142,7 +236,7 @@ uint16 CMemoryMap_LSBF::GetHalf(uint32 nAddress)
 		return *(uint16*)&((uint8*)e->pPointer)[nAddress - e->nStart];
 		break;
 	default:
-		return static_cast<uint16>(e->handler(nAddress, 0));
+		return static_cast<uint16>(e->CallHandler(nAddress, 0));
 		break;
 	}
 }
@@ -162,7 +256,7 @@ uint32 CMemoryMap_LSBF::GetWord(uint32 nAddress)
 		return *(uint32*)&((uint8*)e->pPointer)[nAddress - e->nStart];
 		break;
 	case MEMORYMAP_TYPE_FUNCTION:
-		return e->handler(nAddress, 0);
+		return e->CallHandler(nAddress, 0);
 		break;
 	default:
 		assert(0);
@@ -203,7 +297,7 @@ void CMemoryMap_LSBF::SetHalf(uint32 nAddress, uint16 nValue)
 		*reinterpret_cast<uint16*>(&reinterpret_cast<uint8*>(e->pPointer)[nAddress - e->nStart]) = nValue;
 		break;
 	case MEMORYMAP_TYPE_FUNCTION:
-		e->handler(nAddress, nValue);
+		e->CallHandler(nAddress, nValue);
 		break;
 	default:
 		assert(0);
@@ -226,7 +320,7 @@ void CMemoryMap_LSBF::SetWord(uint32 nAddress, uint32 nValue)
 		*(uint32*)&((uint8*)e->pPointer)[nAddress - e->nStart] = nValue;
 		break;
 	case MEMORYMAP_TYPE_FUNCTION:
-		e->handler(nAddress, nValue);
+		e->CallHandler(nAddress, nValue);
 		break;
 	default:
 		assert(0);
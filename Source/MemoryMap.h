@@ -2,8 +2,9 @@
 #define _MEMORYMAP_H_
 
 #include "Types.h"
+#include <deque>
 #include <functional>
-#include <vector>
+#include <memory>
 
 enum MEMORYMAP_ENDIANESS
 {
@@ -15,6 +16,8 @@ class CMemoryMap
 {
 public:
 	typedef std::function<uint32(uint32, uint32)> MemoryMapHandlerType;
+	//Plain handler, first parameter is the context given when inserting the map
+	typedef uint32 (*MemoryMapHandlerFunctionType)(void*, uint32, uint32);
 
 	enum MEMORYMAP_TYPE
 	{
@@ -29,8 +32,29 @@ public:
 		void* pPointer;
 		MemoryMapHandlerType handler;
 		MEMORYMAP_TYPE nType;
+		MemoryMapHandlerFunctionType handlerFunction = nullptr;
+		void* handlerContext = nullptr;
+
+		//Works for all function elements, whether they were inserted with a plain handler or not
+		uint32 CallHandler(uint32 address, uint32 value) const
+		{
+			return handlerFunction(handlerContext, address, value);
+		}
 	};
 
+	//Adapters to use member functions as plain handlers (context is the object)
+	template <typename ObjectType, uint32 (ObjectType::*Handler)(uint32)>
+	static uint32 ReadHandlerAdapter(void* context, uint32 address, uint32)
+	{
+		return (static_cast<ObjectType*>(context)->*Handler)(address);
+	}
+
+	template <typename ObjectType, uint32 (ObjectType::*Handler)(uint32, uint32)>
+	static uint32 WriteHandlerAdapter(void* context, uint32 address, uint32 value)
+	{
+		return (static_cast<ObjectType*>(context)->*Handler)(address, value);
+	}
+
 	virtual ~CMemoryMap() = default;
 	uint8 GetByte(uint32);
 	virtual uint16 GetHalf(uint32) = 0;
@@ -41,24 +65,56 @@ public:
 	virtual void SetWord(uint32, uint32) = 0;
 	void InsertReadMap(uint32, uint32, void*, unsigned char);
 	void InsertReadMap(uint32, uint32, const MemoryMapHandlerType&, unsigned char);
+	void InsertReadMap(uint32, uint32, MemoryMapHandlerFunctionType, void*, unsigned char);
 	void InsertWriteMap(uint32, uint32, void*, unsigned char);
 	void InsertWriteMap(uint32, uint32, const MemoryMapHandlerType&, unsigned char);
+	void InsertWriteMap(uint32, uint32, MemoryMapHandlerFunctionType, void*, unsigned char);
 	void InsertInstructionMap(uint32, uint32, void*, unsigned char);
 	const MEMORYMAPELEMENT* GetReadMap(uint32) const;
 	const MEMORYMAPELEMENT* GetWriteMap(uint32) const;
 
 protected:
-	typedef std::vector<MEMORYMAPELEMENT> MemoryMapListType;
+	//Elements must not move once inserted, the page index and handlers refer to them
+	typedef std::deque<MEMORYMAPELEMENT> MemoryMapListType;
 
-	static const MEMORYMAPELEMENT* GetMap(const MemoryMapListType&, uint32);
+	enum
+	{
+		PAGE_BITS = 12,
+		DIRECTORY_BITS = 10,
+		PAGES_PER_DIRECTORY = (1 << DIRECTORY_BITS),
+		DIRECTORY_COUNT = (1 << (32 - PAGE_BITS - DIRECTORY_BITS)),
+	};
 
-	MemoryMapListType m_instructionMap;
-	MemoryMapListType m_readMap;
-	MemoryMapListType m_writeMap;
+	//Two level page index of a map. A directory entry without pages (or a page) resolves
+	//to the same element for all of its addresses, unless the page has several elements in it.
+	struct MAPDIRECTORY
+	{
+		const MEMORYMAPELEMENT* element = nullptr;
+		std::unique_ptr<const MEMORYMAPELEMENT*[]> pages;
+	};
+
+	struct MAP
+	{
+		MemoryMapListType elements;
+		MAPDIRECTORY directories[DIRECTORY_COUNT];
+	};
+
+	static const MEMORYMAPELEMENT* GetMap(const MAP&, uint32);
+	//Linear lookup, only used to build the index and for pages with several elements
+	static const MEMORYMAPELEMENT* FindElement(const MemoryMapListType&, uint32);
+
+	MAP m_instructionMap;
+	MAP m_readMap;
+	MAP m_writeMap;
 
 private:
-	static void InsertMap(MemoryMapListType&, uint32, uint32, void*, unsigned char);
-	static void InsertMap(MemoryMapListType&, uint32, uint32, const MemoryMapHandlerType&, unsigned char);
+	static void InsertMap(MAP&, uint32, uint32, void*, unsigned char);
+	static void InsertMap(MAP&, uint32, uint32, const MemoryMapHandlerType&, unsigned char);
+	static void InsertMap(MAP&, uint32, uint32, MemoryMapHandlerFunctionType, void*, unsigned char);
+	static void BuildIndex(MAP&);
+	static uint32 CallStdFunctionHandler(void*, uint32, uint32);
+
+	static const MEMORYMAPELEMENT g_mixedPage;
 };
 
 class CMemoryMap_LSBF : public CMemoryMap
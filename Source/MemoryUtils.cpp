@@ -41,7 +41,7 @@ uint64 MemoryUtils_GetDoubleProxy(CMIPS* context, uint32 vAddress)
 		case CMemoryMap::MEMORYMAP_TYPE_FUNCTION:
 			for(unsigned int i = 0; i < 2; i++)
 			{
-				result.d[i] = e->handler(address + (i * 4), 0);
+				result.d[i] = e->CallHandler(address + (i * 4), 0);
 			}
 			break;
 		default:
@@ -71,7 +71,7 @@ uint128 MemoryUtils_GetQuadProxy(CMIPS* context, uint32 vAddress)
 		case CMemoryMap::MEMORYMAP_TYPE_FUNCTION:
 			for(unsigned int i = 0; i < 4; i++)
 			{
-				result.nV[i] = e->handler(address + (i * 4), 0);
+				result.nV[i] = e->CallHandler(address + (i * 4), 0);
 			}
 			break;
 		default:
@@ -121,7 +121,7 @@ void MemoryUtils_SetDoubleProxy(CMIPS* context, uint64 value64, uint32 vAddress)
 	case CMemoryMap::MEMORYMAP_TYPE_FUNCTION:
 		for(unsigned int i = 0; i < 2; i++)
 		{
-			e->handler(address + (i * 4), value.d[i]);
+			e->CallHandler(address + (i * 4), value.d[i]);
 		}
 		break;
 	default:
@@ -149,7 +149,7 @@ void MemoryUtils_SetQuadProxy(CMIPS* context, const uint128& value, uint32 vAddr
 	case CMemoryMap::MEMORYMAP_TYPE_FUNCTION:
 		for(unsigned int i = 0; i < 4; i++)
 		{
-			e->handler(address + (i * 4), value.nV[i]);
+			e->CallHandler(address + (i * 4), value.nV[i]);
 		}
 		break;
 	default:
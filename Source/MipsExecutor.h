@@ -2,6 +2,8 @@
 
 #include "Types.h"
 
+class CJitCodeCache;
+
 class CMipsExecutor
 {
 public:
@@ -9,6 +11,7 @@ public:
 	virtual void Reset() = 0;
 	virtual int Execute(int) = 0;
 	virtual void ClearActiveBlocksInRange(uint32 start, uint32 end, bool executing) = 0;
+	virtual void SetCodeCache(CJitCodeCache*) = 0;
 
 #ifdef DEBUGGER_INCLUDED
 	virtual bool MustBreak() const = 0;
@@ -1,5 +1,9 @@
 #include <stdio.h>
+#include <algorithm>
+#include <cassert>
 #include <exception>
+#include <mutex>
+#include <stdexcept>
 #include <memory>
 #include <fenv.h>
 #include "make_unique.h"
@@ -8,6 +12,8 @@
 #include "PS2VM_Preferences.h"
 #include "ee/PS2OS.h"
 #include "ee/EeExecutor.h"
+#include "JitCodeArena.h"
+#include "BasicBlockPool.h"
 #include "Ps2Const.h"
 #include "iop/Iop_SifManPs2.h"
 #include "StdStream.h"
@@ -25,8 +31,10 @@
 #include "iop/DirectoryDevice.h"
 #include "iop/OpticalMediaDevice.h"
 #include "Log.h"
+#include "Trace.h"
 #include "ISO9660/BlockProvider.h"
 #include "DiskUtils.h"
+#include "CompressedImageBlockCache.h"
 
 #define LOG_NAME ("ps2vm")
 
@@ -34,10 +42,35 @@
 #define PREF_PS2_MC0_DIRECTORY_DEFAULT ("vfs/mc0")
 #define PREF_PS2_MC1_DIRECTORY_DEFAULT ("vfs/mc1")
 
+#define MAX_INSTANCE_COUNT 32
+
 #define FRAME_TICKS (PS2::EE_CLOCK_FREQ / 60)
 #define ONSCREEN_TICKS (FRAME_TICKS * 9 / 10)
 #define VBLANK_TICKS (FRAME_TICKS / 10)
 
+//Instance indices of live virtual machines, the lowest free one is given to new instances
+static std::mutex g_instanceIndicesMutex;
+static uint32 g_instanceIndices = 0;
+
+static uint32 AllocateInstanceIndex()
+{
+	std::lock_guard<std::mutex> instanceIndicesLock(g_instanceIndicesMutex);
+	for(uint32 i = 0; i < MAX_INSTANCE_COUNT; i++)
+	{
+		if(g_instanceIndices & (1 << i)) continue;
+		g_instanceIndices |= (1 << i);
+		return i;
+	}
+	throw std::runtime_error("Too many virtual machine instances.");
+}
+
+static void ReleaseInstanceIndex(uint32 index)
+{
+	std::lock_guard<std::mutex> instanceIndicesLock(g_instanceIndicesMutex);
+	assert(g_instanceIndices & (1 << index));
+	g_instanceIndices &= ~(1 << index);
+}
+
 CPS2VM::CPS2VM()
     : m_nStatus(PAUSED)
     , m_nEnd(false)
@@ -51,11 +84,11 @@ CPS2VM::CPS2VM()
     , m_eeExecutionTicks(0)
     , m_iopExecutionTicks(0)
     , m_spuUpdateTicks(SPU_UPDATE_TICKS)
-    , m_eeProfilerZone(CProfiler::GetInstance().RegisterZone("EE"))
-    , m_iopProfilerZone(CProfiler::GetInstance().RegisterZone("IOP"))
-    , m_spuProfilerZone(CProfiler::GetInstance().RegisterZone("SPU"))
-    , m_gsSyncProfilerZone(CProfiler::GetInstance().RegisterZone("GSSYNC"))
-    , m_otherProfilerZone(CProfiler::GetInstance().RegisterZone("OTHER"))
+    , m_eeProfilerZone(CProfiler::RegisterZone("EE"))
+    , m_iopProfilerZone(CProfiler::RegisterZone("IOP"))
+    , m_spuProfilerZone(CProfiler::RegisterZone("SPU"))
+    , m_gsSyncProfilerZone(CProfiler::RegisterZone("GSSYNC"))
+    , m_otherProfilerZone(CProfiler::RegisterZone("OTHER"))
 {
 	static const std::pair<const char*, const char*> basicDirectorySettings[] =
 	    {
@@ -82,16 +115,92 @@ CPS2VM::CPS2VM()
 
 	CAppConfig::GetInstance().RegisterPreferencePath(PREF_PS2_CDROM0_PATH, "");
 
+	//Compressed disc images (CSO, ISZ): cache size in MB and number of blocks read ahead
+	{
+		auto imageCacheConfig = CCompressedImageBlockCache::GetDefaultConfig();
+		CAppConfig::GetInstance().RegisterPreferenceInteger(PREF_PS2_IMAGECACHE_SIZE, imageCacheConfig.memoryBudget / (1024 * 1024));
+		CAppConfig::GetInstance().RegisterPreferenceInteger(PREF_PS2_IMAGECACHE_PREFETCH, imageCacheConfig.prefetchBlockCount);
+		imageCacheConfig.memoryBudget = static_cast<uint32>(std::max(CAppConfig::GetInstance().GetPreferenceInteger(PREF_PS2_IMAGECACHE_SIZE), 0)) * 1024 * 1024;
+		imageCacheConfig.prefetchBlockCount = std::max(CAppConfig::GetInstance().GetPreferenceInteger(PREF_PS2_IMAGECACHE_PREFETCH), 0);
+		CCompressedImageBlockCache::SetDefaultConfig(imageCacheConfig);
+	}
+
 	Framework::PathUtils::EnsurePathExists(GetStateDirectoryPath());
 
-	m_iop = std::make_unique<Iop::CSubSystem>(true);
+	//Writes TRACE_PRINT points to logs/trace.bin, read it back with TraceDecoder
+	CAppConfig::GetInstance().RegisterPreferenceBoolean(PREF_LOG_TRACE_ENABLED, false);
+	if(CAppConfig::GetInstance().GetPreferenceBoolean(PREF_LOG_TRACE_ENABLED))
+	{
+		CTrace::GetInstance().Start();
+	}
+
+	//Maps guest memory in host address space for EE and IOP loads/stores (only on supported platforms)
+	CAppConfig::GetInstance().RegisterPreferenceBoolean(PREF_PS2_FASTMEMORY_ENABLED, false);
+	m_fastMemoryEnabled = CAppConfig::GetInstance().GetPreferenceBoolean(PREF_PS2_FASTMEMORY_ENABLED) && CFastMemoryArena::IsSupported();
+
+	//Runs VU1 microprograms on their own thread (not available with the debugger, it needs the VU state of every XGKICK)
+	CAppConfig::GetInstance().RegisterPreferenceBoolean(PREF_PS2_VU1THREAD_ENABLED, false);
+#ifdef DEBUGGER_INCLUDED
+	bool vu1ThreadEnabled = false;
+#else
+	bool vu1ThreadEnabled = CAppConfig::GetInstance().GetPreferenceBoolean(PREF_PS2_VU1THREAD_ENABLED);
+#endif
+
+	//Runs the IOP on its own thread, synchronizing with the EE on SIF transfers and every maxskew EE cycles at most
+	CAppConfig::GetInstance().RegisterPreferenceBoolean(PREF_PS2_IOPTHREAD_ENABLED, false);
+	CAppConfig::GetInstance().RegisterPreferenceInteger(PREF_PS2_IOPTHREAD_MAXSKEW, 4800 * 8);
+#ifndef DEBUGGER_INCLUDED
+	m_iopThreadEnabled = CAppConfig::GetInstance().GetPreferenceBoolean(PREF_PS2_IOPTHREAD_ENABLED);
+#endif
+	m_iopMaxSkew = CAppConfig::GetInstance().GetPreferenceInteger(PREF_PS2_IOPTHREAD_MAXSKEW);
+
+	m_iop = std::make_unique<Iop::CSubSystem>(true, m_fastMemoryEnabled);
 	auto iopOs = dynamic_cast<CIopBios*>(m_iop->m_bios.get());
 
-	m_ee = std::make_unique<Ee::CSubSystem>(m_iop->m_ram, *iopOs);
+	m_ee = std::make_unique<Ee::CSubSystem>(m_iop->m_ram, *iopOs, m_fastMemoryEnabled, vu1ThreadEnabled);
+
+	//Decodes IPU blocks with a fixed-point IDCT (within IEEE 1180 accuracy, but not bit exact with the reference)
+	CAppConfig::GetInstance().RegisterPreferenceBoolean(PREF_PS2_IPU_FASTIDCT_ENABLED, false);
+	m_ee->m_ipu.SetFastIdctEnabled(CAppConfig::GetInstance().GetPreferenceBoolean(PREF_PS2_IPU_FASTIDCT_ENABLED));
+
+	//Decodes IPU macroblocks on worker threads, bitstream parsing stays on the EE thread
+	CAppConfig::GetInstance().RegisterPreferenceInteger(PREF_PS2_IPU_DECODETHREADS, 0);
+	m_ee->m_ipu.SetDecodeThreadCount(std::max(CAppConfig::GetInstance().GetPreferenceInteger(PREF_PS2_IPU_DECODETHREADS), 0));
 	m_OnRequestLoadExecutableConnection = m_ee->m_os->OnRequestLoadExecutable.Connect(std::bind(&CPS2VM::ReloadExecutable, this, std::placeholders::_1, std::placeholders::_2));
 
 	CAppConfig::GetInstance().RegisterPreferenceInteger(PREF_AUDIO_SPUBLOCKCOUNT, 100);
 	m_spuBlockCount = CAppConfig::GetInstance().GetPreferenceInteger(PREF_AUDIO_SPUBLOCKCOUNT);
+
+	//Number of buffers (of spublockcount ms each) queued for the sound output thread, 0 writes them on the emulation thread
+	CAppConfig::GetInstance().RegisterPreferenceInteger(PREF_AUDIO_SPUOUTPUTBUFFERS, 0);
+	CAppConfig::GetInstance().RegisterPreferenceBoolean(PREF_AUDIO_SPUMIXTHREAD, false);
+	if(CAppConfig::GetInstance().GetPreferenceBoolean(PREF_AUDIO_SPUMIXTHREAD))
+	{
+		m_spuMixWorker = std::make_unique<Iop::CSpuMixWorker>();
+	}
+
+	CAppConfig::GetInstance().RegisterPreferenceBoolean(PREF_PS2_JITCODECACHE_ENABLED, false);
+	//Size in MB of each saved code cache, least recently used blocks are dropped past that
+	CAppConfig::GetInstance().RegisterPreferenceInteger(PREF_PS2_JITCODECACHE_BUDGET, CJitCodeCache::DEFAULT_BUDGET / (1024 * 1024));
+	CAppConfig::GetInstance().RegisterPreferenceInteger(PREF_PS2_SPECULATIVEJIT_THREADS, 0);
+
+	//Budget for generated code in MB, executors drop their blocks when it's exceeded (0 is unlimited)
+	CAppConfig::GetInstance().RegisterPreferenceInteger(PREF_PS2_JITCODEARENA_BUDGET, 0);
+	{
+		uint64 codeBudget = std::max(CAppConfig::GetInstance().GetPreferenceInteger(PREF_PS2_JITCODEARENA_BUDGET), 0);
+		CJitCodeArena::GetInstance().SetBudget(codeBudget * 1024 * 1024);
+	}
+
+	m_instanceIndex = AllocateInstanceIndex();
+	if(m_instanceIndex != 0)
+	{
+		m_logContext = string_format("vm%d", m_instanceIndex);
+	}
+}
+
+CPS2VM::~CPS2VM()
+{
+	ReleaseInstanceIndex(m_instanceIndex);
 }
 
 //////////////////////////////////////////////////
@@ -226,6 +335,18 @@ void CPS2VM::DumpEEDmacHandlers()
 void CPS2VM::Initialize()
 {
 	CreateVM();
+	LoadCodeCaches();
+	{
+		int speculativeJitThreads = CAppConfig::GetInstance().GetPreferenceInteger(PREF_PS2_SPECULATIVEJIT_THREADS);
+		if(speculativeJitThreads > 0)
+		{
+			auto eeExecutor = static_cast<CEeExecutor*>(m_ee->m_EE.m_executor.get());
+			if(!eeExecutor->EnableSpeculativeCompilation(speculativeJitThreads, 0, PS2::EE_RAM_SIZE))
+			{
+				CLog::GetInstance().Warn(LOG_NAME, "Speculative compilation isn't supported by the EE executor.\r\n");
+			}
+		}
+	}
 	m_nEnd = false;
 	m_thread = std::thread([&]() { EmuThread(); });
 }
@@ -234,6 +355,27 @@ void CPS2VM::Destroy()
 {
 	m_mailBox.SendCall(std::bind(&CPS2VM::DestroyImpl, this));
 	m_thread.join();
+	if(!SaveCodeCaches())
+	{
+		printf("PS2VM: Failed to save JIT code caches to '%s'.\r\n", GetCodeCacheDirectoryPath().string().c_str());
+	}
+	{
+		auto eeExecutor = static_cast<CEeExecutor*>(m_ee->m_EE.m_executor.get());
+		auto stats = eeExecutor->GetSpeculativeCompilerStats();
+		if(stats.requested != 0)
+		{
+			CLog::GetInstance().Print(LOG_NAME, "Speculative JIT: %d requested, %d compiled, %d hits, %d wasted.\r\n",
+			                          stats.requested, stats.compiled, stats.hits, stats.wasted);
+		}
+	}
+	{
+		auto stats = CJitCodeArena::GetInstance().GetStats();
+		auto poolStats = CBasicBlockPool::GetInstance().GetStats();
+		CLog::GetInstance().Print(LOG_NAME, "JIT code arena: %d slabs, %dKB used (%dKB peak), %d allocations, %d reused, %d flushes. Block pool: %dKB, %d live blocks.\r\n",
+		                          stats.slabCount, static_cast<uint32>(stats.used / 1024), static_cast<uint32>(stats.peakUsed / 1024),
+		                          stats.allocationCount, stats.reusedCount, stats.flushCount,
+		                          static_cast<uint32>(poolStats.slabBytes / 1024), poolStats.liveCount);
+	}
 	DestroyVM();
 }
 
@@ -242,6 +384,11 @@ fs::path CPS2VM::GetStateDirectoryPath()
 	return CAppConfig::GetBasePath() / fs::path("states/");
 }
 
+fs::path CPS2VM::GetCodeCacheDirectoryPath()
+{
+	return CAppConfig::GetBasePath() / fs::path("jitcache/");
+}
+
 fs::path CPS2VM::GenerateStatePath(unsigned int slot) const
 {
 	auto stateFileName = string_format("%s.st%d.zip", m_ee->m_os->GetExecutableName(), slot);
@@ -485,6 +632,10 @@ bool CPS2VM::LoadVMState(const fs::path& statePath)
 void CPS2VM::PauseImpl()
 {
 	m_nStatus = PAUSED;
+	if(m_soundOutputThread)
+	{
+		m_soundOutputThread->Flush();
+	}
 }
 
 void CPS2VM::ResumeImpl()
@@ -517,6 +668,14 @@ void CPS2VM::DestroyGsHandlerImpl()
 {
 	if(m_ee->m_gs == nullptr) return;
 	m_ee->m_gs->Release();
+	{
+		auto stats = m_ee->m_gs->GetTransferStats();
+		if(stats.imagePackets != 0)
+		{
+			CLog::GetInstance().Print(LOG_NAME, "GS image transfers: %llu bytes in %d packets (%d through the command ring), %d buffer allocations, %d buffers reused from the pool.\r\n",
+			                          stats.imageBytes, stats.imagePackets, stats.ringPackets, stats.allocations, stats.allocationsSaved);
+		}
+	}
 	delete m_ee->m_gs;
 	m_ee->m_gs = nullptr;
 }
@@ -537,6 +696,11 @@ void CPS2VM::DestroyPadHandlerImpl()
 void CPS2VM::CreateSoundHandlerImpl(const CSoundHandler::FactoryFunction& factoryFunction)
 {
 	m_soundHandler = factoryFunction();
+	int outputBufferCount = CAppConfig::GetInstance().GetPreferenceInteger(PREF_AUDIO_SPUOUTPUTBUFFERS);
+	if((m_soundHandler != nullptr) && (outputBufferCount > 0))
+	{
+		m_soundOutputThread = std::make_unique<CSoundOutputThread>(m_soundHandler, BLOCK_SIZE * BLOCK_COUNT, outputBufferCount);
+	}
 }
 
 CSoundHandler* CPS2VM::GetSoundHandler()
@@ -547,6 +711,14 @@ CSoundHandler* CPS2VM::GetSoundHandler()
 void CPS2VM::DestroySoundHandlerImpl()
 {
 	if(m_soundHandler == nullptr) return;
+	if(m_soundOutputThread)
+	{
+		m_soundOutputThread->Flush();
+		auto stats = m_soundOutputThread->GetStats();
+		CLog::GetInstance().Print(LOG_NAME, "Sound output: %d buffers written, %d underruns, %d producer waits, %d buffers queued at most.\r\n",
+		                          stats.buffersWritten, stats.underruns, stats.producerWaits, stats.maxQueuedBuffers);
+		m_soundOutputThread.reset();
+	}
 	delete m_soundHandler;
 	m_soundHandler = nullptr;
 }
@@ -614,6 +786,12 @@ void CPS2VM::UpdateIop()
 	CProfilerZone profilerZone(m_iopProfilerZone);
 #endif
 
+	ExecuteIop();
+}
+
+//Also runs on the IOP worker thread, can't use profiler zones
+void CPS2VM::ExecuteIop()
+{
 	while(m_iopExecutionTicks > 0)
 	{
 		int executed = m_iop->ExecuteCpu(m_singleStepIop ? 1 : m_iopExecutionTicks);
@@ -648,12 +826,36 @@ void CPS2VM::UpdateSpu()
 	unsigned int blockOffset = (BLOCK_SIZE * m_currentSpuBlock);
 	int16* samplesSpu0 = m_samples + blockOffset;
 
-	m_iop->m_spuCore0.Render(samplesSpu0, BLOCK_SIZE, DST_SAMPLE_RATE);
+	auto& spuCore0 = m_iop->m_spuCore0;
+	auto& spuCore1 = m_iop->m_spuCore1;
+	bool spuCore1Enabled = spuCore1.IsEnabled();
+	bool mixInParallel = m_spuMixWorker && spuCore1Enabled;
+
+	if(mixInParallel)
+	{
+		//Core 1's voices are mixed while core 0's are. Core 1 renders after core 0 and might read
+		//what core 0's reverb writes, it needs to know about that range to stay exact.
+		m_spuMixWorker->MixVoices(spuCore1, BLOCK_SIZE, DST_SAMPLE_RATE, spuCore0.GetReverbWriteRange());
+		spuCore0.MixVoices(BLOCK_SIZE, DST_SAMPLE_RATE, Iop::CSpuBase::ADDRESS_RANGE());
+		m_spuMixWorker->Wait();
+		spuCore0.FinishRender(samplesSpu0, BLOCK_SIZE, DST_SAMPLE_RATE);
+	}
+	else
+	{
+		spuCore0.Render(samplesSpu0, BLOCK_SIZE, DST_SAMPLE_RATE);
+	}
 
-	if(m_iop->m_spuCore1.IsEnabled())
+	if(spuCore1Enabled)
 	{
 		int16 samplesSpu1[BLOCK_SIZE];
-		m_iop->m_spuCore1.Render(samplesSpu1, BLOCK_SIZE, DST_SAMPLE_RATE);
+		if(mixInParallel)
+		{
+			spuCore1.FinishRender(samplesSpu1, BLOCK_SIZE, DST_SAMPLE_RATE);
+		}
+		else
+		{
+			spuCore1.Render(samplesSpu1, BLOCK_SIZE, DST_SAMPLE_RATE);
+		}
 
 		for(unsigned int i = 0; i < BLOCK_SIZE; i++)
 		{
@@ -667,7 +869,11 @@ void CPS2VM::UpdateSpu()
 	m_currentSpuBlock++;
 	if(m_currentSpuBlock == m_spuBlockCount)
 	{
-		if(m_soundHandler)
+		if(m_soundOutputThread)
+		{
+			m_soundOutputThread->Write(m_samples, BLOCK_SIZE * m_spuBlockCount, DST_SAMPLE_RATE);
+		}
+		else if(m_soundHandler)
 		{
 			if(m_soundHandler->HasFreeBuffers())
 			{
@@ -730,18 +936,102 @@ void CPS2VM::RegisterModulesInPadHandler()
 
 void CPS2VM::ReloadExecutable(const char* executablePath, const CPS2OS::ArgumentList& arguments)
 {
+	//Requested by the EE in the middle of a time slice
+	if(m_iopWorker)
+	{
+		m_iopWorker->Wait(Iop::CSubSystemWorker::SYNC_POINT_IOP_ACCESS);
+	}
 	ResetVM();
 	m_ee->m_os->BootFromVirtualPath(executablePath, arguments);
 }
 
+static const char* g_codeCacheFileNames[] =
+    {
+        "ee.jitcache",
+        "iop.jitcache",
+        "vu0.jitcache",
+        "vu1.jitcache"};
+
+//EE and IOP code generated with fast memory accesses can't be used without fast memory
+std::string CPS2VM::GetCodeCacheFileName(unsigned int index) const
+{
+	std::string fileName = g_codeCacheFileNames[index];
+	if(m_fastMemoryEnabled && ((index == CODE_CACHE_EE) || (index == CODE_CACHE_IOP)))
+	{
+		fileName += ".fastmem";
+	}
+	return fileName;
+}
+
+void CPS2VM::LoadCodeCaches()
+{
+	m_codeCacheEnabled = CAppConfig::GetInstance().GetPreferenceBoolean(PREF_PS2_JITCODECACHE_ENABLED);
+	if(!m_codeCacheEnabled) return;
+
+	CMIPS* cpus[CODE_CACHE_MAX] =
+	    {
+	        &m_ee->m_EE,
+	        &m_iop->m_cpu,
+	        &m_ee->m_VU0,
+	        &m_ee->m_VU1,
+	    };
+
+	auto codeCachePath = GetCodeCacheDirectoryPath();
+	Framework::PathUtils::EnsurePathExists(codeCachePath);
+
+	uint64 codeCacheBudget = std::max(CAppConfig::GetInstance().GetPreferenceInteger(PREF_PS2_JITCODECACHE_BUDGET), 0);
+	for(unsigned int i = 0; i < CODE_CACHE_MAX; i++)
+	{
+		auto& codeCache = m_codeCaches[i];
+		codeCache.SetBudget(codeCacheBudget * 1024 * 1024);
+		codeCache.Load(codeCachePath / GetCodeCacheFileName(i));
+		cpus[i]->m_executor->SetCodeCache(&codeCache);
+	}
+}
+
+bool CPS2VM::SaveCodeCaches()
+{
+	if(!m_codeCacheEnabled) return true;
+
+	bool result = true;
+	auto codeCachePath = GetCodeCacheDirectoryPath();
+	for(unsigned int i = 0; i < CODE_CACHE_MAX; i++)
+	{
+		auto& codeCache = m_codeCaches[i];
+		auto fileName = GetCodeCacheFileName(i);
+		if(!codeCache.Save(codeCachePath / fileName))
+		{
+			result = false;
+		}
+		auto stats = codeCache.GetStats();
+		CLog::GetInstance().Print(LOG_NAME, "Code cache '%s': %d hits, %d misses, %d uncacheable blocks, %d evicted blocks.\r\n",
+		                          fileName.c_str(), stats.hits, stats.misses, stats.uncacheable, stats.evicted);
+	}
+	return result;
+}
+
 void CPS2VM::EmuThread()
 {
 	fesetround(FE_TOWARDZERO);
-	CProfiler::GetInstance().SetWorkThread();
+	CLog::SetThreadContext(m_logContext);
+	m_profiler.SetWorkThread();
 #ifdef PROFILE
 	CProfilerZone profilerZone(m_otherProfilerZone);
 #endif
 	static_cast<CEeExecutor*>(m_ee->m_EE.m_executor.get())->AddExceptionHandler();
+	if(m_iopThreadEnabled)
+	{
+		//Writes from IOP modules to EE RAM can hit pages holding EE code
+		auto eeExecutor = static_cast<CEeExecutor*>(m_ee->m_EE.m_executor.get());
+		m_iopWorker = std::make_unique<Iop::CSubSystemWorker>(
+		    [eeExecutor, logContext = m_logContext]() {
+			    CLog::SetThreadContext(logContext);
+			    eeExecutor->AttachWriterThread();
+		    },
+		    [this]() { ExecuteIop(); });
+		m_ee->m_sif.SetIopSyncHandler(
+		    [this]() { m_iopWorker->Wait(Iop::CSubSystemWorker::SYNC_POINT_IOP_ACCESS); });
+	}
 	while(1)
 	{
 		while(m_mailBox.IsPending())
@@ -787,10 +1077,10 @@ void CPS2VM::EmuThread()
 						}
 #ifdef PROFILE
 						{
-							CProfiler::GetInstance().CountCurrentZone();
-							auto stats = CProfiler::GetInstance().GetStats();
+							m_profiler.CountCurrentZone();
+							auto stats = m_profiler.GetStats();
 							ProfileFrameDone(stats);
-							CProfiler::GetInstance().Reset();
+							m_profiler.Reset();
 						}
 
 						m_cpuUtilisation = CPU_UTILISATION_INFO();
@@ -810,11 +1100,25 @@ void CPS2VM::EmuThread()
 
 				//EE CPU is 8 times faster than the IOP CPU
 				static const int tickStep = 4800;
-				m_eeExecutionTicks += tickStep;
-				m_iopExecutionTicks += tickStep / 8;
+				if(m_iopWorker)
+				{
+					//Run both up to the next vblank or SPU update, SIF transfers synchronize them earlier
+					int step = std::max(tickStep, std::min({m_iopMaxSkew, m_vblankTicks, m_spuUpdateTicks * 8})) & ~7;
+					m_eeExecutionTicks += step;
+					m_iopExecutionTicks += step / 8;
+
+					m_iopWorker->StartJob();
+					UpdateEe();
+					m_iopWorker->Wait(Iop::CSubSystemWorker::SYNC_POINT_STEP);
+				}
+				else
+				{
+					m_eeExecutionTicks += tickStep;
+					m_iopExecutionTicks += tickStep / 8;
 
-				UpdateEe();
-				UpdateIop();
+					UpdateEe();
+					UpdateIop();
+				}
 			}
 #ifdef DEBUGGER_INCLUDED
 			if(
@@ -834,5 +1138,7 @@ void CPS2VM::EmuThread()
 #endif
 		}
 	}
+	m_ee->m_sif.SetIopSyncHandler(CSIF::IopSyncHandler());
+	m_iopWorker.reset();
 	static_cast<CEeExecutor*>(m_ee->m_EE.m_executor.get())->RemoveExceptionHandler();
 }
@@ -12,9 +12,13 @@
 #include "VirtualMachine.h"
 #include "ee/Ee_SubSystem.h"
 #include "iop/Iop_SubSystem.h"
+#include "iop/Iop_SpuMixWorker.h"
+#include "iop/Iop_SubSystemWorker.h"
 #include "../tools/PsfPlayer/Source/SoundHandler.h"
+#include "SoundOutputThread.h"
 #include "FrameDump.h"
 #include "Profiler.h"
+#include "JitCodeCache.h"
 
 class CPS2VM : public CVirtualMachine
 {
@@ -34,7 +38,7 @@ public:
 	typedef Framework::CSignal<void(const CProfiler::ZoneArray&)> ProfileFrameDoneSignal;
 
 	CPS2VM();
-	virtual ~CPS2VM() = default;
+	virtual ~CPS2VM();
 
 	void Initialize();
 	void Destroy();
@@ -67,6 +71,7 @@ public:
 	void ReloadSpuBlockCount();
 
 	static fs::path GetStateDirectoryPath();
+	static fs::path GetCodeCacheDirectoryPath();
 	fs::path GenerateStatePath(unsigned int) const;
 
 	std::future<bool> SaveState(const fs::path&);
@@ -100,6 +105,10 @@ private:
 
 	void ReloadExecutable(const char*, const CPS2OS::ArgumentList&);
 
+	void LoadCodeCaches();
+	bool SaveCodeCaches();
+	std::string GetCodeCacheFileName(unsigned int) const;
+
 	void ResumeImpl();
 	void PauseImpl();
 	void DestroyImpl();
@@ -115,6 +124,7 @@ private:
 
 	void UpdateEe();
 	void UpdateIop();
+	void ExecuteIop();
 	void UpdateSpu();
 
 	void OnGsNewFrame();
@@ -152,6 +162,19 @@ private:
 
 	OpticalMediaPtr m_cdrom0;
 
+	enum CODE_CACHE
+	{
+		CODE_CACHE_EE,
+		CODE_CACHE_IOP,
+		CODE_CACHE_VU0,
+		CODE_CACHE_VU1,
+		CODE_CACHE_MAX,
+	};
+
+	bool m_codeCacheEnabled = false;
+	bool m_fastMemoryEnabled = false;
+	CJitCodeCache m_codeCaches[CODE_CACHE_MAX];
+
 	//SPU update parameters
 	enum
 	{
@@ -167,7 +190,19 @@ private:
 	int m_currentSpuBlock = 0;
 	int m_spuBlockCount;
 	CSoundHandler* m_soundHandler = nullptr;
+	std::unique_ptr<CSoundOutputThread> m_soundOutputThread;
+	std::unique_ptr<Iop::CSpuMixWorker> m_spuMixWorker;
+
+	//IOP time slices run on this thread, at most m_iopMaxSkew EE cycles ahead of the EE
+	bool m_iopThreadEnabled = false;
+	int m_iopMaxSkew = 0;
+	std::unique_ptr<Iop::CSubSystemWorker> m_iopWorker;
+
+	//Index among the virtual machines alive in this process, threads of the others log in their own context
+	uint32 m_instanceIndex = 0;
+	std::string m_logContext;
 
+	CProfiler m_profiler;
 	CProfiler::ZoneHandle m_eeProfilerZone = 0;
 	CProfiler::ZoneHandle m_iopProfilerZone = 0;
 	CProfiler::ZoneHandle m_spuProfilerZone = 0;
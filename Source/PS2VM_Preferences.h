@@ -1,9 +1,26 @@
 #pragma once
 
 #define PREF_PS2_CDROM0_PATH ("ps2.cdrom0.path.v2")
+#define PREF_PS2_IMAGECACHE_SIZE ("ps2.imagecache.size")
+#define PREF_PS2_IMAGECACHE_PREFETCH ("ps2.imagecache.prefetch")
 
 #define PREF_PS2_HOST_DIRECTORY ("ps2.host.directory.v2")
 #define PREF_PS2_MC0_DIRECTORY ("ps2.mc0.directory.v2")
 #define PREF_PS2_MC1_DIRECTORY ("ps2.mc1.directory.v2")
 
+#define PREF_LOG_TRACE_ENABLED ("log.trace.enabled")
+
 #define PREF_AUDIO_SPUBLOCKCOUNT ("audio.spublockcount")
+#define PREF_AUDIO_SPUMIXTHREAD ("audio.spumixthread")
+#define PREF_AUDIO_SPUOUTPUTBUFFERS ("audio.spuoutputbuffers")
+
+#define PREF_PS2_JITCODECACHE_ENABLED ("ps2.jitcodecache.enabled")
+#define PREF_PS2_JITCODECACHE_BUDGET ("ps2.jitcodecache.budget")
+#define PREF_PS2_JITCODEARENA_BUDGET ("ps2.jitcodearena.budget")
+#define PREF_PS2_SPECULATIVEJIT_THREADS ("ps2.speculativejit.threads")
+#define PREF_PS2_FASTMEMORY_ENABLED ("ps2.fastmemory.enabled")
+#define PREF_PS2_VU1THREAD_ENABLED ("ps2.vu1thread.enabled")
+#define PREF_PS2_IOPTHREAD_ENABLED ("ps2.iopthread.enabled")
+#define PREF_PS2_IOPTHREAD_MAXSKEW ("ps2.iopthread.maxskew")
+#define PREF_PS2_IPU_FASTIDCT_ENABLED ("ps2.ipu.fastidct.enabled")
+#define PREF_PS2_IPU_DECODETHREADS ("ps2.ipu.decodethreads")
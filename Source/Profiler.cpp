@@ -1,6 +1,11 @@
 #include "Profiler.h"
 
 #include <cassert>
+#include <mutex>
+
+static std::mutex g_zoneNamesMutex;
+static std::vector<std::string> g_zoneNames;
+static thread_local CProfiler* g_threadProfiler = nullptr;
 
 CProfiler::CProfiler()
 {
@@ -13,21 +18,23 @@ CProfiler::~CProfiler()
 CProfiler::ZoneHandle CProfiler::RegisterZone(const char* name)
 {
 #ifdef PROFILE
-	for(unsigned int i = 0; i < m_zones.size(); i++)
+	std::lock_guard<std::mutex> zoneNamesLock(g_zoneNamesMutex);
+	for(unsigned int i = 0; i < g_zoneNames.size(); i++)
 	{
-		const auto& zone(m_zones[i]);
-		if(zone.name == name) return i;
+		if(g_zoneNames[i] == name) return i;
 	}
-	auto newZone = ZONE();
-	newZone.name = name;
-	newZone.totalTime = 0;
-	m_zones.push_back(newZone);
-	return static_cast<CProfiler::ZoneHandle>(m_zones.size() - 1);
+	g_zoneNames.push_back(name);
+	return static_cast<CProfiler::ZoneHandle>(g_zoneNames.size() - 1);
 #else
 	return 0;
 #endif
 }
 
+CProfiler* CProfiler::GetThreadProfiler()
+{
+	return g_threadProfiler;
+}
+
 void CProfiler::CountCurrentZone()
 {
 	assert(std::this_thread::get_id() == m_workThreadId);
@@ -71,20 +78,34 @@ void CProfiler::ExitZone()
 CProfiler::ZoneArray CProfiler::GetStats() const
 {
 	assert(std::this_thread::get_id() == m_workThreadId);
-	return m_zones;
+	ZoneArray zones;
+	{
+		std::lock_guard<std::mutex> zoneNamesLock(g_zoneNamesMutex);
+		zones.resize(g_zoneNames.size());
+		for(unsigned int i = 0; i < g_zoneNames.size(); i++)
+		{
+			zones[i].name = g_zoneNames[i];
+		}
+	}
+	for(unsigned int i = 0; i < m_zoneTimes.size(); i++)
+	{
+		zones[i].totalTime = m_zoneTimes[i];
+	}
+	return zones;
 }
 
 void CProfiler::Reset()
 {
 	assert(std::this_thread::get_id() == m_workThreadId);
-	for(auto& zone : m_zones)
+	for(auto& zoneTime : m_zoneTimes)
 	{
-		zone.totalTime = 0;
+		zoneTime = 0;
 	}
 }
 
 void CProfiler::SetWorkThread()
 {
+	g_threadProfiler = this;
 #ifdef _DEBUG
 	m_workThreadId = std::this_thread::get_id();
 #endif
@@ -92,9 +113,11 @@ void CProfiler::SetWorkThread()
 
 void CProfiler::AddTimeToZone(ZoneHandle zoneHandle, uint64 timeNs)
 {
-	assert(m_zones.size() > zoneHandle);
-	auto& zone = m_zones[zoneHandle];
-	zone.totalTime += timeNs;
+	if(zoneHandle >= m_zoneTimes.size())
+	{
+		m_zoneTimes.resize(zoneHandle + 1);
+	}
+	m_zoneTimes[zoneHandle] += timeNs;
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -103,13 +126,20 @@ void CProfiler::AddTimeToZone(ZoneHandle zoneHandle, uint64 timeNs)
 CProfilerZone::CProfilerZone(CProfiler::ZoneHandle handle)
 {
 #ifdef PROFILE
-	CProfiler::GetInstance().EnterZone(handle);
+	m_profiler = CProfiler::GetThreadProfiler();
+	if(m_profiler)
+	{
+		m_profiler->EnterZone(handle);
+	}
 #endif
 }
 
 CProfilerZone::~CProfilerZone()
 {
 #ifdef PROFILE
-	CProfiler::GetInstance().ExitZone();
+	if(m_profiler)
+	{
+		m_profiler->ExitZone();
+	}
 #endif
 }
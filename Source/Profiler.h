@@ -5,10 +5,10 @@
 #include <thread>
 #include <vector>
 #include <chrono>
-#include "Singleton.h"
 #include "Types.h"
 
-class CProfiler : public CSingleton<CProfiler>
+//Every virtual machine has its own profiler, bound to its emulation thread
+class CProfiler
 {
 public:
 	typedef uint32 ZoneHandle;
@@ -25,7 +25,11 @@ public:
 	CProfiler();
 	virtual ~CProfiler();
 
-	ZoneHandle RegisterZone(const char*);
+	//Zone handles are shared by all profilers
+	static ZoneHandle RegisterZone(const char*);
+
+	//Profiler bound to the current thread, null if none
+	static CProfiler* GetThreadProfiler();
 
 	void CountCurrentZone();
 
@@ -39,10 +43,11 @@ public:
 
 private:
 	typedef std::stack<ZoneHandle> ZoneStack;
+	typedef std::vector<uint64> ZoneTimeArray;
 
 	void AddTimeToZone(ZoneHandle, uint64);
 
-	ZoneArray m_zones;
+	ZoneTimeArray m_zoneTimes;
 	ZoneStack m_zoneStack;
 	TimePoint m_currentTime;
 
@@ -56,4 +61,7 @@ class CProfilerZone
 public:
 	CProfilerZone(CProfiler::ZoneHandle);
 	~CProfilerZone();
+
+private:
+	CProfiler* m_profiler = nullptr;
 };
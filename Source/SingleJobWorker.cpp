@@ -0,0 +1,91 @@
+#include <algorithm>
+#include <cassert>
+#include "Log.h"
+#include "SingleJobWorker.h"
+
+#define LOG_NAME ("singlejobworker")
+
+CSingleJobWorker::CSingleJobWorker(const std::string& name, const JobFunction& jobFunction, const JobFunction& threadStartFunction, const SyncPointNameArray& syncPointNames)
+    : m_name(name)
+    , m_jobFunction(jobFunction)
+    , m_threadStartFunction(threadStartFunction)
+    , m_syncPointNames(syncPointNames)
+    , m_stats(std::max<size_t>(syncPointNames.size(), 1))
+{
+	m_thread = std::thread([this]() { ThreadProc(); });
+}
+
+CSingleJobWorker::~CSingleJobWorker()
+{
+	Stop();
+
+	CLog::GetInstance().Print(LOG_NAME, "%s: %d jobs.\r\n", m_name.c_str(), m_jobCount);
+	for(unsigned int i = 0; i < m_stats.size(); i++)
+	{
+		const auto& stats = m_stats[i];
+		auto stallTime = std::chrono::duration_cast<std::chrono::microseconds>(stats.stallTime);
+		const char* syncPointName = m_syncPointNames.empty() ? "any" : m_syncPointNames[i].c_str();
+		CLog::GetInstance().Print(LOG_NAME, "%s: sync point '%s': %d synchronizations, waited %d times (%0.2f ms).\r\n",
+		                          m_name.c_str(), syncPointName, stats.syncCount, stats.stallCount, static_cast<double>(stallTime.count()) / 1000.0);
+	}
+}
+
+void CSingleJobWorker::StartJob()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		assert(!m_pending);
+		m_pending = true;
+		m_jobCount++;
+	}
+	m_requestCondition.notify_one();
+}
+
+bool CSingleJobWorker::IsBusy()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_pending;
+}
+
+void CSingleJobWorker::Wait(unsigned int syncPoint)
+{
+	assert(syncPoint < m_stats.size());
+	auto& stats = m_stats[syncPoint];
+	std::unique_lock<std::mutex> lock(m_mutex);
+	stats.syncCount++;
+	if(!m_pending) return;
+	stats.stallCount++;
+	auto stallStart = std::chrono::steady_clock::now();
+	m_doneCondition.wait(lock, [this]() { return !m_pending; });
+	stats.stallTime += std::chrono::steady_clock::now() - stallStart;
+}
+
+void CSingleJobWorker::Stop()
+{
+	if(!m_thread.joinable()) return;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_terminate = true;
+	}
+	m_requestCondition.notify_one();
+	m_thread.join();
+}
+
+void CSingleJobWorker::ThreadProc()
+{
+	if(m_threadStartFunction)
+	{
+		m_threadStartFunction();
+	}
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while(true)
+	{
+		m_requestCondition.wait(lock, [this]() { return m_pending || m_terminate; });
+		if(m_terminate) break;
+		lock.unlock();
+		m_jobFunction();
+		lock.lock();
+		m_pending = false;
+		m_doneCondition.notify_one();
+	}
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Types.h"
+
+//Runs one job at a time on its own thread while the thread that started it carries on.
+//The starting thread must call Wait before touching anything used by the job. Sync points
+//passed to Wait only break down the statistics logged when the worker is destroyed.
+class CSingleJobWorker
+{
+public:
+	typedef std::function<void()> JobFunction;
+	typedef std::vector<std::string> SyncPointNameArray;
+
+	struct STATS
+	{
+		uint32 syncCount = 0;
+		uint32 stallCount = 0;
+		std::chrono::nanoseconds stallTime = std::chrono::nanoseconds::zero();
+	};
+
+	CSingleJobWorker(const std::string&, const JobFunction&, const JobFunction& = JobFunction(), const SyncPointNameArray& = SyncPointNameArray());
+	virtual ~CSingleJobWorker();
+
+	void StartJob();
+	bool IsBusy();
+	void Wait(unsigned int = 0);
+
+protected:
+	//Derived classes whose job uses their own members must call this from their destructor
+	void Stop();
+
+private:
+	void ThreadProc();
+
+	std::string m_name;
+	JobFunction m_jobFunction;
+	JobFunction m_threadStartFunction;
+	SyncPointNameArray m_syncPointNames;
+
+	std::thread m_thread;
+	std::mutex m_mutex;
+	std::condition_variable m_requestCondition;
+	std::condition_variable m_doneCondition;
+	bool m_terminate = false;
+	bool m_pending = false;
+
+	uint32 m_jobCount = 0;
+	std::vector<STATS> m_stats;
+};
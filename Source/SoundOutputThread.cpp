@@ -0,0 +1,117 @@
+#include <cassert>
+#include <algorithm>
+#include <cstring>
+#include "SoundOutputThread.h"
+
+CSoundOutputThread::CSoundOutputThread(CSoundHandler* soundHandler, unsigned int bufferSampleCount, unsigned int bufferCount)
+    : m_soundHandler(soundHandler)
+    , m_buffers(std::max<unsigned int>(bufferCount, 1))
+{
+	assert(m_soundHandler);
+	for(auto& buffer : m_buffers)
+	{
+		buffer.samples.resize(bufferSampleCount);
+	}
+	m_thread = std::thread([this]() { ThreadProc(); });
+}
+
+CSoundOutputThread::~CSoundOutputThread()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_terminate = true;
+	}
+	m_consumerCondition.notify_one();
+	m_thread.join();
+}
+
+void CSoundOutputThread::Write(const int16* samples, unsigned int sampleCount, unsigned int sampleRate)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	unsigned int bufferCount = static_cast<unsigned int>(m_buffers.size());
+	if(m_queuedCount == bufferCount)
+	{
+		m_stats.producerWaits++;
+		m_producerCondition.wait(lock, [&]() { return m_queuedCount != bufferCount; });
+	}
+
+	//Slots are only touched by the consumer between m_readIndex and m_readIndex + m_queuedCount
+	auto& buffer = m_buffers[(m_readIndex + m_queuedCount) % bufferCount];
+	assert(sampleCount <= buffer.samples.size());
+	buffer.sampleCount = std::min<unsigned int>(sampleCount, static_cast<unsigned int>(buffer.samples.size()));
+	buffer.sampleRate = sampleRate;
+	lock.unlock();
+
+	memcpy(buffer.samples.data(), samples, sizeof(int16) * buffer.sampleCount);
+
+	lock.lock();
+	m_queuedCount++;
+	m_stats.maxQueuedBuffers = std::max(m_stats.maxQueuedBuffers, m_queuedCount);
+	lock.unlock();
+	m_consumerCondition.notify_one();
+}
+
+void CSoundOutputThread::Flush()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_producerCondition.wait(lock, [this]() { return (m_queuedCount == 0) && !m_consumerBusy; });
+	m_restartPlayback = true;
+}
+
+CSoundOutputThread::STATS CSoundOutputThread::GetStats() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_stats;
+}
+
+void CSoundOutputThread::ThreadProc()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while(true)
+	{
+		m_consumerCondition.wait(lock, [this]() { return (m_queuedCount != 0) || m_terminate; });
+		//Buffers still queued when terminating are dropped, the sound handler is going away
+		if(m_terminate) break;
+
+		const auto& buffer = m_buffers[m_readIndex];
+		bool restartPlayback = m_restartPlayback;
+		m_restartPlayback = false;
+		m_consumerBusy = true;
+		lock.unlock();
+
+		WriteToHandler(buffer, restartPlayback);
+
+		lock.lock();
+		m_consumerBusy = false;
+		m_readIndex = (m_readIndex + 1) % m_buffers.size();
+		m_queuedCount--;
+		m_producerCondition.notify_all();
+	}
+}
+
+void CSoundOutputThread::WriteToHandler(const BUFFER& buffer, bool restartPlayback)
+{
+	if(restartPlayback)
+	{
+		m_playbackStarted = false;
+	}
+
+	auto currentTime = ClockType::now();
+	bool underrun = m_playbackStarted && (currentTime > m_playbackEndTime);
+
+	if(m_soundHandler->HasFreeBuffers())
+	{
+		m_soundHandler->RecycleBuffers();
+	}
+	m_soundHandler->Write(const_cast<int16*>(buffer.samples.data()), buffer.sampleCount, buffer.sampleRate);
+
+	//Estimate when the audio written so far will have been played (samples are stereo)
+	auto duration = std::chrono::duration_cast<ClockType::duration>(
+	    std::chrono::duration<double>(static_cast<double>(buffer.sampleCount / 2) / static_cast<double>(buffer.sampleRate)));
+	m_playbackEndTime = (underrun || !m_playbackStarted) ? (currentTime + duration) : (m_playbackEndTime + duration);
+	m_playbackStarted = true;
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_stats.buffersWritten++;
+	if(underrun) m_stats.underruns++;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Types.h"
+#include "../tools/PsfPlayer/Source/SoundHandler.h"
+
+//Hands mixed SPU output to the sound handler from its own thread, so that a sound handler
+//blocking on its backend doesn't stall emulation. Buffers go through a bounded queue: the
+//emulation thread waits when all buffers are in flight, which keeps it paced by audio output.
+//Only output samples cross threads, SPU state is still updated on the emulation thread.
+class CSoundOutputThread
+{
+public:
+	struct STATS
+	{
+		uint32 buffersWritten = 0;
+		//Buffers that reached the sound handler after the previously written audio ran out
+		uint32 underruns = 0;
+		//Times the emulation thread had to wait for a free buffer
+		uint32 producerWaits = 0;
+		uint32 maxQueuedBuffers = 0;
+	};
+
+	CSoundOutputThread(CSoundHandler*, unsigned int, unsigned int);
+	virtual ~CSoundOutputThread();
+
+	CSoundOutputThread(const CSoundOutputThread&) = delete;
+	CSoundOutputThread& operator=(const CSoundOutputThread&) = delete;
+
+	void Write(const int16*, unsigned int, unsigned int);
+	//Waits until every queued buffer has been handed to the sound handler. Output is
+	//expected to stop after this (ie.: VM paused), next write won't count as an underrun.
+	void Flush();
+
+	STATS GetStats() const;
+
+private:
+	typedef std::chrono::steady_clock ClockType;
+
+	struct BUFFER
+	{
+		std::vector<int16> samples;
+		unsigned int sampleCount = 0;
+		unsigned int sampleRate = 0;
+	};
+
+	void ThreadProc();
+	void WriteToHandler(const BUFFER&, bool);
+
+	CSoundHandler* m_soundHandler = nullptr;
+	std::vector<BUFFER> m_buffers;
+
+	std::thread m_thread;
+	mutable std::mutex m_mutex;
+	std::condition_variable m_producerCondition;
+	std::condition_variable m_consumerCondition;
+	unsigned int m_readIndex = 0;
+	unsigned int m_queuedCount = 0;
+	bool m_consumerBusy = false;
+	bool m_terminate = false;
+	bool m_restartPlayback = false;
+
+	//Only used by the output thread
+	ClockType::time_point m_playbackEndTime;
+	bool m_playbackStarted = false;
+
+	STATS m_stats;
+};
@@ -0,0 +1,239 @@
+#include "SpeculativeBlockCompiler.h"
+
+CSpeculativeBlockCompiler::CSpeculativeBlockCompiler(const CompileFunction& compileFunction, unsigned int threadCount)
+    : m_compileFunction(compileFunction)
+{
+	assert(threadCount != 0);
+	for(unsigned int i = 0; i < threadCount; i++)
+	{
+		m_workers.emplace_back([this, i]() { WorkerThreadProc(i); });
+	}
+}
+
+CSpeculativeBlockCompiler::~CSpeculativeBlockCompiler()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_terminate = true;
+	}
+	m_requestCondition.notify_all();
+	for(auto& worker : m_workers)
+	{
+		worker.join();
+	}
+}
+
+void CSpeculativeBlockCompiler::Request(uint32 address)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		RequestInternal(address, 0);
+	}
+	m_requestCondition.notify_one();
+}
+
+//Called when the executor creates a block at some address. Returns the speculatively
+//compiled block if it's ready and still matches what's in memory.
+CSpeculativeBlockCompiler::BasicBlockPtr CSpeculativeBlockCompiler::Take(uint32 begin, uint32 end, uint32 checksum)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	//Nothing was requested there, executor checks its own blocks before making new requests
+	auto entryIterator = m_entries.find(begin);
+	if(entryIterator == std::end(m_entries)) return BasicBlockPtr();
+
+	auto& entry = entryIterator->second;
+	BasicBlockPtr result;
+	if(entry.state == ENTRY_STATE::READY)
+	{
+		auto block = std::move(entry.result.block);
+		assert(m_readyCount != 0);
+		m_readyCount--;
+		if((block->GetEndAddress() == end) && (entry.result.checksum == checksum))
+		{
+			m_stats.hits++;
+			result = std::move(block);
+		}
+		else
+		{
+			m_stats.wasted++;
+		}
+	}
+	entry.state = ENTRY_STATE::SETTLED;
+	entry.result = RESULT();
+	return result;
+}
+
+void CSpeculativeBlockCompiler::Discard(uint32 begin)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	MarkSettled(begin);
+}
+
+//Called when the executor removes a block from its lookup table
+void CSpeculativeBlockCompiler::Forget(uint32 begin)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto entryIterator = m_entries.find(begin);
+	if(entryIterator == std::end(m_entries)) return;
+	if(entryIterator->second.state != ENTRY_STATE::SETTLED) return;
+	m_entries.erase(entryIterator);
+}
+
+void CSpeculativeBlockCompiler::InvalidateRange(uint32 start, uint32 end)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	for(auto entryIterator = std::begin(m_entries); entryIterator != std::end(m_entries);)
+	{
+		uint32 begin = entryIterator->first;
+		auto& entry = entryIterator->second;
+		bool overlaps = false;
+		switch(entry.state)
+		{
+		case ENTRY_STATE::PENDING:
+		case ENTRY_STATE::COMPILING:
+		case ENTRY_STATE::SETTLED:
+			//Workers will notice that their entry is gone when they're done
+			overlaps = (begin >= start) && (begin < end);
+			break;
+		case ENTRY_STATE::READY:
+			overlaps = (begin < end) && (entry.result.block->GetEndAddress() >= start);
+			if(overlaps)
+			{
+				assert(m_readyCount != 0);
+				m_readyCount--;
+				m_stats.wasted++;
+			}
+			break;
+		}
+		if(overlaps)
+		{
+			entryIterator = m_entries.erase(entryIterator);
+		}
+		else
+		{
+			entryIterator++;
+		}
+	}
+}
+
+void CSpeculativeBlockCompiler::Reset()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	//Workers in flight won't find their entries anymore and will drop their results
+	m_requests.clear();
+	m_entries.clear();
+	m_readyCount = 0;
+	m_idleCondition.wait(lock, [this]() { return m_busyWorkers == 0; });
+}
+
+CSpeculativeBlockCompiler::STATS CSpeculativeBlockCompiler::GetStats() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_stats;
+}
+
+void CSpeculativeBlockCompiler::RequestInternal(uint32 address, uint32 depth)
+{
+	if(address == MIPS_INVALID_PC) return;
+	if(m_entries.find(address) != std::end(m_entries)) return;
+	if(m_readyCount >= MAX_READY_BLOCKS) return;
+
+	uint32 ticket = m_nextTicket++;
+
+	auto& entry = m_entries[address];
+	entry.state = ENTRY_STATE::PENDING;
+	entry.ticket = ticket;
+	entry.depth = depth;
+
+	m_requests.push_back(REQUEST{address, ticket});
+	m_stats.requested++;
+}
+
+void CSpeculativeBlockCompiler::MarkSettled(uint32 begin)
+{
+	auto entryIterator = m_entries.find(begin);
+	if(entryIterator == std::end(m_entries)) return;
+	auto& entry = entryIterator->second;
+	if(entry.state == ENTRY_STATE::READY)
+	{
+		assert(m_readyCount != 0);
+		m_readyCount--;
+		m_stats.wasted++;
+	}
+	entry.state = ENTRY_STATE::SETTLED;
+	entry.result = RESULT();
+}
+
+void CSpeculativeBlockCompiler::WorkerThreadProc(unsigned int workerIndex)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while(true)
+	{
+		m_requestCondition.wait(lock, [this]() { return m_terminate || !m_requests.empty(); });
+		if(m_terminate) break;
+
+		auto request = m_requests.front();
+		m_requests.pop_front();
+
+		{
+			auto entryIterator = m_entries.find(request.address);
+			if(entryIterator == std::end(m_entries)) continue;
+			auto& entry = entryIterator->second;
+			if((entry.state != ENTRY_STATE::PENDING) || (entry.ticket != request.ticket)) continue;
+			entry.state = ENTRY_STATE::COMPILING;
+		}
+
+		m_busyWorkers++;
+		lock.unlock();
+
+		RESULT result;
+		bool compiled = m_compileFunction(workerIndex, request.address, result);
+
+		lock.lock();
+		m_busyWorkers--;
+
+		if(compiled)
+		{
+			m_stats.compiled++;
+		}
+
+		auto entryIterator = m_entries.find(request.address);
+		bool entryValid = (entryIterator != std::end(m_entries)) &&
+		                  (entryIterator->second.state == ENTRY_STATE::COMPILING) &&
+		                  (entryIterator->second.ticket == request.ticket);
+		if(!entryValid)
+		{
+			//Executor took over that address or invalidated it while we were working
+			if(compiled)
+			{
+				m_stats.wasted++;
+			}
+		}
+		else if(!compiled)
+		{
+			//Don't try again until the executor forgets about this address
+			entryIterator->second.state = ENTRY_STATE::SETTLED;
+		}
+		else
+		{
+			auto& entry = entryIterator->second;
+			uint32 depth = entry.depth;
+			entry.state = ENTRY_STATE::READY;
+			entry.result = std::move(result);
+			m_readyCount++;
+
+			if((depth + 1) < MAX_DEPTH)
+			{
+				RequestInternal(entry.result.nextAddress, depth + 1);
+				RequestInternal(entry.result.branchAddress, depth + 1);
+				m_requestCondition.notify_all();
+			}
+		}
+
+		if(m_busyWorkers == 0)
+		{
+			m_idleCondition.notify_all();
+		}
+	}
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cassert>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Types.h"
+#include "BasicBlock.h"
+
+//Compiles blocks ahead of execution on worker threads. Executors request successors of blocks
+//they create and take finished blocks when execution reaches them. Everything that touches the
+//executor's bookkeeping (block lookup, links) stays on the emulation thread: results are only
+//adopted after their checksum has been validated against the current contents of memory.
+class CSpeculativeBlockCompiler
+{
+public:
+	typedef std::shared_ptr<CBasicBlock> BasicBlockPtr;
+
+	struct RESULT
+	{
+		BasicBlockPtr block;
+		uint32 checksum = 0;
+		uint32 nextAddress = MIPS_INVALID_PC;
+		uint32 branchAddress = MIPS_INVALID_PC;
+	};
+
+	//Runs on a worker thread (first parameter is the worker's index), returns false if no block could be made at that address
+	typedef std::function<bool(unsigned int, uint32, RESULT&)> CompileFunction;
+
+	struct STATS
+	{
+		uint32 requested = 0;
+		uint32 compiled = 0;
+		uint32 hits = 0;
+		uint32 wasted = 0;
+	};
+
+	enum
+	{
+		MAX_DEPTH = 4,
+		MAX_READY_BLOCKS = 1024,
+	};
+
+	CSpeculativeBlockCompiler(const CompileFunction&, unsigned int);
+	virtual ~CSpeculativeBlockCompiler();
+
+	void Request(uint32);
+	BasicBlockPtr Take(uint32, uint32, uint32);
+	void Discard(uint32);
+	void Forget(uint32);
+	void InvalidateRange(uint32, uint32);
+	void Reset();
+
+	STATS GetStats() const;
+
+private:
+	enum class ENTRY_STATE
+	{
+		PENDING,
+		COMPILING,
+		READY,
+		//Executor made its own block while a request was in flight or nothing can be compiled there
+		SETTLED,
+	};
+
+	struct ENTRY
+	{
+		ENTRY_STATE state = ENTRY_STATE::PENDING;
+		uint32 ticket = 0;
+		uint32 depth = 0;
+		RESULT result;
+	};
+
+	struct REQUEST
+	{
+		uint32 address;
+		uint32 ticket;
+	};
+
+	typedef std::map<uint32, ENTRY> EntryMap;
+
+	void RequestInternal(uint32, uint32);
+	void MarkSettled(uint32);
+	void WorkerThreadProc(unsigned int);
+
+	CompileFunction m_compileFunction;
+	std::vector<std::thread> m_workers;
+
+	mutable std::mutex m_mutex;
+	std::condition_variable m_requestCondition;
+	std::condition_variable m_idleCondition;
+	std::deque<REQUEST> m_requests;
+	EntryMap m_entries;
+	uint32 m_nextTicket = 0;
+	uint32 m_readyCount = 0;
+	unsigned int m_busyWorkers = 0;
+	bool m_terminate = false;
+	STATS m_stats;
+};
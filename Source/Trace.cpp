@@ -0,0 +1,218 @@
+#include <algorithm>
+#include <cassert>
+#include "Trace.h"
+#include "AppConfig.h"
+#include "PathUtils.h"
+#include "StdStreamUtils.h"
+
+#define TRACE_PATH "logs"
+#define TRACE_FILE_NAME "trace.bin"
+
+//Records are handed to the writer thread at least this often
+#define FLUSH_INTERVAL_MS 10
+
+std::atomic<bool> CTrace::m_enabled(false);
+
+static thread_local std::shared_ptr<void> g_threadBuffer;
+
+CTrace::THREAD_BUFFER::THREAD_BUFFER()
+    : data(new uint8[BUFFER_SIZE])
+    , writePosition(0)
+    , readPosition(0)
+    , droppedCount(0)
+{
+}
+
+CTrace& CTrace::GetInstance()
+{
+	//Destroyed on exit, records still in thread buffers get written then
+	static CTrace instance;
+	return instance;
+}
+
+CTrace::~CTrace()
+{
+	Stop();
+}
+
+void CTrace::Start()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if(m_stream) return;
+	auto tracePath = CAppConfig::GetBasePath() / TRACE_PATH;
+	Framework::PathUtils::EnsurePathExists(tracePath);
+	m_stream = std::make_unique<Framework::CStdStream>(Framework::CreateOutputStdStream((tracePath / TRACE_FILE_NAME).native()));
+	m_stream->Write32(FILE_MAGIC);
+	m_stream->Write32(FILE_VERSION);
+	//Points registered before a restart need to be written again
+	m_writtenPointCount = 0;
+	m_writerDone = false;
+	m_writerThread = std::thread([this]() { WriterThreadProc(); });
+	m_enabled = true;
+}
+
+void CTrace::Stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if(!m_stream) return;
+		m_enabled = false;
+		m_writerDone = true;
+		m_writerCondition.notify_one();
+	}
+	m_writerThread.join();
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_stream.reset();
+}
+
+CTrace::PointId CTrace::RegisterPoint(const char* logName, const char* format)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	assert(m_points.size() < 0x10000);
+	POINT point;
+	point.logName = logName;
+	point.format = format;
+	m_points.push_back(std::move(point));
+	return static_cast<PointId>(m_points.size() - 1);
+}
+
+uint32 CTrace::WriteArg(uint8* record, uint32 size, uint32& droppedArgCount, const char* value)
+{
+	if((size + 2) > MAX_RECORD_SIZE)
+	{
+		droppedArgCount++;
+		return size;
+	}
+	size_t length = value ? strlen(value) : 0;
+	length = std::min<size_t>(length, MAX_STRING_LENGTH);
+	if(length > (MAX_RECORD_SIZE - (size + 2)))
+	{
+		droppedArgCount++;
+		length = MAX_RECORD_SIZE - (size + 2);
+	}
+	record[size + 0] = ARG_TYPE_STRING;
+	record[size + 1] = static_cast<uint8>(length);
+	if(length != 0)
+	{
+		memcpy(record + size + 2, value, length);
+	}
+	return static_cast<uint32>(size + 2 + length);
+}
+
+void CTrace::Commit(const uint8* record, uint32 size, uint32 droppedArgCount)
+{
+	auto buffer = GetThreadBuffer();
+	if(droppedArgCount != 0)
+	{
+		buffer->droppedCount.fetch_add(droppedArgCount, std::memory_order_relaxed);
+	}
+	uint64 writePosition = buffer->writePosition.load(std::memory_order_relaxed);
+	uint64 readPosition = buffer->readPosition.load(std::memory_order_acquire);
+	if((BUFFER_SIZE - (writePosition - readPosition)) < size)
+	{
+		//Writer thread is late, losing records is better than stalling emulation
+		buffer->droppedCount.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+	uint32 offset = static_cast<uint32>(writePosition % BUFFER_SIZE);
+	uint32 firstSize = std::min<uint32>(size, BUFFER_SIZE - offset);
+	memcpy(buffer->data.get() + offset, record, firstSize);
+	memcpy(buffer->data.get(), record + firstSize, size - firstSize);
+	buffer->writePosition.store(writePosition + size, std::memory_order_release);
+}
+
+CTrace::THREAD_BUFFER* CTrace::GetThreadBuffer()
+{
+	if(auto buffer = g_threadBuffer.get())
+	{
+		return static_cast<THREAD_BUFFER*>(buffer);
+	}
+	auto buffer = std::make_shared<THREAD_BUFFER>();
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		buffer->threadIndex = m_nextThreadIndex++;
+		m_threadBuffers.push_back(buffer);
+	}
+	//Buffer stays alive in m_threadBuffers after the thread is gone, until it's drained
+	g_threadBuffer = buffer;
+	return buffer.get();
+}
+
+void CTrace::WriterThreadProc()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	//Always flush once more after Stop, even if it came before the first wait
+	bool done = false;
+	while(!done)
+	{
+		if(!m_writerDone)
+		{
+			m_writerCondition.wait_for(lock, std::chrono::milliseconds(FLUSH_INTERVAL_MS));
+		}
+		done = m_writerDone;
+		Flush(lock);
+	}
+}
+
+//Called with the lock held, releases it while writing to the trace file
+void CTrace::Flush(std::unique_lock<std::mutex>& lock)
+{
+	//Grab write positions before points, every record we write then has its point registered
+	std::vector<ThreadBufferPtr> threadBuffers(m_threadBuffers);
+	std::vector<uint64> writePositions;
+	writePositions.reserve(threadBuffers.size());
+	for(const auto& buffer : threadBuffers)
+	{
+		writePositions.push_back(buffer->writePosition.load(std::memory_order_acquire));
+	}
+
+	size_t firstPointId = m_writtenPointCount;
+	std::vector<POINT> points(m_points.begin() + m_writtenPointCount, m_points.end());
+	m_writtenPointCount = m_points.size();
+
+	//Stream is only reset by Stop once this thread is done
+	auto stream = m_stream.get();
+	lock.unlock();
+
+	for(size_t i = 0; i < points.size(); i++)
+	{
+		const auto& point = points[i];
+		stream->Write8(BLOCK_TYPE_POINT);
+		stream->Write16(static_cast<uint16>(firstPointId + i));
+		stream->Write16(static_cast<uint16>(point.logName.size()));
+		stream->Write(point.logName.data(), point.logName.size());
+		stream->Write16(static_cast<uint16>(point.format.size()));
+		stream->Write(point.format.data(), point.format.size());
+	}
+
+	for(size_t i = 0; i < threadBuffers.size(); i++)
+	{
+		auto& buffer = threadBuffers[i];
+		uint64 readPosition = buffer->readPosition.load(std::memory_order_relaxed);
+		uint32 size = static_cast<uint32>(writePositions[i] - readPosition);
+		uint32 droppedCount = buffer->droppedCount.exchange(0, std::memory_order_relaxed);
+		if((size == 0) && (droppedCount == 0)) continue;
+		stream->Write8(BLOCK_TYPE_RECORDS);
+		stream->Write32(buffer->threadIndex);
+		stream->Write32(droppedCount);
+		stream->Write32(size);
+		uint32 offset = static_cast<uint32>(readPosition % BUFFER_SIZE);
+		uint32 firstSize = std::min<uint32>(size, BUFFER_SIZE - offset);
+		stream->Write(buffer->data.get() + offset, firstSize);
+		stream->Write(buffer->data.get(), size - firstSize);
+		buffer->readPosition.store(writePositions[i], std::memory_order_release);
+	}
+	stream->Flush();
+
+	threadBuffers.clear();
+	lock.lock();
+
+	//Buffers of threads that are gone are only referenced here
+	m_threadBuffers.erase(
+	    std::remove_if(m_threadBuffers.begin(), m_threadBuffers.end(),
+	                   [](const ThreadBufferPtr& buffer) {
+		                   return (buffer.use_count() == 1) &&
+		                          (buffer->readPosition.load(std::memory_order_relaxed) == buffer->writePosition.load(std::memory_order_acquire));
+	                   }),
+	    m_threadBuffers.end());
+}
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "Types.h"
+#include "StdStream.h"
+
+//Binary trace of TRACE_PRINT points, cheap enough to stay enabled in release builds.
+//Points are registered once with their log name and printf format, records only hold the point id,
+//a timestamp and raw arguments. Records go through a ring buffer owned by the producing thread and
+//are written to the trace file by a background thread. tools/TraceDecoder turns the file into text.
+class CTrace
+{
+public:
+	typedef uint16 PointId;
+
+	enum
+	{
+		FILE_MAGIC = 0x43525450, //'PTRC'
+		FILE_VERSION = 1,
+	};
+
+	enum BLOCK_TYPE : uint8
+	{
+		BLOCK_TYPE_POINT,
+		BLOCK_TYPE_RECORDS,
+	};
+
+	enum ARG_TYPE : uint8
+	{
+		ARG_TYPE_INTEGER,
+		ARG_TYPE_DOUBLE,
+		ARG_TYPE_STRING,
+	};
+
+	//Records are written as is in BLOCK_TYPE_RECORDS blocks, arguments follow the header.
+	//Each argument is its ARG_TYPE followed by 8 bytes or, for strings, a length byte and the characters.
+	struct RECORD_HEADER
+	{
+		uint16 size;
+		PointId pointId;
+		uint32 reserved;
+		uint64 timestamp;
+	};
+	static_assert(sizeof(RECORD_HEADER) == 0x10, "RECORD_HEADER size must be 16 bytes.");
+
+	enum
+	{
+		MAX_RECORD_SIZE = 0x200,
+		MAX_STRING_LENGTH = 0xFF,
+		BUFFER_SIZE = 0x100000,
+	};
+
+	static CTrace& GetInstance();
+
+	static bool IsEnabled()
+	{
+		return m_enabled.load(std::memory_order_relaxed);
+	}
+
+	//Opens the trace file in the log directory, does nothing if tracing has already started
+	void Start();
+	void Stop();
+
+	PointId RegisterPoint(const char*, const char*);
+
+	template <typename... Args>
+	void Write(PointId pointId, const Args&... args)
+	{
+		uint8 record[MAX_RECORD_SIZE];
+		uint32 size = sizeof(RECORD_HEADER);
+		uint32 droppedArgCount = 0;
+		int dummy[] = {0, (size = WriteArg(record, size, droppedArgCount, args), 0)...};
+		(void)dummy;
+		auto header = reinterpret_cast<RECORD_HEADER*>(record);
+		header->size = static_cast<uint16>(size);
+		header->pointId = pointId;
+		header->reserved = 0;
+		header->timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+		Commit(record, size, droppedArgCount);
+	}
+
+	//Never defined, only there to have the compiler check formats against arguments
+#ifdef _MSC_VER
+	static int CheckFormat(_Printf_format_string_ const char*, ...);
+#else
+	static int CheckFormat(const char*, ...) __attribute__((format(printf, 1, 2)));
+#endif
+
+private:
+	struct THREAD_BUFFER
+	{
+		THREAD_BUFFER();
+
+		std::unique_ptr<uint8[]> data;
+		uint32 threadIndex = 0;
+		//Only written by the producing thread
+		std::atomic<uint64> writePosition;
+		//Only written by the writer thread
+		std::atomic<uint64> readPosition;
+		//Records that didn't fit in the buffer and arguments (or parts of strings) that didn't fit in their record
+		std::atomic<uint32> droppedCount;
+	};
+	typedef std::shared_ptr<THREAD_BUFFER> ThreadBufferPtr;
+
+	struct POINT
+	{
+		std::string logName;
+		std::string format;
+	};
+
+	CTrace() = default;
+	~CTrace();
+
+	template <typename Type>
+	static uint32 WriteArg(uint8* record, uint32 size, uint32& droppedArgCount, const Type& value)
+	{
+		static_assert(std::is_arithmetic<Type>::value || std::is_enum<Type>::value || std::is_pointer<Type>::value, "Unsupported trace argument type.");
+		if((size + 9) > MAX_RECORD_SIZE)
+		{
+			droppedArgCount++;
+			return size;
+		}
+		uint64 bits = 0;
+		if(std::is_floating_point<Type>::value)
+		{
+			double doubleValue = static_cast<double>(ToArithmetic(value));
+			memcpy(&bits, &doubleValue, sizeof(double));
+			record[size] = ARG_TYPE_DOUBLE;
+		}
+		else
+		{
+			//Signed values are sign extended, the decoder truncates them back to what the format expects
+			bits = static_cast<uint64>(static_cast<typename std::conditional<std::is_signed<decltype(ToArithmetic(value))>::value, int64, uint64>::type>(ToArithmetic(value)));
+			record[size] = ARG_TYPE_INTEGER;
+		}
+		memcpy(record + size + 1, &bits, sizeof(uint64));
+		return size + 9;
+	}
+
+	static uint32 WriteArg(uint8*, uint32, uint32&, const char*);
+	static uint32 WriteArg(uint8* record, uint32 size, uint32& droppedArgCount, char* value)
+	{
+		return WriteArg(record, size, droppedArgCount, static_cast<const char*>(value));
+	}
+
+	template <typename Type>
+	static typename std::enable_if<std::is_arithmetic<Type>::value, Type>::type ToArithmetic(const Type& value)
+	{
+		return value;
+	}
+
+	template <typename Type>
+	static typename std::enable_if<std::is_enum<Type>::value, typename std::underlying_type<Type>::type>::type ToArithmetic(const Type& value)
+	{
+		return static_cast<typename std::underlying_type<Type>::type>(value);
+	}
+
+	template <typename Type>
+	static uintptr_t ToArithmetic(Type* value)
+	{
+		return reinterpret_cast<uintptr_t>(value);
+	}
+
+	void Commit(const uint8*, uint32, uint32);
+	THREAD_BUFFER* GetThreadBuffer();
+
+	void WriterThreadProc();
+	void Flush(std::unique_lock<std::mutex>&);
+
+	static std::atomic<bool> m_enabled;
+
+	//Guards everything below, never taken by threads producing records once they have a buffer.
+	//The writer thread doesn't hold it while writing to the trace file.
+	std::mutex m_mutex;
+	std::vector<ThreadBufferPtr> m_threadBuffers;
+	std::vector<POINT> m_points;
+	size_t m_writtenPointCount = 0;
+	uint32 m_nextThreadIndex = 0;
+
+	std::unique_ptr<Framework::CStdStream> m_stream;
+	std::thread m_writerThread;
+	std::condition_variable m_writerCondition;
+	bool m_writerDone = false;
+};
+
+#ifdef DISABLE_LOGGING
+#define TRACE_PRINT(logName, format, ...) \
+	do                                    \
+	{                                     \
+	} while(0)
+#else
+#define TRACE_PRINT(logName, format, ...)                                                                     \
+	do                                                                                                        \
+	{                                                                                                         \
+		(void)sizeof(CTrace::CheckFormat(format, ##__VA_ARGS__));                                             \
+		if(CTrace::IsEnabled())                                                                               \
+		{                                                                                                     \
+			static const CTrace::PointId tracePointId = CTrace::GetInstance().RegisterPoint(logName, format); \
+			CTrace::GetInstance().Write(tracePointId, ##__VA_ARGS__);                                         \
+		}                                                                                                     \
+	} while(0)
+#endif
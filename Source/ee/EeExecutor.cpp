@@ -1,7 +1,13 @@
 #include "EeExecutor.h"
+#include "MA_EE.h"
+#include "COP_VU.h"
+#include "../COP_SCU.h"
+#include "../COP_FPU.h"
 #include "../Ps2Const.h"
 #include "AlignedAlloc.h"
 #include <zlib.h>
+#include <stdexcept>
+#include <thread>
 
 #if defined(__unix__) || defined(__ANDROID__) || defined(__APPLE__)
 #include <sys/mman.h>
@@ -31,20 +37,70 @@
 
 #endif
 
-static CEeExecutor* g_eeExecutor = nullptr;
+#define EXECUTOR_COUNT 16
+
+struct EXECUTOR_SLOT
+{
+	std::atomic<CEeExecutor*> executor;
+	//Fault handlers currently using the executor, it can't be destroyed before this drops to 0
+	std::atomic<uint32> handlerCount;
+};
+
+//Every virtual machine running in this process has its executor registered here, faults are
+//routed to the executor owning the faulting address
+static EXECUTOR_SLOT g_eeExecutors[EXECUTOR_COUNT];
+
+#if !defined(__APPLE__)
+static thread_local bool g_isWriterThread = false;
+#endif
 
 CEeExecutor::CEeExecutor(CMIPS& context, uint8* ram)
     : CGenericMipsExecutor(context, 0x20000000)
     , m_ram(ram)
+    , m_hasWriterThreadPages(false)
 {
 	m_pageSize = framework_getpagesize();
+	m_writerThreadPageWordCount = ((PS2::EE_RAM_SIZE / m_pageSize) + 31) / 32;
+	m_writerThreadPages = std::make_unique<std::atomic<uint32>[]>(m_writerThreadPageWordCount);
+	for(uint32 i = 0; i < m_writerThreadPageWordCount; i++)
+	{
+		m_writerThreadPages[i] = 0;
+	}
+	bool registered = false;
+	for(auto& slot : g_eeExecutors)
+	{
+		CEeExecutor* expected = nullptr;
+		if(slot.executor.compare_exchange_strong(expected, this))
+		{
+			registered = true;
+			break;
+		}
+	}
+	if(!registered)
+	{
+		throw std::runtime_error("Too many EE executors.");
+	}
 }
 
-void CEeExecutor::AddExceptionHandler()
+CEeExecutor::~CEeExecutor()
 {
-	assert(g_eeExecutor == nullptr);
-	g_eeExecutor = this;
+	for(auto& slot : g_eeExecutors)
+	{
+		CEeExecutor* expected = this;
+		if(slot.executor.compare_exchange_strong(expected, nullptr))
+		{
+			//Handlers that picked this executor before it was removed might still be running
+			while(slot.handlerCount != 0)
+			{
+				std::this_thread::yield();
+			}
+			break;
+		}
+	}
+}
 
+void CEeExecutor::AddExceptionHandler()
+{
 #ifdef DISABLE_PROTECTION
 	return;
 #endif
@@ -64,6 +120,19 @@ void CEeExecutor::AddExceptionHandler()
 	kern_return_t result = mach_port_allocate(mach_task_self(), MACH_PORT_RIGHT_RECEIVE, &m_port);
 	assert(result == KERN_SUCCESS);
 
+	//Exception ports are per thread, faults from writer threads come through their own port
+	result = mach_port_allocate(mach_task_self(), MACH_PORT_RIGHT_RECEIVE, &m_writerPort);
+	assert(result == KERN_SUCCESS);
+
+	result = mach_port_allocate(mach_task_self(), MACH_PORT_RIGHT_PORT_SET, &m_portSet);
+	assert(result == KERN_SUCCESS);
+
+	result = mach_port_insert_member(mach_task_self(), m_port, m_portSet);
+	assert(result == KERN_SUCCESS);
+
+	result = mach_port_insert_member(mach_task_self(), m_writerPort, m_portSet);
+	assert(result == KERN_SUCCESS);
+
 	m_running = true;
 	m_handlerThread = std::thread([this]() { HandlerThreadProc(); });
 
@@ -90,8 +159,37 @@ void CEeExecutor::RemoveExceptionHandler()
 #endif
 
 #endif //!DISABLE_PROTECTION
+}
+
+void CEeExecutor::AttachWriterThread()
+{
+#ifdef DISABLE_PROTECTION
+	return;
+#endif
+
+#if defined(__APPLE__)
+	assert(m_writerPort != MACH_PORT_NULL);
+
+	kern_return_t result = mach_port_insert_right(mach_task_self(), m_writerPort, m_writerPort, MACH_MSG_TYPE_MAKE_SEND);
+	assert(result == KERN_SUCCESS);
 
-	g_eeExecutor = nullptr;
+	result = thread_set_exception_ports(mach_thread_self(), EXC_MASK_BAD_ACCESS, m_writerPort, EXCEPTION_STATE | MACH_EXCEPTION_CODES, STATE_FLAVOR);
+	assert(result == KERN_SUCCESS);
+
+	result = mach_port_mod_refs(mach_task_self(), m_writerPort, MACH_PORT_RIGHT_SEND, -1);
+	assert(result == KERN_SUCCESS);
+#else
+	g_isWriterThread = true;
+#endif
+}
+
+int CEeExecutor::Execute(int cycles)
+{
+	if(m_hasWriterThreadPages)
+	{
+		ClearWriterThreadPages();
+	}
+	return CGenericMipsExecutor::Execute(cycles);
 }
 
 void CEeExecutor::Reset()
@@ -145,24 +243,123 @@ BasicBlockPtr CEeExecutor::BlockFactory(CMIPS& context, uint32 start, uint32 end
 		}
 	}
 
-	auto result = std::make_shared<CBasicBlock>(context, start, end);
-	result->Compile();
+	auto result = TakeSpeculativeBlock(start, end, checksum);
+	if(!result)
+	{
+		result = MakeBasicBlock<CBasicBlock>(context, start, end);
+		CompileBlock(result.get(), checksum);
+	}
 	m_cachedBlocks.insert(std::make_pair(checksum, result));
 	return result;
 }
 
-bool CEeExecutor::HandleAccessFault(intptr_t ptr)
+void CEeExecutor::ClearSlowMemoryAccessBlock(uint32 start, uint32 end)
+{
+	//Make sure the block isn't recycled from the cache with its fast accesses
+	for(auto blockIterator = m_cachedBlocks.begin(); blockIterator != m_cachedBlocks.end();)
+	{
+		const auto& basicBlock(blockIterator->second);
+		if((basicBlock->GetBeginAddress() == start) && (basicBlock->GetEndAddress() == end))
+		{
+			blockIterator = m_cachedBlocks.erase(blockIterator);
+		}
+		else
+		{
+			blockIterator++;
+		}
+	}
+	CGenericMipsExecutor::ClearSlowMemoryAccessBlock(start, end);
+}
+
+bool CEeExecutor::CreateWorkerArchitecture(WORKER_CONTEXT& workerContext)
+{
+	//Same setup as Ee::CSubSystem
+	workerContext.arch = std::make_unique<CMA_EE>();
+	workerContext.coprocessors[0] = std::make_unique<CCOP_SCU>(MIPS_REGSIZE_64);
+	workerContext.coprocessors[1] = std::make_unique<CCOP_FPU>(MIPS_REGSIZE_64);
+	workerContext.coprocessors[2] = std::make_unique<CCOP_VU>(MIPS_REGSIZE_64);
+	return true;
+}
+
+bool CEeExecutor::OwnsAddress(intptr_t ptr) const
+{
+	ptrdiff_t addr = reinterpret_cast<uint8*>(ptr) - m_ram;
+	if(addr >= 0 && addr < PS2::EE_RAM_SIZE)
+	{
+		return true;
+	}
+	return m_context.m_fastMemory && m_context.m_fastMemory->Contains(ptr);
+}
+
+bool CEeExecutor::DispatchAccessFault(intptr_t ptr, bool fromWriterThread)
+{
+	for(auto& slot : g_eeExecutors)
+	{
+		if(!slot.executor.load()) continue;
+		//Load again after raising the handler count, the destructor waits for the count to drop before going on
+		slot.handlerCount++;
+		auto executor = slot.executor.load();
+		bool owned = false;
+		bool handled = false;
+		if(executor && executor->OwnsAddress(ptr))
+		{
+			owned = true;
+			handled = executor->HandleAccessFault(ptr, fromWriterThread);
+		}
+		slot.handlerCount--;
+		if(owned)
+		{
+			return handled;
+		}
+	}
+	return false;
+}
+
+bool CEeExecutor::HandleAccessFault(intptr_t ptr, bool fromWriterThread)
 {
+	//Writes to RAM can also come through its views in the fast memory arena
+	if(m_context.m_fastMemory)
+	{
+		if(auto memory = m_context.m_fastMemory->GetMemoryPointer(ptr))
+		{
+			ptr = reinterpret_cast<intptr_t>(memory);
+		}
+	}
 	ptrdiff_t addr = reinterpret_cast<uint8*>(ptr) - m_ram;
 	if(addr >= 0 && addr < PS2::EE_RAM_SIZE)
 	{
 		addr &= ~(m_pageSize - 1);
+		if(fromWriterThread)
+		{
+			//The emulation thread might be running blocks from this page, let the write go through
+			//and leave the blocks for the emulation thread to clear
+			SetMemoryProtected(m_ram + addr, m_pageSize, false);
+			uint32 page = static_cast<uint32>(addr / m_pageSize);
+			m_writerThreadPages[page / 32].fetch_or(1U << (page % 32));
+			m_hasWriterThreadPages = true;
+			return true;
+		}
 		ClearActiveBlocksInRange(addr, addr + m_pageSize, true);
 		return true;
 	}
 	return false;
 }
 
+void CEeExecutor::ClearWriterThreadPages()
+{
+	m_hasWriterThreadPages = false;
+	for(uint32 i = 0; i < m_writerThreadPageWordCount; i++)
+	{
+		uint32 pageBits = m_writerThreadPages[i].exchange(0);
+		for(uint32 bit = 0; pageBits != 0; bit++, pageBits >>= 1)
+		{
+			if((pageBits & 1) == 0) continue;
+			uint32 addr = ((i * 32) + bit) * m_pageSize;
+			ClearActiveBlocksInRange(addr, addr + m_pageSize, false);
+		}
+	}
+}
+
 void CEeExecutor::SetMemoryProtected(void* addr, size_t size, bool protect)
 {
 #ifdef DISABLE_PROTECTION
@@ -179,6 +376,10 @@ void CEeExecutor::SetMemoryProtected(void* addr, size_t size, bool protect)
 	size = size + (m_pageSize - 1) & ~(m_pageSize - 1);
 	int result = mprotect(addr, size, protect ? PROT_READ : PROT_READ | PROT_WRITE);
 	assert(result >= 0);
+	if(m_context.m_fastMemory)
+	{
+		m_context.m_fastMemory->SetMemoryProtected(reinterpret_cast<uint8*>(addr), size, protect);
+	}
 #else
 	assert(false);
 #endif
@@ -187,16 +388,11 @@ void CEeExecutor::SetMemoryProtected(void* addr, size_t size, bool protect)
 #if defined(_WIN32)
 
 LONG WINAPI CEeExecutor::HandleException(_EXCEPTION_POINTERS* exceptionInfo)
-{
-	return g_eeExecutor->HandleExceptionInternal(exceptionInfo);
-}
-
-LONG CEeExecutor::HandleExceptionInternal(_EXCEPTION_POINTERS* exceptionInfo)
 {
 	auto exceptionRecord = exceptionInfo->ExceptionRecord;
 	if(exceptionRecord->ExceptionCode == EXCEPTION_ACCESS_VIOLATION)
 	{
-		if(HandleAccessFault(exceptionRecord->ExceptionInformation[1]))
+		if(DispatchAccessFault(exceptionRecord->ExceptionInformation[1], g_isWriterThread))
 		{
 			return EXCEPTION_CONTINUE_EXECUTION;
 		}
@@ -207,14 +403,14 @@ LONG CEeExecutor::HandleExceptionInternal(_EXCEPTION_POINTERS* exceptionInfo)
 #elif defined(__unix__) || defined(__ANDROID__)
 
 void CEeExecutor::HandleException(int sigId, siginfo_t* sigInfo, void* baseContext)
-{
-	g_eeExecutor->HandleExceptionInternal(sigId, sigInfo, baseContext);
-}
-
-void CEeExecutor::HandleExceptionInternal(int sigId, siginfo_t* sigInfo, void* baseContext)
 {
 	if(sigId != SIGSEGV) return;
-	if(HandleAccessFault(reinterpret_cast<intptr_t>(sigInfo->si_addr)))
+	if(DispatchAccessFault(reinterpret_cast<intptr_t>(sigInfo->si_addr), g_isWriterThread))
+	{
+		return;
+	}
+	//Accesses to unmapped addresses of the arena (I/O, etc.) aren't handled by the executor
+	if(CFastMemoryArena::HandleAccessFault(reinterpret_cast<uintptr_t>(sigInfo->si_addr), baseContext))
 	{
 		return;
 	}
@@ -254,13 +450,13 @@ void CEeExecutor::HandlerThreadProc()
 		kern_return_t result = KERN_SUCCESS;
 
 		INPUT_MESSAGE inMsg;
-		result = mach_msg(&inMsg.head, MACH_RCV_MSG | MACH_RCV_LARGE | MACH_RCV_TIMEOUT, 0, sizeof(inMsg), m_port, 1000, MACH_PORT_NULL);
+		result = mach_msg(&inMsg.head, MACH_RCV_MSG | MACH_RCV_LARGE | MACH_RCV_TIMEOUT, 0, sizeof(inMsg), m_portSet, 1000, MACH_PORT_NULL);
 		if(result == MACH_RCV_TIMED_OUT) continue;
 		assert(result == KERN_SUCCESS);
 
 		assert(inMsg.head.msgh_id == 2406); //MACH_EXCEPTION_RAISE_RPC
 
-		bool success = HandleAccessFault(inMsg.code[1]);
+		bool success = HandleAccessFault(inMsg.code[1], inMsg.head.msgh_local_port == m_writerPort);
 
 		OUTPUT_MESSAGE outMsg;
 		outMsg.head.msgh_bits = MACH_MSGH_BITS(MACH_MSGH_BITS_REMOTE(inMsg.head.msgh_bits), 0);
@@ -9,22 +9,33 @@
 #include <signal.h>
 #endif
 
+#include <atomic>
+#include <memory>
 #include "../GenericMipsExecutor.h"
 
 class CEeExecutor : public CGenericMipsExecutor<BlockLookupTwoWay>
 {
 public:
 	CEeExecutor(CMIPS&, uint8*);
-	virtual ~CEeExecutor() = default;
+	virtual ~CEeExecutor();
 
 	void AddExceptionHandler();
 	void RemoveExceptionHandler();
 
+	//Must be called on any other thread that writes to EE RAM (ie.: IOP running on its own thread)
+	//Blocks invalidated by those writes are only cleared when the emulation thread enters Execute
+	void AttachWriterThread();
+
+	int Execute(int) override;
 	void Reset() override;
 	void ClearActiveBlocksInRange(uint32, uint32, bool) override;
 
 	BasicBlockPtr BlockFactory(CMIPS&, uint32, uint32) override;
 
+protected:
+	void ClearSlowMemoryAccessBlock(uint32, uint32) override;
+	bool CreateWorkerArchitecture(WORKER_CONTEXT&) override;
+
 private:
 	typedef std::unordered_multimap<uint32, BasicBlockPtr> CachedBlockMap;
 	CachedBlockMap m_cachedBlocks;
@@ -32,21 +43,29 @@ private:
 	uint8* m_ram = nullptr;
 	size_t m_pageSize = 0;
 
-	bool HandleAccessFault(intptr_t);
+	static bool DispatchAccessFault(intptr_t, bool);
+	bool OwnsAddress(intptr_t) const;
+	bool HandleAccessFault(intptr_t, bool);
 	void SetMemoryProtected(void*, size_t, bool);
+	void ClearWriterThreadPages();
+
+	//One bit per page, set from the fault handler of writer threads
+	std::unique_ptr<std::atomic<uint32>[]> m_writerThreadPages;
+	uint32 m_writerThreadPageWordCount = 0;
+	std::atomic<bool> m_hasWriterThreadPages;
 
 #if defined(_WIN32)
 	static LONG CALLBACK HandleException(_EXCEPTION_POINTERS*);
-	LONG HandleExceptionInternal(_EXCEPTION_POINTERS*);
 
 	LPVOID m_handler = NULL;
 #elif defined(__unix__) || defined(__ANDROID__)
 	static void HandleException(int, siginfo_t*, void*);
-	void HandleExceptionInternal(int, siginfo_t*, void*);
 #elif defined(__APPLE__)
 	void HandlerThreadProc();
 
 	mach_port_t m_port = MACH_PORT_NULL;
+	mach_port_t m_writerPort = MACH_PORT_NULL;
+	mach_port_t m_portSet = MACH_PORT_NULL;
 	std::thread m_handlerThread;
 	std::atomic<bool> m_running;
 #endif
@@ -24,10 +24,11 @@ using namespace Ee;
 
 #define FAKE_IOP_RAM_SIZE (0x1000)
 
-CSubSystem::CSubSystem(uint8* iopRam, CIopBios& iopBios)
-    : m_ram(reinterpret_cast<uint8*>(framework_aligned_alloc(PS2::EE_RAM_SIZE, framework_getpagesize())))
-    , m_bios(new uint8[PS2::EE_BIOS_SIZE])
-    , m_spr(reinterpret_cast<uint8*>(framework_aligned_alloc(PS2::EE_SPR_SIZE, 0x10)))
+CSubSystem::CSubSystem(uint8* iopRam, CIopBios& iopBios, bool fastMemoryEnabled, bool vu1ThreadEnabled)
+    : m_fastMemory(fastMemoryEnabled ? std::make_unique<CFastMemoryArena>() : nullptr)
+    , m_ram(m_fastMemory ? m_fastMemory->AllocateMemory(PS2::EE_RAM_SIZE) : reinterpret_cast<uint8*>(framework_aligned_alloc(PS2::EE_RAM_SIZE, framework_getpagesize())))
+    , m_bios(m_fastMemory ? m_fastMemory->AllocateMemory(PS2::EE_BIOS_SIZE) : new uint8[PS2::EE_BIOS_SIZE])
+    , m_spr(m_fastMemory ? m_fastMemory->AllocateMemory(PS2::EE_SPR_SIZE) : reinterpret_cast<uint8*>(framework_aligned_alloc(PS2::EE_SPR_SIZE, 0x10)))
     , m_fakeIopRam(new uint8[FAKE_IOP_RAM_SIZE])
     , m_vuMem0(reinterpret_cast<uint8*>(framework_aligned_alloc(PS2::VUMEM0SIZE, 0x10)))
     , m_microMem0(new uint8[PS2::MICROMEM0SIZE])
@@ -59,6 +60,10 @@ CSubSystem::CSubSystem(uint8* iopRam, CIopBios& iopBios)
 
 	m_vpu0 = std::make_shared<CVpu>(0, CVpu::VPUINIT(m_microMem0, m_vuMem0, &m_VU0), m_gif, m_intc, m_ram, m_spr);
 	m_vpu1 = std::make_shared<CVpu>(1, CVpu::VPUINIT(m_microMem1, m_vuMem1, &m_VU1), m_gif, m_intc, m_ram, m_spr);
+	if(vu1ThreadEnabled)
+	{
+		m_vpu1->StartWorker();
+	}
 
 	//Setup link between EE's VU context and VU0's VU context
 	m_vu0StateChangedConnection = m_vpu0->VuStateChanged.Connect([this](bool running) { Vu0StateChanged(running); });
@@ -70,24 +75,38 @@ CSubSystem::CSubSystem(uint8* iopRam, CIopBios& iopBios)
 		//Read map
 		m_EE.m_pMemoryMap->InsertReadMap(0x00000000, 0x01FFFFFF, m_ram, 0x00);
 		m_EE.m_pMemoryMap->InsertReadMap(PS2::EE_SPR_ADDR, PS2::EE_SPR_ADDR + PS2::EE_SPR_SIZE - 1, m_spr, 0x01);
-		m_EE.m_pMemoryMap->InsertReadMap(0x10000000, 0x10FFFFFF, std::bind(&CSubSystem::IOPortReadHandler, this, PLACEHOLDER_1), 0x02);
+		m_EE.m_pMemoryMap->InsertReadMap(0x10000000, 0x10FFFFFF, &CMemoryMap::ReadHandlerAdapter<CSubSystem, &CSubSystem::IOPortReadHandler>, this, 0x02);
 		m_EE.m_pMemoryMap->InsertReadMap(PS2::MICROMEM0ADDR, PS2::MICROMEM0ADDR + PS2::MICROMEM0SIZE - 1, m_microMem0, 0x03);
 		m_EE.m_pMemoryMap->InsertReadMap(PS2::VUMEM0ADDR, PS2::VUMEM0ADDR + PS2::VUMEM0SIZE - 1, m_vuMem0, 0x04);
 		m_EE.m_pMemoryMap->InsertReadMap(PS2::MICROMEM1ADDR, PS2::MICROMEM1ADDR + PS2::MICROMEM1SIZE - 1, m_microMem1, 0x05);
-		m_EE.m_pMemoryMap->InsertReadMap(PS2::VUMEM1ADDR, PS2::VUMEM1ADDR + PS2::VUMEM1SIZE - 1, m_vuMem1, 0x06);
-		m_EE.m_pMemoryMap->InsertReadMap(0x12000000, 0x12FFFFFF, std::bind(&CSubSystem::IOPortReadHandler, this, PLACEHOLDER_1), 0x07);
+		if(vu1ThreadEnabled)
+		{
+			m_EE.m_pMemoryMap->InsertReadMap(PS2::VUMEM1ADDR, PS2::VUMEM1ADDR + PS2::VUMEM1SIZE - 1, &CMemoryMap::ReadHandlerAdapter<CSubSystem, &CSubSystem::Vu1MemReadHandler>, this, 0x06);
+		}
+		else
+		{
+			m_EE.m_pMemoryMap->InsertReadMap(PS2::VUMEM1ADDR, PS2::VUMEM1ADDR + PS2::VUMEM1SIZE - 1, m_vuMem1, 0x06);
+		}
+		m_EE.m_pMemoryMap->InsertReadMap(0x12000000, 0x12FFFFFF, &CMemoryMap::ReadHandlerAdapter<CSubSystem, &CSubSystem::IOPortReadHandler>, this, 0x07);
 		m_EE.m_pMemoryMap->InsertReadMap(0x1C000000, 0x1C001000, m_fakeIopRam, 0x08);
 		m_EE.m_pMemoryMap->InsertReadMap(0x1FC00000, 0x1FFFFFFF, m_bios, 0x09);
 
 		//Write map
 		m_EE.m_pMemoryMap->InsertWriteMap(0x00000000, 0x01FFFFFF, m_ram, 0x00);
 		m_EE.m_pMemoryMap->InsertWriteMap(PS2::EE_SPR_ADDR, PS2::EE_SPR_ADDR + PS2::EE_SPR_SIZE - 1, m_spr, 0x01);
-		m_EE.m_pMemoryMap->InsertWriteMap(0x10000000, 0x10FFFFFF, std::bind(&CSubSystem::IOPortWriteHandler, this, PLACEHOLDER_1, PLACEHOLDER_2), 0x02);
-		m_EE.m_pMemoryMap->InsertWriteMap(PS2::MICROMEM0ADDR, PS2::MICROMEM0ADDR + PS2::MICROMEM0SIZE - 1, std::bind(&CSubSystem::Vu0MicroMemWriteHandler, this, PLACEHOLDER_1, PLACEHOLDER_2), 0x03);
+		m_EE.m_pMemoryMap->InsertWriteMap(0x10000000, 0x10FFFFFF, &CMemoryMap::WriteHandlerAdapter<CSubSystem, &CSubSystem::IOPortWriteHandler>, this, 0x02);
+		m_EE.m_pMemoryMap->InsertWriteMap(PS2::MICROMEM0ADDR, PS2::MICROMEM0ADDR + PS2::MICROMEM0SIZE - 1, &CMemoryMap::WriteHandlerAdapter<CSubSystem, &CSubSystem::Vu0MicroMemWriteHandler>, this, 0x03);
 		m_EE.m_pMemoryMap->InsertWriteMap(PS2::VUMEM0ADDR, PS2::VUMEM0ADDR + PS2::VUMEM0SIZE - 1, m_vuMem0, 0x04);
-		m_EE.m_pMemoryMap->InsertWriteMap(PS2::MICROMEM1ADDR, PS2::MICROMEM1ADDR + PS2::MICROMEM1SIZE - 1, std::bind(&CSubSystem::Vu1MicroMemWriteHandler, this, PLACEHOLDER_1, PLACEHOLDER_2), 0x05);
-		m_EE.m_pMemoryMap->InsertWriteMap(PS2::VUMEM1ADDR, PS2::VUMEM1ADDR + PS2::VUMEM1SIZE - 1, m_vuMem1, 0x06);
-		m_EE.m_pMemoryMap->InsertWriteMap(0x12000000, 0x12FFFFFF, std::bind(&CSubSystem::IOPortWriteHandler, this, PLACEHOLDER_1, PLACEHOLDER_2), 0x07);
+		m_EE.m_pMemoryMap->InsertWriteMap(PS2::MICROMEM1ADDR, PS2::MICROMEM1ADDR + PS2::MICROMEM1SIZE - 1, &CMemoryMap::WriteHandlerAdapter<CSubSystem, &CSubSystem::Vu1MicroMemWriteHandler>, this, 0x05);
+		if(vu1ThreadEnabled)
+		{
+			m_EE.m_pMemoryMap->InsertWriteMap(PS2::VUMEM1ADDR, PS2::VUMEM1ADDR + PS2::VUMEM1SIZE - 1, &CMemoryMap::WriteHandlerAdapter<CSubSystem, &CSubSystem::Vu1MemWriteHandler>, this, 0x06);
+		}
+		else
+		{
+			m_EE.m_pMemoryMap->InsertWriteMap(PS2::VUMEM1ADDR, PS2::VUMEM1ADDR + PS2::VUMEM1SIZE - 1, m_vuMem1, 0x06);
+		}
+		m_EE.m_pMemoryMap->InsertWriteMap(0x12000000, 0x12FFFFFF, &CMemoryMap::WriteHandlerAdapter<CSubSystem, &CSubSystem::IOPortWriteHandler>, this, 0x07);
 
 		//Instruction map
 		m_EE.m_pMemoryMap->InsertInstructionMap(0x00000000, 0x01FFFFFF, m_ram, 0x00);
@@ -109,13 +128,13 @@ CSubSystem::CSubSystem(uint8* iopRam, CIopBios& iopBios)
 		m_VU0.m_pMemoryMap->InsertReadMap(0x00001000, 0x00001FFF, m_vuMem0, 0x02);
 		m_VU0.m_pMemoryMap->InsertReadMap(0x00002000, 0x00002FFF, m_vuMem0, 0x03);
 		m_VU0.m_pMemoryMap->InsertReadMap(0x00003000, 0x00003FFF, m_vuMem0, 0x04);
-		m_VU0.m_pMemoryMap->InsertReadMap(0x00004000, 0x00008FFF, std::bind(&CSubSystem::Vu0IoPortReadHandler, this, PLACEHOLDER_1), 0x05);
+		m_VU0.m_pMemoryMap->InsertReadMap(0x00004000, 0x00008FFF, &CMemoryMap::ReadHandlerAdapter<CSubSystem, &CSubSystem::Vu0IoPortReadHandler>, this, 0x05);
 
 		m_VU0.m_pMemoryMap->InsertWriteMap(0x00000000, 0x00000FFF, m_vuMem0, 0x01);
 		m_VU0.m_pMemoryMap->InsertWriteMap(0x00001000, 0x00001FFF, m_vuMem0, 0x02);
 		m_VU0.m_pMemoryMap->InsertWriteMap(0x00002000, 0x00002FFF, m_vuMem0, 0x03);
 		m_VU0.m_pMemoryMap->InsertWriteMap(0x00003000, 0x00003FFF, m_vuMem0, 0x04);
-		m_VU0.m_pMemoryMap->InsertWriteMap(0x00004000, 0x00008FFF, std::bind(&CSubSystem::Vu0IoPortWriteHandler, this, PLACEHOLDER_1, PLACEHOLDER_2), 0x05);
+		m_VU0.m_pMemoryMap->InsertWriteMap(0x00004000, 0x00008FFF, &CMemoryMap::WriteHandlerAdapter<CSubSystem, &CSubSystem::Vu0IoPortWriteHandler>, this, 0x05);
 
 		m_VU0.m_pMemoryMap->InsertInstructionMap(0x00000000, 0x00000FFF, m_microMem0, 0x00);
 
@@ -128,10 +147,10 @@ CSubSystem::CSubSystem(uint8* iopRam, CIopBios& iopBios)
 		m_VU1.m_executor = std::make_unique<CVuExecutor>(m_VU1, PS2::MICROMEM1SIZE);
 
 		m_VU1.m_pMemoryMap->InsertReadMap(0x00000000, 0x00003FFF, m_vuMem1, 0x00);
-		m_VU1.m_pMemoryMap->InsertReadMap(0x00008000, 0x00008FFF, std::bind(&CSubSystem::Vu1IoPortReadHandler, this, PLACEHOLDER_1), 0x01);
+		m_VU1.m_pMemoryMap->InsertReadMap(0x00008000, 0x00008FFF, &CMemoryMap::ReadHandlerAdapter<CSubSystem, &CSubSystem::Vu1IoPortReadHandler>, this, 0x01);
 
 		m_VU1.m_pMemoryMap->InsertWriteMap(0x00000000, 0x00003FFF, m_vuMem1, 0x00);
-		m_VU1.m_pMemoryMap->InsertWriteMap(0x00008000, 0x00008FFF, std::bind(&CSubSystem::Vu1IoPortWriteHandler, this, PLACEHOLDER_1, PLACEHOLDER_2), 0x01);
+		m_VU1.m_pMemoryMap->InsertWriteMap(0x00008000, 0x00008FFF, &CMemoryMap::WriteHandlerAdapter<CSubSystem, &CSubSystem::Vu1IoPortWriteHandler>, this, 0x01);
 
 		m_VU1.m_pMemoryMap->InsertInstructionMap(0x00000000, 0x00003FFF, m_microMem1, 0x01);
 
@@ -145,7 +164,13 @@ CSubSystem::CSubSystem(uint8* iopRam, CIopBios& iopBios)
 
 	m_dmac.SetChannelTransferFunction(CDMAC::CHANNEL_ID_VIF0, std::bind(&CVif::ReceiveDMA, &m_vpu0->GetVif(), PLACEHOLDER_1, PLACEHOLDER_2, PLACEHOLDER_3, PLACEHOLDER_4));
 	m_dmac.SetChannelTransferFunction(CDMAC::CHANNEL_ID_VIF1, std::bind(&CVif::ReceiveDMA, &m_vpu1->GetVif(), PLACEHOLDER_1, PLACEHOLDER_2, PLACEHOLDER_3, PLACEHOLDER_4));
-	m_dmac.SetChannelTransferFunction(CDMAC::CHANNEL_ID_GIF, std::bind(&CGIF::ReceiveDMA, &m_gif, PLACEHOLDER_1, PLACEHOLDER_2, PLACEHOLDER_3, PLACEHOLDER_4));
+	m_dmac.SetChannelTransferFunction(
+	    CDMAC::CHANNEL_ID_GIF,
+	    [this](uint32 address, uint32 qwc, uint32 direction, bool tagIncluded) {
+		    //PATH3 packets must come after the ones kicked by a microprogram running on the VU1 thread
+		    m_vpu1->WaitForMicroProgram();
+		    return m_gif.ReceiveDMA(address, qwc, direction, tagIncluded);
+	    });
 	m_dmac.SetChannelTransferFunction(CDMAC::CHANNEL_ID_TO_IPU, std::bind(&CIPU::ReceiveDMA4, &m_ipu, PLACEHOLDER_1, PLACEHOLDER_2, PLACEHOLDER_4, m_ram, m_spr));
 	m_dmac.SetChannelTransferFunction(CDMAC::CHANNEL_ID_SIF0, std::bind(&CSIF::ReceiveDMA5, &m_sif, PLACEHOLDER_1, PLACEHOLDER_2, PLACEHOLDER_3, PLACEHOLDER_4));
 	m_dmac.SetChannelTransferFunction(CDMAC::CHANNEL_ID_SIF1, std::bind(&CSIF::ReceiveDMA6, &m_sif, PLACEHOLDER_1, PLACEHOLDER_2, PLACEHOLDER_3, PLACEHOLDER_4));
@@ -155,16 +180,26 @@ CSubSystem::CSubSystem(uint8* iopRam, CIopBios& iopBios)
 	m_os = new CPS2OS(m_EE, m_ram, m_bios, m_spr, m_gs, m_sif, iopBios);
 	m_OnRequestInstructionCacheFlushConnection = m_os->OnRequestInstructionCacheFlush.Connect(std::bind(&CSubSystem::FlushInstructionCache, this));
 
+	if(m_fastMemory)
+	{
+		m_fastMemory->Attach(m_EE);
+	}
+
 	SetupEePageTable();
 }
 
 CSubSystem::~CSubSystem()
 {
+	//VU1 thread uses the contexts and memory released below
+	m_vpu1->StopWorker();
 	m_EE.m_executor->Reset();
 	delete m_os;
-	framework_aligned_free(m_ram);
-	delete[] m_bios;
-	framework_aligned_free(m_spr);
+	if(!m_fastMemory)
+	{
+		framework_aligned_free(m_ram);
+		delete[] m_bios;
+		framework_aligned_free(m_spr);
+	}
 	delete[] m_fakeIopRam;
 	framework_aligned_free(m_vuMem0);
 	delete[] m_microMem0;
@@ -184,6 +219,7 @@ void CSubSystem::SetVpu1(std::shared_ptr<CVpu> newVpu1)
 
 void CSubSystem::Reset()
 {
+	m_vpu1->WaitForMicroProgram();
 	m_os->Release();
 	m_EE.m_executor->Reset();
 
@@ -298,7 +334,8 @@ void CSubSystem::CountTicks(int ticks)
 	{
 		m_dmac.ResumeDMA0();
 	}
-	if(!m_vpu1->IsVuRunning() || (m_vpu1->IsVuRunning() && !m_vpu1->GetVif().IsWaitingForProgramEnd()))
+	//Check VIF first, IsVuRunning waits for a program running on the VU1 thread
+	if(!m_vpu1->GetVif().IsWaitingForProgramEnd() || !m_vpu1->IsVuRunning())
 	{
 		m_dmac.ResumeDMA1();
 	}
@@ -334,7 +371,10 @@ void CSubSystem::CountTicks(int ticks)
 
 void CSubSystem::NotifyVBlankStart()
 {
+	//Frame is about to be flipped, the GS needs to have everything VU1 kicked
+	m_vpu1->WaitForMicroProgram();
 	m_timer.NotifyVBlankStart();
+	m_ipu.NotifyVBlankStart();
 	m_intc.AssertLine(CINTC::INTC_LINE_VBLANK_START);
 	if(m_os->CheckVBlankFlag())
 	{
@@ -352,6 +392,8 @@ void CSubSystem::NotifyVBlankEnd()
 
 void CSubSystem::SaveState(Framework::CZipArchiveWriter& archive)
 {
+	m_vpu1->WaitForMicroProgram();
+
 	archive.InsertFile(new CMemoryStateFile(STATE_EE, &m_EE.m_State, sizeof(MIPSSTATE)));
 	archive.InsertFile(new CMemoryStateFile(STATE_VU0, &m_VU0.m_State, sizeof(MIPSSTATE)));
 	archive.InsertFile(new CMemoryStateFile(STATE_VU1, &m_VU1.m_State, sizeof(MIPSSTATE)));
@@ -373,6 +415,7 @@ void CSubSystem::SaveState(Framework::CZipArchiveWriter& archive)
 
 void CSubSystem::LoadState(Framework::CZipArchiveReader& archive)
 {
+	m_vpu1->WaitForMicroProgram();
 	m_EE.m_executor->Reset();
 
 	archive.BeginReadFile(STATE_EE)->Read(&m_EE.m_State, sizeof(MIPSSTATE));
@@ -400,6 +443,12 @@ void CSubSystem::SetupEePageTable()
 	m_EE.MapPages(0x20000000, PS2::EE_RAM_SIZE, m_ram);
 	m_EE.MapPages(0x70000000, PS2::EE_SPR_SIZE, m_spr);
 	m_EE.MapPages(0x80000000, PS2::EE_RAM_SIZE, m_ram);
+
+	//BIOS isn't in the page table (writes must be ignored), map it as read-only for fast loads
+	if(m_fastMemory)
+	{
+		m_fastMemory->MapMemory(0x1FC00000, m_bios, PS2::EE_BIOS_SIZE, false);
+	}
 }
 
 uint32 CSubSystem::IOPortReadHandler(uint32 nAddress)
@@ -415,6 +464,7 @@ uint32 CSubSystem::IOPortReadHandler(uint32 nAddress)
 	}
 	else if(nAddress >= CGIF::REGS_START && nAddress < CGIF::REGS_END)
 	{
+		m_vpu1->WaitForMicroProgram();
 		nReturn = m_gif.GetRegister(nAddress);
 	}
 	else if(nAddress >= CVif::REGS0_START && nAddress < CVif::REGS0_END)
@@ -423,6 +473,7 @@ uint32 CSubSystem::IOPortReadHandler(uint32 nAddress)
 	}
 	else if(nAddress >= CVif::REGS1_START && nAddress < CVif::REGS1_END)
 	{
+		m_vpu1->WaitForMicroProgram();
 		nReturn = m_vpu1->GetVif().GetRegister(nAddress);
 	}
 	else if(nAddress >= 0x10008000 && nAddress <= 0x1000EFFC)
@@ -441,6 +492,8 @@ uint32 CSubSystem::IOPortReadHandler(uint32 nAddress)
 	{
 		if(m_gs != NULL)
 		{
+			//SIGNAL/FINISH events can come from packets kicked by VU1
+			m_vpu1->WaitForMicroProgram();
 			nReturn = m_gs->ReadPrivRegister(nAddress);
 		}
 	}
@@ -512,6 +565,7 @@ uint32 CSubSystem::IOPortWriteHandler(uint32 nAddress, uint32 nData)
 	else if(nAddress == 0x1000F180)
 	{
 		//stdout data
+		m_sif.SyncIop();
 		m_iopBios.GetIoman()->Write(Iop::CIoman::FID_STDOUT, 1, &nData);
 	}
 	else if(nAddress >= 0x1000F520 && nAddress <= 0x1000F59C)
@@ -530,6 +584,7 @@ uint32 CSubSystem::IOPortWriteHandler(uint32 nAddress, uint32 nData)
 	{
 		if(m_gs != NULL)
 		{
+			m_vpu1->WaitForMicroProgram();
 			m_gs->WritePrivRegister(nAddress, nData);
 		}
 	}
@@ -599,12 +654,32 @@ void CSubSystem::Vu0StateChanged(bool running)
 
 uint32 CSubSystem::Vu1MicroMemWriteHandler(uint32 address, uint32 value)
 {
+	m_vpu1->WaitForMicroProgram();
 	uint32 baseAddress = address - PS2::MICROMEM1ADDR;
 	*reinterpret_cast<uint32*>(m_microMem1 + baseAddress) = value;
 	m_vpu1->InvalidateMicroProgram(baseAddress, baseAddress + 4);
 	return 0;
 }
 
+uint32 CSubSystem::Vu1MemReadHandler(uint32 address)
+{
+	//Only used when VU1 runs on its own thread, byte and half reads use the low bits of the result
+	m_vpu1->WaitForMicroProgram();
+	uint32 offset = address - PS2::VUMEM1ADDR;
+	uint32 value = *reinterpret_cast<const uint32*>(m_vuMem1 + (offset & ~0x03));
+	return value >> ((offset & 0x03) * 8);
+}
+
+uint32 CSubSystem::Vu1MemWriteHandler(uint32 address, uint32 value)
+{
+	//Only used when VU1 runs on its own thread, the running microprogram must not see the write.
+	//Handlers don't know the access size, writes are done as words like for micro memory.
+	m_vpu1->WaitForMicroProgram();
+	uint32 offset = address - PS2::VUMEM1ADDR;
+	*reinterpret_cast<uint32*>(m_vuMem1 + (offset & ~0x03)) = value;
+	return 0;
+}
+
 uint32 CSubSystem::Vu1IoPortReadHandler(uint32 address)
 {
 	uint32 result = 0xCCCCCCCC;
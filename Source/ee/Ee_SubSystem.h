@@ -3,6 +3,7 @@
 #include "AlignedAlloc.h"
 #include "../COP_SCU.h"
 #include "../COP_FPU.h"
+#include "../FastMemoryArena.h"
 #include "DMAC.h"
 #include "GIF.h"
 #include "SIF.h"
@@ -24,7 +25,7 @@ namespace Ee
 	class CSubSystem
 	{
 	public:
-		CSubSystem(uint8*, CIopBios&);
+		CSubSystem(uint8*, CIopBios&, bool, bool);
 		virtual ~CSubSystem();
 
 		void Reset();
@@ -41,6 +42,9 @@ namespace Ee
 		void SetVpu0(std::shared_ptr<CVpu>);
 		void SetVpu1(std::shared_ptr<CVpu>);
 
+		//Owns RAM, BIOS and scratchpad when fast memory is enabled
+		std::unique_ptr<CFastMemoryArena> m_fastMemory;
+
 		uint8* m_ram = nullptr;
 		uint8* m_bios = nullptr;
 		uint8* m_spr = nullptr;
@@ -93,6 +97,8 @@ namespace Ee
 		void Vu0StateChanged(bool);
 
 		uint32 Vu1MicroMemWriteHandler(uint32, uint32);
+		uint32 Vu1MemReadHandler(uint32);
+		uint32 Vu1MemWriteHandler(uint32, uint32);
 
 		uint32 Vu1IoPortReadHandler(uint32);
 		uint32 Vu1IoPortWriteHandler(uint32, uint32);
@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include <algorithm>
+#include <cstring>
 #include "../uint128.h"
 #include "../Ps2Const.h"
 #include "../Log.h"
@@ -27,7 +28,7 @@ CGIF::CGIF(CGSHandler*& gs, uint8* ram, uint8* spr)
     , m_ram(ram)
     , m_spr(spr)
     , m_gs(gs)
-    , m_gifProfilerZone(CProfiler::GetInstance().RegisterZone("GIF"))
+    , m_gifProfilerZone(CProfiler::RegisterZone("GIF"))
 {
 }
 
@@ -250,7 +251,11 @@ uint32 CGIF::ProcessImage(const uint8* memory, uint32 address, uint32 end)
 {
 	uint16 totalLoops = static_cast<uint16>((end - address) / 0x10);
 	totalLoops = std::min<uint16>(totalLoops, m_loops);
-	m_gs->FeedImageData(memory + address, totalLoops * 0x10);
+	//PATH2 (VIF1 DIRECT) and PATH3 data comes from guest memory, copy it straight to the GS thread's buffer
+	uint32 length = totalLoops * 0x10;
+	auto imageData = m_gs->BeginImageData(length);
+	memcpy(imageData, memory + address, length);
+	m_gs->EndImageData();
 	m_loops -= totalLoops;
 
 	return (totalLoops * 0x10);
@@ -388,6 +393,34 @@ uint32 CGIF::ProcessMultiplePackets(const uint8* memory, uint32 address, uint32
 	return address - start;
 }
 
+uint32 CGIF::GetPacketSize(const uint8* memory, uint32 address, uint32 end)
+{
+	//Size of the packet starting at address, up to the end of the tag with EOP set
+	uint32 start = address;
+	while(address < end)
+	{
+		auto tag = *reinterpret_cast<const TAG*>(&memory[address]);
+		address += 0x10;
+
+		uint32 regs = (tag.nreg == 0) ? 0x10 : tag.nreg;
+		switch(tag.cmd)
+		{
+		case 0x00:
+			address += tag.loops * regs * 0x10;
+			break;
+		case 0x01:
+			address += ((tag.loops * regs + 1) / 2) * 0x10;
+			break;
+		default:
+			address += tag.loops * 0x10;
+			break;
+		}
+
+		if(tag.eop) break;
+	}
+	return std::min(address, end) - start;
+}
+
 uint32 CGIF::ReceiveDMA(uint32 address, uint32 qwc, uint32 unused, bool tagIncluded)
 {
 	uint32 size = qwc * 0x10;
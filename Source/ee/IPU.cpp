@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 #include <stdio.h>
@@ -10,6 +11,8 @@
 #include "IPU_MacroblockTypeBTable.h"
 #include "IPU_MotionCodeTable.h"
 #include "IPU_DmVectorTable.h"
+#include "IPU_FastIdct.h"
+#include "IPU_MacroblockPipeline.h"
 #include "mpeg2/DcSizeLuminanceTable.h"
 #include "mpeg2/DcSizeChrominanceTable.h"
 #include "mpeg2/DctCoefficientTable0.h"
@@ -20,6 +23,7 @@
 #include "idct/TrivialC.h"
 #include "idct/IEEE1180.h"
 #include "../Log.h"
+#include "../Trace.h"
 #include "DMAC.h"
 #include "INTC.h"
 #include "Ps2Const.h"
@@ -29,6 +33,10 @@
 //#define _DECODE_LOGGING
 #define DECODE_LOG_NAME ("ipu_decode")
 
+//Writes every dequantised block given to the IDCT to a file (can be replayed by MicroBench)
+//#define _IDCT_CAPTURE
+#define IDCT_CAPTURE_PATH ("ipu_idct_blocks.bin")
+
 using namespace IPU;
 using namespace MPEG2;
 
@@ -81,6 +89,12 @@ CIPU::CIPU(CINTC& intc)
 
 CIPU::~CIPU()
 {
+	if(m_outFifoStats.frameCount != 0)
+	{
+		CLog::GetInstance().Print(LOG_NAME, "OUT FIFO: %llu bytes written, %llu bytes copied, %llu bytes copied per frame (%d at most) over %d frames.\r\n",
+		                          m_outFifoStats.bytesWritten, m_outFifoStats.bytesCopied, m_outFifoStats.bytesCopied / m_outFifoStats.frameCount,
+		                          m_outFifoStats.maxFrameBytesCopied, m_outFifoStats.frameCount);
+	}
 }
 
 void CIPU::Reset()
@@ -100,6 +114,7 @@ void CIPU::Reset()
 
 	m_isBusy = false;
 	m_currentCmd = nullptr;
+	DiscardMacroblockPipeline();
 
 	m_IN_FIFO.Reset();
 	m_OUT_FIFO.Reset();
@@ -189,7 +204,7 @@ uint32 CIPU::GetRegister(uint32 nAddress)
 		break;
 
 	default:
-		CLog::GetInstance().Print(LOG_NAME, "Reading an unhandled register (0x%08X).\r\n", nAddress);
+		TRACE_PRINT(LOG_NAME, "Reading an unhandled register (0x%08X).\r\n", nAddress);
 		break;
 	}
 
@@ -198,9 +213,10 @@ uint32 CIPU::GetRegister(uint32 nAddress)
 
 void CIPU::SetRegister(uint32 nAddress, uint32 nValue)
 {
-#ifdef _DEBUG
-	DisassembleSet(nAddress, nValue);
-#endif
+	if(CTrace::IsEnabled())
+	{
+		DisassembleSet(nAddress, nValue);
+	}
 
 	switch(nAddress)
 	{
@@ -217,9 +233,10 @@ void CIPU::SetRegister(uint32 nAddress, uint32 nValue)
 			InitializeCommand(nValue);
 			m_isBusy = true;
 		}
-#ifdef _DEBUG
-		DisassembleCommand(nValue);
-#endif
+		if(CTrace::IsEnabled())
+		{
+			DisassembleCommand(nValue);
+		}
 		break;
 	case IPU_CMD + 0x4:
 	case IPU_CMD + 0x8:
@@ -231,6 +248,7 @@ void CIPU::SetRegister(uint32 nAddress, uint32 nValue)
 		{
 			m_isBusy = false;
 			m_currentCmd = nullptr;
+			DiscardMacroblockPipeline();
 			m_IN_FIFO.Reset();
 			m_OUT_FIFO.Reset();
 		}
@@ -251,7 +269,7 @@ void CIPU::SetRegister(uint32 nAddress, uint32 nValue)
 		break;
 
 	default:
-		CLog::GetInstance().Print(LOG_NAME, "Writing 0x%08X to an unhandled register (0x%08X).\r\n", nValue, nAddress);
+		TRACE_PRINT(LOG_NAME, "Writing 0x%08X to an unhandled register (0x%08X).\r\n", nValue, nAddress);
 		break;
 	}
 }
@@ -295,17 +313,20 @@ void CIPU::ExecuteCommand()
 	}
 	catch(const CStartCodeException&)
 	{
+		DrainMacroblockPipeline();
 		m_currentCmd = nullptr;
 		m_isBusy = false;
 		m_IPU_CTRL |= IPU_CTRL_SCD;
-		CLog::GetInstance().Print(LOG_NAME, "Start code encountered.\r\n");
+		TRACE_PRINT(LOG_NAME, "Start code encountered.\r\n");
 	}
 	catch(const CVLCTable::CVLCTableException&)
 	{
+		//Macroblocks parsed before the error are still output
+		DrainMacroblockPipeline();
 		m_currentCmd = nullptr;
 		m_isBusy = false;
 		m_IPU_CTRL |= IPU_CTRL_ECD;
-		CLog::GetInstance().Print(LOG_NAME, "VLC error encountered.\r\n");
+		TRACE_PRINT(LOG_NAME, "VLC error encountered.\r\n");
 	}
 }
 
@@ -324,6 +345,62 @@ void CIPU::FlushOUTFIFOData()
 	m_OUT_FIFO.Flush();
 }
 
+void CIPU::SetFastCscEnabled(bool fastCscEnabled)
+{
+	m_CSCCommand.SetFastConversionEnabled(fastCscEnabled);
+}
+
+void CIPU::SetFastIdctEnabled(bool fastIdctEnabled)
+{
+	m_BDECCommand.SetFastIdctEnabled(fastIdctEnabled);
+}
+
+void CIPU::SetDecodeThreadCount(unsigned int threadCount)
+{
+	assert(!m_isBusy);
+	m_macroblockPipeline.reset();
+	if(threadCount != 0)
+	{
+		//The reference IDCT is created on first use, make sure workers don't race to create it
+		IDCT::CIEEE1180::GetInstance();
+		m_macroblockPipeline = std::make_unique<CMacroblockPipeline>(threadCount, m_CSCCommand);
+	}
+}
+
+//Only frames where the IPU produced something are counted
+void CIPU::NotifyVBlankStart()
+{
+	auto fifoStats = m_OUT_FIFO.GetStats();
+	if(fifoStats.bytesWritten == m_outFifoStats.bytesWritten) return;
+	auto frameBytesCopied = static_cast<uint32>(fifoStats.bytesCopied - m_outFifoStats.bytesCopied);
+	m_outFifoStats.frameCount++;
+	m_outFifoStats.bytesWritten = fifoStats.bytesWritten;
+	m_outFifoStats.bytesCopied = fifoStats.bytesCopied;
+	m_outFifoStats.lastFrameBytesCopied = frameBytesCopied;
+	m_outFifoStats.maxFrameBytesCopied = std::max(m_outFifoStats.maxFrameBytesCopied, frameBytesCopied);
+}
+
+CIPU::OUTFIFO_STATS CIPU::GetOutFifoStats() const
+{
+	return m_outFifoStats;
+}
+
+void CIPU::DrainMacroblockPipeline()
+{
+	if(m_macroblockPipeline)
+	{
+		m_macroblockPipeline->Drain(&m_OUT_FIFO);
+	}
+}
+
+void CIPU::DiscardMacroblockPipeline()
+{
+	if(m_macroblockPipeline)
+	{
+		m_macroblockPipeline->Discard();
+	}
+}
+
 void CIPU::InitializeCommand(uint32 value)
 {
 	unsigned int nCmd = (value >> 28);
@@ -339,13 +416,13 @@ void CIPU::InitializeCommand(uint32 value)
 	break;
 	case IPU_CMD_IDEC:
 	{
-		m_IDECCommand.Initialize(&m_BDECCommand, &m_CSCCommand, &m_IN_FIFO, &m_OUT_FIFO, value, GetDecoderContext(), m_nTH0, m_nTH1);
+		m_IDECCommand.Initialize(&m_BDECCommand, &m_CSCCommand, &m_IN_FIFO, &m_OUT_FIFO, value, GetDecoderContext(), m_nTH0, m_nTH1, m_macroblockPipeline.get());
 		m_currentCmd = &m_IDECCommand;
 	}
 	break;
 	case IPU_CMD_BDEC:
 	{
-		m_BDECCommand.Initialize(&m_IN_FIFO, &m_OUT_FIFO, value, true, GetDecoderContext());
+		m_BDECCommand.Initialize(&m_IN_FIFO, &m_OUT_FIFO, value, true, GetDecoderContext(), m_macroblockPipeline.get());
 		m_currentCmd = &m_BDECCommand;
 	}
 	break;
@@ -388,7 +465,7 @@ void CIPU::InitializeCommand(uint32 value)
 	break;
 	default:
 		assert(0);
-		CLog::GetInstance().Print(LOG_NAME, "Unhandled command execution requested (%d).\r\n", value >> 28);
+		TRACE_PRINT(LOG_NAME, "Unhandled command execution requested (%d).\r\n", value >> 28);
 		break;
 	}
 }
@@ -588,6 +665,65 @@ void CIPU::InverseScan(int16* pBlock, bool isZigZag)
 	}
 }
 
+void CIPU::DecodeMacroblock(MACROBLOCK& macroblock)
+{
+	const auto& context = macroblock.context;
+	for(unsigned int i = 0; i < 6; i++)
+	{
+		//Blocks that are not coded stay at 0
+		if(!(macroblock.codedBlockPattern & (1 << (5 - i))))
+		{
+			continue;
+		}
+
+		int16* block = macroblock.blocks[i];
+		int16 blockTemp[0x40];
+
+		InverseScan(block, context.isZigZag);
+		DequantiseBlock(block, macroblock.intra, macroblock.qsc,
+		                context.isLinearQScale, context.dcPrecision, context.intraIq, context.nonIntraIq);
+
+		memcpy(blockTemp, block, sizeof(int16) * 0x40);
+
+#ifdef _IDCT_CAPTURE
+		static FILE* captureFile = fopen(IDCT_CAPTURE_PATH, "wb");
+		if(captureFile)
+		{
+			fwrite(blockTemp, sizeof(int16), 0x40, captureFile);
+		}
+#endif
+		if(macroblock.fastIdct)
+		{
+			CFastIdct::Transform(blockTemp, block);
+		}
+		else
+		{
+			IDCT::CIEEE1180::GetInstance()->Transform(blockTemp, block);
+		}
+	}
+}
+
+//Luminance blocks are interleaved (Y0 & Y1 rows, then Y2 & Y3 rows), followed by Cb and Cr
+void CIPU::WriteRaw16Macroblock(const MACROBLOCK& macroblock, int16* output)
+{
+	for(unsigned int i = 0; i < 8; i++)
+	{
+		memcpy(output, macroblock.blocks[0] + (i * 8), sizeof(int16) * 0x8);
+		memcpy(output + 0x8, macroblock.blocks[1] + (i * 8), sizeof(int16) * 0x8);
+		output += 0x10;
+	}
+
+	for(unsigned int i = 0; i < 8; i++)
+	{
+		memcpy(output, macroblock.blocks[2] + (i * 8), sizeof(int16) * 0x8);
+		memcpy(output + 0x8, macroblock.blocks[3] + (i * 8), sizeof(int16) * 0x8);
+		output += 0x10;
+	}
+
+	memcpy(output, macroblock.blocks[4], sizeof(int16) * 0x40);
+	memcpy(output + 0x40, macroblock.blocks[5], sizeof(int16) * 0x40);
+}
+
 uint32 CIPU::GetBusyBit(bool condition) const
 {
 	return condition ? 0x80000000 : 0x00000000;
@@ -617,16 +753,16 @@ void CIPU::DisassembleGet(uint32 nAddress)
 	switch(nAddress)
 	{
 	case IPU_CMD:
-		CLog::GetInstance().Print(LOG_NAME, "IPU_CMD\r\n");
+		TRACE_PRINT(LOG_NAME, "IPU_CMD\r\n");
 		break;
 	case IPU_CTRL:
-		CLog::GetInstance().Print(LOG_NAME, "IPU_CTRL\r\n");
+		TRACE_PRINT(LOG_NAME, "IPU_CTRL\r\n");
 		break;
 	case IPU_BP:
-		CLog::GetInstance().Print(LOG_NAME, "IPU_BP\r\n");
+		TRACE_PRINT(LOG_NAME, "IPU_BP\r\n");
 		break;
 	case IPU_TOP:
-		CLog::GetInstance().Print(LOG_NAME, "IPU_TOP\r\n");
+		TRACE_PRINT(LOG_NAME, "IPU_TOP\r\n");
 		break;
 	}
 }
@@ -636,7 +772,7 @@ void CIPU::DisassembleSet(uint32 nAddress, uint32 nValue)
 	switch(nAddress)
 	{
 	case IPU_CMD + 0x0:
-		CLog::GetInstance().Print(LOG_NAME, "IPU_CMD = 0x%08X\r\n", nValue);
+		TRACE_PRINT(LOG_NAME, "IPU_CMD = 0x%08X\r\n", nValue);
 		break;
 	case IPU_CMD + 0x4:
 	case IPU_CMD + 0x8:
@@ -644,7 +780,7 @@ void CIPU::DisassembleSet(uint32 nAddress, uint32 nValue)
 		break;
 
 	case IPU_CTRL + 0x0:
-		CLog::GetInstance().Print(LOG_NAME, "IPU_CTRL = 0x%08X\r\n", nValue);
+		TRACE_PRINT(LOG_NAME, "IPU_CTRL = 0x%08X\r\n", nValue);
 		break;
 	case IPU_CTRL + 0x4:
 	case IPU_CTRL + 0x8:
@@ -655,7 +791,7 @@ void CIPU::DisassembleSet(uint32 nAddress, uint32 nValue)
 	case IPU_IN_FIFO + 0x4:
 	case IPU_IN_FIFO + 0x8:
 	case IPU_IN_FIFO + 0xC:
-		CLog::GetInstance().Print(LOG_NAME, "IPU_IN_FIFO = 0x%08X\r\n", nValue);
+		TRACE_PRINT(LOG_NAME, "IPU_IN_FIFO = 0x%08X\r\n", nValue);
 		break;
 	}
 }
@@ -665,15 +801,15 @@ void CIPU::DisassembleCommand(uint32 nValue)
 	switch(nValue >> 28)
 	{
 	case 0:
-		CLog::GetInstance().Print(LOG_NAME, "BCLR(bp = %i);\r\n", nValue & 0x7F);
+		TRACE_PRINT(LOG_NAME, "BCLR(bp = %i);\r\n", nValue & 0x7F);
 		break;
 	case 2:
-		CLog::GetInstance().Print(LOG_NAME, "BDEC(mbi = %i, dcr = %i, dt = %i, qsc = %i, fb = %i);\r\n",
-		                          (nValue >> 27) & 1,
-		                          (nValue >> 26) & 1,
-		                          (nValue >> 25) & 1,
-		                          (nValue >> 16) & 0x1F,
-		                          nValue & 0x3F);
+		TRACE_PRINT(LOG_NAME, "BDEC(mbi = %i, dcr = %i, dt = %i, qsc = %i, fb = %i);\r\n",
+		            (nValue >> 27) & 1,
+		            (nValue >> 26) & 1,
+		            (nValue >> 25) & 1,
+		            (nValue >> 16) & 0x1F,
+		            nValue & 0x3F);
 		break;
 	case 3:
 	{
@@ -714,26 +850,26 @@ void CIPU::DisassembleCommand(uint32 nValue)
 			tblName = "DM Vector";
 			break;
 		}
-		CLog::GetInstance().Print(LOG_NAME, "VDEC(tbl = %i (%s), bp = %i);\r\n", tbl, tblName, nValue & 0x3F);
+		TRACE_PRINT(LOG_NAME, "VDEC(tbl = %i (%s), bp = %i);\r\n", tbl, tblName, nValue & 0x3F);
 	}
 	break;
 	case 4:
-		CLog::GetInstance().Print(LOG_NAME, "FDEC(bp = %i);\r\n", nValue & 0x3F);
+		TRACE_PRINT(LOG_NAME, "FDEC(bp = %i);\r\n", nValue & 0x3F);
 		break;
 	case 5:
-		CLog::GetInstance().Print(LOG_NAME, "SETIQ(iqm = %i, bp = %i);\r\n", (nValue & 0x08000000) != 0 ? 1 : 0, nValue & 0x7F);
+		TRACE_PRINT(LOG_NAME, "SETIQ(iqm = %i, bp = %i);\r\n", (nValue & 0x08000000) != 0 ? 1 : 0, nValue & 0x7F);
 		break;
 	case 6:
-		CLog::GetInstance().Print(LOG_NAME, "SETVQ();\r\n");
+		TRACE_PRINT(LOG_NAME, "SETVQ();\r\n");
 		break;
 	case 7:
-		CLog::GetInstance().Print(LOG_NAME, "CSC(ofm = %i, dte = %i, mbc = %i);\r\n",
-		                          (nValue >> 27) & 1,
-		                          (nValue >> 26) & 1,
-		                          (nValue >> 0) & 0x7FF);
+		TRACE_PRINT(LOG_NAME, "CSC(ofm = %i, dte = %i, mbc = %i);\r\n",
+		            (nValue >> 27) & 1,
+		            (nValue >> 26) & 1,
+		            (nValue >> 0) & 0x7FF);
 		break;
 	case 9:
-		CLog::GetInstance().Print(LOG_NAME, "SETTH(th0 = 0x%04X, th1 = 0x%04X);\r\n", nValue & 0x1FF, (nValue >> 16) & 0x1FF);
+		TRACE_PRINT(LOG_NAME, "SETTH(th0 = 0x%04X, th1 = 0x%04X);\r\n", nValue & 0x1FF, (nValue >> 16) & 0x1FF);
 		break;
 	}
 }
@@ -742,61 +878,100 @@ void CIPU::DisassembleCommand(uint32 nValue)
 //OUT FIFO class implementation
 /////////////////////////////////////////////
 
-CIPU::COUTFIFO::COUTFIFO()
-    : m_buffer(nullptr)
-    , m_alloc(0)
-    , m_size(0)
+void CIPU::COUTFIFO::SetReceiveHandler(const Dma3ReceiveHandler& handler)
 {
+	m_receiveHandler = handler;
 }
 
-CIPU::COUTFIFO::~COUTFIFO()
+uint32 CIPU::COUTFIFO::GetSize() const
 {
-	free(m_buffer);
+	return m_size;
 }
 
-void CIPU::COUTFIFO::SetReceiveHandler(const Dma3ReceiveHandler& handler)
+bool CIPU::COUTFIFO::CanWrite(unsigned int size) const
 {
-	m_receiveHandler = handler;
+	assert(size <= SLAB_SIZE);
+	const auto& slab = m_slabs[m_writeSlab];
+	if((slab.writePosition + size) <= SLAB_SIZE) return true;
+	return ((m_writeSlab + 1) % SLAB_COUNT) != m_readSlab;
 }
 
-uint32 CIPU::COUTFIFO::GetSize() const
+void* CIPU::COUTFIFO::Reserve(unsigned int size)
 {
-	return m_size;
+	assert((size & 0x0F) == 0);
+	assert(CanWrite(size));
+	if((m_slabs[m_writeSlab].writePosition + size) > SLAB_SIZE)
+	{
+		m_writeSlab = (m_writeSlab + 1) % SLAB_COUNT;
+		assert(m_slabs[m_writeSlab].writePosition == 0);
+	}
+	auto& slab = m_slabs[m_writeSlab];
+	return slab.data + slab.writePosition;
 }
 
-void CIPU::COUTFIFO::Write(const void* data, unsigned int size)
+void CIPU::COUTFIFO::Commit(unsigned int size)
 {
-	RequestGrow(size);
-
-	memcpy(m_buffer + m_size, data, size);
+	auto& slab = m_slabs[m_writeSlab];
+	assert((slab.writePosition + size) <= SLAB_SIZE);
+	slab.writePosition += size;
 	m_size += size;
+	m_stats.bytesWritten += size;
+}
+
+void CIPU::COUTFIFO::Write(const void* data, unsigned int size)
+{
+	memcpy(Reserve(size), data, size);
+	Commit(size);
+	m_stats.bytesCopied += size;
 }
 
 void CIPU::COUTFIFO::Flush()
 {
-	//Write to memory through DMA channel 3
-	assert((m_size & 0x0F) == 0);
-	uint32 copied = m_receiveHandler(m_buffer, m_size / 0x10);
-	copied *= 0x10;
+	//Write to memory through DMA channel 3, one slab at a time
+	while(m_size != 0)
+	{
+		auto& slab = m_slabs[m_readSlab];
+		uint32 available = slab.writePosition - slab.readPosition;
+		assert((available & 0x0F) == 0);
+		uint32 copied = 0;
+		if(available != 0)
+		{
+			copied = m_receiveHandler(slab.data + slab.readPosition, available / 0x10);
+			copied *= 0x10;
+			slab.readPosition += copied;
+			m_size -= copied;
+		}
 
-	if(copied == 0) return;
+		if(slab.readPosition == slab.writePosition)
+		{
+			slab.readPosition = 0;
+			slab.writePosition = 0;
+			if(m_readSlab != m_writeSlab)
+			{
+				m_readSlab = (m_readSlab + 1) % SLAB_COUNT;
+				continue;
+			}
+		}
 
-	memmove(m_buffer, m_buffer + copied, m_size - copied);
-	m_size -= copied;
+		if(copied != available) break;
+	}
 }
 
 void CIPU::COUTFIFO::Reset()
 {
+	for(auto& slab : m_slabs)
+	{
+		slab.readPosition = 0;
+		slab.writePosition = 0;
+	}
+	m_readSlab = 0;
+	m_writeSlab = 0;
 	m_size = 0;
 }
 
-void CIPU::COUTFIFO::RequestGrow(unsigned int size)
+CIPU::COUTFIFO::STATS CIPU::COUTFIFO::GetStats() const
 {
-	while(m_alloc <= (size + m_size))
-	{
-		m_alloc += GROWSIZE;
-		m_buffer = reinterpret_cast<uint8*>(realloc(m_buffer, m_alloc));
-	}
+	return m_stats;
 }
 
 /////////////////////////////////////////////
@@ -905,6 +1080,31 @@ void CIPU::CINFIFO::SetBitPosition(unsigned int position)
 	m_bitPosition = position;
 }
 
+//Copies up to size bytes if the current position is byte aligned, returns the number of bytes copied
+unsigned int CIPU::CINFIFO::ReadAlignedBytes(void* data, unsigned int size)
+{
+	if((m_bitPosition & 7) != 0) return 0;
+
+	unsigned int position = m_bitPosition / 8;
+	if(position >= m_size) return 0;
+
+	size = std::min(size, m_size - position);
+	memcpy(data, m_buffer + position, size);
+	m_bitPosition += size * 8;
+
+	//Discard the read bytes like Advance does
+	unsigned int discardSize = (m_bitPosition / 128) * 16;
+	if(discardSize != 0)
+	{
+		memmove(m_buffer, m_buffer + discardSize, m_size - discardSize);
+		m_size -= discardSize;
+		m_bitPosition -= discardSize * 8;
+	}
+	m_lookupBitsDirty = true;
+
+	return size;
+}
+
 unsigned int CIPU::CINFIFO::GetSize() const
 {
 	return m_size;
@@ -971,7 +1171,7 @@ CIPU::CIDECCommand::CIDECCommand()
 }
 
 void CIPU::CIDECCommand::Initialize(CBDECCommand* BDECCommand, CCSCCommand* CSCCommand, CINFIFO* inFifo, COUTFIFO* outFifo,
-                                    uint32 commandCode, const DECODER_CONTEXT& context, uint16 TH0, uint16 TH1)
+                                    uint32 commandCode, const DECODER_CONTEXT& context, uint16 TH0, uint16 TH1, CMacroblockPipeline* pipeline)
 {
 	m_command <<= commandCode;
 	assert(m_command.cmdId == IPU_CMD_IDEC);
@@ -980,6 +1180,8 @@ void CIPU::CIDECCommand::Initialize(CBDECCommand* BDECCommand, CCSCCommand* CSCC
 	m_OUT_FIFO = outFifo;
 	m_BDECCommand = BDECCommand;
 	m_CSCCommand = CSCCommand;
+	m_pipeline = pipeline;
+	m_waitingForPipeline = false;
 
 	m_state = STATE_DELAY;
 	m_dt = 0;
@@ -994,6 +1196,12 @@ void CIPU::CIDECCommand::Initialize(CBDECCommand* BDECCommand, CCSCCommand* CSCC
 
 bool CIPU::CIDECCommand::Execute()
 {
+	m_waitingForPipeline = false;
+	if(m_pipeline)
+	{
+		TakePipelineResults();
+	}
+
 	while(1)
 	{
 		switch(m_state)
@@ -1055,7 +1263,8 @@ bool CIPU::CIDECCommand::Execute()
 			bdecCommand.dt = m_dt;
 			bdecCommand.dcr = (m_mbCount == 0) ? 1 : 0;
 			bdecCommand.qsc = m_qsc;
-			m_BDECCommand->Initialize(m_IN_FIFO, &m_temp_OUT_FIFO, bdecCommand, false, m_context);
+			//With a pipeline, BDEC only parses the macroblock and the rest is done by the workers
+			m_BDECCommand->Initialize(m_IN_FIFO, m_pipeline ? nullptr : &m_temp_OUT_FIFO, bdecCommand, false, m_context, nullptr);
 			m_state = STATE_READBLOCK;
 			m_blockStream.ResetBuffer();
 		}
@@ -1066,6 +1275,12 @@ bool CIPU::CIDECCommand::Execute()
 			{
 				return false;
 			}
+			if(m_pipeline)
+			{
+				m_state = STATE_SUBMITBLOCK;
+				m_mbCount++;
+				break;
+			}
 			//BDEC will yield 384 elements in RAW16 format
 			assert(m_blockStream.GetSize() == (CCSCCommand::BLOCK_SIZE * sizeof(int16)));
 			ConvertRawBlock();
@@ -1113,7 +1328,23 @@ bool CIPU::CIDECCommand::Execute()
 				}
 			}
 			break;
-		case STATE_CHECKSTARTCODE:
+		case STATE_SUBMITBLOCK:
+		{
+			if(m_pipeline->IsFull())
+			{
+				m_waitingForPipeline = true;
+				return false;
+			}
+			CMacroblockPipeline::JOB job;
+			job.macroblock = m_BDECCommand->GetMacroblock();
+			job.outputFormat = m_command.ofm ? CMacroblockPipeline::OUTPUT_FORMAT_RGB16 : CMacroblockPipeline::OUTPUT_FORMAT_RGBA32;
+			job.dither = (m_command.dte != 0);
+			job.TH0 = m_TH0;
+			job.TH1 = m_TH1;
+			m_pipeline->Submit(job);
+			m_state = STATE_CHECKSTARTCODE;
+		}
+		break;		case STATE_CHECKSTARTCODE:
 		{
 			uint32 nextBits = 0;
 			if(!m_IN_FIFO->TryPeekBits_MSBF(8, nextBits))
@@ -1140,6 +1371,22 @@ bool CIPU::CIDECCommand::Execute()
 			{
 				throw CVLCTable::CVLCTableException();
 			}
+			m_state = m_pipeline ? STATE_DRAIN : STATE_DONE;
+		}
+		break;
+		case STATE_DRAIN:
+		{
+			//Command is done once all macroblocks have been decoded and accepted by DMA3
+			TakePipelineResults();
+			if(m_OUT_FIFO->GetSize() != 0)
+			{
+				return false;
+			}
+			if(!m_pipeline->IsEmpty())
+			{
+				m_waitingForPipeline = true;
+				return false;
+			}
 			m_state = STATE_DONE;
 		}
 		break;
@@ -1172,7 +1419,16 @@ void CIPU::CIDECCommand::CountTicks(uint32 ticks)
 
 bool CIPU::CIDECCommand::IsDelayed() const
 {
-	return (m_state == STATE_DELAY);
+	return (m_state == STATE_DELAY) || m_waitingForPipeline;
+}
+
+//Results are only taken when DMA3 has accepted everything, like the serial decoder does
+void CIPU::CIDECCommand::TakePipelineResults()
+{
+	while((m_OUT_FIFO->GetSize() == 0) && m_pipeline->TakeResult(m_OUT_FIFO))
+	{
+		m_OUT_FIFO->Flush();
+	}
 }
 
 void CIPU::CIDECCommand::ConvertRawBlock()
@@ -1197,21 +1453,21 @@ void CIPU::CIDECCommand::ConvertRawBlock()
 
 CIPU::CBDECCommand::CBDECCommand()
 {
-	m_blocks[0].block = m_yBlock[0];
+	m_blocks[0].block = m_macroblock.blocks[0];
 	m_blocks[0].channel = 0;
-	m_blocks[1].block = m_yBlock[1];
+	m_blocks[1].block = m_macroblock.blocks[1];
 	m_blocks[1].channel = 0;
-	m_blocks[2].block = m_yBlock[2];
+	m_blocks[2].block = m_macroblock.blocks[2];
 	m_blocks[2].channel = 0;
-	m_blocks[3].block = m_yBlock[3];
+	m_blocks[3].block = m_macroblock.blocks[3];
 	m_blocks[3].channel = 0;
-	m_blocks[4].block = m_cbBlock;
+	m_blocks[4].block = m_macroblock.blocks[4];
 	m_blocks[4].channel = 1;
-	m_blocks[5].block = m_crBlock;
+	m_blocks[5].block = m_macroblock.blocks[5];
 	m_blocks[5].channel = 2;
 }
 
-void CIPU::CBDECCommand::Initialize(CINFIFO* inFifo, COUTFIFO* outFifo, uint32 commandCode, bool checkStartCode, const DECODER_CONTEXT& context)
+void CIPU::CBDECCommand::Initialize(CINFIFO* inFifo, COUTFIFO* outFifo, uint32 commandCode, bool checkStartCode, const DECODER_CONTEXT& context, CMacroblockPipeline* pipeline)
 {
 	m_command <<= commandCode;
 	assert(m_command.cmdId == IPU_CMD_BDEC);
@@ -1222,12 +1478,28 @@ void CIPU::CBDECCommand::Initialize(CINFIFO* inFifo, COUTFIFO* outFifo, uint32 c
 
 	m_IN_FIFO = inFifo;
 	m_OUT_FIFO = outFifo;
+	m_pipeline = pipeline;
 	m_state = STATE_ADVANCE;
 
 	m_codedBlockPattern = 0;
 	m_currentBlockIndex = 0;
 }
 
+bool CIPU::CBDECCommand::IsDelayed() const
+{
+	return (m_state == STATE_WAITOUTPUT);
+}
+
+void CIPU::CBDECCommand::SetFastIdctEnabled(bool fastIdctEnabled)
+{
+	m_fastIdctEnabled = fastIdctEnabled;
+}
+
+const CIPU::MACROBLOCK& CIPU::CBDECCommand::GetMacroblock() const
+{
+	return m_macroblock;
+}
+
 bool CIPU::CBDECCommand::Execute()
 {
 	while(1)
@@ -1258,8 +1530,8 @@ bool CIPU::CBDECCommand::Execute()
 		{
 #ifdef _DECODE_LOGGING
 			static int currentMbIndex = 0;
-			CLog::GetInstance().Print(DECODE_LOG_NAME, "Macroblock(%d, CBP: 0x%02X)\r\n",
-			                          currentMbIndex++, m_codedBlockPattern);
+			TRACE_PRINT(DECODE_LOG_NAME, "Macroblock(%d, CBP: 0x%02X)\r\n",
+			            currentMbIndex++, m_codedBlockPattern);
 #endif
 			if(m_command.dcr)
 			{
@@ -1315,18 +1587,6 @@ bool CIPU::CBDECCommand::Execute()
 			{
 				return false;
 			}
-
-			BLOCKENTRY& blockInfo(m_blocks[m_currentBlockIndex]);
-			int16 blockTemp[0x40];
-
-			InverseScan(blockInfo.block, m_context.isZigZag);
-			DequantiseBlock(blockInfo.block, (m_command.mbi != 0), m_command.qsc,
-			                m_context.isLinearQScale, m_context.dcPrecision, m_context.intraIq, m_context.nonIntraIq);
-
-			memcpy(blockTemp, blockInfo.block, sizeof(int16) * 0x40);
-
-			IDCT::CIEEE1180::GetInstance()->Transform(blockTemp, blockInfo.block);
-
 			m_state = STATE_DECODEBLOCK_GOTONEXT;
 		}
 		break;
@@ -1335,7 +1595,7 @@ bool CIPU::CBDECCommand::Execute()
 			m_currentBlockIndex++;
 			if(m_currentBlockIndex == 6)
 			{
-				m_state = STATE_DONE;
+				m_state = STATE_DECODE;
 			}
 			else
 			{
@@ -1343,24 +1603,56 @@ bool CIPU::CBDECCommand::Execute()
 			}
 		}
 		break;
-		case STATE_DONE:
+		case STATE_DECODE:
 		{
-			//Write blocks into out FIFO
-			for(unsigned int i = 0; i < 8; i++)
+			m_macroblock.codedBlockPattern = m_codedBlockPattern;
+			m_macroblock.intra = (m_command.mbi != 0);
+			m_macroblock.qsc = static_cast<uint8>(m_command.qsc);
+			m_macroblock.fastIdct = m_fastIdctEnabled;
+			m_macroblock.context = m_context;
+
+			if(!m_OUT_FIFO)
 			{
-				m_OUT_FIFO->Write(m_blocks[0].block + (i * 8), sizeof(int16) * 0x8);
-				m_OUT_FIFO->Write(m_blocks[1].block + (i * 8), sizeof(int16) * 0x8);
+				//Caller will decode the macroblock
+				return true;
 			}
 
-			for(unsigned int i = 0; i < 8; i++)
+			if(m_pipeline)
 			{
-				m_OUT_FIFO->Write(m_blocks[2].block + (i * 8), sizeof(int16) * 0x8);
-				m_OUT_FIFO->Write(m_blocks[3].block + (i * 8), sizeof(int16) * 0x8);
+				//Previous command waited for its results, there's always room here
+				CMacroblockPipeline::JOB job;
+				job.macroblock = m_macroblock;
+				job.outputFormat = CMacroblockPipeline::OUTPUT_FORMAT_RAW16;
+				m_pipeline->Submit(job);
+				m_state = STATE_WAITOUTPUT;
 			}
-
-			m_OUT_FIFO->Write(m_blocks[4].block, sizeof(int16) * 0x40);
-			m_OUT_FIFO->Write(m_blocks[5].block, sizeof(int16) * 0x40);
-
+			else
+			{
+				static const unsigned int outputSize = MACROBLOCK::RAW16_SIZE * sizeof(int16);
+				if(!m_OUT_FIFO->CanWrite(outputSize))
+				{
+					//Wait for DMA3 to make room
+					return false;
+				}
+				DecodeMacroblock(m_macroblock);
+				WriteRaw16Macroblock(m_macroblock, reinterpret_cast<int16*>(m_OUT_FIFO->Reserve(outputSize)));
+				m_OUT_FIFO->Commit(outputSize);
+				m_state = STATE_DONE;
+			}
+		}
+		break;
+		case STATE_WAITOUTPUT:
+		{
+			//The EE keeps running while the worker decodes the macroblock
+			if(!m_pipeline->TakeResult(m_OUT_FIFO))
+			{
+				return false;
+			}
+			m_state = STATE_DONE;
+		}
+		break;
+		case STATE_DONE:
+		{
 			m_OUT_FIFO->Flush();
 
 			//Check if there's more than 7 zero bits after this and set "start code detected"
@@ -1435,7 +1727,7 @@ bool CIPU::CBDECCommand_ReadDct::Execute()
 		{
 #ifdef _DECODE_LOGGING
 			static int currentBlockIndex = 0;
-			CLog::GetInstance().Print(DECODE_LOG_NAME, "Block(%d) = ", currentBlockIndex++);
+			TRACE_PRINT(DECODE_LOG_NAME, "Block(%d) = ", currentBlockIndex++);
 #endif
 			if(m_mbi)
 			{
@@ -1457,7 +1749,7 @@ bool CIPU::CBDECCommand_ReadDct::Execute()
 			m_block[0] = static_cast<int16>(m_dcPredictor[m_channelId] + m_dcDiff);
 			m_dcPredictor[m_channelId] = m_block[0];
 #ifdef _DECODE_LOGGING
-			CLog::GetInstance().Print(DECODE_LOG_NAME, "[%d]: %d ", 0, m_block[0]);
+			TRACE_PRINT(DECODE_LOG_NAME, "[%d]: %d ", 0, m_block[0]);
 #endif
 			m_blockIndex = 1;
 			m_state = STATE_CHECKEOB;
@@ -1504,7 +1796,7 @@ bool CIPU::CBDECCommand_ReadDct::Execute()
 			{
 				m_block[m_blockIndex] = static_cast<int16>(runLevelPair.level);
 #ifdef _DECODE_LOGGING
-				CLog::GetInstance().Print(DECODE_LOG_NAME, "[%d]: %d ", m_blockIndex, runLevelPair.level);
+				TRACE_PRINT(DECODE_LOG_NAME, "[%d]: %d ", m_blockIndex, runLevelPair.level);
 #endif
 			}
 			else
@@ -1522,7 +1814,7 @@ bool CIPU::CBDECCommand_ReadDct::Execute()
 				return false;
 			}
 #ifdef _DECODE_LOGGING
-			CLog::GetInstance().Print(DECODE_LOG_NAME, "\r\n");
+			TRACE_PRINT(DECODE_LOG_NAME, "\r\n");
 #endif
 			return true;
 			break;
@@ -1717,8 +2009,8 @@ bool CIPU::CVDECCommand::Execute()
 				tableName = "dm vector";
 			}
 			static unsigned int currentVdec = 0;
-			CLog::GetInstance().Print(DECODE_LOG_NAME, "Symbol(%d, '%s') = %d\r\n",
-			                          currentVdec++, tableName, static_cast<int16>((*m_result) & 0xFFFF));
+			TRACE_PRINT(DECODE_LOG_NAME, "Symbol(%d, '%s') = %d\r\n",
+			            currentVdec++, tableName, static_cast<int16>((*m_result) & 0xFFFF));
 #endif
 			return true;
 			break;
@@ -1837,6 +2129,7 @@ bool CIPU::CSETVQCommand::Execute()
 CIPU::CCSCCommand::CCSCCommand()
 {
 	GenerateCbCrMap();
+	GenerateColorOffsets();
 }
 
 void CIPU::CCSCCommand::Initialize(CINFIFO* input, COUTFIFO* output, uint32 commandCode, uint16 TH0, uint16 TH1)
@@ -1855,6 +2148,11 @@ void CIPU::CCSCCommand::Initialize(CINFIFO* input, COUTFIFO* output, uint32 comm
 	m_mbCount = m_command.mbc;
 }
 
+void CIPU::CCSCCommand::SetFastConversionEnabled(bool fastConversionEnabled)
+{
+	m_fastConversionEnabled = fastConversionEnabled;
+}
+
 bool CIPU::CCSCCommand::Execute()
 {
 	while(1)
@@ -1882,6 +2180,13 @@ bool CIPU::CCSCCommand::Execute()
 			}
 			else
 			{
+				//Data is usually byte aligned (always when coming from IDEC), copy as much as we can
+				unsigned int readSize = m_IN_FIFO->ReadAlignedBytes(m_block + m_currentIndex, BLOCK_SIZE - m_currentIndex);
+				if(readSize != 0)
+				{
+					m_currentIndex += readSize;
+					break;
+				}
 				uint32 blockValue = 0;
 				if(!m_IN_FIFO->TryGetBits_MSBF(8, blockValue))
 				{
@@ -1894,79 +2199,14 @@ bool CIPU::CCSCCommand::Execute()
 		break;
 		case STATE_CONVERTBLOCK:
 		{
-			uint32 nPixel[0x100];
-
-			uint8* pY = m_block;
-			uint8* nBlockCb = m_block + 0x100;
-			uint8* nBlockCr = m_block + 0x140;
-
-			uint32* pPixel = nPixel;
-			unsigned int* pCbCrMap = m_nCbCrMap;
-
-			uint32 alphaTh0 = (m_TH0 & 0xFF) | ((m_TH0 & 0xFF) << 8) | ((m_TH0 & 0xFF) << 16);
-			uint32 alphaTh1 = (m_TH1 & 0xFF) | ((m_TH1 & 0xFF) << 8) | ((m_TH1 & 0xFF) << 16);
-
-			for(unsigned int i = 0; i < 16; i++)
+			if(!m_OUT_FIFO->CanWrite(OUTPUT_SIZE_MAX))
 			{
-				for(unsigned int j = 0; j < 16; j++)
-				{
-					float nY = pY[j];
-					float nCb = nBlockCb[pCbCrMap[j]];
-					float nCr = nBlockCr[pCbCrMap[j]];
-
-					float nR = nY + 1.402f * (nCr - 128);
-					float nG = nY - 0.34414f * (nCb - 128) - 0.71414f * (nCr - 128);
-					float nB = nY + 1.772f * (nCb - 128);
-
-					if(nR < 0)
-					{
-						nR = 0;
-					}
-					if(nR > 255)
-					{
-						nR = 255;
-					}
-					if(nG < 0)
-					{
-						nG = 0;
-					}
-					if(nG > 255)
-					{
-						nG = 255;
-					}
-					if(nB < 0)
-					{
-						nB = 0;
-					}
-					if(nB > 255)
-					{
-						nB = 255;
-					}
-
-					uint8 a = 0;
-					uint32 rgb = (static_cast<uint8>(nB) << 16) | (static_cast<uint8>(nG) << 8) | (static_cast<uint8>(nR) << 0);
-					if(rgb < alphaTh0)
-					{
-						a = 0;
-					}
-					else if(rgb < alphaTh1)
-					{
-						a = 0x40;
-					}
-					else
-					{
-						a = 0x80;
-					}
-
-					pPixel[j] = (a << 24) | rgb;
-				}
-
-				pY += 0x10;
-				pCbCrMap += 0x10;
-				pPixel += 0x10;
+				//Wait for DMA3 to make room
+				return false;
 			}
-
-			m_OUT_FIFO->Write(nPixel, sizeof(uint32) * 0x100);
+			void* output = m_OUT_FIFO->Reserve(OUTPUT_SIZE_MAX);
+			unsigned int outputSize = ConvertMacroblock(m_block, output, m_command.ofm, m_command.dte, m_TH0, m_TH1);
+			m_OUT_FIFO->Commit(outputSize);
 
 			m_mbCount--;
 			m_state = STATE_FLUSHBLOCK;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <functional>
+#include <memory>
 #include "Types.h"
 #include "BitStream.h"
 #include "MemStream.h"
@@ -42,6 +43,27 @@ public:
 	bool HasPendingOUTFIFOData() const;
 	void FlushOUTFIFOData();
 
+	//Fixed-point CSC kernels are used by default, the floating point converter can be forced for comparison
+	void SetFastCscEnabled(bool);
+
+	//Uses the fixed-point IDCT instead of the IEEE 1180 reference for BDEC and IDEC
+	void SetFastIdctEnabled(bool);
+
+	//Decodes BDEC and IDEC macroblocks on worker threads (0 decodes them while executing the command)
+	void SetDecodeThreadCount(unsigned int);
+
+	struct OUTFIFO_STATS
+	{
+		uint32 frameCount = 0;
+		uint64 bytesWritten = 0;
+		uint64 bytesCopied = 0;
+		uint32 lastFrameBytesCopied = 0;
+		uint32 maxFrameBytesCopied = 0;
+	};
+
+	void NotifyVBlankStart();
+	OUTFIFO_STATS GetOutFifoStats() const;
+
 private:
 	enum IPU_CTRL_BITS
 	{
@@ -120,31 +142,76 @@ private:
 		uint32 dcPrecision = 0;
 	};
 
+	//Macroblock parsed by BDEC, coefficients are in bitstream order (before inverse scan and dequantisation)
+	struct MACROBLOCK
+	{
+		enum
+		{
+			RAW16_SIZE = 0x180,
+		};
+
+		int16 blocks[6][0x40];
+		uint8 codedBlockPattern = 0;
+		bool intra = false;
+		uint8 qsc = 0;
+		bool fastIdct = false;
+		DECODER_CONTEXT context;
+	};
+
+	class CMacroblockPipeline;
+
+	//Fixed ring of slabs, each slab holds at least one converted macroblock.
+	//Producers convert straight into a slab (Reserve/Commit) and Flush hands slabs to DMA3 as they are.
 	class COUTFIFO
 	{
 	public:
-		COUTFIFO();
-		virtual ~COUTFIFO();
+		enum
+		{
+			SLAB_SIZE = 0x400,
+			SLAB_COUNT = 0x20,
+		};
+
+		struct STATS
+		{
+			uint64 bytesWritten = 0;
+			//Part of bytesWritten that went through Write
+			uint64 bytesCopied = 0;
+		};
+
+		COUTFIFO() = default;
+		virtual ~COUTFIFO() = default;
 
 		uint32 GetSize() const;
+		bool CanWrite(unsigned int) const;
+
+		//Returns where the next 'size' bytes must be written, Commit makes them visible to Flush
+		void* Reserve(unsigned int);
+		void Commit(unsigned int);
+
+		//Copies data that wasn't produced in place
 		void Write(const void*, unsigned int);
+
 		void Flush();
 		void SetReceiveHandler(const Dma3ReceiveHandler&);
 
 		void Reset();
 
-	private:
-		void RequestGrow(unsigned int);
+		STATS GetStats() const;
 
-		enum GROWSIZE
+	private:
+		struct SLAB
 		{
-			GROWSIZE = 0x200,
+			alignas(16) uint8 data[SLAB_SIZE];
+			unsigned int readPosition = 0;
+			unsigned int writePosition = 0;
 		};
 
-		unsigned int m_size;
-		unsigned int m_alloc;
-		uint8* m_buffer;
+		SLAB m_slabs[SLAB_COUNT];
+		unsigned int m_readSlab = 0;
+		unsigned int m_writeSlab = 0;
+		unsigned int m_size = 0;
 		Dma3ReceiveHandler m_receiveHandler;
+		STATS m_stats;
 	};
 
 	class CINFIFO : public Framework::CBitStream
@@ -162,6 +229,7 @@ private:
 		bool TryPeekBits_MSBF(uint8, uint32&) override;
 
 		void SetBitPosition(unsigned int);
+		unsigned int ReadAlignedBytes(void*, unsigned int);
 		unsigned int GetSize() const;
 		unsigned int GetAvailableBits() const;
 		void Reset();
@@ -225,7 +293,7 @@ private:
 	public:
 		CIDECCommand();
 
-		void Initialize(CBDECCommand*, CCSCCommand*, CINFIFO*, COUTFIFO*, uint32, const DECODER_CONTEXT&, uint16, uint16);
+		void Initialize(CBDECCommand*, CCSCCommand*, CINFIFO*, COUTFIFO*, uint32, const DECODER_CONTEXT&, uint16, uint16, CMacroblockPipeline*);
 		bool Execute() override;
 		void CountTicks(uint32) override;
 		bool IsDelayed() const override;
@@ -245,10 +313,13 @@ private:
 			STATE_READMBINCREMENT,
 			STATE_CSCINIT,
 			STATE_CSC,
+			STATE_SUBMITBLOCK,
+			STATE_DRAIN,
 			STATE_DONE
 		};
 
 		void ConvertRawBlock();
+		void TakePipelineResults();
 
 		CMD_IDEC m_command = make_convertible<CMD_IDEC>(0);
 		STATE m_state = STATE_DONE;
@@ -257,6 +328,8 @@ private:
 		CCSCCommand* m_CSCCommand = nullptr;
 		CINFIFO* m_IN_FIFO = nullptr;
 		COUTFIFO* m_OUT_FIFO = nullptr;
+		CMacroblockPipeline* m_pipeline = nullptr;
+		bool m_waitingForPipeline = false;
 
 		CINFIFO m_temp_IN_FIFO;
 		COUTFIFO m_temp_OUT_FIFO;
@@ -334,8 +407,14 @@ private:
 	public:
 		CBDECCommand();
 
-		void Initialize(CINFIFO*, COUTFIFO*, uint32, bool, const DECODER_CONTEXT&);
+		//Without an output FIFO, Execute only parses the macroblock, it can then be taken with GetMacroblock.
+		//With a pipeline, the macroblock is decoded on a worker thread.
+		void Initialize(CINFIFO*, COUTFIFO*, uint32, bool, const DECODER_CONTEXT&, CMacroblockPipeline*);
 		bool Execute() override;
+		bool IsDelayed() const override;
+
+		void SetFastIdctEnabled(bool);
+		const MACROBLOCK& GetMacroblock() const;
 
 	private:
 		enum STATE
@@ -346,6 +425,8 @@ private:
 			STATE_DECODEBLOCK_BEGIN,
 			STATE_DECODEBLOCK_READCOEFFS,
 			STATE_DECODEBLOCK_GOTONEXT,
+			STATE_DECODE,
+			STATE_WAITOUTPUT,
 			STATE_DONE
 		};
 
@@ -360,17 +441,16 @@ private:
 
 		CINFIFO* m_IN_FIFO = nullptr;
 		COUTFIFO* m_OUT_FIFO = nullptr;
+		CMacroblockPipeline* m_pipeline = nullptr;
 		bool m_checkStartCode = false;
 
 		uint8 m_codedBlockPattern = 0;
 
 		BLOCKENTRY m_blocks[6];
-
-		int16 m_yBlock[4][64];
-		int16 m_cbBlock[64];
-		int16 m_crBlock[64];
+		MACROBLOCK m_macroblock;
 
 		unsigned int m_currentBlockIndex = 0;
+		bool m_fastIdctEnabled = false;
 
 		DECODER_CONTEXT m_context;
 		CBDECCommand_ReadDct m_readDctCoeffsCommand;
@@ -460,6 +540,7 @@ private:
 		enum
 		{
 			BLOCK_SIZE = 0x180,
+			OUTPUT_SIZE_MAX = 0x400,
 		};
 
 		CCSCCommand();
@@ -467,6 +548,12 @@ private:
 		void Initialize(CINFIFO*, COUTFIFO*, uint32, uint16, uint16);
 		bool Execute() override;
 
+		void SetFastConversionEnabled(bool);
+
+		//Converts a RAW8 macroblock to RGBA32 or RGB16, returns the size of the output in bytes.
+		//Only uses constant state, can be called from any thread.
+		unsigned int ConvertMacroblock(const uint8*, void*, bool, bool, uint16, uint16) const;
+
 	private:
 		enum STATE
 		{
@@ -477,7 +564,20 @@ private:
 			STATE_DONE,
 		};
 
+		enum
+		{
+			PIXEL_COUNT = 0x100,
+		};
+
 		void GenerateCbCrMap();
+		void GenerateColorOffsets();
+
+		//Implemented in IPU_Csc.cpp
+		void ConvertBlockReference(const uint8*, uint32*, uint16, uint16) const;
+		void ConvertBlockFast(const uint8*, uint32*, uint16, uint16) const;
+		static void ConvertToRgb16Reference(uint16*, const uint32*, bool);
+		static void ConvertToRgb16Fast(uint16*, const uint32*, bool);
+		int16 GetGreenOffset(uint8, uint8) const;
 
 		STATE m_state = STATE_DONE;
 		CMD_CSC m_command = make_convertible<CMD_CSC>(0);
@@ -492,6 +592,13 @@ private:
 
 		unsigned int m_nCbCrMap[0x100];
 
+		//Integer offsets from Y for each value of Cr (red) and Cb (blue), see GenerateColorOffsets
+		int16 m_redOffsets[0x100];
+		int16 m_blueOffsets[0x100];
+		float m_greenCbTerms[0x100];
+		float m_greenCrTerms[0x100];
+		bool m_fastConversionEnabled = true;
+
 		uint8 m_block[BLOCK_SIZE];
 	};
 
@@ -522,6 +629,11 @@ private:
 
 	static void DequantiseBlock(int16*, uint8, uint8, bool isLinearQScale, uint32 dcPrecision, uint8* intraIq, uint8* nonIntraIq);
 	static void InverseScan(int16*, bool isZigZag);
+	static void DecodeMacroblock(MACROBLOCK&);
+	static void WriteRaw16Macroblock(const MACROBLOCK&, int16*);
+
+	void DrainMacroblockPipeline();
+	void DiscardMacroblockPipeline();
 
 	uint32 GetBusyBit(bool) const;
 	FIFO_STATE GetFifoState() const;
@@ -543,6 +655,7 @@ private:
 	uint32 m_IPU_CMD[2];
 	uint32 m_IPU_CTRL;
 	COUTFIFO m_OUT_FIFO;
+	OUTFIFO_STATS m_outFifoStats;
 	CINFIFO m_IN_FIFO;
 	uint32 m_lastCmd;
 	bool m_isBusy;
@@ -557,4 +670,6 @@ private:
 	CSETVQCommand m_SETVQCommand;
 	CCSCCommand m_CSCCommand;
 	CSETTHCommand m_SETTHCommand;
+
+	std::unique_ptr<CMacroblockPipeline> m_macroblockPipeline;
 };
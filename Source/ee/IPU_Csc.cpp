@@ -0,0 +1,380 @@
+#include <algorithm>
+#include <cmath>
+#include "IPU.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define IPU_CSC_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define IPU_CSC_NEON
+#endif
+
+//Color space conversion kernels. The fast path must produce exactly the same results as
+//the floating point reference converter.
+
+//For a given chroma pair, the reference converter always ends up adding the same integer to Y
+//(before clamping), no matter the value of Y. Evaluating the floating point formula with Y = 128
+//gives that integer for every possible input, this has been checked exhaustively.
+
+static const int g_ditherMatrix[4][4] =
+    {
+        {-4, 0, -3, 1},
+        {2, -2, 3, -1},
+        {-3, 1, -4, 0},
+        {3, -1, 2, -2},
+};
+
+unsigned int CIPU::CCSCCommand::ConvertMacroblock(const uint8* block, void* output, bool rgb16, bool dither, uint16 TH0, uint16 TH1) const
+{
+	//RGBA32 output is converted in place
+	uint32 pixelsTemp[PIXEL_COUNT];
+	uint32* pixels = rgb16 ? pixelsTemp : reinterpret_cast<uint32*>(output);
+	if(m_fastConversionEnabled)
+	{
+		ConvertBlockFast(block, pixels, TH0, TH1);
+	}
+	else
+	{
+		ConvertBlockReference(block, pixels, TH0, TH1);
+	}
+
+	if(rgb16)
+	{
+		auto pixels16 = reinterpret_cast<uint16*>(output);
+		if(m_fastConversionEnabled)
+		{
+			ConvertToRgb16Fast(pixels16, pixels, dither);
+		}
+		else
+		{
+			ConvertToRgb16Reference(pixels16, pixels, dither);
+		}
+		return PIXEL_COUNT * sizeof(uint16);
+	}
+	else
+	{
+		return PIXEL_COUNT * sizeof(uint32);
+	}
+}
+
+void CIPU::CCSCCommand::GenerateColorOffsets()
+{
+	for(unsigned int i = 0; i < 0x100; i++)
+	{
+		float nC = static_cast<float>(i);
+		float nR = 128.f + 1.402f * (nC - 128);
+		float nB = 128.f + 1.772f * (nC - 128);
+		m_redOffsets[i] = static_cast<int16>(std::floor(nR) - 128);
+		m_blueOffsets[i] = static_cast<int16>(std::floor(nB) - 128);
+		m_greenCbTerms[i] = 0.34414f * (nC - 128);
+		m_greenCrTerms[i] = 0.71414f * (nC - 128);
+	}
+}
+
+//Green depends on both chroma values, its offset is computed for each chroma sample
+int16 CIPU::CCSCCommand::GetGreenOffset(uint8 cb, uint8 cr) const
+{
+	float nG = 128.f - m_greenCbTerms[cb] - m_greenCrTerms[cr];
+	int offset = static_cast<int>(nG);
+	if(static_cast<float>(offset) > nG)
+	{
+		offset--;
+	}
+	return static_cast<int16>(offset - 128);
+}
+
+void CIPU::CCSCCommand::ConvertBlockReference(const uint8* block, uint32* nPixel, uint16 TH0, uint16 TH1) const
+{
+	const uint8* pY = block;
+	const uint8* nBlockCb = block + 0x100;
+	const uint8* nBlockCr = block + 0x140;
+
+	uint32* pPixel = nPixel;
+	const unsigned int* pCbCrMap = m_nCbCrMap;
+
+	uint32 alphaTh0 = (TH0 & 0xFF) | ((TH0 & 0xFF) << 8) | ((TH0 & 0xFF) << 16);
+	uint32 alphaTh1 = (TH1 & 0xFF) | ((TH1 & 0xFF) << 8) | ((TH1 & 0xFF) << 16);
+
+	for(unsigned int i = 0; i < 16; i++)
+	{
+		for(unsigned int j = 0; j < 16; j++)
+		{
+			float nY = pY[j];
+			float nCb = nBlockCb[pCbCrMap[j]];
+			float nCr = nBlockCr[pCbCrMap[j]];
+
+			float nR = nY + 1.402f * (nCr - 128);
+			float nG = nY - 0.34414f * (nCb - 128) - 0.71414f * (nCr - 128);
+			float nB = nY + 1.772f * (nCb - 128);
+
+			if(nR < 0)
+			{
+				nR = 0;
+			}
+			if(nR > 255)
+			{
+				nR = 255;
+			}
+			if(nG < 0)
+			{
+				nG = 0;
+			}
+			if(nG > 255)
+			{
+				nG = 255;
+			}
+			if(nB < 0)
+			{
+				nB = 0;
+			}
+			if(nB > 255)
+			{
+				nB = 255;
+			}
+
+			uint8 a = 0;
+			uint32 rgb = (static_cast<uint8>(nB) << 16) | (static_cast<uint8>(nG) << 8) | (static_cast<uint8>(nR) << 0);
+			if(rgb < alphaTh0)
+			{
+				a = 0;
+			}
+			else if(rgb < alphaTh1)
+			{
+				a = 0x40;
+			}
+			else
+			{
+				a = 0x80;
+			}
+
+			pPixel[j] = (a << 24) | rgb;
+		}
+
+		pY += 0x10;
+		pCbCrMap += 0x10;
+		pPixel += 0x10;
+	}
+}
+
+void CIPU::CCSCCommand::ConvertBlockFast(const uint8* block, uint32* pixels, uint16 TH0, uint16 TH1) const
+{
+	const uint8* blockY = block;
+	const uint8* blockCb = block + 0x100;
+	const uint8* blockCr = block + 0x140;
+
+	//One offset per chroma sample (8x8), each one covers 2x2 pixels
+	alignas(16) int16 offsetsR[0x40];
+	alignas(16) int16 offsetsG[0x40];
+	alignas(16) int16 offsetsB[0x40];
+	for(unsigned int i = 0; i < 0x40; i++)
+	{
+		offsetsR[i] = m_redOffsets[blockCr[i]];
+		offsetsG[i] = GetGreenOffset(blockCb[i], blockCr[i]);
+		offsetsB[i] = m_blueOffsets[blockCb[i]];
+	}
+
+	uint32 alphaTh0 = (TH0 & 0xFF) | ((TH0 & 0xFF) << 8) | ((TH0 & 0xFF) << 16);
+	uint32 alphaTh1 = (TH1 & 0xFF) | ((TH1 & 0xFF) << 8) | ((TH1 & 0xFF) << 16);
+
+#if defined(IPU_CSC_SSE2)
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i th0 = _mm_set1_epi32(alphaTh0);
+	const __m128i th1 = _mm_set1_epi32(alphaTh1);
+	const __m128i alphaOpaque = _mm_set1_epi32(0x80000000);
+	const __m128i alphaFlip = _mm_set1_epi32(0xC0000000);
+
+	for(unsigned int i = 0; i < 16; i++)
+	{
+		unsigned int chromaRow = (i / 2) * 8;
+		__m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(blockY + (i * 0x10)));
+		__m128i yLo = _mm_unpacklo_epi8(y, zero);
+		__m128i yHi = _mm_unpackhi_epi8(y, zero);
+
+		__m128i offsetR = _mm_load_si128(reinterpret_cast<const __m128i*>(offsetsR + chromaRow));
+		__m128i offsetG = _mm_load_si128(reinterpret_cast<const __m128i*>(offsetsG + chromaRow));
+		__m128i offsetB = _mm_load_si128(reinterpret_cast<const __m128i*>(offsetsB + chromaRow));
+
+		//Saturating packs do the clamping
+		__m128i r = _mm_packus_epi16(_mm_add_epi16(yLo, _mm_unpacklo_epi16(offsetR, offsetR)), _mm_add_epi16(yHi, _mm_unpackhi_epi16(offsetR, offsetR)));
+		__m128i g = _mm_packus_epi16(_mm_add_epi16(yLo, _mm_unpacklo_epi16(offsetG, offsetG)), _mm_add_epi16(yHi, _mm_unpackhi_epi16(offsetG, offsetG)));
+		__m128i b = _mm_packus_epi16(_mm_add_epi16(yLo, _mm_unpacklo_epi16(offsetB, offsetB)), _mm_add_epi16(yHi, _mm_unpackhi_epi16(offsetB, offsetB)));
+
+		__m128i rgLo = _mm_unpacklo_epi8(r, g);
+		__m128i rgHi = _mm_unpackhi_epi8(r, g);
+		__m128i bLo = _mm_unpacklo_epi8(b, zero);
+		__m128i bHi = _mm_unpackhi_epi8(b, zero);
+
+		__m128i rgb[4] =
+		    {
+		        _mm_unpacklo_epi16(rgLo, bLo),
+		        _mm_unpackhi_epi16(rgLo, bLo),
+		        _mm_unpacklo_epi16(rgHi, bHi),
+		        _mm_unpackhi_epi16(rgHi, bHi),
+		    };
+
+		for(unsigned int j = 0; j < 4; j++)
+		{
+			//Values fit in 24 bits, signed comparisons are fine
+			//alpha = (rgb < th0) ? 0 : ((rgb < th1) ? 0x40 : 0x80)
+			__m128i belowTh0 = _mm_cmplt_epi32(rgb[j], th0);
+			__m128i belowTh1 = _mm_cmplt_epi32(rgb[j], th1);
+			__m128i alpha = _mm_andnot_si128(belowTh0, _mm_xor_si128(alphaOpaque, _mm_and_si128(belowTh1, alphaFlip)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pixels + (i * 0x10) + (j * 4)), _mm_or_si128(rgb[j], alpha));
+		}
+	}
+#elif defined(IPU_CSC_NEON)
+	const uint32x4_t th0 = vdupq_n_u32(alphaTh0);
+	const uint32x4_t th1 = vdupq_n_u32(alphaTh1);
+	const uint32x4_t alphaOpaque = vdupq_n_u32(0x80000000);
+	const uint32x4_t alphaFlip = vdupq_n_u32(0xC0000000);
+
+	for(unsigned int i = 0; i < 16; i++)
+	{
+		unsigned int chromaRow = (i / 2) * 8;
+		uint8x16_t y = vld1q_u8(blockY + (i * 0x10));
+		int16x8_t yLo = vreinterpretq_s16_u16(vmovl_u8(vget_low_u8(y)));
+		int16x8_t yHi = vreinterpretq_s16_u16(vmovl_u8(vget_high_u8(y)));
+
+		int16x8x2_t offsetR = vzipq_s16(vld1q_s16(offsetsR + chromaRow), vld1q_s16(offsetsR + chromaRow));
+		int16x8x2_t offsetG = vzipq_s16(vld1q_s16(offsetsG + chromaRow), vld1q_s16(offsetsG + chromaRow));
+		int16x8x2_t offsetB = vzipq_s16(vld1q_s16(offsetsB + chromaRow), vld1q_s16(offsetsB + chromaRow));
+
+		//Saturating narrows do the clamping
+		uint8x16x4_t rgba;
+		rgba.val[0] = vcombine_u8(vqmovun_s16(vaddq_s16(yLo, offsetR.val[0])), vqmovun_s16(vaddq_s16(yHi, offsetR.val[1])));
+		rgba.val[1] = vcombine_u8(vqmovun_s16(vaddq_s16(yLo, offsetG.val[0])), vqmovun_s16(vaddq_s16(yHi, offsetG.val[1])));
+		rgba.val[2] = vcombine_u8(vqmovun_s16(vaddq_s16(yLo, offsetB.val[0])), vqmovun_s16(vaddq_s16(yHi, offsetB.val[1])));
+		rgba.val[3] = vdupq_n_u8(0);
+
+		uint32* row = pixels + (i * 0x10);
+		vst4q_u8(reinterpret_cast<uint8*>(row), rgba);
+
+		for(unsigned int j = 0; j < 4; j++)
+		{
+			//alpha = (rgb < th0) ? 0 : ((rgb < th1) ? 0x40 : 0x80)
+			uint32x4_t rgb = vld1q_u32(row + (j * 4));
+			uint32x4_t belowTh0 = vcltq_u32(rgb, th0);
+			uint32x4_t belowTh1 = vcltq_u32(rgb, th1);
+			uint32x4_t alpha = vbicq_u32(veorq_u32(alphaOpaque, vandq_u32(belowTh1, alphaFlip)), belowTh0);
+			vst1q_u32(row + (j * 4), vorrq_u32(rgb, alpha));
+		}
+	}
+#else
+	for(unsigned int i = 0; i < 16; i++)
+	{
+		for(unsigned int j = 0; j < 16; j++)
+		{
+			unsigned int chromaIndex = ((i / 2) * 8) + (j / 2);
+			int y = blockY[(i * 0x10) + j];
+			uint32 r = std::min(std::max(y + offsetsR[chromaIndex], 0), 255);
+			uint32 g = std::min(std::max(y + offsetsG[chromaIndex], 0), 255);
+			uint32 b = std::min(std::max(y + offsetsB[chromaIndex], 0), 255);
+			uint32 rgb = (b << 16) | (g << 8) | r;
+			uint32 a = (rgb < alphaTh0) ? 0 : ((rgb < alphaTh1) ? 0x40 : 0x80);
+			pixels[(i * 0x10) + j] = (a << 24) | rgb;
+		}
+	}
+#endif
+}
+
+//RGB16 pixels are made from the RGBA32 ones, the alpha bit is set for pixels between TH0 and TH1
+void CIPU::CCSCCommand::ConvertToRgb16Reference(uint16* dst, const uint32* src, bool dither)
+{
+	for(unsigned int i = 0; i < 16; i++)
+	{
+		for(unsigned int j = 0; j < 16; j++)
+		{
+			uint32 pixel = src[(i * 0x10) + j];
+			int r = (pixel >> 0) & 0xFF;
+			int g = (pixel >> 8) & 0xFF;
+			int b = (pixel >> 16) & 0xFF;
+			uint32 a = (pixel >> 24);
+			if(dither)
+			{
+				int offset = g_ditherMatrix[i & 3][j & 3];
+				r = std::min(std::max(r + offset, 0), 255);
+				g = std::min(std::max(g + offset, 0), 255);
+				b = std::min(std::max(b + offset, 0), 255);
+			}
+			dst[(i * 0x10) + j] = static_cast<uint16>((r >> 3) | ((g >> 3) << 5) | ((b >> 3) << 10) | ((a == 0x40) ? 0x8000 : 0));
+		}
+	}
+}
+
+void CIPU::CCSCCommand::ConvertToRgb16Fast(uint16* dst, const uint32* src, bool dither)
+{
+#if defined(IPU_CSC_SSE2) || defined(IPU_CSC_NEON)
+	//Dithering is done with saturated byte additions and subtractions, one row of the matrix
+	//covers 4 pixels. Alpha bytes are left untouched.
+	alignas(16) uint8 ditherAdd[4][16] = {};
+	alignas(16) uint8 ditherSub[4][16] = {};
+	if(dither)
+	{
+		for(unsigned int i = 0; i < 4; i++)
+		{
+			for(unsigned int j = 0; j < 16; j++)
+			{
+				if((j & 3) == 3) continue;
+				int offset = g_ditherMatrix[i][j / 4];
+				ditherAdd[i][j] = static_cast<uint8>(std::max(offset, 0));
+				ditherSub[i][j] = static_cast<uint8>(std::max(-offset, 0));
+			}
+		}
+	}
+#endif
+
+#if defined(IPU_CSC_SSE2)
+	const __m128i maskR = _mm_set1_epi32(0x001F);
+	const __m128i maskG = _mm_set1_epi32(0x03E0);
+	const __m128i maskB = _mm_set1_epi32(0x7C00);
+	const __m128i alphaHalf = _mm_set1_epi32(0x40);
+	const __m128i alphaBit = _mm_set1_epi32(0x8000);
+
+	for(unsigned int i = 0; i < 16; i++)
+	{
+		__m128i add = _mm_load_si128(reinterpret_cast<const __m128i*>(ditherAdd[i & 3]));
+		__m128i sub = _mm_load_si128(reinterpret_cast<const __m128i*>(ditherSub[i & 3]));
+		for(unsigned int j = 0; j < 16; j += 8)
+		{
+			__m128i result[2];
+			for(unsigned int k = 0; k < 2; k++)
+			{
+				__m128i pixel = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + (i * 0x10) + j + (k * 4)));
+				__m128i alpha = _mm_and_si128(_mm_cmpeq_epi32(_mm_srli_epi32(pixel, 24), alphaHalf), alphaBit);
+				pixel = _mm_subs_epu8(_mm_adds_epu8(pixel, add), sub);
+				__m128i color = _mm_or_si128(
+				    _mm_and_si128(_mm_srli_epi32(pixel, 3), maskR),
+				    _mm_or_si128(_mm_and_si128(_mm_srli_epi32(pixel, 6), maskG), _mm_and_si128(_mm_srli_epi32(pixel, 9), maskB)));
+				//Sign extend from 16 bits so that the signed pack keeps the values as is
+				result[k] = _mm_srai_epi32(_mm_slli_epi32(_mm_or_si128(color, alpha), 16), 16);
+			}
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + (i * 0x10) + j), _mm_packs_epi32(result[0], result[1]));
+		}
+	}
+#elif defined(IPU_CSC_NEON)
+	const uint32x4_t maskR = vdupq_n_u32(0x001F);
+	const uint32x4_t maskG = vdupq_n_u32(0x03E0);
+	const uint32x4_t maskB = vdupq_n_u32(0x7C00);
+	const uint32x4_t alphaHalf = vdupq_n_u32(0x40);
+	const uint32x4_t alphaBit = vdupq_n_u32(0x8000);
+
+	for(unsigned int i = 0; i < 16; i++)
+	{
+		uint8x16_t add = vld1q_u8(ditherAdd[i & 3]);
+		uint8x16_t sub = vld1q_u8(ditherSub[i & 3]);
+		for(unsigned int j = 0; j < 16; j += 4)
+		{
+			uint32x4_t pixel = vld1q_u32(src + (i * 0x10) + j);
+			uint32x4_t alpha = vandq_u32(vceqq_u32(vshrq_n_u32(pixel, 24), alphaHalf), alphaBit);
+			pixel = vreinterpretq_u32_u8(vqsubq_u8(vqaddq_u8(vreinterpretq_u8_u32(pixel), add), sub));
+			uint32x4_t color = vorrq_u32(
+			    vandq_u32(vshrq_n_u32(pixel, 3), maskR),
+			    vorrq_u32(vandq_u32(vshrq_n_u32(pixel, 6), maskG), vandq_u32(vshrq_n_u32(pixel, 9), maskB)));
+			vst1_u16(dst + (i * 0x10) + j, vmovn_u32(vorrq_u32(color, alpha)));
+		}
+	}
+#else
+	ConvertToRgb16Reference(dst, src, dither);
+#endif
+}
@@ -0,0 +1,331 @@
+#include <algorithm>
+#include <cstdint>
+#include "IPU_FastIdct.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define IPU_IDCT_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define IPU_IDCT_NEON
+#endif
+
+using namespace IPU;
+
+//Wk = round(cos(k * pi / 16) * sqrt(2) * 2^14)
+//Rows are scaled up by the first pass to keep precision in 16 bits, the second pass removes the scale.
+//Dequantised coefficients are saturated to 12 bits and the first pass saturates its results to 16 bits,
+//which keeps the even and odd parts of each pass within 32 bits.
+
+enum
+{
+	W1 = 22725,
+	W2 = 21407,
+	W3 = 19266,
+	W4 = 16384,
+	W5 = 12873,
+	W6 = 8867,
+	W7 = 4520,
+};
+
+enum
+{
+	ROW_SHIFT = 11,
+	COL_SHIFT = 20,
+};
+
+enum
+{
+	OUTPUT_MIN = -256,
+	OUTPUT_MAX = 255,
+};
+
+//Final sums can overflow with garbage input, they wrap around like the SIMD additions do
+static inline int32 AddWrap(int32 a, int32 b)
+{
+	return static_cast<int32>(static_cast<uint32>(a) + static_cast<uint32>(b));
+}
+
+static inline int32 SubWrap(int32 a, int32 b)
+{
+	return static_cast<int32>(static_cast<uint32>(a) - static_cast<uint32>(b));
+}
+
+//Computes the 8 unshifted outputs of a 1D IDCT
+static void Transform1DGeneric(const int32* x, int32* y, int32 rounding)
+{
+	int32 a0 = (W4 * x[0]) + (W4 * x[4]) + (W2 * x[2]) + (W6 * x[6]) + rounding;
+	int32 a1 = (W4 * x[0]) - (W4 * x[4]) + (W6 * x[2]) - (W2 * x[6]) + rounding;
+	int32 a2 = (W4 * x[0]) - (W4 * x[4]) - (W6 * x[2]) + (W2 * x[6]) + rounding;
+	int32 a3 = (W4 * x[0]) + (W4 * x[4]) - (W2 * x[2]) - (W6 * x[6]) + rounding;
+
+	int32 b0 = (W1 * x[1]) + (W3 * x[3]) + (W5 * x[5]) + (W7 * x[7]);
+	int32 b1 = (W3 * x[1]) - (W7 * x[3]) - (W1 * x[5]) - (W5 * x[7]);
+	int32 b2 = (W5 * x[1]) - (W1 * x[3]) + (W7 * x[5]) + (W3 * x[7]);
+	int32 b3 = (W7 * x[1]) - (W5 * x[3]) + (W3 * x[5]) - (W1 * x[7]);
+
+	y[0] = AddWrap(a0, b0);
+	y[1] = AddWrap(a1, b1);
+	y[2] = AddWrap(a2, b2);
+	y[3] = AddWrap(a3, b3);
+	y[4] = SubWrap(a3, b3);
+	y[5] = SubWrap(a2, b2);
+	y[6] = SubWrap(a1, b1);
+	y[7] = SubWrap(a0, b0);
+}
+
+void CFastIdct::TransformGeneric(const int16* input, int16* output)
+{
+	int16 temp[BLOCK_SIZE];
+	int32 x[8];
+	int32 y[8];
+
+	for(unsigned int row = 0; row < 8; row++)
+	{
+		for(unsigned int i = 0; i < 8; i++)
+		{
+			x[i] = input[(row * 8) + i];
+		}
+		Transform1DGeneric(x, y, 1 << (ROW_SHIFT - 1));
+		for(unsigned int i = 0; i < 8; i++)
+		{
+			temp[(row * 8) + i] = static_cast<int16>(std::min<int32>(std::max<int32>(y[i] >> ROW_SHIFT, INT16_MIN), INT16_MAX));
+		}
+	}
+
+	for(unsigned int col = 0; col < 8; col++)
+	{
+		for(unsigned int i = 0; i < 8; i++)
+		{
+			x[i] = temp[(i * 8) + col];
+		}
+		Transform1DGeneric(x, y, 1 << (COL_SHIFT - 1));
+		for(unsigned int i = 0; i < 8; i++)
+		{
+			output[(i * 8) + col] = static_cast<int16>(std::min<int32>(std::max<int32>(y[i] >> COL_SHIFT, OUTPUT_MIN), OUTPUT_MAX));
+		}
+	}
+}
+
+#if defined(IPU_IDCT_SSE2)
+
+static inline __m128i MakePair(int16 low, int16 high)
+{
+	return _mm_set1_epi32((static_cast<uint16>(high) << 16) | static_cast<uint16>(low));
+}
+
+static inline void Transpose(__m128i* r)
+{
+	__m128i a0 = _mm_unpacklo_epi16(r[0], r[1]);
+	__m128i a1 = _mm_unpackhi_epi16(r[0], r[1]);
+	__m128i a2 = _mm_unpacklo_epi16(r[2], r[3]);
+	__m128i a3 = _mm_unpackhi_epi16(r[2], r[3]);
+	__m128i a4 = _mm_unpacklo_epi16(r[4], r[5]);
+	__m128i a5 = _mm_unpackhi_epi16(r[4], r[5]);
+	__m128i a6 = _mm_unpacklo_epi16(r[6], r[7]);
+	__m128i a7 = _mm_unpackhi_epi16(r[6], r[7]);
+
+	__m128i b0 = _mm_unpacklo_epi32(a0, a2);
+	__m128i b1 = _mm_unpackhi_epi32(a0, a2);
+	__m128i b2 = _mm_unpacklo_epi32(a1, a3);
+	__m128i b3 = _mm_unpackhi_epi32(a1, a3);
+	__m128i b4 = _mm_unpacklo_epi32(a4, a6);
+	__m128i b5 = _mm_unpackhi_epi32(a4, a6);
+	__m128i b6 = _mm_unpacklo_epi32(a5, a7);
+	__m128i b7 = _mm_unpackhi_epi32(a5, a7);
+
+	r[0] = _mm_unpacklo_epi64(b0, b4);
+	r[1] = _mm_unpackhi_epi64(b0, b4);
+	r[2] = _mm_unpacklo_epi64(b1, b5);
+	r[3] = _mm_unpackhi_epi64(b1, b5);
+	r[4] = _mm_unpacklo_epi64(b2, b6);
+	r[5] = _mm_unpackhi_epi64(b2, b6);
+	r[6] = _mm_unpacklo_epi64(b3, b7);
+	r[7] = _mm_unpackhi_epi64(b3, b7);
+}
+
+//Each sum of products in the generic version is done with pmaddwd on interleaved inputs
+static inline void Transform1DHalf(__m128i x04, __m128i x26, __m128i x13, __m128i x57, __m128i rounding, __m128i* y)
+{
+	__m128i e0 = _mm_madd_epi16(x04, MakePair(W4, W4));
+	__m128i e1 = _mm_madd_epi16(x04, MakePair(W4, -W4));
+
+	__m128i a0 = _mm_add_epi32(_mm_add_epi32(e0, _mm_madd_epi16(x26, MakePair(W2, W6))), rounding);
+	__m128i a1 = _mm_add_epi32(_mm_add_epi32(e1, _mm_madd_epi16(x26, MakePair(W6, -W2))), rounding);
+	__m128i a2 = _mm_add_epi32(_mm_add_epi32(e1, _mm_madd_epi16(x26, MakePair(-W6, W2))), rounding);
+	__m128i a3 = _mm_add_epi32(_mm_add_epi32(e0, _mm_madd_epi16(x26, MakePair(-W2, -W6))), rounding);
+
+	__m128i b0 = _mm_add_epi32(_mm_madd_epi16(x13, MakePair(W1, W3)), _mm_madd_epi16(x57, MakePair(W5, W7)));
+	__m128i b1 = _mm_add_epi32(_mm_madd_epi16(x13, MakePair(W3, -W7)), _mm_madd_epi16(x57, MakePair(-W1, -W5)));
+	__m128i b2 = _mm_add_epi32(_mm_madd_epi16(x13, MakePair(W5, -W1)), _mm_madd_epi16(x57, MakePair(W7, W3)));
+	__m128i b3 = _mm_add_epi32(_mm_madd_epi16(x13, MakePair(W7, -W5)), _mm_madd_epi16(x57, MakePair(W3, -W1)));
+
+	y[0] = _mm_add_epi32(a0, b0);
+	y[1] = _mm_add_epi32(a1, b1);
+	y[2] = _mm_add_epi32(a2, b2);
+	y[3] = _mm_add_epi32(a3, b3);
+	y[4] = _mm_sub_epi32(a3, b3);
+	y[5] = _mm_sub_epi32(a2, b2);
+	y[6] = _mm_sub_epi32(a1, b1);
+	y[7] = _mm_sub_epi32(a0, b0);
+}
+
+//Transforms the 8 lanes independently, x[i] holds the element i of each lane
+template <int SHIFT>
+static inline void Transform1D(__m128i* x)
+{
+	const __m128i rounding = _mm_set1_epi32(1 << (SHIFT - 1));
+
+	__m128i yLo[8];
+	__m128i yHi[8];
+	Transform1DHalf(_mm_unpacklo_epi16(x[0], x[4]), _mm_unpacklo_epi16(x[2], x[6]),
+	                _mm_unpacklo_epi16(x[1], x[3]), _mm_unpacklo_epi16(x[5], x[7]), rounding, yLo);
+	Transform1DHalf(_mm_unpackhi_epi16(x[0], x[4]), _mm_unpackhi_epi16(x[2], x[6]),
+	                _mm_unpackhi_epi16(x[1], x[3]), _mm_unpackhi_epi16(x[5], x[7]), rounding, yHi);
+
+	for(unsigned int i = 0; i < 8; i++)
+	{
+		x[i] = _mm_packs_epi32(_mm_srai_epi32(yLo[i], SHIFT), _mm_srai_epi32(yHi[i], SHIFT));
+	}
+}
+
+void CFastIdct::Transform(const int16* input, int16* output)
+{
+	const __m128i outputMin = _mm_set1_epi16(OUTPUT_MIN);
+	const __m128i outputMax = _mm_set1_epi16(OUTPUT_MAX);
+
+	__m128i r[8];
+	for(unsigned int i = 0; i < 8; i++)
+	{
+		r[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + (i * 8)));
+	}
+
+	Transpose(r);
+	Transform1D<ROW_SHIFT>(r);
+	Transpose(r);
+	Transform1D<COL_SHIFT>(r);
+
+	for(unsigned int i = 0; i < 8; i++)
+	{
+		__m128i result = _mm_min_epi16(_mm_max_epi16(r[i], outputMin), outputMax);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(output + (i * 8)), result);
+	}
+}
+
+#elif defined(IPU_IDCT_NEON)
+
+static inline int16x8_t Combine(int32x4_t low, int32x4_t high, bool upperHalves)
+{
+	if(upperHalves)
+	{
+		return vreinterpretq_s16_s32(vcombine_s32(vget_high_s32(low), vget_high_s32(high)));
+	}
+	else
+	{
+		return vreinterpretq_s16_s32(vcombine_s32(vget_low_s32(low), vget_low_s32(high)));
+	}
+}
+
+static inline void Transpose(int16x8_t* r)
+{
+	int16x8x2_t t0 = vtrnq_s16(r[0], r[1]);
+	int16x8x2_t t1 = vtrnq_s16(r[2], r[3]);
+	int16x8x2_t t2 = vtrnq_s16(r[4], r[5]);
+	int16x8x2_t t3 = vtrnq_s16(r[6], r[7]);
+
+	//Columns 0 & 4, 2 & 6 (u0, u2) and 1 & 5, 3 & 7 (u1, u3)
+	int32x4x2_t u0 = vtrnq_s32(vreinterpretq_s32_s16(t0.val[0]), vreinterpretq_s32_s16(t1.val[0]));
+	int32x4x2_t u1 = vtrnq_s32(vreinterpretq_s32_s16(t0.val[1]), vreinterpretq_s32_s16(t1.val[1]));
+	int32x4x2_t u2 = vtrnq_s32(vreinterpretq_s32_s16(t2.val[0]), vreinterpretq_s32_s16(t3.val[0]));
+	int32x4x2_t u3 = vtrnq_s32(vreinterpretq_s32_s16(t2.val[1]), vreinterpretq_s32_s16(t3.val[1]));
+
+	r[0] = Combine(u0.val[0], u2.val[0], false);
+	r[1] = Combine(u1.val[0], u3.val[0], false);
+	r[2] = Combine(u0.val[1], u2.val[1], false);
+	r[3] = Combine(u1.val[1], u3.val[1], false);
+	r[4] = Combine(u0.val[0], u2.val[0], true);
+	r[5] = Combine(u1.val[0], u3.val[0], true);
+	r[6] = Combine(u0.val[1], u2.val[1], true);
+	r[7] = Combine(u1.val[1], u3.val[1], true);
+}
+
+static inline void Transform1DHalf(const int16x4_t* x, int32x4_t rounding, int32x4_t* y)
+{
+	int32x4_t e0 = vmlal_n_s16(vmull_n_s16(x[0], W4), x[4], W4);
+	int32x4_t e1 = vmlsl_n_s16(vmull_n_s16(x[0], W4), x[4], W4);
+
+	int32x4_t a0 = vaddq_s32(vmlal_n_s16(vmlal_n_s16(e0, x[2], W2), x[6], W6), rounding);
+	int32x4_t a1 = vaddq_s32(vmlsl_n_s16(vmlal_n_s16(e1, x[2], W6), x[6], W2), rounding);
+	int32x4_t a2 = vaddq_s32(vmlal_n_s16(vmlsl_n_s16(e1, x[2], W6), x[6], W2), rounding);
+	int32x4_t a3 = vaddq_s32(vmlsl_n_s16(vmlsl_n_s16(e0, x[2], W2), x[6], W6), rounding);
+
+	int32x4_t b0 = vmlal_n_s16(vmlal_n_s16(vmlal_n_s16(vmull_n_s16(x[1], W1), x[3], W3), x[5], W5), x[7], W7);
+	int32x4_t b1 = vmlsl_n_s16(vmlsl_n_s16(vmlsl_n_s16(vmull_n_s16(x[1], W3), x[3], W7), x[5], W1), x[7], W5);
+	int32x4_t b2 = vmlal_n_s16(vmlal_n_s16(vmlsl_n_s16(vmull_n_s16(x[1], W5), x[3], W1), x[5], W7), x[7], W3);
+	int32x4_t b3 = vmlsl_n_s16(vmlal_n_s16(vmlsl_n_s16(vmull_n_s16(x[1], W7), x[3], W5), x[5], W3), x[7], W1);
+
+	y[0] = vaddq_s32(a0, b0);
+	y[1] = vaddq_s32(a1, b1);
+	y[2] = vaddq_s32(a2, b2);
+	y[3] = vaddq_s32(a3, b3);
+	y[4] = vsubq_s32(a3, b3);
+	y[5] = vsubq_s32(a2, b2);
+	y[6] = vsubq_s32(a1, b1);
+	y[7] = vsubq_s32(a0, b0);
+}
+
+//Transforms the 8 lanes independently, x[i] holds the element i of each lane
+template <int SHIFT>
+static inline void Transform1D(int16x8_t* x)
+{
+	const int32x4_t rounding = vdupq_n_s32(1 << (SHIFT - 1));
+
+	int16x4_t xLo[8];
+	int16x4_t xHi[8];
+	for(unsigned int i = 0; i < 8; i++)
+	{
+		xLo[i] = vget_low_s16(x[i]);
+		xHi[i] = vget_high_s16(x[i]);
+	}
+
+	int32x4_t yLo[8];
+	int32x4_t yHi[8];
+	Transform1DHalf(xLo, rounding, yLo);
+	Transform1DHalf(xHi, rounding, yHi);
+
+	for(unsigned int i = 0; i < 8; i++)
+	{
+		x[i] = vcombine_s16(vqmovn_s32(vshrq_n_s32(yLo[i], SHIFT)), vqmovn_s32(vshrq_n_s32(yHi[i], SHIFT)));
+	}
+}
+
+void CFastIdct::Transform(const int16* input, int16* output)
+{
+	const int16x8_t outputMin = vdupq_n_s16(OUTPUT_MIN);
+	const int16x8_t outputMax = vdupq_n_s16(OUTPUT_MAX);
+
+	int16x8_t r[8];
+	for(unsigned int i = 0; i < 8; i++)
+	{
+		r[i] = vld1q_s16(input + (i * 8));
+	}
+
+	Transpose(r);
+	Transform1D<ROW_SHIFT>(r);
+	Transpose(r);
+	Transform1D<COL_SHIFT>(r);
+
+	for(unsigned int i = 0; i < 8; i++)
+	{
+		vst1q_s16(output + (i * 8), vminq_s16(vmaxq_s16(r[i], outputMin), outputMax));
+	}
+}
+
+#else
+
+void CFastIdct::Transform(const int16* input, int16* output)
+{
+	TransformGeneric(input, output);
+}
+
+#endif
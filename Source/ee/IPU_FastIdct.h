@@ -0,0 +1,22 @@
+#pragma once
+
+#include "Types.h"
+
+namespace IPU
+{
+	//Fixed-point IDCT (separable, 16-bit coefficients with 32-bit accumulators).
+	//Results are not bit exact with the IEEE 1180 reference implementation, but stay within
+	//the accuracy bounds required by the standard. Output is clamped to [-256, 255].
+	class CFastIdct
+	{
+	public:
+		enum
+		{
+			BLOCK_SIZE = 0x40,
+		};
+
+		//Uses the SIMD kernels when available, the results are the same as TransformGeneric
+		static void Transform(const int16*, int16*);
+		static void TransformGeneric(const int16*, int16*);
+	};
+}
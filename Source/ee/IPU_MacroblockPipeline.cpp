@@ -0,0 +1,175 @@
+#include <algorithm>
+#include <cassert>
+#include "IPU_MacroblockPipeline.h"
+#include "../Log.h"
+
+#define LOG_NAME ("ee_ipu_pipeline")
+
+CIPU::CMacroblockPipeline::CMacroblockPipeline(unsigned int threadCount, const CCSCCommand& cscCommand)
+    : m_cscCommand(cscCommand)
+{
+	assert(threadCount != 0);
+	for(unsigned int i = 0; i < threadCount; i++)
+	{
+		m_threads.emplace_back([this]() { ThreadProc(); });
+	}
+}
+
+CIPU::CMacroblockPipeline::~CMacroblockPipeline()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_terminate = true;
+	}
+	m_requestCondition.notify_all();
+	for(auto& thread : m_threads)
+	{
+		thread.join();
+	}
+
+	auto drainTime = std::chrono::duration_cast<std::chrono::microseconds>(m_stats.drainTime);
+	CLog::GetInstance().Print(LOG_NAME, "%d macroblocks, pipeline full %d times, result not ready %d times, %d drains (%0.2f ms).\r\n",
+	                          m_stats.macroblockCount, m_stats.fullCount, m_stats.notReadyCount, m_stats.drainCount, static_cast<double>(drainTime.count()) / 1000.0);
+}
+
+bool CIPU::CMacroblockPipeline::IsFull()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	bool full = (m_submitIndex - m_resultIndex) == MAX_PENDING;
+	if(full)
+	{
+		m_stats.fullCount++;
+	}
+	return full;
+}
+
+bool CIPU::CMacroblockPipeline::IsEmpty()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_submitIndex == m_resultIndex;
+}
+
+void CIPU::CMacroblockPipeline::Submit(const JOB& job)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		assert((m_submitIndex - m_resultIndex) < MAX_PENDING);
+		auto& slot = m_slots[m_submitIndex % MAX_PENDING];
+		slot.job = job;
+		slot.done = false;
+		m_submitIndex++;
+		m_stats.macroblockCount++;
+	}
+	m_requestCondition.notify_one();
+}
+
+bool CIPU::CMacroblockPipeline::TakeResult(COUTFIFO* outFifo)
+{
+	SLOT* slot = nullptr;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if(m_resultIndex == m_submitIndex)
+		{
+			return false;
+		}
+		slot = &m_slots[m_resultIndex % MAX_PENDING];
+		if(!slot->done)
+		{
+			m_stats.notReadyCount++;
+			return false;
+		}
+	}
+
+	if(!outFifo->CanWrite(slot->outputSize))
+	{
+		return false;
+	}
+
+	//The slot can't be reused before the result index moves past it
+	outFifo->Write(slot->output, slot->outputSize);
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_resultIndex++;
+	return true;
+}
+
+void CIPU::CMacroblockPipeline::Drain(COUTFIFO* outFifo)
+{
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		WaitAllDone(lock);
+	}
+	while(TakeResult(outFifo))
+	{
+	}
+	//The OUT FIFO has room for more macroblocks than can be in flight
+	assert(IsEmpty());
+}
+
+void CIPU::CMacroblockPipeline::Discard()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	WaitAllDone(lock);
+	m_resultIndex = m_submitIndex;
+}
+
+void CIPU::CMacroblockPipeline::WaitAllDone(std::unique_lock<std::mutex>& lock)
+{
+	m_stats.drainCount++;
+	auto drainStart = std::chrono::steady_clock::now();
+	m_doneCondition.wait(lock, [this]() { return AreAllDone(); });
+	m_stats.drainTime += std::chrono::steady_clock::now() - drainStart;
+}
+
+bool CIPU::CMacroblockPipeline::AreAllDone() const
+{
+	for(uint32 i = m_resultIndex; i != m_submitIndex; i++)
+	{
+		if(!m_slots[i % MAX_PENDING].done) return false;
+	}
+	return true;
+}
+
+void CIPU::CMacroblockPipeline::ThreadProc()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while(true)
+	{
+		m_requestCondition.wait(lock, [this]() { return (m_decodeIndex != m_submitIndex) || m_terminate; });
+		if(m_terminate) break;
+		auto& slot = m_slots[m_decodeIndex % MAX_PENDING];
+		m_decodeIndex++;
+		lock.unlock();
+		DecodeJob(slot);
+		lock.lock();
+		slot.done = true;
+		m_doneCondition.notify_one();
+	}
+}
+
+void CIPU::CMacroblockPipeline::DecodeJob(SLOT& slot) const
+{
+	auto& job = slot.job;
+	DecodeMacroblock(job.macroblock);
+
+	if(job.outputFormat == OUTPUT_FORMAT_RAW16)
+	{
+		static_assert((MACROBLOCK::RAW16_SIZE * sizeof(int16)) <= sizeof(slot.output), "Output buffer too small");
+		WriteRaw16Macroblock(job.macroblock, reinterpret_cast<int16*>(slot.output));
+		slot.outputSize = MACROBLOCK::RAW16_SIZE * sizeof(int16);
+	}
+	else
+	{
+		int16 raw16[MACROBLOCK::RAW16_SIZE];
+		WriteRaw16Macroblock(job.macroblock, raw16);
+
+		//Same as IDEC's RAW16 to RAW8 conversion
+		uint8 raw8[MACROBLOCK::RAW16_SIZE];
+		for(unsigned int i = 0; i < MACROBLOCK::RAW16_SIZE; i++)
+		{
+			raw8[i] = static_cast<uint8>(std::min<int16>(std::max<int16>(raw16[i], 0), 255));
+		}
+		bool rgb16 = (job.outputFormat == OUTPUT_FORMAT_RGB16);
+		slot.outputSize = m_cscCommand.ConvertMacroblock(raw8, slot.output, rgb16, job.dither, job.TH0, job.TH1);
+	}
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "IPU.h"
+
+//Decodes macroblocks parsed by BDEC and IDEC (dequantisation, IDCT and CSC) on worker threads.
+//Macroblocks are submitted in bitstream order by the emulation thread and their results are
+//taken back in the same order, so the output FIFO sees the same data as with the serial decoder.
+class CIPU::CMacroblockPipeline
+{
+public:
+	enum OUTPUT_FORMAT
+	{
+		OUTPUT_FORMAT_RAW16,
+		OUTPUT_FORMAT_RGBA32,
+		OUTPUT_FORMAT_RGB16,
+	};
+
+	struct JOB
+	{
+		MACROBLOCK macroblock;
+		OUTPUT_FORMAT outputFormat = OUTPUT_FORMAT_RAW16;
+		bool dither = false;
+		uint16 TH0 = 0;
+		uint16 TH1 = 0;
+	};
+
+	struct STATS
+	{
+		uint32 macroblockCount = 0;
+		uint32 fullCount = 0;
+		uint32 notReadyCount = 0;
+		uint32 drainCount = 0;
+		std::chrono::nanoseconds drainTime = std::chrono::nanoseconds::zero();
+	};
+
+	CMacroblockPipeline(unsigned int, const CCSCCommand&);
+	virtual ~CMacroblockPipeline();
+
+	bool IsFull();
+	bool IsEmpty();
+	void Submit(const JOB&);
+
+	//Writes the result of the oldest macroblock if it's ready, returns false otherwise
+	bool TakeResult(COUTFIFO*);
+
+	//Waits for all macroblocks to be decoded and writes their results
+	void Drain(COUTFIFO*);
+
+	//Waits for all macroblocks to be decoded and drops their results
+	void Discard();
+
+private:
+	enum
+	{
+		MAX_PENDING = 16,
+	};
+	static_assert(MAX_PENDING < COUTFIFO::SLAB_COUNT, "Drain needs room for every pending macroblock");
+
+	struct SLOT
+	{
+		JOB job;
+		alignas(16) uint8 output[CCSCCommand::OUTPUT_SIZE_MAX];
+		unsigned int outputSize = 0;
+		bool done = false;
+	};
+
+	void ThreadProc();
+	void DecodeJob(SLOT&) const;
+	void WaitAllDone(std::unique_lock<std::mutex>&);
+	bool AreAllDone() const;
+
+	const CCSCCommand& m_cscCommand;
+
+	std::vector<std::thread> m_threads;
+	std::mutex m_mutex;
+	std::condition_variable m_requestCondition;
+	std::condition_variable m_doneCondition;
+	bool m_terminate = false;
+
+	//Monotonic counters, a macroblock's slot is its index modulo MAX_PENDING
+	uint32 m_submitIndex = 0;
+	uint32 m_decodeIndex = 0;
+	uint32 m_resultIndex = 0;
+	SLOT m_slots[MAX_PENDING];
+
+	STATS m_stats;
+};
@@ -28,6 +28,11 @@ void CMA_VU::SetRelativePipeTime(uint32 relativePipeTime)
 	m_Upper.SetRelativePipeTime(relativePipeTime);
 }
 
+void CMA_VU::SetMacFlagsUnused(bool macFlagsUnused)
+{
+	m_Upper.SetMacFlagsUnused(macFlagsUnused);
+}
+
 void CMA_VU::SetupReflectionTables()
 {
 	m_Lower.SetupReflectionTables();
@@ -21,6 +21,9 @@ public:
 
 	void SetRelativePipeTime(uint32);
 
+	//Set by the block compiler when the MAC flags written by the next upper instruction are never observed
+	void SetMacFlagsUnused(bool);
+
 private:
 	void SetupReflectionTables();
 
@@ -38,6 +41,7 @@ private:
 		uint32 GetInstructionEffectiveAddress(CMIPS*, uint32, uint32);
 
 		void SetRelativePipeTime(uint32);
+		void SetMacFlagsUnused(bool);
 
 	private:
 		typedef void (CUpper::*InstructionFuncConstant)();
@@ -54,6 +58,7 @@ private:
 		uint8 m_nBc;
 		uint8 m_nDest;
 		uint32 m_relativePipeTime;
+		bool m_macFlagsUnused;
 
 		static void ReflOpFtFs(MIPSReflection::INSTRUCTION*, CMIPS*, uint32, uint32, char*, unsigned int);
 
@@ -254,6 +259,8 @@ private:
 		static void ReflOpAffWrItRdFs(VUShared::VUINSTRUCTION*, CMIPS*, uint32, uint32, VUShared::OPERANDSET&);
 		static void ReflOpAffWrItRdIs(VUShared::VUINSTRUCTION*, CMIPS*, uint32, uint32, VUShared::OPERANDSET&);
 		static void ReflOpAffWrItBvRdIs(VUShared::VUINSTRUCTION*, CMIPS*, uint32, uint32, VUShared::OPERANDSET&);
+		static void ReflOpAffWrItBvRdMac(VUShared::VUINSTRUCTION*, CMIPS*, uint32, uint32, VUShared::OPERANDSET&);
+		static void ReflOpAffWrItBvRdIsMac(VUShared::VUINSTRUCTION*, CMIPS*, uint32, uint32, VUShared::OPERANDSET&);
 		static void ReflOpAffWrItRdItFs(VUShared::VUINSTRUCTION*, CMIPS*, uint32, uint32, VUShared::OPERANDSET&);
 		static void ReflOpAffWrPRdFs(VUShared::VUINSTRUCTION*, CMIPS*, uint32, uint32, VUShared::OPERANDSET&);
 		static void ReflOpAffWrVi1Bv(VUShared::VUINSTRUCTION*, CMIPS*, uint32, uint32, VUShared::OPERANDSET&);
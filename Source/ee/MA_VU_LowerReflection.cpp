@@ -312,6 +312,18 @@ void CMA_VU::CLower::ReflOpAffWrItBvRdIs(VUINSTRUCTION*, CMIPS*, uint32, uint32
 	operandSet.branchValue = true;
 }
 
+void CMA_VU::CLower::ReflOpAffWrItBvRdMac(VUINSTRUCTION* instr, CMIPS* context, uint32 address, uint32 opcode, OPERANDSET& operandSet)
+{
+	ReflOpAffWrItBv(instr, context, address, opcode, operandSet);
+	operandSet.readMACflags = true;
+}
+
+void CMA_VU::CLower::ReflOpAffWrItBvRdIsMac(VUINSTRUCTION* instr, CMIPS* context, uint32 address, uint32 opcode, OPERANDSET& operandSet)
+{
+	ReflOpAffWrItBvRdIs(instr, context, address, opcode, operandSet);
+	operandSet.readMACflags = true;
+}
+
 void CMA_VU::CLower::ReflOpAffWrItRdItFs(VUINSTRUCTION*, CMIPS*, uint32, uint32 opcode, OPERANDSET& operandSet)
 {
 	auto it = static_cast<uint8>((opcode >> 16) & 0x001F);
@@ -748,13 +760,13 @@ VUINSTRUCTION CMA_VU::CLower::m_cVuReflGeneral[128] =
 	{	"FCOR",		NULL,			ReflOpAffWrVi1Bv	},
 	{	NULL,		NULL,			NULL				},
 	{	"FSSET",	NULL,			ReflOpAffNone		},
-	{	"FSAND",	NULL,			ReflOpAffWrItBv		},
-	{	"FSOR",		NULL,			ReflOpAffWrItBv		},
+	{	"FSAND",	NULL,			ReflOpAffWrItBvRdMac	},
+	{	"FSOR",		NULL,			ReflOpAffWrItBvRdMac	},
 	//0x18
-	{	"FMEQ",		NULL,			ReflOpAffWrItBvRdIs	},
+	{	"FMEQ",		NULL,			ReflOpAffWrItBvRdIsMac	},
 	{	NULL,		NULL,			NULL				},
-	{	"FMAND",	NULL,			ReflOpAffWrItBvRdIs	},
-	{	"FMOR",		NULL,			ReflOpAffWrItBvRdIs	},
+	{	"FMAND",	NULL,			ReflOpAffWrItBvRdIsMac	},
+	{	"FMOR",		NULL,			ReflOpAffWrItBvRdIsMac	},
 	{	"FCGET",	NULL,			ReflOpAffWrItBv		},
 	{	NULL,		NULL,			NULL				},
 	{	NULL,		NULL,			NULL				},
@@ -255,23 +255,23 @@ INSTRUCTION CMA_VU::CUpper::m_cReflVX3[32] =
 VUINSTRUCTION CMA_VU::CUpper::m_cVuReflV[64] =
 {
 	//0x00
-	{	"ADD",		NULL,			ReflOpAffWrFdRdFtFs	},
-	{	"ADD",		NULL,			ReflOpAffWrFdRdFtFs	},
-	{	"ADD",		NULL,			ReflOpAffWrFdRdFtFs	},
-	{	"ADD",		NULL,			ReflOpAffWrFdRdFtFs	},
-	{	"SUB",		NULL,			ReflOpAffWrFdRdFtFs	},
-	{	"SUB",		NULL,			ReflOpAffWrFdRdFtFs	},
-	{	"SUB",		NULL,			ReflOpAffWrFdRdFtFs	},
-	{	"SUB",		NULL,			ReflOpAffWrFdRdFtFs	},
+	{	"ADD",		NULL,			ReflOpAffWrFdRdFtFsMac	},
+	{	"ADD",		NULL,			ReflOpAffWrFdRdFtFsMac	},
+	{	"ADD",		NULL,			ReflOpAffWrFdRdFtFsMac	},
+	{	"ADD",		NULL,			ReflOpAffWrFdRdFtFsMac	},
+	{	"SUB",		NULL,			ReflOpAffWrFdRdFtFsMac	},
+	{	"SUB",		NULL,			ReflOpAffWrFdRdFtFsMac	},
+	{	"SUB",		NULL,			ReflOpAffWrFdRdFtFsMac	},
+	{	"SUB",		NULL,			ReflOpAffWrFdRdFtFsMac	},
 	//0x08
-	{	"MADD",		NULL,			ReflOpAffWrFdRdFtFs	},
-	{	"MADD",		NULL,			ReflOpAffWrFdRdFtFs	},
-	{	"MADD",		NULL,			ReflOpAffWrFdRdFtFs	},
-	{	"MADD",		NULL,			ReflOpAffWrFdRdFtFs	},
-	{	"MSUB",		NULL,			ReflOpAffWrFdRdFtFs	},
-	{	"MSUB",		NULL,			ReflOpAffWrFdRdFtFs	},
-	{	"MSUB",		NULL,			ReflOpAffWrFdRdFtFs	},
-	{	"MSUB",		NULL,			ReflOpAffWrFdRdFtFs	},
+	{	"MADD",		NULL,			ReflOpAffWrFdRdFtFsMac	},
+	{	"MADD",		NULL,			ReflOpAffWrFdRdFtFsMac	},
+	{	"MADD",		NULL,			ReflOpAffWrFdRdFtFsMac	},
+	{	"MADD",		NULL,			ReflOpAffWrFdRdFtFsMac	},
+	{	"MSUB",		NULL,			ReflOpAffWrFdRdFtFsMac	},
+	{	"MSUB",		NULL,			ReflOpAffWrFdRdFtFsMac	},
+	{	"MSUB",		NULL,			ReflOpAffWrFdRdFtFsMac	},
+	{	"MSUB",		NULL,			ReflOpAffWrFdRdFtFsMac	},
 	//0x10
 	{	"MAX",		NULL,			ReflOpAffWrFdRdFtFs	},
 	{	"MAX",		NULL,			ReflOpAffWrFdRdFtFs	},
@@ -282,31 +282,31 @@ VUINSTRUCTION CMA_VU::CUpper::m_cVuReflV[64] =
 	{	"MINI",		NULL,			ReflOpAffWrFdRdFtFs	},
 	{	"MINI",		NULL,			ReflOpAffWrFdRdFtFs	},
 	//0x18
-	{	"MUL",		NULL,			ReflOpAffWrFdRdFtFs	},
-	{	"MUL",		NULL,			ReflOpAffWrFdRdFtFs	},
-	{	"MUL",		NULL,			ReflOpAffWrFdRdFtFs	},
-	{	"MUL",		NULL,			ReflOpAffWrFdRdFtFs	},
-	{	"MUL",		NULL,			ReflOpAffFdFsQ		},
+	{	"MUL",		NULL,			ReflOpAffWrFdRdFtFsMac	},
+	{	"MUL",		NULL,			ReflOpAffWrFdRdFtFsMac	},
+	{	"MUL",		NULL,			ReflOpAffWrFdRdFtFsMac	},
+	{	"MUL",		NULL,			ReflOpAffWrFdRdFtFsMac	},
+	{	"MUL",		NULL,			ReflOpAffFdFsQMac		},
 	{	"MAX",		NULL,			ReflOpAffFdFsI		},
-	{	"MUL",		NULL,			ReflOpAffFdFsI		},
+	{	"MUL",		NULL,			ReflOpAffFdFsIMac		},
 	{	"MINI",		NULL,			ReflOpAffFdFsI		},
 	//0x20
-	{	"ADD",		NULL,			ReflOpAffFdFsQ		},
-	{	"MADD",		NULL,			ReflOpAffFdFsQ		},
-	{	"ADD",		NULL,			ReflOpAffFdFsI		},
-	{	"MADD",		NULL,			ReflOpAffFdFsI		},
-	{	"SUB",		NULL,			ReflOpAffFdFsQ		},
-	{	"MSUB",		NULL,			ReflOpAffFdFsQ		},
-	{	"SUB",		NULL,			ReflOpAffFdFsI		},
-	{	"MSUB",		NULL,			ReflOpAffFdFsI		},
+	{	"ADD",		NULL,			ReflOpAffFdFsQMac		},
+	{	"MADD",		NULL,			ReflOpAffFdFsQMac		},
+	{	"ADD",		NULL,			ReflOpAffFdFsIMac		},
+	{	"MADD",		NULL,			ReflOpAffFdFsIMac		},
+	{	"SUB",		NULL,			ReflOpAffFdFsQMac		},
+	{	"MSUB",		NULL,			ReflOpAffFdFsQMac		},
+	{	"SUB",		NULL,			ReflOpAffFdFsIMac		},
+	{	"MSUB",		NULL,			ReflOpAffFdFsIMac		},
 	//0x28
-	{	"ADD",		NULL,			ReflOpAffWrFdRdFtFs	},
-	{	"MADD",		NULL,			ReflOpAffWrFdRdFtFs	},
-	{	"MUL",		NULL,			ReflOpAffWrFdRdFtFs	},
+	{	"ADD",		NULL,			ReflOpAffWrFdRdFtFsMac	},
+	{	"MADD",		NULL,			ReflOpAffWrFdRdFtFsMac	},
+	{	"MUL",		NULL,			ReflOpAffWrFdRdFtFsMac	},
 	{	"MAX",		NULL,			ReflOpAffWrFdRdFtFs	},
-	{	"SUB",		NULL,			ReflOpAffWrFdRdFtFs	},
-	{	"MSUB",		NULL,			ReflOpAffWrFdRdFtFs	},
-	{	"OPMSUB",	NULL,			ReflOpAffWrFdRdFtFs	},
+	{	"SUB",		NULL,			ReflOpAffWrFdRdFtFsMac	},
+	{	"MSUB",		NULL,			ReflOpAffWrFdRdFtFsMac	},
+	{	"OPMSUB",	NULL,			ReflOpAffWrFdRdFtFsMac	},
 	{	"MINI",		NULL,			ReflOpAffWrFdRdFtFs	},
 	//0x30
 	{	NULL,		NULL,			NULL				},
@@ -331,19 +331,19 @@ VUINSTRUCTION CMA_VU::CUpper::m_cVuReflV[64] =
 VUINSTRUCTION CMA_VU::CUpper::m_cVuReflVX0[32] =
 {
 	//0x00
-	{	"ADDA",		NULL,			ReflOpAffWrARdFtFs	},
-	{	"SUBA",		NULL,			ReflOpAffWrARdFtFs	},
-	{	"MADDA",	NULL,			ReflOpAffWrARdFtFs	},
-	{	"MSUBA",	NULL,			ReflOpAffWrARdFtFs	},
+	{	"ADDA",		NULL,			ReflOpAffWrARdFtFsMac	},
+	{	"SUBA",		NULL,			ReflOpAffWrARdFtFsMac	},
+	{	"MADDA",	NULL,			ReflOpAffWrARdFtFsMac	},
+	{	"MSUBA",	NULL,			ReflOpAffWrARdFtFsMac	},
 	{	"ITOF0",	NULL,			ReflOpAffFtFs		},
 	{	"FTOI0",	NULL,			ReflOpAffFtFs		},
-	{	"MULA",		NULL,			ReflOpAffWrARdFtFs	},
-	{	"MULA",		NULL,			ReflOpAffWrARdFsQ	},
+	{	"MULA",		NULL,			ReflOpAffWrARdFtFsMac	},
+	{	"MULA",		NULL,			ReflOpAffWrARdFsQMac	},
 	//0x08
 	{	NULL,		NULL,			NULL				},
 	{	NULL,		NULL,			NULL				},
-	{	"ADDA",		NULL,			ReflOpAffWrARdFtFs	},
-	{	"SUBA",		NULL,			ReflOpAffWrARdFtFs	},
+	{	"ADDA",		NULL,			ReflOpAffWrARdFtFsMac	},
+	{	"SUBA",		NULL,			ReflOpAffWrARdFtFsMac	},
 	{	NULL,		NULL,			NULL				},
 	{	NULL,		NULL,			NULL				},
 	{	NULL,		NULL,			NULL				},
@@ -371,19 +371,19 @@ VUINSTRUCTION CMA_VU::CUpper::m_cVuReflVX0[32] =
 VUINSTRUCTION CMA_VU::CUpper::m_cVuReflVX1[32] =
 {
 	//0x00
-	{	"ADDA",		NULL,			ReflOpAffWrARdFtFs	},
-	{	"SUBA",		NULL,			ReflOpAffWrARdFtFs	},
-	{	"MADDA",	NULL,			ReflOpAffWrARdFtFs	},
-	{	"MSUBA",	NULL,			ReflOpAffWrARdFtFs	},
+	{	"ADDA",		NULL,			ReflOpAffWrARdFtFsMac	},
+	{	"SUBA",		NULL,			ReflOpAffWrARdFtFsMac	},
+	{	"MADDA",	NULL,			ReflOpAffWrARdFtFsMac	},
+	{	"MSUBA",	NULL,			ReflOpAffWrARdFtFsMac	},
 	{	"ITOF4",	NULL,			ReflOpAffFtFs,		},
 	{	"FTOI4",	NULL,			ReflOpAffFtFs,		},
-	{	"MULA",		NULL,			ReflOpAffWrARdFtFs	},
+	{	"MULA",		NULL,			ReflOpAffWrARdFtFsMac	},
 	{	"ABS",		NULL,			ReflOpAffFtFs		},
 	//0x08
-	{	"MADDA",	NULL,			ReflOpAffWrARdFsQ	},
-	{	"MSUBA",	NULL,			ReflOpAffWrARdFsQ	},
-	{	"MADDA",	NULL,			ReflOpAffWrARdFtFs	},
-	{	"MSUBA",	NULL,			ReflOpAffWrARdFtFs	},
+	{	"MADDA",	NULL,			ReflOpAffWrARdFsQMac	},
+	{	"MSUBA",	NULL,			ReflOpAffWrARdFsQMac	},
+	{	"MADDA",	NULL,			ReflOpAffWrARdFtFsMac	},
+	{	"MSUBA",	NULL,			ReflOpAffWrARdFtFsMac	},
 	{	NULL,		NULL,			NULL				},
 	{	NULL,		NULL,			NULL				},
 	{	NULL,		NULL,			NULL				},
@@ -411,18 +411,18 @@ VUINSTRUCTION CMA_VU::CUpper::m_cVuReflVX1[32] =
 VUINSTRUCTION CMA_VU::CUpper::m_cVuReflVX2[32] =
 {
 	//0x00
-	{	"ADDA",		NULL,			ReflOpAffWrARdFtFs	},
-	{	"SUBA",		NULL,			ReflOpAffWrARdFtFs	},
-	{	"MADDA",	NULL,			ReflOpAffWrARdFtFs	},
-	{	"MSUBA",	NULL,			ReflOpAffWrARdFtFs	},
+	{	"ADDA",		NULL,			ReflOpAffWrARdFtFsMac	},
+	{	"SUBA",		NULL,			ReflOpAffWrARdFtFsMac	},
+	{	"MADDA",	NULL,			ReflOpAffWrARdFtFsMac	},
+	{	"MSUBA",	NULL,			ReflOpAffWrARdFtFsMac	},
 	{	"ITOF12",	NULL,			ReflOpAffFtFs		},
 	{	"FTOI12",	NULL,			ReflOpAffFtFs		},
-	{	"MULA",		NULL,			ReflOpAffWrARdFtFs	},
-	{	"MULA",		NULL,			ReflOpAffAccFsI		},
+	{	"MULA",		NULL,			ReflOpAffWrARdFtFsMac	},
+	{	"MULA",		NULL,			ReflOpAffAccFsIMac		},
 	//0x08
-	{	"ADDA",		NULL,			ReflOpAffAccFsI,	},
-	{	"SUBA",		NULL,			ReflOpAffAccFsI,	},
-	{	"MULA",		NULL,			ReflOpAffWrARdFtFs	},
+	{	"ADDA",		NULL,			ReflOpAffAccFsIMac,	},
+	{	"SUBA",		NULL,			ReflOpAffAccFsIMac,	},
+	{	"MULA",		NULL,			ReflOpAffWrARdFtFsMac	},
 	{	"OPMULA",	NULL,			ReflOpAffWrARdFtFs	},
 	{	NULL,		NULL,			NULL				},
 	{	NULL,		NULL,			NULL				},
@@ -451,17 +451,17 @@ VUINSTRUCTION CMA_VU::CUpper::m_cVuReflVX2[32] =
 VUINSTRUCTION CMA_VU::CUpper::m_cVuReflVX3[32] =
 {
 	//0x00
-	{	"ADDA",		NULL,			ReflOpAffWrARdFtFs	},
-	{	"SUBA",		NULL,			ReflOpAffWrARdFtFs	},
-	{	"MADDA",	NULL,			ReflOpAffWrARdFtFs	},
-	{	"MSUBA",	NULL,			ReflOpAffWrARdFtFs	},
+	{	"ADDA",		NULL,			ReflOpAffWrARdFtFsMac	},
+	{	"SUBA",		NULL,			ReflOpAffWrARdFtFsMac	},
+	{	"MADDA",	NULL,			ReflOpAffWrARdFtFsMac	},
+	{	"MSUBA",	NULL,			ReflOpAffWrARdFtFsMac	},
 	{	"ITOF15",	NULL,			ReflOpAffFtFs		},
 	{	"FTOI15",	NULL,			ReflOpAffFtFs		},
-	{	"MULA",		NULL,			ReflOpAffWrARdFtFs	},
+	{	"MULA",		NULL,			ReflOpAffWrARdFtFsMac	},
 	{	"CLIP",		NULL,			ReflOpAffWrCfRdFtFs	},
 	//0x08
-	{	"MADDA",	NULL,			ReflOpAffAccFsI		},
-	{	"MSUBA",	NULL,			ReflOpAffAccFsI		},
+	{	"MADDA",	NULL,			ReflOpAffAccFsIMac		},
+	{	"MSUBA",	NULL,			ReflOpAffAccFsIMac		},
 	{	NULL,		NULL,			NULL				},
 	{	"NOP",		NULL,			ReflOpAffNone		},
 	{	NULL,		NULL,			NULL				},
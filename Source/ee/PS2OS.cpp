@@ -550,6 +550,7 @@ void CPS2OS::UnloadExecutable()
 
 uint32 CPS2OS::LoadExecutable(const char* path, const char* section)
 {
+	m_sif.SyncIop();
 	auto ioman = m_iopBios.GetIoman();
 
 	uint32 handle = ioman->Open(Iop::Ioman::CDevice::OPEN_FLAG_RDONLY, path);
@@ -2830,6 +2831,7 @@ void CPS2OS::sc_Deci2Call()
 				uint32 length = m_ram[stringAddr + 0x00] - 0x0C;
 				uint8* string = &m_ram[stringAddr + 0x0C];
 
+				m_sif.SyncIop();
 				m_iopBios.GetIoman()->Write(Iop::CIoman::FID_STDOUT, length, string);
 			}
 
@@ -2857,6 +2859,7 @@ void CPS2OS::sc_Deci2Call()
 		{
 			uint32 stringAddr = *reinterpret_cast<uint32*>(GetStructPtr(param));
 			uint8* string = &m_ram[stringAddr];
+			m_sif.SyncIop();
 			m_iopBios.GetIoman()->Write(1, static_cast<uint32>(strlen(reinterpret_cast<char*>(string))), string);
 		}
 		break;
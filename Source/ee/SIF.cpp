@@ -1,6 +1,7 @@
 #include <cstring>
 #include <stdio.h>
 #include "../Log.h"
+#include "../Trace.h"
 #include "../Ps2Const.h"
 #include "../states/StructCollectionStateFile.h"
 #include "../states/MemoryStateFile.h"
@@ -86,12 +87,14 @@ void CSIF::Reset()
 
 void CSIF::SetDmaBuffer(uint32 bufferAddress, uint32 size)
 {
+	std::lock_guard<std::mutex> lock(m_mutex);
 	m_dmaBufferAddress = bufferAddress;
 	m_dmaBufferSize = size;
 }
 
 void CSIF::SetCmdBuffer(uint32 bufferAddress, uint32 size)
 {
+	std::lock_guard<std::mutex> lock(m_mutex);
 	m_cmdBufferAddress = bufferAddress;
 	m_cmdBufferSize = size;
 	m_nSUBADDR = bufferAddress;
@@ -126,11 +129,18 @@ void CSIF::DeleteModules()
 
 uint32 CSIF::ReceiveDMA5(uint32 srcAddress, uint32 size, uint32 unused, bool isTagIncluded)
 {
-	if(size > m_dmaBufferSize)
+	uint32 dmaBufferAddress = 0;
+	uint32 dmaBufferSize = 0;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		dmaBufferAddress = m_dmaBufferAddress;
+		dmaBufferSize = m_dmaBufferSize;
+	}
+	if(size > dmaBufferSize)
 	{
 		throw std::runtime_error("Packet too big.");
 	}
-	memcpy(m_eeRam + srcAddress, m_iopRam + m_dmaBufferAddress, size);
+	memcpy(m_eeRam + srcAddress, m_iopRam + dmaBufferAddress, size);
 	return size;
 }
 
@@ -138,6 +148,9 @@ uint32 CSIF::ReceiveDMA6(uint32 nSrcAddr, uint32 nSize, uint32 nDstAddr, bool is
 {
 	assert(!isTagIncluded);
 
+	//Commands are handled by IOP modules and data goes to IOP RAM
+	SyncIop();
+
 	//Humm, this is kinda odd, but it ors the address with 0x20000000
 	nSrcAddr &= (PS2::EE_RAM_SIZE - 1);
 
@@ -166,7 +179,7 @@ uint32 CSIF::ReceiveDMA6(uint32 nSrcAddr, uint32 nSize, uint32 nDstAddr, bool is
 	{
 		auto hdr = reinterpret_cast<SIFCMDHEADER*>(m_eeRam + nSrcAddr);
 
-		CLog::GetInstance().Print(LOG_NAME, "Received command 0x%08X.\r\n", hdr->commandId);
+		TRACE_PRINT(LOG_NAME, "Received command 0x%08X.\r\n", hdr->commandId);
 
 		switch(hdr->commandId)
 		{
@@ -199,12 +212,12 @@ uint32 CSIF::ReceiveDMA6(uint32 nSrcAddr, uint32 nSize, uint32 nDstAddr, bool is
 	else
 	{
 		assert(nDstAddr < PS2::IOP_RAM_SIZE);
-		CLog::GetInstance().Print(LOG_NAME, "WriteToIop(dstAddr = 0x%08X, srcAddr = 0x%08X, size = 0x%08X);\r\n",
-		                          nDstAddr, nSrcAddr, nSize);
+		TRACE_PRINT(LOG_NAME, "WriteToIop(dstAddr = 0x%08X, srcAddr = 0x%08X, size = 0x%08X);\r\n",
+		            nDstAddr, nSrcAddr, nSize);
 		nSize &= 0x7FFFFFFF; //Fix for Gregory Horror Show's crash
 		if(nDstAddr >= 0 && nDstAddr <= CIopBios::CONTROL_BLOCK_END)
 		{
-			CLog::GetInstance().Print(LOG_NAME, "Warning: Trying to DMA in Bios Control Area.\r\n");
+			TRACE_PRINT(LOG_NAME, "Warning: Trying to DMA in Bios Control Area.\r\n");
 		}
 		else
 		{
@@ -216,6 +229,7 @@ uint32 CSIF::ReceiveDMA6(uint32 nSrcAddr, uint32 nSize, uint32 nDstAddr, bool is
 
 void CSIF::SendPacket(void* packet, uint32 size)
 {
+	std::lock_guard<std::mutex> lock(m_mutex);
 	m_packetQueue.insert(m_packetQueue.begin(),
 	                     reinterpret_cast<uint8*>(packet),
 	                     reinterpret_cast<uint8*>(packet) + size);
@@ -226,14 +240,19 @@ void CSIF::SendPacket(void* packet, uint32 size)
 
 void CSIF::ProcessPackets()
 {
-	if(m_packetProcessed && !m_packetQueue.empty())
+	if(!m_packetProcessed) return;
+	PacketQueue packet;
 	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if(m_packetQueue.empty()) return;
 		assert(m_packetQueue.size() > 4);
 		uint32 size = *reinterpret_cast<uint32*>(&m_packetQueue[0]);
-		SendDMA(&m_packetQueue[4], size);
+		packet.assign(m_packetQueue.begin() + 4, m_packetQueue.begin() + 4 + size);
 		m_packetQueue.erase(m_packetQueue.begin(), m_packetQueue.begin() + 4 + size);
-		m_packetProcessed = false;
 	}
+	//Don't keep the IOP waiting on the queue while the packet goes through the DMAC
+	SendDMA(packet.data(), static_cast<uint32>(packet.size()));
+	m_packetProcessed = false;
 }
 
 void CSIF::MarkPacketProcessed()
@@ -246,15 +265,25 @@ void CSIF::SendDMA(void* pData, uint32 nSize)
 {
 	//Humm, the DMAC doesn't know about our addresses on this side...
 
-	if(nSize > m_dmaBufferSize)
+	uint32 dmaBufferAddress = 0;
+	uint32 dmaBufferSize = 0;
+	uint32 eeRecvAddr = 0;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		dmaBufferAddress = m_dmaBufferAddress;
+		dmaBufferSize = m_dmaBufferSize;
+		eeRecvAddr = m_nEERecvAddr;
+	}
+
+	if(nSize > dmaBufferSize)
 	{
 		throw std::runtime_error("Packet too big.");
 	}
 
-	memcpy(m_iopRam + m_dmaBufferAddress, pData, nSize);
+	memcpy(m_iopRam + dmaBufferAddress, pData, nSize);
 	uint32 nQuads = (nSize + 0x0F) / 0x10;
 
-	m_dmac.SetRegister(CDMAC::D5_MADR, m_nEERecvAddr);
+	m_dmac.SetRegister(CDMAC::D5_MADR, eeRecvAddr);
 	m_dmac.SetRegister(CDMAC::D5_QWC, nQuads);
 	m_dmac.SetRegister(CDMAC::D5_CHCR, CDMAC::CHCR_STR);
 }
@@ -471,6 +500,7 @@ void CSIF::Cmd_Initialize(const SIFCMDHEADER* hdr)
 	auto init = reinterpret_cast<const INIT*>(hdr);
 	if(init->Header.optional == 0)
 	{
+		std::lock_guard<std::mutex> lock(m_mutex);
 		m_nEERecvAddr = init->nEEAddress;
 		m_nEERecvAddr &= (PS2::EE_RAM_SIZE - 1);
 	}
@@ -513,7 +543,7 @@ void CSIF::Cmd_Bind(const SIFCMDHEADER* hdr)
 	rend.buffer = RPC_RECVADDR;
 	rend.cbuffer = 0xDEADCAFE;
 
-	CLog::GetInstance().Print(LOG_NAME, "Bound client data (0x%08X) with server id 0x%08X.\r\n", bind->clientDataAddr, bind->serverId);
+	TRACE_PRINT(LOG_NAME, "Bound client data (0x%08X) with server id 0x%08X.\r\n", bind->clientDataAddr, bind->serverId);
 
 	auto moduleIterator(m_modules.find(bind->serverId));
 	if(moduleIterator != m_modules.end())
@@ -532,7 +562,7 @@ void CSIF::Cmd_Call(const SIFCMDHEADER* hdr)
 	auto call = reinterpret_cast<const SIFRPCCALL*>(hdr);
 	bool sendReply = true;
 
-	CLog::GetInstance().Print(LOG_NAME, "Calling function 0x%08X of module 0x%08X.\r\n", call->rpcNumber, call->serverDataAddr);
+	TRACE_PRINT(LOG_NAME, "Calling function 0x%08X of module 0x%08X.\r\n", call->rpcNumber, call->serverDataAddr);
 
 	uint32 nRecvAddr = (call->recv & (PS2::EE_RAM_SIZE - 1));
 
@@ -547,7 +577,7 @@ void CSIF::Cmd_Call(const SIFCMDHEADER* hdr)
 	}
 	else
 	{
-		CLog::GetInstance().Print(LOG_NAME, "Called an unknown module (0x%08X).\r\n", call->serverDataAddr);
+		TRACE_PRINT(LOG_NAME, "Called an unknown module (0x%08X).\r\n", call->serverDataAddr);
 	}
 
 	{
@@ -571,10 +601,11 @@ void CSIF::Cmd_Call(const SIFCMDHEADER* hdr)
 		{
 			//Hold the packet
 			//We assume that there's only one call that
-			assert(m_callReplies.find(call->serverDataAddr) == m_callReplies.end());
 			CALLREQUESTINFO requestInfo;
 			requestInfo.reply = rend;
 			requestInfo.call = *call;
+			std::lock_guard<std::mutex> lock(m_mutex);
+			assert(m_callReplies.find(call->serverDataAddr) == m_callReplies.end());
 			m_callReplies[call->serverDataAddr] = requestInfo;
 		}
 	}
@@ -584,8 +615,8 @@ void CSIF::Cmd_GetOtherData(const SIFCMDHEADER* hdr)
 {
 	auto otherData = reinterpret_cast<const SIFRPCOTHERDATA*>(hdr);
 
-	CLog::GetInstance().Print(LOG_NAME, "GetOtherData(dstPtr = 0x%08X, srcPtr = 0x%08X, size = 0x%08X);\r\n",
-	                          otherData->dstPtr, otherData->srcPtr, otherData->size);
+	TRACE_PRINT(LOG_NAME, "GetOtherData(dstPtr = 0x%08X, srcPtr = 0x%08X, size = 0x%08X);\r\n",
+	            otherData->dstPtr, otherData->srcPtr, otherData->size);
 
 	uint32 dstPtr = otherData->dstPtr & (PS2::EE_RAM_SIZE - 1);
 	uint32 srcPtr = otherData->srcPtr & (PS2::IOP_RAM_SIZE - 1);
@@ -611,13 +642,18 @@ void CSIF::Cmd_GetOtherData(const SIFCMDHEADER* hdr)
 
 void CSIF::SendCallReply(uint32 serverId, const void* returnData)
 {
-	CLog::GetInstance().Print(LOG_NAME, "Processing call reply from serverId: 0x%08X\r\n", serverId);
+	TRACE_PRINT(LOG_NAME, "Processing call reply from serverId: 0x%08X\r\n", serverId);
 
-	auto replyIterator(m_callReplies.find(serverId));
-	assert(replyIterator != m_callReplies.end());
-	if(replyIterator == m_callReplies.end()) return;
+	CALLREQUESTINFO requestInfo;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto replyIterator(m_callReplies.find(serverId));
+		assert(replyIterator != m_callReplies.end());
+		if(replyIterator == m_callReplies.end()) return;
+		requestInfo = replyIterator->second;
+		m_callReplies.erase(replyIterator);
+	}
 
-	auto& requestInfo(replyIterator->second);
 	if(requestInfo.call.recv != 0 && returnData != nullptr)
 	{
 		uint32 dstPtr = requestInfo.call.recv & (PS2::EE_RAM_SIZE - 1);
@@ -628,7 +664,6 @@ void CSIF::SendCallReply(uint32 serverId, const void* returnData)
 		memcpy(m_eeRam + dstPtr, returnData, dstSize);
 	}
 	SendPacket(&requestInfo.reply, sizeof(SIFRPCREQUESTEND));
-	m_callReplies.erase(replyIterator);
 }
 
 void CSIF::SetModuleResetHandler(const ModuleResetHandler& moduleResetHandler)
@@ -641,12 +676,26 @@ void CSIF::SetCustomCommandHandler(const CustomCommandHandler& customCommandHand
 	m_customCommandHandler = customCommandHandler;
 }
 
+void CSIF::SetIopSyncHandler(const IopSyncHandler& iopSyncHandler)
+{
+	m_iopSyncHandler = iopSyncHandler;
+}
+
+void CSIF::SyncIop()
+{
+	if(m_iopSyncHandler)
+	{
+		m_iopSyncHandler();
+	}
+}
+
 /////////////////////////////////////////////////////////
 //Get/Set Register
 /////////////////////////////////////////////////////////
 
 uint32 CSIF::GetRegister(uint32 nRegister)
 {
+	SyncIop();
 	switch(nRegister)
 	{
 	case 0x00000001:
@@ -676,6 +725,7 @@ uint32 CSIF::GetRegister(uint32 nRegister)
 
 void CSIF::SetRegister(uint32 nRegister, uint32 nValue)
 {
+	SyncIop();
 	switch(nRegister)
 	{
 	case 0x00000001:
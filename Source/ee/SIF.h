@@ -1,6 +1,8 @@
 #pragma once
 
+#include <functional>
 #include <map>
+#include <mutex>
 #include <vector>
 #include "../SifDefs.h"
 #include "../SifModule.h"
@@ -15,6 +17,7 @@ class CSIF
 public:
 	typedef std::function<void(const std::string&)> ModuleResetHandler;
 	typedef std::function<void(uint32)> CustomCommandHandler;
+	typedef std::function<void()> IopSyncHandler;
 
 	CSIF(CDMAC&, uint8*, uint8*);
 	virtual ~CSIF() = default;
@@ -33,6 +36,10 @@ public:
 	void SetModuleResetHandler(const ModuleResetHandler&);
 	void SetCustomCommandHandler(const CustomCommandHandler&);
 
+	//Called before the EE touches state owned by the IOP when the IOP runs on its own thread
+	void SetIopSyncHandler(const IopSyncHandler&);
+	void SyncIop();
+
 	uint32 ReceiveDMA5(uint32, uint32, uint32, bool);
 	uint32 ReceiveDMA6(uint32, uint32, uint32, bool);
 
@@ -99,6 +106,9 @@ private:
 
 	ModuleMap m_modules;
 
+	//IOP and EE can run on different threads. Guards the packet queue (filled by the IOP and
+	//drained by the EE), the IOP side buffers, the EE receive address and held call replies.
+	std::mutex m_mutex;
 	PacketQueue m_packetQueue;
 	bool m_packetProcessed;
 
@@ -107,4 +117,5 @@ private:
 
 	ModuleResetHandler m_moduleResetHandler;
 	CustomCommandHandler m_customCommandHandler;
+	IopSyncHandler m_iopSyncHandler;
 };
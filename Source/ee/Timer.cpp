@@ -1,6 +1,6 @@
 #include <cstring>
 #include <stdio.h>
-#include "../Log.h"
+#include "../Trace.h"
 #include "../states/RegisterStateFile.h"
 #include "Timer.h"
 
@@ -93,7 +93,10 @@ void CTimer::Count(unsigned int ticks)
 
 uint32 CTimer::GetRegister(uint32 nAddress)
 {
-	DisassembleGet(nAddress);
+	if(CTrace::IsEnabled())
+	{
+		DisassembleGet(nAddress);
+	}
 
 	unsigned int nTimerId = (nAddress >> 11) & 0x3;
 
@@ -132,7 +135,7 @@ uint32 CTimer::GetRegister(uint32 nAddress)
 		break;
 
 	default:
-		CLog::GetInstance().Print(LOG_NAME, "Read an unhandled IO port (0x%08X).\r\n", nAddress);
+		TRACE_PRINT(LOG_NAME, "Read an unhandled IO port (0x%08X).\r\n", nAddress);
 		break;
 	}
 
@@ -141,7 +144,10 @@ uint32 CTimer::GetRegister(uint32 nAddress)
 
 void CTimer::SetRegister(uint32 nAddress, uint32 nValue)
 {
-	DisassembleSet(nAddress, nValue);
+	if(CTrace::IsEnabled())
+	{
+		DisassembleSet(nAddress, nValue);
+	}
 
 	unsigned int nTimerId = (nAddress >> 11) & 0x3;
 
@@ -182,7 +188,7 @@ void CTimer::SetRegister(uint32 nAddress, uint32 nValue)
 		break;
 
 	default:
-		CLog::GetInstance().Print(LOG_NAME, "Wrote to an unhandled IO port (0x%08X, 0x%08X).\r\n", nAddress, nValue);
+		TRACE_PRINT(LOG_NAME, "Wrote to an unhandled IO port (0x%08X, 0x%08X).\r\n", nAddress, nValue);
 		break;
 	}
 }
@@ -194,19 +200,19 @@ void CTimer::DisassembleGet(uint32 nAddress)
 	switch(nAddress & 0x7FF)
 	{
 	case 0x00:
-		CLog::GetInstance().Print(LOG_NAME, "= T%i_COUNT\r\n", nTimerId);
+		TRACE_PRINT(LOG_NAME, "= T%i_COUNT\r\n", nTimerId);
 		break;
 
 	case 0x10:
-		CLog::GetInstance().Print(LOG_NAME, "= T%i_MODE\r\n", nTimerId);
+		TRACE_PRINT(LOG_NAME, "= T%i_MODE\r\n", nTimerId);
 		break;
 
 	case 0x20:
-		CLog::GetInstance().Print(LOG_NAME, "= T%i_COMP\r\n", nTimerId);
+		TRACE_PRINT(LOG_NAME, "= T%i_COMP\r\n", nTimerId);
 		break;
 
 	case 0x30:
-		CLog::GetInstance().Print(LOG_NAME, "= T%i_HOLD\r\n", nTimerId);
+		TRACE_PRINT(LOG_NAME, "= T%i_HOLD\r\n", nTimerId);
 		break;
 	}
 }
@@ -218,19 +224,19 @@ void CTimer::DisassembleSet(uint32 nAddress, uint32 nValue)
 	switch(nAddress & 0x7FF)
 	{
 	case 0x00:
-		CLog::GetInstance().Print(LOG_NAME, "T%i_COUNT = 0x%08X\r\n", nTimerId, nValue);
+		TRACE_PRINT(LOG_NAME, "T%i_COUNT = 0x%08X\r\n", nTimerId, nValue);
 		break;
 
 	case 0x10:
-		CLog::GetInstance().Print(LOG_NAME, "T%i_MODE = 0x%08X\r\n", nTimerId, nValue);
+		TRACE_PRINT(LOG_NAME, "T%i_MODE = 0x%08X\r\n", nTimerId, nValue);
 		break;
 
 	case 0x20:
-		CLog::GetInstance().Print(LOG_NAME, "T%i_COMP = 0x%08X\r\n", nTimerId, nValue);
+		TRACE_PRINT(LOG_NAME, "T%i_COMP = 0x%08X\r\n", nTimerId, nValue);
 		break;
 
 	case 0x30:
-		CLog::GetInstance().Print(LOG_NAME, "T%i_HOLD = 0x%08X\r\n", nTimerId, nValue);
+		TRACE_PRINT(LOG_NAME, "T%i_HOLD = 0x%08X\r\n", nTimerId, nValue);
 		break;
 	}
 }
@@ -58,6 +58,10 @@ namespace VUShared
 		//When set, means that a branch following the instruction will be
 		//able to use the integer value directly
 		bool branchValue;
+
+		//Upper instruction queues MAC flags in the flag pipeline, lower instruction reads them
+		bool writeMACflags;
+		bool readMACflags;
 	};
 
 	struct VUINSTRUCTION;
@@ -93,30 +97,32 @@ namespace VUShared
 	void PushIntegerRegister(CMipsJitter*, unsigned int);
 
 	void ClampVector(CMipsJitter*);
-	void TestSZFlags(CMipsJitter*, uint8, size_t, uint32);
+	//macFlagsUnused is set by the block compiler when nothing can observe the MAC flags of the
+	//instruction being compiled, sticky flags are still updated.
+	void TestSZFlags(CMipsJitter*, uint8, size_t, uint32, bool);
 
 	void GetStatus(CMipsJitter*, size_t, uint32);
 	void SetStatus(CMipsJitter*, size_t);
 
-	void ADDA_base(CMipsJitter*, uint8, size_t, size_t, bool, uint32);
-	void MADD_base(CMipsJitter*, uint8, size_t, size_t, size_t, bool, uint32);
-	void MADDA_base(CMipsJitter*, uint8, size_t, size_t, bool, uint32);
-	void SUB_base(CMipsJitter*, uint8, size_t, size_t, size_t, bool, uint32);
-	void SUBA_base(CMipsJitter*, uint8, size_t, size_t, bool, uint32);
-	void MSUB_base(CMipsJitter*, uint8, size_t, size_t, size_t, bool, uint32);
-	void MSUBA_base(CMipsJitter*, uint8, size_t, size_t, bool, uint32);
-	void MUL_base(CMipsJitter*, uint8, size_t, size_t, size_t, bool, uint32);
-	void MULA_base(CMipsJitter*, uint8, size_t, size_t, bool, uint32);
+	void ADDA_base(CMipsJitter*, uint8, size_t, size_t, bool, uint32, bool);
+	void MADD_base(CMipsJitter*, uint8, size_t, size_t, size_t, bool, uint32, bool);
+	void MADDA_base(CMipsJitter*, uint8, size_t, size_t, bool, uint32, bool);
+	void SUB_base(CMipsJitter*, uint8, size_t, size_t, size_t, bool, uint32, bool);
+	void SUBA_base(CMipsJitter*, uint8, size_t, size_t, bool, uint32, bool);
+	void MSUB_base(CMipsJitter*, uint8, size_t, size_t, size_t, bool, uint32, bool);
+	void MSUBA_base(CMipsJitter*, uint8, size_t, size_t, bool, uint32, bool);
+	void MUL_base(CMipsJitter*, uint8, size_t, size_t, size_t, bool, uint32, bool);
+	void MULA_base(CMipsJitter*, uint8, size_t, size_t, bool, uint32, bool);
 
 	//Shared instructions
 	void ABS(CMipsJitter*, uint8, uint8, uint8);
-	void ADD(CMipsJitter*, uint8, uint8, uint8, uint8, uint32);
-	void ADDbc(CMipsJitter*, uint8, uint8, uint8, uint8, uint8, uint32);
-	void ADDi(CMipsJitter*, uint8, uint8, uint8, uint32);
-	void ADDq(CMipsJitter*, uint8, uint8, uint8, uint32);
-	void ADDA(CMipsJitter*, uint8, uint8, uint8, uint32);
-	void ADDAbc(CMipsJitter*, uint8, uint8, uint8, uint8, uint32);
-	void ADDAi(CMipsJitter*, uint8, uint8, uint32);
+	void ADD(CMipsJitter*, uint8, uint8, uint8, uint8, uint32, bool);
+	void ADDbc(CMipsJitter*, uint8, uint8, uint8, uint8, uint8, uint32, bool);
+	void ADDi(CMipsJitter*, uint8, uint8, uint8, uint32, bool);
+	void ADDq(CMipsJitter*, uint8, uint8, uint8, uint32, bool);
+	void ADDA(CMipsJitter*, uint8, uint8, uint8, uint32, bool);
+	void ADDAbc(CMipsJitter*, uint8, uint8, uint8, uint8, uint32, bool);
+	void ADDAi(CMipsJitter*, uint8, uint8, uint32, bool);
 	void CLIP(CMipsJitter*, uint8, uint8, uint32);
 	void DIV(CMipsJitter*, uint8, uint8, uint8, uint8, uint32);
 	void FTOI0(CMipsJitter*, uint8, uint8, uint8);
@@ -139,14 +145,14 @@ namespace VUShared
 	void LQbase(CMipsJitter*, uint8, uint8);
 	void LQD(CMipsJitter*, uint8, uint8, uint8, uint32);
 	void LQI(CMipsJitter*, uint8, uint8, uint8, uint32);
-	void MADD(CMipsJitter*, uint8, uint8, uint8, uint8, uint32);
-	void MADDbc(CMipsJitter*, uint8, uint8, uint8, uint8, uint8, uint32);
-	void MADDi(CMipsJitter*, uint8, uint8, uint8, uint32);
-	void MADDq(CMipsJitter*, uint8, uint8, uint8, uint32);
-	void MADDA(CMipsJitter*, uint8, uint8, uint8, uint32);
-	void MADDAbc(CMipsJitter*, uint8, uint8, uint8, uint8, uint32);
-	void MADDAi(CMipsJitter*, uint8, uint8, uint32);
-	void MADDAq(CMipsJitter*, uint8, uint8, uint32);
+	void MADD(CMipsJitter*, uint8, uint8, uint8, uint8, uint32, bool);
+	void MADDbc(CMipsJitter*, uint8, uint8, uint8, uint8, uint8, uint32, bool);
+	void MADDi(CMipsJitter*, uint8, uint8, uint8, uint32, bool);
+	void MADDq(CMipsJitter*, uint8, uint8, uint8, uint32, bool);
+	void MADDA(CMipsJitter*, uint8, uint8, uint8, uint32, bool);
+	void MADDAbc(CMipsJitter*, uint8, uint8, uint8, uint8, uint32, bool);
+	void MADDAi(CMipsJitter*, uint8, uint8, uint32, bool);
+	void MADDAq(CMipsJitter*, uint8, uint8, uint32, bool);
 	void MAX(CMipsJitter*, uint8, uint8, uint8, uint8);
 	void MAXbc(CMipsJitter*, uint8, uint8, uint8, uint8, uint8);
 	void MAXi(CMipsJitter*, uint8, uint8, uint8);
@@ -155,25 +161,25 @@ namespace VUShared
 	void MINIi(CMipsJitter*, uint8, uint8, uint8);
 	void MOVE(CMipsJitter*, uint8, uint8, uint8);
 	void MR32(CMipsJitter*, uint8, uint8, uint8);
-	void MSUB(CMipsJitter*, uint8, uint8, uint8, uint8, uint32);
-	void MSUBbc(CMipsJitter*, uint8, uint8, uint8, uint8, uint8, uint32);
-	void MSUBi(CMipsJitter*, uint8, uint8, uint8, uint32);
-	void MSUBq(CMipsJitter*, uint8, uint8, uint8, uint32);
-	void MSUBA(CMipsJitter*, uint8, uint8, uint8, uint32);
-	void MSUBAbc(CMipsJitter*, uint8, uint8, uint8, uint8, uint32);
-	void MSUBAi(CMipsJitter*, uint8, uint8, uint32);
-	void MSUBAq(CMipsJitter*, uint8, uint8, uint32);
+	void MSUB(CMipsJitter*, uint8, uint8, uint8, uint8, uint32, bool);
+	void MSUBbc(CMipsJitter*, uint8, uint8, uint8, uint8, uint8, uint32, bool);
+	void MSUBi(CMipsJitter*, uint8, uint8, uint8, uint32, bool);
+	void MSUBq(CMipsJitter*, uint8, uint8, uint8, uint32, bool);
+	void MSUBA(CMipsJitter*, uint8, uint8, uint8, uint32, bool);
+	void MSUBAbc(CMipsJitter*, uint8, uint8, uint8, uint8, uint32, bool);
+	void MSUBAi(CMipsJitter*, uint8, uint8, uint32, bool);
+	void MSUBAq(CMipsJitter*, uint8, uint8, uint32, bool);
 	void MFIR(CMipsJitter*, uint8, uint8, uint8);
 	void MTIR(CMipsJitter*, uint8, uint8, uint8);
-	void MUL(CMipsJitter*, uint8, uint8, uint8, uint8, uint32);
-	void MULbc(CMipsJitter*, uint8, uint8, uint8, uint8, uint8, uint32);
-	void MULi(CMipsJitter*, uint8, uint8, uint8, uint32);
-	void MULq(CMipsJitter*, uint8, uint8, uint8, uint32);
-	void MULA(CMipsJitter*, uint8, uint8, uint8, uint32);
-	void MULAbc(CMipsJitter*, uint8, uint8, uint8, uint8, uint32);
-	void MULAi(CMipsJitter*, uint8, uint8, uint32);
-	void MULAq(CMipsJitter*, uint8, uint8, uint32);
-	void OPMSUB(CMipsJitter*, uint8, uint8, uint8, uint32);
+	void MUL(CMipsJitter*, uint8, uint8, uint8, uint8, uint32, bool);
+	void MULbc(CMipsJitter*, uint8, uint8, uint8, uint8, uint8, uint32, bool);
+	void MULi(CMipsJitter*, uint8, uint8, uint8, uint32, bool);
+	void MULq(CMipsJitter*, uint8, uint8, uint8, uint32, bool);
+	void MULA(CMipsJitter*, uint8, uint8, uint8, uint32, bool);
+	void MULAbc(CMipsJitter*, uint8, uint8, uint8, uint8, uint32, bool);
+	void MULAi(CMipsJitter*, uint8, uint8, uint32, bool);
+	void MULAq(CMipsJitter*, uint8, uint8, uint32, bool);
+	void OPMSUB(CMipsJitter*, uint8, uint8, uint8, uint32, bool);
 	void OPMULA(CMipsJitter*, uint8, uint8);
 	void RINIT(CMipsJitter*, uint8, uint8);
 	void RGET(CMipsJitter*, uint8, uint8);
@@ -184,13 +190,13 @@ namespace VUShared
 	void SQD(CMipsJitter*, uint8, uint8, uint8, uint32);
 	void SQI(CMipsJitter*, uint8, uint8, uint8, uint32);
 	void SQRT(CMipsJitter*, uint8, uint8, uint32);
-	void SUB(CMipsJitter*, uint8, uint8, uint8, uint8, uint32);
-	void SUBbc(CMipsJitter*, uint8, uint8, uint8, uint8, uint8, uint32);
-	void SUBi(CMipsJitter*, uint8, uint8, uint8, uint32);
-	void SUBq(CMipsJitter*, uint8, uint8, uint8, uint32);
-	void SUBA(CMipsJitter*, uint8, uint8, uint8, uint32);
-	void SUBAbc(CMipsJitter*, uint8, uint8, uint8, uint8, uint32);
-	void SUBAi(CMipsJitter*, uint8, uint8, uint32);
+	void SUB(CMipsJitter*, uint8, uint8, uint8, uint8, uint32, bool);
+	void SUBbc(CMipsJitter*, uint8, uint8, uint8, uint8, uint8, uint32, bool);
+	void SUBi(CMipsJitter*, uint8, uint8, uint8, uint32, bool);
+	void SUBq(CMipsJitter*, uint8, uint8, uint8, uint32, bool);
+	void SUBA(CMipsJitter*, uint8, uint8, uint8, uint32, bool);
+	void SUBAbc(CMipsJitter*, uint8, uint8, uint8, uint8, uint32, bool);
+	void SUBAi(CMipsJitter*, uint8, uint8, uint32, bool);
 	void WAITP(CMipsJitter*);
 	void WAITQ(CMipsJitter*);
 
@@ -242,6 +248,14 @@ namespace VUShared
 	void ReflOpAffWrQRdFt(VUINSTRUCTION*, CMIPS*, uint32, uint32, OPERANDSET&);
 	void ReflOpAffWrQRdFtFs(VUINSTRUCTION*, CMIPS*, uint32, uint32, OPERANDSET&);
 
+	//Same as above, for instructions that also update MAC flags
+	void ReflOpAffAccFsIMac(VUINSTRUCTION*, CMIPS*, uint32, uint32, OPERANDSET&);
+	void ReflOpAffFdFsQMac(VUINSTRUCTION*, CMIPS*, uint32, uint32, OPERANDSET&);
+	void ReflOpAffFdFsIMac(VUINSTRUCTION*, CMIPS*, uint32, uint32, OPERANDSET&);
+	void ReflOpAffWrARdFtFsMac(VUINSTRUCTION*, CMIPS*, uint32, uint32, OPERANDSET&);
+	void ReflOpAffWrARdFsQMac(VUINSTRUCTION*, CMIPS*, uint32, uint32, OPERANDSET&);
+	void ReflOpAffWrFdRdFtFsMac(VUINSTRUCTION*, CMIPS*, uint32, uint32, OPERANDSET&);
+
 	VUINSTRUCTION* DereferenceInstruction(VUSUBTABLE*, uint32);
 	void SubTableAffectedOperands(VUINSTRUCTION* pInstr, CMIPS* pCtx, uint32, uint32, OPERANDSET&);
 
@@ -422,3 +422,39 @@ void VUShared::ReflOpAffWrQRdFtFs(VUINSTRUCTION*, CMIPS*, uint32, uint32 opcode,
 	operandSet.readF1 = fs;
 	operandSet.syncQ = true;
 }
+
+void VUShared::ReflOpAffAccFsIMac(VUINSTRUCTION* pInstr, CMIPS* pCtx, uint32 nAddress, uint32 nOpcode, OPERANDSET& operandSet)
+{
+	ReflOpAffAccFsI(pInstr, pCtx, nAddress, nOpcode, operandSet);
+	operandSet.writeMACflags = true;
+}
+
+void VUShared::ReflOpAffFdFsQMac(VUINSTRUCTION* pInstr, CMIPS* pCtx, uint32 nAddress, uint32 nOpcode, OPERANDSET& operandSet)
+{
+	ReflOpAffFdFsQ(pInstr, pCtx, nAddress, nOpcode, operandSet);
+	operandSet.writeMACflags = true;
+}
+
+void VUShared::ReflOpAffFdFsIMac(VUINSTRUCTION* pInstr, CMIPS* pCtx, uint32 nAddress, uint32 nOpcode, OPERANDSET& operandSet)
+{
+	ReflOpAffFdFsI(pInstr, pCtx, nAddress, nOpcode, operandSet);
+	operandSet.writeMACflags = true;
+}
+
+void VUShared::ReflOpAffWrARdFtFsMac(VUINSTRUCTION* pInstr, CMIPS* pCtx, uint32 nAddress, uint32 nOpcode, OPERANDSET& operandSet)
+{
+	ReflOpAffWrARdFtFs(pInstr, pCtx, nAddress, nOpcode, operandSet);
+	operandSet.writeMACflags = true;
+}
+
+void VUShared::ReflOpAffWrARdFsQMac(VUINSTRUCTION* pInstr, CMIPS* pCtx, uint32 nAddress, uint32 nOpcode, OPERANDSET& operandSet)
+{
+	ReflOpAffWrARdFsQ(pInstr, pCtx, nAddress, nOpcode, operandSet);
+	operandSet.writeMACflags = true;
+}
+
+void VUShared::ReflOpAffWrFdRdFtFsMac(VUINSTRUCTION* pInstr, CMIPS* pCtx, uint32 nAddress, uint32 nOpcode, OPERANDSET& operandSet)
+{
+	ReflOpAffWrFdRdFtFs(pInstr, pCtx, nAddress, nOpcode, operandSet);
+	operandSet.writeMACflags = true;
+}
@@ -3,7 +3,7 @@
 #include <climits>
 #include <stdexcept>
 #include "string_format.h"
-#include "../Log.h"
+#include "../Trace.h"
 #include "../Ps2Const.h"
 #include "../states/RegisterStateFile.h"
 #include "../states/MemoryStateFile.h"
@@ -44,7 +44,7 @@ CVif::CVif(unsigned int number, CVpu& vpu, CINTC& intc, uint8* ram, uint8* spr)
     , m_intc(intc)
     , m_stream(ram, spr)
     , m_vpu(vpu)
-    , m_vifProfilerZone(CProfiler::GetInstance().RegisterZone(string_format("VIF%d", number).c_str()))
+    , m_vifProfilerZone(CProfiler::RegisterZone(string_format("VIF%d", number).c_str()))
 {
 }
 
@@ -131,9 +131,10 @@ uint32 CVif::GetRegister(uint32 address)
 		result = m_R[3];
 		break;
 	}
-#ifdef _DEBUG
-	DisassembleGet(address);
-#endif
+	if(CTrace::IsEnabled())
+	{
+		DisassembleGet(address);
+	}
 	return result;
 }
 
@@ -173,9 +174,10 @@ void CVif::SetRegister(uint32 address, uint32 value)
 			break;
 		}
 	}
-#ifdef _DEBUG
-	DisassembleSet(address, value);
-#endif
+	if(CTrace::IsEnabled())
+	{
+		DisassembleSet(address, value);
+	}
 }
 
 void CVif::SaveState(Framework::CZipArchiveWriter& archive)
@@ -265,10 +267,8 @@ uint32 CVif::ReceiveDMA(uint32 address, uint32 qwc, uint32 unused, bool tagInclu
 	CProfilerZone profilerZone(m_vifProfilerZone);
 #endif
 
-#ifdef _DEBUG
-	CLog::GetInstance().Print(LOG_NAME, "vif%i : Processing packet @ 0x%08X, qwc = 0x%X, tagIncluded = %i\r\n",
-	                          m_number, address, qwc, static_cast<int>(tagIncluded));
-#endif
+	TRACE_PRINT(LOG_NAME, "vif%i : Processing packet @ 0x%08X, qwc = 0x%X, tagIncluded = %i\r\n",
+	            m_number, address, qwc, static_cast<int>(tagIncluded));
 
 	m_stream.SetDmaParams(address, qwc * 0x10, tagIncluded);
 
@@ -286,6 +286,11 @@ bool CVif::IsWaitingForProgramEnd() const
 	return (m_STAT.nVEW != 0);
 }
 
+void CVif::SetFastUnpackEnabled(bool fastUnpackEnabled)
+{
+	m_fastUnpackEnabled = fastUnpackEnabled;
+}
+
 void CVif::ProcessFifoWrite(uint32 address, uint32 value)
 {
 	assert(m_fifoIndex != FIFO_SIZE);
@@ -371,12 +376,10 @@ void CVif::ProcessPacket(StreamType& stream)
 
 void CVif::ExecuteCommand(StreamType& stream, CODE nCommand)
 {
-#ifdef _DEBUG
-	if(m_number == 0)
+	if((m_number == 0) && CTrace::IsEnabled())
 	{
 		DisassembleCommand(nCommand);
 	}
-#endif
 	if(nCommand.nCMD >= 0x60)
 	{
 #ifdef DELAYED_MSCAL
@@ -636,6 +639,13 @@ void CVif::Cmd_UNPACK(StreamType& stream, CODE nCommand, uint32 nDstAddr)
 	assert(nDstAddr < vuMemSize);
 	nDstAddr &= (vuMemSize - 1);
 
+	//Process as much as possible with the specialized kernels, the loop below
+	//takes care of what remains (partial elements, filling write cycles)
+	if(m_fastUnpackEnabled && (cl >= wl))
+	{
+		nDstAddr = Unpack_Fast(stream, nCommand, nDstAddr, currentNum, usn, useMask, cl, wl);
+	}
+
 	while(currentNum != 0)
 	{
 		bool mustWrite = false;
@@ -986,9 +996,9 @@ bool CVif::ResumeDelayedMicroProgram()
 
 void CVif::DisassembleGet(uint32 address)
 {
-#define LOG_GET(registerId)                                            \
-	case registerId:                                                   \
-		CLog::GetInstance().Print(LOG_NAME, "= " #registerId ".\r\n"); \
+#define LOG_GET(registerId)                              \
+	case registerId:                                     \
+		TRACE_PRINT(LOG_NAME, "= " #registerId ".\r\n"); \
 		break;
 
 	switch(address)
@@ -1018,7 +1028,7 @@ void CVif::DisassembleGet(uint32 address)
 		LOG_GET(VIF1_R3)
 
 	default:
-		CLog::GetInstance().Print(LOG_NAME, "Reading unknown register 0x%08X.\r\n", address);
+		TRACE_PRINT(LOG_NAME, "Reading unknown register 0x%08X.\r\n", address);
 		break;
 	}
 
@@ -1029,17 +1039,17 @@ void CVif::DisassembleSet(uint32 address, uint32 value)
 {
 	if((address >= VIF0_FIFO_START) && (address < VIF0_FIFO_END))
 	{
-		CLog::GetInstance().Print(LOG_NAME, "VIF0_FIFO(0x%03X) = 0x%08X.\r\n", address & 0xFFF, value);
+		TRACE_PRINT(LOG_NAME, "VIF0_FIFO(0x%03X) = 0x%08X.\r\n", address & 0xFFF, value);
 	}
 	else if((address >= VIF1_FIFO_START) && (address < VIF1_FIFO_END))
 	{
-		CLog::GetInstance().Print(LOG_NAME, "VIF1_FIFO(0x%03X) = 0x%08X.\r\n", address & 0xFFF, value);
+		TRACE_PRINT(LOG_NAME, "VIF1_FIFO(0x%03X) = 0x%08X.\r\n", address & 0xFFF, value);
 	}
 	else
 	{
-#define LOG_SET(registerId)                                                       \
-	case registerId:                                                              \
-		CLog::GetInstance().Print(LOG_NAME, #registerId " = 0x%08X.\r\n", value); \
+#define LOG_SET(registerId)                                         \
+	case registerId:                                                \
+		TRACE_PRINT(LOG_NAME, #registerId " = 0x%08X.\r\n", value); \
 		break;
 
 		switch(address)
@@ -1051,7 +1061,7 @@ void CVif::DisassembleSet(uint32 address, uint32 value)
 			LOG_SET(VIF1_MARK)
 
 		default:
-			CLog::GetInstance().Print(LOG_NAME, "Writing unknown register 0x%08X, 0x%08X.\r\n", address, value);
+			TRACE_PRINT(LOG_NAME, "Writing unknown register 0x%08X, 0x%08X.\r\n", address, value);
 			break;
 		}
 
@@ -1063,11 +1073,11 @@ void CVif::DisassembleCommand(CODE code)
 {
 	if(m_STAT.nVPS != 0) return;
 
-	CLog::GetInstance().Print(LOG_NAME, "vif%i : ", m_number);
+	TRACE_PRINT(LOG_NAME, "vif%i : ", m_number);
 
 	if(code.nI)
 	{
-		CLog::GetInstance().Print(LOG_NAME, "(I) ");
+		TRACE_PRINT(LOG_NAME, "(I) ");
 	}
 
 	if(code.nCMD >= 0x60)
@@ -1090,75 +1100,75 @@ void CVif::DisassembleCommand(CODE code)
 		        "V4-16",
 		        "V4-8",
 		        "V4-5"};
-		CLog::GetInstance().Print(LOG_NAME, "UNPACK(format = %s, imm = 0x%x, num = 0x%x);\r\n",
-		                          packFormats[code.nCMD & 0x0F], code.nIMM, code.nNUM);
+		TRACE_PRINT(LOG_NAME, "UNPACK(format = %s, imm = 0x%x, num = 0x%x);\r\n",
+		            packFormats[code.nCMD & 0x0F], code.nIMM, code.nNUM);
 	}
 	else
 	{
 		switch(code.nCMD)
 		{
 		case 0x00:
-			CLog::GetInstance().Print(LOG_NAME, "NOP\r\n");
+			TRACE_PRINT(LOG_NAME, "NOP\r\n");
 			break;
 		case 0x01:
-			CLog::GetInstance().Print(LOG_NAME, "STCYCL(imm = 0x%x);\r\n", code.nIMM);
+			TRACE_PRINT(LOG_NAME, "STCYCL(imm = 0x%x);\r\n", code.nIMM);
 			break;
 		case 0x02:
-			CLog::GetInstance().Print(LOG_NAME, "OFFSET(imm = 0x%x);\r\n", code.nIMM);
+			TRACE_PRINT(LOG_NAME, "OFFSET(imm = 0x%x);\r\n", code.nIMM);
 			break;
 		case 0x03:
-			CLog::GetInstance().Print(LOG_NAME, "BASE(imm = 0x%x);\r\n", code.nIMM);
+			TRACE_PRINT(LOG_NAME, "BASE(imm = 0x%x);\r\n", code.nIMM);
 			break;
 		case 0x04:
-			CLog::GetInstance().Print(LOG_NAME, "ITOP(imm = 0x%x);\r\n", code.nIMM);
+			TRACE_PRINT(LOG_NAME, "ITOP(imm = 0x%x);\r\n", code.nIMM);
 			break;
 		case 0x05:
-			CLog::GetInstance().Print(LOG_NAME, "STMOD(imm = 0x%x);\r\n", code.nIMM);
+			TRACE_PRINT(LOG_NAME, "STMOD(imm = 0x%x);\r\n", code.nIMM);
 			break;
 		case 0x06:
-			CLog::GetInstance().Print(LOG_NAME, "MSKPATH3(mask = %d);\r\n", (code.nIMM & 0x8000) ? 1 : 0);
+			TRACE_PRINT(LOG_NAME, "MSKPATH3(mask = %d);\r\n", (code.nIMM & 0x8000) ? 1 : 0);
 			break;
 		case 0x07:
-			CLog::GetInstance().Print(LOG_NAME, "MARK(imm = 0x%x);\r\n", code.nIMM);
+			TRACE_PRINT(LOG_NAME, "MARK(imm = 0x%x);\r\n", code.nIMM);
 			break;
 		case 0x10:
-			CLog::GetInstance().Print(LOG_NAME, "FLUSHE();\r\n");
+			TRACE_PRINT(LOG_NAME, "FLUSHE();\r\n");
 			break;
 		case 0x11:
-			CLog::GetInstance().Print(LOG_NAME, "FLUSH();\r\n");
+			TRACE_PRINT(LOG_NAME, "FLUSH();\r\n");
 			break;
 		case 0x13:
-			CLog::GetInstance().Print(LOG_NAME, "FLUSHA();\r\n");
+			TRACE_PRINT(LOG_NAME, "FLUSHA();\r\n");
 			break;
 		case 0x14:
-			CLog::GetInstance().Print(LOG_NAME, "MSCAL(imm = 0x%x);\r\n", code.nIMM);
+			TRACE_PRINT(LOG_NAME, "MSCAL(imm = 0x%x);\r\n", code.nIMM);
 			break;
 		case 0x15:
-			CLog::GetInstance().Print(LOG_NAME, "MSCALF(imm = 0x%x);\r\n", code.nIMM);
+			TRACE_PRINT(LOG_NAME, "MSCALF(imm = 0x%x);\r\n", code.nIMM);
 			break;
 		case 0x17:
-			CLog::GetInstance().Print(LOG_NAME, "MSCNT();\r\n");
+			TRACE_PRINT(LOG_NAME, "MSCNT();\r\n");
 			break;
 		case 0x20:
-			CLog::GetInstance().Print(LOG_NAME, "STMASK();\r\n");
+			TRACE_PRINT(LOG_NAME, "STMASK();\r\n");
 			break;
 		case 0x30:
-			CLog::GetInstance().Print(LOG_NAME, "STROW();\r\n");
+			TRACE_PRINT(LOG_NAME, "STROW();\r\n");
 			break;
 		case 0x31:
-			CLog::GetInstance().Print(LOG_NAME, "STCOL();\r\n");
+			TRACE_PRINT(LOG_NAME, "STCOL();\r\n");
 			break;
 		case 0x4A:
-			CLog::GetInstance().Print(LOG_NAME, "MPG(imm = 0x%x, num = 0x%x);\r\n", code.nIMM, code.nNUM);
+			TRACE_PRINT(LOG_NAME, "MPG(imm = 0x%x, num = 0x%x);\r\n", code.nIMM, code.nNUM);
 			break;
 		case 0x50:
-			CLog::GetInstance().Print(LOG_NAME, "DIRECT(imm = 0x%x);\r\n", code.nIMM);
+			TRACE_PRINT(LOG_NAME, "DIRECT(imm = 0x%x);\r\n", code.nIMM);
 			break;
 		case 0x51:
-			CLog::GetInstance().Print(LOG_NAME, "DIRECTHL(imm = 0x%x);\r\n", code.nIMM);
+			TRACE_PRINT(LOG_NAME, "DIRECTHL(imm = 0x%x);\r\n", code.nIMM);
 			break;
 		default:
-			CLog::GetInstance().Print(LOG_NAME, "Unknown command (0x%x).\r\n", code.nCMD);
+			TRACE_PRINT(LOG_NAME, "Unknown command (0x%x).\r\n", code.nCMD);
 			break;
 		}
 	}
@@ -69,6 +69,9 @@ public:
 
 	bool IsWaitingForProgramEnd() const;
 
+	//Specialized UNPACK kernels are used by default, the generic path can be forced for comparison
+	void SetFastUnpackEnabled(bool);
+
 protected:
 	enum
 	{
@@ -204,6 +207,10 @@ protected:
 	bool Unpack_V32(StreamType&, uint128&, unsigned int);
 	bool Unpack_V45(StreamType&, uint128&);
 
+	uint32 Unpack_Fast(StreamType&, CODE, uint32, uint32&, bool, bool, uint32, uint32);
+	template <uint32, bool, bool, uint32>
+	uint32 Unpack_Kernel(const uint8*, uint32, uint32, uint32, uint32);
+
 	uint32 GetMaskOp(unsigned int, unsigned int) const;
 
 	virtual void PrepareMicroProgram();
@@ -245,5 +252,7 @@ protected:
 	CODE m_previousCODE;
 #endif
 
+	bool m_fastUnpackEnabled = true;
+
 	CProfiler::ZoneHandle m_vifProfilerZone = 0;
 };
@@ -3,6 +3,7 @@
 #include "string_format.h"
 #include "../states/RegisterStateFile.h"
 #include "../FrameDump.h"
+#include "../Trace.h"
 #include "GIF.h"
 #include "Dmac_Channel.h"
 #include "Vpu.h"
@@ -81,6 +82,8 @@ uint32 CVif1::ReceiveDMA(uint32 address, uint32 qwc, uint32 direction, bool tagI
 			address &= (PS2::EE_RAM_SIZE - 1);
 			assert((address + size) <= PS2::EE_RAM_SIZE);
 		}
+		//Make sure everything the VU kicked reached the GS
+		m_vpu.WaitForMicroProgram();
 		auto gs = m_gif.GetGsHandler();
 		gs->ReadImageData(source + address, size);
 		return qwc;
@@ -93,9 +96,10 @@ uint32 CVif1::ReceiveDMA(uint32 address, uint32 qwc, uint32 direction, bool tagI
 
 void CVif1::ExecuteCommand(StreamType& stream, CODE nCommand)
 {
-#ifdef _DEBUG
-	DisassembleCommand(nCommand);
-#endif
+	if(CTrace::IsEnabled())
+	{
+		DisassembleCommand(nCommand);
+	}
 	switch(nCommand.nCMD)
 	{
 	case 0x02:
@@ -160,6 +164,8 @@ void CVif1::Cmd_DIRECT(StreamType& stream, CODE nCommand)
 
 	if(nSize != 0)
 	{
+		//PATH2 packets must come after the ones the running microprogram kicked
+		m_vpu.WaitForMicroProgram();
 		auto packet = stream.GetDirectPointer();
 		uint32 processed = m_gif.ProcessMultiplePackets(packet, 0, nSize, CGsPacketMetadata(2));
 		assert(processed <= nSize);
@@ -187,6 +193,8 @@ void CVif1::Cmd_UNPACK(StreamType& stream, CODE nCommand, uint32 nDstAddr)
 		nDstAddr += m_TOPS;
 	}
 
+	//Running microprogram must finish with the data it had, as if it had run to completion on MSCAL
+	m_vpu.WaitForMicroProgram();
 	return CVif::Cmd_UNPACK(stream, nCommand, nDstAddr);
 }
 
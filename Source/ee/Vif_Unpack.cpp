@@ -0,0 +1,613 @@
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include "Vpu.h"
+#include "Vif.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define VIF_UNPACK_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define VIF_UNPACK_NEON
+#endif
+
+//Specialized UNPACK kernels. Each combination of format, sign extension, masking and
+//addition mode gets its own kernel that reads elements directly from the stream's memory.
+//They must produce exactly the same results as the generic path in Vif.cpp.
+
+namespace
+{
+#if defined(VIF_UNPACK_SSE2)
+
+	typedef __m128i UnpackVector;
+
+	UnpackVector LoadVector(const void* src)
+	{
+		return _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+	}
+
+	void StoreVector(void* dst, UnpackVector value)
+	{
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst), value);
+	}
+
+	UnpackVector SplatVector(uint32 value)
+	{
+		return _mm_set1_epi32(value);
+	}
+
+	UnpackVector AddVector(UnpackVector lhs, UnpackVector rhs)
+	{
+		return _mm_add_epi32(lhs, rhs);
+	}
+
+	UnpackVector AndVector(UnpackVector lhs, UnpackVector rhs)
+	{
+		return _mm_and_si128(lhs, rhs);
+	}
+
+	UnpackVector OrVector(UnpackVector lhs, UnpackVector rhs)
+	{
+		return _mm_or_si128(lhs, rhs);
+	}
+
+	//Picks lanes from 'a' where mask is set, from 'b' otherwise
+	UnpackVector SelectVector(UnpackVector mask, UnpackVector a, UnpackVector b)
+	{
+		return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+	}
+
+	//Expands 4 halfwords (8 bytes) to 4 words
+	template <bool zeroExtend>
+	UnpackVector Widen16(const uint8* src)
+	{
+		auto value = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src));
+		if(zeroExtend)
+		{
+			return _mm_unpacklo_epi16(value, _mm_setzero_si128());
+		}
+		else
+		{
+			return _mm_srai_epi32(_mm_unpacklo_epi16(value, value), 16);
+		}
+	}
+
+	//Expands 4 bytes to 4 words
+	template <bool zeroExtend>
+	UnpackVector Widen8(const uint8* src)
+	{
+		uint32 bytes = 0;
+		memcpy(&bytes, src, 4);
+		auto value = _mm_cvtsi32_si128(bytes);
+		if(zeroExtend)
+		{
+			auto zero = _mm_setzero_si128();
+			return _mm_unpacklo_epi16(_mm_unpacklo_epi8(value, zero), zero);
+		}
+		else
+		{
+			value = _mm_unpacklo_epi8(value, value);
+			return _mm_srai_epi32(_mm_unpacklo_epi16(value, value), 24);
+		}
+	}
+
+#elif defined(VIF_UNPACK_NEON)
+
+	typedef uint32x4_t UnpackVector;
+
+	UnpackVector LoadVector(const void* src)
+	{
+		return vreinterpretq_u32_u8(vld1q_u8(reinterpret_cast<const uint8*>(src)));
+	}
+
+	void StoreVector(void* dst, UnpackVector value)
+	{
+		vst1q_u8(reinterpret_cast<uint8*>(dst), vreinterpretq_u8_u32(value));
+	}
+
+	UnpackVector SplatVector(uint32 value)
+	{
+		return vdupq_n_u32(value);
+	}
+
+	UnpackVector AddVector(UnpackVector lhs, UnpackVector rhs)
+	{
+		return vaddq_u32(lhs, rhs);
+	}
+
+	UnpackVector AndVector(UnpackVector lhs, UnpackVector rhs)
+	{
+		return vandq_u32(lhs, rhs);
+	}
+
+	UnpackVector OrVector(UnpackVector lhs, UnpackVector rhs)
+	{
+		return vorrq_u32(lhs, rhs);
+	}
+
+	UnpackVector SelectVector(UnpackVector mask, UnpackVector a, UnpackVector b)
+	{
+		return vbslq_u32(mask, a, b);
+	}
+
+	template <bool zeroExtend>
+	UnpackVector Widen16(const uint8* src)
+	{
+		auto value = vld1_u8(src);
+		if(zeroExtend)
+		{
+			return vmovl_u16(vreinterpret_u16_u8(value));
+		}
+		else
+		{
+			return vreinterpretq_u32_s32(vmovl_s16(vreinterpret_s16_u8(value)));
+		}
+	}
+
+	template <bool zeroExtend>
+	UnpackVector Widen8(const uint8* src)
+	{
+		uint8 bytes[8] = {};
+		memcpy(bytes, src, 4);
+		auto value = vld1_u8(bytes);
+		if(zeroExtend)
+		{
+			return vmovl_u16(vget_low_u16(vmovl_u8(value)));
+		}
+		else
+		{
+			return vreinterpretq_u32_s32(vmovl_s16(vget_low_s16(vmovl_s8(vreinterpret_s8_u8(value)))));
+		}
+	}
+
+#else
+
+	struct UnpackVector
+	{
+		uint32 nV[4];
+	};
+
+	UnpackVector LoadVector(const void* src)
+	{
+		UnpackVector result;
+		memcpy(&result, src, sizeof(UnpackVector));
+		return result;
+	}
+
+	void StoreVector(void* dst, UnpackVector value)
+	{
+		memcpy(dst, &value, sizeof(UnpackVector));
+	}
+
+	UnpackVector SplatVector(uint32 value)
+	{
+		return UnpackVector{{value, value, value, value}};
+	}
+
+	UnpackVector AddVector(UnpackVector lhs, UnpackVector rhs)
+	{
+		for(unsigned int i = 0; i < 4; i++)
+		{
+			lhs.nV[i] += rhs.nV[i];
+		}
+		return lhs;
+	}
+
+	UnpackVector AndVector(UnpackVector lhs, UnpackVector rhs)
+	{
+		for(unsigned int i = 0; i < 4; i++)
+		{
+			lhs.nV[i] &= rhs.nV[i];
+		}
+		return lhs;
+	}
+
+	UnpackVector OrVector(UnpackVector lhs, UnpackVector rhs)
+	{
+		for(unsigned int i = 0; i < 4; i++)
+		{
+			lhs.nV[i] |= rhs.nV[i];
+		}
+		return lhs;
+	}
+
+	UnpackVector SelectVector(UnpackVector mask, UnpackVector a, UnpackVector b)
+	{
+		for(unsigned int i = 0; i < 4; i++)
+		{
+			a.nV[i] = (a.nV[i] & mask.nV[i]) | (b.nV[i] & ~mask.nV[i]);
+		}
+		return a;
+	}
+
+	template <bool zeroExtend>
+	UnpackVector Widen16(const uint8* src)
+	{
+		UnpackVector result;
+		for(unsigned int i = 0; i < 4; i++)
+		{
+			uint16 value = 0;
+			memcpy(&value, src + (i * 2), 2);
+			result.nV[i] = zeroExtend ? value : static_cast<int16>(value);
+		}
+		return result;
+	}
+
+	template <bool zeroExtend>
+	UnpackVector Widen8(const uint8* src)
+	{
+		UnpackVector result;
+		for(unsigned int i = 0; i < 4; i++)
+		{
+			result.nV[i] = zeroExtend ? src[i] : static_cast<int8>(src[i]);
+		}
+		return result;
+	}
+
+#endif
+
+	//Element decoders, fields that are not present in the source are set to 0
+
+	struct UNPACK_S32
+	{
+		enum
+		{
+			ELEMENT_SIZE = 4
+		};
+
+		static UnpackVector Decode(const uint8* src)
+		{
+			uint32 value = 0;
+			memcpy(&value, src, 4);
+			return SplatVector(value);
+		}
+	};
+
+	template <bool zeroExtend>
+	struct UNPACK_S16
+	{
+		enum
+		{
+			ELEMENT_SIZE = 2
+		};
+
+		static UnpackVector Decode(const uint8* src)
+		{
+			uint16 value = 0;
+			memcpy(&value, src, 2);
+			return SplatVector(zeroExtend ? value : static_cast<int16>(value));
+		}
+	};
+
+	template <bool zeroExtend>
+	struct UNPACK_S8
+	{
+		enum
+		{
+			ELEMENT_SIZE = 1
+		};
+
+		static UnpackVector Decode(const uint8* src)
+		{
+			return SplatVector(zeroExtend ? src[0] : static_cast<int8>(src[0]));
+		}
+	};
+
+	template <unsigned int fields>
+	struct UNPACK_V32
+	{
+		enum
+		{
+			ELEMENT_SIZE = fields * 4
+		};
+
+		static UnpackVector Decode(const uint8* src)
+		{
+			uint8 value[0x10] = {};
+			memcpy(value, src, ELEMENT_SIZE);
+			return LoadVector(value);
+		}
+	};
+
+	template <>
+	struct UNPACK_V32<4>
+	{
+		enum
+		{
+			ELEMENT_SIZE = 0x10
+		};
+
+		static UnpackVector Decode(const uint8* src)
+		{
+			return LoadVector(src);
+		}
+	};
+
+	template <unsigned int fields, bool zeroExtend>
+	struct UNPACK_V16
+	{
+		enum
+		{
+			ELEMENT_SIZE = fields * 2
+		};
+
+		static UnpackVector Decode(const uint8* src)
+		{
+			uint8 value[8] = {};
+			memcpy(value, src, ELEMENT_SIZE);
+			return Widen16<zeroExtend>(value);
+		}
+	};
+
+	template <unsigned int fields, bool zeroExtend>
+	struct UNPACK_V8
+	{
+		enum
+		{
+			ELEMENT_SIZE = fields
+		};
+
+		static UnpackVector Decode(const uint8* src)
+		{
+			uint8 value[4] = {};
+			memcpy(value, src, ELEMENT_SIZE);
+			return Widen8<zeroExtend>(value);
+		}
+	};
+
+	struct UNPACK_V45
+	{
+		enum
+		{
+			ELEMENT_SIZE = 2
+		};
+
+		static UnpackVector Decode(const uint8* src)
+		{
+			uint16 color = 0;
+			memcpy(&color, src, 2);
+			uint32 value[4] =
+			    {
+			        static_cast<uint32>(((color >> 0) & 0x1F) << 3),
+			        static_cast<uint32>(((color >> 5) & 0x1F) << 3),
+			        static_cast<uint32>(((color >> 10) & 0x1F) << 3),
+			        static_cast<uint32>(((color >> 15) & 0x01) << 7),
+			    };
+			return LoadVector(value);
+		}
+	};
+
+	//Maps the format bits of the UNPACK command to a decoder
+	template <uint32 format, bool zeroExtend>
+	struct UNPACK_FORMAT;
+
+	// clang-format off
+	template <bool zeroExtend> struct UNPACK_FORMAT<0x00, zeroExtend> : public UNPACK_S32 {};
+	template <bool zeroExtend> struct UNPACK_FORMAT<0x01, zeroExtend> : public UNPACK_S16<zeroExtend> {};
+	template <bool zeroExtend> struct UNPACK_FORMAT<0x02, zeroExtend> : public UNPACK_S8<zeroExtend> {};
+	template <bool zeroExtend> struct UNPACK_FORMAT<0x04, zeroExtend> : public UNPACK_V32<2> {};
+	template <bool zeroExtend> struct UNPACK_FORMAT<0x05, zeroExtend> : public UNPACK_V16<2, zeroExtend> {};
+	template <bool zeroExtend> struct UNPACK_FORMAT<0x06, zeroExtend> : public UNPACK_V8<2, zeroExtend> {};
+	template <bool zeroExtend> struct UNPACK_FORMAT<0x08, zeroExtend> : public UNPACK_V32<3> {};
+	template <bool zeroExtend> struct UNPACK_FORMAT<0x09, zeroExtend> : public UNPACK_V16<3, zeroExtend> {};
+	template <bool zeroExtend> struct UNPACK_FORMAT<0x0A, zeroExtend> : public UNPACK_V8<3, zeroExtend> {};
+	template <bool zeroExtend> struct UNPACK_FORMAT<0x0C, zeroExtend> : public UNPACK_V32<4> {};
+	template <bool zeroExtend> struct UNPACK_FORMAT<0x0D, zeroExtend> : public UNPACK_V16<4, zeroExtend> {};
+	template <bool zeroExtend> struct UNPACK_FORMAT<0x0E, zeroExtend> : public UNPACK_V8<4, zeroExtend> {};
+	template <bool zeroExtend> struct UNPACK_FORMAT<0x0F, zeroExtend> : public UNPACK_V45 {};
+	// clang-format on
+
+	//Element size for each format, 0 for invalid formats
+	const uint32 g_unpackElementSizes[0x10] =
+	    {
+	        4, 2, 1, 0,
+	        8, 4, 2, 0,
+	        12, 6, 3, 0,
+	        16, 8, 4, 2};
+
+	//Lane selectors for one column of the MASK register
+	struct UNPACK_MASK
+	{
+		UnpackVector data;
+		UnpackVector row;
+		UnpackVector keep;
+		UnpackVector column;
+	};
+
+	template <uint32 mode>
+	UnpackVector ApplyMode(UnpackVector value, UnpackVector& row, UnpackVector dataLanes)
+	{
+		return value;
+	}
+
+	template <>
+	UnpackVector ApplyMode<1>(UnpackVector value, UnpackVector& row, UnpackVector dataLanes)
+	{
+		return AddVector(value, row);
+	}
+
+	template <>
+	UnpackVector ApplyMode<2>(UnpackVector value, UnpackVector& row, UnpackVector dataLanes)
+	{
+		value = AddVector(value, row);
+		row = SelectVector(dataLanes, value, row);
+		return value;
+	}
+}
+
+template <uint32 format, bool usn, bool useMask, uint32 mode>
+uint32 CVif::Unpack_Kernel(const uint8* src, uint32 dstAddr, uint32 count, uint32 cl, uint32 wl)
+{
+	typedef UNPACK_FORMAT<format, usn> Format;
+
+	static_assert(MODE_OFFSET == 1, "MODE_OFFSET must match ApplyMode specialization.");
+	static_assert(MODE_DIFFERENCE == 2, "MODE_DIFFERENCE must match ApplyMode specialization.");
+
+	assert(cl >= wl);
+
+	auto vuMem = m_vpu.GetVuMemory();
+	uint32 vuMemMask = m_vpu.GetVuMemorySize() - 1;
+	auto row = LoadVector(m_R);
+	auto allLanes = SplatVector(~0U);
+	uint32 readTick = m_readTick;
+	uint32 writeTick = m_writeTick;
+
+	if(!useMask && (cl == wl) && (readTick == writeTick))
+	{
+		//Every element goes to the next quadword, ticks only need to be updated at the end
+		uint32 tickCount = count % cl;
+		for(; count >= 4; count -= 4)
+		{
+			auto value0 = ApplyMode<mode>(Format::Decode(src + (Format::ELEMENT_SIZE * 0)), row, allLanes);
+			auto value1 = ApplyMode<mode>(Format::Decode(src + (Format::ELEMENT_SIZE * 1)), row, allLanes);
+			auto value2 = ApplyMode<mode>(Format::Decode(src + (Format::ELEMENT_SIZE * 2)), row, allLanes);
+			auto value3 = ApplyMode<mode>(Format::Decode(src + (Format::ELEMENT_SIZE * 3)), row, allLanes);
+			StoreVector(vuMem + dstAddr, value0);
+			dstAddr = (dstAddr + 0x10) & vuMemMask;
+			StoreVector(vuMem + dstAddr, value1);
+			dstAddr = (dstAddr + 0x10) & vuMemMask;
+			StoreVector(vuMem + dstAddr, value2);
+			dstAddr = (dstAddr + 0x10) & vuMemMask;
+			StoreVector(vuMem + dstAddr, value3);
+			dstAddr = (dstAddr + 0x10) & vuMemMask;
+			src += Format::ELEMENT_SIZE * 4;
+		}
+		for(; count != 0; count--)
+		{
+			auto value = ApplyMode<mode>(Format::Decode(src), row, allLanes);
+			StoreVector(vuMem + dstAddr, value);
+			dstAddr = (dstAddr + 0x10) & vuMemMask;
+			src += Format::ELEMENT_SIZE;
+		}
+		readTick = (readTick + tickCount) % cl;
+		writeTick = readTick;
+	}
+	else
+	{
+		UNPACK_MASK masks[4];
+		if(useMask)
+		{
+			for(unsigned int col = 0; col < 4; col++)
+			{
+				uint32 dataLanes[4], rowLanes[4], keepLanes[4], columnValues[4];
+				for(unsigned int i = 0; i < 4; i++)
+				{
+					uint32 maskOp = GetMaskOp(i, col);
+					dataLanes[i] = (maskOp == MASK_DATA) ? ~0U : 0;
+					rowLanes[i] = (maskOp == MASK_ROW) ? ~0U : 0;
+					keepLanes[i] = (maskOp == MASK_MASK) ? ~0U : 0;
+					columnValues[i] = (maskOp == MASK_COL) ? m_C[col] : 0;
+				}
+				masks[col].data = LoadVector(dataLanes);
+				masks[col].row = LoadVector(rowLanes);
+				masks[col].keep = LoadVector(keepLanes);
+				masks[col].column = LoadVector(columnValues);
+			}
+		}
+
+		while(count != 0)
+		{
+			if(readTick < wl)
+			{
+				auto value = Format::Decode(src);
+				auto dst = vuMem + dstAddr;
+				src += Format::ELEMENT_SIZE;
+				if(useMask)
+				{
+					const auto& mask = masks[std::min<uint32>(writeTick, 3)];
+					value = ApplyMode<mode>(value, row, mask.data);
+					value = OrVector(
+					    OrVector(AndVector(value, mask.data), AndVector(row, mask.row)),
+					    OrVector(AndVector(LoadVector(dst), mask.keep), mask.column));
+				}
+				else
+				{
+					value = ApplyMode<mode>(value, row, allLanes);
+				}
+				StoreVector(dst, value);
+				count--;
+			}
+
+			writeTick = std::min<uint32>(writeTick + 1, wl);
+			readTick = std::min<uint32>(readTick + 1, cl);
+
+			if(readTick == cl)
+			{
+				writeTick = 0;
+				readTick = 0;
+			}
+
+			dstAddr = (dstAddr + 0x10) & vuMemMask;
+		}
+	}
+
+	if(mode == MODE_DIFFERENCE)
+	{
+		StoreVector(m_R, row);
+	}
+
+	m_readTick = readTick;
+	m_writeTick = writeTick;
+
+	return dstAddr;
+}
+
+// clang-format off
+#define UNPACK_KERNELS_MODE(format, usn, useMask) \
+	{ &CVif::Unpack_Kernel<format, usn, useMask, MODE_NORMAL>, &CVif::Unpack_Kernel<format, usn, useMask, MODE_OFFSET>, &CVif::Unpack_Kernel<format, usn, useMask, MODE_DIFFERENCE> }
+#define UNPACK_KERNELS_MASK(format, usn) { UNPACK_KERNELS_MODE(format, usn, false), UNPACK_KERNELS_MODE(format, usn, true) }
+#define UNPACK_KERNELS(format) { UNPACK_KERNELS_MASK(format, false), UNPACK_KERNELS_MASK(format, true) }
+#define UNPACK_KERNELS_INVALID { { { nullptr, nullptr, nullptr }, { nullptr, nullptr, nullptr } }, { { nullptr, nullptr, nullptr }, { nullptr, nullptr, nullptr } } }
+// clang-format on
+
+//Processes all the complete elements available in the stream, returns the updated destination address
+uint32 CVif::Unpack_Fast(StreamType& stream, CODE command, uint32 dstAddr, uint32& currentNum, bool usn, bool useMask, uint32 cl, uint32 wl)
+{
+	typedef uint32 (CVif::*UnpackKernel)(const uint8*, uint32, uint32, uint32, uint32);
+
+	//Indexed by format, usn, mask and mode
+	static const UnpackKernel kernels[0x10][2][2][3] =
+	    {
+	        UNPACK_KERNELS(0x00),
+	        UNPACK_KERNELS(0x01),
+	        UNPACK_KERNELS(0x02),
+	        UNPACK_KERNELS_INVALID,
+	        UNPACK_KERNELS(0x04),
+	        UNPACK_KERNELS(0x05),
+	        UNPACK_KERNELS(0x06),
+	        UNPACK_KERNELS_INVALID,
+	        UNPACK_KERNELS(0x08),
+	        UNPACK_KERNELS(0x09),
+	        UNPACK_KERNELS(0x0A),
+	        UNPACK_KERNELS_INVALID,
+	        UNPACK_KERNELS(0x0C),
+	        UNPACK_KERNELS(0x0D),
+	        UNPACK_KERNELS(0x0E),
+	        UNPACK_KERNELS(0x0F),
+	    };
+
+	uint32 format = command.nCMD & 0x0F;
+	uint32 elementSize = g_unpackElementSizes[format];
+	if(elementSize == 0)
+	{
+		return dstAddr;
+	}
+
+	uint32 count = std::min<uint32>(currentNum, stream.GetAvailableReadBytes() / elementSize);
+	if(count == 0)
+	{
+		return dstAddr;
+	}
+
+	//MODE 3 behaves like MODE_NORMAL
+	uint32 modeIndex = ((m_MODE == MODE_OFFSET) || (m_MODE == MODE_DIFFERENCE)) ? m_MODE : MODE_NORMAL;
+	auto kernel = kernels[format][usn ? 1 : 0][useMask ? 1 : 0][modeIndex];
+	assert(kernel);
+
+	dstAddr = (this->*kernel)(stream.GetDirectPointer(), dstAddr, count, cl, wl);
+	stream.Read(nullptr, count * elementSize);
+	currentNum -= count;
+
+	return dstAddr;
+}
@@ -18,7 +18,7 @@ CVpu::CVpu(unsigned int number, const VPUINIT& vpuInit, CGIF& gif, CINTC& intc,
     , m_vuMemSize((number == 0) ? PS2::VUMEM0SIZE : PS2::VUMEM1SIZE)
     , m_ctx(vpuInit.context)
     , m_gif(gif)
-    , m_vuProfilerZone(CProfiler::GetInstance().RegisterZone("VU"))
+    , m_vuProfilerZone(CProfiler::RegisterZone("VU"))
 #ifdef DEBUGGER_INCLUDED
     , m_microMemMiniState(new uint8[(number == 0) ? PS2::MICROMEM0SIZE : PS2::MICROMEM1SIZE])
     , m_vuMemMiniState(new uint8[(number == 0) ? PS2::VUMEM0SIZE : PS2::VUMEM1SIZE])
@@ -38,12 +38,26 @@ CVpu::~CVpu()
 
 void CVpu::Execute(int32 quota)
 {
+	if(m_worker)
+	{
+		//Send what the program kicked so far, it's only continued here if the worker
+		//gave up on it (same budget as ExecuteMicroProgram in the non threaded case)
+		bool busy = m_worker->IsBusy();
+		FlushXgKicks();
+		if(busy) return;
+	}
+
 	if(!m_running) return;
 
 #ifdef PROFILE
 	CProfilerZone profilerZone(m_vuProfilerZone);
 #endif
 
+	ExecuteSlice(quota);
+}
+
+void CVpu::ExecuteSlice(int32 quota)
+{
 	m_ctx->m_executor->Execute(quota);
 	if(m_ctx->m_State.nHasException)
 	{
@@ -93,6 +107,11 @@ uint32 CVpu::GetVuItopMiniState() const
 
 void CVpu::Reset()
 {
+	if(m_worker)
+	{
+		m_worker->Wait();
+		m_worker->TakeXgKicks(m_xgKickPackets);
+	}
 	m_running = false;
 	m_ctx->m_executor->Reset();
 	m_vif->Reset();
@@ -130,6 +149,7 @@ uint32 CVpu::GetVuMemorySize() const
 
 bool CVpu::IsVuRunning() const
 {
+	WaitForMicroProgram();
 	return m_running;
 }
 
@@ -146,6 +166,12 @@ void CVpu::ExecuteMicroProgram(uint32 nAddress)
 	m_ctx->m_State.pipeTime = 0;
 	m_ctx->m_State.nHasException = 0;
 
+	//MAC flags queued by the previous microprogram are all available by now
+	for(auto& pipeTime : m_ctx->m_State.pipeMac.pipeTimes)
+	{
+		pipeTime = 0;
+	}
+
 #ifdef DEBUGGER_INCLUDED
 	SaveMiniState();
 #endif
@@ -153,9 +179,24 @@ void CVpu::ExecuteMicroProgram(uint32 nAddress)
 	assert(!m_running);
 	m_running = true;
 	VuStateChanged(m_running);
+	if(m_worker)
+	{
+		m_worker->StartJob();
+		return;
+	}
+
+#ifdef PROFILE
+	CProfilerZone profilerZone(m_vuProfilerZone);
+#endif
+
+	RunMicroProgram();
+}
+
+void CVpu::RunMicroProgram()
+{
 	for(unsigned int i = 0; i < 100; i++)
 	{
-		Execute(5000);
+		ExecuteSlice(5000);
 		if(!m_running) break;
 	}
 }
@@ -177,6 +218,14 @@ void CVpu::ProcessXgKick(uint32 address)
 
 	//	assert(nAddress < PS2::VUMEM1SIZE);
 
+	if(m_worker)
+	{
+		//Program can overwrite the packet once the kick is done, copy it for the emulation thread
+		uint32 size = CGIF::GetPacketSize(GetVuMemory(), address, PS2::VUMEM1SIZE);
+		m_worker->QueueXgKick(GetVuMemory(), address, size);
+		return;
+	}
+
 	CGsPacketMetadata metadata;
 	metadata.pathIndex = 1;
 #ifdef DEBUGGER_INCLUDED
@@ -194,3 +243,34 @@ void CVpu::ProcessXgKick(uint32 address)
 	SaveMiniState();
 #endif
 }
+
+void CVpu::StartWorker()
+{
+	assert(!m_worker);
+	m_worker = std::make_unique<CVpuWorker>(m_number, [this]() { RunMicroProgram(); });
+}
+
+void CVpu::StopWorker()
+{
+	m_worker.reset();
+}
+
+void CVpu::WaitForMicroProgram() const
+{
+	if(!m_worker) return;
+	m_worker->Wait();
+	FlushXgKicks();
+}
+
+void CVpu::FlushXgKicks() const
+{
+	m_worker->TakeXgKicks(m_xgKickPackets);
+	uint32 index = 0;
+	while(index < m_xgKickPackets.size())
+	{
+		uint32 qwordCount = m_xgKickPackets[index].nV0;
+		auto packet = reinterpret_cast<const uint8*>(&m_xgKickPackets[index + 1]);
+		m_gif.ProcessSinglePacket(packet, 0, qwordCount * 0x10, CGsPacketMetadata(1));
+		index += 1 + qwordCount;
+	}
+}
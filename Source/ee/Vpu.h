@@ -4,6 +4,7 @@
 #include "../MIPS.h"
 #include "../Profiler.h"
 #include "Convertible.h"
+#include "VpuWorker.h"
 #include "zip/ZipArchiveWriter.h"
 #include "zip/ZipArchiveReader.h"
 
@@ -60,6 +61,13 @@ public:
 
 	void ProcessXgKick(uint32);
 
+	//Microprograms run on a worker thread once started, WaitForMicroProgram must be
+	//called before anything that observes the VU (IsVuRunning does it). Waiting only
+	//hands what the program kicked to the GIF, so it can be done from const methods.
+	void StartWorker();
+	void StopWorker();
+	void WaitForMicroProgram() const;
+
 #ifdef DEBUGGER_INCLUDED
 	void SaveMiniState();
 	const MIPSSTATE& GetVuMiniState() const;
@@ -73,6 +81,11 @@ public:
 
 protected:
 	typedef std::unique_ptr<CVif> VifPtr;
+	typedef std::unique_ptr<CVpuWorker> WorkerPtr;
+
+	void RunMicroProgram();
+	void ExecuteSlice(int32);
+	void FlushXgKicks() const;
 
 	uint8* m_microMem = nullptr;
 	uint8* m_vuMem = nullptr;
@@ -81,6 +94,10 @@ protected:
 	CGIF& m_gif;
 	VifPtr m_vif;
 
+	WorkerPtr m_worker;
+	//Scratch buffer used when packets kicked by the worker are sent to the GIF
+	mutable CVpuWorker::XgKickPacketBuffer m_xgKickPackets;
+
 #ifdef DEBUGGER_INCLUDED
 	MIPSSTATE m_vuMiniState;
 	uint8* m_microMemMiniState;
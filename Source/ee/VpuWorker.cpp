@@ -0,0 +1,35 @@
+#include <cassert>
+#include <cstring>
+#include "string_format.h"
+#include "VpuWorker.h"
+
+CVpuWorker::CVpuWorker(unsigned int number, const MicroProgramFunction& microProgramFunction)
+    : CSingleJobWorker(string_format("VU%d", number), microProgramFunction)
+{
+}
+
+CVpuWorker::~CVpuWorker()
+{
+	Stop();
+}
+
+void CVpuWorker::QueueXgKick(const uint8* memory, uint32 address, uint32 size)
+{
+	assert((size & 0x0F) == 0);
+	uint32 qwordCount = size / 0x10;
+
+	std::lock_guard<std::mutex> lock(m_xgKickMutex);
+	size_t headerIndex = m_xgKickPackets.size();
+	m_xgKickPackets.resize(headerIndex + 1 + qwordCount);
+	auto header = &m_xgKickPackets[headerIndex];
+	memset(header, 0, sizeof(uint128));
+	header->nV0 = qwordCount;
+	memcpy(header + 1, memory + address, size);
+}
+
+void CVpuWorker::TakeXgKicks(XgKickPacketBuffer& packets)
+{
+	packets.clear();
+	std::lock_guard<std::mutex> lock(m_xgKickMutex);
+	std::swap(packets, m_xgKickPackets);
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <functional>
+#include <mutex>
+#include <vector>
+#include "Types.h"
+#include "../SingleJobWorker.h"
+#include "../uint128.h"
+
+//Runs VU microprograms on their own thread while the emulation thread carries on.
+//The emulation thread must call Wait before doing anything that depends on the state of the VU.
+//XGKICK packets are copied on the worker and handed to the emulation thread, the GIF is never used here.
+class CVpuWorker : public CSingleJobWorker
+{
+public:
+	typedef std::function<void()> MicroProgramFunction;
+	typedef std::vector<uint128> XgKickPacketBuffer;
+
+	CVpuWorker(unsigned int, const MicroProgramFunction&);
+	virtual ~CVpuWorker();
+
+	//Called by the microprogram on the worker thread
+	void QueueXgKick(const uint8*, uint32, uint32);
+
+	//Packets are stored as a header (size in qwords) followed by the packet data
+	void TakeXgKicks(XgKickPacketBuffer&);
+
+private:
+	std::mutex m_xgKickMutex;
+	XgKickPacketBuffer m_xgKickPackets;
+};
@@ -4,8 +4,9 @@
 #include "MemoryUtils.h"
 #include "Vpu.h"
 
-CVuBasicBlock::CVuBasicBlock(CMIPS& context, uint32 begin, uint32 end)
+CVuBasicBlock::CVuBasicBlock(CMIPS& context, uint32 begin, uint32 end, bool skipUnusedMacFlagWrites)
     : CBasicBlock(context, begin, end)
+    , m_skipUnusedMacFlagWrites(skipUnusedMacFlagWrites)
 {
 }
 
@@ -18,6 +19,7 @@ void CVuBasicBlock::CompileRange(CMipsJitter* jitter)
 	auto arch = static_cast<CMA_VU*>(m_context.m_pArch);
 
 	auto integerBranchDelayInfo = GetIntegerBranchDelayInfo();
+	auto unusedMacFlagWrites = GetUnusedMacFlagWrites();
 
 	bool hasPendingXgKick = false;
 	const auto clearPendingXgKick =
@@ -95,7 +97,9 @@ void CVuBasicBlock::CompileRange(CMipsJitter* jitter)
 		}
 
 		arch->SetRelativePipeTime(relativePipeTime);
+		arch->SetMacFlagsUnused(unusedMacFlagWrites[relativePipeTime]);
 		arch->CompileInstruction(addressHi, jitter, &m_context);
+		arch->SetMacFlagsUnused(false);
 
 		if(savedReg != 0)
 		{
@@ -255,6 +259,58 @@ bool CVuBasicBlock::CheckIsSpecialIntegerLoop(unsigned int regI) const
 	return true;
 }
 
+std::vector<bool> CVuBasicBlock::GetUnusedMacFlagWrites() const
+{
+	//MAC flags written by an upper instruction are unused if another upper instruction of this
+	//block overwrites them before any lower instruction reads them. The flags of the overwriting
+	//instruction also need to be available before the end of the block since following blocks
+	//will only see those.
+
+	auto arch = static_cast<CMA_VU*>(m_context.m_pArch);
+	uint32 length = ((m_end - m_begin) / 8) + 1;
+	std::vector<bool> result(length, false);
+	if(!m_skipUnusedMacFlagWrites) return result;
+
+	std::vector<uint32> macWrites;
+	std::vector<bool> macReads(length, false);
+	for(uint32 index = 0; index < length; index++)
+	{
+		uint32 addressLo = m_begin + (index * 8);
+		uint32 addressHi = addressLo + 4;
+		uint32 opcodeLo = m_context.m_pMemoryMap->GetInstruction(addressLo);
+		uint32 opcodeHi = m_context.m_pMemoryMap->GetInstruction(addressHi);
+		auto loOps = arch->GetAffectedOperands(&m_context, addressLo, opcodeLo);
+		auto hiOps = arch->GetAffectedOperands(&m_context, addressHi, opcodeHi);
+		if(hiOps.writeMACflags)
+		{
+			macWrites.push_back(index);
+		}
+		macReads[index] = loOps.readMACflags;
+	}
+
+	//Time of the next read at or after a given time
+	std::vector<uint32> nextMacRead(length + 1, ~0U);
+	for(uint32 index = length; index != 0; index--)
+	{
+		nextMacRead[index - 1] = macReads[index - 1] ? (index - 1) : nextMacRead[index];
+	}
+
+	for(uint32 i = 1; i < macWrites.size(); i++)
+	{
+		uint32 prevWrite = macWrites[i - 1];
+		uint32 nextWrite = macWrites[i];
+		uint32 prevAvailable = prevWrite + VUShared::LATENCY_MAC;
+		uint32 nextAvailable = nextWrite + VUShared::LATENCY_MAC;
+		if(nextAvailable > length) break;
+		if(nextMacRead[prevAvailable] >= nextAvailable)
+		{
+			result[prevWrite] = true;
+		}
+	}
+
+	return result;
+}
+
 void CVuBasicBlock::EmitXgKick(CMipsJitter* jitter)
 {
 	//Push context
@@ -1,11 +1,12 @@
 #pragma once
 
+#include <vector>
 #include "../BasicBlock.h"
 
 class CVuBasicBlock : public CBasicBlock
 {
 public:
-	CVuBasicBlock(CMIPS&, uint32, uint32);
+	CVuBasicBlock(CMIPS&, uint32, uint32, bool = true);
 	virtual ~CVuBasicBlock() = default;
 
 protected:
@@ -23,5 +24,8 @@ private:
 
 	INTEGER_BRANCH_DELAY_INFO GetIntegerBranchDelayInfo() const;
 	bool CheckIsSpecialIntegerLoop(unsigned int) const;
+	std::vector<bool> GetUnusedMacFlagWrites() const;
 	static void EmitXgKick(CMipsJitter*);
+
+	bool m_skipUnusedMacFlagWrites = true;
 };
@@ -13,6 +13,13 @@ void CVuExecutor::Reset()
 	CGenericMipsExecutor::Reset();
 }
 
+void CVuExecutor::SetSkipUnusedMacFlagWrites(bool skipUnusedMacFlagWrites)
+{
+	m_skipUnusedMacFlagWrites = skipUnusedMacFlagWrites;
+	//Blocks compiled with the previous setting can't be reused
+	Reset();
+}
+
 BasicBlockPtr CVuExecutor::BlockFactory(CMIPS& context, uint32 begin, uint32 end)
 {
 	uint32 blockSize = ((end - begin) + 4) / 4;
@@ -49,8 +56,8 @@ BasicBlockPtr CVuExecutor::BlockFactory(CMIPS& context, uint32 begin, uint32 end
 		}
 	}
 
-	auto result = std::make_shared<CVuBasicBlock>(context, begin, end);
-	result->Compile();
+	auto result = MakeBasicBlock<CVuBasicBlock>(context, begin, end, m_skipUnusedMacFlagWrites);
+	CompileBlock(result.get(), checksum);
 	m_cachedBlocks.insert(std::make_pair(checksum, result));
 	return result;
 }
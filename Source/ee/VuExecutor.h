@@ -11,6 +11,9 @@ public:
 
 	void Reset() override;
 
+	//Dead MAC flag writes are skipped by default, turning it off allows checking that results don't change
+	void SetSkipUnusedMacFlagWrites(bool);
+
 protected:
 	typedef std::unordered_multimap<uint32, BasicBlockPtr> CachedBlockMap;
 
@@ -18,4 +21,5 @@ protected:
 	void PartitionFunction(uint32) override;
 
 	CachedBlockMap m_cachedBlocks;
+	bool m_skipUnusedMacFlagWrites = true;
 };
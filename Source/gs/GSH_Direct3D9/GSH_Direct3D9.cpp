@@ -1,4 +1,5 @@
 #include "GSH_Direct3D9.h"
+#include "../../AppConfig.h"
 #include "../../Log.h"
 #include "../../gs/GsPixelFormats.h"
 #include "direct3d9/D3D9TextureUtils.h"
@@ -69,16 +70,21 @@ CGSHandler::FactoryFunction CGSH_Direct3D9::GetFactoryFunction(Framework::Win32:
 
 void CGSH_Direct3D9::ProcessHostToLocalTransfer()
 {
-	auto bltBuf = make_convertible<BITBLTBUF>(m_nReg[GS_REG_BITBLTBUF]);
-	uint32 transferAddress = bltBuf.GetDstPtr();
-
 	if(m_trxCtx.nDirty)
 	{
 		//FlushVertexBuffer();
 		m_renderState.isValid = false;
 
+		//Textures only need to be invalidated in the pages that were modified by the transfer
+		assert(m_trxCtx.dirtyPageStart < m_trxCtx.dirtyPageEnd);
+		m_textureCache.InvalidateRange(m_trxCtx.dirtyPageStart * CGsPixelFormats::PAGESIZE,
+		                               (m_trxCtx.dirtyPageEnd - m_trxCtx.dirtyPageStart) * CGsPixelFormats::PAGESIZE);
+
+#if 0
+		auto bltBuf = make_convertible<BITBLTBUF>(m_nReg[GS_REG_BITBLTBUF]);
 		auto trxReg = make_convertible<TRXREG>(m_nReg[GS_REG_TRXREG]);
 		auto trxPos = make_convertible<TRXPOS>(m_nReg[GS_REG_TRXPOS]);
+		uint32 transferAddress = bltBuf.GetDstPtr();
 
 		//Find the pages that are touched by this transfer
 		auto transferPageSize = CGsPixelFormats::GetPsmPageSize(bltBuf.nDstPsm);
@@ -90,9 +96,6 @@ void CGSH_Direct3D9::ProcessHostToLocalTransfer()
 		uint32 transferSize = pageCount * CGsPixelFormats::PAGESIZE;
 		uint32 transferOffset = (trxPos.nDSAY / transferPageSize.second) * pageCountX * CGsPixelFormats::PAGESIZE;
 
-		m_textureCache.InvalidateRange(transferAddress + transferOffset, transferSize);
-
-#if 0
 		bool isUpperByteTransfer = (bltBuf.nDstPsm == PSMT8H) || (bltBuf.nDstPsm == PSMT4HL) || (bltBuf.nDstPsm == PSMT4HH);
 		for(const auto& framebuffer : m_framebuffers)
 		{
@@ -167,6 +170,13 @@ void CGSH_Direct3D9::ProcessLocalToHostTransfer()
 
 void CGSH_Direct3D9::ProcessLocalToLocalTransfer()
 {
+	TransferLocalToLocal();
+	if(m_trxCtx.dirtyPageStart < m_trxCtx.dirtyPageEnd)
+	{
+		m_renderState.isValid = false;
+		m_textureCache.InvalidateRange(m_trxCtx.dirtyPageStart * CGsPixelFormats::PAGESIZE,
+		                               (m_trxCtx.dirtyPageEnd - m_trxCtx.dirtyPageStart) * CGsPixelFormats::PAGESIZE);
+	}
 }
 
 void CGSH_Direct3D9::ProcessClutTransfer(uint32, uint32)
@@ -230,6 +240,7 @@ void CGSH_Direct3D9::ResetImpl()
 	m_framebuffers.clear();
 	m_depthbuffers.clear();
 	m_textureCache.Flush();
+	m_textureCache.SetMaxTextureCount(std::max<int>(CAppConfig::GetInstance().GetPreferenceInteger(PREF_CGSHANDLER_TEXTURECACHE_SIZE), 1));
 	m_renderState.isValid = false;
 	CGSHandler::ResetImpl();
 }
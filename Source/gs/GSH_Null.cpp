@@ -26,6 +26,8 @@ void CGSH_Null::ProcessLocalToHostTransfer()
 
 void CGSH_Null::ProcessLocalToLocalTransfer()
 {
+	//Keep GS RAM current for local to host transfers
+	TransferLocalToLocal();
 }
 
 void CGSH_Null::ProcessClutTransfer(uint32, uint32)
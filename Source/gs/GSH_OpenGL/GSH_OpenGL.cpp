@@ -320,6 +320,7 @@ void CGSH_OpenGL::LoadPreferences()
 {
 	m_fbScale = CAppConfig::GetInstance().GetPreferenceInteger(PREF_CGSH_OPENGL_RESOLUTION_FACTOR);
 	m_forceBilinearTextures = CAppConfig::GetInstance().GetPreferenceBoolean(PREF_CGSH_OPENGL_FORCEBILINEARTEXTURES);
+	m_textureCache.SetMaxTextureCount(std::max<int>(CAppConfig::GetInstance().GetPreferenceInteger(PREF_CGSHANDLER_TEXTURECACHE_SIZE), 1));
 }
 
 void CGSH_OpenGL::InitializeRC()
@@ -2058,7 +2059,12 @@ void CGSH_OpenGL::ProcessHostToLocalTransfer()
 		auto trxReg = make_convertible<TRXREG>(m_nReg[GS_REG_TRXREG]);
 		auto trxPos = make_convertible<TRXPOS>(m_nReg[GS_REG_TRXPOS]);
 
-		//Find the pages that are touched by this transfer
+		//Textures only need to be invalidated in the pages that were modified by the transfer
+		assert(m_trxCtx.dirtyPageStart < m_trxCtx.dirtyPageEnd);
+		m_textureCache.InvalidateRange(m_trxCtx.dirtyPageStart * CGsPixelFormats::PAGESIZE,
+		                               (m_trxCtx.dirtyPageEnd - m_trxCtx.dirtyPageStart) * CGsPixelFormats::PAGESIZE);
+
+		//GS RAM might not be up to date with framebuffer contents, invalidate every page touched by this transfer
 		auto transferPageSize = CGsPixelFormats::GetPsmPageSize(bltBuf.nDstPsm);
 
 		uint32 pageCountX = (bltBuf.GetDstWidth() + transferPageSize.first - 1) / transferPageSize.first;
@@ -2068,8 +2074,6 @@ void CGSH_OpenGL::ProcessHostToLocalTransfer()
 		uint32 transferSize = pageCount * CGsPixelFormats::PAGESIZE;
 		uint32 transferOffset = (trxPos.nDSAY / transferPageSize.second) * pageCountX * CGsPixelFormats::PAGESIZE;
 
-		m_textureCache.InvalidateRange(transferAddress + transferOffset, transferSize);
-
 		bool isUpperByteTransfer = (bltBuf.nDstPsm == PSMT8H) || (bltBuf.nDstPsm == PSMT4HL) || (bltBuf.nDstPsm == PSMT4HH);
 		for(const auto& framebuffer : m_framebuffers)
 		{
@@ -2162,6 +2166,25 @@ void CGSH_OpenGL::ProcessLocalToLocalTransfer()
 
 		glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
 	}
+	else if(srcFramebufferIterator == std::end(m_framebuffers))
+	{
+		//Source isn't rendered to, GS RAM holds its contents and we can copy there
+		TransferLocalToLocal();
+		if(m_trxCtx.dirtyPageStart < m_trxCtx.dirtyPageEnd)
+		{
+			FlushVertexBuffer();
+			m_renderState.isTextureStateValid = false;
+			m_renderState.isFramebufferStateValid = false;
+
+			uint32 dirtyAddress = m_trxCtx.dirtyPageStart * CGsPixelFormats::PAGESIZE;
+			uint32 dirtySize = (m_trxCtx.dirtyPageEnd - m_trxCtx.dirtyPageStart) * CGsPixelFormats::PAGESIZE;
+			m_textureCache.InvalidateRange(dirtyAddress, dirtySize);
+			for(const auto& framebuffer : m_framebuffers)
+			{
+				framebuffer->m_cachedArea.Invalidate(dirtyAddress, dirtySize);
+			}
+		}
+	}
 }
 
 void CGSH_OpenGL::ProcessClutTransfer(uint32 csa, uint32)
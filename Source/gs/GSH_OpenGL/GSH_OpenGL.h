@@ -152,7 +152,6 @@ private:
 
 	enum
 	{
-		MAX_TEXTURE_CACHE = 256,
 		MAX_PALETTE_CACHE = 256,
 	};
 
@@ -0,0 +1,831 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include "../AppConfig.h"
+#include "../Log.h"
+#include "GSH_Software.h"
+#include "GsPixelFormats.h"
+
+#define LOG_NAME ("gsh_software")
+
+CGSH_Software::CGSH_Software(bool gsThreaded)
+    : CGSHandler(gsThreaded)
+    , m_nextTile(0)
+{
+	RegisterPreferences();
+
+	memset(&m_vtxBuffer, 0, sizeof(m_vtxBuffer));
+	m_primitiveMode <<= 0;
+	m_batchTarget.frame <<= 0;
+	m_batchTarget.zbuf <<= 0;
+}
+
+CGSH_Software::~CGSH_Software()
+{
+	StopWorkers();
+}
+
+void CGSH_Software::RegisterPreferences()
+{
+	CGSHandler::RegisterPreferences();
+	CAppConfig::GetInstance().RegisterPreferenceInteger(PREF_CGSH_SOFTWARE_THREADS, 0);
+}
+
+CGSHandler::FactoryFunction CGSH_Software::GetFactoryFunction()
+{
+	return std::bind(&CGSH_Software::GSHandlerFactory);
+}
+
+CGSHandler* CGSH_Software::GSHandlerFactory()
+{
+	return new CGSH_Software();
+}
+
+void CGSH_Software::InitializeImpl()
+{
+	//Indexors build their page offset tables on first use, make sure this
+	//happens here and not concurrently on worker threads
+	CGsPixelFormats::CPixelIndexorPSMCT32(m_pRAM, 0, 1);
+	CGsPixelFormats::CPixelIndexor<CGsPixelFormats::STORAGEPSMZ32>(m_pRAM, 0, 1);
+	CGsPixelFormats::CPixelIndexorPSMCT16(m_pRAM, 0, 1);
+	CGsPixelFormats::CPixelIndexorPSMCT16S(m_pRAM, 0, 1);
+	CGsPixelFormats::CPixelIndexorPSMT8(m_pRAM, 0, 1);
+	CGsPixelFormats::CPixelIndexorPSMT4(m_pRAM, 0, 1);
+
+	StartWorkers();
+}
+
+void CGSH_Software::ReleaseImpl()
+{
+	DiscardBatch();
+	StopWorkers();
+}
+
+void CGSH_Software::ResetImpl()
+{
+	DiscardBatch();
+	memset(&m_vtxBuffer, 0, sizeof(m_vtxBuffer));
+	m_vtxCount = 0;
+	m_primitiveType = PRIM_INVALID;
+	m_primitiveMode <<= 0;
+	m_drawStateDirty = true;
+	CGSHandler::ResetImpl();
+}
+
+void CGSH_Software::FlipImpl()
+{
+	FlushBatch();
+	CGSHandler::FlipImpl();
+}
+
+void CGSH_Software::SaveState(Framework::CZipArchiveWriter& archive)
+{
+	SendGSCall([this]() { FlushBatch(); }, true);
+	CGSHandler::SaveState(archive);
+}
+
+void CGSH_Software::LoadState(Framework::CZipArchiveReader& archive)
+{
+	SendGSCall([this]() { DiscardBatch(); }, true);
+	CGSHandler::LoadState(archive);
+}
+
+/////////////////////////////////////////////////////////////
+// Worker Pool
+/////////////////////////////////////////////////////////////
+
+void CGSH_Software::StartWorkers()
+{
+	assert(m_workers.empty());
+
+	unsigned int threadCount = CAppConfig::GetInstance().GetPreferenceInteger(PREF_CGSH_SOFTWARE_THREADS);
+	if(threadCount == 0)
+	{
+		threadCount = std::thread::hardware_concurrency();
+	}
+	threadCount = std::max<unsigned int>(std::min<unsigned int>(threadCount, MAX_WORKER_THREADS), 1);
+
+	//GS thread takes part in rasterization and uses the first tile context
+	m_tileContexts.clear();
+	for(unsigned int i = 0; i < threadCount; i++)
+	{
+		m_tileContexts.push_back(std::make_unique<TILE_CONTEXT>());
+	}
+
+	m_workersDone = false;
+	for(unsigned int i = 1; i < threadCount; i++)
+	{
+		m_workers.emplace_back([this, i]() { WorkerThreadProc(i); });
+	}
+
+	CLog::GetInstance().Print(LOG_NAME, "Rasterizing with %d thread(s).\r\n", threadCount);
+}
+
+void CGSH_Software::StopWorkers()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_workMutex);
+		m_workersDone = true;
+	}
+	m_workCondition.notify_all();
+	for(auto& worker : m_workers)
+	{
+		worker.join();
+	}
+	m_workers.clear();
+	m_workGeneration = 0;
+}
+
+void CGSH_Software::WorkerThreadProc(unsigned int contextIndex)
+{
+	auto& tileContext = *m_tileContexts[contextIndex];
+	uint32 generation = 0;
+	while(1)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_workMutex);
+			m_workCondition.wait(lock, [&]() { return m_workersDone || (m_workGeneration != generation); });
+			if(m_workersDone) break;
+			generation = m_workGeneration;
+		}
+
+		RunTiles(tileContext);
+
+		{
+			std::lock_guard<std::mutex> lock(m_workMutex);
+			assert(m_busyWorkers != 0);
+			m_busyWorkers--;
+			if(m_busyWorkers == 0)
+			{
+				m_workDoneCondition.notify_one();
+			}
+		}
+	}
+}
+
+void CGSH_Software::RunTiles(TILE_CONTEXT& tileContext)
+{
+	while(1)
+	{
+		uint32 tileIndex = m_nextTile++;
+		if(tileIndex >= m_activeTiles.size()) break;
+		RasterizeTile(m_activeTiles[tileIndex], tileContext);
+	}
+}
+
+void CGSH_Software::ProcessTiles()
+{
+	m_nextTile = 0;
+	if(m_workers.empty())
+	{
+		RunTiles(*m_tileContexts[0]);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_workMutex);
+		m_busyWorkers = static_cast<uint32>(m_workers.size());
+		m_workGeneration++;
+	}
+	m_workCondition.notify_all();
+
+	RunTiles(*m_tileContexts[0]);
+
+	{
+		std::unique_lock<std::mutex> lock(m_workMutex);
+		m_workDoneCondition.wait(lock, [this]() { return m_busyWorkers == 0; });
+	}
+}
+
+/////////////////////////////////////////////////////////////
+// Batching
+/////////////////////////////////////////////////////////////
+
+void CGSH_Software::FlushBatch()
+{
+	if(!m_primitives.empty())
+	{
+		assert(!m_tileContexts.empty());
+		ProcessTiles();
+		m_drawCallCount++;
+	}
+	DiscardBatch();
+}
+
+void CGSH_Software::DiscardBatch()
+{
+	for(auto tileIndex : m_activeTiles)
+	{
+		m_tileBins[tileIndex].clear();
+	}
+	m_activeTiles.clear();
+	m_primitives.clear();
+	m_drawStates.clear();
+	m_batchMaxY = 0;
+}
+
+void CGSH_Software::SubmitPrimitive(PRIMITIVE& primitive)
+{
+	unsigned int context = m_primitiveMode.nContext;
+
+	auto scissor = make_convertible<SCISSOR>(m_nReg[GS_REG_SCISSOR_1 + context]);
+	primitive.minX = std::max<int>(primitive.minX, scissor.scax0);
+	primitive.minY = std::max<int>(primitive.minY, scissor.scay0);
+	primitive.maxX = std::min<int>(primitive.maxX, scissor.scax1);
+	primitive.maxY = std::min<int>(primitive.maxY, scissor.scay1);
+	if((primitive.minX > primitive.maxX) || (primitive.minY > primitive.maxY)) return;
+
+	TARGET target;
+	target.frame <<= m_nReg[GS_REG_FRAME_1 + context];
+	target.zbuf <<= m_nReg[GS_REG_ZBUF_1 + context];
+
+	if(!m_primitives.empty())
+	{
+		//Tiles only own their pixels if all primitives of a batch use the same buffers
+		bool sameTarget =
+		    (static_cast<uint64>(target.frame) == static_cast<uint64>(m_batchTarget.frame)) &&
+		    (static_cast<uint64>(target.zbuf) == static_cast<uint64>(m_batchTarget.zbuf));
+		if(!sameTarget || (m_primitives.size() >= MAX_BATCH_PRIMITIVES))
+		{
+			FlushBatch();
+		}
+	}
+
+	if(m_drawStateDirty || m_drawStates.empty())
+	{
+		m_drawStates.push_back(MakeDrawState());
+		m_drawStateDirty = false;
+	}
+
+	uint32 maxY = std::max<uint32>(m_batchMaxY, primitive.maxY);
+	if(!m_primitives.empty() && IsTextureReadHazard(target, maxY))
+	{
+		//Primitive would sample something the batch is drawing
+		auto drawState = m_drawStates.back();
+		FlushBatch();
+		m_drawStates.push_back(drawState);
+		maxY = primitive.maxY;
+	}
+
+	m_batchTarget = target;
+	m_batchMaxY = maxY;
+
+	primitive.stateIndex = static_cast<uint32>(m_drawStates.size() - 1);
+	uint32 primitiveIndex = static_cast<uint32>(m_primitives.size());
+	m_primitives.push_back(primitive);
+
+	for(int tileY = primitive.minY / TILE_HEIGHT; tileY <= primitive.maxY / TILE_HEIGHT; tileY++)
+	{
+		for(int tileX = primitive.minX / TILE_WIDTH; tileX <= primitive.maxX / TILE_WIDTH; tileX++)
+		{
+			uint32 tileIndex = tileX + (tileY * TILE_COUNT_X);
+			auto& tileBin = m_tileBins[tileIndex];
+			if(tileBin.empty())
+			{
+				m_activeTiles.push_back(tileIndex);
+			}
+			tileBin.push_back(primitiveIndex);
+		}
+	}
+}
+
+CGSH_Software::DRAW_STATE CGSH_Software::MakeDrawState() const
+{
+	unsigned int context = m_primitiveMode.nContext;
+
+	DRAW_STATE state;
+	state.primMode = m_primitiveMode;
+	state.tex0 <<= m_nReg[GS_REG_TEX0_1 + context];
+	state.clamp <<= m_nReg[GS_REG_CLAMP_1 + context];
+	state.texa <<= m_nReg[GS_REG_TEXA];
+	state.scissor <<= m_nReg[GS_REG_SCISSOR_1 + context];
+	state.alpha <<= m_nReg[GS_REG_ALPHA_1 + context];
+	state.test <<= m_nReg[GS_REG_TEST_1 + context];
+	state.fogCol <<= m_nReg[GS_REG_FOGCOL];
+	state.fba = static_cast<uint32>(m_nReg[GS_REG_FBA_1 + context] & 1);
+	state.pabe = static_cast<uint32>(m_nReg[GS_REG_PABE] & 1);
+	state.colClamp = (m_nReg[GS_REG_COLCLAMP] & 1) != 0;
+	state.texturePages = CGsCachedArea::MemoryPageRange(0, 0);
+
+	if(state.primMode.nTexture)
+	{
+		CGsCachedArea textureArea;
+		textureArea.SetArea(state.tex0.nPsm, state.tex0.GetBufPtr(), state.tex0.GetBufWidth(), state.tex0.GetHeight());
+		state.texturePages = textureArea.GetMemoryPageRange();
+
+		//CLUT is copied since it can change before the batch is rasterized
+		if(CGsPixelFormats::IsPsmIDTEX(state.tex0.nPsm))
+		{
+			MakeLinearCLUT(state.tex0, state.clut);
+			if((state.tex0.nCPSM == PSMCT16) || (state.tex0.nCPSM == PSMCT16S))
+			{
+				//Alpha of 16-bit colors is expanded using TEXA
+				for(auto& color : state.clut)
+				{
+					uint32 alpha = (color & 0x80000000) ? state.texa.nTA1 : state.texa.nTA0;
+					if(state.texa.nAEM && (color == 0)) alpha = 0;
+					color = (color & 0x00FFFFFF) | (alpha << 24);
+				}
+			}
+		}
+	}
+
+	return state;
+}
+
+bool CGSH_Software::IsTextureReadHazard(const TARGET& target, uint32 maxY) const
+{
+	static const auto overlaps =
+	    [](const CGsCachedArea::MemoryPageRange& range1, const CGsCachedArea::MemoryPageRange& range2) {
+		    return (range1.first < range2.second) && (range2.first < range1.second);
+	    };
+
+	CGsCachedArea frameArea;
+	frameArea.SetArea(target.frame.nPsm, target.frame.GetBasePtr(), target.frame.GetWidth(), maxY + 1);
+	auto framePages = frameArea.GetMemoryPageRange();
+
+	auto depthPages = CGsCachedArea::MemoryPageRange(0, 0);
+	if(!target.zbuf.nMask)
+	{
+		CGsCachedArea depthArea;
+		depthArea.SetArea(PSMZ32 | target.zbuf.nPsm, target.zbuf.GetBasePtr(), target.frame.GetWidth(), maxY + 1);
+		depthPages = depthArea.GetMemoryPageRange();
+	}
+
+	for(const auto& drawState : m_drawStates)
+	{
+		const auto& texturePages = drawState.texturePages;
+		if(texturePages.first == texturePages.second) continue;
+		if(overlaps(texturePages, framePages) || overlaps(texturePages, depthPages))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/////////////////////////////////////////////////////////////
+// Primitive Assembly
+/////////////////////////////////////////////////////////////
+
+void CGSH_Software::WriteRegisterImpl(uint8 registerId, uint64 data)
+{
+	switch(registerId)
+	{
+	case GS_REG_TRXDIR:
+		//Transfers will read or write GS RAM
+		FlushBatch();
+		break;
+	case GS_REG_TEX0_1:
+	case GS_REG_TEX0_2:
+	case GS_REG_TEX2_1:
+	case GS_REG_TEX2_2:
+		//CLD is non zero, CLUT might get loaded from GS RAM
+		if((data >> 61) != 0)
+		{
+			FlushBatch();
+		}
+		break;
+	}
+
+	CGSHandler::WriteRegisterImpl(registerId, data);
+
+	switch(registerId)
+	{
+	case GS_REG_PRIM:
+		m_primitiveType = static_cast<unsigned int>(data & 0x07);
+		switch(m_primitiveType)
+		{
+		case PRIM_POINT:
+			m_vtxCount = 1;
+			break;
+		case PRIM_LINE:
+		case PRIM_LINESTRIP:
+			m_vtxCount = 2;
+			break;
+		case PRIM_TRIANGLE:
+		case PRIM_TRIANGLESTRIP:
+		case PRIM_TRIANGLEFAN:
+			m_vtxCount = 3;
+			break;
+		case PRIM_SPRITE:
+			m_vtxCount = 2;
+			break;
+		default:
+			m_vtxCount = 0;
+			break;
+		}
+		m_drawStateDirty = true;
+		break;
+	case GS_REG_XYZ2:
+	case GS_REG_XYZ3:
+	case GS_REG_XYZF2:
+	case GS_REG_XYZF3:
+		VertexKick(registerId, data);
+		break;
+	case GS_REG_RGBAQ:
+	case GS_REG_ST:
+	case GS_REG_UV:
+	case GS_REG_FOG:
+	case GS_REG_TEXFLUSH:
+	case GS_REG_BITBLTBUF:
+	case GS_REG_TRXPOS:
+	case GS_REG_TRXREG:
+	case GS_REG_TRXDIR:
+	case GS_REG_HWREG:
+	case GS_REG_SIGNAL:
+	case GS_REG_FINISH:
+	case GS_REG_LABEL:
+		break;
+	default:
+		m_drawStateDirty = true;
+		break;
+	}
+}
+
+void CGSH_Software::VertexKick(uint8 registerId, uint64 value)
+{
+	if(m_vtxCount == 0) return;
+
+	bool drawingKick = (registerId == GS_REG_XYZ2) || (registerId == GS_REG_XYZF2);
+	bool fog = (registerId == GS_REG_XYZF2) || (registerId == GS_REG_XYZF3);
+
+	if(!m_drawEnabled) drawingKick = false;
+
+	auto& vertex = m_vtxBuffer[m_vtxCount - 1];
+	if(fog)
+	{
+		vertex.position = value & 0x00FFFFFFFFFFFFFFULL;
+		vertex.fog = static_cast<uint8>(value >> 56);
+	}
+	else
+	{
+		vertex.position = value;
+		vertex.fog = static_cast<uint8>(m_nReg[GS_REG_FOG] >> 56);
+	}
+	vertex.rgbaq = m_nReg[GS_REG_RGBAQ];
+	vertex.uv = m_nReg[GS_REG_UV];
+	vertex.st = m_nReg[GS_REG_ST];
+
+	m_vtxCount--;
+
+	if(m_vtxCount == 0)
+	{
+		auto primitiveMode = make_convertible<PRMODE>(((m_nReg[GS_REG_PRMODECONT] & 1) != 0) ? m_nReg[GS_REG_PRIM] : m_nReg[GS_REG_PRMODE]);
+		if(static_cast<uint64>(primitiveMode) != static_cast<uint64>(m_primitiveMode))
+		{
+			m_primitiveMode = primitiveMode;
+			m_drawStateDirty = true;
+		}
+
+		switch(m_primitiveType)
+		{
+		case PRIM_POINT:
+			if(drawingKick) Prim_Point();
+			m_vtxCount = 1;
+			break;
+		case PRIM_LINE:
+			if(drawingKick) Prim_Line();
+			m_vtxCount = 2;
+			break;
+		case PRIM_LINESTRIP:
+			if(drawingKick) Prim_Line();
+			memcpy(&m_vtxBuffer[1], &m_vtxBuffer[0], sizeof(VERTEX));
+			m_vtxCount = 1;
+			break;
+		case PRIM_TRIANGLE:
+			if(drawingKick) Prim_Triangle();
+			m_vtxCount = 3;
+			break;
+		case PRIM_TRIANGLESTRIP:
+			if(drawingKick) Prim_Triangle();
+			memcpy(&m_vtxBuffer[2], &m_vtxBuffer[1], sizeof(VERTEX));
+			memcpy(&m_vtxBuffer[1], &m_vtxBuffer[0], sizeof(VERTEX));
+			m_vtxCount = 1;
+			break;
+		case PRIM_TRIANGLEFAN:
+			if(drawingKick) Prim_Triangle();
+			memcpy(&m_vtxBuffer[1], &m_vtxBuffer[0], sizeof(VERTEX));
+			m_vtxCount = 1;
+			break;
+		case PRIM_SPRITE:
+			if(drawingKick) Prim_Sprite();
+			m_vtxCount = 2;
+			break;
+		}
+	}
+}
+
+CGSH_Software::RASTER_VERTEX CGSH_Software::MakeRasterVertex(const VERTEX& vertex) const
+{
+	unsigned int context = m_primitiveMode.nContext;
+
+	auto xyz = make_convertible<XYZ>(vertex.position);
+	auto rgbaq = make_convertible<RGBAQ>(vertex.rgbaq);
+	auto offset = make_convertible<XYOFFSET>(m_nReg[GS_REG_XYOFFSET_1 + context]);
+
+	RASTER_VERTEX result;
+	result.x = xyz.GetX() - offset.GetX();
+	result.y = xyz.GetY() - offset.GetY();
+	result.z = static_cast<double>(xyz.nZ);
+	result.r = rgbaq.nR;
+	result.g = rgbaq.nG;
+	result.b = rgbaq.nB;
+	result.a = rgbaq.nA;
+	result.s = 0;
+	result.t = 0;
+	result.q = 1;
+	result.f = vertex.fog;
+
+	if(m_primitiveMode.nTexture)
+	{
+		if(m_primitiveMode.nUseUV)
+		{
+			auto uv = make_convertible<UV>(vertex.uv);
+			result.s = uv.GetU();
+			result.t = uv.GetV();
+		}
+		else
+		{
+			//Texel coordinates are (s / q, t / q), interpolated linearly in screen space
+			auto tex0 = make_convertible<TEX0>(m_nReg[GS_REG_TEX0_1 + context]);
+			auto st = make_convertible<ST>(vertex.st);
+			result.s = st.nS * static_cast<float>(tex0.GetWidth());
+			result.t = st.nT * static_cast<float>(tex0.GetHeight());
+			result.q = (rgbaq.nQ != 0) ? rgbaq.nQ : 1.0f;
+		}
+	}
+
+	return result;
+}
+
+void CGSH_Software::Prim_Point()
+{
+	PRIMITIVE primitive;
+	primitive.kind = PRIMITIVE_KIND_POINT;
+	primitive.vertices[0] = MakeRasterVertex(m_vtxBuffer[0]);
+
+	const auto& vertex = primitive.vertices[0];
+	primitive.minX = primitive.maxX = static_cast<int>(std::floor(vertex.x + 0.5f));
+	primitive.minY = primitive.maxY = static_cast<int>(std::floor(vertex.y + 0.5f));
+
+	SubmitPrimitive(primitive);
+}
+
+void CGSH_Software::Prim_Line()
+{
+	PRIMITIVE primitive;
+	primitive.kind = PRIMITIVE_KIND_LINE;
+	primitive.vertices[0] = MakeRasterVertex(m_vtxBuffer[1]);
+	primitive.vertices[1] = MakeRasterVertex(m_vtxBuffer[0]);
+
+	auto& vertex0 = primitive.vertices[0];
+	auto& vertex1 = primitive.vertices[1];
+	if(m_primitiveMode.nShading == 0)
+	{
+		vertex0.r = vertex1.r;
+		vertex0.g = vertex1.g;
+		vertex0.b = vertex1.b;
+		vertex0.a = vertex1.a;
+	}
+
+	primitive.minX = static_cast<int>(std::floor(std::min(vertex0.x, vertex1.x) + 0.5f));
+	primitive.minY = static_cast<int>(std::floor(std::min(vertex0.y, vertex1.y) + 0.5f));
+	primitive.maxX = static_cast<int>(std::floor(std::max(vertex0.x, vertex1.x) + 0.5f));
+	primitive.maxY = static_cast<int>(std::floor(std::max(vertex0.y, vertex1.y) + 0.5f));
+
+	SubmitPrimitive(primitive);
+}
+
+void CGSH_Software::Prim_Triangle()
+{
+	PRIMITIVE primitive;
+	primitive.kind = PRIMITIVE_KIND_TRIANGLE;
+	primitive.vertices[0] = MakeRasterVertex(m_vtxBuffer[2]);
+	primitive.vertices[1] = MakeRasterVertex(m_vtxBuffer[1]);
+	primitive.vertices[2] = MakeRasterVertex(m_vtxBuffer[0]);
+
+	if(m_primitiveMode.nShading == 0)
+	{
+		//Flat shaded triangles use the last color set
+		const auto& lastVertex = primitive.vertices[2];
+		for(unsigned int i = 0; i < 2; i++)
+		{
+			auto& vertex = primitive.vertices[i];
+			vertex.r = lastVertex.r;
+			vertex.g = lastVertex.g;
+			vertex.b = lastVertex.b;
+			vertex.a = lastVertex.a;
+		}
+	}
+
+	float minX = primitive.vertices[0].x, maxX = primitive.vertices[0].x;
+	float minY = primitive.vertices[0].y, maxY = primitive.vertices[0].y;
+	for(unsigned int i = 1; i < 3; i++)
+	{
+		minX = std::min(minX, primitive.vertices[i].x);
+		maxX = std::max(maxX, primitive.vertices[i].x);
+		minY = std::min(minY, primitive.vertices[i].y);
+		maxY = std::max(maxY, primitive.vertices[i].y);
+	}
+
+	//Pixels are sampled at integer coordinates
+	primitive.minX = static_cast<int>(std::ceil(minX));
+	primitive.minY = static_cast<int>(std::ceil(minY));
+	primitive.maxX = static_cast<int>(std::floor(maxX));
+	primitive.maxY = static_cast<int>(std::floor(maxY));
+
+	SubmitPrimitive(primitive);
+}
+
+void CGSH_Software::Prim_Sprite()
+{
+	PRIMITIVE primitive;
+	primitive.kind = PRIMITIVE_KIND_SPRITE;
+	primitive.vertices[0] = MakeRasterVertex(m_vtxBuffer[1]);
+	primitive.vertices[1] = MakeRasterVertex(m_vtxBuffer[0]);
+
+	//Sprites use the color and depth of the last vertex
+	auto& vertex0 = primitive.vertices[0];
+	auto& vertex1 = primitive.vertices[1];
+	vertex0.r = vertex1.r;
+	vertex0.g = vertex1.g;
+	vertex0.b = vertex1.b;
+	vertex0.a = vertex1.a;
+	vertex0.z = vertex1.z;
+	vertex0.f = vertex1.f;
+
+	//No perspective correction for sprites
+	for(unsigned int i = 0; i < 2; i++)
+	{
+		auto& vertex = primitive.vertices[i];
+		vertex.s /= vertex.q;
+		vertex.t /= vertex.q;
+		vertex.q = 1;
+	}
+
+	primitive.minX = static_cast<int>(std::ceil(std::min(vertex0.x, vertex1.x)));
+	primitive.minY = static_cast<int>(std::ceil(std::min(vertex0.y, vertex1.y)));
+	primitive.maxX = static_cast<int>(std::ceil(std::max(vertex0.x, vertex1.x))) - 1;
+	primitive.maxY = static_cast<int>(std::ceil(std::max(vertex0.y, vertex1.y))) - 1;
+
+	SubmitPrimitive(primitive);
+}
+
+/////////////////////////////////////////////////////////////
+// Transfers
+/////////////////////////////////////////////////////////////
+
+void CGSH_Software::ProcessHostToLocalTransfer()
+{
+	//Image data was written to GS RAM by the transfer handlers and GS RAM is our only
+	//storage, nothing else to do. The batch was flushed when the transfer started.
+}
+
+void CGSH_Software::ProcessLocalToHostTransfer()
+{
+	//Transfer handlers will read from GS RAM which was made current when the transfer started.
+}
+
+void CGSH_Software::ProcessLocalToLocalTransfer()
+{
+	//GS RAM is our only storage, copy pixels there directly
+	TransferLocalToLocal();
+}
+
+void CGSH_Software::ProcessClutTransfer(uint32, uint32)
+{
+	//Draw states keep their own copy of the CLUT
+}
+
+/////////////////////////////////////////////////////////////
+// Display
+/////////////////////////////////////////////////////////////
+
+unsigned int CGSH_Software::GetCurrentReadCircuit()
+{
+	uint32 rcMode = m_nPMODE & 0x03;
+	switch(rcMode)
+	{
+	default:
+	case 0:
+	case 1:
+		return 0;
+	case 2:
+		return 1;
+	case 3:
+	{
+		//Both are enabled, pick the one that seems valid
+		std::lock_guard<std::recursive_mutex> registerMutexLock(m_registerMutex);
+		bool fb1Null = (m_nDISPFB1.value.q == 0);
+		bool fb2Null = (m_nDISPFB2.value.q == 0);
+		if(fb1Null && !fb2Null)
+		{
+			return 1;
+		}
+		return 0;
+	}
+	}
+}
+
+//Copies the displayed area as RGBA pixels
+void CGSH_Software::CopyDisplayFramebuffer(uint32 width, uint32 height, uint32* pixels)
+{
+	DISPFB fb;
+	{
+		std::lock_guard<std::recursive_mutex> registerMutexLock(m_registerMutex);
+		fb <<= (GetCurrentReadCircuit() == 0) ? m_nDISPFB1.value.q : m_nDISPFB2.value.q;
+	}
+
+	switch(fb.nPSM)
+	{
+	case PSMCT32:
+	case PSMCT24:
+	{
+		CGsPixelFormats::CPixelIndexorPSMCT32 indexor(m_pRAM, fb.GetBufPtr(), fb.nBufWidth);
+		for(uint32 y = 0; y < height; y++)
+		{
+			for(uint32 x = 0; x < width; x++)
+			{
+				uint32 pixel = indexor.GetPixel((fb.nX + x) % 2048, (fb.nY + y) % 2048);
+				pixels[x + (y * width)] = pixel | 0xFF000000;
+			}
+		}
+	}
+	break;
+	case PSMCT16:
+	case PSMCT16S:
+	{
+		for(uint32 y = 0; y < height; y++)
+		{
+			for(uint32 x = 0; x < width; x++)
+			{
+				uint32 pixelX = (fb.nX + x) % 2048;
+				uint32 pixelY = (fb.nY + y) % 2048;
+				uint16 pixel = (fb.nPSM == PSMCT16)
+				                   ? CGsPixelFormats::CPixelIndexorPSMCT16(m_pRAM, fb.GetBufPtr(), fb.nBufWidth).GetPixel(pixelX, pixelY)
+				                   : CGsPixelFormats::CPixelIndexorPSMCT16S(m_pRAM, fb.GetBufPtr(), fb.nBufWidth).GetPixel(pixelX, pixelY);
+				pixels[x + (y * width)] = ((pixel & 0x001F) << 3) | ((pixel & 0x03E0) << 6) | ((pixel & 0x7C00) << 9) | 0xFF000000;
+			}
+		}
+	}
+	break;
+	default:
+		memset(pixels, 0, width * height * sizeof(uint32));
+		break;
+	}
+}
+
+//Called on the GS thread
+void CGSH_Software::ReadFramebuffer(uint32 width, uint32 height, void* buffer)
+{
+	FlushBatch();
+
+	//Rows are stored bottom to top as BGR triplets, aligned on 4 bytes
+	std::vector<uint32> pixels(width * height);
+	CopyDisplayFramebuffer(width, height, pixels.data());
+
+	uint32 pitch = ((width * 3) + 3) & ~3;
+	auto output = reinterpret_cast<uint8*>(buffer);
+	for(uint32 y = 0; y < height; y++)
+	{
+		auto outputRow = output + ((height - y - 1) * pitch);
+		for(uint32 x = 0; x < width; x++)
+		{
+			uint32 pixel = pixels[x + (y * width)];
+			outputRow[(x * 3) + 0] = static_cast<uint8>(pixel >> 16);
+			outputRow[(x * 3) + 1] = static_cast<uint8>(pixel >> 8);
+			outputRow[(x * 3) + 2] = static_cast<uint8>(pixel >> 0);
+		}
+	}
+}
+
+//Called on the GS thread
+Framework::CBitmap CGSH_Software::GetScreenshot()
+{
+	FlushBatch();
+
+	DISPLAY d;
+	{
+		std::lock_guard<std::recursive_mutex> registerMutexLock(m_registerMutex);
+		d <<= (GetCurrentReadCircuit() == 0) ? m_nDISPLAY1.value.q : m_nDISPLAY2.value.q;
+	}
+
+	uint32 width = (d.nW + 1) / (d.nMagX + 1);
+	uint32 height = (d.nH + 1);
+	if(GetCrtIsInterlaced() && GetCrtIsFrameMode())
+	{
+		height /= 2;
+	}
+
+	if((width == 0) || (height == 0))
+	{
+		throw std::runtime_error("Nothing is being displayed.");
+	}
+
+	auto bitmap = Framework::CBitmap(width, height, 32);
+	CopyDisplayFramebuffer(width, height, reinterpret_cast<uint32*>(bitmap.GetPixels()));
+	return bitmap;
+}
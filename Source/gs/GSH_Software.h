@@ -0,0 +1,200 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "GSHandler.h"
+#include "GsCachedArea.h"
+
+#define PREF_CGSH_SOFTWARE_THREADS "renderer.software.threads"
+
+//Renders directly into GS RAM. Primitives are accumulated in batches and binned into screen
+//tiles which are then rasterized in parallel by a pool of worker threads. A batch is flushed
+//whenever something needs to observe GS RAM (transfers, CLUT loads, display) or when the next
+//primitive would read memory written by the batch.
+class CGSH_Software : public CGSHandler
+{
+public:
+	CGSH_Software(bool = true);
+	virtual ~CGSH_Software();
+
+	static void RegisterPreferences();
+
+	void ProcessHostToLocalTransfer() override;
+	void ProcessLocalToHostTransfer() override;
+	void ProcessLocalToLocalTransfer() override;
+	void ProcessClutTransfer(uint32, uint32) override;
+	void ReadFramebuffer(uint32, uint32, void*) override;
+
+	void SaveState(Framework::CZipArchiveWriter&) override;
+	void LoadState(Framework::CZipArchiveReader&) override;
+
+	Framework::CBitmap GetScreenshot() override;
+
+	static FactoryFunction GetFactoryFunction();
+
+private:
+	enum
+	{
+		TILE_WIDTH = 64,
+		TILE_HEIGHT = 32,
+		TILE_PIXEL_COUNT = TILE_WIDTH * TILE_HEIGHT,
+		MAX_COORD = 2048,
+		TILE_COUNT_X = MAX_COORD / TILE_WIDTH,
+		TILE_COUNT_Y = MAX_COORD / TILE_HEIGHT,
+		MAX_BATCH_PRIMITIVES = 4096,
+		MAX_WORKER_THREADS = 16,
+	};
+
+	enum PRIMITIVE_KIND
+	{
+		PRIMITIVE_KIND_POINT,
+		PRIMITIVE_KIND_LINE,
+		PRIMITIVE_KIND_TRIANGLE,
+		PRIMITIVE_KIND_SPRITE,
+	};
+
+	struct VERTEX
+	{
+		uint64 position;
+		uint64 rgbaq;
+		uint64 uv;
+		uint64 st;
+		uint8 fog;
+	};
+
+	//Everything a tile needs to know to rasterize a primitive
+	struct DRAW_STATE
+	{
+		PRMODE primMode;
+		TEX0 tex0;
+		CLAMP clamp;
+		TEXA texa;
+		SCISSOR scissor;
+		ALPHA alpha;
+		TEST test;
+		FOGCOL fogCol;
+		uint32 fba;
+		uint32 pabe;
+		bool colClamp;
+		//GS RAM pages read by this state's texture, empty if not textured
+		CGsCachedArea::MemoryPageRange texturePages;
+		std::array<uint32, 256> clut;
+	};
+
+	struct RASTER_VERTEX
+	{
+		float x;
+		float y;
+		double z;
+		float r, g, b, a;
+		float s, t, q;
+		float f;
+	};
+
+	struct PRIMITIVE
+	{
+		PRIMITIVE_KIND kind;
+		uint32 stateIndex;
+		RASTER_VERTEX vertices[3];
+		//Inclusive bounding box, in pixels
+		int minX, minY, maxX, maxY;
+	};
+
+	//Destination buffers shared by all primitives of a batch
+	struct TARGET
+	{
+		FRAME frame;
+		ZBUF zbuf;
+	};
+
+	//Each row of a tile fits in one word of the written masks
+	static_assert(TILE_WIDTH == 64, "Tile width must be 64 pixels.");
+
+	struct TILE_CONTEXT
+	{
+		int originX;
+		int originY;
+		uint32 color[TILE_PIXEL_COUNT];
+		uint32 depth[TILE_PIXEL_COUNT];
+		uint64 colorWritten[TILE_PIXEL_COUNT / 64];
+		uint64 depthWritten[TILE_PIXEL_COUNT / 64];
+	};
+
+	typedef std::vector<uint32> PrimitiveIndexArray;
+
+	void InitializeImpl() override;
+	void ReleaseImpl() override;
+	void ResetImpl() override;
+	void FlipImpl() override;
+	void WriteRegisterImpl(uint8, uint64) override;
+
+	void StartWorkers();
+	void StopWorkers();
+	void WorkerThreadProc(unsigned int);
+
+	void VertexKick(uint8, uint64);
+	void Prim_Point();
+	void Prim_Line();
+	void Prim_Triangle();
+	void Prim_Sprite();
+	RASTER_VERTEX MakeRasterVertex(const VERTEX&) const;
+	void SubmitPrimitive(PRIMITIVE&);
+	DRAW_STATE MakeDrawState() const;
+	bool IsTextureReadHazard(const TARGET&, uint32) const;
+
+	void FlushBatch();
+	void DiscardBatch();
+	void ProcessTiles();
+	void RunTiles(TILE_CONTEXT&);
+
+	//Rasterization, runs on worker threads
+	void RasterizeTile(uint32, TILE_CONTEXT&) const;
+	void LoadTile(TILE_CONTEXT&) const;
+	void StoreTile(const TILE_CONTEXT&) const;
+	void DrawPoint(const PRIMITIVE&, const DRAW_STATE&, int, int, int, int, TILE_CONTEXT&) const;
+	void DrawLine(const PRIMITIVE&, const DRAW_STATE&, int, int, int, int, TILE_CONTEXT&) const;
+	void DrawTriangle(const PRIMITIVE&, const DRAW_STATE&, int, int, int, int, TILE_CONTEXT&) const;
+	void DrawSprite(const PRIMITIVE&, const DRAW_STATE&, int, int, int, int, TILE_CONTEXT&) const;
+	void FillSpan(const DRAW_STATE&, uint32, uint32, int, int, int, TILE_CONTEXT&) const;
+	void ShadePixel(const DRAW_STATE&, const RASTER_VERTEX&, int, int, TILE_CONTEXT&) const;
+	uint32 SampleTexture(const DRAW_STATE&, float, float) const;
+	uint32 FetchTexel(const DRAW_STATE&, uint32, uint32) const;
+	bool IsSimpleFill(const DRAW_STATE&) const;
+	uint32 GetDepthMax() const;
+
+	uint32 GetCurrentReadCircuit();
+	void CopyDisplayFramebuffer(uint32, uint32, uint32*);
+
+	static CGSHandler* GSHandlerFactory();
+
+	//Primitive assembly
+	VERTEX m_vtxBuffer[3];
+	unsigned int m_vtxCount = 0;
+	unsigned int m_primitiveType = PRIM_INVALID;
+	PRMODE m_primitiveMode;
+	bool m_drawStateDirty = true;
+
+	//Current batch
+	TARGET m_batchTarget;
+	uint32 m_batchMaxY = 0;
+	std::vector<DRAW_STATE> m_drawStates;
+	std::vector<PRIMITIVE> m_primitives;
+	std::array<PrimitiveIndexArray, TILE_COUNT_X * TILE_COUNT_Y> m_tileBins;
+	std::vector<uint32> m_activeTiles;
+
+	//Worker pool
+	std::vector<std::thread> m_workers;
+	std::vector<std::unique_ptr<TILE_CONTEXT>> m_tileContexts;
+	std::mutex m_workMutex;
+	std::condition_variable m_workCondition;
+	std::condition_variable m_workDoneCondition;
+	std::atomic<uint32> m_nextTile;
+	uint32 m_workGeneration = 0;
+	uint32 m_busyWorkers = 0;
+	bool m_workersDone = false;
+};
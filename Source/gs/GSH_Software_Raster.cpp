@@ -0,0 +1,834 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include "GSH_Software.h"
+#include "GsPixelFormats.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define GSH_SOFTWARE_SSE2
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define GSH_SOFTWARE_NEON
+#endif
+
+//Tile color buffers always hold 32-bit RGBA values, 16-bit formats are expanded on load
+static uint32 RGBA16ToRGBA32(uint16 color)
+{
+	return ((color & 0x8000) ? 0x80000000 : 0) | ((color & 0x7C00) << 9) | ((color & 0x03E0) << 6) | ((color & 0x001F) << 3);
+}
+
+static uint16 RGBA32ToRGBA16(uint32 color)
+{
+	return static_cast<uint16>(((color >> 3) & 0x001F) | ((color >> 6) & 0x03E0) | ((color >> 9) & 0x7C00) | ((color >> 16) & 0x8000));
+}
+
+static bool IsPsm16Bits(unsigned int psm)
+{
+	return (psm == CGSHandler::PSMCT16) || (psm == CGSHandler::PSMCT16S) || (psm == CGSHandler::PSMZ16) || (psm == CGSHandler::PSMZ16S);
+}
+
+static int ClampColor(int value)
+{
+	return std::min(std::max(value, 0), 255);
+}
+
+static uint64 MakeSpanMask(int x0, int x1)
+{
+	int count = x1 - x0 + 1;
+	uint64 mask = (count >= 64) ? ~0ULL : ((1ULL << count) - 1);
+	return mask << x0;
+}
+
+void CGSH_Software::RasterizeTile(uint32 tileIndex, TILE_CONTEXT& tileContext) const
+{
+	tileContext.originX = (tileIndex % TILE_COUNT_X) * TILE_WIDTH;
+	tileContext.originY = (tileIndex / TILE_COUNT_X) * TILE_HEIGHT;
+
+	LoadTile(tileContext);
+
+	int clipX0 = tileContext.originX;
+	int clipY0 = tileContext.originY;
+	int clipX1 = tileContext.originX + TILE_WIDTH - 1;
+	int clipY1 = tileContext.originY + TILE_HEIGHT - 1;
+
+	//Primitives are binned in submission order, drawing order is preserved
+	for(auto primitiveIndex : m_tileBins[tileIndex])
+	{
+		const auto& primitive = m_primitives[primitiveIndex];
+		const auto& state = m_drawStates[primitive.stateIndex];
+
+		int x0 = std::max(primitive.minX, clipX0);
+		int y0 = std::max(primitive.minY, clipY0);
+		int x1 = std::min(primitive.maxX, clipX1);
+		int y1 = std::min(primitive.maxY, clipY1);
+		if((x0 > x1) || (y0 > y1)) continue;
+
+		switch(primitive.kind)
+		{
+		case PRIMITIVE_KIND_POINT:
+			DrawPoint(primitive, state, x0, y0, x1, y1, tileContext);
+			break;
+		case PRIMITIVE_KIND_LINE:
+			DrawLine(primitive, state, x0, y0, x1, y1, tileContext);
+			break;
+		case PRIMITIVE_KIND_TRIANGLE:
+			DrawTriangle(primitive, state, x0, y0, x1, y1, tileContext);
+			break;
+		case PRIMITIVE_KIND_SPRITE:
+			DrawSprite(primitive, state, x0, y0, x1, y1, tileContext);
+			break;
+		}
+	}
+
+	StoreTile(tileContext);
+}
+
+void CGSH_Software::LoadTile(TILE_CONTEXT& tileContext) const
+{
+	auto frame = m_batchTarget.frame;
+	auto zbuf = m_batchTarget.zbuf;
+	uint32 zbufPsm = PSMZ32 | zbuf.nPsm;
+
+	memset(tileContext.colorWritten, 0, sizeof(tileContext.colorWritten));
+	memset(tileContext.depthWritten, 0, sizeof(tileContext.depthWritten));
+
+	//Indexors are built once per tile and the format is resolved outside of the pixel loops
+	auto loadBuffer =
+	    [&tileContext](auto indexor, uint32* buffer, auto convert) {
+		    for(unsigned int y = 0; y < TILE_HEIGHT; y++)
+		    {
+			    uint32 pixelY = tileContext.originY + y;
+			    auto row = buffer + (y * TILE_WIDTH);
+			    for(unsigned int x = 0; x < TILE_WIDTH; x++)
+			    {
+				    row[x] = convert(indexor.GetPixel(tileContext.originX + x, pixelY));
+			    }
+		    }
+	    };
+	auto identity = [](uint32 value) { return value; };
+	auto expand16 = [](uint16 value) { return RGBA16ToRGBA32(value); };
+
+	switch(frame.nPsm)
+	{
+	case PSMCT32:
+	case PSMCT24:
+		loadBuffer(CGsPixelFormats::CPixelIndexorPSMCT32(m_pRAM, frame.GetBasePtr(), frame.nWidth), tileContext.color, identity);
+		break;
+	case PSMZ32:
+	case PSMZ24:
+		loadBuffer(CGsPixelFormats::CPixelIndexor<CGsPixelFormats::STORAGEPSMZ32>(m_pRAM, frame.GetBasePtr(), frame.nWidth), tileContext.color, identity);
+		break;
+	case PSMCT16:
+	case PSMZ16:
+		loadBuffer(CGsPixelFormats::CPixelIndexorPSMCT16(m_pRAM, frame.GetBasePtr(), frame.nWidth), tileContext.color, expand16);
+		break;
+	case PSMCT16S:
+	case PSMZ16S:
+		loadBuffer(CGsPixelFormats::CPixelIndexorPSMCT16S(m_pRAM, frame.GetBasePtr(), frame.nWidth), tileContext.color, expand16);
+		break;
+	default:
+		memset(tileContext.color, 0, sizeof(tileContext.color));
+		break;
+	}
+
+	switch(zbufPsm)
+	{
+	case PSMZ32:
+		loadBuffer(CGsPixelFormats::CPixelIndexor<CGsPixelFormats::STORAGEPSMZ32>(m_pRAM, zbuf.GetBasePtr(), frame.nWidth), tileContext.depth, identity);
+		break;
+	case PSMZ24:
+		loadBuffer(CGsPixelFormats::CPixelIndexor<CGsPixelFormats::STORAGEPSMZ32>(m_pRAM, zbuf.GetBasePtr(), frame.nWidth), tileContext.depth,
+		           [](uint32 value) { return value & 0x00FFFFFF; });
+		break;
+	case PSMZ16:
+		loadBuffer(CGsPixelFormats::CPixelIndexorPSMCT16(m_pRAM, zbuf.GetBasePtr(), frame.nWidth), tileContext.depth, identity);
+		break;
+	case PSMZ16S:
+		loadBuffer(CGsPixelFormats::CPixelIndexorPSMCT16S(m_pRAM, zbuf.GetBasePtr(), frame.nWidth), tileContext.depth, identity);
+		break;
+	default:
+		memset(tileContext.depth, 0, sizeof(tileContext.depth));
+		break;
+	}
+}
+
+void CGSH_Software::StoreTile(const TILE_CONTEXT& tileContext) const
+{
+	auto frame = m_batchTarget.frame;
+	auto zbuf = m_batchTarget.zbuf;
+	uint32 zbufPsm = PSMZ32 | zbuf.nPsm;
+
+	//Only pixels flagged as written are stored back, rows without any are skipped
+	auto storeBuffer =
+	    [&tileContext](auto indexor, const uint32* buffer, const uint64* writtenMasks, auto store) {
+		    for(unsigned int y = 0; y < TILE_HEIGHT; y++)
+		    {
+			    uint64 written = writtenMasks[y];
+			    if(written == 0) continue;
+
+			    uint32 pixelY = tileContext.originY + y;
+			    auto row = buffer + (y * TILE_WIDTH);
+			    for(unsigned int x = 0; x < TILE_WIDTH; x++)
+			    {
+				    if(written & (1ULL << x))
+				    {
+					    store(indexor, tileContext.originX + x, pixelY, row[x]);
+				    }
+			    }
+		    }
+	    };
+	auto setPixel = [](auto& indexor, uint32 x, uint32 y, uint32 value) { indexor.SetPixel(x, y, value); };
+	auto setPixel16 = [](auto& indexor, uint32 x, uint32 y, uint32 value) { indexor.SetPixel(x, y, static_cast<uint16>(value)); };
+	auto setPixelRGBA16 = [](auto& indexor, uint32 x, uint32 y, uint32 value) { indexor.SetPixel(x, y, RGBA32ToRGBA16(value)); };
+	//Upper 8 bits of memory are left untouched
+	auto setPixel24 =
+	    [](auto& indexor, uint32 x, uint32 y, uint32 value) {
+		    auto pixel = indexor.GetPixelAddress(x, y);
+		    *pixel = (*pixel & 0xFF000000) | (value & 0x00FFFFFF);
+	    };
+
+	switch(frame.nPsm)
+	{
+	case PSMCT32:
+		storeBuffer(CGsPixelFormats::CPixelIndexorPSMCT32(m_pRAM, frame.GetBasePtr(), frame.nWidth), tileContext.color, tileContext.colorWritten, setPixel);
+		break;
+	case PSMCT24:
+		storeBuffer(CGsPixelFormats::CPixelIndexorPSMCT32(m_pRAM, frame.GetBasePtr(), frame.nWidth), tileContext.color, tileContext.colorWritten, setPixel24);
+		break;
+	case PSMZ32:
+		storeBuffer(CGsPixelFormats::CPixelIndexor<CGsPixelFormats::STORAGEPSMZ32>(m_pRAM, frame.GetBasePtr(), frame.nWidth), tileContext.color, tileContext.colorWritten, setPixel);
+		break;
+	case PSMZ24:
+		storeBuffer(CGsPixelFormats::CPixelIndexor<CGsPixelFormats::STORAGEPSMZ32>(m_pRAM, frame.GetBasePtr(), frame.nWidth), tileContext.color, tileContext.colorWritten, setPixel24);
+		break;
+	case PSMCT16:
+	case PSMZ16:
+		storeBuffer(CGsPixelFormats::CPixelIndexorPSMCT16(m_pRAM, frame.GetBasePtr(), frame.nWidth), tileContext.color, tileContext.colorWritten, setPixelRGBA16);
+		break;
+	case PSMCT16S:
+	case PSMZ16S:
+		storeBuffer(CGsPixelFormats::CPixelIndexorPSMCT16S(m_pRAM, frame.GetBasePtr(), frame.nWidth), tileContext.color, tileContext.colorWritten, setPixelRGBA16);
+		break;
+	}
+
+	switch(zbufPsm)
+	{
+	case PSMZ32:
+		storeBuffer(CGsPixelFormats::CPixelIndexor<CGsPixelFormats::STORAGEPSMZ32>(m_pRAM, zbuf.GetBasePtr(), frame.nWidth), tileContext.depth, tileContext.depthWritten, setPixel);
+		break;
+	case PSMZ24:
+		storeBuffer(CGsPixelFormats::CPixelIndexor<CGsPixelFormats::STORAGEPSMZ32>(m_pRAM, zbuf.GetBasePtr(), frame.nWidth), tileContext.depth, tileContext.depthWritten, setPixel24);
+		break;
+	case PSMZ16:
+		storeBuffer(CGsPixelFormats::CPixelIndexorPSMCT16(m_pRAM, zbuf.GetBasePtr(), frame.nWidth), tileContext.depth, tileContext.depthWritten, setPixel16);
+		break;
+	case PSMZ16S:
+		storeBuffer(CGsPixelFormats::CPixelIndexorPSMCT16S(m_pRAM, zbuf.GetBasePtr(), frame.nWidth), tileContext.depth, tileContext.depthWritten, setPixel16);
+		break;
+	}
+}
+
+void CGSH_Software::DrawPoint(const PRIMITIVE& primitive, const DRAW_STATE& state, int, int, int, int, TILE_CONTEXT& tileContext) const
+{
+	//Bounding box of a point is the pixel it covers, clipping already took care of everything
+	ShadePixel(state, primitive.vertices[0], primitive.minX, primitive.minY, tileContext);
+}
+
+void CGSH_Software::DrawLine(const PRIMITIVE& primitive, const DRAW_STATE& state, int clipX0, int clipY0, int clipX1, int clipY1, TILE_CONTEXT& tileContext) const
+{
+	const auto& vertex0 = primitive.vertices[0];
+	const auto& vertex1 = primitive.vertices[1];
+
+	float dx = vertex1.x - vertex0.x;
+	float dy = vertex1.y - vertex0.y;
+	int stepCount = static_cast<int>(std::ceil(std::max(std::fabs(dx), std::fabs(dy))));
+
+	//Last pixel is left out so that connected lines don't draw their shared vertex twice
+	int pixelCount = std::max(stepCount, 1);
+	for(int i = 0; i < pixelCount; i++)
+	{
+		float t = (stepCount != 0) ? static_cast<float>(i) / static_cast<float>(stepCount) : 0;
+		int x = static_cast<int>(std::floor(vertex0.x + (dx * t) + 0.5f));
+		int y = static_cast<int>(std::floor(vertex0.y + (dy * t) + 0.5f));
+		if((x < clipX0) || (x > clipX1) || (y < clipY0) || (y > clipY1)) continue;
+
+		RASTER_VERTEX attributes;
+		attributes.x = static_cast<float>(x);
+		attributes.y = static_cast<float>(y);
+		attributes.z = vertex0.z + ((vertex1.z - vertex0.z) * t);
+		attributes.r = vertex0.r + ((vertex1.r - vertex0.r) * t);
+		attributes.g = vertex0.g + ((vertex1.g - vertex0.g) * t);
+		attributes.b = vertex0.b + ((vertex1.b - vertex0.b) * t);
+		attributes.a = vertex0.a + ((vertex1.a - vertex0.a) * t);
+		attributes.s = vertex0.s + ((vertex1.s - vertex0.s) * t);
+		attributes.t = vertex0.t + ((vertex1.t - vertex0.t) * t);
+		attributes.q = vertex0.q + ((vertex1.q - vertex0.q) * t);
+		attributes.f = vertex0.f + ((vertex1.f - vertex0.f) * t);
+		ShadePixel(state, attributes, x, y, tileContext);
+	}
+}
+
+void CGSH_Software::DrawTriangle(const PRIMITIVE& primitive, const DRAW_STATE& state, int clipX0, int clipY0, int clipX1, int clipY1, TILE_CONTEXT& tileContext) const
+{
+	const RASTER_VERTEX* vertices[3] = {&primitive.vertices[0], &primitive.vertices[1], &primitive.vertices[2]};
+
+	//Edges are evaluated in 12.4 fixed point, the native precision of vertex coordinates
+	int64 vx[3], vy[3];
+	for(unsigned int i = 0; i < 3; i++)
+	{
+		vx[i] = static_cast<int64>(vertices[i]->x * 16.0f);
+		vy[i] = static_cast<int64>(vertices[i]->y * 16.0f);
+	}
+
+	int64 area = ((vx[1] - vx[0]) * (vy[2] - vy[0])) - ((vy[1] - vy[0]) * (vx[2] - vx[0]));
+	if(area == 0) return;
+	if(area < 0)
+	{
+		std::swap(vertices[1], vertices[2]);
+		std::swap(vx[1], vx[2]);
+		std::swap(vy[1], vy[2]);
+		area = -area;
+	}
+
+	struct EDGE
+	{
+		int64 stepX;
+		int64 stepY;
+		int64 value;
+		int64 bias;
+	};
+
+	//Edge i is opposite to vertex i, its value is the barycentric weight of that vertex
+	EDGE edges[3];
+	for(unsigned int i = 0; i < 3; i++)
+	{
+		unsigned int a = (i + 1) % 3;
+		unsigned int b = (i + 2) % 3;
+		auto& edge = edges[i];
+		edge.stepX = -(vy[b] - vy[a]) * 16;
+		edge.stepY = (vx[b] - vx[a]) * 16;
+		edge.value = ((vx[b] - vx[a]) * ((clipY0 * 16) - vy[a])) - ((vy[b] - vy[a]) * ((clipX0 * 16) - vx[a]));
+		//Top-left fill convention, pixels exactly on other edges belong to neighbouring triangles
+		bool topLeft = ((vy[a] == vy[b]) && (vx[b] > vx[a])) || (vy[b] < vy[a]);
+		edge.bias = topLeft ? 0 : -1;
+	}
+
+	double invArea = 1.0 / static_cast<double>(area);
+
+	bool flatFill = IsSimpleFill(state) &&
+	                (vertices[0]->z == vertices[1]->z) && (vertices[0]->z == vertices[2]->z) &&
+	                (vertices[0]->r == vertices[1]->r) && (vertices[0]->r == vertices[2]->r) &&
+	                (vertices[0]->g == vertices[1]->g) && (vertices[0]->g == vertices[2]->g) &&
+	                (vertices[0]->b == vertices[1]->b) && (vertices[0]->b == vertices[2]->b) &&
+	                (vertices[0]->a == vertices[1]->a) && (vertices[0]->a == vertices[2]->a);
+	uint32 fillColor = 0;
+	uint32 fillDepth = 0;
+	if(flatFill)
+	{
+		fillColor = ClampColor(static_cast<int>(vertices[0]->r)) |
+		            (ClampColor(static_cast<int>(vertices[0]->g)) << 8) |
+		            (ClampColor(static_cast<int>(vertices[0]->b)) << 16) |
+		            (ClampColor(static_cast<int>(vertices[0]->a)) << 24);
+		fillDepth = static_cast<uint32>(std::min<double>(vertices[0]->z, GetDepthMax()));
+	}
+
+	for(int y = clipY0; y <= clipY1; y++)
+	{
+		int64 rowValues[3] = {edges[0].value, edges[1].value, edges[2].value};
+		int spanStart = -1;
+		int spanEnd = -1;
+		for(int x = clipX0; x <= clipX1; x++)
+		{
+			bool inside =
+			    ((rowValues[0] + edges[0].bias) >= 0) &&
+			    ((rowValues[1] + edges[1].bias) >= 0) &&
+			    ((rowValues[2] + edges[2].bias) >= 0);
+			if(inside)
+			{
+				if(spanStart < 0) spanStart = x;
+				spanEnd = x;
+				if(!flatFill)
+				{
+					double w0 = static_cast<double>(rowValues[0]) * invArea;
+					double w1 = static_cast<double>(rowValues[1]) * invArea;
+					double w2 = static_cast<double>(rowValues[2]) * invArea;
+					float fw0 = static_cast<float>(w0);
+					float fw1 = static_cast<float>(w1);
+					float fw2 = static_cast<float>(w2);
+
+					RASTER_VERTEX attributes;
+					attributes.x = static_cast<float>(x);
+					attributes.y = static_cast<float>(y);
+					attributes.z = (vertices[0]->z * w0) + (vertices[1]->z * w1) + (vertices[2]->z * w2);
+					attributes.r = (vertices[0]->r * fw0) + (vertices[1]->r * fw1) + (vertices[2]->r * fw2);
+					attributes.g = (vertices[0]->g * fw0) + (vertices[1]->g * fw1) + (vertices[2]->g * fw2);
+					attributes.b = (vertices[0]->b * fw0) + (vertices[1]->b * fw1) + (vertices[2]->b * fw2);
+					attributes.a = (vertices[0]->a * fw0) + (vertices[1]->a * fw1) + (vertices[2]->a * fw2);
+					attributes.s = (vertices[0]->s * fw0) + (vertices[1]->s * fw1) + (vertices[2]->s * fw2);
+					attributes.t = (vertices[0]->t * fw0) + (vertices[1]->t * fw1) + (vertices[2]->t * fw2);
+					attributes.q = (vertices[0]->q * fw0) + (vertices[1]->q * fw1) + (vertices[2]->q * fw2);
+					attributes.f = (vertices[0]->f * fw0) + (vertices[1]->f * fw1) + (vertices[2]->f * fw2);
+					ShadePixel(state, attributes, x, y, tileContext);
+				}
+			}
+			else if(spanStart >= 0)
+			{
+				//Triangles are convex, nothing else on this row
+				break;
+			}
+			rowValues[0] += edges[0].stepX;
+			rowValues[1] += edges[1].stepX;
+			rowValues[2] += edges[2].stepX;
+		}
+		if(flatFill && (spanStart >= 0))
+		{
+			FillSpan(state, fillColor, fillDepth, y, spanStart, spanEnd, tileContext);
+		}
+		edges[0].value += edges[0].stepY;
+		edges[1].value += edges[1].stepY;
+		edges[2].value += edges[2].stepY;
+	}
+}
+
+void CGSH_Software::DrawSprite(const PRIMITIVE& primitive, const DRAW_STATE& state, int clipX0, int clipY0, int clipX1, int clipY1, TILE_CONTEXT& tileContext) const
+{
+	const auto& vertex0 = primitive.vertices[0];
+	const auto& vertex1 = primitive.vertices[1];
+
+	if(IsSimpleFill(state))
+	{
+		uint32 color = ClampColor(static_cast<int>(vertex1.r)) |
+		               (ClampColor(static_cast<int>(vertex1.g)) << 8) |
+		               (ClampColor(static_cast<int>(vertex1.b)) << 16) |
+		               (ClampColor(static_cast<int>(vertex1.a)) << 24);
+		uint32 depth = static_cast<uint32>(std::min<double>(vertex1.z, GetDepthMax()));
+		for(int y = clipY0; y <= clipY1; y++)
+		{
+			FillSpan(state, color, depth, y, clipX0, clipX1, tileContext);
+		}
+		return;
+	}
+
+	float width = vertex1.x - vertex0.x;
+	float height = vertex1.y - vertex0.y;
+	if((width == 0) || (height == 0)) return;
+
+	float dsdx = (vertex1.s - vertex0.s) / width;
+	float dtdy = (vertex1.t - vertex0.t) / height;
+
+	RASTER_VERTEX attributes = vertex1;
+	for(int y = clipY0; y <= clipY1; y++)
+	{
+		attributes.y = static_cast<float>(y);
+		attributes.t = vertex0.t + ((static_cast<float>(y) - vertex0.y) * dtdy);
+		for(int x = clipX0; x <= clipX1; x++)
+		{
+			attributes.x = static_cast<float>(x);
+			attributes.s = vertex0.s + ((static_cast<float>(x) - vertex0.x) * dsdx);
+			ShadePixel(state, attributes, x, y, tileContext);
+		}
+	}
+}
+
+//Writes a run of pixels that need no per pixel processing
+void CGSH_Software::FillSpan(const DRAW_STATE& state, uint32 color, uint32 depth, int y, int x0, int x1, TILE_CONTEXT& tileContext) const
+{
+	int row = y - tileContext.originY;
+	int startX = x0 - tileContext.originX;
+	int endX = x1 - tileContext.originX;
+	assert((row >= 0) && (row < TILE_HEIGHT));
+	assert((startX >= 0) && (endX < TILE_WIDTH) && (startX <= endX));
+
+	if(IsPsm16Bits(m_batchTarget.frame.nPsm))
+	{
+		color &= 0x80F8F8F8;
+	}
+
+	auto colorRow = tileContext.color + (row * TILE_WIDTH);
+	int x = startX;
+#if defined(GSH_SOFTWARE_SSE2)
+	__m128i colorVector = _mm_set1_epi32(static_cast<int>(color));
+	for(; (x + 4) <= (endX + 1); x += 4)
+	{
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(colorRow + x), colorVector);
+	}
+#elif defined(GSH_SOFTWARE_NEON)
+	uint32x4_t colorVector = vdupq_n_u32(color);
+	for(; (x + 4) <= (endX + 1); x += 4)
+	{
+		vst1q_u32(colorRow + x, colorVector);
+	}
+#endif
+	for(; x <= endX; x++)
+	{
+		colorRow[x] = color;
+	}
+
+	uint64 spanMask = MakeSpanMask(startX, endX);
+	tileContext.colorWritten[row] |= spanMask;
+
+	bool depthWrite = state.test.nDepthEnabled && !m_batchTarget.zbuf.nMask;
+	if(depthWrite)
+	{
+		std::fill(tileContext.depth + (row * TILE_WIDTH) + startX, tileContext.depth + (row * TILE_WIDTH) + endX + 1, depth);
+		tileContext.depthWritten[row] |= spanMask;
+	}
+}
+
+void CGSH_Software::ShadePixel(const DRAW_STATE& state, const RASTER_VERTEX& attributes, int x, int y, TILE_CONTEXT& tileContext) const
+{
+	int row = y - tileContext.originY;
+	int column = x - tileContext.originX;
+	assert((row >= 0) && (row < TILE_HEIGHT));
+	assert((column >= 0) && (column < TILE_WIDTH));
+
+	unsigned int pixelIndex = column + (row * TILE_WIDTH);
+	uint64 pixelBit = 1ULL << column;
+
+	const auto& frame = m_batchTarget.frame;
+	const auto& test = state.test;
+	bool frame16Bits = IsPsm16Bits(frame.nPsm);
+	bool frameHasAlpha = (frame.nPsm != PSMCT24) && (frame.nPsm != PSMZ24);
+
+	int r = ClampColor(static_cast<int>(attributes.r));
+	int g = ClampColor(static_cast<int>(attributes.g));
+	int b = ClampColor(static_cast<int>(attributes.b));
+	int a = ClampColor(static_cast<int>(attributes.a));
+
+	if(state.primMode.nTexture)
+	{
+		float q = (attributes.q != 0) ? attributes.q : 1.0f;
+		uint32 texel = SampleTexture(state, attributes.s / q, attributes.t / q);
+		int tr = (texel >> 0) & 0xFF;
+		int tg = (texel >> 8) & 0xFF;
+		int tb = (texel >> 16) & 0xFF;
+		int ta = (texel >> 24) & 0xFF;
+		bool useTextureAlpha = (state.tex0.nColorComp != 0);
+		switch(state.tex0.nFunction)
+		{
+		case TEX0_FUNCTION_MODULATE:
+			r = std::min((tr * r) >> 7, 255);
+			g = std::min((tg * g) >> 7, 255);
+			b = std::min((tb * b) >> 7, 255);
+			if(useTextureAlpha) a = std::min((ta * a) >> 7, 255);
+			break;
+		case TEX0_FUNCTION_DECAL:
+			r = tr;
+			g = tg;
+			b = tb;
+			if(useTextureAlpha) a = ta;
+			break;
+		case TEX0_FUNCTION_HIGHLIGHT:
+			r = std::min(((tr * r) >> 7) + a, 255);
+			g = std::min(((tg * g) >> 7) + a, 255);
+			b = std::min(((tb * b) >> 7) + a, 255);
+			if(useTextureAlpha) a = std::min(ta + a, 255);
+			break;
+		case TEX0_FUNCTION_HIGHLIGHT2:
+			r = std::min(((tr * r) >> 7) + a, 255);
+			g = std::min(((tg * g) >> 7) + a, 255);
+			b = std::min(((tb * b) >> 7) + a, 255);
+			if(useTextureAlpha) a = ta;
+			break;
+		}
+	}
+
+	if(state.primMode.nFog)
+	{
+		int f = ClampColor(static_cast<int>(attributes.f));
+		r = ((f * r) + ((255 - f) * static_cast<int>(state.fogCol.nFCR))) >> 8;
+		g = ((f * g) + ((255 - f) * static_cast<int>(state.fogCol.nFCG))) >> 8;
+		b = ((f * b) + ((255 - f) * static_cast<int>(state.fogCol.nFCB))) >> 8;
+	}
+
+	bool colorWrite = true;
+	bool alphaWrite = true;
+	bool depthWrite = test.nDepthEnabled && !m_batchTarget.zbuf.nMask;
+
+	if(test.nAlphaEnabled)
+	{
+		int alphaRef = test.nAlphaRef;
+		bool passed = true;
+		switch(test.nAlphaMethod)
+		{
+		case ALPHA_TEST_NEVER:
+			passed = false;
+			break;
+		case ALPHA_TEST_ALWAYS:
+			passed = true;
+			break;
+		case ALPHA_TEST_LESS:
+			passed = (a < alphaRef);
+			break;
+		case ALPHA_TEST_LEQUAL:
+			passed = (a <= alphaRef);
+			break;
+		case ALPHA_TEST_EQUAL:
+			passed = (a == alphaRef);
+			break;
+		case ALPHA_TEST_GEQUAL:
+			passed = (a >= alphaRef);
+			break;
+		case ALPHA_TEST_GREATER:
+			passed = (a > alphaRef);
+			break;
+		case ALPHA_TEST_NOTEQUAL:
+			passed = (a != alphaRef);
+			break;
+		}
+		if(!passed)
+		{
+			switch(test.nAlphaFail)
+			{
+			case ALPHA_TEST_FAIL_KEEP:
+				return;
+			case ALPHA_TEST_FAIL_FBONLY:
+				depthWrite = false;
+				break;
+			case ALPHA_TEST_FAIL_ZBONLY:
+				colorWrite = false;
+				alphaWrite = false;
+				break;
+			case ALPHA_TEST_FAIL_RGBONLY:
+				alphaWrite = false;
+				depthWrite = false;
+				break;
+			}
+		}
+	}
+
+	uint32 dstColor = tileContext.color[pixelIndex];
+
+	if(test.nDestAlphaEnabled && frameHasAlpha)
+	{
+		uint32 dstAlphaBit = (dstColor >> 31) & 1;
+		if(dstAlphaBit != test.nDestAlphaMode) return;
+	}
+
+	uint32 depth = static_cast<uint32>(std::min<double>(std::max<double>(attributes.z, 0), GetDepthMax()));
+	if(test.nDepthEnabled)
+	{
+		uint32 dstDepth = tileContext.depth[pixelIndex];
+		bool passed = true;
+		switch(test.nDepthMethod)
+		{
+		case DEPTH_TEST_NEVER:
+			passed = false;
+			break;
+		case DEPTH_TEST_ALWAYS:
+			passed = true;
+			break;
+		case DEPTH_TEST_GEQUAL:
+			passed = (depth >= dstDepth);
+			break;
+		case DEPTH_TEST_GREATER:
+			passed = (depth > dstDepth);
+			break;
+		}
+		if(!passed) return;
+	}
+
+	if(state.primMode.nAlpha && !(state.pabe && ((a & 0x80) == 0)))
+	{
+		int dstR = (dstColor >> 0) & 0xFF;
+		int dstG = (dstColor >> 8) & 0xFF;
+		int dstB = (dstColor >> 16) & 0xFF;
+		int dstA = frameHasAlpha ? ((dstColor >> 24) & 0xFF) : 0x80;
+
+		const auto& alpha = state.alpha;
+		int srcColor[3] = {r, g, b};
+		int dstColors[3] = {dstR, dstG, dstB};
+		int coef = 0;
+		switch(alpha.nC)
+		{
+		case ALPHABLEND_C_AS:
+			coef = a;
+			break;
+		case ALPHABLEND_C_AD:
+			coef = dstA;
+			break;
+		default:
+			coef = alpha.nFix;
+			break;
+		}
+
+		int result[3];
+		for(unsigned int i = 0; i < 3; i++)
+		{
+			int inputs[3] = {srcColor[i], dstColors[i], 0};
+			int valueA = inputs[std::min<unsigned int>(alpha.nA, 2)];
+			int valueB = inputs[std::min<unsigned int>(alpha.nB, 2)];
+			int valueD = inputs[std::min<unsigned int>(alpha.nD, 2)];
+			int value = (((valueA - valueB) * coef) >> 7) + valueD;
+			result[i] = state.colClamp ? ClampColor(value) : (value & 0xFF);
+		}
+		r = result[0];
+		g = result[1];
+		b = result[2];
+	}
+
+	if(state.fba)
+	{
+		a |= 0x80;
+	}
+
+	if(colorWrite)
+	{
+		uint32 srcColor = r | (g << 8) | (b << 16) | (a << 24);
+		uint32 writeMask = ~frame.nMask;
+		if(!alphaWrite || !frameHasAlpha)
+		{
+			writeMask &= 0x00FFFFFF;
+		}
+		uint32 newColor = (srcColor & writeMask) | (dstColor & ~writeMask);
+		if(frame16Bits)
+		{
+			newColor &= 0x80F8F8F8;
+		}
+		tileContext.color[pixelIndex] = newColor;
+		tileContext.colorWritten[row] |= pixelBit;
+	}
+
+	if(depthWrite)
+	{
+		tileContext.depth[pixelIndex] = depth;
+		tileContext.depthWritten[row] |= pixelBit;
+	}
+}
+
+uint32 CGSH_Software::SampleTexture(const DRAW_STATE& state, float s, float t) const
+{
+	int width = state.tex0.GetWidth();
+	int height = state.tex0.GetHeight();
+	int u = static_cast<int>(std::floor(s));
+	int v = static_cast<int>(std::floor(t));
+
+	const auto& clamp = state.clamp;
+	int minU = clamp.nMINU;
+	int maxU = clamp.nMAXU;
+	int minV = clamp.nReserved0 | (clamp.nReserved1 << 8);
+	int maxV = clamp.nMAXV;
+
+	switch(clamp.nWMS)
+	{
+	case CLAMP_MODE_REPEAT:
+		u &= (width - 1);
+		break;
+	case CLAMP_MODE_CLAMP:
+		u = std::min(std::max(u, 0), width - 1);
+		break;
+	case CLAMP_MODE_REGION_CLAMP:
+		u = std::min(std::max(u, minU), maxU);
+		break;
+	case CLAMP_MODE_REGION_REPEAT:
+		u = (u & minU) | maxU;
+		break;
+	}
+
+	switch(clamp.nWMT)
+	{
+	case CLAMP_MODE_REPEAT:
+		v &= (height - 1);
+		break;
+	case CLAMP_MODE_CLAMP:
+		v = std::min(std::max(v, 0), height - 1);
+		break;
+	case CLAMP_MODE_REGION_CLAMP:
+		v = std::min(std::max(v, minV), maxV);
+		break;
+	case CLAMP_MODE_REGION_REPEAT:
+		v = (v & minV) | maxV;
+		break;
+	}
+
+	return FetchTexel(state, static_cast<uint32>(u) % MAX_COORD, static_cast<uint32>(v) % MAX_COORD);
+}
+
+uint32 CGSH_Software::FetchTexel(const DRAW_STATE& state, uint32 u, uint32 v) const
+{
+	const auto& tex0 = state.tex0;
+	const auto& texa = state.texa;
+	uint32 bufPtr = tex0.GetBufPtr();
+	uint32 bufWidth = tex0.nBufWidth;
+
+	auto expandAlpha =
+	    [&texa](uint32 rgb, bool alphaBit) -> uint32 {
+		    uint32 alpha = alphaBit ? texa.nTA1 : texa.nTA0;
+		    if(!alphaBit && texa.nAEM && (rgb == 0)) alpha = 0;
+		    return rgb | (alpha << 24);
+	    };
+
+	switch(tex0.nPsm)
+	{
+	case PSMCT32:
+		return CGsPixelFormats::CPixelIndexorPSMCT32(m_pRAM, bufPtr, bufWidth).GetPixel(u, v);
+	case PSMZ32:
+		return CGsPixelFormats::CPixelIndexor<CGsPixelFormats::STORAGEPSMZ32>(m_pRAM, bufPtr, bufWidth).GetPixel(u, v);
+	case PSMCT24:
+		return expandAlpha(CGsPixelFormats::CPixelIndexorPSMCT32(m_pRAM, bufPtr, bufWidth).GetPixel(u, v) & 0x00FFFFFF, false);
+	case PSMZ24:
+		return expandAlpha(CGsPixelFormats::CPixelIndexor<CGsPixelFormats::STORAGEPSMZ32>(m_pRAM, bufPtr, bufWidth).GetPixel(u, v) & 0x00FFFFFF, false);
+	case PSMCT16:
+	case PSMZ16:
+	{
+		uint32 color = RGBA16ToRGBA32(CGsPixelFormats::CPixelIndexorPSMCT16(m_pRAM, bufPtr, bufWidth).GetPixel(u, v));
+		return expandAlpha(color & 0x00FFFFFF, (color & 0x80000000) != 0);
+	}
+	case PSMCT16S:
+	case PSMZ16S:
+	{
+		uint32 color = RGBA16ToRGBA32(CGsPixelFormats::CPixelIndexorPSMCT16S(m_pRAM, bufPtr, bufWidth).GetPixel(u, v));
+		return expandAlpha(color & 0x00FFFFFF, (color & 0x80000000) != 0);
+	}
+	case PSMT8:
+		return state.clut[CGsPixelFormats::CPixelIndexorPSMT8(m_pRAM, bufPtr, bufWidth).GetPixel(u, v)];
+	case PSMT4:
+		return state.clut[CGsPixelFormats::CPixelIndexorPSMT4(m_pRAM, bufPtr, bufWidth).GetPixel(u, v)];
+	case PSMT8H:
+		return state.clut[CGsPixelFormats::CPixelIndexorPSMCT32(m_pRAM, bufPtr, bufWidth).GetPixel(u, v) >> 24];
+	case PSMT4HL:
+		return state.clut[(CGsPixelFormats::CPixelIndexorPSMCT32(m_pRAM, bufPtr, bufWidth).GetPixel(u, v) >> 24) & 0x0F];
+	case PSMT4HH:
+		return state.clut[CGsPixelFormats::CPixelIndexorPSMCT32(m_pRAM, bufPtr, bufWidth).GetPixel(u, v) >> 28];
+	default:
+		return 0;
+	}
+}
+
+//Primitives that write the same value to every covered pixel
+bool CGSH_Software::IsSimpleFill(const DRAW_STATE& state) const
+{
+	const auto& test = state.test;
+	if(state.primMode.nTexture || state.primMode.nFog || state.primMode.nAlpha) return false;
+	if(test.nAlphaEnabled && (test.nAlphaMethod != ALPHA_TEST_ALWAYS)) return false;
+	if(test.nDestAlphaEnabled) return false;
+	if(test.nDepthEnabled && (test.nDepthMethod != DEPTH_TEST_ALWAYS)) return false;
+	if(state.fba) return false;
+
+	const auto& frame = m_batchTarget.frame;
+	if(frame.nMask != 0) return false;
+	switch(frame.nPsm)
+	{
+	case PSMCT32:
+	case PSMCT16:
+	case PSMCT16S:
+		return true;
+	default:
+		return false;
+	}
+}
+
+uint32 CGSH_Software::GetDepthMax() const
+{
+	switch(PSMZ32 | m_batchTarget.zbuf.nPsm)
+	{
+	case PSMZ32:
+		return 0xFFFFFFFF;
+	case PSMZ24:
+		return 0x00FFFFFF;
+	default:
+		return 0x0000FFFF;
+	}
+}
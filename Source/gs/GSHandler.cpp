@@ -1,6 +1,8 @@
 #include <stdio.h>
 #include <string.h>
 #include <functional>
+#include <memory>
+#include <type_traits>
 #include "../AppConfig.h"
 #include "../Log.h"
 #include "../states/MemoryStateFile.h"
@@ -9,6 +11,7 @@
 #include "../ee/INTC.h"
 #include "GSHandler.h"
 #include "GsPixelFormats.h"
+#include "GsBlockSwizzle.h"
 #include "string_format.h"
 
 //Shadow Hearts 2 looks for this specific value
@@ -54,14 +57,6 @@
 
 #define LOG_NAME ("gs")
 
-struct MASSIVEWRITE_INFO
-{
-#ifdef DEBUGGER_INCLUDED
-	CGsPacketMetadata metadata;
-#endif
-	CGSHandler::RegisterWriteList writes;
-};
-
 CGSHandler::CGSHandler(bool gsThreaded)
     : m_threadDone(false)
     , m_drawCallCount(0)
@@ -70,6 +65,7 @@ CGSHandler::CGSHandler(bool gsThreaded)
     , m_frameDump(nullptr)
     , m_loggingEnabled(true)
     , m_gsThreaded(gsThreaded)
+    , m_pendingCallCount(0)
 {
 	RegisterPreferences();
 
@@ -86,24 +82,46 @@ CGSHandler::CGSHandler(bool gsThreaded)
 		m_transferReadHandlers[i] = &CGSHandler::TransferReadHandlerInvalid;
 	}
 
-	m_transferWriteHandlers[PSMCT32] = &CGSHandler::TransferWriteHandlerGeneric<CGsPixelFormats::STORAGEPSMCT32>;
-	m_transferWriteHandlers[PSMCT24] = &CGSHandler::TransferWriteHandlerPSMCT24;
-	m_transferWriteHandlers[PSMCT16] = &CGSHandler::TransferWriteHandlerGeneric<CGsPixelFormats::STORAGEPSMCT16>;
-	m_transferWriteHandlers[PSMCT16S] = &CGSHandler::TransferWriteHandlerGeneric<CGsPixelFormats::STORAGEPSMCT16S>;
-	m_transferWriteHandlers[PSMT8] = &CGSHandler::TransferWriteHandlerGeneric<CGsPixelFormats::STORAGEPSMT8>;
-	m_transferWriteHandlers[PSMT4] = &CGSHandler::TransferWriteHandlerPSMT4;
-	m_transferWriteHandlers[PSMT8H] = &CGSHandler::TransferWriteHandlerPSMT8H;
-	m_transferWriteHandlers[PSMT4HL] = &CGSHandler::TransferWriteHandlerPSMT4H<24, 0x0F000000>;
-	m_transferWriteHandlers[PSMT4HH] = &CGSHandler::TransferWriteHandlerPSMT4H<28, 0xF0000000>;
-
-	m_transferReadHandlers[PSMCT32] = &CGSHandler::TransferReadHandlerGeneric<CGsPixelFormats::STORAGEPSMCT32>;
-	m_transferReadHandlers[PSMT8] = &CGSHandler::TransferReadHandlerGeneric<CGsPixelFormats::STORAGEPSMT8>;
+	//Transfers aligned on blocks are swizzled a block at a time, per pixel handlers take care of the rest
+	typedef CGsPixelFormats::STORAGEPSMCT32 StoragePSMCT32;
+	typedef CGsPixelFormats::STORAGEPSMZ32 StoragePSMZ32;
+	typedef CGsPixelFormats::STORAGEPSMCT16 StoragePSMCT16;
+	typedef CGsPixelFormats::STORAGEPSMCT16S StoragePSMCT16S;
+	typedef CGsPixelFormats::STORAGEPSMT8 StoragePSMT8;
+	typedef CGsPixelFormats::STORAGEPSMT4 StoragePSMT4;
+
+	m_transferWriteHandlers[PSMCT32] = &CGSHandler::TransferWriteHandlerBlocks<StoragePSMCT32, 32, &CGsBlockSwizzle::WriteBlock<StoragePSMCT32>, &CGSHandler::TransferWriteHandlerGeneric<StoragePSMCT32>>;
+	m_transferWriteHandlers[PSMCT24] = &CGSHandler::TransferWriteHandlerBlocks<StoragePSMCT32, 24, &CGsBlockSwizzle::WriteBlockPSMCT24, &CGSHandler::TransferWriteHandlerPSMCT24>;
+	m_transferWriteHandlers[PSMCT16] = &CGSHandler::TransferWriteHandlerBlocks<StoragePSMCT16, 16, &CGsBlockSwizzle::WriteBlock<StoragePSMCT16>, &CGSHandler::TransferWriteHandlerGeneric<StoragePSMCT16>>;
+	m_transferWriteHandlers[PSMCT16S] = &CGSHandler::TransferWriteHandlerBlocks<StoragePSMCT16S, 16, &CGsBlockSwizzle::WriteBlock<StoragePSMCT16S>, &CGSHandler::TransferWriteHandlerGeneric<StoragePSMCT16S>>;
+	m_transferWriteHandlers[PSMT8] = &CGSHandler::TransferWriteHandlerBlocks<StoragePSMT8, 8, &CGsBlockSwizzle::WriteBlock<StoragePSMT8>, &CGSHandler::TransferWriteHandlerGeneric<StoragePSMT8>>;
+	m_transferWriteHandlers[PSMT4] = &CGSHandler::TransferWriteHandlerBlocks<StoragePSMT4, 4, &CGsBlockSwizzle::WriteBlock<StoragePSMT4>, &CGSHandler::TransferWriteHandlerPSMT4>;
+	m_transferWriteHandlers[PSMT8H] = &CGSHandler::TransferWriteHandlerBlocks<StoragePSMCT32, 8, &CGsBlockSwizzle::WriteBlockPSMT8H, &CGSHandler::TransferWriteHandlerPSMT8H>;
+	m_transferWriteHandlers[PSMT4HL] = &CGSHandler::TransferWriteHandlerBlocks<StoragePSMCT32, 4, &CGsBlockSwizzle::WriteBlockPSMT4H<24, 0x0F000000>, &CGSHandler::TransferWriteHandlerPSMT4H<24, 0x0F000000>>;
+	m_transferWriteHandlers[PSMT4HH] = &CGSHandler::TransferWriteHandlerBlocks<StoragePSMCT32, 4, &CGsBlockSwizzle::WriteBlockPSMT4H<28, 0xF0000000>, &CGSHandler::TransferWriteHandlerPSMT4H<28, 0xF0000000>>;
+
+	//Blocks of PSMZ32 have the same layout as PSMCT32 ones, only their arrangement in a page differs
+	m_transferReadHandlers[PSMCT32] = &CGSHandler::TransferReadHandlerBlocks<StoragePSMCT32, 32, &CGsBlockSwizzle::ReadBlock<StoragePSMCT32>, &CGSHandler::TransferReadHandlerGeneric<StoragePSMCT32>>;
+	m_transferReadHandlers[PSMCT24] = &CGSHandler::TransferReadHandlerBlocks<StoragePSMCT32, 24, &CGsBlockSwizzle::ReadBlockPSMCT24, &CGSHandler::TransferReadHandlerPSMCT24<StoragePSMCT32>>;
+	m_transferReadHandlers[PSMCT16] = &CGSHandler::TransferReadHandlerBlocks<StoragePSMCT16, 16, &CGsBlockSwizzle::ReadBlock<StoragePSMCT16>, &CGSHandler::TransferReadHandlerGeneric<StoragePSMCT16>>;
+	m_transferReadHandlers[PSMCT16S] = &CGSHandler::TransferReadHandlerBlocks<StoragePSMCT16S, 16, &CGsBlockSwizzle::ReadBlock<StoragePSMCT16S>, &CGSHandler::TransferReadHandlerGeneric<StoragePSMCT16S>>;
+	m_transferReadHandlers[PSMT8] = &CGSHandler::TransferReadHandlerBlocks<StoragePSMT8, 8, &CGsBlockSwizzle::ReadBlock<StoragePSMT8>, &CGSHandler::TransferReadHandlerGeneric<StoragePSMT8>>;
+	m_transferReadHandlers[PSMT4] = &CGSHandler::TransferReadHandlerBlocks<StoragePSMT4, 4, &CGsBlockSwizzle::ReadBlock<StoragePSMT4>, &CGSHandler::TransferReadHandlerPSMT4>;
+	m_transferReadHandlers[PSMT8H] = &CGSHandler::TransferReadHandlerBlocks<StoragePSMCT32, 8, &CGsBlockSwizzle::ReadBlockPSMT8H, &CGSHandler::TransferReadHandlerPSMT8H>;
+	m_transferReadHandlers[PSMT4HL] = &CGSHandler::TransferReadHandlerBlocks<StoragePSMCT32, 4, &CGsBlockSwizzle::ReadBlockPSMT4H<24>, &CGSHandler::TransferReadHandlerPSMT4H<24>>;
+	m_transferReadHandlers[PSMT4HH] = &CGSHandler::TransferReadHandlerBlocks<StoragePSMCT32, 4, &CGsBlockSwizzle::ReadBlockPSMT4H<28>, &CGSHandler::TransferReadHandlerPSMT4H<28>>;
+	m_transferReadHandlers[PSMZ32] = &CGSHandler::TransferReadHandlerBlocks<StoragePSMZ32, 32, &CGsBlockSwizzle::ReadBlock<StoragePSMCT32>, &CGSHandler::TransferReadHandlerGeneric<StoragePSMZ32>>;
+	m_transferReadHandlers[PSMZ24] = &CGSHandler::TransferReadHandlerBlocks<StoragePSMZ32, 24, &CGsBlockSwizzle::ReadBlockPSMCT24, &CGSHandler::TransferReadHandlerPSMCT24<StoragePSMZ32>>;
 
 	ResetBase();
 
 	if(m_gsThreaded)
 	{
-		m_thread = std::thread([&]() { ThreadProc(); });
+		//Runs in the same log context as the virtual machine creating it
+		m_thread = std::thread([this, logContext = CLog::GetThreadContext()]() {
+			CLog::SetThreadContext(logContext);
+			ThreadProc();
+		});
 	}
 }
 
@@ -121,6 +139,7 @@ CGSHandler::~CGSHandler()
 void CGSHandler::RegisterPreferences()
 {
 	CAppConfig::GetInstance().RegisterPreferenceInteger(PREF_CGSHANDLER_PRESENTATION_MODE, CGSHandler::PRESENTATION_MODE_FIT);
+	CAppConfig::GetInstance().RegisterPreferenceInteger(PREF_CGSHANDLER_TEXTURECACHE_SIZE, 256);
 }
 
 void CGSHandler::NotifyPreferencesChanged()
@@ -436,22 +455,78 @@ void CGSHandler::SetSMODE2(uint64 value)
 
 void CGSHandler::WriteRegister(uint8 registerId, uint64 value)
 {
-	SendGSCall(std::bind(&CGSHandler::WriteRegisterImpl, this, registerId, value));
+	m_commandRing.BeginWrite(GS_COMMAND_WRITEREGISTER, registerId, value, 0);
+	m_commandRing.EndWrite();
 }
 
 void CGSHandler::FeedImageData(const void* data, uint32 length)
 {
+	auto imageData = BeginImageData(length);
+	memcpy(imageData, data, length);
+	EndImageData();
+}
+
+//Returns a buffer where the caller writes image data that will be sent to the GS thread when
+//EndImageData is called. Buffers come from the command ring or from a pool for large transfers.
+//Callers should fill it straight from guest memory instead of going through FeedImageData.
+uint8* CGSHandler::BeginImageData(uint32 length)
+{
+	assert(!m_pendingImageData);
 	m_transferCount++;
 
+	m_transferStats.imageBytes += length;
+	m_transferStats.imagePackets++;
+
 	//Allocate 0x10 more bytes to allow transfer handlers
 	//to read beyond the actual length of the buffer (ie.: PSMCT24)
+	uint32 payloadSize = length + 0x10;
 
-	std::vector<uint8> imageData(length + 0x10);
-	memcpy(imageData.data(), data, length);
-	SendGSCall(
-	    [this, imageData = std::move(imageData), length]() {
-		    FeedImageDataImpl(imageData.data(), length);
-	    });
+	uint8* imageData = nullptr;
+	if(payloadSize > m_commandRing.GetMaxPayloadSize())
+	{
+		m_pendingImageBuffer = m_transferBufferPool.Acquire(payloadSize);
+		imageData = m_pendingImageBuffer.get();
+	}
+	else
+	{
+		m_transferStats.ringPackets++;
+		imageData = m_commandRing.BeginWrite(GS_COMMAND_FEEDIMAGEDATA, 0, length, payloadSize);
+	}
+
+	memset(imageData + length, 0, payloadSize - length);
+	m_pendingImageData = imageData;
+	m_pendingImageLength = length;
+	return imageData;
+}
+
+void CGSHandler::EndImageData()
+{
+	assert(m_pendingImageData);
+	uint32 length = m_pendingImageLength;
+	m_pendingImageData = nullptr;
+	m_pendingImageLength = 0;
+
+	if(m_pendingImageBuffer)
+	{
+		auto imageBuffer = std::move(m_pendingImageBuffer);
+		SendGSCall(
+		    [this, imageBuffer = std::move(imageBuffer), length]() {
+			    FeedImageDataImpl(imageBuffer.get(), length);
+		    });
+	}
+	else
+	{
+		m_commandRing.EndWrite();
+	}
+}
+
+CGSHandler::TRANSFER_STATS CGSHandler::GetTransferStats() const
+{
+	auto stats = m_transferStats;
+	auto poolStats = m_transferBufferPool.GetStats();
+	stats.allocations = poolStats.allocations;
+	stats.allocationsSaved = poolStats.reuses;
+	return stats;
 }
 
 void CGSHandler::ReadImageData(void* data, uint32 length)
@@ -495,23 +570,46 @@ void CGSHandler::WriteRegisterMassively(RegisterWriteList registerWrites, const
 
 	m_transferCount++;
 
-	MASSIVEWRITE_INFO massiveWrite;
-	massiveWrite.writes = std::move(registerWrites);
+#ifdef DEBUGGER_INCLUDED
+	uint32 metadataSize = (sizeof(CGsPacketMetadata) + 0xF) & ~0xF;
+#else
+	uint32 metadataSize = 0;
+#endif
+	uint32 payloadSize = metadataSize + static_cast<uint32>(registerWrites.size() * sizeof(RegisterWrite));
+
+	if(payloadSize > m_commandRing.GetMaxPayloadSize())
+	{
+#ifdef DEBUGGER_INCLUDED
+		auto packetMetadata = (metadata != nullptr) ? *metadata : CGsPacketMetadata();
+#endif
+		SendGSCall(
+		    [=, registerWrites = std::move(registerWrites)]() {
+#ifdef DEBUGGER_INCLUDED
+			    WriteRegisterMassivelyImpl(registerWrites.data(), static_cast<uint32>(registerWrites.size()), &packetMetadata);
+#else
+			    WriteRegisterMassivelyImpl(registerWrites.data(), static_cast<uint32>(registerWrites.size()), nullptr);
+#endif
+		    });
+		return;
+	}
+
+	//Payloads are constructed in place and never destroyed, the GS thread reads them and moves on
+	static_assert(std::is_trivially_destructible<CGsPacketMetadata>::value, "CGsPacketMetadata must be trivially destructible.");
+	static_assert(std::is_trivially_destructible<RegisterWrite>::value, "RegisterWrite must be trivially destructible.");
+
+	auto payload = m_commandRing.BeginWrite(GS_COMMAND_WRITEREGISTERMASSIVELY, 0, registerWrites.size(), payloadSize);
 #ifdef DEBUGGER_INCLUDED
 	if(metadata != nullptr)
 	{
-		memcpy(&massiveWrite.metadata, metadata, sizeof(CGsPacketMetadata));
+		new(payload) CGsPacketMetadata(*metadata);
 	}
 	else
 	{
-		massiveWrite.metadata = CGsPacketMetadata();
+		new(payload) CGsPacketMetadata();
 	}
 #endif
-
-	SendGSCall(
-	    [this, massiveWrite = std::move(massiveWrite)]() {
-		    WriteRegisterMassivelyImpl(massiveWrite);
-	    });
+	std::uninitialized_copy(std::begin(registerWrites), std::end(registerWrites), reinterpret_cast<RegisterWrite*>(payload + metadataSize));
+	m_commandRing.EndWrite();
 }
 
 void CGSHandler::WriteRegisterImpl(uint8 nRegister, uint64 nData)
@@ -617,17 +715,18 @@ void CGSHandler::ReadImageDataImpl(void* ptr, uint32 size)
 	((this)->*(m_transferReadHandlers[bltBuf.nSrcPsm]))(ptr, size);
 }
 
-void CGSHandler::WriteRegisterMassivelyImpl(const MASSIVEWRITE_INFO& massiveWrite)
+void CGSHandler::WriteRegisterMassivelyImpl(const RegisterWrite* writes, uint32 writeCount, const CGsPacketMetadata* metadata)
 {
 #ifdef DEBUGGER_INCLUDED
 	if(m_frameDump)
 	{
-		m_frameDump->AddRegisterPacket(massiveWrite.writes.data(), massiveWrite.writes.size(), &massiveWrite.metadata);
+		m_frameDump->AddRegisterPacket(writes, writeCount, metadata);
 	}
 #endif
 
-	for(const auto& write : massiveWrite.writes)
+	for(uint32 i = 0; i < writeCount; i++)
 	{
+		const auto& write = writes[i];
 		WriteRegisterImpl(write.first, write.second);
 	}
 
@@ -638,6 +737,8 @@ void CGSHandler::WriteRegisterMassivelyImpl(const MASSIVEWRITE_INFO& massiveWrit
 void CGSHandler::BeginTransfer()
 {
 	uint32 trxDir = m_nReg[GS_REG_TRXDIR] & 0x03;
+	m_trxCtx.dirtyPageStart = RAMSIZE / CGsPixelFormats::PAGESIZE;
+	m_trxCtx.dirtyPageEnd = 0;
 	if(trxDir == 0 || trxDir == 1)
 	{
 		//"Host to Local" or "Local to Host"
@@ -709,6 +810,90 @@ bool CGSHandler::TransferWriteHandlerInvalid(const void* pData, uint32 nLength)
 	return false;
 }
 
+void CGSHandler::SetTransferPageDirty(uint32 address)
+{
+	uint32 page = address / CGsPixelFormats::PAGESIZE;
+	m_trxCtx.dirtyPageStart = std::min(m_trxCtx.dirtyPageStart, page);
+	m_trxCtx.dirtyPageEnd = std::max(m_trxCtx.dirtyPageEnd, page + 1);
+}
+
+template <typename Storage>
+uint32 CGSHandler::GetTransferBlockAddress(uint32 bufPtr, uint32 bufWidth, uint32 nX, uint32 nY)
+{
+	//Same addressing as CPixelIndexor, for the pixel at the start of a block
+	uint32 pageNum = (nX / Storage::PAGEWIDTH) + (nY / Storage::PAGEHEIGHT) * (bufWidth * 64) / Storage::PAGEWIDTH;
+	uint32 blockNum = Storage::m_nBlockSwizzleTable[(nY % Storage::PAGEHEIGHT) / Storage::BLOCKHEIGHT][(nX % Storage::PAGEWIDTH) / Storage::BLOCKWIDTH];
+	return (bufPtr + (pageNum * CGsPixelFormats::PAGESIZE) + (blockNum * CGsPixelFormats::BLOCKSIZE)) & (RAMSIZE - 1);
+}
+
+template <typename Storage, uint32 pixelBits, CGSHandler::TRANSFERBLOCKWRITER blockWriter, CGSHandler::TRANSFERWRITEHANDLER pixelWriter>
+bool CGSHandler::TransferWriteHandlerBlocks(const void* pData, uint32 nLength)
+{
+	auto trxPos = make_convertible<TRXPOS>(m_nReg[GS_REG_TRXPOS]);
+	auto trxReg = make_convertible<TRXREG>(m_nReg[GS_REG_TRXREG]);
+	auto trxBuf = make_convertible<BITBLTBUF>(m_nReg[GS_REG_BITBLTBUF]);
+
+	//Blocks can only be used if the transfer is aligned on them and doesn't wrap around
+	bool canWriteBlocks =
+	    (trxReg.nRRW != 0) &&
+	    ((trxReg.nRRW % Storage::BLOCKWIDTH) == 0) &&
+	    ((trxPos.nDSAX % Storage::BLOCKWIDTH) == 0) &&
+	    ((trxPos.nDSAY % Storage::BLOCKHEIGHT) == 0) &&
+	    ((trxPos.nDSAX + trxReg.nRRW) <= 2048) &&
+	    ((trxPos.nDSAY + trxReg.nRRH) <= 2048);
+	if(!canWriteBlocks)
+	{
+		return ((this)->*(pixelWriter))(pData, nLength);
+	}
+
+	bool dirty = false;
+	uint32 dstPtr = trxBuf.GetDstPtr();
+	uint32 rowSize = (trxReg.nRRW * pixelBits) / 8;
+	uint32 blockRowSize = rowSize * Storage::BLOCKHEIGHT;
+
+	auto pSrc = reinterpret_cast<const uint8*>(pData);
+
+	while(nLength != 0)
+	{
+		if((m_trxCtx.nRRX == 0) && ((m_trxCtx.nRRY % Storage::BLOCKHEIGHT) == 0))
+		{
+			while((nLength >= blockRowSize) && ((m_trxCtx.nRRY + Storage::BLOCKHEIGHT) <= trxReg.nRRH))
+			{
+				uint32 nY = trxPos.nDSAY + m_trxCtx.nRRY;
+				for(uint32 blockX = 0; blockX < trxReg.nRRW; blockX += Storage::BLOCKWIDTH)
+				{
+					uint32 nX = trxPos.nDSAX + blockX;
+					uint32 blockAddress = GetTransferBlockAddress<Storage>(dstPtr, trxBuf.nDstWidth, nX, nY);
+
+					if(blockWriter(m_pRAM + blockAddress, pSrc + ((blockX * pixelBits) / 8), rowSize))
+					{
+						SetTransferPageDirty(blockAddress);
+						dirty = true;
+					}
+				}
+
+				pSrc += blockRowSize;
+				nLength -= blockRowSize;
+				m_trxCtx.nRRY += Storage::BLOCKHEIGHT;
+			}
+
+			if(nLength == 0) break;
+		}
+
+		//Not enough data left for a whole row of blocks, write pixels up to the next one
+		uint32 nextBlockRowY = ((m_trxCtx.nRRY / Storage::BLOCKHEIGHT) + 1) * Storage::BLOCKHEIGHT;
+		uint32 pixelCount = ((nextBlockRowY - m_trxCtx.nRRY) * trxReg.nRRW) - m_trxCtx.nRRX;
+		uint32 pixelLength = std::min((pixelCount * pixelBits) / 8, nLength);
+
+		dirty |= ((this)->*(pixelWriter))(pSrc, pixelLength);
+
+		pSrc += pixelLength;
+		nLength -= pixelLength;
+	}
+
+	return dirty;
+}
+
 template <typename Storage>
 bool CGSHandler::TransferWriteHandlerGeneric(const void* pData, uint32 nLength)
 {
@@ -733,6 +918,7 @@ bool CGSHandler::TransferWriteHandlerGeneric(const void* pData, uint32 nLength)
 		if((*pPixel) != pSrc[i])
 		{
 			(*pPixel) = pSrc[i];
+			SetTransferPageDirty(static_cast<uint32>(reinterpret_cast<uint8*>(pPixel) - m_pRAM));
 			nDirty = true;
 		}
 
@@ -766,6 +952,7 @@ bool CGSHandler::TransferWriteHandlerPSMCT24(const void* pData, uint32 nLength)
 		uint32 nSrcPixel = *reinterpret_cast<const uint32*>(&pSrc[i]) & 0x00FFFFFF;
 		(*pDstPixel) &= 0xFF000000;
 		(*pDstPixel) |= nSrcPixel;
+		SetTransferPageDirty(static_cast<uint32>(reinterpret_cast<uint8*>(pDstPixel) - m_pRAM));
 
 		m_trxCtx.nRRX++;
 		if(m_trxCtx.nRRX == trxReg.nRRW)
@@ -805,6 +992,7 @@ bool CGSHandler::TransferWriteHandlerPSMT4(const void* pData, uint32 nLength)
 			if(currentPixel != nPixel[j])
 			{
 				Indexor.SetPixel(nX, nY, nPixel[j]);
+				SetTransferPageDirty(Indexor.GetPixelColumnAddress(nX, nY));
 				dirty = true;
 			}
 
@@ -842,6 +1030,7 @@ bool CGSHandler::TransferWriteHandlerPSMT4H(const void* pData, uint32 nLength)
 		uint32* pDstPixel = Indexor.GetPixelAddress(nX, nY);
 		(*pDstPixel) &= ~nMask;
 		(*pDstPixel) |= (nSrcPixel << nShift);
+		SetTransferPageDirty(static_cast<uint32>(reinterpret_cast<uint8*>(pDstPixel) - m_pRAM));
 
 		m_trxCtx.nRRX++;
 		if(m_trxCtx.nRRX == trxReg.nRRW)
@@ -859,6 +1048,7 @@ bool CGSHandler::TransferWriteHandlerPSMT4H(const void* pData, uint32 nLength)
 		pDstPixel = Indexor.GetPixelAddress(nX, nY);
 		(*pDstPixel) &= ~nMask;
 		(*pDstPixel) |= (nSrcPixel << (nShift - 4));
+		SetTransferPageDirty(static_cast<uint32>(reinterpret_cast<uint8*>(pDstPixel) - m_pRAM));
 
 		m_trxCtx.nRRX++;
 		if(m_trxCtx.nRRX == trxReg.nRRW)
@@ -891,6 +1081,7 @@ bool CGSHandler::TransferWriteHandlerPSMT8H(const void* pData, uint32 nLength)
 		uint32* pDstPixel = Indexor.GetPixelAddress(nX, nY);
 		(*pDstPixel) &= ~0xFF000000;
 		(*pDstPixel) |= (nSrcPixel << 24);
+		SetTransferPageDirty(static_cast<uint32>(reinterpret_cast<uint8*>(pDstPixel) - m_pRAM));
 
 		m_trxCtx.nRRX++;
 		if(m_trxCtx.nRRX == trxReg.nRRW)
@@ -908,6 +1099,67 @@ void CGSHandler::TransferReadHandlerInvalid(void*, uint32)
 	assert(0);
 }
 
+template <typename Storage, uint32 pixelBits, CGSHandler::TRANSFERBLOCKREADER blockReader, CGSHandler::TRANSFERREADHANDLER pixelReader>
+void CGSHandler::TransferReadHandlerBlocks(void* buffer, uint32 length)
+{
+	auto trxPos = make_convertible<TRXPOS>(m_nReg[GS_REG_TRXPOS]);
+	auto trxReg = make_convertible<TRXREG>(m_nReg[GS_REG_TRXREG]);
+	auto trxBuf = make_convertible<BITBLTBUF>(m_nReg[GS_REG_BITBLTBUF]);
+
+	//Same constraints as TransferWriteHandlerBlocks
+	bool canReadBlocks =
+	    (trxReg.nRRW != 0) &&
+	    ((trxReg.nRRW % Storage::BLOCKWIDTH) == 0) &&
+	    ((trxPos.nSSAX % Storage::BLOCKWIDTH) == 0) &&
+	    ((trxPos.nSSAY % Storage::BLOCKHEIGHT) == 0) &&
+	    ((trxPos.nSSAX + trxReg.nRRW) <= 2048) &&
+	    ((trxPos.nSSAY + trxReg.nRRH) <= 2048);
+	if(!canReadBlocks)
+	{
+		((this)->*(pixelReader))(buffer, length);
+		return;
+	}
+
+	uint32 srcPtr = trxBuf.GetSrcPtr();
+	uint32 rowSize = (trxReg.nRRW * pixelBits) / 8;
+	uint32 blockRowSize = rowSize * Storage::BLOCKHEIGHT;
+
+	auto pDst = reinterpret_cast<uint8*>(buffer);
+
+	while(length != 0)
+	{
+		if((m_trxCtx.nRRX == 0) && ((m_trxCtx.nRRY % Storage::BLOCKHEIGHT) == 0))
+		{
+			while((length >= blockRowSize) && ((m_trxCtx.nRRY + Storage::BLOCKHEIGHT) <= trxReg.nRRH))
+			{
+				uint32 nY = trxPos.nSSAY + m_trxCtx.nRRY;
+				for(uint32 blockX = 0; blockX < trxReg.nRRW; blockX += Storage::BLOCKWIDTH)
+				{
+					uint32 nX = trxPos.nSSAX + blockX;
+					uint32 blockAddress = GetTransferBlockAddress<Storage>(srcPtr, trxBuf.nSrcWidth, nX, nY);
+					blockReader(pDst + ((blockX * pixelBits) / 8), m_pRAM + blockAddress, rowSize);
+				}
+
+				pDst += blockRowSize;
+				length -= blockRowSize;
+				m_trxCtx.nRRY += Storage::BLOCKHEIGHT;
+			}
+
+			if(length == 0) break;
+		}
+
+		//Not enough room left for a whole row of blocks, read pixels up to the next one
+		uint32 nextBlockRowY = ((m_trxCtx.nRRY / Storage::BLOCKHEIGHT) + 1) * Storage::BLOCKHEIGHT;
+		uint32 pixelCount = ((nextBlockRowY - m_trxCtx.nRRY) * trxReg.nRRW) - m_trxCtx.nRRX;
+		uint32 pixelLength = std::min((pixelCount * pixelBits) / 8, length);
+
+		((this)->*(pixelReader))(pDst, pixelLength);
+
+		pDst += pixelLength;
+		length -= pixelLength;
+	}
+}
+
 template <typename Storage>
 void CGSHandler::TransferReadHandlerGeneric(void* buffer, uint32 length)
 {
@@ -934,6 +1186,384 @@ void CGSHandler::TransferReadHandlerGeneric(void* buffer, uint32 length)
 	}
 }
 
+template <typename Storage>
+void CGSHandler::TransferReadHandlerPSMCT24(void* buffer, uint32 length)
+{
+	auto trxPos = make_convertible<TRXPOS>(m_nReg[GS_REG_TRXPOS]);
+	auto trxReg = make_convertible<TRXREG>(m_nReg[GS_REG_TRXREG]);
+	auto trxBuf = make_convertible<BITBLTBUF>(m_nReg[GS_REG_BITBLTBUF]);
+
+	CGsPixelFormats::CPixelIndexor<Storage> indexor(m_pRAM, trxBuf.GetSrcPtr(), trxBuf.nSrcWidth);
+
+	auto pDst = reinterpret_cast<uint8*>(buffer);
+
+	for(uint32 i = 0; i < length; i += 3)
+	{
+		uint32 x = (m_trxCtx.nRRX + trxPos.nSSAX) % 2048;
+		uint32 y = (m_trxCtx.nRRY + trxPos.nSSAY) % 2048;
+
+		//Buffer might end in the middle of a pixel
+		uint32 pixel = indexor.GetPixel(x, y);
+		for(uint32 j = 0; (j < 3) && ((i + j) < length); j++)
+		{
+			pDst[i + j] = static_cast<uint8>(pixel >> (j * 8));
+		}
+
+		m_trxCtx.nRRX++;
+		if(m_trxCtx.nRRX == trxReg.nRRW)
+		{
+			m_trxCtx.nRRX = 0;
+			m_trxCtx.nRRY++;
+		}
+	}
+}
+
+void CGSHandler::TransferReadHandlerPSMT4(void* buffer, uint32 length)
+{
+	auto trxPos = make_convertible<TRXPOS>(m_nReg[GS_REG_TRXPOS]);
+	auto trxReg = make_convertible<TRXREG>(m_nReg[GS_REG_TRXREG]);
+	auto trxBuf = make_convertible<BITBLTBUF>(m_nReg[GS_REG_BITBLTBUF]);
+
+	CGsPixelFormats::CPixelIndexorPSMT4 indexor(m_pRAM, trxBuf.GetSrcPtr(), trxBuf.nSrcWidth);
+
+	auto pDst = reinterpret_cast<uint8*>(buffer);
+
+	for(uint32 i = 0; i < length; i++)
+	{
+		uint8 pixels = 0;
+		for(uint32 j = 0; j < 2; j++)
+		{
+			uint32 x = (m_trxCtx.nRRX + trxPos.nSSAX) % 2048;
+			uint32 y = (m_trxCtx.nRRY + trxPos.nSSAY) % 2048;
+
+			pixels |= indexor.GetPixel(x, y) << (j * 4);
+
+			m_trxCtx.nRRX++;
+			if(m_trxCtx.nRRX == trxReg.nRRW)
+			{
+				m_trxCtx.nRRX = 0;
+				m_trxCtx.nRRY++;
+			}
+		}
+		pDst[i] = pixels;
+	}
+}
+
+void CGSHandler::TransferReadHandlerPSMT8H(void* buffer, uint32 length)
+{
+	auto trxPos = make_convertible<TRXPOS>(m_nReg[GS_REG_TRXPOS]);
+	auto trxReg = make_convertible<TRXREG>(m_nReg[GS_REG_TRXREG]);
+	auto trxBuf = make_convertible<BITBLTBUF>(m_nReg[GS_REG_BITBLTBUF]);
+
+	CGsPixelFormats::CPixelIndexorPSMCT32 indexor(m_pRAM, trxBuf.GetSrcPtr(), trxBuf.nSrcWidth);
+
+	auto pDst = reinterpret_cast<uint8*>(buffer);
+
+	for(uint32 i = 0; i < length; i++)
+	{
+		uint32 x = (m_trxCtx.nRRX + trxPos.nSSAX) % 2048;
+		uint32 y = (m_trxCtx.nRRY + trxPos.nSSAY) % 2048;
+
+		pDst[i] = static_cast<uint8>(indexor.GetPixel(x, y) >> 24);
+
+		m_trxCtx.nRRX++;
+		if(m_trxCtx.nRRX == trxReg.nRRW)
+		{
+			m_trxCtx.nRRX = 0;
+			m_trxCtx.nRRY++;
+		}
+	}
+}
+
+template <uint32 nShift>
+void CGSHandler::TransferReadHandlerPSMT4H(void* buffer, uint32 length)
+{
+	auto trxPos = make_convertible<TRXPOS>(m_nReg[GS_REG_TRXPOS]);
+	auto trxReg = make_convertible<TRXREG>(m_nReg[GS_REG_TRXREG]);
+	auto trxBuf = make_convertible<BITBLTBUF>(m_nReg[GS_REG_BITBLTBUF]);
+
+	CGsPixelFormats::CPixelIndexorPSMCT32 indexor(m_pRAM, trxBuf.GetSrcPtr(), trxBuf.nSrcWidth);
+
+	auto pDst = reinterpret_cast<uint8*>(buffer);
+
+	for(uint32 i = 0; i < length; i++)
+	{
+		uint8 pixels = 0;
+		for(uint32 j = 0; j < 2; j++)
+		{
+			uint32 x = (m_trxCtx.nRRX + trxPos.nSSAX) % 2048;
+			uint32 y = (m_trxCtx.nRRY + trxPos.nSSAY) % 2048;
+
+			pixels |= ((indexor.GetPixel(x, y) >> nShift) & 0x0F) << (j * 4);
+
+			m_trxCtx.nRRX++;
+			if(m_trxCtx.nRRX == trxReg.nRRW)
+			{
+				m_trxCtx.nRRX = 0;
+				m_trxCtx.nRRY++;
+			}
+		}
+		pDst[i] = pixels;
+	}
+}
+
+bool CGSHandler::GetTransferPixelFormat(uint32 psm, TRANSFERPIXELFORMAT& format)
+{
+	switch(psm)
+	{
+	case PSMCT32:
+		format = {PSMCT32, 0, 0xFFFFFFFF};
+		break;
+	case PSMCT24:
+		format = {PSMCT32, 0, 0x00FFFFFF};
+		break;
+	case PSMZ32:
+		format = {PSMZ32, 0, 0xFFFFFFFF};
+		break;
+	case PSMZ24:
+		format = {PSMZ32, 0, 0x00FFFFFF};
+		break;
+	case PSMCT16:
+	case PSMZ16:
+		format = {PSMCT16, 0, 0xFFFF};
+		break;
+	case PSMCT16S:
+	case PSMZ16S:
+		format = {PSMCT16S, 0, 0xFFFF};
+		break;
+	case PSMT8:
+		format = {PSMT8, 0, 0xFF};
+		break;
+	case PSMT4:
+		format = {PSMT4, 0, 0x0F};
+		break;
+	case PSMT8H:
+		format = {PSMCT32, 24, 0xFF};
+		break;
+	case PSMT4HL:
+		format = {PSMCT32, 24, 0x0F};
+		break;
+	case PSMT4HH:
+		format = {PSMCT32, 28, 0x0F};
+		break;
+	default:
+		return false;
+	}
+	return true;
+}
+
+void CGSHandler::TransferLocalToLocal()
+{
+	typedef CGsPixelFormats::STORAGEPSMCT32 StoragePSMCT32;
+	typedef CGsPixelFormats::STORAGEPSMZ32 StoragePSMZ32;
+	typedef CGsPixelFormats::STORAGEPSMCT16 StoragePSMCT16;
+	typedef CGsPixelFormats::STORAGEPSMCT16S StoragePSMCT16S;
+	typedef CGsPixelFormats::STORAGEPSMT8 StoragePSMT8;
+	typedef CGsPixelFormats::STORAGEPSMT4 StoragePSMT4;
+
+	auto bltBuf = make_convertible<BITBLTBUF>(m_nReg[GS_REG_BITBLTBUF]);
+
+	TRANSFERPIXELFORMAT srcFormat = {};
+	TRANSFERPIXELFORMAT dstFormat = {};
+	if(!GetTransferPixelFormat(bltBuf.nSrcPsm, srcFormat) || !GetTransferPixelFormat(bltBuf.nDstPsm, dstFormat))
+	{
+		CLog::GetInstance().Warn(LOG_NAME, "Unsupported local to local transfer between formats %d and %d.\r\n",
+		                         bltBuf.nSrcPsm, bltBuf.nDstPsm);
+		return;
+	}
+
+	//Pixels stored the same way on both sides can be copied a block at a time
+	bool sameLayout =
+	    (srcFormat.storagePsm == dstFormat.storagePsm) &&
+	    (srcFormat.shift == dstFormat.shift) &&
+	    (srcFormat.mask == dstFormat.mask);
+	if(sameLayout)
+	{
+		bool copied = false;
+		uint32 blockMask = dstFormat.mask << dstFormat.shift;
+		switch(dstFormat.storagePsm)
+		{
+		case PSMCT32:
+			copied = TransferLocalToLocalBlocks<StoragePSMCT32>(blockMask);
+			break;
+		case PSMZ32:
+			copied = TransferLocalToLocalBlocks<StoragePSMZ32>(blockMask);
+			break;
+		case PSMCT16:
+			copied = TransferLocalToLocalBlocks<StoragePSMCT16>(~0U);
+			break;
+		case PSMCT16S:
+			copied = TransferLocalToLocalBlocks<StoragePSMCT16S>(~0U);
+			break;
+		case PSMT8:
+			copied = TransferLocalToLocalBlocks<StoragePSMT8>(~0U);
+			break;
+		case PSMT4:
+			copied = TransferLocalToLocalBlocks<StoragePSMT4>(~0U);
+			break;
+		}
+		if(copied) return;
+	}
+
+	switch(srcFormat.storagePsm)
+	{
+	case PSMCT32:
+		TransferLocalToLocalFrom<StoragePSMCT32>(srcFormat, dstFormat);
+		break;
+	case PSMZ32:
+		TransferLocalToLocalFrom<StoragePSMZ32>(srcFormat, dstFormat);
+		break;
+	case PSMCT16:
+		TransferLocalToLocalFrom<StoragePSMCT16>(srcFormat, dstFormat);
+		break;
+	case PSMCT16S:
+		TransferLocalToLocalFrom<StoragePSMCT16S>(srcFormat, dstFormat);
+		break;
+	case PSMT8:
+		TransferLocalToLocalFrom<StoragePSMT8>(srcFormat, dstFormat);
+		break;
+	case PSMT4:
+		TransferLocalToLocalFrom<StoragePSMT4>(srcFormat, dstFormat);
+		break;
+	}
+}
+
+template <typename Storage>
+bool CGSHandler::TransferLocalToLocalBlocks(uint32 blockMask)
+{
+	auto bltBuf = make_convertible<BITBLTBUF>(m_nReg[GS_REG_BITBLTBUF]);
+	auto trxPos = make_convertible<TRXPOS>(m_nReg[GS_REG_TRXPOS]);
+	auto trxReg = make_convertible<TRXREG>(m_nReg[GS_REG_TRXREG]);
+
+	bool canCopyBlocks =
+	    (trxReg.nRRW != 0) && (trxReg.nRRH != 0) &&
+	    ((trxReg.nRRW % Storage::BLOCKWIDTH) == 0) &&
+	    ((trxReg.nRRH % Storage::BLOCKHEIGHT) == 0) &&
+	    ((trxPos.nSSAX % Storage::BLOCKWIDTH) == 0) &&
+	    ((trxPos.nSSAY % Storage::BLOCKHEIGHT) == 0) &&
+	    ((trxPos.nDSAX % Storage::BLOCKWIDTH) == 0) &&
+	    ((trxPos.nDSAY % Storage::BLOCKHEIGHT) == 0) &&
+	    ((trxPos.nSSAX + trxReg.nRRW) <= 2048) &&
+	    ((trxPos.nSSAY + trxReg.nRRH) <= 2048) &&
+	    ((trxPos.nDSAX + trxReg.nRRW) <= 2048) &&
+	    ((trxPos.nDSAY + trxReg.nRRH) <= 2048);
+	if(!canCopyBlocks)
+	{
+		return false;
+	}
+
+	//Pixels past the end of a row of pages alias others from the same area, the last one written wins
+	uint32 dstRowWidth = ((bltBuf.nDstWidth * 64) / Storage::PAGEWIDTH) * Storage::PAGEWIDTH;
+	if((trxPos.nDSAX + trxReg.nRRW) > dstRowWidth)
+	{
+		return false;
+	}
+
+	//Copy order only matters if both areas overlap, let the pixel copy honor the direction in that case.
+	//Areas are bounded by the first and last pages they touch, they must not wrap around GS RAM either.
+	auto getAreaRange =
+	    [](uint32 bufPtr, uint32 bufWidth, uint32 nX, uint32 nY, uint32 width, uint32 height) {
+		    uint32 pagesPerRow = (bufWidth * 64) / Storage::PAGEWIDTH;
+		    uint32 firstPage = (nX / Storage::PAGEWIDTH) + (nY / Storage::PAGEHEIGHT) * pagesPerRow;
+		    uint32 lastPage = ((nX + width - 1) / Storage::PAGEWIDTH) + ((nY + height - 1) / Storage::PAGEHEIGHT) * pagesPerRow;
+		    return std::make_pair(bufPtr + (firstPage * CGsPixelFormats::PAGESIZE), bufPtr + ((lastPage + 1) * CGsPixelFormats::PAGESIZE));
+	    };
+	auto srcRange = getAreaRange(bltBuf.GetSrcPtr(), bltBuf.nSrcWidth, trxPos.nSSAX, trxPos.nSSAY, trxReg.nRRW, trxReg.nRRH);
+	auto dstRange = getAreaRange(bltBuf.GetDstPtr(), bltBuf.nDstWidth, trxPos.nDSAX, trxPos.nDSAY, trxReg.nRRW, trxReg.nRRH);
+	if((srcRange.second > RAMSIZE) || (dstRange.second > RAMSIZE))
+	{
+		return false;
+	}
+	if((srcRange.first < dstRange.second) && (dstRange.first < srcRange.second))
+	{
+		return false;
+	}
+
+	for(uint32 blockY = 0; blockY < trxReg.nRRH; blockY += Storage::BLOCKHEIGHT)
+	{
+		for(uint32 blockX = 0; blockX < trxReg.nRRW; blockX += Storage::BLOCKWIDTH)
+		{
+			uint32 srcAddress = GetTransferBlockAddress<Storage>(bltBuf.GetSrcPtr(), bltBuf.nSrcWidth, trxPos.nSSAX + blockX, trxPos.nSSAY + blockY);
+			uint32 dstAddress = GetTransferBlockAddress<Storage>(bltBuf.GetDstPtr(), bltBuf.nDstWidth, trxPos.nDSAX + blockX, trxPos.nDSAY + blockY);
+			bool changed = (blockMask == ~0U)
+			                   ? CGsBlockSwizzle::CopyBlock(m_pRAM + dstAddress, m_pRAM + srcAddress)
+			                   : CGsBlockSwizzle::CopyBlockMasked(m_pRAM + dstAddress, m_pRAM + srcAddress, blockMask);
+			if(changed)
+			{
+				SetTransferPageDirty(dstAddress);
+			}
+		}
+	}
+
+	return true;
+}
+
+template <typename SrcStorage>
+void CGSHandler::TransferLocalToLocalFrom(const TRANSFERPIXELFORMAT& srcFormat, const TRANSFERPIXELFORMAT& dstFormat)
+{
+	switch(dstFormat.storagePsm)
+	{
+	case PSMCT32:
+		TransferLocalToLocalPixels<SrcStorage, CGsPixelFormats::STORAGEPSMCT32>(srcFormat, dstFormat);
+		break;
+	case PSMZ32:
+		TransferLocalToLocalPixels<SrcStorage, CGsPixelFormats::STORAGEPSMZ32>(srcFormat, dstFormat);
+		break;
+	case PSMCT16:
+		TransferLocalToLocalPixels<SrcStorage, CGsPixelFormats::STORAGEPSMCT16>(srcFormat, dstFormat);
+		break;
+	case PSMCT16S:
+		TransferLocalToLocalPixels<SrcStorage, CGsPixelFormats::STORAGEPSMCT16S>(srcFormat, dstFormat);
+		break;
+	case PSMT8:
+		TransferLocalToLocalPixels<SrcStorage, CGsPixelFormats::STORAGEPSMT8>(srcFormat, dstFormat);
+		break;
+	case PSMT4:
+		TransferLocalToLocalPixels<SrcStorage, CGsPixelFormats::STORAGEPSMT4>(srcFormat, dstFormat);
+		break;
+	}
+}
+
+template <typename SrcStorage, typename DstStorage>
+void CGSHandler::TransferLocalToLocalPixels(const TRANSFERPIXELFORMAT& srcFormat, const TRANSFERPIXELFORMAT& dstFormat)
+{
+	auto bltBuf = make_convertible<BITBLTBUF>(m_nReg[GS_REG_BITBLTBUF]);
+	auto trxPos = make_convertible<TRXPOS>(m_nReg[GS_REG_TRXPOS]);
+	auto trxReg = make_convertible<TRXREG>(m_nReg[GS_REG_TRXREG]);
+
+	CGsPixelFormats::CPixelIndexor<SrcStorage> srcIndexor(m_pRAM, bltBuf.GetSrcPtr(), bltBuf.nSrcWidth);
+	CGsPixelFormats::CPixelIndexor<DstStorage> dstIndexor(m_pRAM, bltBuf.GetDstPtr(), bltBuf.nDstWidth);
+
+	//Pixel values are moved as is between formats, no color conversion takes place
+	uint32 dstMask = dstFormat.mask << dstFormat.shift;
+
+	//Direction matters when source and destination overlap
+	bool reverseX = (trxPos.nDIR & 2) != 0;
+	bool reverseY = (trxPos.nDIR & 1) != 0;
+
+	for(uint32 j = 0; j < trxReg.nRRH; j++)
+	{
+		uint32 offsetY = reverseY ? (trxReg.nRRH - j - 1) : j;
+		for(uint32 i = 0; i < trxReg.nRRW; i++)
+		{
+			uint32 offsetX = reverseX ? (trxReg.nRRW - i - 1) : i;
+			uint32 srcX = (trxPos.nSSAX + offsetX) % 2048;
+			uint32 srcY = (trxPos.nSSAY + offsetY) % 2048;
+			uint32 dstX = (trxPos.nDSAX + offsetX) % 2048;
+			uint32 dstY = (trxPos.nDSAY + offsetY) % 2048;
+
+			uint32 value = (static_cast<uint32>(srcIndexor.GetPixel(srcX, srcY)) >> srcFormat.shift) & srcFormat.mask;
+			uint32 dstPixel = dstIndexor.GetPixel(dstX, dstY);
+			uint32 newDstPixel = (dstPixel & ~dstMask) | ((value << dstFormat.shift) & dstMask);
+			if(newDstPixel != dstPixel)
+			{
+				dstIndexor.SetPixel(dstX, dstY, static_cast<typename DstStorage::Unit>(newDstPixel));
+				SetTransferPageDirty(dstIndexor.GetPixelColumnAddress(dstX, dstY));
+			}
+		}
+	}
+}
+
 void CGSHandler::SetCrt(bool nIsInterlaced, unsigned int nMode, bool nIsFrameMode)
 {
 	m_nCrtMode = nMode;
@@ -1727,13 +2357,63 @@ void CGSHandler::WriteToDelayedRegister(uint32 address, uint32 value, DELAYED_RE
 void CGSHandler::ThreadProc()
 {
 	while(!m_threadDone)
+	{
+		if(!ProcessPendingCommands())
+		{
+			m_commandRing.WaitForCommand();
+		}
+	}
+}
+
+//Executes the next mailbox call, or the commands that were written before any call we
+//could receive later was sent. Returns false if there was nothing to do.
+bool CGSHandler::ProcessPendingCommands()
+{
+	uint64 writePosition = m_commandRing.GetWritePosition();
+	if(m_pendingCallCount != 0)
 	{
 		m_mailBox.WaitForCall();
-		while(m_mailBox.IsPending())
+		m_pendingCallCount--;
+		m_mailBox.ReceiveCall();
+		return true;
+	}
+	return ExecuteCommands(writePosition);
+}
+
+bool CGSHandler::ExecuteCommands(uint64 endPosition)
+{
+	bool executed = false;
+	while(auto command = m_commandRing.BeginRead(endPosition))
+	{
+		auto payload = reinterpret_cast<const uint8*>(command + 1);
+		switch(command->type)
+		{
+		case GS_COMMAND_WRITEREGISTER:
+			WriteRegisterImpl(static_cast<uint8>(command->parameter), command->argument);
+			break;
+		case GS_COMMAND_FEEDIMAGEDATA:
+			FeedImageDataImpl(payload, static_cast<uint32>(command->argument));
+			break;
+		case GS_COMMAND_WRITEREGISTERMASSIVELY:
 		{
-			m_mailBox.ReceiveCall();
+#ifdef DEBUGGER_INCLUDED
+			auto metadata = reinterpret_cast<const CGsPacketMetadata*>(payload);
+			payload += (sizeof(CGsPacketMetadata) + 0xF) & ~0xF;
+#else
+			const CGsPacketMetadata* metadata = nullptr;
+#endif
+			auto writes = reinterpret_cast<const RegisterWrite*>(payload);
+			WriteRegisterMassivelyImpl(writes, static_cast<uint32>(command->argument), metadata);
 		}
+		break;
+		default:
+			assert(false);
+			break;
+		}
+		m_commandRing.EndRead();
+		executed = true;
 	}
+	return executed;
 }
 
 void CGSHandler::SendGSCall(const CMailBox::FunctionType& function, bool waitForCompletion, bool forceWaitForCompletion)
@@ -1743,12 +2423,27 @@ void CGSHandler::SendGSCall(const CMailBox::FunctionType& function, bool waitFor
 		waitForCompletion = false;
 	}
 	waitForCompletion |= forceWaitForCompletion;
-	m_mailBox.SendCall(function, waitForCompletion);
+	uint64 writePosition = m_commandRing.GetWritePosition();
+	m_pendingCallCount++;
+	m_commandRing.Notify();
+	m_mailBox.SendCall(
+	    [this, writePosition, function]() {
+		    ExecuteCommands(writePosition);
+		    function();
+	    },
+	    waitForCompletion);
 }
 
 void CGSHandler::SendGSCall(CMailBox::FunctionType&& function)
 {
-	m_mailBox.SendCall(std::move(function));
+	uint64 writePosition = m_commandRing.GetWritePosition();
+	m_pendingCallCount++;
+	m_commandRing.Notify();
+	m_mailBox.SendCall(
+	    [this, writePosition, function = std::move(function)]() {
+		    ExecuteCommands(writePosition);
+		    function();
+	    });
 }
 
 void CGSHandler::ProcessSingleFrame()
@@ -1756,10 +2451,9 @@ void CGSHandler::ProcessSingleFrame()
 	assert(!m_gsThreaded);
 	while(!m_flipped)
 	{
-		m_mailBox.WaitForCall();
-		while(m_mailBox.IsPending() && !m_flipped)
+		if(!ProcessPendingCommands())
 		{
-			m_mailBox.ReceiveCall();
+			m_commandRing.WaitForCommand();
 		}
 	}
 	m_flipped = false;
@@ -11,6 +11,8 @@
 #include "Types.h"
 #include "Convertible.h"
 #include "../MailBox.h"
+#include "GsCommandRing.h"
+#include "GsTransferBufferPool.h"
 #include "../Integer64.h"
 #include "zip/ZipArchiveWriter.h"
 #include "zip/ZipArchiveReader.h"
@@ -18,9 +20,9 @@
 class CFrameDump;
 class CGsPacketMetadata;
 class CINTC;
-struct MASSIVEWRITE_INFO;
 
 #define PREF_CGSHANDLER_PRESENTATION_MODE "renderer.presentationmode"
+#define PREF_CGSHANDLER_TEXTURECACHE_SIZE "renderer.texturecachesize"
 
 enum GS_REGS
 {
@@ -119,6 +121,17 @@ public:
 		CSR_FIFO_FULL = 0x8000
 	};
 
+	struct TRANSFER_STATS
+	{
+		uint64 imageBytes = 0;
+		uint32 imagePackets = 0;
+		uint32 ringPackets = 0;
+		//Buffer allocations made for packets too large for the ring, and those saved by reusing pooled buffers.
+		//Such packets are still posted to the GS thread through SendGSCall, which allocates on its own.
+		uint32 allocations = 0;
+		uint32 allocationsSaved = 0;
+	};
+
 	struct PRESENTATION_PARAMS
 	{
 		uint32 windowWidth;
@@ -733,6 +746,8 @@ public:
 
 	void WriteRegister(uint8, uint64);
 	void FeedImageData(const void*, uint32);
+	uint8* BeginImageData(uint32);
+	void EndImageData();
 	void ReadImageData(void*, uint32);
 	void WriteRegisterMassively(RegisterWriteList, const CGsPacketMetadata*);
 
@@ -755,6 +770,7 @@ public:
 	void SetSMODE2(uint64);
 
 	int GetPendingTransferCount() const;
+	TRANSFER_STATS GetTransferStats() const;
 	void NotifyEvent(uint32);
 
 	unsigned int GetCrtWidth() const;
@@ -903,10 +919,23 @@ protected:
 		uint32 nRRX;
 		uint32 nRRY;
 		bool nDirty;
+		//GS RAM pages modified by the transfer (first and last, exclusive)
+		uint32 dirtyPageStart;
+		uint32 dirtyPageEnd;
 	};
 
 	typedef bool (CGSHandler::*TRANSFERWRITEHANDLER)(const void*, uint32);
+	typedef bool (*TRANSFERBLOCKWRITER)(uint8*, const uint8*, uint32);
 	typedef void (CGSHandler::*TRANSFERREADHANDLER)(void*, uint32);
+	typedef void (*TRANSFERBLOCKREADER)(uint8*, const uint8*, uint32);
+
+	//Where the bits of a pixel live in the storage unit of its format
+	struct TRANSFERPIXELFORMAT
+	{
+		uint32 storagePsm;
+		uint32 shift;
+		uint32 mask;
+	};
 
 	void LogWrite(uint8, uint64);
 	void LogPrivateWrite(uint32);
@@ -914,6 +943,8 @@ protected:
 	void WriteToDelayedRegister(uint32, uint32, DELAYED_REGISTER&);
 
 	void ThreadProc();
+	bool ProcessPendingCommands();
+	bool ExecuteCommands(uint64);
 	virtual void InitializeImpl() = 0;
 	virtual void ReleaseImpl() = 0;
 	void ResetBase();
@@ -924,14 +955,20 @@ protected:
 	virtual void WriteRegisterImpl(uint8, uint64);
 	void FeedImageDataImpl(const uint8*, uint32);
 	void ReadImageDataImpl(void*, uint32);
-	void WriteRegisterMassivelyImpl(const MASSIVEWRITE_INFO&);
+	void WriteRegisterMassivelyImpl(const RegisterWrite*, uint32, const CGsPacketMetadata*);
 
 	void BeginTransfer();
 
+	//Copies pixels between two areas of GS RAM. Backends that need GS RAM to be current can use this
+	//for local to local transfers, pages that were modified are recorded in the transfer context.
+	void TransferLocalToLocal();
+
 	TRANSFERWRITEHANDLER m_transferWriteHandlers[PSM_MAX];
 	TRANSFERREADHANDLER m_transferReadHandlers[PSM_MAX];
 
 	bool TransferWriteHandlerInvalid(const void*, uint32);
+	template <typename Storage, uint32, TRANSFERBLOCKWRITER, TRANSFERWRITEHANDLER>
+	bool TransferWriteHandlerBlocks(const void*, uint32);
 	template <typename Storage>
 	bool TransferWriteHandlerGeneric(const void*, uint32);
 	bool TransferWriteHandlerPSMT4(const void*, uint32);
@@ -939,10 +976,29 @@ protected:
 	bool TransferWriteHandlerPSMT8H(const void*, uint32);
 	template <uint32, uint32>
 	bool TransferWriteHandlerPSMT4H(const void*, uint32);
+	void SetTransferPageDirty(uint32);
+	template <typename Storage>
+	static uint32 GetTransferBlockAddress(uint32, uint32, uint32, uint32);
 
 	void TransferReadHandlerInvalid(void*, uint32);
+	template <typename Storage, uint32, TRANSFERBLOCKREADER, TRANSFERREADHANDLER>
+	void TransferReadHandlerBlocks(void*, uint32);
 	template <typename Storage>
 	void TransferReadHandlerGeneric(void*, uint32);
+	void TransferReadHandlerPSMT4(void*, uint32);
+	template <typename Storage>
+	void TransferReadHandlerPSMCT24(void*, uint32);
+	void TransferReadHandlerPSMT8H(void*, uint32);
+	template <uint32>
+	void TransferReadHandlerPSMT4H(void*, uint32);
+
+	static bool GetTransferPixelFormat(uint32, TRANSFERPIXELFORMAT&);
+	template <typename Storage>
+	bool TransferLocalToLocalBlocks(uint32);
+	template <typename SrcStorage>
+	void TransferLocalToLocalFrom(const TRANSFERPIXELFORMAT&, const TRANSFERPIXELFORMAT&);
+	template <typename SrcStorage, typename DstStorage>
+	void TransferLocalToLocalPixels(const TRANSFERPIXELFORMAT&, const TRANSFERPIXELFORMAT&);
 
 	void SyncCLUT(const TEX0&);
 	template <typename Indexor>
@@ -995,5 +1051,23 @@ protected:
 	bool m_flipped = false;
 
 private:
+	enum GS_COMMAND
+	{
+		GS_COMMAND_WRITEREGISTER = 1,
+		GS_COMMAND_FEEDIMAGEDATA,
+		GS_COMMAND_WRITEREGISTERMASSIVELY,
+	};
+
+	//Register writes and image data go through the command ring, the mailbox is only used for
+	//less frequent calls. Each call executes the commands that were written before it was sent.
+	CGsCommandRing m_commandRing;
 	CMailBox m_mailBox;
+	std::atomic<uint32> m_pendingCallCount;
+
+	//Image data too large for the command ring is carried in pooled buffers
+	CGsTransferBufferPool m_transferBufferPool;
+	CGsTransferBufferPool::BufferPtr m_pendingImageBuffer;
+	uint8* m_pendingImageData = nullptr;
+	uint32 m_pendingImageLength = 0;
+	TRANSFER_STATS m_transferStats;
 };
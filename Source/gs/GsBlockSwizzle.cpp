@@ -0,0 +1,489 @@
+#include <cstring>
+#include "GsBlockSwizzle.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define GS_BLOCKSWIZZLE_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define GS_BLOCKSWIZZLE_NEON
+#endif
+
+//Columns of PSMCT32 and PSMCT16 blocks interleave two rows of pixels, this is done with
+//unpack instructions. Blocks of other formats are swizzled through tables built from the
+//same tables used by CPixelIndexor.
+
+namespace
+{
+	//Byte offset of each pixel of a PSMT8 block
+	struct PSMT8BLOCKTABLE
+	{
+		typedef CGsPixelFormats::STORAGEPSMT8 Storage;
+
+		PSMT8BLOCKTABLE()
+		{
+			for(uint32 y = 0; y < Storage::BLOCKHEIGHT; y++)
+			{
+				for(uint32 x = 0; x < Storage::BLOCKWIDTH; x++)
+				{
+					uint32 columnNum = y / Storage::COLUMNHEIGHT;
+					uint32 workY = y % Storage::COLUMNHEIGHT;
+					uint32 table = ((workY & 0x02) >> 1) ^ (columnNum & 1);
+					uint32 byte = ((x & 0x08) >> 2) + ((workY & 0x02) >> 1);
+					offsets[y][x] = static_cast<uint8>((columnNum * CGsPixelFormats::COLUMNSIZE) + (Storage::m_nColumnWordTable[table][workY & 1][x & 7] * 4) + byte);
+				}
+			}
+		}
+
+		uint8 offsets[Storage::BLOCKHEIGHT][Storage::BLOCKWIDTH];
+	};
+
+	//Nibble index of each pixel of a PSMT4 block
+	struct PSMT4BLOCKTABLE
+	{
+		typedef CGsPixelFormats::STORAGEPSMT4 Storage;
+
+		PSMT4BLOCKTABLE()
+		{
+			for(uint32 y = 0; y < Storage::BLOCKHEIGHT; y++)
+			{
+				for(uint32 x = 0; x < Storage::BLOCKWIDTH; x++)
+				{
+					uint32 columnNum = y / Storage::COLUMNHEIGHT;
+					uint32 shiftAmount = (x & 0x18) + ((y & 0x02) << 1);
+					uint32 subTable = ((y & 0x02) >> 1) ^ (columnNum & 1);
+					uint32 wordOffset = (columnNum * CGsPixelFormats::COLUMNSIZE) + (Storage::m_nColumnWordTable[subTable][y & 1][x & 7] * 4);
+					nibbles[y][x] = static_cast<uint16>((wordOffset * 2) + (shiftAmount / 4));
+				}
+			}
+		}
+
+		uint16 nibbles[Storage::BLOCKHEIGHT][Storage::BLOCKWIDTH];
+	};
+}
+
+bool CGsBlockSwizzle::CommitBlock(uint8* dst, const void* block)
+{
+	if(!memcmp(dst, block, CGsPixelFormats::BLOCKSIZE))
+	{
+		return false;
+	}
+	memcpy(dst, block, CGsPixelFormats::BLOCKSIZE);
+	return true;
+}
+
+bool CGsBlockSwizzle::CommitBlockMasked(uint8* dst, uint32* block, uint32 mask)
+{
+	auto dstWords = reinterpret_cast<const uint32*>(dst);
+	for(uint32 i = 0; i < (CGsPixelFormats::BLOCKSIZE / 4); i++)
+	{
+		block[i] = (dstWords[i] & ~mask) | block[i];
+	}
+	return CommitBlock(dst, block);
+}
+
+bool CGsBlockSwizzle::CopyBlock(uint8* dst, const uint8* src)
+{
+	return CommitBlock(dst, src);
+}
+
+bool CGsBlockSwizzle::CopyBlockMasked(uint8* dst, const uint8* src, uint32 mask)
+{
+	alignas(16) uint32 block[CGsPixelFormats::BLOCKSIZE / 4];
+	memcpy(block, src, CGsPixelFormats::BLOCKSIZE);
+	for(uint32 i = 0; i < (CGsPixelFormats::BLOCKSIZE / 4); i++)
+	{
+		block[i] &= mask;
+	}
+	return CommitBlockMasked(dst, block, mask);
+}
+
+void CGsBlockSwizzle::SwizzlePSMCT32(uint32* dst, const uint8* src, uint32 pitch)
+{
+	//Each column holds two rows, pixels are interleaved in pairs
+	for(uint32 column = 0; column < 4; column++)
+	{
+		const uint8* row0 = src + ((column * 2) + 0) * pitch;
+		const uint8* row1 = src + ((column * 2) + 1) * pitch;
+		uint32* columnDst = dst + (column * 16);
+#if defined(GS_BLOCKSWIZZLE_SSE2)
+		__m128i row0a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + 0x00));
+		__m128i row0b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + 0x10));
+		__m128i row1a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + 0x00));
+		__m128i row1b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + 0x10));
+		_mm_store_si128(reinterpret_cast<__m128i*>(columnDst + 0x0), _mm_unpacklo_epi64(row0a, row1a));
+		_mm_store_si128(reinterpret_cast<__m128i*>(columnDst + 0x4), _mm_unpackhi_epi64(row0a, row1a));
+		_mm_store_si128(reinterpret_cast<__m128i*>(columnDst + 0x8), _mm_unpacklo_epi64(row0b, row1b));
+		_mm_store_si128(reinterpret_cast<__m128i*>(columnDst + 0xC), _mm_unpackhi_epi64(row0b, row1b));
+#elif defined(GS_BLOCKSWIZZLE_NEON)
+		uint64x2_t row0a = vreinterpretq_u64_u8(vld1q_u8(row0 + 0x00));
+		uint64x2_t row0b = vreinterpretq_u64_u8(vld1q_u8(row0 + 0x10));
+		uint64x2_t row1a = vreinterpretq_u64_u8(vld1q_u8(row1 + 0x00));
+		uint64x2_t row1b = vreinterpretq_u64_u8(vld1q_u8(row1 + 0x10));
+		vst1q_u32(columnDst + 0x0, vreinterpretq_u32_u64(vcombine_u64(vget_low_u64(row0a), vget_low_u64(row1a))));
+		vst1q_u32(columnDst + 0x4, vreinterpretq_u32_u64(vcombine_u64(vget_high_u64(row0a), vget_high_u64(row1a))));
+		vst1q_u32(columnDst + 0x8, vreinterpretq_u32_u64(vcombine_u64(vget_low_u64(row0b), vget_low_u64(row1b))));
+		vst1q_u32(columnDst + 0xC, vreinterpretq_u32_u64(vcombine_u64(vget_high_u64(row0b), vget_high_u64(row1b))));
+#else
+		for(uint32 x = 0; x < 8; x++)
+		{
+			memcpy(columnDst + CGsPixelFormats::STORAGEPSMCT32::m_nColumnSwizzleTable[0][x], row0 + (x * 4), 4);
+			memcpy(columnDst + CGsPixelFormats::STORAGEPSMCT32::m_nColumnSwizzleTable[1][x], row1 + (x * 4), 4);
+		}
+#endif
+	}
+}
+
+void CGsBlockSwizzle::UnswizzlePSMCT32(uint8* dst, const uint32* src, uint32 pitch)
+{
+	for(uint32 column = 0; column < 4; column++)
+	{
+		uint8* row0 = dst + ((column * 2) + 0) * pitch;
+		uint8* row1 = dst + ((column * 2) + 1) * pitch;
+		const uint32* columnSrc = src + (column * 16);
+#if defined(GS_BLOCKSWIZZLE_SSE2)
+		__m128i column0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(columnSrc + 0x0));
+		__m128i column1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(columnSrc + 0x4));
+		__m128i column2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(columnSrc + 0x8));
+		__m128i column3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(columnSrc + 0xC));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(row0 + 0x00), _mm_unpacklo_epi64(column0, column1));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(row1 + 0x00), _mm_unpackhi_epi64(column0, column1));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(row0 + 0x10), _mm_unpacklo_epi64(column2, column3));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(row1 + 0x10), _mm_unpackhi_epi64(column2, column3));
+#elif defined(GS_BLOCKSWIZZLE_NEON)
+		uint64x2_t column0 = vreinterpretq_u64_u32(vld1q_u32(columnSrc + 0x0));
+		uint64x2_t column1 = vreinterpretq_u64_u32(vld1q_u32(columnSrc + 0x4));
+		uint64x2_t column2 = vreinterpretq_u64_u32(vld1q_u32(columnSrc + 0x8));
+		uint64x2_t column3 = vreinterpretq_u64_u32(vld1q_u32(columnSrc + 0xC));
+		vst1q_u8(row0 + 0x00, vreinterpretq_u8_u64(vcombine_u64(vget_low_u64(column0), vget_low_u64(column1))));
+		vst1q_u8(row1 + 0x00, vreinterpretq_u8_u64(vcombine_u64(vget_high_u64(column0), vget_high_u64(column1))));
+		vst1q_u8(row0 + 0x10, vreinterpretq_u8_u64(vcombine_u64(vget_low_u64(column2), vget_low_u64(column3))));
+		vst1q_u8(row1 + 0x10, vreinterpretq_u8_u64(vcombine_u64(vget_high_u64(column2), vget_high_u64(column3))));
+#else
+		for(uint32 x = 0; x < 8; x++)
+		{
+			memcpy(row0 + (x * 4), columnSrc + CGsPixelFormats::STORAGEPSMCT32::m_nColumnSwizzleTable[0][x], 4);
+			memcpy(row1 + (x * 4), columnSrc + CGsPixelFormats::STORAGEPSMCT32::m_nColumnSwizzleTable[1][x], 4);
+		}
+#endif
+	}
+}
+
+template <>
+bool CGsBlockSwizzle::WriteBlock<CGsPixelFormats::STORAGEPSMCT32>(uint8* dst, const uint8* src, uint32 pitch)
+{
+	alignas(16) uint32 block[CGsPixelFormats::BLOCKSIZE / 4];
+	SwizzlePSMCT32(block, src, pitch);
+	return CommitBlock(dst, block);
+}
+
+template <>
+bool CGsBlockSwizzle::WriteBlock<CGsPixelFormats::STORAGEPSMCT16>(uint8* dst, const uint8* src, uint32 pitch)
+{
+	alignas(16) uint16 block[CGsPixelFormats::BLOCKSIZE / 2];
+	//Same as PSMCT32, except that pixels from both halves of a row are paired up first
+	for(uint32 column = 0; column < 4; column++)
+	{
+		const uint8* row0 = src + ((column * 2) + 0) * pitch;
+		const uint8* row1 = src + ((column * 2) + 1) * pitch;
+		uint16* columnDst = block + (column * 32);
+#if defined(GS_BLOCKSWIZZLE_SSE2)
+		__m128i row0a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + 0x00));
+		__m128i row0b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + 0x10));
+		__m128i row1a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + 0x00));
+		__m128i row1b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + 0x10));
+		__m128i pairs0a = _mm_unpacklo_epi16(row0a, row0b);
+		__m128i pairs0b = _mm_unpackhi_epi16(row0a, row0b);
+		__m128i pairs1a = _mm_unpacklo_epi16(row1a, row1b);
+		__m128i pairs1b = _mm_unpackhi_epi16(row1a, row1b);
+		_mm_store_si128(reinterpret_cast<__m128i*>(columnDst + 0x00), _mm_unpacklo_epi64(pairs0a, pairs1a));
+		_mm_store_si128(reinterpret_cast<__m128i*>(columnDst + 0x08), _mm_unpackhi_epi64(pairs0a, pairs1a));
+		_mm_store_si128(reinterpret_cast<__m128i*>(columnDst + 0x10), _mm_unpacklo_epi64(pairs0b, pairs1b));
+		_mm_store_si128(reinterpret_cast<__m128i*>(columnDst + 0x18), _mm_unpackhi_epi64(pairs0b, pairs1b));
+#elif defined(GS_BLOCKSWIZZLE_NEON)
+		uint16x8x2_t pairs0 = vzipq_u16(vld1q_u16(reinterpret_cast<const uint16*>(row0 + 0x00)), vld1q_u16(reinterpret_cast<const uint16*>(row0 + 0x10)));
+		uint16x8x2_t pairs1 = vzipq_u16(vld1q_u16(reinterpret_cast<const uint16*>(row1 + 0x00)), vld1q_u16(reinterpret_cast<const uint16*>(row1 + 0x10)));
+		uint64x2_t pairs0a = vreinterpretq_u64_u16(pairs0.val[0]);
+		uint64x2_t pairs0b = vreinterpretq_u64_u16(pairs0.val[1]);
+		uint64x2_t pairs1a = vreinterpretq_u64_u16(pairs1.val[0]);
+		uint64x2_t pairs1b = vreinterpretq_u64_u16(pairs1.val[1]);
+		vst1q_u16(columnDst + 0x00, vreinterpretq_u16_u64(vcombine_u64(vget_low_u64(pairs0a), vget_low_u64(pairs1a))));
+		vst1q_u16(columnDst + 0x08, vreinterpretq_u16_u64(vcombine_u64(vget_high_u64(pairs0a), vget_high_u64(pairs1a))));
+		vst1q_u16(columnDst + 0x10, vreinterpretq_u16_u64(vcombine_u64(vget_low_u64(pairs0b), vget_low_u64(pairs1b))));
+		vst1q_u16(columnDst + 0x18, vreinterpretq_u16_u64(vcombine_u64(vget_high_u64(pairs0b), vget_high_u64(pairs1b))));
+#else
+		for(uint32 x = 0; x < 16; x++)
+		{
+			memcpy(columnDst + CGsPixelFormats::STORAGEPSMCT16::m_nColumnSwizzleTable[0][x], row0 + (x * 2), 2);
+			memcpy(columnDst + CGsPixelFormats::STORAGEPSMCT16::m_nColumnSwizzleTable[1][x], row1 + (x * 2), 2);
+		}
+#endif
+	}
+	return CommitBlock(dst, block);
+}
+
+template <>
+bool CGsBlockSwizzle::WriteBlock<CGsPixelFormats::STORAGEPSMCT16S>(uint8* dst, const uint8* src, uint32 pitch)
+{
+	//PSMCT16S only differs from PSMCT16 in the way blocks are arranged in a page
+	return WriteBlock<CGsPixelFormats::STORAGEPSMCT16>(dst, src, pitch);
+}
+
+template <>
+bool CGsBlockSwizzle::WriteBlock<CGsPixelFormats::STORAGEPSMT8>(uint8* dst, const uint8* src, uint32 pitch)
+{
+	typedef CGsPixelFormats::STORAGEPSMT8 Storage;
+	static const PSMT8BLOCKTABLE blockTable;
+
+	alignas(16) uint8 block[CGsPixelFormats::BLOCKSIZE];
+	for(uint32 y = 0; y < Storage::BLOCKHEIGHT; y++)
+	{
+		const uint8* row = src + (y * pitch);
+		for(uint32 x = 0; x < Storage::BLOCKWIDTH; x++)
+		{
+			block[blockTable.offsets[y][x]] = row[x];
+		}
+	}
+	return CommitBlock(dst, block);
+}
+
+template <>
+bool CGsBlockSwizzle::WriteBlock<CGsPixelFormats::STORAGEPSMT4>(uint8* dst, const uint8* src, uint32 pitch)
+{
+	typedef CGsPixelFormats::STORAGEPSMT4 Storage;
+	static const PSMT4BLOCKTABLE blockTable;
+
+	//Every nibble of the block gets written
+	alignas(16) uint8 block[CGsPixelFormats::BLOCKSIZE] = {};
+	for(uint32 y = 0; y < Storage::BLOCKHEIGHT; y++)
+	{
+		const uint8* row = src + (y * pitch);
+		for(uint32 x = 0; x < Storage::BLOCKWIDTH; x++)
+		{
+			uint8 pixel = (row[x / 2] >> ((x & 1) * 4)) & 0x0F;
+			uint32 nibble = blockTable.nibbles[y][x];
+			block[nibble / 2] |= pixel << ((nibble & 1) * 4);
+		}
+	}
+	return CommitBlock(dst, block);
+}
+
+bool CGsBlockSwizzle::WriteBlockPSMCT24(uint8* dst, const uint8* src, uint32 pitch)
+{
+	typedef CGsPixelFormats::STORAGEPSMCT32 Storage;
+
+	uint32 pixels[Storage::BLOCKHEIGHT][Storage::BLOCKWIDTH];
+	for(uint32 y = 0; y < Storage::BLOCKHEIGHT; y++)
+	{
+		const uint8* row = src + (y * pitch);
+		for(uint32 x = 0; x < Storage::BLOCKWIDTH; x++)
+		{
+			const uint8* pixel = row + (x * 3);
+			pixels[y][x] = pixel[0] | (pixel[1] << 8) | (pixel[2] << 16);
+		}
+	}
+
+	alignas(16) uint32 block[CGsPixelFormats::BLOCKSIZE / 4];
+	SwizzlePSMCT32(block, reinterpret_cast<const uint8*>(pixels), sizeof(pixels[0]));
+	return CommitBlockMasked(dst, block, 0x00FFFFFF);
+}
+
+bool CGsBlockSwizzle::WriteBlockPSMT8H(uint8* dst, const uint8* src, uint32 pitch)
+{
+	typedef CGsPixelFormats::STORAGEPSMCT32 Storage;
+
+	uint32 pixels[Storage::BLOCKHEIGHT][Storage::BLOCKWIDTH];
+	for(uint32 y = 0; y < Storage::BLOCKHEIGHT; y++)
+	{
+		const uint8* row = src + (y * pitch);
+		for(uint32 x = 0; x < Storage::BLOCKWIDTH; x++)
+		{
+			pixels[y][x] = static_cast<uint32>(row[x]) << 24;
+		}
+	}
+
+	alignas(16) uint32 block[CGsPixelFormats::BLOCKSIZE / 4];
+	SwizzlePSMCT32(block, reinterpret_cast<const uint8*>(pixels), sizeof(pixels[0]));
+	return CommitBlockMasked(dst, block, 0xFF000000);
+}
+
+bool CGsBlockSwizzle::WriteBlockPSMT4H(uint8* dst, const uint8* src, uint32 pitch, uint32 shift, uint32 mask)
+{
+	typedef CGsPixelFormats::STORAGEPSMCT32 Storage;
+
+	uint32 pixels[Storage::BLOCKHEIGHT][Storage::BLOCKWIDTH];
+	for(uint32 y = 0; y < Storage::BLOCKHEIGHT; y++)
+	{
+		const uint8* row = src + (y * pitch);
+		for(uint32 x = 0; x < Storage::BLOCKWIDTH; x += 2)
+		{
+			uint8 srcPixels = row[x / 2];
+			pixels[y][x + 0] = static_cast<uint32>(srcPixels & 0x0F) << shift;
+			pixels[y][x + 1] = static_cast<uint32>(srcPixels & 0xF0) << (shift - 4);
+		}
+	}
+
+	alignas(16) uint32 block[CGsPixelFormats::BLOCKSIZE / 4];
+	SwizzlePSMCT32(block, reinterpret_cast<const uint8*>(pixels), sizeof(pixels[0]));
+	return CommitBlockMasked(dst, block, mask);
+}
+
+template <>
+void CGsBlockSwizzle::ReadBlock<CGsPixelFormats::STORAGEPSMCT32>(uint8* dst, const uint8* src, uint32 pitch)
+{
+	UnswizzlePSMCT32(dst, reinterpret_cast<const uint32*>(src), pitch);
+}
+
+template <>
+void CGsBlockSwizzle::ReadBlock<CGsPixelFormats::STORAGEPSMCT16>(uint8* dst, const uint8* src, uint32 pitch)
+{
+	//Undoes the pairing done by WriteBlock, pixels of both halves of a row are split apart
+	for(uint32 column = 0; column < 4; column++)
+	{
+		uint8* row0 = dst + ((column * 2) + 0) * pitch;
+		uint8* row1 = dst + ((column * 2) + 1) * pitch;
+		auto columnSrc = reinterpret_cast<const uint16*>(src) + (column * 32);
+#if defined(GS_BLOCKSWIZZLE_SSE2)
+		__m128i column0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(columnSrc + 0x00));
+		__m128i column1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(columnSrc + 0x08));
+		__m128i column2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(columnSrc + 0x10));
+		__m128i column3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(columnSrc + 0x18));
+		__m128i pairs0a = _mm_unpacklo_epi64(column0, column1);
+		__m128i pairs1a = _mm_unpackhi_epi64(column0, column1);
+		__m128i pairs0b = _mm_unpacklo_epi64(column2, column3);
+		__m128i pairs1b = _mm_unpackhi_epi64(column2, column3);
+		for(uint32 row = 0; row < 2; row++)
+		{
+			__m128i pairsA = row ? pairs1a : pairs0a;
+			__m128i pairsB = row ? pairs1b : pairs0b;
+			//Three rounds of unpacking separate even and odd pixels
+			__m128i work0 = _mm_unpacklo_epi16(pairsA, pairsB);
+			__m128i work1 = _mm_unpackhi_epi16(pairsA, pairsB);
+			__m128i work2 = _mm_unpacklo_epi16(work0, work1);
+			__m128i work3 = _mm_unpackhi_epi16(work0, work1);
+			uint8* rowDst = row ? row1 : row0;
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(rowDst + 0x00), _mm_unpacklo_epi16(work2, work3));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(rowDst + 0x10), _mm_unpackhi_epi16(work2, work3));
+		}
+#elif defined(GS_BLOCKSWIZZLE_NEON)
+		uint64x2_t column0 = vreinterpretq_u64_u16(vld1q_u16(columnSrc + 0x00));
+		uint64x2_t column1 = vreinterpretq_u64_u16(vld1q_u16(columnSrc + 0x08));
+		uint64x2_t column2 = vreinterpretq_u64_u16(vld1q_u16(columnSrc + 0x10));
+		uint64x2_t column3 = vreinterpretq_u64_u16(vld1q_u16(columnSrc + 0x18));
+		uint16x8_t pairs0a = vreinterpretq_u16_u64(vcombine_u64(vget_low_u64(column0), vget_low_u64(column1)));
+		uint16x8_t pairs1a = vreinterpretq_u16_u64(vcombine_u64(vget_high_u64(column0), vget_high_u64(column1)));
+		uint16x8_t pairs0b = vreinterpretq_u16_u64(vcombine_u64(vget_low_u64(column2), vget_low_u64(column3)));
+		uint16x8_t pairs1b = vreinterpretq_u16_u64(vcombine_u64(vget_high_u64(column2), vget_high_u64(column3)));
+		uint16x8x2_t pixels0 = vuzpq_u16(pairs0a, pairs0b);
+		uint16x8x2_t pixels1 = vuzpq_u16(pairs1a, pairs1b);
+		vst1q_u16(reinterpret_cast<uint16*>(row0 + 0x00), pixels0.val[0]);
+		vst1q_u16(reinterpret_cast<uint16*>(row0 + 0x10), pixels0.val[1]);
+		vst1q_u16(reinterpret_cast<uint16*>(row1 + 0x00), pixels1.val[0]);
+		vst1q_u16(reinterpret_cast<uint16*>(row1 + 0x10), pixels1.val[1]);
+#else
+		for(uint32 x = 0; x < 16; x++)
+		{
+			memcpy(row0 + (x * 2), columnSrc + CGsPixelFormats::STORAGEPSMCT16::m_nColumnSwizzleTable[0][x], 2);
+			memcpy(row1 + (x * 2), columnSrc + CGsPixelFormats::STORAGEPSMCT16::m_nColumnSwizzleTable[1][x], 2);
+		}
+#endif
+	}
+}
+
+template <>
+void CGsBlockSwizzle::ReadBlock<CGsPixelFormats::STORAGEPSMCT16S>(uint8* dst, const uint8* src, uint32 pitch)
+{
+	ReadBlock<CGsPixelFormats::STORAGEPSMCT16>(dst, src, pitch);
+}
+
+template <>
+void CGsBlockSwizzle::ReadBlock<CGsPixelFormats::STORAGEPSMT8>(uint8* dst, const uint8* src, uint32 pitch)
+{
+	typedef CGsPixelFormats::STORAGEPSMT8 Storage;
+	static const PSMT8BLOCKTABLE blockTable;
+
+	for(uint32 y = 0; y < Storage::BLOCKHEIGHT; y++)
+	{
+		uint8* row = dst + (y * pitch);
+		for(uint32 x = 0; x < Storage::BLOCKWIDTH; x++)
+		{
+			row[x] = src[blockTable.offsets[y][x]];
+		}
+	}
+}
+
+template <>
+void CGsBlockSwizzle::ReadBlock<CGsPixelFormats::STORAGEPSMT4>(uint8* dst, const uint8* src, uint32 pitch)
+{
+	typedef CGsPixelFormats::STORAGEPSMT4 Storage;
+	static const PSMT4BLOCKTABLE blockTable;
+
+	for(uint32 y = 0; y < Storage::BLOCKHEIGHT; y++)
+	{
+		uint8* row = dst + (y * pitch);
+		for(uint32 x = 0; x < Storage::BLOCKWIDTH; x += 2)
+		{
+			uint32 nibble0 = blockTable.nibbles[y][x + 0];
+			uint32 nibble1 = blockTable.nibbles[y][x + 1];
+			uint8 pixel0 = (src[nibble0 / 2] >> ((nibble0 & 1) * 4)) & 0x0F;
+			uint8 pixel1 = (src[nibble1 / 2] >> ((nibble1 & 1) * 4)) & 0x0F;
+			row[x / 2] = pixel0 | (pixel1 << 4);
+		}
+	}
+}
+
+void CGsBlockSwizzle::ReadBlockPSMCT24(uint8* dst, const uint8* src, uint32 pitch)
+{
+	typedef CGsPixelFormats::STORAGEPSMCT32 Storage;
+
+	uint32 pixels[Storage::BLOCKHEIGHT][Storage::BLOCKWIDTH];
+	UnswizzlePSMCT32(reinterpret_cast<uint8*>(pixels), reinterpret_cast<const uint32*>(src), sizeof(pixels[0]));
+
+	for(uint32 y = 0; y < Storage::BLOCKHEIGHT; y++)
+	{
+		uint8* row = dst + (y * pitch);
+		for(uint32 x = 0; x < Storage::BLOCKWIDTH; x++)
+		{
+			uint8* pixel = row + (x * 3);
+			pixel[0] = static_cast<uint8>(pixels[y][x] >> 0);
+			pixel[1] = static_cast<uint8>(pixels[y][x] >> 8);
+			pixel[2] = static_cast<uint8>(pixels[y][x] >> 16);
+		}
+	}
+}
+
+void CGsBlockSwizzle::ReadBlockPSMT8H(uint8* dst, const uint8* src, uint32 pitch)
+{
+	typedef CGsPixelFormats::STORAGEPSMCT32 Storage;
+
+	uint32 pixels[Storage::BLOCKHEIGHT][Storage::BLOCKWIDTH];
+	UnswizzlePSMCT32(reinterpret_cast<uint8*>(pixels), reinterpret_cast<const uint32*>(src), sizeof(pixels[0]));
+
+	for(uint32 y = 0; y < Storage::BLOCKHEIGHT; y++)
+	{
+		uint8* row = dst + (y * pitch);
+		for(uint32 x = 0; x < Storage::BLOCKWIDTH; x++)
+		{
+			row[x] = static_cast<uint8>(pixels[y][x] >> 24);
+		}
+	}
+}
+
+void CGsBlockSwizzle::ReadBlockPSMT4H(uint8* dst, const uint8* src, uint32 pitch, uint32 shift)
+{
+	typedef CGsPixelFormats::STORAGEPSMCT32 Storage;
+
+	uint32 pixels[Storage::BLOCKHEIGHT][Storage::BLOCKWIDTH];
+	UnswizzlePSMCT32(reinterpret_cast<uint8*>(pixels), reinterpret_cast<const uint32*>(src), sizeof(pixels[0]));
+
+	for(uint32 y = 0; y < Storage::BLOCKHEIGHT; y++)
+	{
+		uint8* row = dst + (y * pitch);
+		for(uint32 x = 0; x < Storage::BLOCKWIDTH; x += 2)
+		{
+			uint8 pixel0 = (pixels[y][x + 0] >> shift) & 0x0F;
+			uint8 pixel1 = (pixels[y][x + 1] >> shift) & 0x0F;
+			row[x / 2] = pixel0 | (pixel1 << 4);
+		}
+	}
+}
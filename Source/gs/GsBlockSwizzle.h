@@ -0,0 +1,70 @@
+#pragma once
+
+#include "Types.h"
+#include "GsPixelFormats.h"
+
+//Swizzles whole GS blocks out of linear image data, used by host to local transfers that are aligned
+//on blocks. Rows of source pixels are 'pitch' bytes apart. The block is only written to GS RAM if its
+//contents change, functions return false if GS RAM was left untouched.
+//Reading does the opposite for local to host transfers and copying moves whole blocks around
+//for local to local transfers between areas using the same storage.
+class CGsBlockSwizzle
+{
+public:
+	template <typename Storage>
+	static bool WriteBlock(uint8*, const uint8*, uint32);
+
+	static bool WriteBlockPSMCT24(uint8*, const uint8*, uint32);
+	static bool WriteBlockPSMT8H(uint8*, const uint8*, uint32);
+
+	template <uint32 nShift, uint32 nMask>
+	static bool WriteBlockPSMT4H(uint8* dst, const uint8* src, uint32 pitch)
+	{
+		return WriteBlockPSMT4H(dst, src, pitch, nShift, nMask);
+	}
+
+	template <typename Storage>
+	static void ReadBlock(uint8*, const uint8*, uint32);
+
+	static void ReadBlockPSMCT24(uint8*, const uint8*, uint32);
+	static void ReadBlockPSMT8H(uint8*, const uint8*, uint32);
+
+	template <uint32 nShift>
+	static void ReadBlockPSMT4H(uint8* dst, const uint8* src, uint32 pitch)
+	{
+		ReadBlockPSMT4H(dst, src, pitch, nShift);
+	}
+
+	static bool CopyBlock(uint8*, const uint8*);
+	static bool CopyBlockMasked(uint8*, const uint8*, uint32);
+
+private:
+	static bool WriteBlockPSMT4H(uint8*, const uint8*, uint32, uint32, uint32);
+	static void ReadBlockPSMT4H(uint8*, const uint8*, uint32, uint32);
+
+	static void SwizzlePSMCT32(uint32*, const uint8*, uint32);
+	static void UnswizzlePSMCT32(uint8*, const uint32*, uint32);
+	static bool CommitBlock(uint8*, const void*);
+	static bool CommitBlockMasked(uint8*, uint32*, uint32);
+};
+
+template <>
+bool CGsBlockSwizzle::WriteBlock<CGsPixelFormats::STORAGEPSMCT32>(uint8*, const uint8*, uint32);
+template <>
+bool CGsBlockSwizzle::WriteBlock<CGsPixelFormats::STORAGEPSMCT16>(uint8*, const uint8*, uint32);
+template <>
+bool CGsBlockSwizzle::WriteBlock<CGsPixelFormats::STORAGEPSMCT16S>(uint8*, const uint8*, uint32);
+template <>
+bool CGsBlockSwizzle::WriteBlock<CGsPixelFormats::STORAGEPSMT8>(uint8*, const uint8*, uint32);
+template <>
+bool CGsBlockSwizzle::WriteBlock<CGsPixelFormats::STORAGEPSMT4>(uint8*, const uint8*, uint32);
+template <>
+void CGsBlockSwizzle::ReadBlock<CGsPixelFormats::STORAGEPSMCT32>(uint8*, const uint8*, uint32);
+template <>
+void CGsBlockSwizzle::ReadBlock<CGsPixelFormats::STORAGEPSMCT16>(uint8*, const uint8*, uint32);
+template <>
+void CGsBlockSwizzle::ReadBlock<CGsPixelFormats::STORAGEPSMCT16S>(uint8*, const uint8*, uint32);
+template <>
+void CGsBlockSwizzle::ReadBlock<CGsPixelFormats::STORAGEPSMT8>(uint8*, const uint8*, uint32);
+template <>
+void CGsBlockSwizzle::ReadBlock<CGsPixelFormats::STORAGEPSMT4>(uint8*, const uint8*, uint32);
@@ -100,6 +100,20 @@ uint32 CGsCachedArea::GetSize() const
 	return GetPageCount() * CGsPixelFormats::PAGESIZE;
 }
 
+CGsCachedArea::MemoryPageRange CGsCachedArea::GetMemoryPageRange() const
+{
+	uint32 areaSize = GetSize();
+	if(areaSize == 0)
+	{
+		return MemoryPageRange(0, 0);
+	}
+
+	//Buffer pointer is not necessarily aligned on a page boundary
+	uint32 pageStart = m_bufPtr / CGsPixelFormats::PAGESIZE;
+	uint32 pageEnd = (m_bufPtr + areaSize + CGsPixelFormats::PAGESIZE - 1) / CGsPixelFormats::PAGESIZE;
+	return MemoryPageRange(pageStart, pageEnd);
+}
+
 void CGsCachedArea::Invalidate(uint32 memoryStart, uint32 memorySize)
 {
 	uint32 areaSize = GetSize();
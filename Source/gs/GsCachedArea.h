@@ -16,6 +16,9 @@ public:
 		uint32 height;
 	};
 
+	//First and last (exclusive) GS RAM pages
+	typedef std::pair<uint32, uint32> MemoryPageRange;
+
 	enum
 	{
 		MAX_DIRTYPAGES_SECTIONS = 8,
@@ -31,6 +34,7 @@ public:
 
 	uint32 GetPageCount() const;
 	uint32 GetSize() const;
+	MemoryPageRange GetMemoryPageRange() const;
 
 	void Invalidate(uint32, uint32);
 	bool IsPageDirty(uint32) const;
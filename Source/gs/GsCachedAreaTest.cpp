@@ -9,6 +9,7 @@ void CGsCachedAreaTest::Execute()
 	CheckDirtyRect();
 	CheckClearDirtyPages();
 	CheckInvalidate();
+	CheckMemoryPageRange();
 }
 
 void CGsCachedAreaTest::CheckEmptyArea()
@@ -154,3 +155,35 @@ void CGsCachedAreaTest::CheckInvalidate()
 		assert(dirtyRect.height == 2);
 	}
 }
+
+void CGsCachedAreaTest::CheckMemoryPageRange()
+{
+	//Empty area
+	{
+		CGsCachedArea area;
+		area.SetArea(CGSHandler::PSMCT32, 0x2000, 0, 0);
+
+		auto pageRange = area.GetMemoryPageRange();
+		assert(pageRange.first == pageRange.second);
+	}
+
+	//Page aligned area
+	{
+		CGsCachedArea area;
+		area.SetArea(CGSHandler::PSMCT32, CGsPixelFormats::PAGESIZE * 2, 512, 512);
+
+		auto pageRange = area.GetMemoryPageRange();
+		assert(pageRange.first == 2);
+		assert(pageRange.second == (2 + area.GetPageCount()));
+	}
+
+	//Area starting in the middle of a page
+	{
+		CGsCachedArea area;
+		area.SetArea(CGSHandler::PSMCT32, CGsPixelFormats::PAGESIZE + 0x100, 64, 32);
+
+		auto pageRange = area.GetMemoryPageRange();
+		assert(pageRange.first == 1);
+		assert(pageRange.second == 3);
+	}
+}
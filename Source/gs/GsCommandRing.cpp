@@ -0,0 +1,184 @@
+#include <algorithm>
+#include <cassert>
+#include <thread>
+#include "GsCommandRing.h"
+
+CGsCommandRing::CGsCommandRing(uint32 size)
+    : m_writePosition(0)
+    , m_producerSleeping(false)
+    , m_readPosition(0)
+    , m_consumerSleeping(false)
+    , m_notified(false)
+{
+	assert((size & (size - 1)) == 0);
+	assert(size >= (ALIGNMENT * 4));
+	m_buffer.resize(size);
+	m_sizeMask = size - 1;
+}
+
+uint32 CGsCommandRing::GetMaxPayloadSize() const
+{
+	//Keep commands small enough so that the producer doesn't have to wait for the ring to be empty
+	return static_cast<uint32>(m_buffer.size() / 4) - sizeof(COMMAND);
+}
+
+uint32 CGsCommandRing::GetCommandSize(uint32 payloadSize)
+{
+	return (sizeof(COMMAND) + payloadSize + (ALIGNMENT - 1)) & ~(ALIGNMENT - 1);
+}
+
+//Returns a pointer to where the payload needs to be written, the command
+//will be visible to the consumer once EndWrite is called
+uint8* CGsCommandRing::BeginWrite(uint16 type, uint16 parameter, uint64 argument, uint32 payloadSize)
+{
+	assert(type != COMMAND_TYPE_PADDING);
+	assert(payloadSize <= GetMaxPayloadSize());
+
+	uint32 bufferSize = static_cast<uint32>(m_buffer.size());
+	uint32 commandSize = GetCommandSize(payloadSize);
+	uint32 offset = static_cast<uint32>(m_pendingWritePosition & m_sizeMask);
+	uint32 contiguousSize = bufferSize - offset;
+	uint32 paddingSize = (contiguousSize < commandSize) ? contiguousSize : 0;
+	uint32 requiredSize = paddingSize + commandSize;
+
+	auto hasSpace =
+	    [&]() {
+		    uint64 usedSize = m_pendingWritePosition - m_readPosition.load();
+		    return (bufferSize - usedSize) >= requiredSize;
+	    };
+
+	if(!hasSpace())
+	{
+		bool spaceFound = false;
+		for(unsigned int i = 0; i < SPIN_COUNT; i++)
+		{
+			if(hasSpace())
+			{
+				spaceFound = true;
+				break;
+			}
+			if(i >= SPIN_YIELD_THRESHOLD)
+			{
+				std::this_thread::yield();
+			}
+		}
+		if(!spaceFound)
+		{
+			std::unique_lock<std::mutex> sleepLock(m_sleepMutex);
+			m_producerSleeping = true;
+			m_producerCondition.wait(sleepLock, hasSpace);
+			m_producerSleeping = false;
+		}
+	}
+
+	if(paddingSize != 0)
+	{
+		auto padding = reinterpret_cast<COMMAND*>(m_buffer.data() + offset);
+		padding->payloadSize = paddingSize - sizeof(COMMAND);
+		padding->type = COMMAND_TYPE_PADDING;
+		padding->parameter = 0;
+		padding->argument = 0;
+		m_pendingWritePosition += paddingSize;
+		offset = 0;
+	}
+
+	auto command = reinterpret_cast<COMMAND*>(m_buffer.data() + offset);
+	command->payloadSize = payloadSize;
+	command->type = type;
+	command->parameter = parameter;
+	command->argument = argument;
+	m_pendingWritePosition += commandSize;
+
+	return reinterpret_cast<uint8*>(command + 1);
+}
+
+void CGsCommandRing::EndWrite()
+{
+	m_writePosition = m_pendingWritePosition;
+	if(m_consumerSleeping)
+	{
+		std::lock_guard<std::mutex> sleepLock(m_sleepMutex);
+		m_consumerCondition.notify_one();
+	}
+}
+
+uint64 CGsCommandRing::GetWritePosition() const
+{
+	return m_writePosition;
+}
+
+//Returns the next command written before endPosition, or nullptr if there's none.
+//The command and its payload remain valid until EndRead is called.
+const CGsCommandRing::COMMAND* CGsCommandRing::BeginRead(uint64 endPosition)
+{
+	assert(m_currentCommandSize == 0);
+	endPosition = std::min<uint64>(endPosition, m_writePosition.load(std::memory_order_acquire));
+	while(1)
+	{
+		uint64 readPosition = m_readPosition.load(std::memory_order_relaxed);
+		if(readPosition >= endPosition)
+		{
+			return nullptr;
+		}
+		auto command = reinterpret_cast<const COMMAND*>(m_buffer.data() + (readPosition & m_sizeMask));
+		m_currentCommandSize = GetCommandSize(command->payloadSize);
+		if(command->type != COMMAND_TYPE_PADDING)
+		{
+			return command;
+		}
+		EndRead();
+	}
+}
+
+void CGsCommandRing::EndRead()
+{
+	assert(m_currentCommandSize != 0);
+	m_readPosition = m_readPosition.load(std::memory_order_relaxed) + m_currentCommandSize;
+	m_currentCommandSize = 0;
+	if(m_producerSleeping)
+	{
+		std::lock_guard<std::mutex> sleepLock(m_sleepMutex);
+		m_producerCondition.notify_one();
+	}
+}
+
+uint64 CGsCommandRing::GetReadPosition() const
+{
+	return m_readPosition;
+}
+
+bool CGsCommandRing::CanRead() const
+{
+	return m_readPosition != m_writePosition;
+}
+
+void CGsCommandRing::WaitForCommand()
+{
+	for(unsigned int i = 0; i < SPIN_COUNT; i++)
+	{
+		if(CanRead() || m_notified.exchange(false))
+		{
+			return;
+		}
+		if(i >= SPIN_YIELD_THRESHOLD)
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	std::unique_lock<std::mutex> sleepLock(m_sleepMutex);
+	m_consumerSleeping = true;
+	m_consumerCondition.wait(sleepLock, [this]() { return CanRead() || m_notified; });
+	m_consumerSleeping = false;
+	m_notified = false;
+}
+
+void CGsCommandRing::Notify()
+{
+	m_notified = true;
+	if(m_consumerSleeping)
+	{
+		std::lock_guard<std::mutex> sleepLock(m_sleepMutex);
+		m_consumerCondition.notify_one();
+	}
+}
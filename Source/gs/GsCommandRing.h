@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+#include "Types.h"
+
+//Single producer, single consumer ring of variable sized commands. Payloads are stored inline
+//and are read in place by the consumer, nothing is allocated once the ring is created.
+//Both sides spin for a little while before going to sleep when they need to wait, and
+//they only signal each other when the other side is actually sleeping.
+class CGsCommandRing
+{
+public:
+	struct COMMAND
+	{
+		uint32 payloadSize;
+		uint16 type;
+		uint16 parameter;
+		uint64 argument;
+	};
+	static_assert(sizeof(COMMAND) == 0x10, "Size of COMMAND struct must be 16 bytes.");
+
+	enum
+	{
+		DEFAULT_SIZE = 0x400000,
+		//Type reserved for the ring, used to skip the end of the buffer when wrapping around
+		COMMAND_TYPE_PADDING = 0,
+	};
+
+	CGsCommandRing(uint32 = DEFAULT_SIZE);
+	virtual ~CGsCommandRing() = default;
+
+	CGsCommandRing(const CGsCommandRing&) = delete;
+	CGsCommandRing& operator=(const CGsCommandRing&) = delete;
+
+	uint32 GetMaxPayloadSize() const;
+
+	//Producer side
+	uint8* BeginWrite(uint16, uint16, uint64, uint32);
+	void EndWrite();
+	uint64 GetWritePosition() const;
+
+	//Consumer side
+	const COMMAND* BeginRead(uint64);
+	void EndRead();
+	uint64 GetReadPosition() const;
+	void WaitForCommand();
+
+	//Wakes up the consumer even if nothing was written
+	void Notify();
+
+private:
+	enum
+	{
+		ALIGNMENT = 0x10,
+		SPIN_COUNT = 0x800,
+		SPIN_YIELD_THRESHOLD = 0x100,
+	};
+
+	static uint32 GetCommandSize(uint32);
+	bool CanRead() const;
+
+	std::vector<uint8> m_buffer;
+	uint32 m_sizeMask = 0;
+
+	//Written by the producer only
+	alignas(64) std::atomic<uint64> m_writePosition;
+	uint64 m_pendingWritePosition = 0;
+	std::atomic<bool> m_producerSleeping;
+
+	//Written by the consumer only
+	alignas(64) std::atomic<uint64> m_readPosition;
+	uint64 m_currentCommandSize = 0;
+	std::atomic<bool> m_consumerSleeping;
+
+	alignas(64) std::atomic<bool> m_notified;
+	std::mutex m_sleepMutex;
+	std::condition_variable m_producerCondition;
+	std::condition_variable m_consumerCondition;
+};
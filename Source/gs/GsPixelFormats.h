@@ -240,12 +240,9 @@ public:
 			m_nWidth = nWidth;
 			m_pMemory = pMemory;
 
-			//This might not be thread safe (?)
-			if(!m_pageOffsetsInitialized)
-			{
-				BuildPageOffsetTable();
-				m_pageOffsetsInitialized = true;
-			}
+			//GS threads of several virtual machines can get here at the same time
+			static const bool pageOffsetsInitialized = (BuildPageOffsetTable(), true);
+			(void)pageOffsetsInitialized;
 		}
 
 		typename Storage::Unit GetPixel(unsigned int nX, unsigned int nY)
@@ -258,6 +255,12 @@ public:
 			*GetPixelAddress(nX, nY) = nPixel;
 		}
 
+		//Address of the column holding the pixel, relative to the start of GS RAM
+		uint32 GetPixelColumnAddress(unsigned int nX, unsigned int nY)
+		{
+			return GetColumnAddress(nX, nY);
+		}
+
 		typename Storage::Unit* GetPixelAddress(unsigned int nX, unsigned int nY)
 		{
 			uint32 pageNum = (nX / Storage::PAGEWIDTH) + (nY / Storage::PAGEHEIGHT) * (m_nWidth * 64) / Storage::PAGEWIDTH;
@@ -317,7 +320,6 @@ public:
 		uint32 m_nPointer;
 		uint32 m_nWidth;
 		uint8* m_pMemory;
-		static bool m_pageOffsetsInitialized;
 		static uint32 m_pageOffsets[Storage::PAGEHEIGHT][Storage::PAGEWIDTH];
 	};
 
@@ -331,9 +333,6 @@ public:
 //////////////////////////////////////////////
 //Some storage methods templates specializations
 
-template <typename Storage>
-bool CGsPixelFormats::CPixelIndexor<Storage>::m_pageOffsetsInitialized = false;
-
 template <typename Storage>
 uint32 CGsPixelFormats::CPixelIndexor<Storage>::m_pageOffsets[Storage::PAGEHEIGHT][Storage::PAGEWIDTH];
 
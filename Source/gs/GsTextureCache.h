@@ -1,11 +1,20 @@
 #pragma once
 
-#include <list>
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <memory>
+#include <unordered_map>
+#include <vector>
 #include "GSHandler.h"
 #include "GsCachedArea.h"
+#include "GsPixelFormats.h"
 
 #define TEX0_CLUTINFO_MASK (~0xFFFFFFE000000000ULL)
 
+//Textures are indexed by their masked TEX0 value and by the GS RAM pages they cover, so
+//searches and invalidations only need to look at the textures they are concerned with.
+//Least recently used textures get recycled when the cache is full.
 template <typename TextureHandleType>
 class CGsTextureCache
 {
@@ -26,18 +35,61 @@ public:
 
 		//Platform specific
 		TextureHandleType m_textureHandle;
+
+	private:
+		friend class CGsTextureCache;
+
+		CTexture* m_lruPrev = nullptr;
+		CTexture* m_lruNext = nullptr;
+
+		//GS RAM pages this texture is registered in
+		uint32 m_pageStart = 0;
+		uint32 m_pageEnd = 0;
+
+		uint32 m_invalidationStamp = 0;
 	};
 
 	enum
 	{
-		MAX_TEXTURE_CACHE = 256,
+		DEFAULT_MAX_TEXTURE_CACHE = 256,
 	};
 
-	CGsTextureCache()
+	CGsTextureCache(unsigned int maxTextureCount = DEFAULT_MAX_TEXTURE_CACHE)
+	{
+		SetMaxTextureCount(maxTextureCount);
+	}
+
+	CGsTextureCache(const CGsTextureCache&) = delete;
+	CGsTextureCache& operator=(const CGsTextureCache&) = delete;
+
+	unsigned int GetMaxTextureCount() const
 	{
-		for(unsigned int i = 0; i < MAX_TEXTURE_CACHE; i++)
+		return static_cast<unsigned int>(m_textures.size());
+	}
+
+	//Changing the size of the cache releases all cached textures
+	void SetMaxTextureCount(unsigned int maxTextureCount)
+	{
+		assert(maxTextureCount != 0);
+		maxTextureCount = std::max<unsigned int>(maxTextureCount, 1);
+		if(maxTextureCount == m_textures.size()) return;
+
+		m_textureIndex.clear();
+		for(auto& pageTextures : m_pageTextures)
+		{
+			pageTextures.clear();
+		}
+		m_lruHead = nullptr;
+		m_lruTail = nullptr;
+		m_textures.clear();
+
+		m_textures.reserve(maxTextureCount);
+		m_textureIndex.reserve(maxTextureCount);
+		for(unsigned int i = 0; i < maxTextureCount; i++)
 		{
-			m_textureCache.push_back(std::make_shared<CTexture>());
+			auto texture = std::make_unique<CTexture>();
+			LruPushBack(texture.get());
+			m_textures.push_back(std::move(texture));
 		}
 	}
 
@@ -45,50 +97,193 @@ public:
 	{
 		uint64 maskedTex0 = static_cast<uint64>(tex0) & TEX0_CLUTINFO_MASK;
 
-		for(auto textureIterator(m_textureCache.begin());
-		    textureIterator != m_textureCache.end(); textureIterator++)
+		auto textureIterator = m_textureIndex.find(maskedTex0);
+		if(textureIterator == std::end(m_textureIndex))
 		{
-			auto texture = *textureIterator;
-			if(!texture->m_live) continue;
-			if(maskedTex0 != texture->m_tex0) continue;
-			m_textureCache.erase(textureIterator);
-			m_textureCache.push_front(texture);
-			return texture.get();
+			return nullptr;
 		}
 
-		return nullptr;
+		auto texture = textureIterator->second;
+		assert(texture->m_live);
+		LruRemove(texture);
+		LruPushFront(texture);
+		return texture;
 	}
 
 	void Insert(const CGSHandler::TEX0& tex0, TextureHandleType textureHandle)
 	{
-		auto texture = *m_textureCache.rbegin();
-		texture->Reset();
+		uint64 maskedTex0 = static_cast<uint64>(tex0) & TEX0_CLUTINFO_MASK;
+
+		//Make sure we never have two textures with the same key
+		{
+			auto textureIterator = m_textureIndex.find(maskedTex0);
+			if(textureIterator != std::end(m_textureIndex))
+			{
+				auto texture = textureIterator->second;
+				Release(texture);
+				LruRemove(texture);
+				LruPushBack(texture);
+			}
+		}
+
+		auto texture = m_lruTail;
+		Release(texture);
 
 		texture->m_cachedArea.SetArea(tex0.nPsm, tex0.GetBufPtr(), tex0.GetBufWidth(), tex0.GetHeight());
 
-		texture->m_tex0 = static_cast<uint64>(tex0) & TEX0_CLUTINFO_MASK;
+		texture->m_tex0 = maskedTex0;
 		texture->m_textureHandle = std::move(textureHandle);
 		texture->m_live = true;
 
-		m_textureCache.pop_back();
-		m_textureCache.push_front(texture);
+		Register(texture);
+
+		LruRemove(texture);
+		LruPushFront(texture);
 	}
 
 	void InvalidateRange(uint32 start, uint32 size)
 	{
-		std::for_each(std::begin(m_textureCache), std::end(m_textureCache),
-		              [start, size](TexturePtr& texture) { if(texture->m_live) { texture->m_cachedArea.Invalidate(start, size); } });
+		if(size == 0) return;
+
+		uint32 pageStart = start / CGsPixelFormats::PAGESIZE;
+		uint32 pageEnd = std::min<uint32>(((start + size - 1) / CGsPixelFormats::PAGESIZE) + 1, RAM_PAGE_COUNT);
+
+		//Textures spanning many pages must only be processed once
+		m_invalidationStamp++;
+		if(m_invalidationStamp == 0)
+		{
+			for(auto& texture : m_textures)
+			{
+				texture->m_invalidationStamp = 0;
+			}
+			m_invalidationStamp = 1;
+		}
+
+		for(uint32 page = pageStart; page < pageEnd; page++)
+		{
+			for(auto texture : m_pageTextures[page])
+			{
+				assert(texture->m_live);
+				if(texture->m_invalidationStamp == m_invalidationStamp) continue;
+				texture->m_invalidationStamp = m_invalidationStamp;
+				texture->m_cachedArea.Invalidate(start, size);
+			}
+		}
 	}
 
 	void Flush()
 	{
-		std::for_each(std::begin(m_textureCache), std::end(m_textureCache),
-		              [](TexturePtr& texture) { texture->Reset(); });
+		for(auto& texture : m_textures)
+		{
+			Release(texture.get());
+		}
+		assert(m_textureIndex.empty());
 	}
 
 private:
-	typedef std::shared_ptr<CTexture> TexturePtr;
-	typedef std::list<TexturePtr> TextureList;
+	typedef std::unique_ptr<CTexture> TexturePtr;
+	typedef std::vector<TexturePtr> TextureArray;
+	typedef std::unordered_map<uint64, CTexture*> TextureIndex;
+	typedef std::vector<CTexture*> PageTextureList;
+
+	enum
+	{
+		RAM_PAGE_COUNT = CGSHandler::RAMSIZE / CGsPixelFormats::PAGESIZE,
+	};
+
+	void Register(CTexture* texture)
+	{
+		assert(texture->m_live);
+		m_textureIndex[texture->m_tex0] = texture;
+
+		auto pageRange = texture->m_cachedArea.GetMemoryPageRange();
+		texture->m_pageStart = std::min<uint32>(pageRange.first, RAM_PAGE_COUNT);
+		texture->m_pageEnd = std::min<uint32>(pageRange.second, RAM_PAGE_COUNT);
+		for(uint32 page = texture->m_pageStart; page < texture->m_pageEnd; page++)
+		{
+			m_pageTextures[page].push_back(texture);
+		}
+	}
+
+	//Removes a texture from our indices and releases its resources
+	void Release(CTexture* texture)
+	{
+		if(texture->m_live)
+		{
+			m_textureIndex.erase(texture->m_tex0);
+			for(uint32 page = texture->m_pageStart; page < texture->m_pageEnd; page++)
+			{
+				auto& pageTextures = m_pageTextures[page];
+				auto textureIterator = std::find(std::begin(pageTextures), std::end(pageTextures), texture);
+				assert(textureIterator != std::end(pageTextures));
+				*textureIterator = pageTextures.back();
+				pageTextures.pop_back();
+			}
+			texture->m_pageStart = 0;
+			texture->m_pageEnd = 0;
+		}
+		texture->Reset();
+	}
+
+	void LruPushFront(CTexture* texture)
+	{
+		texture->m_lruPrev = nullptr;
+		texture->m_lruNext = m_lruHead;
+		if(m_lruHead)
+		{
+			m_lruHead->m_lruPrev = texture;
+		}
+		else
+		{
+			m_lruTail = texture;
+		}
+		m_lruHead = texture;
+	}
+
+	void LruPushBack(CTexture* texture)
+	{
+		texture->m_lruNext = nullptr;
+		texture->m_lruPrev = m_lruTail;
+		if(m_lruTail)
+		{
+			m_lruTail->m_lruNext = texture;
+		}
+		else
+		{
+			m_lruHead = texture;
+		}
+		m_lruTail = texture;
+	}
+
+	void LruRemove(CTexture* texture)
+	{
+		if(texture->m_lruPrev)
+		{
+			texture->m_lruPrev->m_lruNext = texture->m_lruNext;
+		}
+		else
+		{
+			m_lruHead = texture->m_lruNext;
+		}
+		if(texture->m_lruNext)
+		{
+			texture->m_lruNext->m_lruPrev = texture->m_lruPrev;
+		}
+		else
+		{
+			m_lruTail = texture->m_lruPrev;
+		}
+		texture->m_lruPrev = nullptr;
+		texture->m_lruNext = nullptr;
+	}
+
+	TextureArray m_textures;
+	TextureIndex m_textureIndex;
+	std::array<PageTextureList, RAM_PAGE_COUNT> m_pageTextures;
+
+	//Most recently used texture is at the head
+	CTexture* m_lruHead = nullptr;
+	CTexture* m_lruTail = nullptr;
 
-	TextureList m_textureCache;
+	uint32 m_invalidationStamp = 0;
 };
@@ -0,0 +1,173 @@
+#include <cassert>
+#include <new>
+#include "GsTransferBufferPool.h"
+
+CGsTransferBufferPool::BufferPtr::BufferPtr(BUFFER* buffer)
+    : m_buffer(buffer)
+{
+}
+
+CGsTransferBufferPool::BufferPtr::BufferPtr(const BufferPtr& src)
+    : m_buffer(src.m_buffer)
+{
+	if(m_buffer)
+	{
+		m_buffer->refCount.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+CGsTransferBufferPool::BufferPtr::BufferPtr(BufferPtr&& src) noexcept
+    : m_buffer(src.m_buffer)
+{
+	src.m_buffer = nullptr;
+}
+
+CGsTransferBufferPool::BufferPtr::~BufferPtr()
+{
+	Release();
+}
+
+CGsTransferBufferPool::BufferPtr& CGsTransferBufferPool::BufferPtr::operator=(const BufferPtr& src)
+{
+	if(src.m_buffer)
+	{
+		src.m_buffer->refCount.fetch_add(1, std::memory_order_relaxed);
+	}
+	Release();
+	m_buffer = src.m_buffer;
+	return *this;
+}
+
+CGsTransferBufferPool::BufferPtr& CGsTransferBufferPool::BufferPtr::operator=(BufferPtr&& src) noexcept
+{
+	if(this != &src)
+	{
+		Release();
+		m_buffer = src.m_buffer;
+		src.m_buffer = nullptr;
+	}
+	return *this;
+}
+
+uint8* CGsTransferBufferPool::BufferPtr::get() const
+{
+	return m_buffer ? reinterpret_cast<uint8*>(m_buffer) + DATA_OFFSET : nullptr;
+}
+
+CGsTransferBufferPool::BufferPtr::operator bool() const
+{
+	return m_buffer != nullptr;
+}
+
+void CGsTransferBufferPool::BufferPtr::Release()
+{
+	if(!m_buffer) return;
+	if(m_buffer->refCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+	{
+		ReleaseBuffer(m_buffer);
+	}
+	m_buffer = nullptr;
+}
+
+CGsTransferBufferPool::STATE::~STATE()
+{
+	for(auto& bucket : freeBuffers)
+	{
+		for(auto buffer : bucket)
+		{
+			FreeBuffer(buffer);
+		}
+	}
+}
+
+CGsTransferBufferPool::CGsTransferBufferPool()
+    : m_state(std::make_shared<STATE>())
+{
+}
+
+//Buckets hold buffers of increasing powers of two, larger requests are not pooled
+unsigned int CGsTransferBufferPool::GetBucketIndex(uint32 size)
+{
+	unsigned int bucketIndex = 0;
+	while((bucketIndex < BUCKET_COUNT) && (size > (1U << (bucketIndex + MIN_BUFFER_SIZE_LOG2))))
+	{
+		bucketIndex++;
+	}
+	return bucketIndex;
+}
+
+CGsTransferBufferPool::BUFFER* CGsTransferBufferPool::AllocateBuffer(unsigned int bucketIndex, uint32 size)
+{
+	void* memory = ::operator new(DATA_OFFSET + size);
+	auto buffer = new(memory) BUFFER();
+	buffer->bucketIndex = bucketIndex;
+	return buffer;
+}
+
+void CGsTransferBufferPool::FreeBuffer(BUFFER* buffer)
+{
+	buffer->~BUFFER();
+	::operator delete(buffer);
+}
+
+void CGsTransferBufferPool::ReleaseBuffer(BUFFER* buffer)
+{
+	auto state = std::move(buffer->state);
+	if(buffer->bucketIndex == BUCKET_COUNT)
+	{
+		FreeBuffer(buffer);
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(state->mutex);
+	auto& bucket = state->freeBuffers[buffer->bucketIndex];
+	if(bucket.size() < MAX_FREE_BUFFERS_PER_BUCKET)
+	{
+		bucket.push_back(buffer);
+	}
+	else
+	{
+		FreeBuffer(buffer);
+	}
+}
+
+CGsTransferBufferPool::BufferPtr CGsTransferBufferPool::Acquire(uint32 size)
+{
+	unsigned int bucketIndex = GetBucketIndex(size);
+	BUFFER* buffer = nullptr;
+
+	{
+		std::lock_guard<std::mutex> lock(m_state->mutex);
+		if(bucketIndex == BUCKET_COUNT)
+		{
+			m_state->stats.allocations++;
+			buffer = AllocateBuffer(bucketIndex, size);
+		}
+		else
+		{
+			auto& bucket = m_state->freeBuffers[bucketIndex];
+			if(bucket.empty())
+			{
+				m_state->stats.allocations++;
+				buffer = AllocateBuffer(bucketIndex, 1U << (bucketIndex + MIN_BUFFER_SIZE_LOG2));
+			}
+			else
+			{
+				m_state->stats.reuses++;
+				buffer = bucket.back();
+				bucket.pop_back();
+			}
+		}
+	}
+
+	assert(buffer->state == nullptr);
+	buffer->refCount.store(1, std::memory_order_relaxed);
+	buffer->state = m_state;
+	return BufferPtr(buffer);
+}
+
+CGsTransferBufferPool::STATS CGsTransferBufferPool::GetStats() const
+{
+	std::lock_guard<std::mutex> lock(m_state->mutex);
+	return m_state->stats;
+}
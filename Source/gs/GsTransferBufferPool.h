@@ -0,0 +1,96 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "Types.h"
+
+//Recycles the buffers used to carry image data to the GS thread. Buffers are reference counted
+//and go back to the pool when the last reference is dropped, which can happen on any thread.
+//The reference count lives in a header allocated along with the buffer, so reusing a pooled
+//buffer doesn't touch the heap.
+class CGsTransferBufferPool
+{
+	struct BUFFER;
+	struct STATE;
+
+public:
+	class BufferPtr
+	{
+	public:
+		BufferPtr() = default;
+		BufferPtr(const BufferPtr&);
+		BufferPtr(BufferPtr&&) noexcept;
+		~BufferPtr();
+
+		BufferPtr& operator=(const BufferPtr&);
+		BufferPtr& operator=(BufferPtr&&) noexcept;
+
+		uint8* get() const;
+		explicit operator bool() const;
+
+	private:
+		friend class CGsTransferBufferPool;
+
+		explicit BufferPtr(BUFFER*);
+		void Release();
+
+		BUFFER* m_buffer = nullptr;
+	};
+
+	struct STATS
+	{
+		uint32 allocations = 0;
+		uint32 reuses = 0;
+	};
+
+	CGsTransferBufferPool();
+	virtual ~CGsTransferBufferPool() = default;
+
+	CGsTransferBufferPool(const CGsTransferBufferPool&) = delete;
+	CGsTransferBufferPool& operator=(const CGsTransferBufferPool&) = delete;
+
+	BufferPtr Acquire(uint32);
+	STATS GetStats() const;
+
+private:
+	enum
+	{
+		MIN_BUFFER_SIZE_LOG2 = 16,
+		BUCKET_COUNT = 10,
+		MAX_FREE_BUFFERS_PER_BUCKET = 4,
+	};
+
+	//Precedes the buffer's data in the same allocation
+	struct BUFFER
+	{
+		std::atomic<uint32> refCount;
+		unsigned int bucketIndex = 0;
+		//Only set while the buffer is handed out, free buffers don't keep the pool alive
+		std::shared_ptr<STATE> state;
+	};
+
+	//Keeps the data as aligned as a plain heap allocation would be
+	static constexpr size_t DATA_OFFSET = (sizeof(BUFFER) + 0xF) & ~0xF;
+
+	typedef std::array<std::vector<BUFFER*>, BUCKET_COUNT> BucketArray;
+
+	//Outlives the pool if buffers are still referenced when it's destroyed
+	struct STATE
+	{
+		~STATE();
+
+		std::mutex mutex;
+		BucketArray freeBuffers;
+		STATS stats;
+	};
+
+	static unsigned int GetBucketIndex(uint32);
+	static BUFFER* AllocateBuffer(unsigned int, uint32);
+	static void FreeBuffer(BUFFER*);
+	static void ReleaseBuffer(BUFFER*);
+
+	std::shared_ptr<STATE> m_state;
+};
@@ -4,6 +4,7 @@
 #include "Iop_Intc.h"
 #include "../states/RegisterStateFile.h"
 #include "../Log.h"
+#include "../Trace.h"
 
 #define LOG_NAME ("iop_dmac")
 
@@ -98,9 +99,10 @@ uint8* CDmac::GetRam()
 
 uint32 CDmac::ReadRegister(uint32 address)
 {
-#ifdef _DEBUG
-	LogRead(address);
-#endif
+	if(CTrace::IsEnabled())
+	{
+		LogRead(address);
+	}
 	switch(address)
 	{
 	case DPCR:
@@ -124,9 +126,10 @@ uint32 CDmac::ReadRegister(uint32 address)
 
 uint32 CDmac::WriteRegister(uint32 address, uint32 value)
 {
-#ifdef _DEBUG
-	LogWrite(address, value);
-#endif
+	if(CTrace::IsEnabled())
+	{
+		LogWrite(address, value);
+	}
 	switch(address)
 	{
 	case DPCR:
@@ -188,10 +191,10 @@ void CDmac::LogRead(uint32 address)
 	switch(address)
 	{
 	case DPCR:
-		CLog::GetInstance().Print(LOG_NAME, "= DPCR.\r\n");
+		TRACE_PRINT(LOG_NAME, "= DPCR.\r\n");
 		break;
 	case DICR:
-		CLog::GetInstance().Print(LOG_NAME, "= DICR.\r\n");
+		TRACE_PRINT(LOG_NAME, "= DICR.\r\n");
 		break;
 	default:
 	{
@@ -200,10 +203,10 @@ void CDmac::LogRead(uint32 address)
 		switch(registerId)
 		{
 		case CChannel::REG_MADR:
-			CLog::GetInstance().Print(LOG_NAME, "ch%02d: = MADR.\r\n", channelId);
+			TRACE_PRINT(LOG_NAME, "ch%02d: = MADR.\r\n", channelId);
 			break;
 		case CChannel::REG_CHCR:
-			CLog::GetInstance().Print(LOG_NAME, "ch%02d: = CHCR.\r\n", channelId);
+			TRACE_PRINT(LOG_NAME, "ch%02d: = CHCR.\r\n", channelId);
 			break;
 		default:
 			CLog::GetInstance().Warn(LOG_NAME, "Read an unknown register 0x%08X.\r\n",
@@ -220,10 +223,10 @@ void CDmac::LogWrite(uint32 address, uint32 value)
 	switch(address)
 	{
 	case DPCR:
-		CLog::GetInstance().Print(LOG_NAME, "DPCR = 0x%08X.\r\n", value);
+		TRACE_PRINT(LOG_NAME, "DPCR = 0x%08X.\r\n", value);
 		break;
 	case DICR:
-		CLog::GetInstance().Print(LOG_NAME, "DICR = 0x%08X.\r\n", value);
+		TRACE_PRINT(LOG_NAME, "DICR = 0x%08X.\r\n", value);
 		break;
 	default:
 	{
@@ -232,16 +235,16 @@ void CDmac::LogWrite(uint32 address, uint32 value)
 		switch(registerId)
 		{
 		case CChannel::REG_MADR:
-			CLog::GetInstance().Print(LOG_NAME, "ch%02d: MADR = 0x%08X.\r\n", channelId, value);
+			TRACE_PRINT(LOG_NAME, "ch%02d: MADR = 0x%08X.\r\n", channelId, value);
 			break;
 		case CChannel::REG_BCR:
-			CLog::GetInstance().Print(LOG_NAME, "ch%02d: BCR = 0x%08X.\r\n", channelId, value);
+			TRACE_PRINT(LOG_NAME, "ch%02d: BCR = 0x%08X.\r\n", channelId, value);
 			break;
 		case CChannel::REG_BCR + 2:
-			CLog::GetInstance().Print(LOG_NAME, "ch%02d: BCR.ba = 0x%08X.\r\n", channelId, value);
+			TRACE_PRINT(LOG_NAME, "ch%02d: BCR.ba = 0x%08X.\r\n", channelId, value);
 			break;
 		case CChannel::REG_CHCR:
-			CLog::GetInstance().Print(LOG_NAME, "ch%02d: CHCR = 0x%08X.\r\n", channelId, value);
+			TRACE_PRINT(LOG_NAME, "ch%02d: CHCR = 0x%08X.\r\n", channelId, value);
 			break;
 		default:
 			CLog::GetInstance().Warn(LOG_NAME, "Wrote 0x%08X to unknown register 0x%08X.\r\n",
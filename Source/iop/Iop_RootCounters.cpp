@@ -3,7 +3,7 @@
 #include "Iop_RootCounters.h"
 #include "Iop_Intc.h"
 #include "string_format.h"
-#include "../Log.h"
+#include "../Trace.h"
 #include "../states/RegisterStateFile.h"
 
 #define LOG_NAME ("iop_counters")
@@ -181,9 +181,10 @@ void CRootCounters::Update(unsigned int ticks)
 
 uint32 CRootCounters::ReadRegister(uint32 address)
 {
-#ifdef _DEBUG
-	DisassembleRead(address);
-#endif
+	if(CTrace::IsEnabled())
+	{
+		DisassembleRead(address);
+	}
 	unsigned int counterId = GetCounterIdByAddress(address);
 	unsigned int registerId = address & 0x0F;
 	assert(counterId < MAX_COUNTERS);
@@ -204,9 +205,10 @@ uint32 CRootCounters::ReadRegister(uint32 address)
 
 uint32 CRootCounters::WriteRegister(uint32 address, uint32 value)
 {
-#ifdef _DEBUG
-	DisassembleWrite(address, value);
-#endif
+	if(CTrace::IsEnabled())
+	{
+		DisassembleWrite(address, value);
+	}
 	unsigned int counterId = GetCounterIdByAddress(address);
 	unsigned int registerId = address & 0x0F;
 	assert(counterId < MAX_COUNTERS);
@@ -233,16 +235,16 @@ void CRootCounters::DisassembleRead(uint32 address)
 	switch(registerId)
 	{
 	case CNT_COUNT:
-		CLog::GetInstance().Print(LOG_NAME, "CNT%d: = COUNT\r\n", counterId);
+		TRACE_PRINT(LOG_NAME, "CNT%d: = COUNT\r\n", counterId);
 		break;
 	case CNT_MODE:
-		CLog::GetInstance().Print(LOG_NAME, "CNT%d: = MODE\r\n", counterId);
+		TRACE_PRINT(LOG_NAME, "CNT%d: = MODE\r\n", counterId);
 		break;
 	case CNT_TARGET:
-		CLog::GetInstance().Print(LOG_NAME, "CNT%d: = TARGET\r\n", counterId);
+		TRACE_PRINT(LOG_NAME, "CNT%d: = TARGET\r\n", counterId);
 		break;
 	default:
-		CLog::GetInstance().Print(LOG_NAME, "Reading an unknown register (0x%08X).\r\n", address);
+		TRACE_PRINT(LOG_NAME, "Reading an unknown register (0x%08X).\r\n", address);
 		break;
 	}
 }
@@ -254,16 +256,16 @@ void CRootCounters::DisassembleWrite(uint32 address, uint32 value)
 	switch(registerId)
 	{
 	case CNT_COUNT:
-		CLog::GetInstance().Print(LOG_NAME, "CNT%d: COUNT = 0x%04X\r\n", counterId, value);
+		TRACE_PRINT(LOG_NAME, "CNT%d: COUNT = 0x%04X\r\n", counterId, value);
 		break;
 	case CNT_MODE:
-		CLog::GetInstance().Print(LOG_NAME, "CNT%d: MODE = 0x%08X\r\n", counterId, value);
+		TRACE_PRINT(LOG_NAME, "CNT%d: MODE = 0x%08X\r\n", counterId, value);
 		break;
 	case CNT_TARGET:
-		CLog::GetInstance().Print(LOG_NAME, "CNT%d: TARGET = 0x%04X\r\n", counterId, value);
+		TRACE_PRINT(LOG_NAME, "CNT%d: TARGET = 0x%04X\r\n", counterId, value);
 		break;
 	default:
-		CLog::GetInstance().Print(LOG_NAME, "Writing to an unknown register (0x%08X, 0x%08X).\r\n", address, value);
+		TRACE_PRINT(LOG_NAME, "Writing to an unknown register (0x%08X, 0x%08X).\r\n", address, value);
 		break;
 	}
 }
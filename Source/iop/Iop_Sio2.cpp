@@ -2,7 +2,7 @@
 #include <cstring>
 #include <vector>
 #include "Iop_Sio2.h"
-#include "../Log.h"
+#include "../Trace.h"
 #include "../states/RegisterStateFile.h"
 #include "../states/MemoryStateFile.h"
 
@@ -158,9 +158,10 @@ uint32 CSio2::ReadRegister(uint32 address)
 		m_outputBuffer.pop_front();
 		break;
 	}
-#ifdef _DEBUG
-	DisassembleRead(address, value);
-#endif
+	if(CTrace::IsEnabled())
+	{
+		DisassembleRead(address, value);
+	}
 	return value;
 }
 
@@ -209,9 +210,10 @@ void CSio2::WriteRegister(uint32 address, uint32 value)
 			break;
 		}
 	}
-#ifdef _DEBUG
-	DisassembleWrite(address, value);
-#endif
+	if(CTrace::IsEnabled())
+	{
+		DisassembleWrite(address, value);
+	}
 }
 
 void CSio2::ProcessCommand()
@@ -272,7 +274,7 @@ void CSio2::ProcessController(unsigned int portId, size_t outputOffset, uint32 d
 			m_outputBuffer[outputOffset + 0x06] = 0x00;
 			m_outputBuffer[outputOffset + 0x07] = 0x00;
 			m_outputBuffer[outputOffset + 0x08] = 0x5A;
-			CLog::GetInstance().Print(LOG_NAME, "Pad %d: SetVrefParam();\r\n", padId);
+			TRACE_PRINT(LOG_NAME, "Pad %d: SetVrefParam();\r\n", padId);
 			break;
 		case 0x41:
 			assert(dstSize == 9);
@@ -294,7 +296,7 @@ void CSio2::ProcessController(unsigned int portId, size_t outputOffset, uint32 d
 				m_outputBuffer[outputOffset + 0x07] = 0x00;
 				m_outputBuffer[outputOffset + 0x08] = 0x5A;
 			}
-			CLog::GetInstance().Print(LOG_NAME, "Pad %d: QueryButtonMask();\r\n", padId);
+			TRACE_PRINT(LOG_NAME, "Pad %d: QueryButtonMask();\r\n", padId);
 			break;
 		case 0x42: //Read Data
 			assert(dstSize == 5 || dstSize == 9 || dstSize == 21);
@@ -328,11 +330,11 @@ void CSio2::ProcessController(unsigned int portId, size_t outputOffset, uint32 d
 					m_outputBuffer[outputOffset + 0x14] = ((padState.buttonState & 0x0002) == 0) ? 0xFF : 0x00; //R2
 				}
 			}
-			CLog::GetInstance().Print(LOG_NAME, "Pad %d: ReadData();\r\n", padId);
+			TRACE_PRINT(LOG_NAME, "Pad %d: ReadData();\r\n", padId);
 			break;
 		case 0x43: //Enter Config Mode
 			padState.configMode = (m_inputBuffer[3] == 0x01);
-			CLog::GetInstance().Print(LOG_NAME, "Pad %d: EnterConfigMode(config = %d);\r\n", padId, m_inputBuffer[3]);
+			TRACE_PRINT(LOG_NAME, "Pad %d: EnterConfigMode(config = %d);\r\n", padId, m_inputBuffer[3]);
 			break;
 		case 0x44: //Set Mode & Lock
 		{
@@ -350,7 +352,7 @@ void CSio2::ProcessController(unsigned int portId, size_t outputOffset, uint32 d
 				m_outputBuffer[outputOffset + 0x08] = 0x00;
 			}
 			padState.mode = (mode == 0x01) ? ID_ANALOG : ID_DIGITAL;
-			CLog::GetInstance().Print(LOG_NAME, "Pad %d: SetModeAndLock(mode = %d, lock = %d);\r\n", padId, mode, lock);
+			TRACE_PRINT(LOG_NAME, "Pad %d: SetModeAndLock(mode = %d, lock = %d);\r\n", padId, mode, lock);
 		}
 		break;
 		case 0x45: //Query Model
@@ -358,7 +360,7 @@ void CSio2::ProcessController(unsigned int portId, size_t outputOffset, uint32 d
 			assert(padState.configMode);
 			std::copy(std::begin(DUALSHOCK2_MODEL), std::end(DUALSHOCK2_MODEL), m_outputBuffer.begin() + outputOffset + 0x03);
 			m_outputBuffer[outputOffset + 5] = (padState.mode == ID_DIGITAL) ? 0x00 : 0x01; //0x01 if analog pad
-			CLog::GetInstance().Print(LOG_NAME, "Pad %d: QueryModel();\r\n", padId);
+			TRACE_PRINT(LOG_NAME, "Pad %d: QueryModel();\r\n", padId);
 			break;
 		case 0x46:
 			assert(dstSize == 9);
@@ -371,13 +373,13 @@ void CSio2::ProcessController(unsigned int portId, size_t outputOffset, uint32 d
 			{
 				std::copy(std::begin(DUALSHOCK2_ID[1]), std::end(DUALSHOCK2_ID[1]), m_outputBuffer.begin() + outputOffset + 0x04);
 			}
-			CLog::GetInstance().Print(LOG_NAME, "Pad %d: QueryAct(mode = %d);\r\n", padId, m_inputBuffer[3]);
+			TRACE_PRINT(LOG_NAME, "Pad %d: QueryAct(mode = %d);\r\n", padId, m_inputBuffer[3]);
 			break;
 		case 0x47:
 			assert(dstSize == 9);
 			assert(padState.configMode);
 			std::copy(std::begin(DUALSHOCK2_ID[2]), std::end(DUALSHOCK2_ID[2]), m_outputBuffer.begin() + outputOffset + 0x04);
-			CLog::GetInstance().Print(LOG_NAME, "Pad %d: QueryComb();\r\n", padId);
+			TRACE_PRINT(LOG_NAME, "Pad %d: QueryComb();\r\n", padId);
 			break;
 		case 0x4C:
 			assert(dstSize == 9);
@@ -390,11 +392,11 @@ void CSio2::ProcessController(unsigned int portId, size_t outputOffset, uint32 d
 			{
 				std::copy(std::begin(DUALSHOCK2_ID[4]), std::end(DUALSHOCK2_ID[4]), m_outputBuffer.begin() + outputOffset + 0x04);
 			}
-			CLog::GetInstance().Print(LOG_NAME, "Pad %d: QueryMode(mode = %d);\r\n", padId, m_inputBuffer[3]);
+			TRACE_PRINT(LOG_NAME, "Pad %d: QueryMode(mode = %d);\r\n", padId, m_inputBuffer[3]);
 			break;
 		case 0x4D: //SetVibration
 			assert(dstSize == 9);
-			CLog::GetInstance().Print(LOG_NAME, "Pad %d: SetVibration();\r\n", padId);
+			TRACE_PRINT(LOG_NAME, "Pad %d: SetVibration();\r\n", padId);
 			break;
 		case 0x4F: //SetPollMask
 			assert(dstSize == 9);
@@ -409,17 +411,17 @@ void CSio2::ProcessController(unsigned int portId, size_t outputOffset, uint32 d
 			padState.pollMask[0] = m_inputBuffer[3];
 			padState.pollMask[1] = m_inputBuffer[4];
 			padState.pollMask[2] = m_inputBuffer[5];
-			CLog::GetInstance().Print(LOG_NAME, "Pad %d: SetPollMask(mask = { 0x%02X, 0x%02X, 0x%02X });\r\n",
-			                          padId, padState.pollMask[0], padState.pollMask[1], padState.pollMask[2]);
+			TRACE_PRINT(LOG_NAME, "Pad %d: SetPollMask(mask = { 0x%02X, 0x%02X, 0x%02X });\r\n",
+			            padId, padState.pollMask[0], padState.pollMask[1], padState.pollMask[2]);
 			break;
 		default:
-			CLog::GetInstance().Print(LOG_NAME, "Pad %d: Unknown command received (0x%02X).\r\n", padId, cmd);
+			TRACE_PRINT(LOG_NAME, "Pad %d: Unknown command received (0x%02X).\r\n", padId, cmd);
 			break;
 		}
 	}
 	else
 	{
-		CLog::GetInstance().Print(LOG_NAME, "Sending command to unsupported pad (%d).\r\n", portId);
+		TRACE_PRINT(LOG_NAME, "Sending command to unsupported pad (%d).\r\n", portId);
 	}
 }
 
@@ -432,13 +434,13 @@ void CSio2::ProcessMultitap(unsigned int portId, size_t outputOffset, uint32 dst
 	case 0x13:
 		//GetSlotNumber
 		m_outputBuffer[outputOffset + 0x03] = 1;
-		CLog::GetInstance().Print(LOG_NAME, "Multitap: GetSlotNumber();\r\n");
+		TRACE_PRINT(LOG_NAME, "Multitap: GetSlotNumber();\r\n");
 		break;
 	case 0x21:
 	case 0x22:
 		//ChangeSlot
 		m_outputBuffer[outputOffset + 0x05] = 0;
-		CLog::GetInstance().Print(LOG_NAME, "Multitap: ChangeSlot();\r\n");
+		TRACE_PRINT(LOG_NAME, "Multitap: ChangeSlot();\r\n");
 		break;
 	}
 }
@@ -448,13 +450,13 @@ void CSio2::DisassembleRead(uint32 address, uint32 value)
 	switch(address)
 	{
 	case REG_DATA_IN:
-		CLog::GetInstance().Print(LOG_NAME, "= DATA_IN = 0x%08X\r\n", value);
+		TRACE_PRINT(LOG_NAME, "= DATA_IN = 0x%08X\r\n", value);
 		break;
 	case REG_CTRL:
-		CLog::GetInstance().Print(LOG_NAME, "= REG_CTRL = 0x%08X\r\n", value);
+		TRACE_PRINT(LOG_NAME, "= REG_CTRL = 0x%08X\r\n", value);
 		break;
 	default:
-		CLog::GetInstance().Print(LOG_NAME, "Read an unknown register 0x%08X.\r\n", address);
+		TRACE_PRINT(LOG_NAME, "Read an unknown register 0x%08X.\r\n", address);
 		break;
 	}
 }
@@ -464,37 +466,37 @@ void CSio2::DisassembleWrite(uint32 address, uint32 value)
 	switch(address)
 	{
 	case REG_PORT0_CTRL1:
-		CLog::GetInstance().Print(LOG_NAME, "REG_PORT0_CTRL1 = 0x%08X\r\n", value);
+		TRACE_PRINT(LOG_NAME, "REG_PORT0_CTRL1 = 0x%08X\r\n", value);
 		break;
 	case REG_PORT0_CTRL2:
-		CLog::GetInstance().Print(LOG_NAME, "REG_PORT0_CTRL2 = 0x%08X\r\n", value);
+		TRACE_PRINT(LOG_NAME, "REG_PORT0_CTRL2 = 0x%08X\r\n", value);
 		break;
 	case REG_PORT1_CTRL1:
-		CLog::GetInstance().Print(LOG_NAME, "REG_PORT1_CTRL1 = 0x%08X\r\n", value);
+		TRACE_PRINT(LOG_NAME, "REG_PORT1_CTRL1 = 0x%08X\r\n", value);
 		break;
 	case REG_PORT1_CTRL2:
-		CLog::GetInstance().Print(LOG_NAME, "REG_PORT1_CTRL2 = 0x%08X\r\n", value);
+		TRACE_PRINT(LOG_NAME, "REG_PORT1_CTRL2 = 0x%08X\r\n", value);
 		break;
 	case REG_PORT2_CTRL1:
-		CLog::GetInstance().Print(LOG_NAME, "REG_PORT2_CTRL1 = 0x%08X\r\n", value);
+		TRACE_PRINT(LOG_NAME, "REG_PORT2_CTRL1 = 0x%08X\r\n", value);
 		break;
 	case REG_PORT2_CTRL2:
-		CLog::GetInstance().Print(LOG_NAME, "REG_PORT2_CTRL2 = 0x%08X\r\n", value);
+		TRACE_PRINT(LOG_NAME, "REG_PORT2_CTRL2 = 0x%08X\r\n", value);
 		break;
 	case REG_PORT3_CTRL1:
-		CLog::GetInstance().Print(LOG_NAME, "REG_PORT3_CTRL1 = 0x%08X\r\n", value);
+		TRACE_PRINT(LOG_NAME, "REG_PORT3_CTRL1 = 0x%08X\r\n", value);
 		break;
 	case REG_PORT3_CTRL2:
-		CLog::GetInstance().Print(LOG_NAME, "REG_PORT3_CTRL2 = 0x%08X\r\n", value);
+		TRACE_PRINT(LOG_NAME, "REG_PORT3_CTRL2 = 0x%08X\r\n", value);
 		break;
 	case REG_DATA_OUT:
-		CLog::GetInstance().Print(LOG_NAME, "DATA_OUT = 0x%08X\r\n", value);
+		TRACE_PRINT(LOG_NAME, "DATA_OUT = 0x%08X\r\n", value);
 		break;
 	case REG_CTRL:
-		CLog::GetInstance().Print(LOG_NAME, "CTRL = 0x%08X\r\n", value);
+		TRACE_PRINT(LOG_NAME, "CTRL = 0x%08X\r\n", value);
 		break;
 	default:
-		CLog::GetInstance().Print(LOG_NAME, "Write 0x%08X to an unknown register 0x%08X.\r\n", value, address);
+		TRACE_PRINT(LOG_NAME, "Write 0x%08X to an unknown register 0x%08X.\r\n", value, address);
 		break;
 	}
 }
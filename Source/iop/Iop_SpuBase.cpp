@@ -2,6 +2,8 @@
 #include <cstring>
 #include <cmath>
 #include <climits>
+#include <algorithm>
+#include <iterator>
 #include "string_format.h"
 #include "../Log.h"
 #include "../states/RegisterStateFile.h"
@@ -56,6 +58,81 @@ using namespace Iop;
 #define STATE_SAMPLEREADER_REGS_DIDCHANGEREPEAT ("DidChangeRepeat")
 #define STATE_SAMPLEREADER_REGS_BUFFER_FORMAT ("%sBuffer%d")
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define SPU_MIX_SSE2
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define SPU_MIX_NEON
+#endif
+
+namespace
+{
+	//Computes (a * b) / 0x7FFF, truncating like integer division. Products fit in 31 bits,
+	//so double precision division gives the exact same results.
+	void ScaleSamples(int32* dst, const int32* a, const int32* b, unsigned int count)
+	{
+		unsigned int i = 0;
+#if defined(SPU_MIX_SSE2)
+		const __m128d divisor = _mm_set1_pd(32767.0);
+		for(; (i + 4) <= count; i += 4)
+		{
+			__m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+			__m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+			__m128d lo = _mm_mul_pd(_mm_cvtepi32_pd(va), _mm_cvtepi32_pd(vb));
+			__m128d hi = _mm_mul_pd(_mm_cvtepi32_pd(_mm_shuffle_epi32(va, _MM_SHUFFLE(1, 0, 3, 2))), _mm_cvtepi32_pd(_mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2))));
+			__m128i resultLo = _mm_cvttpd_epi32(_mm_div_pd(lo, divisor));
+			__m128i resultHi = _mm_cvttpd_epi32(_mm_div_pd(hi, divisor));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_unpacklo_epi64(resultLo, resultHi));
+		}
+#elif defined(SPU_MIX_NEON)
+		const float64x2_t divisor = vdupq_n_f64(32767.0);
+		for(; (i + 4) <= count; i += 4)
+		{
+			int32x4_t va = vld1q_s32(a + i);
+			int32x4_t vb = vld1q_s32(b + i);
+			float64x2_t lo = vmulq_f64(vcvtq_f64_s64(vmovl_s32(vget_low_s32(va))), vcvtq_f64_s64(vmovl_s32(vget_low_s32(vb))));
+			float64x2_t hi = vmulq_f64(vcvtq_f64_s64(vmovl_s32(vget_high_s32(va))), vcvtq_f64_s64(vmovl_s32(vget_high_s32(vb))));
+			int32x2_t resultLo = vmovn_s64(vcvtq_s64_f64(vdivq_f64(lo, divisor)));
+			int32x2_t resultHi = vmovn_s64(vcvtq_s64_f64(vdivq_f64(hi, divisor)));
+			vst1q_s32(dst + i, vcombine_s32(resultLo, resultHi));
+		}
+#endif
+		for(; i < count; i++)
+		{
+			dst[i] = (a[i] * b[i]) / 0x7FFF;
+		}
+	}
+
+	//Adds samples to output, saturating like CSpuBase::MixSamples
+	void AccumulateSamples(int16* dst, const int32* src, unsigned int count)
+	{
+		unsigned int i = 0;
+#if defined(SPU_MIX_SSE2)
+		for(; (i + 4) <= count; i += 4)
+		{
+			__m128i output = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(dst + i));
+			output = _mm_srai_epi32(_mm_unpacklo_epi16(output, output), 16);
+			output = _mm_add_epi32(output, _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(dst + i), _mm_packs_epi32(output, output));
+		}
+#elif defined(SPU_MIX_NEON)
+		for(; (i + 4) <= count; i += 4)
+		{
+			int32x4_t output = vaddq_s32(vmovl_s16(vld1_s16(dst + i)), vld1q_s32(src + i));
+			vst1_s16(dst + i, vqmovn_s32(output));
+		}
+#endif
+		for(; i < count; i++)
+		{
+			int32 output = static_cast<int32>(dst[i]) + src[i];
+			output = std::max<int32>(output, SHRT_MIN);
+			output = std::min<int32>(output, SHRT_MAX);
+			dst[i] = static_cast<int16>(output);
+		}
+	}
+}
+
 bool CSpuBase::g_reverbParamIsAddress[REVERB_PARAM_COUNT] =
     {
         true,
@@ -594,7 +671,102 @@ void CSpuBase::MixSamples(int32 inputSample, int32 volumeLevel, int16* output)
 
 void CSpuBase::Render(int16* samples, unsigned int sampleCount, unsigned int sampleRate)
 {
-	bool updateReverb = m_reverbEnabled && (m_ctrl & CONTROL_REVERB) && (m_reverbWorkAddrStart < m_reverbWorkAddrEnd);
+	MixVoices(sampleCount, sampleRate, ADDRESS_RANGE());
+	FinishRender(samples, sampleCount, sampleRate);
+}
+
+CSpuBase::ADDRESS_RANGE CSpuBase::GetReverbWriteRange() const
+{
+	ADDRESS_RANGE range;
+	if(IsReverbUpdateEnabled())
+	{
+		//Reverb writes 16-bit samples anywhere in its work area (starting from the current address)
+		range.start = std::min(m_reverbWorkAddrStart, m_reverbCurrAddr);
+		range.end = m_reverbWorkAddrEnd + 2;
+	}
+	return range;
+}
+
+void CSpuBase::MixVoices(unsigned int sampleCount, unsigned int sampleRate, const ADDRESS_RANGE& externalWriteRange)
+{
+	assert(m_voiceMixState == VOICE_MIX_STATE::NONE);
+	assert((sampleCount & 0x01) == 0);
+
+	bool updateReverb = IsReverbUpdateEnabled();
+	bool checkIrqs = (m_ctrl & CONTROL_IRQ) && (m_irqAddr != INVALID_ADDRESS);
+	unsigned int ticks = sampleCount / 2;
+
+	m_voiceSamples.assign(sampleCount, 0);
+	m_reverbInputSamples.assign(sampleCount, 0);
+	m_voiceInput.resize(sampleCount);
+	m_voiceAdsrLevels.resize(sampleCount);
+	m_voiceVolumes.resize(sampleCount);
+
+	//Voices are mixed one after the other for the whole block, but reverb (ours, or the one from
+	//a core rendered before us) writes to RAM on every tick. If a voice reads from that memory,
+	//results would differ from the tick by tick renderer: voices are restored and FinishRender
+	//renders the block tick by tick.
+	auto reverbWriteRange = GetReverbWriteRange();
+	bool guardReads = !reverbWriteRange.IsEmpty() || !externalWriteRange.IsEmpty();
+	if(guardReads)
+	{
+		SaveVoiceState(m_voiceStateBackup);
+	}
+
+	bool readGuardHit = false;
+	for(unsigned int i = 0; i < MAX_CHANNEL; i++)
+	{
+		auto& reader(m_reader[i]);
+		if(guardReads)
+		{
+			reader.SetReadGuards(reverbWriteRange, externalWriteRange);
+		}
+		MixVoice(i, ticks, sampleRate, checkIrqs, updateReverb && (m_channelReverb.f & (1 << i)));
+		if(guardReads)
+		{
+			readGuardHit |= reader.GetReadGuardHit();
+			reader.ClearReadGuards();
+		}
+	}
+
+	if(readGuardHit)
+	{
+		RestoreVoiceState(m_voiceStateBackup);
+	}
+
+	m_voiceMixState = readGuardHit ? VOICE_MIX_STATE::INVALID : VOICE_MIX_STATE::READY;
+}
+
+void CSpuBase::FinishRender(int16* samples, unsigned int sampleCount, unsigned int sampleRate)
+{
+	assert(m_voiceMixState != VOICE_MIX_STATE::NONE);
+	auto voiceMixState = m_voiceMixState;
+	m_voiceMixState = VOICE_MIX_STATE::NONE;
+
+	if(voiceMixState == VOICE_MIX_STATE::INVALID)
+	{
+		RenderTicks(samples, sampleCount, sampleRate);
+		return;
+	}
+
+	assert(sampleCount == m_voiceSamples.size());
+	bool updateReverb = IsReverbUpdateEnabled();
+	unsigned int ticks = sampleCount / 2;
+	memcpy(samples, m_voiceSamples.data(), sizeof(int16) * sampleCount);
+
+	const int16* reverbSamples = m_reverbInputSamples.data();
+	for(unsigned int j = 0; j < ticks; j++)
+	{
+		MixInputAndReverb(samples, reverbSamples, sampleRate, updateReverb);
+		samples += 2;
+		reverbSamples += 2;
+	}
+}
+
+//Reference renderer, processes every voice on each tick
+void CSpuBase::RenderTicks(int16* samples, unsigned int sampleCount, unsigned int sampleRate)
+{
+	bool updateReverb = IsReverbUpdateEnabled();
 	bool checkIrqs = (m_ctrl & CONTROL_IRQ) && (m_irqAddr != INVALID_ADDRESS);
 
 	assert((sampleCount & 0x01) == 0);
@@ -608,218 +780,287 @@ void CSpuBase::Render(int16* samples, unsigned int sampleCount, unsigned int sam
 		//Update channels
 		for(unsigned int i = 0; i < 24; i++)
 		{
-			auto& channel(m_channel[i]);
-			if((channel.status == STOPPED) && !checkIrqs) continue;
-			auto& reader(m_reader[i]);
-			if(channel.status == KEY_ON)
-			{
-				reader.SetParams(channel.address, channel.repeat);
-				reader.ClearEndFlag();
-				channel.status = ATTACK;
-				channel.adsrVolume = 0;
-			}
-			else
-			{
-				if(reader.IsDone())
-				{
-					channel.status = STOPPED;
-					channel.adsrVolume = 0;
-					reader.ClearIsDone();
-					//No point in continuing if we don't need to check interrupts
-					if(!checkIrqs) continue;
-				}
-				if(reader.DidChangeRepeat())
-				{
-					channel.repeat = reader.GetRepeat();
-					reader.ClearDidChangeRepeat();
-				}
-				//Update repeat in case it has been changed externally (needed for FFX)
-				reader.SetRepeat(channel.repeat);
-			}
-
-			reader.SetIrqAddress(m_irqAddr);
-
-			int16 readSample = 0;
-			reader.SetPitch(m_baseSamplingRate, channel.pitch);
-			reader.GetSamples(&readSample, 1, sampleRate);
-			channel.current = reader.GetCurrent();
-
-			if(checkIrqs && reader.GetIrqPending())
-			{
-				m_irqPending = true;
-			}
-
-			reader.ClearIrqPending();
+			VOICE_SAMPLE voiceSample;
+			if(!ReadVoiceSample(i, sampleRate, checkIrqs, voiceSample)) continue;
 
-			//Mix samples
-			UpdateAdsr(channel);
-			int32 inputSample = static_cast<int32>(readSample);
 			//Mix adsrVolume
-			{
-				inputSample = (inputSample * static_cast<int32>(channel.adsrVolume >> 16)) / static_cast<int32>(MAX_ADSR_VOLUME >> 16);
-			}
-
-			channel.volumeLeftAbs = ComputeChannelVolume(channel.volumeLeft, channel.volumeLeftAbs);
-			channel.volumeRightAbs = ComputeChannelVolume(channel.volumeRight, channel.volumeRightAbs);
+			int32 inputSample = (voiceSample.sample * voiceSample.adsrLevel) / static_cast<int32>(MAX_ADSR_VOLUME >> 16);
 
-			int32 adjustedLeftVolume = std::min<int32>(0x7FFF, static_cast<int32>(static_cast<float>(channel.volumeLeftAbs >> 16) * m_volumeAdjust));
-			int32 adjustedRightVolume = std::min<int32>(0x7FFF, static_cast<int32>(static_cast<float>(channel.volumeRightAbs >> 16) * m_volumeAdjust));
-			MixSamples(inputSample, adjustedLeftVolume, samples + 0);
-			MixSamples(inputSample, adjustedRightVolume, samples + 1);
+			MixSamples(inputSample, voiceSample.leftVolume, samples + 0);
+			MixSamples(inputSample, voiceSample.rightVolume, samples + 1);
 			//Mix in reverb if enabled for this channel
 			if(updateReverb && (m_channelReverb.f & (1 << i)))
 			{
-				MixSamples(inputSample, adjustedLeftVolume, reverbSample + 0);
-				MixSamples(inputSample, adjustedRightVolume, reverbSample + 1);
+				MixSamples(inputSample, voiceSample.leftVolume, reverbSample + 0);
+				MixSamples(inputSample, voiceSample.rightVolume, reverbSample + 1);
 			}
 		}
 
-		if(!m_blockReader.CanReadSamples() && (m_blockWritePtr == SOUND_INPUT_DATA_SIZE))
+		MixInputAndReverb(samples, reverbSample, sampleRate, updateReverb);
+		samples += 2;
+	}
+}
+
+//Mixes one voice for the whole block in m_voiceSamples (and m_reverbInputSamples if needed)
+void CSpuBase::MixVoice(unsigned int channelIndex, unsigned int ticks, unsigned int sampleRate, bool checkIrqs, bool mixReverb)
+{
+	if((m_channel[channelIndex].status == STOPPED) && !checkIrqs) return;
+
+	//Buffers are interleaved like the output, the voice's sample goes in both left and right slots
+	auto input = m_voiceInput.data();
+	auto adsrLevels = m_voiceAdsrLevels.data();
+	auto volumes = m_voiceVolumes.data();
+	unsigned int sampleCount = ticks * 2;
+
+	for(unsigned int j = 0; j < ticks; j++)
+	{
+		VOICE_SAMPLE voiceSample;
+		if(!ReadVoiceSample(channelIndex, sampleRate, checkIrqs, voiceSample))
 		{
-			//We're ready to consume some data
-			m_blockReader.FillBlock(m_ram + m_soundInputDataAddr);
-			m_blockWritePtr = 0;
+			//Contributes nothing to this tick
+			voiceSample = VOICE_SAMPLE();
 		}
+		input[(j * 2) + 0] = voiceSample.sample;
+		input[(j * 2) + 1] = voiceSample.sample;
+		adsrLevels[(j * 2) + 0] = voiceSample.adsrLevel;
+		adsrLevels[(j * 2) + 1] = voiceSample.adsrLevel;
+		volumes[(j * 2) + 0] = voiceSample.leftVolume;
+		volumes[(j * 2) + 1] = voiceSample.rightVolume;
+	}
 
-		if(m_blockReader.CanReadSamples())
-		{
-			int16 sampleL = 0;
-			int16 sampleR = 0;
-			m_blockReader.GetSamples(sampleL, sampleR, sampleRate);
+	ScaleSamples(input, input, adsrLevels, sampleCount);
+	ScaleSamples(input, input, volumes, sampleCount);
+	AccumulateSamples(m_voiceSamples.data(), input, sampleCount);
+	if(mixReverb)
+	{
+		AccumulateSamples(m_reverbInputSamples.data(), input, sampleCount);
+	}
+}
 
-			MixSamples(sampleL, 0x3FFF, samples + 0);
-			MixSamples(sampleR, 0x3FFF, samples + 1);
+//Advances a voice by one tick, returns false if the voice doesn't need to be mixed
+bool CSpuBase::ReadVoiceSample(unsigned int channelIndex, unsigned int sampleRate, bool checkIrqs, VOICE_SAMPLE& result)
+{
+	auto& channel(m_channel[channelIndex]);
+	if((channel.status == STOPPED) && !checkIrqs) return false;
+	auto& reader(m_reader[channelIndex]);
+	if(channel.status == KEY_ON)
+	{
+		reader.SetParams(channel.address, channel.repeat);
+		reader.ClearEndFlag();
+		channel.status = ATTACK;
+		channel.adsrVolume = 0;
+	}
+	else
+	{
+		if(reader.IsDone())
+		{
+			channel.status = STOPPED;
+			channel.adsrVolume = 0;
+			reader.ClearIsDone();
+			//No point in continuing if we don't need to check interrupts
+			if(!checkIrqs) return false;
 		}
+		if(reader.DidChangeRepeat())
+		{
+			channel.repeat = reader.GetRepeat();
+			reader.ClearDidChangeRepeat();
+		}
+		//Update repeat in case it has been changed externally (needed for FFX)
+		reader.SetRepeat(channel.repeat);
+	}
+
+	reader.SetIrqAddress(m_irqAddr);
+
+	int16 readSample = 0;
+	reader.SetPitch(m_baseSamplingRate, channel.pitch);
+	reader.GetSamples(&readSample, 1, sampleRate);
+	channel.current = reader.GetCurrent();
+
+	if(checkIrqs && reader.GetIrqPending())
+	{
+		m_irqPending = true;
+	}
+
+	reader.ClearIrqPending();
+
+	UpdateAdsr(channel);
+	result.sample = static_cast<int32>(readSample);
+	result.adsrLevel = static_cast<int32>(channel.adsrVolume >> 16);
+
+	channel.volumeLeftAbs = ComputeChannelVolume(channel.volumeLeft, channel.volumeLeftAbs);
+	channel.volumeRightAbs = ComputeChannelVolume(channel.volumeRight, channel.volumeRightAbs);
+
+	result.leftVolume = std::min<int32>(0x7FFF, static_cast<int32>(static_cast<float>(channel.volumeLeftAbs >> 16) * m_volumeAdjust));
+	result.rightVolume = std::min<int32>(0x7FFF, static_cast<int32>(static_cast<float>(channel.volumeRightAbs >> 16) * m_volumeAdjust));
+	return true;
+}
+
+//Mixes sound input data and reverb for one tick, voices must have been mixed already
+void CSpuBase::MixInputAndReverb(int16* samples, const int16* reverbSample, unsigned int sampleRate, bool updateReverb)
+{
+	if(!m_blockReader.CanReadSamples() && (m_blockWritePtr == SOUND_INPUT_DATA_SIZE))
+	{
+		//We're ready to consume some data
+		m_blockReader.FillBlock(m_ram + m_soundInputDataAddr);
+		m_blockWritePtr = 0;
+	}
 
-		//Update reverb
-		if(updateReverb)
+	if(m_blockReader.CanReadSamples())
+	{
+		int16 sampleL = 0;
+		int16 sampleR = 0;
+		m_blockReader.GetSamples(sampleL, sampleR, sampleRate);
+
+		MixSamples(sampleL, 0x3FFF, samples + 0);
+		MixSamples(sampleR, 0x3FFF, samples + 1);
+	}
+
+	//Update reverb
+	if(updateReverb)
+	{
+		//Feed samples to FIR filter
+		if(m_reverbTicks & 1)
 		{
-			//Feed samples to FIR filter
-			if(m_reverbTicks & 1)
+			//IIR_INPUT_A0 = buffer[IIR_SRC_A0] * IIR_COEF + INPUT_SAMPLE_L * IN_COEF_L;
+			//IIR_INPUT_A1 = buffer[IIR_SRC_A1] * IIR_COEF + INPUT_SAMPLE_R * IN_COEF_R;
+			//IIR_INPUT_B0 = buffer[IIR_SRC_B0] * IIR_COEF + INPUT_SAMPLE_L * IN_COEF_L;
+			//IIR_INPUT_B1 = buffer[IIR_SRC_B1] * IIR_COEF + INPUT_SAMPLE_R * IN_COEF_R;
+
+			float input_sample_l = static_cast<float>(reverbSample[0]) * 0.5f;
+			float input_sample_r = static_cast<float>(reverbSample[1]) * 0.5f;
+
+			float irr_coef = GetReverbCoef(IIR_COEF);
+			float in_coef_l = GetReverbCoef(IN_COEF_L);
+			float in_coef_r = GetReverbCoef(IN_COEF_R);
+
+			float iir_input_a0 = GetReverbSample(GetReverbOffset(ACC_SRC_A0)) * irr_coef + input_sample_l * in_coef_l;
+			float iir_input_a1 = GetReverbSample(GetReverbOffset(ACC_SRC_A1)) * irr_coef + input_sample_r * in_coef_r;
+			float iir_input_b0 = GetReverbSample(GetReverbOffset(ACC_SRC_B0)) * irr_coef + input_sample_l * in_coef_l;
+			float iir_input_b1 = GetReverbSample(GetReverbOffset(ACC_SRC_B1)) * irr_coef + input_sample_r * in_coef_r;
+
+			//IIR_A0 = IIR_INPUT_A0 * IIR_ALPHA + buffer[IIR_DEST_A0] * (1.0 - IIR_ALPHA);
+			//IIR_A1 = IIR_INPUT_A1 * IIR_ALPHA + buffer[IIR_DEST_A1] * (1.0 - IIR_ALPHA);
+			//IIR_B0 = IIR_INPUT_B0 * IIR_ALPHA + buffer[IIR_DEST_B0] * (1.0 - IIR_ALPHA);
+			//IIR_B1 = IIR_INPUT_B1 * IIR_ALPHA + buffer[IIR_DEST_B1] * (1.0 - IIR_ALPHA);
+
+			float iir_alpha = GetReverbCoef(IIR_ALPHA);
+
+			float iir_a0 = iir_input_a0 * iir_alpha + GetReverbSample(GetReverbOffset(IIR_DEST_A0)) * (1.0f - iir_alpha);
+			float iir_a1 = iir_input_a1 * iir_alpha + GetReverbSample(GetReverbOffset(IIR_DEST_A1)) * (1.0f - iir_alpha);
+			float iir_b0 = iir_input_b0 * iir_alpha + GetReverbSample(GetReverbOffset(IIR_DEST_B0)) * (1.0f - iir_alpha);
+			float iir_b1 = iir_input_b1 * iir_alpha + GetReverbSample(GetReverbOffset(IIR_DEST_B1)) * (1.0f - iir_alpha);
+
+			//buffer[IIR_DEST_A0 + 1sample] = IIR_A0;
+			//buffer[IIR_DEST_A1 + 1sample] = IIR_A1;
+			//buffer[IIR_DEST_B0 + 1sample] = IIR_B0;
+			//buffer[IIR_DEST_B1 + 1sample] = IIR_B1;
+
+			SetReverbSample(GetReverbOffset(IIR_DEST_A0) + 2, iir_a0);
+			SetReverbSample(GetReverbOffset(IIR_DEST_A1) + 2, iir_a1);
+			SetReverbSample(GetReverbOffset(IIR_DEST_B0) + 2, iir_b0);
+			SetReverbSample(GetReverbOffset(IIR_DEST_B1) + 2, iir_b1);
+
+			//ACC0 = buffer[ACC_SRC_A0] * ACC_COEF_A +
+			//	   buffer[ACC_SRC_B0] * ACC_COEF_B +
+			//	   buffer[ACC_SRC_C0] * ACC_COEF_C +
+			//	   buffer[ACC_SRC_D0] * ACC_COEF_D;
+			//ACC1 = buffer[ACC_SRC_A1] * ACC_COEF_A +
+			//	   buffer[ACC_SRC_B1] * ACC_COEF_B +
+			//	   buffer[ACC_SRC_C1] * ACC_COEF_C +
+			//	   buffer[ACC_SRC_D1] * ACC_COEF_D;
+
+			float acc_coef_a = GetReverbCoef(ACC_COEF_A);
+			float acc_coef_b = GetReverbCoef(ACC_COEF_B);
+			float acc_coef_c = GetReverbCoef(ACC_COEF_C);
+			float acc_coef_d = GetReverbCoef(ACC_COEF_D);
+
+			float acc0 =
+			    GetReverbSample(GetReverbOffset(ACC_SRC_A0)) * acc_coef_a +
+			    GetReverbSample(GetReverbOffset(ACC_SRC_B0)) * acc_coef_b +
+			    GetReverbSample(GetReverbOffset(ACC_SRC_C0)) * acc_coef_c +
+			    GetReverbSample(GetReverbOffset(ACC_SRC_D0)) * acc_coef_d;
+
+			float acc1 =
+			    GetReverbSample(GetReverbOffset(ACC_SRC_A1)) * acc_coef_a +
+			    GetReverbSample(GetReverbOffset(ACC_SRC_B1)) * acc_coef_b +
+			    GetReverbSample(GetReverbOffset(ACC_SRC_C1)) * acc_coef_c +
+			    GetReverbSample(GetReverbOffset(ACC_SRC_D1)) * acc_coef_d;
+
+			//FB_A0 = buffer[MIX_DEST_A0 - FB_SRC_A];
+			//FB_A1 = buffer[MIX_DEST_A1 - FB_SRC_A];
+			//FB_B0 = buffer[MIX_DEST_B0 - FB_SRC_B];
+			//FB_B1 = buffer[MIX_DEST_B1 - FB_SRC_B];
+
+			float fb_a0 = GetReverbSample(GetReverbOffset(MIX_DEST_A0) - GetReverbOffset(FB_SRC_A));
+			float fb_a1 = GetReverbSample(GetReverbOffset(MIX_DEST_A1) - GetReverbOffset(FB_SRC_A));
+			float fb_b0 = GetReverbSample(GetReverbOffset(MIX_DEST_B0) - GetReverbOffset(FB_SRC_B));
+			float fb_b1 = GetReverbSample(GetReverbOffset(MIX_DEST_B1) - GetReverbOffset(FB_SRC_B));
+
+			//buffer[MIX_DEST_A0] = ACC0 - FB_A0 * FB_ALPHA;
+			//buffer[MIX_DEST_A1] = ACC1 - FB_A1 * FB_ALPHA;
+			//buffer[MIX_DEST_B0] = (FB_ALPHA * ACC0) - FB_A0 * (FB_ALPHA^0x8000) - FB_B0 * FB_X;
+			//buffer[MIX_DEST_B1] = (FB_ALPHA * ACC1) - FB_A1 * (FB_ALPHA^0x8000) - FB_B1 * FB_X;
+
+			float fb_alpha = GetReverbCoef(FB_ALPHA);
+			float fb_x = GetReverbCoef(FB_X);
+
+			SetReverbSample(GetReverbOffset(MIX_DEST_A0), acc0 - fb_a0 * fb_alpha);
+			SetReverbSample(GetReverbOffset(MIX_DEST_A1), acc1 - fb_a1 * fb_alpha);
+			SetReverbSample(GetReverbOffset(MIX_DEST_B0), (fb_alpha * acc0) - fb_a0 * -fb_alpha - fb_b0 * fb_x);
+			SetReverbSample(GetReverbOffset(MIX_DEST_B1), (fb_alpha * acc1) - fb_a1 * -fb_alpha - fb_b1 * fb_x);
+
+			m_reverbCurrAddr += 2;
+			if(m_reverbCurrAddr >= m_reverbWorkAddrEnd)
 			{
-				//IIR_INPUT_A0 = buffer[IIR_SRC_A0] * IIR_COEF + INPUT_SAMPLE_L * IN_COEF_L;
-				//IIR_INPUT_A1 = buffer[IIR_SRC_A1] * IIR_COEF + INPUT_SAMPLE_R * IN_COEF_R;
-				//IIR_INPUT_B0 = buffer[IIR_SRC_B0] * IIR_COEF + INPUT_SAMPLE_L * IN_COEF_L;
-				//IIR_INPUT_B1 = buffer[IIR_SRC_B1] * IIR_COEF + INPUT_SAMPLE_R * IN_COEF_R;
-
-				float input_sample_l = static_cast<float>(reverbSample[0]) * 0.5f;
-				float input_sample_r = static_cast<float>(reverbSample[1]) * 0.5f;
-
-				float irr_coef = GetReverbCoef(IIR_COEF);
-				float in_coef_l = GetReverbCoef(IN_COEF_L);
-				float in_coef_r = GetReverbCoef(IN_COEF_R);
-
-				float iir_input_a0 = GetReverbSample(GetReverbOffset(ACC_SRC_A0)) * irr_coef + input_sample_l * in_coef_l;
-				float iir_input_a1 = GetReverbSample(GetReverbOffset(ACC_SRC_A1)) * irr_coef + input_sample_r * in_coef_r;
-				float iir_input_b0 = GetReverbSample(GetReverbOffset(ACC_SRC_B0)) * irr_coef + input_sample_l * in_coef_l;
-				float iir_input_b1 = GetReverbSample(GetReverbOffset(ACC_SRC_B1)) * irr_coef + input_sample_r * in_coef_r;
-
-				//IIR_A0 = IIR_INPUT_A0 * IIR_ALPHA + buffer[IIR_DEST_A0] * (1.0 - IIR_ALPHA);
-				//IIR_A1 = IIR_INPUT_A1 * IIR_ALPHA + buffer[IIR_DEST_A1] * (1.0 - IIR_ALPHA);
-				//IIR_B0 = IIR_INPUT_B0 * IIR_ALPHA + buffer[IIR_DEST_B0] * (1.0 - IIR_ALPHA);
-				//IIR_B1 = IIR_INPUT_B1 * IIR_ALPHA + buffer[IIR_DEST_B1] * (1.0 - IIR_ALPHA);
-
-				float iir_alpha = GetReverbCoef(IIR_ALPHA);
-
-				float iir_a0 = iir_input_a0 * iir_alpha + GetReverbSample(GetReverbOffset(IIR_DEST_A0)) * (1.0f - iir_alpha);
-				float iir_a1 = iir_input_a1 * iir_alpha + GetReverbSample(GetReverbOffset(IIR_DEST_A1)) * (1.0f - iir_alpha);
-				float iir_b0 = iir_input_b0 * iir_alpha + GetReverbSample(GetReverbOffset(IIR_DEST_B0)) * (1.0f - iir_alpha);
-				float iir_b1 = iir_input_b1 * iir_alpha + GetReverbSample(GetReverbOffset(IIR_DEST_B1)) * (1.0f - iir_alpha);
-
-				//buffer[IIR_DEST_A0 + 1sample] = IIR_A0;
-				//buffer[IIR_DEST_A1 + 1sample] = IIR_A1;
-				//buffer[IIR_DEST_B0 + 1sample] = IIR_B0;
-				//buffer[IIR_DEST_B1 + 1sample] = IIR_B1;
-
-				SetReverbSample(GetReverbOffset(IIR_DEST_A0) + 2, iir_a0);
-				SetReverbSample(GetReverbOffset(IIR_DEST_A1) + 2, iir_a1);
-				SetReverbSample(GetReverbOffset(IIR_DEST_B0) + 2, iir_b0);
-				SetReverbSample(GetReverbOffset(IIR_DEST_B1) + 2, iir_b1);
-
-				//ACC0 = buffer[ACC_SRC_A0] * ACC_COEF_A +
-				//	   buffer[ACC_SRC_B0] * ACC_COEF_B +
-				//	   buffer[ACC_SRC_C0] * ACC_COEF_C +
-				//	   buffer[ACC_SRC_D0] * ACC_COEF_D;
-				//ACC1 = buffer[ACC_SRC_A1] * ACC_COEF_A +
-				//	   buffer[ACC_SRC_B1] * ACC_COEF_B +
-				//	   buffer[ACC_SRC_C1] * ACC_COEF_C +
-				//	   buffer[ACC_SRC_D1] * ACC_COEF_D;
-
-				float acc_coef_a = GetReverbCoef(ACC_COEF_A);
-				float acc_coef_b = GetReverbCoef(ACC_COEF_B);
-				float acc_coef_c = GetReverbCoef(ACC_COEF_C);
-				float acc_coef_d = GetReverbCoef(ACC_COEF_D);
-
-				float acc0 =
-				    GetReverbSample(GetReverbOffset(ACC_SRC_A0)) * acc_coef_a +
-				    GetReverbSample(GetReverbOffset(ACC_SRC_B0)) * acc_coef_b +
-				    GetReverbSample(GetReverbOffset(ACC_SRC_C0)) * acc_coef_c +
-				    GetReverbSample(GetReverbOffset(ACC_SRC_D0)) * acc_coef_d;
-
-				float acc1 =
-				    GetReverbSample(GetReverbOffset(ACC_SRC_A1)) * acc_coef_a +
-				    GetReverbSample(GetReverbOffset(ACC_SRC_B1)) * acc_coef_b +
-				    GetReverbSample(GetReverbOffset(ACC_SRC_C1)) * acc_coef_c +
-				    GetReverbSample(GetReverbOffset(ACC_SRC_D1)) * acc_coef_d;
-
-				//FB_A0 = buffer[MIX_DEST_A0 - FB_SRC_A];
-				//FB_A1 = buffer[MIX_DEST_A1 - FB_SRC_A];
-				//FB_B0 = buffer[MIX_DEST_B0 - FB_SRC_B];
-				//FB_B1 = buffer[MIX_DEST_B1 - FB_SRC_B];
-
-				float fb_a0 = GetReverbSample(GetReverbOffset(MIX_DEST_A0) - GetReverbOffset(FB_SRC_A));
-				float fb_a1 = GetReverbSample(GetReverbOffset(MIX_DEST_A1) - GetReverbOffset(FB_SRC_A));
-				float fb_b0 = GetReverbSample(GetReverbOffset(MIX_DEST_B0) - GetReverbOffset(FB_SRC_B));
-				float fb_b1 = GetReverbSample(GetReverbOffset(MIX_DEST_B1) - GetReverbOffset(FB_SRC_B));
-
-				//buffer[MIX_DEST_A0] = ACC0 - FB_A0 * FB_ALPHA;
-				//buffer[MIX_DEST_A1] = ACC1 - FB_A1 * FB_ALPHA;
-				//buffer[MIX_DEST_B0] = (FB_ALPHA * ACC0) - FB_A0 * (FB_ALPHA^0x8000) - FB_B0 * FB_X;
-				//buffer[MIX_DEST_B1] = (FB_ALPHA * ACC1) - FB_A1 * (FB_ALPHA^0x8000) - FB_B1 * FB_X;
-
-				float fb_alpha = GetReverbCoef(FB_ALPHA);
-				float fb_x = GetReverbCoef(FB_X);
-
-				SetReverbSample(GetReverbOffset(MIX_DEST_A0), acc0 - fb_a0 * fb_alpha);
-				SetReverbSample(GetReverbOffset(MIX_DEST_A1), acc1 - fb_a1 * fb_alpha);
-				SetReverbSample(GetReverbOffset(MIX_DEST_B0), (fb_alpha * acc0) - fb_a0 * -fb_alpha - fb_b0 * fb_x);
-				SetReverbSample(GetReverbOffset(MIX_DEST_B1), (fb_alpha * acc1) - fb_a1 * -fb_alpha - fb_b1 * fb_x);
-
-				m_reverbCurrAddr += 2;
-				if(m_reverbCurrAddr >= m_reverbWorkAddrEnd)
-				{
-					m_reverbCurrAddr = m_reverbWorkAddrStart;
-				}
+				m_reverbCurrAddr = m_reverbWorkAddrStart;
 			}
+		}
 
-			if(m_reverbWorkAddrStart != 0)
-			{
-				float sampleL = 0.333f * (GetReverbSample(GetReverbOffset(MIX_DEST_A0)) + GetReverbSample(GetReverbOffset(MIX_DEST_B0)));
-				float sampleR = 0.333f * (GetReverbSample(GetReverbOffset(MIX_DEST_A1)) + GetReverbSample(GetReverbOffset(MIX_DEST_B1)));
-
-				{
-					int16* output = samples + 0;
-					int32 resultSample = static_cast<int32>(sampleL) + static_cast<int32>(*output);
-					resultSample = std::max<int32>(resultSample, SHRT_MIN);
-					resultSample = std::min<int32>(resultSample, SHRT_MAX);
-					*output = static_cast<int16>(resultSample);
-				}
+		if(m_reverbWorkAddrStart != 0)
+		{
+			float sampleL = 0.333f * (GetReverbSample(GetReverbOffset(MIX_DEST_A0)) + GetReverbSample(GetReverbOffset(MIX_DEST_B0)));
+			float sampleR = 0.333f * (GetReverbSample(GetReverbOffset(MIX_DEST_A1)) + GetReverbSample(GetReverbOffset(MIX_DEST_B1)));
 
-				{
-					int16* output = samples + 1;
-					int32 resultSample = static_cast<int32>(sampleR) + static_cast<int32>(*output);
-					resultSample = std::max<int32>(resultSample, SHRT_MIN);
-					resultSample = std::min<int32>(resultSample, SHRT_MAX);
-					*output = static_cast<int16>(resultSample);
-				}
+			{
+				int16* output = samples + 0;
+				int32 resultSample = static_cast<int32>(sampleL) + static_cast<int32>(*output);
+				resultSample = std::max<int32>(resultSample, SHRT_MIN);
+				resultSample = std::min<int32>(resultSample, SHRT_MAX);
+				*output = static_cast<int16>(resultSample);
 			}
 
-			m_reverbTicks++;
+			{
+				int16* output = samples + 1;
+				int32 resultSample = static_cast<int32>(sampleR) + static_cast<int32>(*output);
+				resultSample = std::max<int32>(resultSample, SHRT_MIN);
+				resultSample = std::min<int32>(resultSample, SHRT_MAX);
+				*output = static_cast<int16>(resultSample);
+			}
 		}
-		samples += 2;
+
+		m_reverbTicks++;
 	}
 }
 
+bool CSpuBase::IsReverbUpdateEnabled() const
+{
+	return m_reverbEnabled && (m_ctrl & CONTROL_REVERB) && (m_reverbWorkAddrStart < m_reverbWorkAddrEnd);
+}
+
+void CSpuBase::SaveVoiceState(VOICE_STATE& state) const
+{
+	std::copy(std::begin(m_channel), std::end(m_channel), std::begin(state.channels));
+	std::copy(std::begin(m_reader), std::end(m_reader), std::begin(state.readers));
+	state.irqPending = m_irqPending;
+}
+
+void CSpuBase::RestoreVoiceState(const VOICE_STATE& state)
+{
+	std::copy(std::begin(state.channels), std::end(state.channels), std::begin(m_channel));
+	std::copy(std::begin(state.readers), std::end(state.readers), std::begin(m_reader));
+	m_irqPending = state.irqPending;
+}
+
 uint32 CSpuBase::GetAdsrDelta(unsigned int index) const
 {
 	return m_adsrLogTable[index + 32];
@@ -1114,6 +1355,11 @@ void CSpuBase::CSampleReader::UnpackSamples(int16* dst)
 
 	uint8* nextSample = m_ram + m_nextSampleAddr;
 
+	if(m_readGuards[0].Intersects(m_nextSampleAddr, 0x10) || m_readGuards[1].Intersects(m_nextSampleAddr, 0x10))
+	{
+		m_readGuardHit = true;
+	}
+
 	if(m_nextSampleAddr == m_irqAddr)
 	{
 		m_irqPending = true;
@@ -1248,6 +1494,25 @@ void CSpuBase::CSampleReader::ClearDidChangeRepeat()
 	m_didChangeRepeat = false;
 }
 
+void CSpuBase::CSampleReader::SetReadGuards(const ADDRESS_RANGE& firstRange, const ADDRESS_RANGE& secondRange)
+{
+	m_readGuards[0] = firstRange;
+	m_readGuards[1] = secondRange;
+	m_readGuardHit = false;
+}
+
+void CSpuBase::CSampleReader::ClearReadGuards()
+{
+	m_readGuards[0] = ADDRESS_RANGE();
+	m_readGuards[1] = ADDRESS_RANGE();
+	m_readGuardHit = false;
+}
+
+bool CSpuBase::CSampleReader::GetReadGuardHit() const
+{
+	return m_readGuardHit;
+}
+
 ///////////////////////////////////////////////////////
 // CBlockSampleReader
 ///////////////////////////////////////////////////////
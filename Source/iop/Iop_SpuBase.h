@@ -5,6 +5,7 @@
 #include "Convertible.h"
 #include "zip/ZipArchiveWriter.h"
 #include "zip/ZipArchiveReader.h"
+#include <vector>
 
 class CRegisterStateFile;
 
@@ -152,6 +153,22 @@ namespace Iop
 			uint32 current;
 		};
 
+		struct ADDRESS_RANGE
+		{
+			uint32 start = 0;
+			uint32 end = 0;
+
+			bool IsEmpty() const
+			{
+				return start >= end;
+			}
+
+			bool Intersects(uint32 address, uint32 size) const
+			{
+				return (address < end) && ((address + size) > start);
+			}
+		};
+
 		CSpuBase(uint8*, uint32, unsigned int);
 		virtual ~CSpuBase() = default;
 
@@ -216,6 +233,12 @@ namespace Iop
 
 		void Render(int16*, unsigned int, unsigned int);
 
+		//Render split in two steps: MixVoices only reads SPU RAM and can run concurrently with
+		//another core's MixVoices (which must then get the RAM range written by our reverb).
+		void MixVoices(unsigned int, unsigned int, const ADDRESS_RANGE&);
+		void FinishRender(int16*, unsigned int, unsigned int);
+		ADDRESS_RANGE GetReverbWriteRange() const;
+
 		static bool g_reverbParamIsAddress[REVERB_PARAM_COUNT];
 
 	private:
@@ -256,6 +279,10 @@ namespace Iop
 			bool DidChangeRepeat() const;
 			void ClearDidChangeRepeat();
 
+			void SetReadGuards(const ADDRESS_RANGE&, const ADDRESS_RANGE&);
+			void ClearReadGuards();
+			bool GetReadGuardHit() const;
+
 		private:
 			enum
 			{
@@ -283,6 +310,8 @@ namespace Iop
 			bool m_endFlag;
 			bool m_irqPending = false;
 			bool m_didChangeRepeat;
+			ADDRESS_RANGE m_readGuards[2];
+			bool m_readGuardHit = false;
 
 			static_assert((sizeof(decltype(m_buffer)) % 16) == 0, "sizeof(m_buffer) must be a multiple of 16 (needed for saved state).");
 		};
@@ -311,6 +340,36 @@ namespace Iop
 			MAX_ADSR_VOLUME = 0x7FFFFFFF,
 		};
 
+		enum class VOICE_MIX_STATE
+		{
+			NONE,
+			READY,
+			INVALID,
+		};
+
+		struct VOICE_SAMPLE
+		{
+			int32 sample = 0;
+			int32 adsrLevel = 0;
+			int32 leftVolume = 0;
+			int32 rightVolume = 0;
+		};
+
+		struct VOICE_STATE
+		{
+			CHANNEL channels[MAX_CHANNEL];
+			CSampleReader readers[MAX_CHANNEL];
+			bool irqPending = false;
+		};
+
+		void RenderTicks(int16*, unsigned int, unsigned int);
+		void MixVoice(unsigned int, unsigned int, unsigned int, bool, bool);
+		bool ReadVoiceSample(unsigned int, unsigned int, bool, VOICE_SAMPLE&);
+		void MixInputAndReverb(int16*, const int16*, unsigned int, bool);
+		bool IsReverbUpdateEnabled() const;
+		void SaveVoiceState(VOICE_STATE&) const;
+		void RestoreVoiceState(const VOICE_STATE&);
+
 		void UpdateAdsr(CHANNEL&);
 		uint32 GetAdsrDelta(unsigned int) const;
 		float GetReverbSample(uint32) const;
@@ -351,6 +410,14 @@ namespace Iop
 		uint32 m_soundInputDataAddr = 0;
 		uint32 m_blockWritePtr = 0;
 
+		VOICE_MIX_STATE m_voiceMixState = VOICE_MIX_STATE::NONE;
+		std::vector<int16> m_voiceSamples;
+		std::vector<int16> m_reverbInputSamples;
+		std::vector<int32> m_voiceInput;
+		std::vector<int32> m_voiceAdsrLevels;
+		std::vector<int32> m_voiceVolumes;
+		VOICE_STATE m_voiceStateBackup;
+
 		static_assert((sizeof(decltype(m_reverb)) % 16) == 0, "sizeof(m_reverb) must be a multiple of 16 (needed for saved state).");
 	};
 }
@@ -0,0 +1,25 @@
+#include <cassert>
+#include "Iop_SpuMixWorker.h"
+
+using namespace Iop;
+
+CSpuMixWorker::CSpuMixWorker()
+    : CSingleJobWorker("SPU mix", [this]() { m_spu->MixVoices(m_sampleCount, m_sampleRate, m_externalWriteRange); })
+{
+}
+
+CSpuMixWorker::~CSpuMixWorker()
+{
+	Stop();
+}
+
+void CSpuMixWorker::MixVoices(CSpuBase& spu, unsigned int sampleCount, unsigned int sampleRate, const CSpuBase::ADDRESS_RANGE& externalWriteRange)
+{
+	//Worker only reads these once the job is started, StartJob's lock makes them visible to it
+	assert(!IsBusy());
+	m_spu = &spu;
+	m_sampleCount = sampleCount;
+	m_sampleRate = sampleRate;
+	m_externalWriteRange = externalWriteRange;
+	StartJob();
+}
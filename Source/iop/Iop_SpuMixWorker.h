@@ -0,0 +1,24 @@
+#pragma once
+
+#include "../SingleJobWorker.h"
+#include "Iop_SpuBase.h"
+
+namespace Iop
+{
+	//Mixes the voices of an SPU core on its own thread while the emulation thread mixes another one.
+	//Only CSpuBase::MixVoices runs on the worker, FinishRender must be called after Wait.
+	class CSpuMixWorker : public CSingleJobWorker
+	{
+	public:
+		CSpuMixWorker();
+		virtual ~CSpuMixWorker();
+
+		void MixVoices(CSpuBase&, unsigned int, unsigned int, const CSpuBase::ADDRESS_RANGE&);
+
+	private:
+		CSpuBase* m_spu = nullptr;
+		unsigned int m_sampleCount = 0;
+		unsigned int m_sampleRate = 0;
+		CSpuBase::ADDRESS_RANGE m_externalWriteRange;
+	};
+}
@@ -17,10 +17,11 @@ using namespace PS2;
 #define STATE_SCRATCH ("iop_scratch")
 #define STATE_SPURAM ("iop_spuram")
 
-CSubSystem::CSubSystem(bool ps2Mode)
-    : m_cpu(MEMORYMAP_ENDIAN_LSBF, true)
-    , m_ram(new uint8[IOP_RAM_SIZE])
-    , m_scratchPad(new uint8[IOP_SCRATCH_SIZE])
+CSubSystem::CSubSystem(bool ps2Mode, bool fastMemoryEnabled)
+    : m_fastMemory(fastMemoryEnabled ? std::make_unique<CFastMemoryArena>() : nullptr)
+    , m_ram(m_fastMemory ? m_fastMemory->AllocateMemory(IOP_RAM_SIZE) : new uint8[IOP_RAM_SIZE])
+    , m_scratchPad(m_fastMemory ? m_fastMemory->AllocateMemory(IOP_SCRATCH_SIZE) : new uint8[IOP_SCRATCH_SIZE])
+    , m_cpu(MEMORYMAP_ENDIAN_LSBF, true)
     , m_spuRam(new uint8[SPU_RAM_SIZE])
     , m_dmac(m_ram, m_intc)
     , m_counters(ps2Mode ? IOP_CLOCK_OVER_FREQ : IOP_CLOCK_BASE_FREQ, m_intc)
@@ -52,7 +53,7 @@ CSubSystem::CSubSystem(bool ps2Mode)
 	m_cpu.m_pMemoryMap->InsertReadMap((2 * IOP_RAM_SIZE), (2 * IOP_RAM_SIZE) + IOP_RAM_SIZE - 1, m_ram, 0x03);
 	m_cpu.m_pMemoryMap->InsertReadMap((3 * IOP_RAM_SIZE), (3 * IOP_RAM_SIZE) + IOP_RAM_SIZE - 1, m_ram, 0x04);
 	m_cpu.m_pMemoryMap->InsertReadMap(IOP_SCRATCH_ADDR, IOP_SCRATCH_ADDR + IOP_SCRATCH_SIZE - 1, m_scratchPad, 0x05);
-	m_cpu.m_pMemoryMap->InsertReadMap(HW_REG_BEGIN, HW_REG_END, std::bind(&CSubSystem::ReadIoRegister, this, std::placeholders::_1), 0x06);
+	m_cpu.m_pMemoryMap->InsertReadMap(HW_REG_BEGIN, HW_REG_END, &CMemoryMap::ReadHandlerAdapter<CSubSystem, &CSubSystem::ReadIoRegister>, this, 0x06);
 
 	//Write memory map
 	m_cpu.m_pMemoryMap->InsertWriteMap((0 * IOP_RAM_SIZE), (0 * IOP_RAM_SIZE) + IOP_RAM_SIZE - 1, m_ram, 0x01);
@@ -60,7 +61,7 @@ CSubSystem::CSubSystem(bool ps2Mode)
 	m_cpu.m_pMemoryMap->InsertWriteMap((2 * IOP_RAM_SIZE), (2 * IOP_RAM_SIZE) + IOP_RAM_SIZE - 1, m_ram, 0x03);
 	m_cpu.m_pMemoryMap->InsertWriteMap((3 * IOP_RAM_SIZE), (3 * IOP_RAM_SIZE) + IOP_RAM_SIZE - 1, m_ram, 0x04);
 	m_cpu.m_pMemoryMap->InsertWriteMap(IOP_SCRATCH_ADDR, IOP_SCRATCH_ADDR + IOP_SCRATCH_SIZE - 1, m_scratchPad, 0x05);
-	m_cpu.m_pMemoryMap->InsertWriteMap(HW_REG_BEGIN, HW_REG_END, std::bind(&CSubSystem::WriteIoRegister, this, std::placeholders::_1, std::placeholders::_2), 0x06);
+	m_cpu.m_pMemoryMap->InsertWriteMap(HW_REG_BEGIN, HW_REG_END, &CMemoryMap::WriteHandlerAdapter<CSubSystem, &CSubSystem::WriteIoRegister>, this, 0x06);
 
 	//Instruction memory map
 	m_cpu.m_pMemoryMap->InsertInstructionMap((0 * IOP_RAM_SIZE), (0 * IOP_RAM_SIZE) + IOP_RAM_SIZE - 1, m_ram, 0x01);
@@ -75,14 +76,22 @@ CSubSystem::CSubSystem(bool ps2Mode)
 	m_dmac.SetReceiveFunction(4, std::bind(&CSpuBase::ReceiveDma, &m_spuCore0, PLACEHOLDER_1, PLACEHOLDER_2, PLACEHOLDER_3));
 	m_dmac.SetReceiveFunction(8, std::bind(&CSpuBase::ReceiveDma, &m_spuCore1, PLACEHOLDER_1, PLACEHOLDER_2, PLACEHOLDER_3));
 
+	if(m_fastMemory)
+	{
+		m_fastMemory->Attach(m_cpu);
+	}
+
 	SetupPageTable();
 }
 
 CSubSystem::~CSubSystem()
 {
 	m_bios.reset();
-	delete[] m_ram;
-	delete[] m_scratchPad;
+	if(!m_fastMemory)
+	{
+		delete[] m_ram;
+		delete[] m_scratchPad;
+	}
 	delete[] m_spuRam;
 }
 
@@ -3,6 +3,7 @@
 #include "../MIPS.h"
 #include "../MA_MIPSIV.h"
 #include "../COP_SCU.h"
+#include "../FastMemoryArena.h"
 #include "Iop_SpuBase.h"
 #include "Iop_Spu.h"
 #include "Iop_Spu2.h"
@@ -19,7 +20,7 @@ namespace Iop
 	class CSubSystem
 	{
 	public:
-		CSubSystem(bool ps2Mode);
+		CSubSystem(bool ps2Mode, bool fastMemoryEnabled = false);
 		virtual ~CSubSystem();
 
 		void Reset();
@@ -33,6 +34,9 @@ namespace Iop
 		void SaveState(Framework::CZipArchiveWriter&);
 		void LoadState(Framework::CZipArchiveReader&);
 
+		//Owns RAM and scratchpad when fast memory is enabled
+		std::unique_ptr<CFastMemoryArena> m_fastMemory;
+
 		uint8* m_ram;
 		uint8* m_scratchPad;
 		uint8* m_spuRam;
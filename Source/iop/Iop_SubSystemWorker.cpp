@@ -0,0 +1,8 @@
+#include "Iop_SubSystemWorker.h"
+
+using namespace Iop;
+
+CSubSystemWorker::CSubSystemWorker(const JobFunction& threadStartFunction, const JobFunction& sliceFunction)
+    : CSingleJobWorker("IOP", sliceFunction, threadStartFunction, {"step", "IOP access"})
+{
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "../SingleJobWorker.h"
+
+namespace Iop
+{
+	//Runs IOP time slices on their own thread while the emulation thread runs the EE.
+	//The emulation thread must call Wait before touching anything owned by the IOP.
+	class CSubSystemWorker : public CSingleJobWorker
+	{
+	public:
+		enum SYNC_POINT
+		{
+			SYNC_POINT_STEP,
+			SYNC_POINT_IOP_ACCESS,
+			SYNC_POINT_MAX,
+		};
+
+		CSubSystemWorker(const JobFunction&, const JobFunction&);
+	};
+}
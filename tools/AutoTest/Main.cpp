@@ -1,3 +1,8 @@
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
 #include "PS2VM.h"
 #include "filesystem_def.h"
 #include "StdStream.h"
@@ -5,12 +10,14 @@
 #include "iop/IopBios.h"
 #include "JUnitTestReportWriter.h"
 #include "gs/GSH_Null.h"
+#include "gs/GSH_Software.h"
 #ifdef _WIN32
 #include "gs/GSH_OpenGLWin32/GSH_OpenGLWin32.h"
 #include "gs/GSH_Direct3D9/GSH_Direct3D9.h"
 #endif
 
 #define GS_HANDLER_NAME_NULL "null"
+#define GS_HANDLER_NAME_SOFTWARE "software"
 #define GS_HANDLER_NAME_OGL "ogl"
 #define GS_HANDLER_NAME_D3D9 "d3d9"
 
@@ -19,6 +26,7 @@
 static std::set<std::string> g_validGsHandlersNames =
     {
         GS_HANDLER_NAME_NULL,
+        GS_HANDLER_NAME_SOFTWARE,
 #ifdef _WIN32
         GS_HANDLER_NAME_OGL,
         GS_HANDLER_NAME_D3D9,
@@ -39,12 +47,44 @@ public:
 
 #endif
 
+//Signaled from the threads of the virtual machine once the test is over
+class CCompletionEvent
+{
+public:
+	void Signal()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_signaled = true;
+		m_condition.notify_all();
+	}
+
+	void Wait()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_condition.wait(lock, [this]() { return m_signaled; });
+	}
+
+private:
+	std::mutex m_mutex;
+	std::condition_variable m_condition;
+	bool m_signaled = false;
+};
+
+typedef std::vector<fs::path> TestPathArray;
+
+//Virtual machines register their preferences in the shared config when they are set up
+static std::mutex g_virtualMachineSetupMutex;
+
 CGSHandler::FactoryFunction GetGsHandlerFactoryFunction(const std::string& gsHandlerName)
 {
 	if(gsHandlerName == GS_HANDLER_NAME_NULL)
 	{
 		return CGSH_Null::GetFactoryFunction();
 	}
+	else if(gsHandlerName == GS_HANDLER_NAME_SOFTWARE)
+	{
+		return CGSH_Software::GetFactoryFunction();
+	}
 #ifdef _WIN32
 	else if(gsHandlerName == GS_HANDLER_NAME_OGL)
 	{
@@ -116,16 +156,18 @@ void ExecuteEeTest(const fs::path& testFilePath, const std::string& gsHandlerNam
 	resultFilePath.replace_extension(".result");
 	auto resultStream = new Framework::CStdStream(resultFilePath.string().c_str(), "wb");
 
-	bool executionOver = false;
+	CCompletionEvent executionOver;
 
 	//Setup virtual machine
+	std::unique_lock<std::mutex> setupLock(g_virtualMachineSetupMutex);
 	CPS2VM virtualMachine;
 	virtualMachine.Initialize();
 	virtualMachine.Reset();
 	virtualMachine.CreateGSHandler(GetGsHandlerFactoryFunction(gsHandlerName));
+	setupLock.unlock();
 	auto connection = virtualMachine.m_ee->m_os->OnRequestExit.Connect(
 	    [&executionOver]() {
-		    executionOver = true;
+		    executionOver.Signal();
 	    });
 	virtualMachine.m_ee->m_os->BootFromFile(testFilePath);
 	{
@@ -134,10 +176,7 @@ void ExecuteEeTest(const fs::path& testFilePath, const std::string& gsHandlerNam
 	}
 	virtualMachine.Resume();
 
-	while(!executionOver)
-	{
-		std::this_thread::sleep_for(std::chrono::milliseconds(100));
-	}
+	executionOver.Wait();
 
 	virtualMachine.Pause();
 	virtualMachine.DestroyGSHandler();
@@ -159,12 +198,14 @@ void ExecuteIopTest(const fs::path& testFilePath)
 	resultFilePath.replace_extension(".result");
 	auto resultStream = new Framework::CStdStream(resultFilePath.string().c_str(), "wb");
 
-	bool executionOver = false;
+	CCompletionEvent executionOver;
 	CIopBios::ModuleStartedEvent::Connection connection;
 	//Setup virtual machine
+	std::unique_lock<std::mutex> setupLock(g_virtualMachineSetupMutex);
 	CPS2VM virtualMachine;
 	virtualMachine.Initialize();
 	virtualMachine.Reset();
+	setupLock.unlock();
 	{
 		auto iopOs = dynamic_cast<CIopBios*>(virtualMachine.m_iop->m_bios.get());
 		int32 rootModuleId = iopOs->LoadModuleFromHost(moduleData.data());
@@ -172,7 +213,7 @@ void ExecuteIopTest(const fs::path& testFilePath)
 		    [&executionOver, rootModuleId](uint32 moduleId) {
 			    if(rootModuleId == moduleId)
 			    {
-				    executionOver = true;
+				    executionOver.Signal();
 			    }
 		    });
 		iopOs->StartModule(rootModuleId, "", nullptr, 0);
@@ -180,16 +221,13 @@ void ExecuteIopTest(const fs::path& testFilePath)
 	}
 	virtualMachine.Resume();
 
-	while(!executionOver)
-	{
-		std::this_thread::sleep_for(std::chrono::milliseconds(100));
-	}
+	executionOver.Wait();
 
 	virtualMachine.Pause();
 	virtualMachine.Destroy();
 }
 
-void ScanAndExecuteTests(const fs::path& testDirPath, const TestReportWriterPtr& testReportWriter, const std::string& gsHandlerName)
+void ScanTests(const fs::path& testDirPath, TestPathArray& testPaths)
 {
 	fs::directory_iterator endIterator;
 	for(auto testPathIterator = fs::directory_iterator(testDirPath);
@@ -198,30 +236,92 @@ void ScanAndExecuteTests(const fs::path& testDirPath, const TestReportWriterPtr&
 		auto testPath = testPathIterator->path();
 		if(fs::is_directory(testPath))
 		{
-			ScanAndExecuteTests(testPath, testReportWriter, gsHandlerName);
+			ScanTests(testPath, testPaths);
 			continue;
 		}
-		if(testPath.extension() == ".elf")
+		if((testPath.extension() == ".elf") || (testPath.extension() == ".irx"))
 		{
-			printf("Testing '%s': ", testPath.string().c_str());
-			ExecuteEeTest(testPath, gsHandlerName);
-			auto result = GetTestResult(testPath);
-			printf("%s.\r\n", result.succeeded ? "SUCCEEDED" : "FAILED");
-			if(testReportWriter)
-			{
-				testReportWriter->ReportTestEntry(testPath.string(), result);
-			}
+			testPaths.push_back(testPath);
+		}
+	}
+}
+
+TESTRESULT ExecuteTest(const fs::path& testPath, const std::string& gsHandlerName)
+{
+	if(testPath.extension() == ".elf")
+	{
+		ExecuteEeTest(testPath, gsHandlerName);
+	}
+	else
+	{
+		ExecuteIopTest(testPath);
+	}
+	return GetTestResult(testPath);
+}
+
+//Each job runs its own virtual machine, tests are picked in order as jobs become free
+void ExecuteTests(const TestPathArray& testPaths, const TestReportWriterPtr& testReportWriter, const std::string& gsHandlerName, unsigned int jobCount)
+{
+	std::vector<TESTRESULT> results(testPaths.size());
+	std::atomic<size_t> nextTestIndex(0);
+	std::mutex outputMutex;
+	std::exception_ptr jobException;
+
+	auto job =
+	    [&]() {
+		    while(1)
+		    {
+			    size_t testIndex = nextTestIndex++;
+			    if(testIndex >= testPaths.size()) break;
+			    const auto& testPath = testPaths[testIndex];
+			    try
+			    {
+				    results[testIndex] = ExecuteTest(testPath, gsHandlerName);
+			    }
+			    catch(...)
+			    {
+				    std::lock_guard<std::mutex> outputLock(outputMutex);
+				    if(!jobException)
+				    {
+					    jobException = std::current_exception();
+				    }
+				    nextTestIndex = testPaths.size();
+				    break;
+			    }
+			    std::lock_guard<std::mutex> outputLock(outputMutex);
+			    printf("Testing '%s': %s.\r\n", testPath.string().c_str(), results[testIndex].succeeded ? "SUCCEEDED" : "FAILED");
+		    }
+	    };
+
+	jobCount = std::max<unsigned int>(std::min<size_t>(jobCount, testPaths.size()), 1);
+	if(jobCount == 1)
+	{
+		job();
+	}
+	else
+	{
+		std::vector<std::thread> jobThreads;
+		for(unsigned int i = 0; i < jobCount; i++)
+		{
+			jobThreads.emplace_back(job);
 		}
-		else if(testPath.extension() == ".irx")
+		for(auto& jobThread : jobThreads)
 		{
-			printf("Testing '%s': ", testPath.string().c_str());
-			ExecuteIopTest(testPath);
-			auto result = GetTestResult(testPath);
-			printf("%s.\r\n", result.succeeded ? "SUCCEEDED" : "FAILED");
-			if(testReportWriter)
-			{
-				testReportWriter->ReportTestEntry(testPath.string(), result);
-			}
+			jobThread.join();
+		}
+	}
+
+	if(jobException)
+	{
+		std::rethrow_exception(jobException);
+	}
+
+	//Report entries are written in scan order, whatever order the jobs completed in
+	if(testReportWriter)
+	{
+		for(size_t i = 0; i < testPaths.size(); i++)
+		{
+			testReportWriter->ReportTestEntry(testPaths[i].string(), results[i]);
 		}
 	}
 }
@@ -250,6 +350,7 @@ int main(int argc, const char** argv)
 		printf("\t --junitreport <path>\t Writes JUnit format report at <path>.\r\n");
 		printf("\t --gshandler <%s>\tSelects which GS handler to instantiate (default is '%s').\r\n",
 		       validGsHandlerNamesString.c_str(), DEFAULT_GS_HANDLER_NAME);
+		printf("\t --jobs <count>\t Runs up to <count> tests at once, each in its own virtual machine (default is 1).\r\n");
 		return -1;
 	}
 
@@ -257,6 +358,7 @@ int main(int argc, const char** argv)
 	fs::path autoTestRoot;
 	fs::path reportPath;
 	std::string gsHandlerName = DEFAULT_GS_HANDLER_NAME;
+	unsigned int jobCount = 1;
 	assert(g_validGsHandlersNames.find(gsHandlerName) != std::end(g_validGsHandlersNames));
 
 	for(int i = 1; i < argc; i++)
@@ -287,6 +389,22 @@ int main(int argc, const char** argv)
 			}
 			i++;
 		}
+		else if(!strcmp(argv[i], "--jobs"))
+		{
+			if((i + 1) >= argc)
+			{
+				printf("Error: Job count must be specified for --jobs option.\r\n");
+				return -1;
+			}
+			int jobCountArg = atoi(argv[i + 1]);
+			if(jobCountArg <= 0)
+			{
+				printf("Error: Invalid job count '%s'.\r\n", argv[i + 1]);
+				return -1;
+			}
+			jobCount = jobCountArg;
+			i++;
+		}
 		else
 		{
 			autoTestRoot = argv[i];
@@ -300,9 +418,20 @@ int main(int argc, const char** argv)
 		return -1;
 	}
 
+#ifdef _WIN32
+	//These handlers all draw in the same test window
+	if((jobCount != 1) && ((gsHandlerName == GS_HANDLER_NAME_OGL) || (gsHandlerName == GS_HANDLER_NAME_D3D9)))
+	{
+		printf("Error: GS handler '%s' can't be used with more than one job.\r\n", gsHandlerName.c_str());
+		return -1;
+	}
+#endif
+
 	try
 	{
-		ScanAndExecuteTests(autoTestRoot, testReportWriter, gsHandlerName);
+		TestPathArray testPaths;
+		ScanTests(autoTestRoot, testPaths);
+		ExecuteTests(testPaths, testReportWriter, gsHandlerName, jobCount);
 	}
 	catch(const std::exception& exception)
 	{
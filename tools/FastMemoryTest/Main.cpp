@@ -0,0 +1,174 @@
+#include <cstdio>
+#include <stdexcept>
+#include "FastMemoryArena.h"
+#include "MIPS.h"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <signal.h>
+#endif
+
+#define TEST_VERIFY(a)                                             \
+	if(!(a))                                                       \
+	{                                                              \
+		printf("Verification failed: '%s'. Failed.\r\n", #a);     \
+		throw std::exception();                                    \
+	}
+
+static const uint32 RAM_SIZE = 0x02000000;
+static const uint32 IO_BASE = 0x10000000;
+static const uint32 IO_END = 0x1000FFFF;
+
+static volatile uint32 g_ioLastWriteAddress = 0;
+static volatile uint32 g_ioLastWriteValue = 0;
+
+static uint32 IoRead(void*, uint32 address, uint32)
+{
+	return address ^ 0xA5A5A5A5;
+}
+
+static uint32 IoWrite(void*, uint32 address, uint32 value)
+{
+	g_ioLastWriteAddress = address;
+	g_ioLastWriteValue = value;
+	return 0;
+}
+
+#ifdef _WIN32
+
+static LONG CALLBACK HandleException(_EXCEPTION_POINTERS* exceptionInfo)
+{
+	auto exceptionRecord = exceptionInfo->ExceptionRecord;
+	if(exceptionRecord->ExceptionCode != EXCEPTION_ACCESS_VIOLATION)
+	{
+		return EXCEPTION_CONTINUE_SEARCH;
+	}
+	auto address = static_cast<uintptr_t>(exceptionRecord->ExceptionInformation[1]);
+	if(CFastMemoryArena::HandleAccessFault(address, exceptionInfo->ContextRecord))
+	{
+		return EXCEPTION_CONTINUE_EXECUTION;
+	}
+	return EXCEPTION_CONTINUE_SEARCH;
+}
+
+static void InstallFaultHandler()
+{
+	AddVectoredExceptionHandler(TRUE, &HandleException);
+}
+
+#else
+
+static void HandleException(int sigId, siginfo_t* sigInfo, void* context)
+{
+	if(CFastMemoryArena::HandleAccessFault(reinterpret_cast<uintptr_t>(sigInfo->si_addr), context))
+	{
+		return;
+	}
+	signal(sigId, SIG_DFL);
+}
+
+static void InstallFaultHandler()
+{
+	struct sigaction sigAction = {};
+	sigAction.sa_sigaction = &HandleException;
+	sigAction.sa_flags = SA_SIGINFO;
+	sigemptyset(&sigAction.sa_mask);
+	sigaction(SIGSEGV, &sigAction, nullptr);
+	sigaction(SIGBUS, &sigAction, nullptr);
+}
+
+#endif
+
+//Stores through kseg1 aren't mapped in the arena and must reach RAM through the memory map
+static void Kseg1RamAliasTest(CMIPS& context, uint8* ram)
+{
+	auto base = context.m_fastMemoryBase;
+
+	*reinterpret_cast<volatile uint32*>(base + 0xA0001000) = 0x13572468;
+	TEST_VERIFY(*reinterpret_cast<volatile uint32*>(ram + 0x1000) == 0x13572468);
+	TEST_VERIFY(*reinterpret_cast<volatile uint32*>(base + 0x00001000) == 0x13572468);
+	TEST_VERIFY(*reinterpret_cast<volatile uint32*>(base + 0x80001000) == 0x13572468);
+	TEST_VERIFY(*reinterpret_cast<volatile uint32*>(base + 0xA0001000) == 0x13572468);
+
+	*reinterpret_cast<volatile uint16*>(base + 0xA0001006) = 0xBEEF;
+	TEST_VERIFY(*reinterpret_cast<volatile uint16*>(ram + 0x1006) == 0xBEEF);
+	TEST_VERIFY(*reinterpret_cast<volatile uint16*>(base + 0xA0001006) == 0xBEEF);
+
+	*reinterpret_cast<volatile uint8*>(base + 0xA0001008) = 0x5A;
+	TEST_VERIFY(*reinterpret_cast<volatile uint8*>(ram + 0x1008) == 0x5A);
+	TEST_VERIFY(*reinterpret_cast<volatile uint8*>(base + 0xA0001008) == 0x5A);
+}
+
+//I/O registers accessed through kseg1 must be dispatched with their physical address
+static void Kseg1IoAliasTest(CMIPS& context)
+{
+	auto base = context.m_fastMemoryBase;
+
+	*reinterpret_cast<volatile uint32*>(base + 0xB0000100) = 0xCAFEF00D;
+	TEST_VERIFY(g_ioLastWriteAddress == 0x10000100);
+	TEST_VERIFY(g_ioLastWriteValue == 0xCAFEF00D);
+
+	uint32 value = *reinterpret_cast<volatile uint32*>(base + 0xB0000200);
+	TEST_VERIFY(value == (0x10000200 ^ 0xA5A5A5A5));
+}
+
+//Sign extended loads (movsx, movsxd) must extend the value returned by the memory map
+static void SignExtendedLoadTest(CMIPS& context)
+{
+#if defined(__x86_64__) && defined(__GNUC__)
+	auto base = context.m_fastMemoryBase;
+
+	int64 wordValue = 0;
+	asm volatile("movslq (%1), %0"
+	             : "=r"(wordValue)
+	             : "r"(base + 0xB0000300)
+	             : "memory");
+	TEST_VERIFY(wordValue == static_cast<int32>(0x10000300 ^ 0xA5A5A5A5));
+
+	int64 halfValue = 0;
+	asm volatile("movswq (%1), %0"
+	             : "=r"(halfValue)
+	             : "r"(base + 0xB0000400)
+	             : "memory");
+	TEST_VERIFY(halfValue == static_cast<int16>(0x10000400 ^ 0xA5A5A5A5));
+#endif
+}
+
+int main(int argc, const char** argv)
+{
+	if(!CFastMemoryArena::IsSupported())
+	{
+		printf("Fast memory isn't supported on this platform, skipping.\r\n");
+		return 0;
+	}
+
+	try
+	{
+		CFastMemoryArena arena;
+		CMIPS context(MEMORYMAP_ENDIAN_LSBF, true);
+		context.m_pAddrTranslator = CMIPS::TranslateAddress64;
+
+		auto ram = arena.AllocateMemory(RAM_SIZE);
+		context.m_pMemoryMap->InsertReadMap(0x00000000, RAM_SIZE - 1, ram, 0x00);
+		context.m_pMemoryMap->InsertReadMap(IO_BASE, IO_END, &IoRead, nullptr, 0x01);
+		context.m_pMemoryMap->InsertWriteMap(0x00000000, RAM_SIZE - 1, ram, 0x00);
+		context.m_pMemoryMap->InsertWriteMap(IO_BASE, IO_END, &IoWrite, nullptr, 0x01);
+
+		arena.Attach(context);
+		context.MapPages(0x00000000, RAM_SIZE, ram);
+		context.MapPages(0x80000000, RAM_SIZE, ram);
+
+		InstallFaultHandler();
+
+		Kseg1RamAliasTest(context, ram);
+		Kseg1IoAliasTest(context);
+		SignExtendedLoadTest(context);
+	}
+	catch(...)
+	{
+		return -1;
+	}
+
+	printf("All tests passed.\r\n");
+	return 0;
+}
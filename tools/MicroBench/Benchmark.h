@@ -0,0 +1,27 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+
+class CBenchmark
+{
+public:
+	virtual ~CBenchmark() = default;
+
+	//Returns false if the optimized and reference paths don't produce the same results
+	virtual bool Run() = 0;
+
+protected:
+	//Returns the average time in nanoseconds taken by one call to the function
+	static double Measure(unsigned int iterations, const std::function<void()>& function)
+	{
+		auto startTime = std::chrono::high_resolution_clock::now();
+		for(unsigned int i = 0; i < iterations; i++)
+		{
+			function();
+		}
+		auto endTime = std::chrono::high_resolution_clock::now();
+		auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime);
+		return static_cast<double>(duration.count()) / static_cast<double>(iterations);
+	}
+};
@@ -0,0 +1,176 @@
+#include <cstdio>
+#include <random>
+#include <string>
+#include "GsSwizzleBenchmark.h"
+#include "gs/GSHandler.h"
+#include "gs/GsBlockSwizzle.h"
+#include "gs/GsPixelFormats.h"
+
+#define ITERATIONS 50
+#define IMAGE_WIDTH 256
+#define IMAGE_HEIGHT 256
+#define BUFFER_POINTER 0x100000
+#define BUFFER_WIDTH (IMAGE_WIDTH / 64)
+
+CGsSwizzleBenchmark::CGsSwizzleBenchmark()
+    : m_pixelsRam(CGSHandler::RAMSIZE)
+    , m_blocksRam(CGSHandler::RAMSIZE)
+{
+	std::mt19937 random(IMAGE_WIDTH);
+	for(auto& image : m_images)
+	{
+		image.resize(IMAGE_WIDTH * IMAGE_HEIGHT * 4);
+		for(auto& value : image)
+		{
+			value = static_cast<uint8>(random());
+		}
+	}
+}
+
+bool CGsSwizzleBenchmark::Run()
+{
+	printf("GS transfer swizzle (%dx%d image)\n", IMAGE_WIDTH, IMAGE_HEIGHT);
+
+	bool result = true;
+	result &= RunFormat<CGsPixelFormats::STORAGEPSMCT32>("PSMCT32", 32);
+	result &= RunFormat<CGsPixelFormats::STORAGEPSMCT16>("PSMCT16", 16);
+	result &= RunFormat<CGsPixelFormats::STORAGEPSMCT16S>("PSMCT16S", 16);
+	result &= RunFormat<CGsPixelFormats::STORAGEPSMT8>("PSMT8", 8);
+	result &= RunFormat<CGsPixelFormats::STORAGEPSMT4>("PSMT4", 4);
+	return result;
+}
+
+template <typename Storage>
+bool CGsSwizzleBenchmark::RunFormat(const char* name, uint32 pixelBits)
+{
+	uint32 pitch = (IMAGE_WIDTH * pixelBits) / 8;
+	bool matches = true;
+	for(const auto& image : m_images)
+	{
+		WritePixels<Storage>(m_pixelsRam, image.data(), pitch);
+		WriteBlocks<Storage>(m_blocksRam, image.data(), pitch);
+		matches &= (m_pixelsRam == m_blocksRam);
+	}
+
+	//Alternate between both images so that every write changes GS RAM
+	uint32 pixelsImage = 0;
+	uint32 blocksImage = 0;
+	double pixelsTime = Measure(ITERATIONS, [&]() { WritePixels<Storage>(m_pixelsRam, m_images[(pixelsImage++) & 1].data(), pitch); });
+	double blocksTime = Measure(ITERATIONS, [&]() { WriteBlocks<Storage>(m_blocksRam, m_images[(blocksImage++) & 1].data(), pitch); });
+
+	printf("  %-24s pixels: %7.2f us/image, blocks: %7.2f us/image, speedup: %5.2fx%s\n",
+	       name, pixelsTime / 1000, blocksTime / 1000, pixelsTime / blocksTime,
+	       matches ? "" : " (MISMATCH)");
+
+	//Local to host, read back what was written last
+	std::vector<uint8> pixelsImageRead(pitch * IMAGE_HEIGHT);
+	std::vector<uint8> blocksImageRead(pitch * IMAGE_HEIGHT);
+	ReadPixels<Storage>(m_blocksRam, pixelsImageRead.data(), pitch);
+	ReadBlocks<Storage>(m_blocksRam, blocksImageRead.data(), pitch);
+	bool readMatches = (pixelsImageRead == blocksImageRead);
+
+	double readPixelsTime = Measure(ITERATIONS, [&]() { ReadPixels<Storage>(m_blocksRam, pixelsImageRead.data(), pitch); });
+	double readBlocksTime = Measure(ITERATIONS, [&]() { ReadBlocks<Storage>(m_blocksRam, blocksImageRead.data(), pitch); });
+
+	printf("  %-24s pixels: %7.2f us/image, blocks: %7.2f us/image, speedup: %5.2fx%s\n",
+	       (std::string(name) + " (read)").c_str(), readPixelsTime / 1000, readBlocksTime / 1000, readPixelsTime / readBlocksTime,
+	       readMatches ? "" : " (MISMATCH)");
+
+	return matches && readMatches;
+}
+
+template <typename Storage>
+void CGsSwizzleBenchmark::WritePixels(std::vector<uint8>& ram, const uint8* image, uint32 pitch)
+{
+	CGsPixelFormats::CPixelIndexor<Storage> indexor(ram.data(), BUFFER_POINTER, BUFFER_WIDTH);
+	for(uint32 y = 0; y < IMAGE_HEIGHT; y++)
+	{
+		auto row = reinterpret_cast<const typename Storage::Unit*>(image + (y * pitch));
+		for(uint32 x = 0; x < IMAGE_WIDTH; x++)
+		{
+			auto pixel = indexor.GetPixelAddress(x, y);
+			if((*pixel) != row[x])
+			{
+				(*pixel) = row[x];
+			}
+		}
+	}
+}
+
+template <>
+void CGsSwizzleBenchmark::WritePixels<CGsPixelFormats::STORAGEPSMT4>(std::vector<uint8>& ram, const uint8* image, uint32 pitch)
+{
+	CGsPixelFormats::CPixelIndexorPSMT4 indexor(ram.data(), BUFFER_POINTER, BUFFER_WIDTH);
+	for(uint32 y = 0; y < IMAGE_HEIGHT; y++)
+	{
+		auto row = image + (y * pitch);
+		for(uint32 x = 0; x < IMAGE_WIDTH; x++)
+		{
+			uint8 pixel = (row[x / 2] >> ((x & 1) * 4)) & 0x0F;
+			if(indexor.GetPixel(x, y) != pixel)
+			{
+				indexor.SetPixel(x, y, pixel);
+			}
+		}
+	}
+}
+
+template <typename Storage>
+void CGsSwizzleBenchmark::WriteBlocks(std::vector<uint8>& ram, const uint8* image, uint32 pitch)
+{
+	uint32 pixelBits = (pitch * 8) / IMAGE_WIDTH;
+	for(uint32 y = 0; y < IMAGE_HEIGHT; y += Storage::BLOCKHEIGHT)
+	{
+		for(uint32 x = 0; x < IMAGE_WIDTH; x += Storage::BLOCKWIDTH)
+		{
+			uint32 pageNum = (x / Storage::PAGEWIDTH) + (y / Storage::PAGEHEIGHT) * (BUFFER_WIDTH * 64) / Storage::PAGEWIDTH;
+			uint32 blockNum = Storage::m_nBlockSwizzleTable[(y % Storage::PAGEHEIGHT) / Storage::BLOCKHEIGHT][(x % Storage::PAGEWIDTH) / Storage::BLOCKWIDTH];
+			uint32 blockAddress = (BUFFER_POINTER + (pageNum * CGsPixelFormats::PAGESIZE) + (blockNum * CGsPixelFormats::BLOCKSIZE)) & (CGSHandler::RAMSIZE - 1);
+			CGsBlockSwizzle::WriteBlock<Storage>(ram.data() + blockAddress, image + (y * pitch) + ((x * pixelBits) / 8), pitch);
+		}
+	}
+}
+
+template <typename Storage>
+void CGsSwizzleBenchmark::ReadPixels(std::vector<uint8>& ram, uint8* image, uint32 pitch)
+{
+	CGsPixelFormats::CPixelIndexor<Storage> indexor(ram.data(), BUFFER_POINTER, BUFFER_WIDTH);
+	for(uint32 y = 0; y < IMAGE_HEIGHT; y++)
+	{
+		auto row = reinterpret_cast<typename Storage::Unit*>(image + (y * pitch));
+		for(uint32 x = 0; x < IMAGE_WIDTH; x++)
+		{
+			row[x] = indexor.GetPixel(x, y);
+		}
+	}
+}
+
+template <>
+void CGsSwizzleBenchmark::ReadPixels<CGsPixelFormats::STORAGEPSMT4>(std::vector<uint8>& ram, uint8* image, uint32 pitch)
+{
+	CGsPixelFormats::CPixelIndexorPSMT4 indexor(ram.data(), BUFFER_POINTER, BUFFER_WIDTH);
+	for(uint32 y = 0; y < IMAGE_HEIGHT; y++)
+	{
+		auto row = image + (y * pitch);
+		for(uint32 x = 0; x < IMAGE_WIDTH; x += 2)
+		{
+			row[x / 2] = indexor.GetPixel(x, y) | (indexor.GetPixel(x + 1, y) << 4);
+		}
+	}
+}
+
+template <typename Storage>
+void CGsSwizzleBenchmark::ReadBlocks(std::vector<uint8>& ram, uint8* image, uint32 pitch)
+{
+	uint32 pixelBits = (pitch * 8) / IMAGE_WIDTH;
+	for(uint32 y = 0; y < IMAGE_HEIGHT; y += Storage::BLOCKHEIGHT)
+	{
+		for(uint32 x = 0; x < IMAGE_WIDTH; x += Storage::BLOCKWIDTH)
+		{
+			uint32 pageNum = (x / Storage::PAGEWIDTH) + (y / Storage::PAGEHEIGHT) * (BUFFER_WIDTH * 64) / Storage::PAGEWIDTH;
+			uint32 blockNum = Storage::m_nBlockSwizzleTable[(y % Storage::PAGEHEIGHT) / Storage::BLOCKHEIGHT][(x % Storage::PAGEWIDTH) / Storage::BLOCKWIDTH];
+			uint32 blockAddress = (BUFFER_POINTER + (pageNum * CGsPixelFormats::PAGESIZE) + (blockNum * CGsPixelFormats::BLOCKSIZE)) & (CGSHandler::RAMSIZE - 1);
+			CGsBlockSwizzle::ReadBlock<Storage>(image + (y * pitch) + ((x * pixelBits) / 8), ram.data() + blockAddress, pitch);
+		}
+	}
+}
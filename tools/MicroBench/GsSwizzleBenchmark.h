@@ -0,0 +1,32 @@
+#pragma once
+
+#include <vector>
+#include "Benchmark.h"
+#include "Types.h"
+
+//Compares block swizzling of GS transfers with per pixel accesses through CPixelIndexor
+class CGsSwizzleBenchmark : public CBenchmark
+{
+public:
+	CGsSwizzleBenchmark();
+	virtual ~CGsSwizzleBenchmark() = default;
+
+	bool Run() override;
+
+private:
+	template <typename Storage>
+	bool RunFormat(const char*, uint32);
+
+	template <typename Storage>
+	void WritePixels(std::vector<uint8>&, const uint8*, uint32);
+	template <typename Storage>
+	void WriteBlocks(std::vector<uint8>&, const uint8*, uint32);
+	template <typename Storage>
+	void ReadPixels(std::vector<uint8>&, uint8*, uint32);
+	template <typename Storage>
+	void ReadBlocks(std::vector<uint8>&, uint8*, uint32);
+
+	std::vector<uint8> m_pixelsRam;
+	std::vector<uint8> m_blocksRam;
+	std::vector<uint8> m_images[2];
+};
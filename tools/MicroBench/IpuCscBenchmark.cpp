@@ -0,0 +1,134 @@
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include "IpuCscBenchmark.h"
+#include "Ps2Const.h"
+
+#define ITERATIONS 20
+#define MACROBLOCK_COUNT 256
+#define MACROBLOCK_SIZE 0x180
+#define MAX_MBC 0x400
+
+// clang-format off
+const CIpuCscBenchmark::SCENARIO CIpuCscBenchmark::g_scenarios[] =
+{
+	{ "RGBA32",                false, false, 0x000, 0x000 },
+	{ "RGBA32 (thresholds)",   false, false, 0x040, 0x0C0 },
+	{ "RGB16",                 true,  false, 0x040, 0x0C0 },
+	{ "RGB16 (dithered)",      true,  true,  0x040, 0x0C0 },
+};
+// clang-format on
+
+CIpuCscBenchmark::CIpuCscBenchmark()
+    : m_ram(new uint8[PS2::EE_RAM_SIZE])
+    , m_spr(new uint8[PS2::EE_SPR_SIZE])
+    , m_vuMem(new uint8[PS2::VUMEM0SIZE])
+    , m_ee(MEMORYMAP_ENDIAN_LSBF)
+    , m_dmac(m_ram, m_spr, m_vuMem, m_ee)
+    , m_intc(m_dmac)
+    , m_ipu(m_intc)
+{
+	memset(m_ram, 0, PS2::EE_RAM_SIZE);
+	memset(m_spr, 0, PS2::EE_SPR_SIZE);
+	m_ipu.SetDMA3ReceiveHandler(
+	    [this](const void* data, uint32 qwc) {
+		    auto bytes = reinterpret_cast<const uint8*>(data);
+		    m_output.insert(m_output.end(), bytes, bytes + (qwc * 0x10));
+		    return qwc;
+	    });
+}
+
+CIpuCscBenchmark::~CIpuCscBenchmark()
+{
+	delete[] m_ram;
+	delete[] m_spr;
+	delete[] m_vuMem;
+}
+
+bool CIpuCscBenchmark::Run()
+{
+	printf("IPU CSC (%d macroblocks per run)\n", MACROBLOCK_COUNT);
+
+	bool result = true;
+	for(const auto& scenario : g_scenarios)
+	{
+		//Every combination of Y, Cb and Cr goes through both converters once
+		BuildAllColorsMacroblocks();
+		bool matches = (RunCsc(scenario, 0x10000, false) == RunCsc(scenario, 0x10000, true));
+
+		BuildRandomMacroblocks(MACROBLOCK_COUNT);
+		matches &= (RunCsc(scenario, MACROBLOCK_COUNT, false) == RunCsc(scenario, MACROBLOCK_COUNT, true));
+		result &= matches;
+
+		double referenceTime = Measure(ITERATIONS, [&]() { RunCsc(scenario, MACROBLOCK_COUNT, false); });
+		double fastTime = Measure(ITERATIONS, [&]() { RunCsc(scenario, MACROBLOCK_COUNT, true); });
+
+		printf("  %-24s reference: %7.2f ns/mb, fast: %7.2f ns/mb, speedup: %5.2fx%s\n",
+		       scenario.name, referenceTime / MACROBLOCK_COUNT, fastTime / MACROBLOCK_COUNT, referenceTime / fastTime,
+		       matches ? "" : " (MISMATCH)");
+	}
+
+	return result;
+}
+
+//Writes macroblocks (256 Y values followed by 64 Cb and 64 Cr values) at the start of RAM
+void CIpuCscBenchmark::BuildRandomMacroblocks(uint32 count)
+{
+	assert((count * MACROBLOCK_SIZE) <= PS2::EE_RAM_SIZE);
+	std::mt19937 random(count);
+	for(uint32 i = 0; i < (count * MACROBLOCK_SIZE); i++)
+	{
+		m_ram[i] = static_cast<uint8>(random());
+	}
+}
+
+//One macroblock for each chroma pair, with every value of Y
+void CIpuCscBenchmark::BuildAllColorsMacroblocks()
+{
+	assert((0x10000 * MACROBLOCK_SIZE) <= PS2::EE_RAM_SIZE);
+	for(uint32 i = 0; i < 0x10000; i++)
+	{
+		uint8* macroblock = m_ram + (i * MACROBLOCK_SIZE);
+		for(uint32 y = 0; y < 0x100; y++)
+		{
+			macroblock[y] = static_cast<uint8>(y);
+		}
+		memset(macroblock + 0x100, i & 0xFF, 0x40);
+		memset(macroblock + 0x140, i >> 8, 0x40);
+	}
+}
+
+std::vector<uint8> CIpuCscBenchmark::RunCsc(const SCENARIO& scenario, uint32 macroblockCount, bool fastCscEnabled)
+{
+	m_ipu.Reset();
+	m_ipu.SetFastCscEnabled(fastCscEnabled);
+	m_output.clear();
+
+	//SETTH
+	m_ipu.SetRegister(CIPU::IPU_CMD, (0x09 << 28) | (scenario.th1 << 16) | scenario.th0);
+	while(m_ipu.WillExecuteCommand())
+	{
+		m_ipu.ExecuteCommand();
+	}
+
+	uint32 address = 0;
+	for(uint32 remain = macroblockCount; remain != 0;)
+	{
+		uint32 mbc = std::min<uint32>(remain, MAX_MBC);
+		m_ipu.SetRegister(CIPU::IPU_CMD, (0x07 << 28) | (scenario.ofm ? (1 << 27) : 0) | (scenario.dte ? (1 << 26) : 0) | mbc);
+		uint32 endAddress = address + (mbc * MACROBLOCK_SIZE);
+		while(m_ipu.WillExecuteCommand())
+		{
+			if(address != endAddress)
+			{
+				address += m_ipu.ReceiveDMA4(address, (endAddress - address) / 0x10, false, m_ram, m_spr) * 0x10;
+			}
+			m_ipu.ExecuteCommand();
+		}
+		remain -= mbc;
+	}
+
+	return m_output;
+}
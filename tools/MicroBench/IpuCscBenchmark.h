@@ -0,0 +1,43 @@
+#pragma once
+
+#include <vector>
+#include "Benchmark.h"
+#include "MIPS.h"
+#include "ee/DMAC.h"
+#include "ee/INTC.h"
+#include "ee/IPU.h"
+
+//Compares the fixed-point IPU CSC kernels with the floating point converter
+class CIpuCscBenchmark : public CBenchmark
+{
+public:
+	CIpuCscBenchmark();
+	virtual ~CIpuCscBenchmark();
+
+	bool Run() override;
+
+private:
+	struct SCENARIO
+	{
+		const char* name;
+		bool ofm;
+		bool dte;
+		uint16 th0;
+		uint16 th1;
+	};
+
+	void BuildRandomMacroblocks(uint32);
+	void BuildAllColorsMacroblocks();
+	std::vector<uint8> RunCsc(const SCENARIO&, uint32, bool);
+
+	static const SCENARIO g_scenarios[];
+
+	uint8* m_ram = nullptr;
+	uint8* m_spr = nullptr;
+	uint8* m_vuMem = nullptr;
+	CMIPS m_ee;
+	CDMAC m_dmac;
+	CINTC m_intc;
+	CIPU m_ipu;
+	std::vector<uint8> m_output;
+};
@@ -0,0 +1,231 @@
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include "IpuDecodeBenchmark.h"
+#include "Ps2Const.h"
+
+#define ITERATIONS 5
+#define MACROBLOCK_COUNT 2048
+#define RAW16_MACROBLOCK_SIZE 0x300
+
+static const unsigned int g_threadCounts[] = {1, 2, 4};
+
+// clang-format off
+//MPEG-2 dct_dc_size_luminance and dct_dc_size_chrominance codes (sizes 0 to 6)
+static const char* g_dcSizeLuminanceCodes[] = { "100", "00", "01", "101", "110", "1110", "11110" };
+static const char* g_dcSizeChrominanceCodes[] = { "00", "01", "10", "110", "1110", "11110", "111110" };
+// clang-format on
+
+void CIpuDecodeBenchmark::CBitWriter::WriteBits(uint32 value, unsigned int size)
+{
+	for(unsigned int i = 0; i < size; i++)
+	{
+		if((m_bitPosition % 8) == 0)
+		{
+			m_bytes.push_back(0);
+		}
+		uint32 bit = (value >> (size - i - 1)) & 1;
+		m_bytes.back() |= static_cast<uint8>(bit << (7 - (m_bitPosition % 8)));
+		m_bitPosition++;
+	}
+}
+
+void CIpuDecodeBenchmark::CBitWriter::WriteCode(const char* code)
+{
+	for(; *code; code++)
+	{
+		WriteBits((*code == '1') ? 1 : 0, 1);
+	}
+}
+
+//Set bits are used for padding to make sure nothing looks like a start code
+void CIpuDecodeBenchmark::CBitWriter::PadToQuadword()
+{
+	while((m_bitPosition % 128) != 0)
+	{
+		WriteBits(1, 1);
+	}
+}
+
+const std::vector<uint8>& CIpuDecodeBenchmark::CBitWriter::GetBytes() const
+{
+	return m_bytes;
+}
+
+CIpuDecodeBenchmark::CIpuDecodeBenchmark()
+    : m_ram(new uint8[PS2::EE_RAM_SIZE])
+    , m_spr(new uint8[PS2::EE_SPR_SIZE])
+    , m_vuMem(new uint8[PS2::VUMEM0SIZE])
+    , m_ee(MEMORYMAP_ENDIAN_LSBF)
+    , m_dmac(m_ram, m_spr, m_vuMem, m_ee)
+    , m_intc(m_dmac)
+    , m_ipu(m_intc)
+{
+	memset(m_ram, 0, PS2::EE_RAM_SIZE);
+	memset(m_spr, 0, PS2::EE_SPR_SIZE);
+	m_ipu.SetDMA3ReceiveHandler([this](const void* data, uint32 qwc) { return ReceiveDma3(data, qwc); });
+}
+
+CIpuDecodeBenchmark::~CIpuDecodeBenchmark()
+{
+	delete[] m_ram;
+	delete[] m_spr;
+	delete[] m_vuMem;
+}
+
+bool CIpuDecodeBenchmark::Run()
+{
+	printf("IPU BDEC (%d macroblocks per run)\n", MACROBLOCK_COUNT);
+
+	BuildStream(MACROBLOCK_COUNT);
+
+	auto reference = RunBdec(0, false);
+	bool result = !m_decodeError && (reference.size() == (MACROBLOCK_COUNT * RAW16_MACROBLOCK_SIZE));
+	double serialTime = Measure(ITERATIONS, [&]() { RunBdec(0, false); });
+	printf("  %-24s %7.2f ns/mb%s\n", "Serial", serialTime / MACROBLOCK_COUNT, result ? "" : " (DECODE ERROR)");
+
+	for(auto threadCount : g_threadCounts)
+	{
+		bool matches = (RunBdec(threadCount, false) == reference) && !m_decodeError;
+		result &= matches;
+
+		double threadedTime = Measure(ITERATIONS, [&]() { RunBdec(threadCount, false); });
+
+		char name[32];
+		snprintf(name, sizeof(name), "%d thread(s)", threadCount);
+		printf("  %-24s %7.2f ns/mb, speedup: %5.2fx%s\n",
+		       name, threadedTime / MACROBLOCK_COUNT, serialTime / threadedTime, matches ? "" : " (MISMATCH)");
+	}
+
+	//DMA3 leaving data in the OUT FIFO makes producers wait for room in its ring
+	for(unsigned int threadCount = 0; threadCount <= 4; threadCount += 2)
+	{
+		bool matches = (RunBdec(threadCount, true) == reference) && !m_decodeError;
+		result &= matches;
+
+		char name[32];
+		snprintf(name, sizeof(name), "Partial DMA3, %d thread(s)", threadCount);
+		printf("  %-24s %s\n", name, matches ? "ok" : "(MISMATCH)");
+	}
+
+	m_ipu.SetDecodeThreadCount(0);
+	return result;
+}
+
+//Writes an intra quantiser matrix followed by intra macroblocks at the start of RAM and builds
+//the BDEC commands that decode them. Blocks have a random DC and a few escape coded coefficients.
+void CIpuDecodeBenchmark::BuildStream(uint32 macroblockCount)
+{
+	std::mt19937 random(macroblockCount);
+	CBitWriter writer;
+
+	for(unsigned int i = 0; i < 0x40; i++)
+	{
+		writer.WriteBits(8 + (random() % 32), 8);
+	}
+
+	m_bdecCommands.clear();
+	for(uint32 macroblockIndex = 0; macroblockIndex < macroblockCount; macroblockIndex++)
+	{
+		uint32 qsc = 1 + (random() % 31);
+		//BDEC, MBI and DCR set
+		m_bdecCommands.push_back((0x02 << 28) | (1 << 27) | (1 << 26) | (qsc << 16));
+
+		for(unsigned int blockIndex = 0; blockIndex < 6; blockIndex++)
+		{
+			bool isLuminance = (blockIndex < 4);
+			//First code of the macroblock starts with a set bit, BDEC checks for start codes after each macroblock
+			uint32 dcSize = (blockIndex == 0) ? (3 + (random() % 3)) : (random() % 7);
+			writer.WriteCode(isLuminance ? g_dcSizeLuminanceCodes[dcSize] : g_dcSizeChrominanceCodes[dcSize]);
+			if(dcSize != 0)
+			{
+				uint32 magnitude = (1 << (dcSize - 1)) + (random() % (1 << (dcSize - 1)));
+				uint32 diffBits = (random() & 1) ? magnitude : ((1 << dcSize) - 1 - magnitude);
+				writer.WriteBits(diffBits, dcSize);
+			}
+
+			uint32 coefficientIndex = 1;
+			for(unsigned int coefficientCount = random() % 5; coefficientCount != 0; coefficientCount--)
+			{
+				uint32 run = random() % 12;
+				if((coefficientIndex + run) >= 0x40) break;
+				int32 level = 1 + (random() % 200);
+				if(random() & 1) level = -level;
+				//Escape code, 6-bit run and 12-bit level
+				writer.WriteCode("000001");
+				writer.WriteBits(run, 6);
+				writer.WriteBits(static_cast<uint32>(level) & 0xFFF, 12);
+				coefficientIndex += run + 1;
+			}
+
+			//End of block
+			writer.WriteCode("10");
+		}
+	}
+
+	writer.PadToQuadword();
+
+	const auto& bytes = writer.GetBytes();
+	assert(bytes.size() <= PS2::EE_RAM_SIZE);
+	memcpy(m_ram, bytes.data(), bytes.size());
+	m_streamSize = static_cast<uint32>(bytes.size());
+}
+
+std::vector<uint8> CIpuDecodeBenchmark::RunBdec(unsigned int threadCount, bool partialDma3)
+{
+	m_ipu.Reset();
+	m_ipu.SetDecodeThreadCount(threadCount);
+	m_output.clear();
+	m_decodeError = false;
+	m_partialDma3 = partialDma3;
+	m_dma3Random.seed(threadCount);
+
+	uint32 address = 0;
+
+	//SETIQ (intra)
+	ExecuteCommand(0x05 << 28, address);
+	for(auto command : m_bdecCommands)
+	{
+		ExecuteCommand(command, address);
+		if(m_decodeError) break;
+	}
+
+	m_partialDma3 = false;
+	m_ipu.FlushOUTFIFOData();
+	return m_output;
+}
+
+void CIpuDecodeBenchmark::ExecuteCommand(uint32 command, uint32& address)
+{
+	m_ipu.SetRegister(CIPU::IPU_CMD, command);
+	while(m_ipu.WillExecuteCommand())
+	{
+		if(address != m_streamSize)
+		{
+			address += m_ipu.ReceiveDMA4(address, (m_streamSize - address) / 0x10, false, m_ram, m_spr) * 0x10;
+		}
+		m_ipu.ExecuteCommand();
+		if(m_ipu.HasPendingOUTFIFOData())
+		{
+			m_ipu.FlushOUTFIFOData();
+		}
+	}
+	if(m_ipu.GetRegister(CIPU::IPU_CTRL) & 0x4000)
+	{
+		//VLC error
+		m_decodeError = true;
+	}
+}
+
+uint32 CIpuDecodeBenchmark::ReceiveDma3(const void* data, uint32 qwc)
+{
+	if(m_partialDma3)
+	{
+		qwc = std::min<uint32>(qwc, m_dma3Random() % 0x30);
+	}
+	auto bytes = reinterpret_cast<const uint8*>(data);
+	m_output.insert(m_output.end(), bytes, bytes + (qwc * 0x10));
+	return qwc;
+}
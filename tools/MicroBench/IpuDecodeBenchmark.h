@@ -0,0 +1,56 @@
+#pragma once
+
+#include <random>
+#include <vector>
+#include "Benchmark.h"
+#include "MIPS.h"
+#include "ee/DMAC.h"
+#include "ee/INTC.h"
+#include "ee/IPU.h"
+
+//Decodes a generated stream of intra macroblocks with BDEC, serially and with the decode
+//pipeline's worker threads, and checks that the output is the same. Runs are also made with
+//DMA3 taking random amounts of the OUT FIFO's data. Build with -fsanitize=thread to check the
+//pipeline for races, or with -fsanitize=address,undefined to check the OUT FIFO ring.
+class CIpuDecodeBenchmark : public CBenchmark
+{
+public:
+	CIpuDecodeBenchmark();
+	virtual ~CIpuDecodeBenchmark();
+
+	bool Run() override;
+
+private:
+	class CBitWriter
+	{
+	public:
+		void WriteBits(uint32, unsigned int);
+		void WriteCode(const char*);
+		void PadToQuadword();
+
+		const std::vector<uint8>& GetBytes() const;
+
+	private:
+		std::vector<uint8> m_bytes;
+		unsigned int m_bitPosition = 0;
+	};
+
+	void BuildStream(uint32);
+	std::vector<uint8> RunBdec(unsigned int, bool);
+	void ExecuteCommand(uint32, uint32&);
+	uint32 ReceiveDma3(const void*, uint32);
+
+	uint8* m_ram = nullptr;
+	uint8* m_spr = nullptr;
+	uint8* m_vuMem = nullptr;
+	CMIPS m_ee;
+	CDMAC m_dmac;
+	CINTC m_intc;
+	CIPU m_ipu;
+	std::vector<uint8> m_output;
+	std::vector<uint32> m_bdecCommands;
+	uint32 m_streamSize = 0;
+	bool m_decodeError = false;
+	bool m_partialDma3 = false;
+	std::mt19937 m_dma3Random;
+};
@@ -0,0 +1,253 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include "IpuIdctBenchmark.h"
+#include "ee/IPU_FastIdct.h"
+#include "idct/IEEE1180.h"
+
+#define ITERATIONS 20
+#define IEEE1180_BLOCK_COUNT 10000
+
+static const double g_pi = 3.14159265358979323846;
+
+// clang-format off
+const CIpuIdctBenchmark::IEEE1180_RANGE CIpuIdctBenchmark::g_ieee1180Ranges[] =
+{
+	{ 256, 255,  1 },
+	{ 256, 255, -1 },
+	{   5,   5,  1 },
+	{   5,   5, -1 },
+	{ 300, 300,  1 },
+	{ 300, 300, -1 },
+};
+// clang-format on
+
+bool CIpuIdctBenchmark::ACCURACY::IsWithinIeee1180Bounds() const
+{
+	return (peakError <= 1) &&
+	       (peakMeanSquareError <= 0.06) &&
+	       (overallMeanSquareError <= 0.02) &&
+	       (peakMeanError <= 0.015) &&
+	       (overallMeanError <= 0.0015);
+}
+
+CIpuIdctBenchmark::CIpuIdctBenchmark(const std::vector<std::string>& captureFiles)
+    : m_captureFiles(captureFiles)
+{
+	for(unsigned int i = 0; i < 8; i++)
+	{
+		double scale = (i == 0) ? sqrt(0.125) : 0.5;
+		for(unsigned int j = 0; j < 8; j++)
+		{
+			m_cosTable[i][j] = scale * cos((g_pi / 8.0) * i * (j + 0.5));
+		}
+	}
+}
+
+bool CIpuIdctBenchmark::Run()
+{
+	printf("IPU IDCT (IEEE 1180 test, %d blocks per range)\n", IEEE1180_BLOCK_COUNT);
+
+	bool result = true;
+	for(const auto& range : g_ieee1180Ranges)
+	{
+		auto blocks = GenerateIeee1180Blocks(range);
+		auto accuracy = MeasureAccuracy(blocks);
+		bool matches = CheckGenericMatches(blocks);
+		bool withinBounds = accuracy.IsWithinIeee1180Bounds();
+		result &= matches && withinBounds;
+
+		double referenceTime = 0;
+		double fastTime = 0;
+		MeasureSpeed(blocks, referenceTime, fastTime);
+
+		char name[32];
+		snprintf(name, sizeof(name), "[-%d, %d] x %d", range.low, range.high, range.sign);
+		printf("  %-24s peak: %d, pmse: %6.4f, omse: %6.4f, pme: %6.4f, ome: %7.5f, speedup: %5.2fx%s%s\n",
+		       name, accuracy.peakError, accuracy.peakMeanSquareError, accuracy.overallMeanSquareError,
+		       accuracy.peakMeanError, accuracy.overallMeanError, referenceTime / fastTime,
+		       withinBounds ? "" : " (OUT OF BOUNDS)", matches ? "" : " (MISMATCH)");
+	}
+
+	{
+		int16 zeroBlock[BLOCK_SIZE] = {};
+		int16 output[BLOCK_SIZE];
+		IPU::CFastIdct::Transform(zeroBlock, output);
+		bool zeroOutput = std::all_of(std::begin(output), std::end(output), [](int16 value) { return value == 0; });
+		result &= zeroOutput;
+		printf("  %-24s %s\n", "Zero input", zeroOutput ? "ok" : "(OUT OF BOUNDS)");
+	}
+
+	for(const auto& captureFile : m_captureFiles)
+	{
+		BlockArray blocks;
+		if(!LoadCapture(captureFile, blocks))
+		{
+			printf("  %s: failed to load capture\n", captureFile.c_str());
+			result = false;
+			continue;
+		}
+
+		uint32 blockCount = static_cast<uint32>(blocks.size() / BLOCK_SIZE);
+		auto accuracy = MeasureAccuracy(blocks);
+		bool matches = CheckGenericMatches(blocks);
+		result &= matches && (accuracy.peakError <= 1);
+
+		double referenceTime = 0;
+		double fastTime = 0;
+		MeasureSpeed(blocks, referenceTime, fastTime);
+
+		printf("  %s (%d blocks)\n", captureFile.c_str(), blockCount);
+		printf("    reference: %7.2f ns/block, fast: %7.2f ns/block, speedup: %5.2fx\n",
+		       referenceTime / blockCount, fastTime / blockCount, referenceTime / fastTime);
+		printf("    peak: %d, pmse: %6.4f, omse: %6.4f, pme: %6.4f, ome: %7.5f%s%s\n",
+		       accuracy.peakError, accuracy.peakMeanSquareError, accuracy.overallMeanSquareError,
+		       accuracy.peakMeanError, accuracy.overallMeanError,
+		       (accuracy.peakError <= 1) ? "" : " (OUT OF BOUNDS)", matches ? "" : " (MISMATCH)");
+	}
+
+	return result;
+}
+
+//Random pixel blocks are transformed with a precise forward DCT, as described in the standard
+CIpuIdctBenchmark::BlockArray CIpuIdctBenchmark::GenerateIeee1180Blocks(const IEEE1180_RANGE& range)
+{
+	m_randomState = 1;
+
+	BlockArray blocks(IEEE1180_BLOCK_COUNT * BLOCK_SIZE);
+	for(uint32 blockIndex = 0; blockIndex < IEEE1180_BLOCK_COUNT; blockIndex++)
+	{
+		int16 pixels[BLOCK_SIZE];
+		for(unsigned int i = 0; i < BLOCK_SIZE; i++)
+		{
+			m_randomState = (m_randomState * 1103515245) + 12345;
+			double value = static_cast<double>(m_randomState & 0x7FFFFFFE) / static_cast<double>(0x7FFFFFFF);
+			value *= (range.low + range.high + 1);
+			pixels[i] = static_cast<int16>((static_cast<int>(value) - range.low) * range.sign);
+		}
+		ForwardDct(pixels, blocks.data() + (blockIndex * BLOCK_SIZE));
+	}
+	return blocks;
+}
+
+bool CIpuIdctBenchmark::LoadCapture(const std::string& path, BlockArray& blocks)
+{
+	FILE* file = fopen(path.c_str(), "rb");
+	if(!file)
+	{
+		return false;
+	}
+	fseek(file, 0, SEEK_END);
+	long size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	uint32 blockCount = static_cast<uint32>(size / (BLOCK_SIZE * sizeof(int16)));
+	blocks.resize(blockCount * BLOCK_SIZE);
+	size_t readCount = fread(blocks.data(), sizeof(int16), blocks.size(), file);
+	fclose(file);
+	return (blockCount != 0) && (readCount == blocks.size());
+}
+
+CIpuIdctBenchmark::ACCURACY CIpuIdctBenchmark::MeasureAccuracy(const BlockArray& blocks)
+{
+	double errorSums[BLOCK_SIZE] = {};
+	double squareErrorSums[BLOCK_SIZE] = {};
+
+	ACCURACY accuracy;
+	uint32 blockCount = static_cast<uint32>(blocks.size() / BLOCK_SIZE);
+	for(uint32 blockIndex = 0; blockIndex < blockCount; blockIndex++)
+	{
+		int16 input[BLOCK_SIZE];
+		int16 reference[BLOCK_SIZE];
+		int16 fast[BLOCK_SIZE];
+		memcpy(input, blocks.data() + (blockIndex * BLOCK_SIZE), sizeof(input));
+		IDCT::CIEEE1180::GetInstance()->Transform(input, reference);
+		IPU::CFastIdct::Transform(input, fast);
+		for(unsigned int i = 0; i < BLOCK_SIZE; i++)
+		{
+			int error = fast[i] - reference[i];
+			errorSums[i] += error;
+			squareErrorSums[i] += error * error;
+			accuracy.peakError = std::max(accuracy.peakError, std::abs(error));
+		}
+	}
+
+	for(unsigned int i = 0; i < BLOCK_SIZE; i++)
+	{
+		accuracy.peakMeanSquareError = std::max(accuracy.peakMeanSquareError, squareErrorSums[i] / blockCount);
+		accuracy.peakMeanError = std::max(accuracy.peakMeanError, std::abs(errorSums[i]) / blockCount);
+		accuracy.overallMeanSquareError += squareErrorSums[i];
+		accuracy.overallMeanError += errorSums[i];
+	}
+	accuracy.overallMeanSquareError /= (blockCount * BLOCK_SIZE);
+	accuracy.overallMeanError = std::abs(accuracy.overallMeanError) / (blockCount * BLOCK_SIZE);
+	return accuracy;
+}
+
+bool CIpuIdctBenchmark::CheckGenericMatches(const BlockArray& blocks)
+{
+	for(size_t i = 0; i < blocks.size(); i += BLOCK_SIZE)
+	{
+		int16 simdOutput[BLOCK_SIZE];
+		int16 genericOutput[BLOCK_SIZE];
+		IPU::CFastIdct::Transform(blocks.data() + i, simdOutput);
+		IPU::CFastIdct::TransformGeneric(blocks.data() + i, genericOutput);
+		if(memcmp(simdOutput, genericOutput, sizeof(simdOutput)))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void CIpuIdctBenchmark::MeasureSpeed(const BlockArray& blocks, double& referenceTime, double& fastTime)
+{
+	BlockArray input(blocks);
+	BlockArray output(blocks.size());
+
+	auto runReference = [&]() {
+		for(size_t i = 0; i < input.size(); i += BLOCK_SIZE)
+		{
+			IDCT::CIEEE1180::GetInstance()->Transform(input.data() + i, output.data() + i);
+		}
+	};
+	auto runFast = [&]() {
+		for(size_t i = 0; i < input.size(); i += BLOCK_SIZE)
+		{
+			IPU::CFastIdct::Transform(input.data() + i, output.data() + i);
+		}
+	};
+
+	referenceTime = Measure(ITERATIONS, runReference);
+	fastTime = Measure(ITERATIONS, runFast);
+}
+
+void CIpuIdctBenchmark::ForwardDct(const int16* input, int16* output) const
+{
+	double temp[BLOCK_SIZE];
+	for(unsigned int i = 0; i < 8; i++)
+	{
+		for(unsigned int j = 0; j < 8; j++)
+		{
+			double sum = 0;
+			for(unsigned int k = 0; k < 8; k++)
+			{
+				sum += m_cosTable[j][k] * input[(i * 8) + k];
+			}
+			temp[(i * 8) + j] = sum;
+		}
+	}
+
+	for(unsigned int i = 0; i < 8; i++)
+	{
+		for(unsigned int j = 0; j < 8; j++)
+		{
+			double sum = 0;
+			for(unsigned int k = 0; k < 8; k++)
+			{
+				sum += m_cosTable[i][k] * temp[(k * 8) + j];
+			}
+			output[(i * 8) + j] = static_cast<int16>(std::min(std::max(floor(sum + 0.5), -2048.0), 2047.0));
+		}
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "Benchmark.h"
+#include "Types.h"
+
+//Checks the fixed-point IPU IDCT against the IEEE 1180 reference and compares their speed.
+//Blocks captured from movies (see _IDCT_CAPTURE in IPU.cpp) can be given on the command line.
+class CIpuIdctBenchmark : public CBenchmark
+{
+public:
+	CIpuIdctBenchmark(const std::vector<std::string>&);
+	virtual ~CIpuIdctBenchmark() = default;
+
+	bool Run() override;
+
+private:
+	enum
+	{
+		BLOCK_SIZE = 0x40,
+	};
+
+	typedef std::vector<int16> BlockArray;
+
+	struct ACCURACY
+	{
+		int peakError = 0;
+		double peakMeanSquareError = 0;
+		double overallMeanSquareError = 0;
+		double peakMeanError = 0;
+		double overallMeanError = 0;
+
+		bool IsWithinIeee1180Bounds() const;
+	};
+
+	struct IEEE1180_RANGE
+	{
+		int low;
+		int high;
+		int sign;
+	};
+
+	BlockArray GenerateIeee1180Blocks(const IEEE1180_RANGE&);
+	static bool LoadCapture(const std::string&, BlockArray&);
+
+	static ACCURACY MeasureAccuracy(const BlockArray&);
+	static bool CheckGenericMatches(const BlockArray&);
+	void MeasureSpeed(const BlockArray&, double&, double&);
+
+	void ForwardDct(const int16*, int16*) const;
+
+	static const IEEE1180_RANGE g_ieee1180Ranges[];
+
+	std::vector<std::string> m_captureFiles;
+	double m_cosTable[8][8];
+	uint32 m_randomState = 1;
+};
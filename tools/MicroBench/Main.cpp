@@ -0,0 +1,41 @@
+#include <cstdio>
+#include <memory>
+#include <functional>
+#include <string>
+#include <vector>
+#include "GsSwizzleBenchmark.h"
+#include "IpuCscBenchmark.h"
+#include "IpuDecodeBenchmark.h"
+#include "IpuIdctBenchmark.h"
+#include "MemoryMapBenchmark.h"
+#include "VifUnpackBenchmark.h"
+
+typedef std::vector<std::string> ArgumentList;
+typedef std::function<CBenchmark*(const ArgumentList&)> BenchmarkFactoryFunction;
+
+static const BenchmarkFactoryFunction s_factories[] =
+    {
+        [](const ArgumentList&) { return new CVifUnpackBenchmark(); },
+        [](const ArgumentList&) { return new CMemoryMapBenchmark(); },
+        [](const ArgumentList&) { return new CIpuCscBenchmark(); },
+        [](const ArgumentList&) { return new CIpuDecodeBenchmark(); },
+        [](const ArgumentList& arguments) { return new CIpuIdctBenchmark(arguments); },
+        [](const ArgumentList&) { return new CGsSwizzleBenchmark(); },
+};
+
+//Arguments are paths to IDCT block captures
+int main(int argc, const char** argv)
+{
+	ArgumentList arguments(argv + 1, argv + argc);
+
+	int result = 0;
+	for(const auto& factory : s_factories)
+	{
+		auto benchmark = std::unique_ptr<CBenchmark>(factory(arguments));
+		if(!benchmark->Run())
+		{
+			result = 1;
+		}
+	}
+	return result;
+}
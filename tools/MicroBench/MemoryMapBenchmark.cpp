@@ -0,0 +1,212 @@
+#include <cstdio>
+#include "MemoryMapBenchmark.h"
+#include "Ps2Const.h"
+
+#define ITERATIONS 200
+#define ACCESS_COUNT 4096
+#define REGISTER_COUNT 0x400
+
+// clang-format off
+const CMemoryMapBenchmark::SCENARIO CMemoryMapBenchmark::g_scenarios[] =
+{
+	{ "DMAC status polling",   0x1000E010, 0x00, 0x0000, false },
+	{ "Timer register sweep",  0x10000000, 0x10, 0x1840, false },
+	{ "VIF1 FIFO writes",      0x10005000, 0x04, 0x0010, true  },
+	{ "GS privileged reads",   0x12001000, 0x00, 0x0000, false },
+	{ "GS privileged writes",  0x12000000, 0x10, 0x00F0, true  },
+	{ "Scratchpad reads",      0x02000000, 0x04, 0x4000, false },
+	{ "VU1 memory writes",     0x1100C000, 0x04, 0x4000, true  },
+	{ "BIOS reads",            0x1FC00000, 0x04, 0x8000, false },
+	{ "RAM reads",             0x00100000, 0x04, 0x8000, false },
+};
+// clang-format on
+
+CMemoryMapBenchmark::CMemoryMapBenchmark()
+    : m_ram(PS2::EE_RAM_SIZE)
+    , m_spr(PS2::EE_SPR_SIZE)
+    , m_vuMem1(PS2::VUMEM1SIZE)
+    , m_fakeIopRam(0x1001)
+    , m_bios(PS2::EE_BIOS_SIZE)
+    , m_registers(REGISTER_COUNT)
+{
+	SetupMap(m_indexedMap, true);
+	SetupMap(m_linearMap, false);
+}
+
+bool CMemoryMapBenchmark::Run()
+{
+	printf("Memory map (%d word accesses per pass)\n", ACCESS_COUNT);
+
+	bool result = CheckLookups();
+	if(!result)
+	{
+		printf("  Lookup MISMATCH between linear and indexed maps\n");
+	}
+
+	for(const auto& scenario : g_scenarios)
+	{
+		std::fill(m_registers.begin(), m_registers.end(), 0);
+		uint32 linearChecksum = RunScenario(m_linearMap, scenario);
+		std::fill(m_registers.begin(), m_registers.end(), 0);
+		uint32 indexedChecksum = RunScenario(m_indexedMap, scenario);
+
+		bool matches = (linearChecksum == indexedChecksum);
+		result &= matches;
+
+		double linearTime = Measure(ITERATIONS, [&]() { RunScenario(m_linearMap, scenario); });
+		double indexedTime = Measure(ITERATIONS, [&]() { RunScenario(m_indexedMap, scenario); });
+
+		printf("  %-24s linear: %7.2f ns/access, indexed: %7.2f ns/access, speedup: %5.2fx%s\n",
+		       scenario.name, linearTime / ACCESS_COUNT, indexedTime / ACCESS_COUNT, linearTime / indexedTime,
+		       matches ? "" : " (MISMATCH)");
+	}
+
+	return result;
+}
+
+//Same layout as the EE's memory map
+void CMemoryMapBenchmark::SetupMap(CMemoryMap& memoryMap, bool usePlainHandlers)
+{
+	auto readHandler = [this](uint32 address, uint32) { return ReadRegister(address); };
+	auto writeHandler = [this](uint32 address, uint32 value) { return WriteRegister(address, value); };
+	auto insertReadHandler = [&](uint32 start, uint32 end, unsigned char key) {
+		if(usePlainHandlers)
+		{
+			memoryMap.InsertReadMap(start, end, &CMemoryMap::ReadHandlerAdapter<CMemoryMapBenchmark, &CMemoryMapBenchmark::ReadRegister>, this, key);
+		}
+		else
+		{
+			memoryMap.InsertReadMap(start, end, readHandler, key);
+		}
+	};
+	auto insertWriteHandler = [&](uint32 start, uint32 end, unsigned char key) {
+		if(usePlainHandlers)
+		{
+			memoryMap.InsertWriteMap(start, end, &CMemoryMap::WriteHandlerAdapter<CMemoryMapBenchmark, &CMemoryMapBenchmark::WriteRegister>, this, key);
+		}
+		else
+		{
+			memoryMap.InsertWriteMap(start, end, writeHandler, key);
+		}
+	};
+
+	memoryMap.InsertReadMap(0x00000000, 0x01FFFFFF, m_ram.data(), 0x00);
+	memoryMap.InsertReadMap(PS2::EE_SPR_ADDR, PS2::EE_SPR_ADDR + PS2::EE_SPR_SIZE - 1, m_spr.data(), 0x01);
+	insertReadHandler(0x10000000, 0x10FFFFFF, 0x02);
+	memoryMap.InsertReadMap(PS2::VUMEM1ADDR, PS2::VUMEM1ADDR + PS2::VUMEM1SIZE - 1, m_vuMem1.data(), 0x03);
+	insertReadHandler(0x12000000, 0x12FFFFFF, 0x04);
+	memoryMap.InsertReadMap(0x1C000000, 0x1C001000, m_fakeIopRam.data(), 0x05);
+	memoryMap.InsertReadMap(0x1FC00000, 0x1FFFFFFF, m_bios.data(), 0x06);
+
+	memoryMap.InsertWriteMap(0x00000000, 0x01FFFFFF, m_ram.data(), 0x00);
+	memoryMap.InsertWriteMap(PS2::EE_SPR_ADDR, PS2::EE_SPR_ADDR + PS2::EE_SPR_SIZE - 1, m_spr.data(), 0x01);
+	insertWriteHandler(0x10000000, 0x10FFFFFF, 0x02);
+	memoryMap.InsertWriteMap(PS2::VUMEM1ADDR, PS2::VUMEM1ADDR + PS2::VUMEM1SIZE - 1, m_vuMem1.data(), 0x03);
+	insertWriteHandler(0x12000000, 0x12FFFFFF, 0x04);
+}
+
+//Both maps must resolve every address to the same region, checked around every page
+bool CMemoryMapBenchmark::CheckLookups()
+{
+	auto sameElement = [](const CMemoryMap::MEMORYMAPELEMENT* indexed, const CMemoryMap::MEMORYMAPELEMENT* linear) {
+		if(!indexed || !linear) return (indexed == linear);
+		return (indexed->nStart == linear->nStart) && (indexed->nEnd == linear->nEnd) && (indexed->nType == linear->nType);
+	};
+
+	static const uint32 pageSize = 0x1000;
+	uint64 address = 0;
+	while(address < 0x100000000ULL)
+	{
+		for(uint32 offset : {0U, 4U, pageSize - 4})
+		{
+			uint32 checkAddress = static_cast<uint32>(address + offset);
+			if(!sameElement(m_indexedMap.GetReadMap(checkAddress), m_linearMap.FindReadElement(checkAddress))) return false;
+			if(!sameElement(m_indexedMap.GetWriteMap(checkAddress), m_linearMap.FindWriteElement(checkAddress))) return false;
+		}
+		address += pageSize;
+	}
+	return true;
+}
+
+uint32 CMemoryMapBenchmark::RunScenario(CMemoryMap& memoryMap, const SCENARIO& scenario)
+{
+	uint32 checksum = 0;
+	uint32 offset = 0;
+	for(unsigned int i = 0; i < ACCESS_COUNT; i++)
+	{
+		uint32 address = scenario.address + offset;
+		if(scenario.write)
+		{
+			memoryMap.SetWord(address, i);
+		}
+		else
+		{
+			checksum += memoryMap.GetWord(address);
+		}
+		offset += scenario.stride;
+		if(offset >= scenario.span)
+		{
+			offset = 0;
+		}
+	}
+	return checksum + m_registers[0] + m_registers[REGISTER_COUNT - 1];
+}
+
+uint32 CMemoryMapBenchmark::ReadRegister(uint32 address)
+{
+	return m_registers[(address >> 2) % REGISTER_COUNT]++;
+}
+
+uint32 CMemoryMapBenchmark::WriteRegister(uint32 address, uint32 value)
+{
+	m_registers[(address >> 2) % REGISTER_COUNT] += value;
+	return 0;
+}
+
+//////////////////////////////////////////////////////////////////
+//Linear memory map
+//////////////////////////////////////////////////////////////////
+
+uint32 CMemoryMapBenchmark::CLinearMemoryMap::GetWord(uint32 address)
+{
+	const auto e = FindReadElement(address);
+	if(!e)
+	{
+		return 0xCCCCCCCC;
+	}
+	switch(e->nType)
+	{
+	case MEMORYMAP_TYPE_MEMORY:
+		return *reinterpret_cast<uint32*>(&reinterpret_cast<uint8*>(e->pPointer)[address - e->nStart]);
+	default:
+		return e->handler(address, 0);
+	}
+}
+
+void CMemoryMapBenchmark::CLinearMemoryMap::SetWord(uint32 address, uint32 value)
+{
+	const auto e = FindWriteElement(address);
+	if(!e)
+	{
+		return;
+	}
+	switch(e->nType)
+	{
+	case MEMORYMAP_TYPE_MEMORY:
+		*reinterpret_cast<uint32*>(&reinterpret_cast<uint8*>(e->pPointer)[address - e->nStart]) = value;
+		break;
+	default:
+		e->handler(address, value);
+		break;
+	}
+}
+
+const CMemoryMap::MEMORYMAPELEMENT* CMemoryMapBenchmark::CLinearMemoryMap::FindReadElement(uint32 address) const
+{
+	return FindElement(m_readMap.elements, address);
+}
+
+const CMemoryMap::MEMORYMAPELEMENT* CMemoryMapBenchmark::CLinearMemoryMap::FindWriteElement(uint32 address) const
+{
+	return FindElement(m_writeMap.elements, address);
+}
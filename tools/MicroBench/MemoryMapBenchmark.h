@@ -0,0 +1,55 @@
+#pragma once
+
+#include <vector>
+#include "Benchmark.h"
+#include "MemoryMap.h"
+
+//Compares the page indexed memory map with a linear lookup and std::function handlers
+class CMemoryMapBenchmark : public CBenchmark
+{
+public:
+	CMemoryMapBenchmark();
+	virtual ~CMemoryMapBenchmark() = default;
+
+	bool Run() override;
+
+private:
+	//Memory map as it was before the page index: linear lookup, handlers called through std::function
+	class CLinearMemoryMap : public CMemoryMap_LSBF
+	{
+	public:
+		uint32 GetWord(uint32) override;
+		void SetWord(uint32, uint32) override;
+
+		const MEMORYMAPELEMENT* FindReadElement(uint32) const;
+		const MEMORYMAPELEMENT* FindWriteElement(uint32) const;
+	};
+
+	struct SCENARIO
+	{
+		const char* name;
+		uint32 address;
+		uint32 stride;
+		uint32 span;
+		bool write;
+	};
+
+	void SetupMap(CMemoryMap&, bool);
+	bool CheckLookups();
+	uint32 RunScenario(CMemoryMap&, const SCENARIO&);
+
+	uint32 ReadRegister(uint32);
+	uint32 WriteRegister(uint32, uint32);
+
+	static const SCENARIO g_scenarios[];
+
+	std::vector<uint8> m_ram;
+	std::vector<uint8> m_spr;
+	std::vector<uint8> m_vuMem1;
+	std::vector<uint8> m_fakeIopRam;
+	std::vector<uint8> m_bios;
+	std::vector<uint32> m_registers;
+
+	CMemoryMap_LSBF m_indexedMap;
+	CLinearMemoryMap m_linearMap;
+};
@@ -0,0 +1,151 @@
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include "VifUnpackBenchmark.h"
+#include "Ps2Const.h"
+#include "ee/Vif.h"
+
+#define ITERATIONS 200
+#define UNPACK_COUNT 16
+
+// clang-format off
+const CVifUnpackBenchmark::SCENARIO CVifUnpackBenchmark::g_scenarios[] =
+{
+	{ "V4-32",                 0x0C, false, false, 0, 4, 4 },
+	{ "V3-32",                 0x08, false, false, 0, 4, 4 },
+	{ "V2-32",                 0x04, false, false, 0, 1, 1 },
+	{ "S-32",                  0x00, false, false, 0, 1, 1 },
+	{ "V4-16",                 0x0D, false, false, 0, 4, 4 },
+	{ "V3-16 (usn)",           0x09, true,  false, 0, 4, 4 },
+	{ "V2-16",                 0x05, false, false, 0, 1, 1 },
+	{ "V4-8 (usn)",            0x0E, true,  false, 0, 4, 4 },
+	{ "V3-8",                  0x0A, false, false, 0, 1, 1 },
+	{ "V4-5",                  0x0F, false, false, 0, 1, 1 },
+	{ "V4-32 offset",          0x0C, false, false, 1, 4, 4 },
+	{ "V4-16 difference",      0x0D, false, false, 2, 4, 4 },
+	{ "V4-32 masked",          0x0C, false, true,  0, 4, 4 },
+	{ "V3-32 masked offset",   0x08, false, true,  1, 4, 4 },
+	{ "V4-32 skipping (4/2)",  0x0C, false, false, 0, 4, 2 },
+	{ "V2-16 skipping (3/1)",  0x05, false, true,  0, 3, 1 },
+};
+// clang-format on
+
+CVifUnpackBenchmark::CVifUnpackBenchmark()
+    : m_ram(new uint8[PS2::EE_RAM_SIZE])
+    , m_spr(new uint8[PS2::EE_SPR_SIZE])
+    , m_vuMem(new uint8[PS2::VUMEM0SIZE])
+    , m_microMem(new uint8[PS2::MICROMEM0SIZE])
+    , m_vu(MEMORYMAP_ENDIAN_LSBF)
+    , m_ee(MEMORYMAP_ENDIAN_LSBF)
+    , m_dmac(m_ram, m_spr, m_vuMem, m_ee)
+    , m_intc(m_dmac)
+    , m_gif(m_gs, m_ram, m_spr)
+    , m_vpu(0, CVpu::VPUINIT(m_microMem, m_vuMem, &m_vu), m_gif, m_intc, m_ram, m_spr)
+{
+	memset(m_ram, 0, PS2::EE_RAM_SIZE);
+	memset(m_spr, 0, PS2::EE_SPR_SIZE);
+	memset(m_microMem, 0, PS2::MICROMEM0SIZE);
+}
+
+CVifUnpackBenchmark::~CVifUnpackBenchmark()
+{
+	delete[] m_ram;
+	delete[] m_spr;
+	delete[] m_vuMem;
+	delete[] m_microMem;
+}
+
+bool CVifUnpackBenchmark::Run()
+{
+	printf("VIF UNPACK (%d commands of 256 elements per packet)\n", UNPACK_COUNT);
+
+	bool result = true;
+	for(const auto& scenario : g_scenarios)
+	{
+		uint32 qwc = BuildPacket(scenario);
+
+		bool matches = (RunPacket(qwc, false) == RunPacket(qwc, true));
+		result &= matches;
+
+		auto& vif = m_vpu.GetVif();
+		auto processPacket = [&]() { vif.ReceiveDMA(0, qwc, 0, false); };
+
+		vif.SetFastUnpackEnabled(false);
+		double genericTime = Measure(ITERATIONS, processPacket);
+		vif.SetFastUnpackEnabled(true);
+		double fastTime = Measure(ITERATIONS, processPacket);
+
+		double elementCount = UNPACK_COUNT * 256;
+		printf("  %-24s generic: %7.2f ns/elem, fast: %7.2f ns/elem, speedup: %5.2fx%s\n",
+		       scenario.name, genericTime / elementCount, fastTime / elementCount, genericTime / fastTime,
+		       matches ? "" : " (MISMATCH)");
+	}
+
+	return result;
+}
+
+//Writes a VIF packet at the start of RAM, returns its size in quadwords
+uint32 CVifUnpackBenchmark::BuildPacket(const SCENARIO& scenario)
+{
+	static const uint32 elementSizes[0x10] =
+	    {
+	        4, 2, 1, 0,
+	        8, 4, 2, 0,
+	        12, 6, 3, 0,
+	        16, 8, 4, 2};
+
+	std::mt19937 random(scenario.format);
+	std::vector<uint32> packet;
+
+	//STCYCL, STMOD, STMASK, STROW, STCOL
+	packet.push_back((0x01 << 24) | (scenario.wl << 8) | scenario.cl);
+	packet.push_back((0x05 << 24) | scenario.mode);
+	packet.push_back(0x20 << 24);
+	packet.push_back(random());
+	packet.push_back(0x30 << 24);
+	for(unsigned int i = 0; i < 4; i++)
+	{
+		packet.push_back(random());
+	}
+	packet.push_back(0x31 << 24);
+	for(unsigned int i = 0; i < 4; i++)
+	{
+		packet.push_back(random());
+	}
+
+	uint32 command = 0x60 | scenario.format | (scenario.useMask ? 0x10 : 0);
+	uint32 imm = scenario.usn ? 0x4000 : 0;
+	uint32 dataWordCount = ((elementSizes[scenario.format] * 256) + 3) / 4;
+	for(unsigned int unpack = 0; unpack < UNPACK_COUNT; unpack++)
+	{
+		//NUM = 0 means 256 elements
+		packet.push_back((command << 24) | imm);
+		for(unsigned int i = 0; i < dataWordCount; i++)
+		{
+			packet.push_back(random());
+		}
+	}
+
+	//Pad to a quadword boundary with NOPs
+	while(packet.size() & 3)
+	{
+		packet.push_back(0);
+	}
+
+	uint32 packetSize = static_cast<uint32>(packet.size() * 4);
+	assert(packetSize <= PS2::EE_RAM_SIZE);
+	memcpy(m_ram, packet.data(), packetSize);
+	return packetSize / 0x10;
+}
+
+std::vector<uint8> CVifUnpackBenchmark::RunPacket(uint32 qwc, bool fastUnpackEnabled)
+{
+	auto& vif = m_vpu.GetVif();
+	vif.Reset();
+	vif.SetFastUnpackEnabled(fastUnpackEnabled);
+	memset(m_vuMem, 0, PS2::VUMEM0SIZE);
+	uint32 processed = vif.ReceiveDMA(0, qwc, 0, false);
+	assert(processed == qwc);
+	return std::vector<uint8>(m_vuMem, m_vuMem + PS2::VUMEM0SIZE);
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <vector>
+#include "Benchmark.h"
+#include "MIPS.h"
+#include "ee/DMAC.h"
+#include "ee/INTC.h"
+#include "ee/GIF.h"
+#include "ee/Vpu.h"
+
+//Compares the specialized VIF UNPACK kernels with the generic path
+class CVifUnpackBenchmark : public CBenchmark
+{
+public:
+	CVifUnpackBenchmark();
+	virtual ~CVifUnpackBenchmark();
+
+	bool Run() override;
+
+private:
+	struct SCENARIO
+	{
+		const char* name;
+		uint32 format;
+		bool usn;
+		bool useMask;
+		uint32 mode;
+		uint32 cl;
+		uint32 wl;
+	};
+
+	uint32 BuildPacket(const SCENARIO&);
+	std::vector<uint8> RunPacket(uint32, bool);
+
+	static const SCENARIO g_scenarios[];
+
+	uint8* m_ram = nullptr;
+	uint8* m_spr = nullptr;
+	uint8* m_vuMem = nullptr;
+	uint8* m_microMem = nullptr;
+	CMIPS m_vu;
+	CMIPS m_ee;
+	CDMAC m_dmac;
+	CINTC m_intc;
+	CGSHandler* m_gs = nullptr;
+	CGIF m_gif;
+	CVpu m_vpu;
+};
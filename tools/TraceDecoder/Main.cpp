@@ -0,0 +1,120 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include "StdStream.h"
+#include "StdStreamUtils.h"
+#include "PathUtils.h"
+#include "TraceReader.h"
+
+//Records are printed in time order, with the thread that produced them.
+//With --split, each log gets its own file holding only the formatted text, like CLog writes them.
+int main(int argc, const char** argv)
+{
+	if(argc < 2)
+	{
+		printf("Usage: TraceDecoder [options] traceFile\r\n");
+		printf("Options: \r\n");
+		printf("\t --split <dir>\t Writes records of each log to <dir>/<log>.log instead of the standard output.\r\n");
+		return -1;
+	}
+
+	fs::path tracePath;
+	fs::path splitPath;
+
+	for(int i = 1; i < argc; i++)
+	{
+		if(!strcmp(argv[i], "--split"))
+		{
+			if((i + 1) >= argc)
+			{
+				printf("Error: Directory must be specified for --split option.\r\n");
+				return -1;
+			}
+			splitPath = fs::path(argv[i + 1]);
+			i++;
+		}
+		else
+		{
+			tracePath = argv[i];
+			break;
+		}
+	}
+
+	if(tracePath.empty())
+	{
+		printf("Error: No trace file specified.\r\n");
+		return -1;
+	}
+
+	CTraceReader reader;
+	try
+	{
+		auto traceStream = Framework::CreateInputStdStream(tracePath.native());
+		reader.Read(traceStream);
+	}
+	catch(const std::exception& exception)
+	{
+		//Trace files of processes that didn't exit cleanly can end with a partial block
+		fprintf(stderr, "Warning: Failed to read whole trace file: %s\r\n", exception.what());
+	}
+
+	//Records of a thread are in order, blocks of different threads are interleaved
+	auto records = reader.GetRecords();
+	std::stable_sort(records.begin(), records.end(),
+	                 [](const CTraceReader::RECORD& record1, const CTraceReader::RECORD& record2) {
+		                 return record1.timestamp < record2.timestamp;
+	                 });
+
+	const auto& points = reader.GetPoints();
+	try
+	{
+		if(splitPath.empty())
+		{
+			uint64 startTimestamp = records.empty() ? 0 : records[0].timestamp;
+			for(const auto& record : records)
+			{
+				auto text = reader.FormatRecord(record);
+				while(!text.empty() && ((text.back() == '\n') || (text.back() == '\r')))
+				{
+					text.pop_back();
+				}
+				const char* logName = (record.pointId < points.size()) ? points[record.pointId].logName.c_str() : "";
+				double time = static_cast<double>(record.timestamp - startTimestamp) / 1000000000.0;
+				printf("[%12.6f] [%2d] %s: %s\n", time, record.threadIndex, logName, text.c_str());
+			}
+		}
+		else
+		{
+			Framework::PathUtils::EnsurePathExists(splitPath);
+			std::map<std::string, Framework::CStdStream> logStreams;
+			for(const auto& record : records)
+			{
+				const auto& logName = (record.pointId < points.size()) ? points[record.pointId].logName : std::string("unknown");
+				auto logIterator = logStreams.find(logName);
+				if(logIterator == std::end(logStreams))
+				{
+					auto logPath = splitPath / (logName + ".log");
+					logIterator = logStreams.emplace(logName, Framework::CreateOutputStdStream(logPath.native())).first;
+				}
+				auto text = reader.FormatRecord(record);
+				logIterator->second.Write(text.data(), text.size());
+			}
+		}
+	}
+	catch(const std::exception& exception)
+	{
+		printf("Error: Failed to write decoded trace: %s\r\n", exception.what());
+		return -1;
+	}
+
+	const auto& threadStats = reader.GetThreadStats();
+	for(uint32 i = 0; i < threadStats.size(); i++)
+	{
+		if(threadStats[i].droppedCount == 0) continue;
+		fprintf(stderr, "Warning: Thread %d dropped %d records or arguments (%d recorded).\r\n",
+		        i, threadStats[i].droppedCount, threadStats[i].recordCount);
+	}
+
+	return 0;
+}
@@ -0,0 +1,255 @@
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <stdexcept>
+#include "TraceReader.h"
+#include "string_format.h"
+
+void CTraceReader::Read(Framework::CStream& stream)
+{
+	if(stream.Read32() != CTrace::FILE_MAGIC)
+	{
+		throw std::runtime_error("Not a trace file.");
+	}
+	if(stream.Read32() != CTrace::FILE_VERSION)
+	{
+		throw std::runtime_error("Unsupported trace file version.");
+	}
+	while(1)
+	{
+		uint8 blockType = 0;
+		if(stream.Read(&blockType, 1) != 1) break;
+		switch(blockType)
+		{
+		case CTrace::BLOCK_TYPE_POINT:
+			ReadPoint(stream);
+			break;
+		case CTrace::BLOCK_TYPE_RECORDS:
+			ReadRecords(stream);
+			break;
+		default:
+			throw std::runtime_error(string_format("Unknown block type %d.", blockType));
+		}
+	}
+}
+
+const CTraceReader::PointArray& CTraceReader::GetPoints() const
+{
+	return m_points;
+}
+
+const CTraceReader::RecordArray& CTraceReader::GetRecords() const
+{
+	return m_records;
+}
+
+const CTraceReader::ThreadStatsArray& CTraceReader::GetThreadStats() const
+{
+	return m_threadStats;
+}
+
+std::string CTraceReader::FormatRecord(const RECORD& record) const
+{
+	if(record.pointId >= m_points.size())
+	{
+		return string_format("<unknown trace point %d>", record.pointId);
+	}
+	return FormatArgs(m_points[record.pointId].format, record.args);
+}
+
+void CTraceReader::ReadPoint(Framework::CStream& stream)
+{
+	auto readString = [&stream]() {
+		std::string result(stream.Read16(), 0);
+		stream.Read(&result[0], result.size());
+		return result;
+	};
+	uint16 pointId = stream.Read16();
+	if(pointId >= m_points.size())
+	{
+		m_points.resize(pointId + 1);
+	}
+	auto& point = m_points[pointId];
+	point.logName = readString();
+	point.format = readString();
+}
+
+void CTraceReader::ReadRecords(Framework::CStream& stream)
+{
+	uint32 threadIndex = stream.Read32();
+	uint32 droppedCount = stream.Read32();
+	uint32 size = stream.Read32();
+	std::vector<uint8> data(size);
+	if(stream.Read(data.data(), size) != size)
+	{
+		throw std::runtime_error("Trace file is truncated.");
+	}
+	if(threadIndex >= m_threadStats.size())
+	{
+		m_threadStats.resize(threadIndex + 1);
+	}
+	auto& threadStats = m_threadStats[threadIndex];
+	threadStats.droppedCount += droppedCount;
+	uint32 offset = 0;
+	while(offset < size)
+	{
+		CTrace::RECORD_HEADER header;
+		if((size - offset) < sizeof(header))
+		{
+			throw std::runtime_error("Trace record is truncated.");
+		}
+		memcpy(&header, data.data() + offset, sizeof(header));
+		if((header.size < sizeof(header)) || (header.size > (size - offset)))
+		{
+			throw std::runtime_error("Trace record has an invalid size.");
+		}
+		RECORD record;
+		record.timestamp = header.timestamp;
+		record.threadIndex = threadIndex;
+		record.pointId = header.pointId;
+		ReadRecord(record, data.data() + offset + sizeof(header), header.size - sizeof(header));
+		m_records.push_back(std::move(record));
+		threadStats.recordCount++;
+		offset += header.size;
+	}
+}
+
+void CTraceReader::ReadRecord(RECORD& record, const uint8* args, uint32 size)
+{
+	uint32 offset = 0;
+	while(offset < size)
+	{
+		ARG arg;
+		arg.type = static_cast<CTrace::ARG_TYPE>(args[offset++]);
+		if(arg.type == CTrace::ARG_TYPE_STRING)
+		{
+			if(offset >= size) break;
+			uint32 length = args[offset++];
+			length = std::min<uint32>(length, size - offset);
+			arg.string = std::string(reinterpret_cast<const char*>(args + offset), length);
+			offset += length;
+		}
+		else
+		{
+			if((size - offset) < sizeof(uint64)) break;
+			memcpy(&arg.value, args + offset, sizeof(uint64));
+			offset += sizeof(uint64);
+		}
+		record.args.push_back(std::move(arg));
+	}
+}
+
+//Integers were widened to 64 bits when recorded, they are truncated back using the conversion's length modifier
+std::string CTraceReader::FormatArgs(const std::string& format, const ArgArray& args)
+{
+	static const ARG missingArg;
+	size_t argIndex = 0;
+	auto nextArg = [&]() -> const ARG& {
+		return (argIndex < args.size()) ? args[argIndex++] : missingArg;
+	};
+
+	std::string result;
+	size_t position = 0;
+	while(position < format.size())
+	{
+		char formatChar = format[position++];
+		if(formatChar != '%')
+		{
+			result += formatChar;
+			continue;
+		}
+		if((position < format.size()) && (format[position] == '%'))
+		{
+			result += '%';
+			position++;
+			continue;
+		}
+
+		//Flags, width and precision are passed as is to string_format
+		std::string spec = "%";
+		while((position < format.size()) && strchr("-+ #0", format[position]))
+		{
+			spec += format[position++];
+		}
+		for(bool precision = false;; precision = true)
+		{
+			if((position < format.size()) && (format[position] == '*'))
+			{
+				spec += std::to_string(static_cast<int32>(nextArg().value));
+				position++;
+			}
+			while((position < format.size()) && isdigit(static_cast<unsigned char>(format[position])))
+			{
+				spec += format[position++];
+			}
+			if(precision || (position >= format.size()) || (format[position] != '.')) break;
+			spec += format[position++];
+		}
+
+		unsigned int lengthBits = 32;
+		while((position < format.size()) && strchr("hljztLq", format[position]))
+		{
+			switch(format[position++])
+			{
+			case 'h':
+				lengthBits = (lengthBits == 16) ? 8 : 16;
+				break;
+			default:
+				lengthBits = 64;
+				break;
+			}
+		}
+		if(position >= format.size()) break;
+
+		char conversion = format[position++];
+		const auto& arg = nextArg();
+		uint64 value = arg.value;
+		if(lengthBits != 64)
+		{
+			value &= (1ULL << lengthBits) - 1;
+		}
+		switch(conversion)
+		{
+		case 'd':
+		case 'i':
+		{
+			int64 signedValue = static_cast<int64>(value << (64 - lengthBits)) >> (64 - lengthBits);
+			result += string_format((spec + "lld").c_str(), static_cast<long long>(signedValue));
+		}
+		break;
+		case 'u':
+		case 'x':
+		case 'X':
+		case 'o':
+			result += string_format((spec + "ll" + conversion).c_str(), static_cast<unsigned long long>(value));
+			break;
+		case 'c':
+			result += string_format((spec + "c").c_str(), static_cast<int>(value));
+			break;
+		case 'f':
+		case 'F':
+		case 'e':
+		case 'E':
+		case 'g':
+		case 'G':
+		case 'a':
+		case 'A':
+		{
+			double doubleValue = 0;
+			memcpy(&doubleValue, &arg.value, sizeof(double));
+			result += string_format((spec + conversion).c_str(), doubleValue);
+		}
+		break;
+		case 's':
+			result += string_format((spec + "s").c_str(), arg.string.c_str());
+			break;
+		case 'p':
+			result += string_format("0x%llx", static_cast<unsigned long long>(arg.value));
+			break;
+		default:
+			result += spec + conversion;
+			break;
+		}
+	}
+	return result;
+}
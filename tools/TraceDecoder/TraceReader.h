@@ -0,0 +1,61 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "Stream.h"
+#include "Trace.h"
+
+//Reads back trace files written by CTrace
+class CTraceReader
+{
+public:
+	struct ARG
+	{
+		CTrace::ARG_TYPE type = CTrace::ARG_TYPE_INTEGER;
+		uint64 value = 0;
+		std::string string;
+	};
+	typedef std::vector<ARG> ArgArray;
+
+	struct POINT
+	{
+		std::string logName;
+		std::string format;
+	};
+	typedef std::vector<POINT> PointArray;
+
+	struct RECORD
+	{
+		uint64 timestamp = 0;
+		uint32 threadIndex = 0;
+		CTrace::PointId pointId = 0;
+		ArgArray args;
+	};
+	typedef std::vector<RECORD> RecordArray;
+
+	struct THREAD_STATS
+	{
+		uint32 recordCount = 0;
+		uint32 droppedCount = 0;
+	};
+	typedef std::vector<THREAD_STATS> ThreadStatsArray;
+
+	void Read(Framework::CStream&);
+
+	const PointArray& GetPoints() const;
+	const RecordArray& GetRecords() const;
+	const ThreadStatsArray& GetThreadStats() const;
+
+	//Formats the record's arguments as printf would have with the point's format
+	std::string FormatRecord(const RECORD&) const;
+
+private:
+	void ReadPoint(Framework::CStream&);
+	void ReadRecords(Framework::CStream&);
+	static void ReadRecord(RECORD&, const uint8*, uint32);
+	static std::string FormatArgs(const std::string&, const ArgArray&);
+
+	PointArray m_points;
+	RecordArray m_records;
+	ThreadStatsArray m_threadStats;
+};
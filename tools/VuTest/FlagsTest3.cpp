@@ -0,0 +1,157 @@
+#include "FlagsTest3.h"
+#include "VuAssembler.h"
+
+struct FLAGS_TEST3_RESULT
+{
+	uint32 macFlags[3];
+	uint32 statusFlags;
+	uint32 stickyFlags;
+};
+
+static FLAGS_TEST3_RESULT RunFlagsTest3(CTestVm& virtualMachine)
+{
+	virtualMachine.Reset();
+
+	auto microMem = reinterpret_cast<uint32*>(virtualMachine.m_microMem);
+
+	CVuAssembler assembler(microMem);
+
+	//pipe = 0		//macTime = 0 + 4 = 4, read at pipe 4
+	assembler.Write(
+	    CVuAssembler::Upper::SUBbc(CVuAssembler::DEST_XYZW, CVuAssembler::VF1, CVuAssembler::VF2, CVuAssembler::VF3, CVuAssembler::BC_X),
+	    CVuAssembler::Lower::NOP());
+
+	//pipe = 1		//macTime = 1 + 4 = 5, overwritten before being read
+	assembler.Write(
+	    CVuAssembler::Upper::MULi(CVuAssembler::DEST_XYZW, CVuAssembler::VF4, CVuAssembler::VF5),
+	    CVuAssembler::Lower::NOP());
+
+	//pipe = 2		//macTime = 2 + 4 = 6, read at pipe 6
+	assembler.Write(
+	    CVuAssembler::Upper::ADDi(CVuAssembler::DEST_XYZW, CVuAssembler::VF6, CVuAssembler::VF7),
+	    CVuAssembler::Lower::NOP());
+
+	//pipe = 3
+	assembler.Write(
+	    CVuAssembler::Upper::NOP(),
+	    CVuAssembler::Lower::NOP());
+
+	//pipe = 4
+	assembler.Write(
+	    CVuAssembler::Upper::NOP(),
+	    CVuAssembler::Lower::FMAND(CVuAssembler::VI1, CVuAssembler::VI15));
+
+	//pipe = 5
+	assembler.Write(
+	    CVuAssembler::Upper::NOP(),
+	    CVuAssembler::Lower::NOP());
+
+	//pipe = 6
+	assembler.Write(
+	    CVuAssembler::Upper::NOP(),
+	    CVuAssembler::Lower::FMAND(CVuAssembler::VI2, CVuAssembler::VI15));
+
+	//pipe = 7		//macTime = 7 + 4 = 11, overwritten before being read
+	assembler.Write(
+	    CVuAssembler::Upper::SUBbc(CVuAssembler::DEST_XYZW, CVuAssembler::VF8, CVuAssembler::VF5, CVuAssembler::VF2, CVuAssembler::BC_X),
+	    CVuAssembler::Lower::NOP());
+
+	//pipe = 8		//macTime = 8 + 4 = 12, seen by the following microprogram
+	assembler.Write(
+	    CVuAssembler::Upper::MULi(CVuAssembler::DEST_XYZW, CVuAssembler::VF9, CVuAssembler::VF2),
+	    CVuAssembler::Lower::NOP());
+
+	//pipe = 9-11
+	for(unsigned int i = 0; i < 3; i++)
+	{
+		assembler.Write(
+		    CVuAssembler::Upper::NOP(),
+		    CVuAssembler::Lower::NOP());
+	}
+
+	//pipe = 12
+	assembler.Write(
+	    CVuAssembler::Upper::NOP() | CVuAssembler::Upper::E_BIT,
+	    CVuAssembler::Lower::FSAND(CVuAssembler::VI3, 0xFFF));
+
+	//pipe = 13
+	assembler.Write(
+	    CVuAssembler::Upper::NOP(),
+	    CVuAssembler::Lower::NOP());
+
+	//Second microprogram, reads the MAC flags left by the first one
+	static const uint32 secondProgramAddress = 0x100;
+	CVuAssembler secondAssembler(microMem + (secondProgramAddress / 4));
+
+	secondAssembler.Write(
+	    CVuAssembler::Upper::NOP(),
+	    CVuAssembler::Lower::FMAND(CVuAssembler::VI4, CVuAssembler::VI15));
+
+	secondAssembler.Write(
+	    CVuAssembler::Upper::NOP() | CVuAssembler::Upper::E_BIT,
+	    CVuAssembler::Lower::NOP());
+
+	secondAssembler.Write(
+	    CVuAssembler::Upper::NOP(),
+	    CVuAssembler::Lower::NOP());
+
+	auto& state = virtualMachine.m_cpu.m_State;
+
+	state.nCOP2[2].nV0 = 0x3F800000; //VF2 = (1, 1, 1, 1)
+	state.nCOP2[2].nV1 = 0x3F800000;
+	state.nCOP2[2].nV2 = 0x3F800000;
+	state.nCOP2[2].nV3 = 0x3F800000;
+
+	state.nCOP2[3].nV0 = 0x3F800000; //VF3x = 1
+
+	state.nCOP2[5].nV0 = 0x3F800000; //VF5 = (1, 2, 3, 4)
+	state.nCOP2[5].nV1 = 0x40000000;
+	state.nCOP2[5].nV2 = 0x40400000;
+	state.nCOP2[5].nV3 = 0x40800000;
+
+	state.nCOP2[7].nV0 = 0x3F800000; //VF7 = (1, 2, 1, 0)
+	state.nCOP2[7].nV1 = 0x40000000;
+	state.nCOP2[7].nV2 = 0x3F800000;
+	state.nCOP2[7].nV3 = 0x00000000;
+
+	state.nCOP2I = 0xBF800000; //I = -1
+
+	state.nCOP2VI[15] = 0xFFFF;
+
+	virtualMachine.ExecuteTest(0);
+
+	state.nHasException = 0;
+	virtualMachine.ExecuteTest(secondProgramAddress);
+
+	FLAGS_TEST3_RESULT result = {};
+	result.macFlags[0] = state.nCOP2VI[1];
+	result.macFlags[1] = state.nCOP2VI[2];
+	result.macFlags[2] = state.nCOP2VI[4];
+	result.statusFlags = state.nCOP2VI[3];
+	result.stickyFlags = state.nCOP2SF;
+	return result;
+}
+
+void CFlagsTest3::Execute(CTestVm& virtualMachine)
+{
+	//MAC flag writes overwritten before anything reads them are skipped by the block compiler,
+	//every flag value that can be observed must be the same as when all writes are kept
+
+	virtualMachine.m_executor.SetSkipUnusedMacFlagWrites(false);
+	auto referenceResult = RunFlagsTest3(virtualMachine);
+
+	virtualMachine.m_executor.SetSkipUnusedMacFlagWrites(true);
+	auto result = RunFlagsTest3(virtualMachine);
+
+	//Z set for every component (SUBbc result)
+	TEST_VERIFY(referenceResult.macFlags[0] == 0x000F);
+	//S set for every component (MULi result)
+	TEST_VERIFY(referenceResult.macFlags[2] == 0x00F0);
+
+	for(unsigned int i = 0; i < 3; i++)
+	{
+		TEST_VERIFY(result.macFlags[i] == referenceResult.macFlags[i]);
+	}
+	TEST_VERIFY(result.statusFlags == referenceResult.statusFlags);
+	TEST_VERIFY(result.stickyFlags == referenceResult.stickyFlags);
+}
@@ -4,6 +4,7 @@
 #include "AddTest.h"
 #include "FlagsTest.h"
 #include "FlagsTest2.h"
+#include "FlagsTest3.h"
 #include "TriAceTest.h"
 
 typedef std::function<CTest*()> TestFactoryFunction;
@@ -13,6 +14,7 @@ static const TestFactoryFunction s_factories[] =
         []() { return new CAddTest(); },
         []() { return new CFlagsTest(); },
         []() { return new CFlagsTest2(); },
+        []() { return new CFlagsTest3(); },
         []() { return new CTriAceTest(); },
 };
 